@@ -0,0 +1,216 @@
+/**
+ * The example to measure the JSON builders (JsonWriter, ObjectWriter and the Firestore Values), the parsers
+ * (StringUtil::parse and ValueConverter::to<T>) and the base64 encoding and decoding at several payload sizes.
+ *
+ * The report lines are in CSV format "BENCH,<name>,<size>,<ns/byte>,<ns/op>,<allocs/op>" that can be collected from
+ * serial output to compare the library versions.
+ *
+ * The allocs/op is the Memory class allocations of the library, the heap blocks that were held by the result
+ * are also counted on ESP32.
+ *
+ * The complete usage guidelines, please visit https://github.com/mobizt/FirebaseClient
+ */
+
+#include <Arduino.h>
+#include <FirebaseClient.h>
+
+#if defined(ESP32)
+#include <esp_heap_caps.h>
+#endif
+
+#define ROUNDS 50
+
+static const size_t sizes[] = {16, 256, 4096};
+
+String value;
+unsigned long start_us;
+uint32_t start_allocs;
+int32_t start_blocks;
+
+int32_t heapBlocks()
+{
+#if defined(ESP32)
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, MALLOC_CAP_DEFAULT);
+    return info.allocated_blocks;
+#else
+    return 0;
+#endif
+}
+
+void begin()
+{
+    start_allocs = Memory::globalStats().alloc_count;
+    start_blocks = heapBlocks();
+    start_us = micros();
+}
+
+// The blocks are sampled before the results were freed.
+void end(const char *name, size_t size, uint32_t ops)
+{
+    unsigned long us = micros() - start_us;
+    int32_t blocks = heapBlocks() - start_blocks;
+    uint32_t allocs = Memory::globalStats().alloc_count - start_allocs;
+
+    double ns_op = (double)us * 1000 / ops;
+    Serial.print("BENCH,");
+    Serial.print(name);
+    Serial.print(',');
+    Serial.print(size);
+    Serial.print(',');
+    Serial.print(size ? ns_op / size : 0, 2);
+    Serial.print(',');
+    Serial.print(ns_op, 0);
+    Serial.print(',');
+    Serial.println((double)(allocs + (blocks > 0 ? blocks : 0)) / ops, 2);
+}
+
+void benchJsonWriter(size_t size)
+{
+    JsonWriter writer;
+    object_t objs[ROUNDS];
+    begin();
+    for (int i = 0; i < ROUNDS; i++)
+        writer.create(objs[i], "/a/b/c", string_t(value.c_str()));
+    end("JsonWriter::create", size, ROUNDS);
+
+    object_t joined[ROUNDS];
+    begin();
+    for (int i = 0; i < ROUNDS; i++)
+        writer.join(joined[i], 3, objs[i], objs[i], objs[i]);
+    end("JsonWriter::join", size * 3, ROUNDS);
+}
+
+void benchObjectWriter(size_t size)
+{
+    ObjectWriter owriter;
+    String member = "{\"k\":\"";
+    member += value;
+    member += "\"}";
+    String bufs[ROUNDS];
+    begin();
+    for (int i = 0; i < ROUNDS; i++)
+    {
+        bufs[i] = member;
+        owriter.addMember(bufs[i], member, false);
+    }
+    end("ObjectWriter::addMember", size, ROUNDS);
+}
+
+void benchValues(size_t size)
+{
+#if defined(ENABLE_FIRESTORE)
+    String bufs[ROUNDS];
+    begin();
+    for (int i = 0; i < ROUNDS; i++)
+    {
+        Values::MapValue map("a", Values::StringValue(value));
+        map.add("b", Values::IntegerValue(i));
+        bufs[i] = map.c_str();
+    }
+    end("Values::MapValue", size, ROUNDS);
+
+    begin();
+    for (int i = 0; i < ROUNDS; i++)
+    {
+        Values::ArrayValue arr{Values::StringValue(value)};
+        arr.add(Values::DoubleValue(1.5));
+        bufs[i] = arr.c_str();
+    }
+    end("Values::ArrayValue", size, ROUNDS);
+#endif
+}
+
+void benchParse(size_t size)
+{
+    // The member to find is at the end of payload.
+    String payload = "{\"value\":\"";
+    payload += value;
+    payload += "\",\"name\":\"benchmark\"}";
+    StringUtil sut;
+    begin();
+    for (int i = 0; i < ROUNDS; i++)
+    {
+        int p1 = 0, p2 = 0;
+        sut.parse(payload, "\"name\"", ",", p1, p2);
+    }
+    end("StringUtil::parse", payload.length(), ROUNDS);
+}
+
+void benchConverter()
+{
+    ValueConverter vcon;
+    volatile int32_t n = 0;
+    volatile double d = 0;
+    begin();
+    for (int i = 0; i < ROUNDS * 20; i++)
+        n = vcon.to<int>("-1234567");
+    end("ValueConverter::to<int>", 8, ROUNDS * 20);
+
+    begin();
+    for (int i = 0; i < ROUNDS * 20; i++)
+        d = vcon.to<double>("3.14159265e2");
+    end("ValueConverter::to<double>", 12, ROUNDS * 20);
+
+    begin();
+    for (int i = 0; i < ROUNDS * 20; i++)
+        n = vcon.to<bool>("true");
+    end("ValueConverter::to<bool>", 4, ROUNDS * 20);
+    (void)n;
+    (void)d;
+}
+
+void benchBase64(size_t size)
+{
+    char *enc = new char[(size + 2) / 3 * 4 + 1];
+    uint8_t *dec = new uint8_t[size + 3];
+
+    begin();
+    size_t len = 0;
+    for (int i = 0; i < ROUNDS; i++)
+        len = Base64Util::encodeChars((const uint8_t *)value.c_str(), size, enc, false);
+    end("Base64Util::encode", size, ROUNDS);
+
+    begin();
+    for (int i = 0; i < ROUNDS; i++)
+    {
+        Base64Decoder decoder;
+        size_t written = 0;
+        decoder.decode((const uint8_t *)enc, len, dec, size + 3, written);
+    }
+    end("Base64Decoder::decode", size, ROUNDS);
+
+    delete[] enc;
+    delete[] dec;
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    delay(1000);
+
+    Firebase.printf("Firebase Client v%s\n", FIREBASE_CLIENT_VERSION);
+    Serial.println("BENCH,name,size,ns/byte,ns/op,allocs/op");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        value = "";
+        value.reserve(sizes[s]);
+        for (size_t i = 0; i < sizes[s]; i++)
+            value += (char)('a' + i % 26);
+
+        benchJsonWriter(sizes[s]);
+        benchObjectWriter(sizes[s]);
+        benchValues(sizes[s]);
+        benchParse(sizes[s]);
+        benchBase64(sizes[s]);
+        yield();
+    }
+
+    benchConverter();
+    Serial.println("BENCH,done,0,0,0,0");
+}
+
+void loop()
+{
+}
@@ -0,0 +1,305 @@
+/**
+ * The example to generate the sustained load of the Realtime database sets and updates, the Firestore commits,
+ * one Realtime database stream and the periodic Storage uploads at the target rate, for soak testing and
+ * performance reports.
+ *
+ * The report lines are in CSV format
+ * "LOAD,<uptime s>,<ops/s>,<ok>,<errors>,<p50 ms>,<p99 ms>,<reconnects>,<stream events>,<free heap>,<min free heap>,<fragmentation %>"
+ * that are printed every REPORT_INTERVAL_SEC, the ops/s, latency, errors and stream events are of the last interval.
+ *
+ * The operations mix is set by the weights, the operation is not sent when the queue of async client has
+ * MAX_IN_FLIGHT tasks.
+ *
+ * The complete usage guidelines, please visit https://github.com/mobizt/FirebaseClient
+ */
+
+#include <Arduino.h>
+#if defined(ESP32) || defined(ARDUINO_RASPBERRY_PI_PICO_W)
+#include <WiFi.h>
+#elif defined(ESP8266)
+#include <ESP8266WiFi.h>
+#elif __has_include(<WiFiNINA.h>)
+#include <WiFiNINA.h>
+#elif __has_include(<WiFi101.h>)
+#include <WiFi101.h>
+#elif __has_include(<WiFiS3.h>)
+#include <WiFiS3.h>
+#endif
+
+#include <FirebaseClient.h>
+
+#define WIFI_SSID "WIFI_AP"
+#define WIFI_PASSWORD "WIFI_PASSWORD"
+
+// The API key can be obtained from Firebase console > Project Overview > Project settings.
+#define API_KEY "Web_API_KEY"
+
+// User Email and password that already registerd or added in your project.
+#define USER_EMAIL "USER_EMAIL"
+#define USER_PASSWORD "USER_PASSWORD"
+#define DATABASE_URL "URL"
+#define FIREBASE_PROJECT_ID "PROJECT_ID"
+#define STORAGE_BUCKET_ID "BUCKET-NAME.appspot.com"
+
+// The target numbers of operations per second.
+#define TARGET_OPS_PER_SEC 2
+
+// The weights of operations mix, the operation with zero weight is not sent.
+#define RTDB_SET_WEIGHT 4
+#define RTDB_UPDATE_WEIGHT 2
+#define FIRESTORE_COMMIT_WEIGHT 1
+
+// The interval of Storage upload, 0 for no upload.
+#define STORAGE_UPLOAD_INTERVAL_SEC 300
+#define STORAGE_UPLOAD_SIZE 4096
+
+// Set to 0 to disable the stream.
+#define ENABLE_LOAD_STREAM 1
+
+#define MAX_IN_FLIGHT 4
+#define REPORT_INTERVAL_SEC 60
+
+// The latency samples of report interval, the percentiles are of the first samples when it is full.
+#define LATENCY_SAMPLES 256
+
+void asyncCB(AsyncResult &aResult);
+
+void streamCB(AsyncResult &aResult);
+
+DefaultNetwork network;
+
+UserAuth user_auth(API_KEY, USER_EMAIL, USER_PASSWORD);
+
+FirebaseApp app;
+
+#if defined(ESP32) || defined(ESP8266) || defined(PICO_RP2040)
+#include <WiFiClientSecure.h>
+WiFiClientSecure ssl_client, stream_ssl_client;
+#elif defined(ARDUINO_ARCH_SAMD)
+#include <WiFiSSLClient.h>
+WiFiSSLClient ssl_client, stream_ssl_client;
+#endif
+
+using AsyncClient = AsyncClientClass;
+
+AsyncClient aClient(ssl_client, getNetwork(network)), streamClient(stream_ssl_client, getNetwork(network));
+
+RealtimeDatabase Database;
+
+Firestore::Documents Docs;
+
+Storage storage;
+
+uint8_t upload_data[STORAGE_UPLOAD_SIZE];
+BlobConfig upload_blob(upload_data, sizeof(upload_data));
+
+uint32_t latency_ms[LATENCY_SAMPLES];
+size_t latency_count = 0;
+uint32_t ops_ok = 0, ops_error = 0, ops_total = 0, stream_events = 0;
+unsigned long next_op_ms = 0, report_ms = 0, upload_ms = 0;
+
+uint32_t heapFree()
+{
+#if defined(ESP32) || defined(ESP8266)
+    return ESP.getFreeHeap();
+#else
+    return 0;
+#endif
+}
+
+uint32_t heapMinFree()
+{
+#if defined(ESP32)
+    return ESP.getMinFreeHeap();
+#else
+    return FirebaseMetrics::shared().heapMinFree();
+#endif
+}
+
+// The percentage of free heap that is not in the largest free block.
+uint8_t heapFragmentation()
+{
+#if defined(ESP32)
+    uint32_t free = ESP.getFreeHeap();
+    return free ? 100 - (uint64_t)ESP.getMaxAllocHeap() * 100 / free : 0;
+#elif defined(ESP8266)
+    return ESP.getHeapFragmentation();
+#else
+    return 0;
+#endif
+}
+
+int compareLatency(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+uint32_t percentile(uint8_t p) { return latency_count ? latency_ms[(latency_count - 1) * p / 100] : 0; }
+
+void report()
+{
+    unsigned long elapsed = millis() - report_ms;
+    report_ms = millis();
+
+    qsort(latency_ms, latency_count, sizeof(uint32_t), compareLatency);
+
+    Serial.print("LOAD,");
+    Serial.print(millis() / 1000);
+    Serial.print(',');
+    Serial.print(elapsed ? (float)(ops_ok + ops_error) * 1000 / elapsed : 0, 2);
+    Serial.print(',');
+    Serial.print(ops_ok);
+    Serial.print(',');
+    Serial.print(ops_error);
+    Serial.print(',');
+    Serial.print(percentile(50));
+    Serial.print(',');
+    Serial.print(percentile(99));
+    Serial.print(',');
+    Serial.print(FirebaseMetrics::shared().counter(metrics_reconnects));
+    Serial.print(',');
+    Serial.print(stream_events);
+    Serial.print(',');
+    Serial.print(heapFree());
+    Serial.print(',');
+    Serial.print(heapMinFree());
+    Serial.print(',');
+    Serial.println(heapFragmentation());
+
+    ops_ok = 0;
+    ops_error = 0;
+    stream_events = 0;
+    latency_count = 0;
+}
+
+void sendOperation()
+{
+    const uint16_t total = RTDB_SET_WEIGHT + RTDB_UPDATE_WEIGHT + FIRESTORE_COMMIT_WEIGHT;
+    if (total == 0)
+        return;
+
+    uint16_t pick = ops_total++ % total;
+
+    if (pick < RTDB_SET_WEIGHT)
+    {
+        Database.set<int>(aClient, "/load/set/value", ops_total, asyncCB);
+    }
+    else if (pick < RTDB_SET_WEIGHT + RTDB_UPDATE_WEIGHT)
+    {
+        object_t json;
+        JsonWriter writer;
+        writer.create(json, "count", ops_total);
+        Database.update<object_t>(aClient, "/load/update", json, asyncCB);
+    }
+    else
+    {
+        Document<Values::Value> doc;
+        doc.setName("load_collection/load_document");
+        doc.add("count", Values::Value(Values::IntegerValue(ops_total)));
+        Writes writes(Write(DocumentMask("count"), doc, Precondition()));
+        Docs.commit(aClient, Firestore::Parent(FIREBASE_PROJECT_ID), writes, asyncCB);
+    }
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+
+    Serial.print("Connecting to Wi-Fi");
+    while (WiFi.status() != WL_CONNECTED)
+    {
+        Serial.print(".");
+        delay(300);
+    }
+    Serial.println();
+
+    Firebase.printf("Firebase Client v%s\n", FIREBASE_CLIENT_VERSION);
+
+#if defined(ESP32) || defined(ESP8266) || defined(PICO_RP2040)
+    ssl_client.setInsecure();
+    stream_ssl_client.setInsecure();
+#if defined(ESP8266)
+    ssl_client.setBufferSizes(4096, 1024);
+    stream_ssl_client.setBufferSizes(4096, 1024);
+#endif
+#endif
+
+    for (size_t i = 0; i < sizeof(upload_data); i++)
+        upload_data[i] = (uint8_t)i;
+
+    initializeApp(aClient, app, getAuth(user_auth));
+
+    unsigned long ms = millis();
+    while (app.isInitialized() && !app.ready() && millis() - ms < 120 * 1000)
+        app.loop();
+
+    app.getApp<RealtimeDatabase>(Database);
+    app.getApp<Firestore::Documents>(Docs);
+    app.getApp<Storage>(storage);
+
+    Database.url(DATABASE_URL);
+
+#if ENABLE_LOAD_STREAM
+    Database.get(streamClient, "/load/update", streamCB, true /* SSE mode (HTTP Streaming) */);
+#endif
+
+    Serial.println("LOAD,uptime_s,ops_per_s,ok,errors,p50_ms,p99_ms,reconnects,stream_events,heap_free,heap_min_free,fragmentation");
+    report_ms = millis();
+    upload_ms = millis();
+    next_op_ms = millis();
+}
+
+void loop()
+{
+    app.loop();
+    Database.loop();
+    Docs.loop();
+    storage.loop();
+
+    if (!app.ready())
+        return;
+
+    // The operations are scheduled at fixed rate, the missed operations are not sent later.
+    if ((long)(millis() - next_op_ms) >= 0)
+    {
+        next_op_ms += 1000 / TARGET_OPS_PER_SEC;
+        if ((long)(millis() - next_op_ms) > 1000)
+            next_op_ms = millis();
+        if (aClient.queueDepth() < MAX_IN_FLIGHT)
+            sendOperation();
+    }
+
+    if (STORAGE_UPLOAD_INTERVAL_SEC > 0 && millis() - upload_ms >= STORAGE_UPLOAD_INTERVAL_SEC * 1000UL)
+    {
+        upload_ms = millis();
+        storage.upload(aClient, FirebaseStorage::Parent(STORAGE_BUCKET_ID, "load.bin"), getBlob(upload_blob), "application/octet-stream", asyncCB);
+    }
+
+    if (millis() - report_ms >= REPORT_INTERVAL_SEC * 1000UL)
+        report();
+}
+
+void asyncCB(AsyncResult &aResult)
+{
+    // The upload progress and debug information are not counted.
+    if (aResult.isError())
+        ops_error++;
+    else if (aResult.available())
+        ops_ok++;
+    else
+        return;
+
+    request_timings_t t = aResult.timings();
+    if (t.complete_us && latency_count < LATENCY_SAMPLES)
+        latency_ms[latency_count++] = t.complete_us / 1000;
+}
+
+void streamCB(AsyncResult &aResult)
+{
+    if (aResult.isError())
+        Firebase.printf("Stream error: %s, code: %d\n", aResult.error().message().c_str(), aResult.error().code());
+    else if (aResult.available())
+        stream_events++;
+}
@@ -0,0 +1,394 @@
+/**
+ * The example to check the performance of the response parser (Content-Length, chunked and SSE responses), the JSON
+ * writers and Firestore Values builders, the base64 encoding and decoding, the URL construction and the slot scheduler
+ * against the recorded baselines.
+ *
+ * A check fails when its time per operation is more than REGRESSION_THRESHOLD percent above the baseline µs/op, when
+ * its allocations per operation grow by more than half of an allocation from the baseline, or when any of its
+ * operations was not completed with the expected result (payload, JSON, URL or decoded bytes).
+ *
+ * The allocations are counted from the heap allocation hook of the host build (test/host) that counts all malloc,
+ * calloc, realloc and new calls including the String buffers. On boards, only the Memory class allocations of the
+ * library are counted.
+ *
+ * The baselines depend on the target and compiler. The baselines table below was recorded with the host build
+ * (x86-64 Linux, GCC, CMake Release). To check on the board or other host, define RECORD_BASELINES and run the
+ * previous library version, then replace the table with the printed lines.
+ *
+ * Each check runs REPEATS times and the lowest µs/op of the runs is compared to reduce the noise of the other tasks.
+ *
+ * The report lines are in CSV format "PERF,<name>,<µs/op>,<allocs/op>,<PASS|FAIL>" and the last line is
+ * "PERF,result,<numbers of failed checks>".
+ *
+ * The complete usage guidelines, please visit https://github.com/mobizt/FirebaseClient
+ */
+
+#include <Arduino.h>
+#include <FirebaseClient.h>
+#include <core/MockClient.h>
+
+#define DATABASE_URL "https://regression-default-rtdb.firebaseio.com"
+
+// The numbers of requests of the response parser checks.
+#define ROUNDS 200
+
+// The numbers of operations of the JSON, base64 and URL checks that are faster than the request.
+#define COMPUTE_ROUNDS 2000
+
+#define REPEATS 5
+
+// The allowed time per operation above the baseline in percent, the time of the host build also varies with the
+// CPU load and frequency scaling of the host.
+#if !defined(REGRESSION_THRESHOLD)
+#if defined(ARDUINO)
+#define REGRESSION_THRESHOLD 25
+#else
+#define REGRESSION_THRESHOLD 100
+#endif
+#endif
+
+// The numbers of queued requests of slot scheduler check.
+#define QUEUED_REQUESTS 8
+
+// Print the baselines table lines instead of checking.
+// #define RECORD_BASELINES
+
+struct baseline_t
+{
+    const char *name;
+    float us_per_op;
+    float allocs_per_op;
+};
+
+// The median of 10 host runs.
+static const baseline_t baselines[] = {
+    {"parse_content_length", 8.26, 26.02},
+    {"parse_chunked", 8.06, 27.01},
+    {"parse_sse_event", 2.44, 0.14},
+    {"json_writer", 0.31, 5.00},
+    {"values_builder", 2.13, 36.00},
+    {"base64_encode", 0.18, 0.00},
+    {"base64_decode", 0.54, 0.00},
+    {"url_construction", 0.26, 5.00},
+    {"slot_scheduler", 7.76, 25.02}};
+
+static const char content_length_response[] = "HTTP/1.1 200 OK\r\nContent-Type: application/json; charset=utf-8\r\nContent-Length: 43\r\nConnection: keep-alive\r\n\r\n{\"name\":\"replay\",\"count\":12345,\"flag\":true}";
+
+static const char chunked_response[] = "HTTP/1.1 200 OK\r\nContent-Type: application/json; charset=utf-8\r\nTransfer-Encoding: chunked\r\nConnection: keep-alive\r\n\r\n10\r\n{\"name\":\"replay\"\r\n1B\r\n,\"count\":12345,\"flag\":true}\r\n0\r\n\r\n";
+
+static const char response_payload[] = "{\"name\":\"replay\",\"count\":12345,\"flag\":true}";
+
+static const char sse_header[] = "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n\r\n";
+
+// The events that are repeated in the SSE response.
+static const char sse_events[] = "event: put\ndata: {\"path\":\"/\",\"data\":{\"a\":1}}\n\n"
+                                 "event: patch\ndata: {\"path\":\"/s1\",\"data\":{\"temp\":25}}\n\n"
+                                 "event: put\ndata: {\"path\":\"/s2/hum\",\"data\":60}\n\n"
+                                 "event: put\ndata: {\"path\":\"/s3\",\"data\":\"on\"}\n\n";
+
+// The expected data paths of the SSE events.
+static const char *sse_paths[] = {"/", "/s1", "/s2/hum", "/s3"};
+
+#define SSE_EVENTS 200
+
+// The SSE response of SSE_EVENTS events.
+String sse_response;
+
+void netconnect() {}
+
+void netStatus(bool &status) { status = true; }
+
+GenericNetwork network(netconnect, netStatus);
+
+// The app with the legacy token is ready without the token request, the secret is not verified by MockClient.
+LegacyToken legacy_token("mock_database_secret");
+
+FirebaseApp app;
+
+MockClient mock;
+
+using AsyncClient = AsyncClientClass;
+
+AsyncClient aClient(mock, getNetwork(network));
+
+RealtimeDatabase Database;
+
+// The 256 bytes value of the letters 'a' to 'z' that are repeated and the expected JSON outputs of it.
+String value, expected_json, expected_values;
+
+// The base64 of the value.
+static const char value_base64[] = "YWJjZGVmZ2hpamtsbW5vcHFyc3R1dnd4eXphYmNkZWZnaGlqa2xtbm9wcXJzdHV2d3h5emFiY2RlZmdoaWprbG1u"
+                                   "b3BxcnN0dXZ3eHl6YWJjZGVmZ2hpamtsbW5vcHFyc3R1dnd4eXphYmNkZWZnaGlqa2xtbm9wcXJzdHV2d3h5emFi"
+                                   "Y2RlZmdoaWprbG1ub3BxcnN0dXZ3eHl6YWJjZGVmZ2hpamtsbW5vcHFyc3R1dnd4eXphYmNkZWZnaGlqa2xtbm9w"
+                                   "cXJzdHV2d3h5emFiY2RlZmdoaWprbG1ub3BxcnN0dXZ3eHl6YWJjZGVmZ2hpamtsbW5vcHFyc3R1dg==";
+
+uint32_t events = 0, done = 0, ok = 0;
+int failed = 0;
+
+uint32_t allocCount()
+{
+#if defined(ARDUINO)
+    return Memory::globalStats().alloc_count;
+#else
+    return hostAllocCount();
+#endif
+}
+
+// Run the check REPEATS times, the check returns the numbers of the operations that were completed.
+void measure(const char *name, uint32_t (*check)(), uint32_t ops)
+{
+    float us = 0;
+    uint32_t allocs = 0, completed = 0;
+    for (int r = 0; r < REPEATS; r++)
+    {
+        uint32_t start_allocs = allocCount();
+        unsigned long start_us = micros();
+        completed += check();
+        float run_us = (float)(micros() - start_us) / ops;
+        allocs += allocCount() - start_allocs;
+        if (r == 0 || run_us < us)
+            us = run_us;
+    }
+
+    float allocs_per_op = (float)allocs / (ops * REPEATS);
+
+#if defined(RECORD_BASELINES)
+    Firebase.printf("    {\"%s\", %.2f, %.2f},\n", name, us, allocs_per_op);
+#else
+    bool pass = completed == ops * REPEATS, found = false;
+    for (size_t i = 0; i < sizeof(baselines) / sizeof(baselines[0]); i++)
+    {
+        if (strcmp(baselines[i].name, name) == 0)
+        {
+            found = true;
+            if (us > baselines[i].us_per_op * (100 + REGRESSION_THRESHOLD) / 100)
+                pass = false;
+            // The allocations of the first operation that are amortized over the operations are tolerated.
+            if (allocs_per_op > baselines[i].allocs_per_op + 0.5f)
+                pass = false;
+        }
+    }
+
+    if (!pass || !found)
+        failed++;
+
+    Serial.print("PERF,");
+    Serial.print(name);
+    Serial.print(',');
+    Serial.print(us, 2);
+    Serial.print(',');
+    Serial.print(allocs_per_op, 2);
+    Serial.print(',');
+    Serial.println(pass && found ? "PASS" : "FAIL");
+#endif
+}
+
+uint32_t replay(const char *response)
+{
+    mock.clearResponses();
+    mock.addResponse(response);
+    mock.setLoop(true);
+
+    uint32_t completed = 0;
+    for (int i = 0; i < ROUNDS; i++)
+    {
+        AsyncResult result;
+        Database.get(aClient, "/replay", result);
+        // The available() is true once.
+        bool available = false;
+        while (!(available = result.available()) && !result.isError())
+            Database.loop();
+        if (available && strcmp(result.c_str(), response_payload) == 0)
+            completed++;
+    }
+    return completed;
+}
+
+uint32_t checkContentLength() { return replay(content_length_response); }
+
+uint32_t checkChunked() { return replay(chunked_response); }
+
+void eventCB(AsyncResult &aResult)
+{
+    if (aResult.available())
+    {
+        RealtimeDatabaseResult &r = aResult.to<RealtimeDatabaseResult>();
+        if (r.isStream() && events < SSE_EVENTS && r.dataPath() == sse_paths[events % 4])
+            events++;
+    }
+}
+
+uint32_t checkSSE()
+{
+    mock.clearResponses();
+    mock.addResponse(sse_response.c_str(), sse_response.length());
+    mock.setLoop(false);
+    events = 0;
+
+    Database.get(aClient, "/stream", eventCB, true /* SSE mode (HTTP Streaming) */);
+    unsigned long ms = millis();
+    while (events < SSE_EVENTS && millis() - ms < 5000)
+        Database.loop();
+
+    aClient.stopAsync(true);
+    for (int i = 0; i < 10; i++)
+        Database.loop();
+    return events;
+}
+
+uint32_t checkJSONWriter()
+{
+    JsonWriter writer;
+    uint32_t completed = 0;
+    for (int i = 0; i < COMPUTE_ROUNDS; i++)
+    {
+        object_t obj;
+        writer.create(obj, "/a/b/c", string_t(value.c_str()));
+        if (strcmp(obj.c_str(), expected_json.c_str()) == 0)
+            completed++;
+    }
+    return completed;
+}
+
+#if defined(ENABLE_FIRESTORE)
+uint32_t checkValuesBuilder()
+{
+    uint32_t completed = 0;
+    for (int i = 0; i < COMPUTE_ROUNDS; i++)
+    {
+        Values::MapValue map("a", Values::StringValue(value));
+        map.add("b", Values::IntegerValue(7));
+        map.add("c", Values::DoubleValue(1.5));
+        if (strcmp(map.c_str(), expected_values.c_str()) == 0)
+            completed++;
+    }
+    return completed;
+}
+#endif
+
+static char enc[sizeof(value_base64)];
+
+uint32_t checkBase64Encode()
+{
+    uint32_t completed = 0;
+    for (int i = 0; i < COMPUTE_ROUNDS; i++)
+    {
+        size_t len = Base64Util::encodeChars((const uint8_t *)value.c_str(), value.length(), enc, false);
+        if (len == sizeof(value_base64) - 1 && memcmp(enc, value_base64, len) == 0)
+            completed++;
+    }
+    return completed;
+}
+
+uint32_t checkBase64Decode()
+{
+    static uint8_t dec[256 + 3];
+    uint32_t completed = 0;
+    for (int i = 0; i < COMPUTE_ROUNDS; i++)
+    {
+        Base64Decoder decoder;
+        size_t written = 0;
+        decoder.decode((const uint8_t *)value_base64, sizeof(value_base64) - 1, dec, sizeof(dec), written);
+        if (written == value.length() && memcmp(dec, value.c_str(), written) == 0)
+            completed++;
+    }
+    return completed;
+}
+
+uint32_t checkURL()
+{
+    URLUtil uut;
+    uint32_t completed = 0;
+    for (int i = 0; i < COMPUTE_ROUNDS; i++)
+    {
+        String url;
+        uut.addGStorageURL(url, "regression.appspot.com", "/media/images/photo 1.jpg");
+        String encoded = uut.encode("/users/a b/c,d");
+        if (url == "gs://regression.appspot.com/media/images/photo 1.jpg" && encoded == "%2Fusers%2Fa%20b%2Fc%2Cd")
+            completed++;
+    }
+    return completed;
+}
+
+void doneCB(AsyncResult &aResult)
+{
+    // The available() is true once.
+    if (aResult.available())
+    {
+        if (strcmp(aResult.c_str(), response_payload) == 0)
+            ok++;
+        done++;
+    }
+    else if (aResult.isError())
+        done++;
+}
+
+uint32_t checkScheduler()
+{
+    mock.clearResponses();
+    mock.addResponse(content_length_response);
+    mock.setLoop(true);
+    done = 0;
+    ok = 0;
+
+    // The requests are queued before they are processed.
+    for (int i = 0; i < ROUNDS / QUEUED_REQUESTS; i++)
+    {
+        uint32_t queued = done + QUEUED_REQUESTS;
+        for (int j = 0; j < QUEUED_REQUESTS; j++)
+            Database.get(aClient, "/queue", doneCB);
+        unsigned long ms = millis();
+        while (done < queued && millis() - ms < 5000)
+            Database.loop();
+    }
+    return ok;
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    delay(1000);
+
+    Firebase.printf("Firebase Client v%s\n", FIREBASE_CLIENT_VERSION);
+
+    initializeApp(aClient, app, getAuth(legacy_token));
+
+    app.getApp<RealtimeDatabase>(Database);
+    Database.url(DATABASE_URL);
+
+    value.reserve(256);
+    for (size_t i = 0; i < 256; i++)
+        value += (char)('a' + i % 26);
+
+    sse_response = sse_header;
+    for (int i = 0; i < SSE_EVENTS / 4; i++)
+        sse_response += sse_events;
+
+    expected_json = "{\"a\":{\"b\":{\"c\":\"" + value + "\"}}}";
+    expected_values = "{\"fields\":{\"a\":{\"stringValue\":\"" + value + "\"},\"b\":{\"integerValue\":\"7\"},\"c\":{\"doubleValue\":1.50}}}";
+
+#if !defined(RECORD_BASELINES)
+    Serial.println("PERF,name,us_per_op,allocs_per_op,status");
+#endif
+
+    measure("parse_content_length", checkContentLength, ROUNDS);
+    measure("parse_chunked", checkChunked, ROUNDS);
+    measure("parse_sse_event", checkSSE, SSE_EVENTS);
+    measure("json_writer", checkJSONWriter, COMPUTE_ROUNDS);
+#if defined(ENABLE_FIRESTORE)
+    measure("values_builder", checkValuesBuilder, COMPUTE_ROUNDS);
+#endif
+    measure("base64_encode", checkBase64Encode, COMPUTE_ROUNDS);
+    measure("base64_decode", checkBase64Decode, COMPUTE_ROUNDS);
+    measure("url_construction", checkURL, COMPUTE_ROUNDS);
+    measure("slot_scheduler", checkScheduler, ROUNDS / QUEUED_REQUESTS * QUEUED_REQUESTS);
+
+#if !defined(RECORD_BASELINES)
+    Serial.print("PERF,result,");
+    Serial.println(failed);
+#endif
+}
+
+void loop()
+{
+}
@@ -0,0 +1,124 @@
+/**
+ * The example to replay the recorded server responses through the async client with MockClient at several read
+ * segmentations (from 1-byte reads to the full response) to measure the response parsing time and allocations.
+ *
+ * The responses are replayed on the same kept-alive connection, then the next response follows the previous one
+ * as in the session reuse.
+ *
+ * To replay the raw server byte stream that was recorded from the network, forward the network client to MockClient
+ * and set the file to record, e.g.
+ *
+ * MockClient recorder(&ssl_client);
+ * recorder.setRecorder(&file);
+ *
+ * Then use the recorder as the network client of async client and add the recorded file with mock.addResponse(file)
+ * to replay it.
+ *
+ * The report lines are in CSV format "REPLAY,<response>,<segment size>,<µs/request>,<allocs/request>,<ok>",
+ * the segment size 0 is the full response.
+ *
+ * The complete usage guidelines, please visit https://github.com/mobizt/FirebaseClient
+ */
+
+#include <Arduino.h>
+#include <FirebaseClient.h>
+#include <core/MockClient.h>
+
+#define DATABASE_URL "https://replay-default-rtdb.firebaseio.com"
+
+#define ROUNDS 20
+
+struct recorded_response_t
+{
+    const char *name;
+    const char *data;
+};
+
+static const recorded_response_t responses[] = {
+    {"content_length", "HTTP/1.1 200 OK\r\nContent-Type: application/json; charset=utf-8\r\nContent-Length: 46\r\nConnection: keep-alive\r\n\r\n{\"name\":\"replay\",\"count\":12345,\"flag\":true}\n\n\n"},
+    {"chunked", "HTTP/1.1 200 OK\r\nContent-Type: application/json; charset=utf-8\r\nTransfer-Encoding: chunked\r\nConnection: keep-alive\r\n\r\n10\r\n{\"name\":\"replay\"\r\n1D\r\n,\"count\":12345,\"flag\":true}\n\n\r\n0\r\n\r\n"},
+    {"error", "HTTP/1.1 404 Not Found\r\nContent-Type: application/json; charset=utf-8\r\nContent-Length: 25\r\nConnection: keep-alive\r\n\r\n{\"error\":\"404 Not Found\"}"}};
+
+static const size_t segments[] = {1, 16, 256, 1460, 0};
+
+void netconnect() {}
+
+void netStatus(bool &status) { status = true; }
+
+GenericNetwork network(netconnect, netStatus);
+
+// The app with the legacy token is ready without the token request, the secret is not verified by MockClient.
+LegacyToken legacy_token("mock_database_secret");
+
+FirebaseApp app;
+
+MockClient mock;
+
+using AsyncClient = AsyncClientClass;
+
+AsyncClient aClient(mock, getNetwork(network));
+
+RealtimeDatabase Database;
+
+void replay(const recorded_response_t &response, size_t segment)
+{
+    mock.clearResponses();
+    mock.addResponse(response.data);
+    mock.setLoop(true);
+    mock.setChunkSize(segment);
+
+    uint32_t allocs = Memory::globalStats().alloc_count, ok = 0;
+    unsigned long start = micros();
+    for (int i = 0; i < ROUNDS; i++)
+    {
+        AsyncResult result;
+        Database.get(aClient, "/replay", result);
+        // The result is set when the response was parsed completely, available() is true once.
+        bool available = false;
+        while (!(available = result.available()) && !result.isError())
+            Database.loop();
+        // The HTTP error is the parsed response, the client errors are negative.
+        if (available || result.error().code() > 0)
+            ok++;
+    }
+    unsigned long us = micros() - start;
+    allocs = Memory::globalStats().alloc_count - allocs;
+
+    Serial.print("REPLAY,");
+    Serial.print(response.name);
+    Serial.print(',');
+    Serial.print(segment);
+    Serial.print(',');
+    Serial.print(us / ROUNDS);
+    Serial.print(',');
+    Serial.print((float)allocs / ROUNDS, 2);
+    Serial.print(',');
+    Serial.println(ok);
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    delay(1000);
+
+    Firebase.printf("Firebase Client v%s\n", FIREBASE_CLIENT_VERSION);
+
+    initializeApp(aClient, app, getAuth(legacy_token));
+    while (app.isInitialized() && !app.ready())
+        app.loop();
+
+    app.getApp<RealtimeDatabase>(Database);
+    Database.url(DATABASE_URL);
+
+    Serial.println("REPLAY,response,segment,us_per_request,allocs_per_request,ok");
+    for (size_t r = 0; r < sizeof(responses) / sizeof(responses[0]); r++)
+    {
+        for (size_t s = 0; s < sizeof(segments) / sizeof(segments[0]); s++)
+            replay(responses[r], segments[s]);
+    }
+    Serial.println("REPLAY,done,0,0,0,0");
+}
+
+void loop()
+{
+}
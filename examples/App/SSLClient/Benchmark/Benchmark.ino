@@ -0,0 +1,178 @@
+/**
+ * The example to measure the EC (ECDHE), ECDSA verify and RSA public key implementations of the
+ * bundled BearSSL on the target device to find the fastest ones.
+ *
+ * The implementations that were reported as the fastest can be pinned for the SSL client
+ * (ESP_SSLClient) by defining the macros in Custom_ESP_SSLClient_FS.h e.g.
+ *
+ * #define ESP_SSLCLIENT_EC_IMPL br_ec_all_m15
+ * #define ESP_SSLCLIENT_ECDSA_VRFY_IMPL br_ecdsa_i15_vrfy_asn1
+ * #define ESP_SSLCLIENT_RSA_VRFY_IMPL br_rsa_i15_pkcs1_vrfy
+ * #define ESP_SSLCLIENT_RSA_PUB_IMPL br_rsa_i15_public
+ *
+ * The complete usage guidelines, please visit https://github.com/mobizt/FirebaseClient
+ */
+
+#include <Arduino.h>
+#include <FirebaseClient.h>
+
+#define EC_ROUNDS 3
+#define RSA_ROUNDS 5
+
+struct ec_impl_t
+{
+    const char *name;
+    const br_ec_impl *impl;
+};
+
+struct rsa_impl_t
+{
+    const char *name;
+    br_rsa_public pub;
+};
+
+// The private key and message hash that used for ECDSA.
+static const uint8_t ec_key[32] = {
+    0xc9, 0xaf, 0xa9, 0xd8, 0x45, 0xba, 0x75, 0x16, 0x6b, 0x5c, 0x21, 0x57, 0x67, 0xb1, 0xd6, 0x93,
+    0x4e, 0x50, 0xc3, 0xdb, 0x36, 0xe8, 0x9b, 0x12, 0x7b, 0x8a, 0x62, 0x2b, 0x12, 0x0f, 0x67, 0x21};
+
+uint8_t hash[32];
+
+unsigned long timeECDHE(const br_ec_impl *impl, int curve)
+{
+    uint8_t point[BR_EC_KBUF_PUB_MAX_SIZE];
+    size_t len = 0;
+    unsigned long start = micros();
+    for (int i = 0; i < EC_ROUNDS; i++)
+    {
+        // The key generation and shared secret computation of ECDHE.
+        len = impl->mulgen(point, ec_key, sizeof(ec_key), curve);
+        if (!len || !impl->mul(point, len, ec_key, sizeof(ec_key), curve))
+            return 0;
+        yield();
+    }
+    return (micros() - start) / EC_ROUNDS;
+}
+
+unsigned long timeECDSA(const br_ec_impl *impl, br_ecdsa_vrfy vrfy)
+{
+    br_ec_private_key sk = {BR_EC_secp256r1, (unsigned char *)ec_key, sizeof(ec_key)};
+    uint8_t pub[BR_EC_KBUF_PUB_MAX_SIZE], sig[80];
+    br_ec_public_key pk;
+    if (!br_ec_compute_pub(impl, &pk, pub, &sk))
+        return 0;
+
+    size_t sig_len = br_ecdsa_i31_sign_asn1(impl, &br_sha256_vtable, hash, &sk, sig);
+    unsigned long start = micros();
+    for (int i = 0; i < EC_ROUNDS; i++)
+    {
+        if (!sig_len || !vrfy(impl, hash, sizeof(hash), &pk, sig, sig_len))
+            return 0;
+        yield();
+    }
+    return (micros() - start) / EC_ROUNDS;
+}
+
+unsigned long timeRSA(br_rsa_public pub)
+{
+    // The odd 2048-bit modulus and the message that is less than modulus, the public key operation
+    // (the cost of RSA signature verification) does not require the real key.
+    static uint8_t n[256], x[256];
+    static const uint8_t e[] = {0x01, 0x00, 0x01};
+    for (size_t i = 0; i < sizeof(n); i++)
+        n[i] = (uint8_t)(i * 167 + 13);
+    n[0] |= 0x80;
+    n[sizeof(n) - 1] |= 0x01;
+    br_rsa_public_key pk = {n, sizeof(n), (unsigned char *)e, sizeof(e)};
+
+    unsigned long start = micros();
+    for (int i = 0; i < RSA_ROUNDS; i++)
+    {
+        memcpy(x, n, sizeof(x));
+        x[0] = 0x12;
+        if (!pub(x, sizeof(x), &pk))
+            return 0;
+        yield();
+    }
+    return (micros() - start) / RSA_ROUNDS;
+}
+
+void printTime(const char *name, unsigned long us)
+{
+    if (us)
+        Firebase.printf("  %-28s %8lu us\n", name, us);
+    else
+        Firebase.printf("  %-28s %8s\n", name, "n/a");
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    delay(1000);
+
+    Firebase.printf("Firebase Client v%s\n", FIREBASE_CLIENT_VERSION);
+
+    br_sha256_context ctx;
+    br_sha256_init(&ctx);
+    br_sha256_update(&ctx, "benchmark", 9);
+    br_sha256_out(&ctx, hash);
+
+    // The implementations that are not supported on this platform are null.
+    ec_impl_t p256[] = {{"br_ec_p256_m15", &br_ec_p256_m15}, {"br_ec_p256_m31", &br_ec_p256_m31}, {"br_ec_p256_m62", br_ec_p256_m62_get()}, {"br_ec_p256_m64", br_ec_p256_m64_get()}, {"br_ec_prime_i15", &br_ec_prime_i15}, {"br_ec_prime_i31", &br_ec_prime_i31}};
+    ec_impl_t c25519[] = {{"br_ec_c25519_i15", &br_ec_c25519_i15}, {"br_ec_c25519_i31", &br_ec_c25519_i31}, {"br_ec_c25519_m15", &br_ec_c25519_m15}, {"br_ec_c25519_m31", &br_ec_c25519_m31}, {"br_ec_c25519_m62", br_ec_c25519_m62_get()}, {"br_ec_c25519_m64", br_ec_c25519_m64_get()}};
+    ec_impl_t all[] = {{"br_ec_all_m15", &br_ec_all_m15}, {"br_ec_all_m31", &br_ec_all_m31}};
+    rsa_impl_t rsa[] = {{"br_rsa_i15_public", &br_rsa_i15_public}, {"br_rsa_i31_public", &br_rsa_i31_public}, {"br_rsa_i32_public", &br_rsa_i32_public}, {"br_rsa_i62_public", br_rsa_i62_public_get()}};
+
+    Serial.println("ECDHE secp256r1 (key generation + shared secret)");
+    for (size_t i = 0; i < sizeof(p256) / sizeof(p256[0]); i++)
+        printTime(p256[i].name, p256[i].impl ? timeECDHE(p256[i].impl, BR_EC_secp256r1) : 0);
+
+    Serial.println("ECDHE curve25519 (key generation + shared secret)");
+    for (size_t i = 0; i < sizeof(c25519) / sizeof(c25519[0]); i++)
+        printTime(c25519[i].name, c25519[i].impl ? timeECDHE(c25519[i].impl, BR_EC_curve25519) : 0);
+
+    Serial.println("ECDHE secp256r1 of ESP_SSLCLIENT_EC_IMPL candidates");
+    int ec_best = 0;
+    unsigned long ec_time[2];
+    for (int i = 0; i < 2; i++)
+    {
+        ec_time[i] = timeECDHE(all[i].impl, BR_EC_secp256r1);
+        printTime(all[i].name, ec_time[i]);
+        if (ec_time[i] && ec_time[i] < ec_time[ec_best])
+            ec_best = i;
+    }
+
+    Serial.println("ECDSA secp256r1 verify (ESP_SSLCLIENT_ECDSA_VRFY_IMPL candidates)");
+    unsigned long vrfy15 = timeECDSA(all[ec_best].impl, &br_ecdsa_i15_vrfy_asn1);
+    unsigned long vrfy31 = timeECDSA(all[ec_best].impl, &br_ecdsa_i31_vrfy_asn1);
+    printTime("br_ecdsa_i15_vrfy_asn1", vrfy15);
+    printTime("br_ecdsa_i31_vrfy_asn1", vrfy31);
+
+    Serial.println("RSA-2048 public key operation (ESP_SSLCLIENT_RSA_*_IMPL candidates)");
+    int rsa_best = -1;
+    unsigned long rsa_time = 0;
+    for (size_t i = 0; i < sizeof(rsa) / sizeof(rsa[0]); i++)
+    {
+        unsigned long t = rsa[i].pub ? timeRSA(rsa[i].pub) : 0;
+        printTime(rsa[i].name, t);
+        if (t && (rsa_best < 0 || t < rsa_time))
+        {
+            rsa_best = i;
+            rsa_time = t;
+        }
+    }
+
+    const char *rsa_names[] = {"i15", "i31", "i32", "i62"};
+    Serial.println("\nThe fastest implementations (Custom_ESP_SSLClient_FS.h):");
+    Firebase.printf("#define ESP_SSLCLIENT_EC_IMPL %s\n", all[ec_best].name);
+    Firebase.printf("#define ESP_SSLCLIENT_ECDSA_VRFY_IMPL %s\n", vrfy15 && (!vrfy31 || vrfy15 < vrfy31) ? "br_ecdsa_i15_vrfy_asn1" : "br_ecdsa_i31_vrfy_asn1");
+    if (rsa_best > -1)
+    {
+        Firebase.printf("#define ESP_SSLCLIENT_RSA_VRFY_IMPL br_rsa_%s_pkcs1_vrfy\n", rsa_names[rsa_best]);
+        Firebase.printf("#define ESP_SSLCLIENT_RSA_PUB_IMPL br_rsa_%s_public\n", rsa_names[rsa_best]);
+    }
+}
+
+void loop()
+{
+}
@@ -0,0 +1,317 @@
+/**
+ * The example to measure the TLS handshake (full and resumed), the record encryption and decryption
+ * throughput of cipher suites, the RSA signing of JWT and the SHA-256 and base64 throughput on the target device.
+ *
+ * The report lines are in CSV format "BENCH,<name>,<value>,<unit>" that can be collected from serial output
+ * e.g. to compare the boards or library versions.
+ *
+ * The handshake is measured when WIFI_SSID is set.
+ *
+ * The complete usage guidelines, please visit https://github.com/mobizt/FirebaseClient
+ */
+
+#include <Arduino.h>
+#if defined(ESP32) || defined(ARDUINO_RASPBERRY_PI_PICO_W)
+#include <WiFi.h>
+#elif defined(ESP8266)
+#include <ESP8266WiFi.h>
+#elif __has_include(<WiFiNINA.h>)
+#include <WiFiNINA.h>
+#elif __has_include(<WiFi101.h>)
+#include <WiFi101.h>
+#elif __has_include(<WiFiS3.h>)
+#include <WiFiS3.h>
+#endif
+
+#include <FirebaseClient.h>
+
+#define WIFI_SSID ""
+#define WIFI_PASSWORD ""
+
+#define TLS_HOST "firebaseio.com"
+#define TLS_ROUNDS 3
+
+// The record size (TLS maximum fragment) and rounds of throughput measurement.
+#define RECORD_SIZE 1024
+#define RECORD_ROUNDS 32
+
+#define RSA_BITS 2048
+#define RSA_ROUNDS 3
+
+static uint8_t record[RECORD_SIZE];
+static const uint8_t key[32] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32};
+static const uint8_t iv[12] = {0};
+static uint8_t tag[16];
+
+void report(const char *name, double value, const char *unit)
+{
+    Serial.print("BENCH,");
+    Serial.print(name);
+    Serial.print(',');
+    Serial.print(value, 3);
+    Serial.print(',');
+    Serial.println(unit);
+}
+
+// The throughput in MB/s of the bytes that were processed in the time in µs.
+double mbps(unsigned long us) { return us ? (double)RECORD_SIZE * RECORD_ROUNDS / us : 0; }
+
+void benchGCM(const char *name, const br_block_ctr_class *vt, br_ghash gh)
+{
+    if (!vt || !gh)
+        return;
+
+    br_aes_gen_ctr_keys aes;
+    vt->init(&aes.vtable, key, 16);
+    br_gcm_context gcm;
+    br_gcm_init(&gcm, &aes.vtable, gh);
+
+    String n = name;
+    for (int encrypt = 1; encrypt >= 0; encrypt--)
+    {
+        unsigned long start = micros();
+        for (int i = 0; i < RECORD_ROUNDS; i++)
+        {
+            br_gcm_reset(&gcm, iv, sizeof(iv));
+            br_gcm_aad_inject(&gcm, key, 13);
+            br_gcm_flip(&gcm);
+            br_gcm_run(&gcm, encrypt, record, sizeof(record));
+            br_gcm_get_tag(&gcm, tag);
+            yield();
+        }
+        report((n + (encrypt ? "_encrypt" : "_decrypt")).c_str(), mbps(micros() - start), "MB/s");
+    }
+}
+
+void benchChaCha(const char *name, br_chacha20_run cc, br_poly1305_run pc)
+{
+    if (!cc || !pc)
+        return;
+
+    String n = name;
+    for (int encrypt = 1; encrypt >= 0; encrypt--)
+    {
+        unsigned long start = micros();
+        for (int i = 0; i < RECORD_ROUNDS; i++)
+        {
+            pc(key, iv, record, sizeof(record), key, 13, tag, cc, encrypt);
+            yield();
+        }
+        report((n + (encrypt ? "_encrypt" : "_decrypt")).c_str(), mbps(micros() - start), "MB/s");
+    }
+}
+
+void benchCBC()
+{
+    // The AES-128-CBC with HMAC-SHA256 record, the MAC is computed over the plaintext and encrypted.
+    uint8_t cbc_iv[16];
+    br_hmac_key_context hk;
+    br_hmac_key_init(&hk, &br_sha256_vtable, key, 32);
+
+    br_aes_ct_cbcenc_keys enc;
+    br_aes_ct_cbcenc_init(&enc, key, 16);
+    unsigned long start = micros();
+    for (int i = 0; i < RECORD_ROUNDS; i++)
+    {
+        br_hmac_context hc;
+        br_hmac_init(&hc, &hk, 0);
+        br_hmac_update(&hc, record, sizeof(record));
+        br_hmac_out(&hc, tag);
+        memset(cbc_iv, 0, sizeof(cbc_iv));
+        br_aes_ct_cbcenc_run(&enc, cbc_iv, record, sizeof(record));
+        yield();
+    }
+    report("aes128_cbc_sha256_encrypt", mbps(micros() - start), "MB/s");
+
+    br_aes_ct_cbcdec_keys dec;
+    br_aes_ct_cbcdec_init(&dec, key, 16);
+    start = micros();
+    for (int i = 0; i < RECORD_ROUNDS; i++)
+    {
+        memset(cbc_iv, 0, sizeof(cbc_iv));
+        br_aes_ct_cbcdec_run(&dec, cbc_iv, record, sizeof(record));
+        br_hmac_context hc;
+        br_hmac_init(&hc, &hk, 0);
+        br_hmac_update(&hc, record, sizeof(record));
+        br_hmac_out(&hc, tag);
+        yield();
+    }
+    report("aes128_cbc_sha256_decrypt", mbps(micros() - start), "MB/s");
+}
+
+void benchSHA256()
+{
+    uint8_t hash[32];
+    br_sha256_context ctx;
+    br_sha256_init(&ctx);
+    unsigned long start = micros();
+    for (int i = 0; i < RECORD_ROUNDS; i++)
+        br_sha256_update(&ctx, record, sizeof(record));
+    br_sha256_out(&ctx, hash);
+    report("sha256", mbps(micros() - start), "MB/s");
+}
+
+void benchBase64()
+{
+    // The encoded size of the record.
+    static char out[(RECORD_SIZE + 2) / 3 * 4 + 1];
+    unsigned long start = micros();
+    for (int i = 0; i < RECORD_ROUNDS; i++)
+        Base64Util::encodeChars(record, sizeof(record), out, false);
+    report("base64_encode", mbps(micros() - start), "MB/s");
+
+    static uint8_t dec[RECORD_SIZE + 3];
+    size_t len = Base64Util::encodeChars(record, sizeof(record), out, false);
+    start = micros();
+    for (int i = 0; i < RECORD_ROUNDS; i++)
+    {
+        Base64Decoder decoder;
+        size_t written = 0;
+        decoder.decode((const uint8_t *)out, len, dec, sizeof(dec), written);
+    }
+    report("base64_decode", mbps(micros() - start), "MB/s");
+}
+
+void benchRSA()
+{
+    // The key is generated on device, it takes a while for 2048-bit key.
+    static uint8_t kbuf_priv[BR_RSA_KBUF_PRIV_SIZE(RSA_BITS)], kbuf_pub[BR_RSA_KBUF_PUB_SIZE(RSA_BITS)];
+    br_rsa_private_key sk;
+    br_rsa_public_key pk;
+    br_hmac_drbg_context rng;
+    br_hmac_drbg_init(&rng, &br_sha256_vtable, key, sizeof(key));
+
+    Serial.println("Generating RSA key...");
+    unsigned long start = millis();
+    if (!br_rsa_keygen_get_default()(&rng.vtable, &sk, kbuf_priv, &pk, kbuf_pub, RSA_BITS, 65537))
+        return;
+    report("rsa_keygen", millis() - start, "ms");
+
+    uint8_t hash[32], sig[RSA_BITS / 8];
+    memset(hash, 0x5a, sizeof(hash));
+
+    br_rsa_pkcs1_sign sign = br_rsa_pkcs1_sign_get_default();
+    start = millis();
+    for (int i = 0; i < RSA_ROUNDS; i++)
+    {
+        sign(BR_HASH_OID_SHA256, hash, sizeof(hash), &sk, sig);
+        yield();
+    }
+    report("rsa_sign_pkcs1_sha256", (double)(millis() - start) / RSA_ROUNDS, "ms");
+
+#if defined(ENABLE_JWT)
+    // The JWT signing that is performed in time slices by JWTClass::loop.
+    RSASigner signer;
+    unsigned long busy = 0;
+    uint32_t steps = 0;
+    start = millis();
+    if (signer.begin(&sk, hash))
+    {
+        int ret = 0;
+        while (ret == 0)
+        {
+            unsigned long ms = millis();
+            ret = signer.step();
+            busy += millis() - ms;
+            steps++;
+            yield();
+        }
+        report("rsa_sign_jwt", millis() - start, "ms");
+        report("rsa_sign_jwt_steps", steps, "steps");
+        report("rsa_sign_jwt_step_avg", steps ? (double)busy / steps : 0, "ms");
+    }
+#endif
+}
+
+#if defined(ESP32) || defined(ESP8266) || defined(ARDUINO_RASPBERRY_PI_PICO_W)
+WiFiClient basic_client;
+ESP_SSLClient ssl_client;
+
+void benchHandshake()
+{
+    ssl_client.setClient(&basic_client);
+    ssl_client.setInsecure();
+    ssl_client.setBufferSizes(4096, 1024);
+
+    BearSSL_Session session;
+    unsigned long full = 0, resumed = 0;
+    int full_count = 0, resumed_count = 0;
+    for (int i = 0; i < TLS_ROUNDS; i++)
+    {
+        // The new session object makes the full handshake, the same session object is resumed.
+        BearSSL_Session fresh;
+        ssl_client.setSession(&fresh);
+        unsigned long start = millis();
+        if (ssl_client.connect(TLS_HOST, 443))
+        {
+            full += millis() - start;
+            full_count++;
+        }
+        ssl_client.stop();
+        session = fresh;
+
+        ssl_client.setSession(&session);
+        start = millis();
+        if (ssl_client.connect(TLS_HOST, 443))
+        {
+            resumed += millis() - start;
+            resumed_count++;
+        }
+        ssl_client.stop();
+    }
+    ssl_client.setSession(nullptr);
+
+    if (full_count)
+        report("tls_handshake_full", (double)full / full_count, "ms");
+    if (resumed_count)
+        report("tls_handshake_resumed", (double)resumed / resumed_count, "ms");
+}
+#endif
+
+void setup()
+{
+    Serial.begin(115200);
+    delay(1000);
+
+    Firebase.printf("Firebase Client v%s\n", FIREBASE_CLIENT_VERSION);
+
+    for (size_t i = 0; i < sizeof(record); i++)
+        record[i] = (uint8_t)(i * 31 + 7);
+
+    Serial.println("BENCH,name,value,unit");
+
+    // The AES-GCM with the AES and GHASH implementations that are not supported on this platform are skipped.
+    benchGCM("aes128_gcm_ct", &br_aes_ct_ctr_vtable, &br_ghash_ctmul);
+    benchGCM("aes128_gcm_ct64", &br_aes_ct64_ctr_vtable, &br_ghash_ctmul64);
+    benchGCM("aes128_gcm_big", &br_aes_big_ctr_vtable, &br_ghash_ctmul32);
+    benchGCM("aes128_gcm_x86ni", br_aes_x86ni_ctr_get_vtable(), br_ghash_pclmul_get());
+
+    benchChaCha("chacha20_poly1305_ct", &br_chacha20_ct_run, &br_poly1305_ctmul_run);
+    benchChaCha("chacha20_poly1305_sse2", br_chacha20_sse2_get(), br_poly1305_ctmulq_get());
+
+    benchCBC();
+    benchSHA256();
+    benchBase64();
+    benchRSA();
+
+#if defined(ESP32) || defined(ESP8266) || defined(ARDUINO_RASPBERRY_PI_PICO_W)
+    if (strlen(WIFI_SSID))
+    {
+        WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+        Serial.print("Connecting to Wi-Fi");
+        while (WiFi.status() != WL_CONNECTED)
+        {
+            Serial.print(".");
+            delay(300);
+        }
+        Serial.println();
+        benchHandshake();
+    }
+#endif
+
+    Serial.println("BENCH,done,0,");
+}
+
+void loop()
+{
+}
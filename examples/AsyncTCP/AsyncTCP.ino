@@ -161,6 +161,8 @@ void AsyncTCPSendCB(uint8_t *data, size_t size, uint32_t &sent)
  * If data is available from TCP client, fills (copies) the data to buffer within the buffSize.
  * And set the amount of filled data in filledSize, and the remaining data amount in available.
  *
+ * The buffSize can be up to FIREBASE_ASYNC_TCP_RX_BUFFER_SIZE, fill as much data as available (up to buffSize) in one call.
+ *
  * If no data is available, TCP client should set 0 to available.
  * If connection or any receiving failure, sets filledSize with -1.
  */
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""Generate the preparsed service account credentials (service_account_key_t) from the service account JSON file.
+
+Usage: python3 service_account.py service_account.json [output.h] [variable_name]
+
+The client email, project Id, the constant JWT claims and the RSA private key (CRT) components are stored
+in flash, then ServiceAuth(timeCb, variable_name) and CustomAuth(timeCb, apiKey, variable_name, uid) do not
+parse the JSON and decode the PEM private key at run time.
+
+The generated header contains the private key, do not share or commit it.
+"""
+
+import base64
+import json
+import re
+import sys
+
+RSA_OID = bytes.fromhex('2a864886f70d010101')
+
+
+def tlv(der, pos):
+    """Returns (tag, content start, end) of the DER element at pos."""
+    tag = der[pos]
+    n = der[pos + 1]
+    pos += 2
+    if n & 0x80:
+        size = n & 0x7f
+        n = int.from_bytes(der[pos:pos + size], 'big')
+        pos += size
+    return tag, pos, pos + n
+
+
+def children(der, start, end):
+    items = []
+    while start < end:
+        tag, s, e = tlv(der, start)
+        items.append((tag, start, s, e))
+        start = e
+    return items
+
+
+def rsa_key(pem):
+    """Returns the RSAPrivateKey integers (version, n, e, d, p, q, dp, dq, iq) of PKCS#8 or PKCS#1 PEM key."""
+    m = re.search(r'-----BEGIN (RSA )?PRIVATE KEY-----(.+?)-----END (RSA )?PRIVATE KEY-----', pem, re.S)
+    if not m:
+        raise ValueError('no PEM private key')
+    der = base64.b64decode(''.join(m.group(2).split()))
+    items = children(der, *tlv(der, 0)[1:])
+    if not m.group(1):  # PrivateKeyInfo
+        alg = children(der, items[1][2], items[1][3])
+        if der[alg[0][2]:alg[0][3]] != RSA_OID:
+            raise ValueError('not RSA private key')
+        der = der[items[2][2]:items[2][3]]
+        items = children(der, *tlv(der, 0)[1:])
+    return [der[s:e].lstrip(b'\x00') for _, _, s, e in items[:9]]
+
+
+def array(name, data):
+    rows = [', '.join('0x%02x' % b for b in data[i:i + 16]) for i in range(0, len(data), 16)]
+    return 'static const uint8_t %s[] PROGMEM = {\n    %s};\n' % (name, ',\n    '.join(rows))
+
+
+def string(name, value):
+    return 'static const char %s[] PROGMEM = %s;\n' % (name, json.dumps(value))
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        return 1
+
+    sa = json.load(open(sys.argv[1]))
+    out = open(sys.argv[2], 'w') if len(sys.argv) > 2 else sys.stdout
+    var = sys.argv[3] if len(sys.argv) > 3 else 'service_account_key'
+
+    email = sa['client_email']
+    _, n, _, _, p, q, dp, dq, iq = rsa_key(sa['private_key'])
+    claims = '"iss":%s,"sub":%s' % (json.dumps(email), json.dumps(email))
+
+    out.write('// Generated by service_account.py, do not edit.\n')
+    out.write('// The preparsed credentials of %s for ServiceAuth(timeCb, %s).\n\n' % (email, var))
+    out.write(string('%s_email' % var, email))
+    out.write(string('%s_project_id' % var, sa['project_id']))
+    out.write(string('%s_claims' % var, claims))
+    fields = []
+    for name, value in (('p', p), ('q', q), ('dp', dp), ('dq', dq), ('iq', iq)):
+        out.write(array('%s_%s' % (var, name), value))
+        fields.append('%s_%s, sizeof(%s_%s)' % (var, name, var, name))
+    n_bitlen = int.from_bytes(n, 'big').bit_length()
+    out.write('\nstatic const service_account_key_t %s = {%s_email, %s_project_id, %s_claims, %d,\n    %s};\n' % (
+        var, var, var, var, n_bitlen, ',\n    '.join(fields)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""Generate the FlashTrustAnchor table (PROGMEM) for bssl::FlashCertStore from the PEM CA bundle.
+
+Usage: python3 trust_anchors.py ca_bundle.pem [output.h] [variable_name]
+
+The anchors are sorted by the SHA-256 hash of their subject DN (the same hash that is used by the
+X.509 validator of the bundled BearSSL). The RSA and EC (secp256r1, secp384r1 and secp521r1) keys
+are supported, the certificates of other key types and the duplicate subjects are skipped.
+"""
+
+import base64
+import hashlib
+import re
+import sys
+
+RSA_OID = bytes.fromhex('2a864886f70d010101')
+EC_OID = bytes.fromhex('2a8648ce3d0201')
+CURVES = {
+    bytes.fromhex('2a8648ce3d030107'): 23,  # BR_EC_secp256r1
+    bytes.fromhex('2b81040022'): 24,  # BR_EC_secp384r1
+    bytes.fromhex('2b81040023'): 25,  # BR_EC_secp521r1
+}
+
+
+def tlv(der, pos):
+    """Returns (tag, content start, end) of the DER element at pos."""
+    tag = der[pos]
+    n = der[pos + 1]
+    pos += 2
+    if n & 0x80:
+        size = n & 0x7f
+        n = int.from_bytes(der[pos:pos + size], 'big')
+        pos += size
+    return tag, pos, pos + n
+
+
+def children(der, start, end):
+    items = []
+    while start < end:
+        tag, s, e = tlv(der, start)
+        items.append((tag, start, s, e))
+        start = e
+    return items
+
+
+def parse(der):
+    _, s, e = tlv(der, 0)
+    _, s, e = tlv(der, s)  # tbsCertificate
+    items = children(der, s, e)
+    if items[0][0] == 0xa0:  # version
+        items = items[1:]
+    subject = der[items[4][1]:items[4][3]]
+    spki = children(der, items[5][2], items[5][3])
+    alg = children(der, spki[0][2], spki[0][3])
+    oid = der[alg[0][2]:alg[0][3]]
+    bits = der[spki[1][2] + 1:spki[1][3]]
+    if oid == RSA_OID:
+        key = children(bits, *tlv(bits, 0)[1:])
+        n = bits[key[0][2]:key[0][3]].lstrip(b'\x00')
+        e = bits[key[1][2]:key[1][3]].lstrip(b'\x00')
+        return subject, 'BR_KEYTYPE_RSA', 0, n, e
+    if oid == EC_OID and len(alg) > 1:
+        curve = CURVES.get(der[alg[1][2]:alg[1][3]])
+        if curve:
+            return subject, 'BR_KEYTYPE_EC', curve, bits, b''
+    return None
+
+
+def array(name, data):
+    rows = [', '.join('0x%02x' % b for b in data[i:i + 16]) for i in range(0, len(data), 16)]
+    return 'static const uint8_t %s[] PROGMEM = {\n    %s};\n' % (name, ',\n    '.join(rows))
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        return 1
+
+    src = open(sys.argv[1]).read()
+    out = open(sys.argv[2], 'w') if len(sys.argv) > 2 else sys.stdout
+    var = sys.argv[3] if len(sys.argv) > 3 else 'trust_anchors_P'
+
+    anchors = {}
+    for pem in re.findall(r'-----BEGIN CERTIFICATE-----(.+?)-----END CERTIFICATE-----', src, re.S):
+        key = parse(base64.b64decode(''.join(pem.split())))
+        if not key:
+            continue
+        dn_hash = hashlib.sha256(key[0]).digest()
+        if dn_hash in anchors:
+            sys.stderr.write('skip the duplicate subject %s\n' % dn_hash.hex())
+            continue
+        anchors[dn_hash] = key
+
+    out.write('// Generated by trust_anchors.py, do not edit.\n')
+    out.write('// %d trust anchors for bssl::FlashCertStore(%s, %s_count).\n\n' % (len(anchors), var, var))
+    entries = []
+    for i, dn_hash in enumerate(sorted(anchors)):
+        _, key_type, curve, k, e = anchors[dn_hash]
+        out.write(array('%s_key_%d' % (var, i), k))
+        exp = 'nullptr, 0'
+        if e:
+            out.write(array('%s_exp_%d' % (var, i), e))
+            exp = '%s_exp_%d, sizeof(%s_exp_%d)' % (var, i, var, i)
+        entries.append('    {{%s}, BR_X509_TA_CA, %s, %d, %s_key_%d, sizeof(%s_key_%d), %s}' % (
+            ', '.join('0x%02x' % b for b in dn_hash), key_type, curve, var, i, var, i, exp))
+    out.write('\nstatic const bssl::FlashTrustAnchor %s[] PROGMEM = {\n%s};\n\n' % (var, ',\n'.join(entries)))
+    out.write('static const size_t %s_count = sizeof(%s) / sizeof(%s[0]);\n' % (var, var, var))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
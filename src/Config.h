@@ -121,6 +121,348 @@
  * 🏷️ For maximum async queue limit setting for an async client
  * #define FIREBASE_ASYNC_QUEUE_LIMIT 10
  * 
+ * 🏷️ For maximum network clients (connections) in async client's connection pool
+ * #define FIREBASE_ASYNC_CONNECTION_POOL_LIMIT 4
+ * 
+ * 🏷️ For maximum networks (including the network of constructor) that async client can fail over to
+ * #define FIREBASE_NETWORK_FAILOVER_LIMIT 3
+ * 
+ * 🏷️ For the interval in seconds that the higher priority network is checked for failing back
+ * #define FIREBASE_NETWORK_FAILBACK_SEC 10
+ * 
+ * 🏷️ For the time in ms that the network status is used before the link status was read again (0 for no caching)
+ * #define FIREBASE_NET_STATUS_CACHE_MS 100
+ * 
+ * 🏷️ For the time in ms to wait the GSM modem to register to the network
+ * #define FIREBASE_GSM_NETWORK_TIMEOUT 60000
+ * 
+ * 🏷️ For the size of receive buffer that response data was read from network client in blocks
+ * #define FIREBASE_RX_BUFFER_SIZE 256
+ * 
+ * 🏷️ For the size of ring buffer that keeps the data received from async TCP client
+ * #define FIREBASE_ASYNC_TCP_RX_BUFFER_SIZE 512
+ * 
+ * 🏷️ For using the preallocated slot data (sized to FIREBASE_ASYNC_QUEUE_LIMIT) that are recycled instead of allocating from heap
+ * #define FIREBASE_ASYNC_SLOT_POOL
+ * 
+ * 🏷️ For the maximum size of request header and payload that are sent together in one write
+ * #define FIREBASE_COALESCE_WRITE_SIZE 1024
+ * 
+ * 🏷️ For the size of memory block of arena allocator that used by slot for the chunk buffers (0 for disabling)
+ * #define FIREBASE_MEMORY_ARENA_SIZE 4096
+ * 
+ * 🏷️ For the default transfer chunk size in bytes of async client
+ * #define FIREBASE_CHUNK_SIZE 2048
+ * 
+ * 🏷️ For the default source data size in bytes of base64 encoded upload chunk
+ * #define FIREBASE_BASE64_CHUNK_SIZE 1026
+ * 
+ * 🏷️ For the range of transfer chunk size that can be set at run time
+ * #define FIREBASE_CHUNK_SIZE_MIN 256
+ * #define FIREBASE_CHUNK_SIZE_MAX 16384
+ * 
+ * 🏷️ For the minimum allocation size that is placed in PSRAM when the memory placement is mem_placement_auto
+ * #define FIREBASE_PSRAM_MIN_ALLOC_SIZE 1024
+ * 
+ * 🏷️ For the maximum Content-Length of payload that its buffer is reserved before reading (0 for disabling)
+ * #define FIREBASE_PAYLOAD_RESERVE_LIMIT 16384
+ * 
+ * 🏷️ For the file block size in bytes that is read ahead or written behind in base64 file transfer
+ * #define FIREBASE_FILE_BLOCK_SIZE 1536
+ * 
+ * 🏷️ For using the fixed-size buffers (in slot data) for the receive, chunk and incomplete data buffers instead of heap
+ * #define FIREBASE_STATIC_BUFFERS
+ * 
+ * 🏷️ For the capacity of request header and response payload buffers that reserved in static buffers mode
+ * #define FIREBASE_STATIC_HEADER_SIZE 1024
+ * #define FIREBASE_STATIC_PAYLOAD_SIZE 2048
+ * 
+ * 🏷️ For the size of event buffer that is allocated once when the SSE stream was opened
+ * #define FIREBASE_SSE_BUFFER_SIZE 1024
+ * 
+ * 🏷️ For discarding the SSE event that exceeds the event buffer instead of growing the buffer
+ * #define FIREBASE_SSE_DROP_OVERFLOW
+ * 
+ * 🏷️ For the size of SSE event line that is read until its data path was matched by the stream filter
+ * #define FIREBASE_SSE_FILTER_READ_SIZE 64
+ * 
+ * 🏷️ For the numbers of unread debug messages in flash that are kept in async result
+ * #define FIREBASE_DEBUG_MESSAGES 4
+ * 
+ * 🏷️ For the maximum SSE stream timeout in ms that learned from the keep-alive interval
+ * #define FIREBASE_SSE_TIMEOUT_MAX 120000
+ * 
+ * 🏷️ For the maximum delay in ms of SSE stream reconnection backoff
+ * #define FIREBASE_SSE_BACKOFF_MAX 60000
+ * 
+ * 🏷️ For the default memory limit in bytes of Realtime Database mirror cache
+ * #define FIREBASE_RTDB_MIRROR_SIZE 4096
+ * 
+ * 🏷️ For the default size in bytes of sample ring buffer of Realtime Database telemetry batcher
+ * #define FIREBASE_RTDB_TELEMETRY_SIZE 2048
+ * 
+ * 🏷️ For the maximum numbers of node paths in Realtime Database offline write queue
+ * #define FIREBASE_RTDB_WRITE_QUEUE_LIMIT 100
+ * 
+ * 🏷️ For the maximum numbers of send attempts of Realtime Database offline write queue entry (0 for no limit)
+ * #define FIREBASE_RTDB_WRITE_QUEUE_ATTEMPTS 20
+ * 
+ * 🏷️ For the maximum numbers of leaf values per node in Realtime Database diff write
+ * #define FIREBASE_RTDB_DIFF_LEAF_LIMIT 256
+ * 
+ * 🏷️ For the maximum numbers of queued field requests of Realtime Database select
+ * #define FIREBASE_RTDB_SELECT_WINDOW 4
+ * 
+ * 🏷️ For the default maximum bytes of cached GET response payloads
+ * #define FIREBASE_RESPONSE_CACHE_SIZE 4096
+ * 
+ * 🏷️ For the maximum numbers of writes per batch of Firestore batch writer
+ * #define FIREBASE_FIRESTORE_BATCH_WRITE_LIMIT 500
+ * 
+ * 🏷️ For the maximum payload bytes per batch of Firestore batch writer
+ * #define FIREBASE_FIRESTORE_BATCH_WRITE_SIZE 16384
+ * 
+ * 🏷️ For the default numbers of writes in flight of Firestore pipelined writer
+ * #define FIREBASE_FIRESTORE_PIPELINE_WINDOW 4
+ * 
+ * 🏷️ For the maximum numbers of writes that were not acknowledged of Firestore pipelined writer
+ * #define FIREBASE_FIRESTORE_PIPELINE_QUEUE_LIMIT 16
+ * 
+ * 🏷️ For the maximum numbers of attempts of Firestore pipelined write that was not sent completely
+ * #define FIREBASE_FIRESTORE_PIPELINE_ATTEMPTS 3
+ * 
+ * 🏷️ For the delay in ms before the failed Firestore pipelined write is sent again, it grows with the attempts
+ * #define FIREBASE_FIRESTORE_PIPELINE_RETRY_MS 1000
+ * 
+ * 🏷️ For the maximum numbers of documents per request of Firestore streaming batchGet
+ * #define FIREBASE_FIRESTORE_BATCH_GET_LIMIT 100
+ * 
+ * 🏷️ For the minimum and maximum delay in ms between the polls of Firestore long-running operation
+ * #define FIREBASE_FIRESTORE_OPERATION_POLL_MIN 1000
+ * #define FIREBASE_FIRESTORE_OPERATION_POLL_MAX 60000
+ * 
+ * 🏷️ For the maximum numbers of retries of Firestore long-running operation poll when the network or server error occurred
+ * #define FIREBASE_FIRESTORE_OPERATION_RETRY 5
+ * 
+ * 🏷️ For the maximum numbers of attempts of Firestore transaction runner when the transaction was aborted
+ * #define FIREBASE_FIRESTORE_TRANSACTION_ATTEMPTS 5
+ * 
+ * 🏷️ For the maximum numbers of queued requests of Messaging fan-out sending
+ * #define FIREBASE_FCM_FANOUT_WINDOW 4
+ * 
+ * 🏷️ For the range size of Cloud Storage resumable upload in units of 256 KB
+ * #define FIREBASE_RESUMABLE_RANGE_UNITS 1
+ * 
+ * 🏷️ For the maximum range size of Cloud Storage adaptive resumable upload in units of 256 KB
+ * #define FIREBASE_RESUMABLE_RANGE_MAX_UNITS 32
+ * 
+ * 🏷️ For the target time in ms of each range of Cloud Storage adaptive resumable upload
+ * #define FIREBASE_RESUMABLE_RANGE_TARGET_MS 5000
+ * 
+ * 🏷️ For the maximum number of concurrent ranges of Storage and Cloud Storage parallel download
+ * #define FIREBASE_RANGE_DOWNLOAD_PARTS_LIMIT 4
+ * 
+ * 🏷️ For the range size in bytes of parallel file download (also the size of each reorder buffer)
+ * #define FIREBASE_RANGE_DOWNLOAD_BUFFER_SIZE 8192
+ * 
+ * 🏷️ For the number of attempts of each failed range of parallel download
+ * #define FIREBASE_RANGE_DOWNLOAD_ATTEMPTS 3
+ * 
+ * 🏷️ For computing the MD5 (BearSSL br_md5) of uploaded and downloaded data in addition to CRC32C
+ * #define FIREBASE_TRANSFER_MD5
+ * 
+ * 🏷️ For the maximum number of concurrent parts of Cloud Storage parallel (composite) upload
+ * #define FIREBASE_COMPOSITE_UPLOAD_PARTS_LIMIT 4
+ * 
+ * 🏷️ For the number of attempts of each failed part of parallel upload
+ * #define FIREBASE_COMPOSITE_UPLOAD_ATTEMPTS 3
+ * 
+ * 🏷️ For the number of entries in each page of Storage and Cloud Storage list iterator
+ * #define FIREBASE_LIST_PAGE_SIZE 50
+ * 
+ * 🏷️ For the number of attempts of each failed page of list iterator
+ * #define FIREBASE_LIST_PAGE_ATTEMPTS 3
+ * 
+ * 🏷️ For accepting and inflating the gzip compressed response
+ * #define ENABLE_GZIP
+ * 
+ * 🏷️ For the window size (2^bits bytes) of gzip inflate
+ * #define FIREBASE_INFLATE_WINDOW_BITS 15
+ * 
+ * 🏷️ For the size of input buffer of gzip inflate that keeps the incomplete block header or symbol
+ * #define FIREBASE_INFLATE_INPUT_SIZE 640
+ * 
+ * 🏷️ For the numbers of bits of the match finder table size of request payload gzip compression
+ * #define FIREBASE_DEFLATE_HASH_BITS 9
+ * 
+ * 🏷️ For the minimum size of request payload that is compressed (setRequestGzip)
+ * #define FIREBASE_DEFLATE_MIN_SIZE 1024
+ * 
+ * 🏷️ For the maximum number of objects that their metadata are cached
+ * #define FIREBASE_OBJECT_META_CACHE_SIZE 8
+ * 
+ * 🏷️ For the time in milliseconds that the cached object metadata is used without request
+ * #define FIREBASE_OBJECT_META_CACHE_TTL 300000
+ * 
+ * 🏷️ For the size of firmware blocks that are written to flash from two buffers in OTA update
+ * #define FIREBASE_OTA_BLOCK_SIZE 4096
+ * 
+ * 🏷️ For disabling the task that writes the firmware blocks to flash in OTA update (ESP32)
+ * #define FIREBASE_DISABLE_OTA_WRITE_TASK
+ * 
+ * 🏷️ For the stack size of the task that writes the firmware blocks to flash in OTA update (ESP32)
+ * #define FIREBASE_OTA_WRITE_TASK_STACK_SIZE 4096
+ * 
+ * 🏷️ For enabling the delta patch and gzip compressed firmware in OTA update
+ * #define ENABLE_DELTA_OTA
+ * 
+ * 🏷️ For the size of buffer that the running firmware is read for applying the delta patch
+ * #define FIREBASE_DELTA_OTA_BUFFER_SIZE 256
+ * 
+ * 🏷️ For the window size (2^bits bytes) of inflate for the gzip compressed firmware
+ * #define FIREBASE_OTA_INFLATE_WINDOW_BITS 15
+ * 
+ * 🏷️ For the number of hosts that their TLS sessions are kept for resuming the session
+ * #define FIREBASE_TLS_SESSION_CACHE_SIZE 4
+ * 
+ * 🏷️ For the maximum fragment length (512, 1024, 2048 or 4096) that is negotiated for sizing the TLS buffers
+ * #define FIREBASE_TLS_MAX_FRAGMENT_LENGTH 4096
+ * 
+ * 🏷️ For the number of hosts that their addresses are kept for connecting without host name lookup
+ * #define FIREBASE_DNS_CACHE_SIZE 4
+ * 
+ * 🏷️ For the default time to live in seconds of the cached host address
+ * #define FIREBASE_DNS_CACHE_TTL_SEC 300
+ * 
+ * 🏷️ For the number of hosts that their request rates are limited
+ * #define FIREBASE_RATE_LIMIT_HOSTS 4
+ * 
+ * 🏷️ For the initial requests per minute of the host that was limited from its HTTP 429 error
+ * #define FIREBASE_RATE_LIMIT_LEARN_RATE 60
+ * 
+ * 🏷️ For the minimum read timeout in seconds of the async tasks when the link adaptation is enabled
+ * #define FIREBASE_LINK_READ_TIMEOUT_MIN_SEC 10
+ * 
+ * 🏷️ For the maximum read timeout in seconds of the async tasks when the link adaptation is enabled
+ * #define FIREBASE_LINK_READ_TIMEOUT_MAX_SEC 60
+ * 
+ * 🏷️ For the multiple of retransmission timeout that is used as the read timeout of the async tasks when the link adaptation is enabled
+ * #define FIREBASE_LINK_READ_TIMEOUT_FACTOR 8
+ * 
+ * 🏷️ For the minimum bytes of request and response that its goodput is added to the link estimate
+ * #define FIREBASE_LINK_GOODPUT_MIN_BYTES 2048
+ * 
+ * 🏷️ For the number of hash buckets of the uid index that is used by stopAsync(uid)
+ * #define FIREBASE_SLOT_INDEX_BUCKETS 8
+ * 
+ * 🏷️ For the number of slot bits of each level of timer wheel that expires the library timers
+ * #define FIREBASE_TIMER_WHEEL_BITS 5
+ * 
+ * 🏷️ For the time in ms of RSA private key operation in each JWT loop (JWT token signing)
+ * #define FIREBASE_RSA_SIGN_SLICE_MS 20
+ * 
+ * 🏷️ For disabling the hardware SHA256 (mbedtls) of JWT token signing input (ESP32)
+ * #define FIREBASE_DISABLE_HW_SHA256
+ * 
+ * 🏷️ For the seconds that the time from time status callback is advanced by millis before it was requested again
+ * #define FIREBASE_TIME_RESYNC_SEC 21600
+ * 
+ * 🏷️ For the time in ms that the tasks waiting for the response can wait before the data arrival was checked (nextDeadline)
+ * #define FIREBASE_IDLE_POLL_MS 50
+ * 
+ * 🏷️ For the time in µs that each process call (loop) of async tasks can spend (0 for unlimited)
+ * #define FIREBASE_PROCESS_BUDGET_US 0
+ * 
+ * 🏷️ For the time in seconds that the kept-alive connection can be idle before it was closed (0 for no limit)
+ * #define FIREBASE_CONNECTION_MAX_IDLE_SEC 50
+ * 
+ * 🏷️ For the numbers of times that the waiting task can be passed by the tasks to the other host (setHostRouting)
+ * #define FIREBASE_HOST_ROUTING_BYPASS 4
+ * 
+ * 🏷️ For the seconds before the token expiry that the token is refreshed by warm-up (refreshAhead)
+ * #define FIREBASE_WARMUP_TOKEN_SEC 300
+ * 
+ * 🏷️ For the time in ms that the async task which was added before the app was authenticated waits for the token
+ * #define FIREBASE_AUTH_WAIT_MS 30000
+ * 
+ * 🏷️ For the numbers of Http2Client that can share the Http2Session
+ * #define FIREBASE_HTTP2_MAX_STREAMS 4
+ * 
+ * 🏷️ For the receive window and buffer size in bytes of each HTTP/2 stream
+ * #define FIREBASE_HTTP2_STREAM_WINDOW 4096
+ * 
+ * 🏷️ For the size in bytes of the HPACK dynamic table of HTTP/2 request headers
+ * #define FIREBASE_HTTP2_HPACK_TABLE_SIZE 512
+ * 
+ * 🏷️ For the size in bytes of the HTTP/2 header block buffer
+ * #define FIREBASE_HTTP2_HEADER_BLOCK_SIZE 2048
+ * 
+ * 🏷️ For the time in ms that the HTTP/2 stream waits for the flow control window to send data
+ * #define FIREBASE_HTTP2_WRITE_TIMEOUT_MS 10000
+ * 
+ * 🏷️ For the minimum delay in ms of failed request retry backoff (RetryPolicy)
+ * #define FIREBASE_RETRY_BACKOFF_MIN 500
+ * 
+ * 🏷️ For the maximum delay in ms of failed request retry backoff (RetryPolicy)
+ * #define FIREBASE_RETRY_BACKOFF_MAX 30000
+ * 
+ * 🏷️ For the numbers of retries of all requests of async client in a minute (RetryPolicy)
+ * #define FIREBASE_RETRY_BUDGET 10
+ * 
+ * 🏷️ For the remaining payload size of cancelled task that is discarded to keep the connection alive
+ * #define FIREBASE_CANCEL_DRAIN_SIZE 2048
+ * 
+ * 🏷️ For the numbers of response spool files of async client that are used in turn
+ * #define FIREBASE_SPOOL_RESPONSE_FILES 2
+ * 
+ * 🏷️ For disabling the locks of async client queue and address lists that used by multiple tasks (ESP32)
+ * #define FIREBASE_DISABLE_TASK_LOCK
+ * 
+ * 🏷️ For disabling the C++20 coroutine awaitables (AsyncTask and asyncAwait)
+ * #define FIREBASE_DISABLE_COROUTINE
+ * 
+ * 🏷️ For the stack size of the network worker task (ESP32)
+ * #define FIREBASE_NETWORK_WORKER_STACK_SIZE 8192
+ * 
+ * 🏷️ For the numbers of jobs that can be submitted to the network worker task (ESP32)
+ * #define FIREBASE_NETWORK_WORKER_QUEUE_SIZE 8
+ * 
+ * 🏷️ For disabling the scheduler of async clients that are processed by the pool of worker tasks (ESP32)
+ * #define FIREBASE_DISABLE_CLIENT_SCHEDULER
+ * 
+ * 🏷️ For the numbers of async clients that can be added to the client scheduler (ESP32)
+ * #define FIREBASE_CLIENT_SCHEDULER_CLIENT_LIMIT 8
+ * 
+ * 🏷️ For the maximum numbers of worker tasks of the client scheduler (ESP32)
+ * #define FIREBASE_CLIENT_SCHEDULER_WORKER_LIMIT 4
+ * 
+ * 🏷️ For the stack size of each worker task of the client scheduler (ESP32)
+ * #define FIREBASE_CLIENT_SCHEDULER_STACK_SIZE 8192
+ * 
+ * 🏷️ For the numbers of loop functions that can be added to the client scheduler (ESP32)
+ * #define FIREBASE_CLIENT_SCHEDULER_LOOP_LIMIT 8
+ * 
+ * 🏷️ For the maximum time in ms that the worker task of the client scheduler waits when its clients are idle (ESP32)
+ * #define FIREBASE_CLIENT_SCHEDULER_IDLE_MS 2
+ * 
+ * 🏷️ For disabling the process-wide metrics counters and latency histograms (FirebaseMetrics)
+ * #define FIREBASE_DISABLE_METRICS
+ * 
+ * 🏷️ For the numbers of log2 buckets of metrics latency histograms
+ * #define FIREBASE_METRICS_BUCKETS 16
+ * 
+ * 🏷️ For the numbers of request bytes that are kept by MockClient
+ * #define FIREBASE_MOCK_CLIENT_CAPTURE_SIZE 1024
+ * 
+ * 🏷️ For the size of receive buffer of SocketClient
+ * #define FIREBASE_SOCKET_RX_BUFFER_SIZE 1460
+ * 
+ * 🏷️ For the size of socket send and receive buffers that are requested by SocketClient (0 for the TCP stack default)
+ * #define FIREBASE_SOCKET_BUFFER_SIZE 8192
+ * 
+ * 🏷️ For enabling the task state transition trace ring buffer with the numbers of records (power of two) (AsyncTrace)
+ * #define FIREBASE_TRACE_SIZE 256
+ * 
  * 🏷️ For Firebase.printf debug port
  * #define FIREBASE_PRINTF_PORT Serial
  */
@@ -35,6 +35,8 @@
 #include <Arduino.h>
 #include "./core/FirebaseApp.h"
 #include "./core/AsyncClient/AsyncClient.h"
+#include "./core/NetworkWorker.h"
+#include "./core/ClientScheduler.h"
 
 #if defined(ENABLE_DATABASE)
 #if __has_include("database/RealtimeDatabase.h")
@@ -93,10 +95,8 @@ namespace firebase
     private:
         void configApp(AsyncClientClass &aClient, FirebaseApp &app, user_auth_data &auth, firebase_core_auth_task_type task_type = firebase_core_auth_task_type_undefined)
         {
-            app.aClient = &aClient;
-            app.aclient_addr = reinterpret_cast<uint32_t>(&aClient);
-
-            app.aClient->addRemoveClientVec(reinterpret_cast<uint32_t>(&(app.cVec)), true);
+            app.setClient(aClient);
+            app.aClient->addRemoveClientVec(app.cVec, true);
             app.auth_data.user_auth.copy(auth);
 
             app.auth_data.app_token.clear();
@@ -197,6 +197,7 @@ namespace firebase
                 app.auth_data.app_token.authenticated = false;
                 uint32_t exp = app.auth_data.user_auth.auth_type == auth_user_id_token ? app.auth_data.user_auth.user.expire : app.auth_data.user_auth.sa.expire;
                 resetTimer(app, true, 0, exp);
+                app.restoreToken();
             }
         }
 
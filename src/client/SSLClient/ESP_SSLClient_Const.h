@@ -55,6 +55,12 @@ enum esp_ssl_client_error_types
     esp_ssl_internal_error
 };
 
+enum esp_ssl_client_cipher_policy
+{
+    esp_ssl_cipher_policy_default,
+    esp_ssl_cipher_policy_fastest
+};
+
 #if defined(ESP_SSLCLIENT_ENABLE_DEBUG)
 
 static void esp_ssl_debug_print_prefix(const char *func_name, int level)
@@ -33,6 +33,13 @@
 // For external SRAM (PSRAM) support
 #define ESP_SSLCLIENT_USE_PSRAM
 
+// For the EC (ECDHE), ECDSA and RSA implementations that are used instead of the defaults,
+// run the SSLClient/Benchmark example on the target to find the fastest ones.
+// #define ESP_SSLCLIENT_EC_IMPL br_ec_all_m15
+// #define ESP_SSLCLIENT_ECDSA_VRFY_IMPL br_ecdsa_i15_vrfy_asn1
+// #define ESP_SSLCLIENT_RSA_VRFY_IMPL br_rsa_i15_pkcs1_vrfy
+// #define ESP_SSLCLIENT_RSA_PUB_IMPL br_rsa_i15_public
+
 #if defined __has_include
 #if __has_include(<Custom_ESP_SSLClient_FS.h>)
 #include "Custom_ESP_SSLClient_FS.h"
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2017 Thomas Pornin <pornin@bolet.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining 
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be 
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND 
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "../ESP_SSLClient_FS.h"
+#if defined(USE_LIB_SSL_ENGINE)
+
+#include "inner.h"
+
+#if BR_AES_ESP32
+
+#if __has_include(<aes/esp_aes.h>)
+#include <aes/esp_aes.h>
+#else
+#include <esp32/aes.h>
+#endif
+
+/* see bearssl_block.h */
+const br_block_cbcenc_class *
+br_aes_esp32_cbcenc_get_vtable(void)
+{
+	return &br_aes_esp32_cbcenc_vtable;
+}
+
+/* see bearssl_block.h */
+void
+br_aes_esp32_cbcenc_init(br_aes_esp32_cbcenc_keys *ctx,
+	const void *key, size_t len)
+{
+	esp_aes_context aes;
+
+	ctx->vtable = &br_aes_esp32_cbcenc_vtable;
+	memcpy(ctx->key, key, len);
+	ctx->key_len = len;
+
+	/*
+	 * The key length that the accelerator does not support is
+	 * processed by the aes_ct code.
+	 */
+	esp_aes_init(&aes);
+	if (esp_aes_setkey(&aes, ctx->key, len << 3) != 0) {
+		ctx->key_len = 0;
+		br_aes_ct_cbcenc_init(&ctx->ct, key, len);
+	}
+	esp_aes_free(&aes);
+}
+
+/* see bearssl_block.h */
+void
+br_aes_esp32_cbcenc_run(const br_aes_esp32_cbcenc_keys *ctx,
+	void *iv, void *data, size_t len)
+{
+	esp_aes_context aes;
+
+	if (ctx->key_len == 0) {
+		br_aes_ct_cbcenc_run(&ctx->ct, iv, data, len);
+		return;
+	}
+
+	/*
+	 * The data are encrypted in place, the IV is updated to the last
+	 * block of ciphertext.
+	 */
+	esp_aes_init(&aes);
+	esp_aes_setkey(&aes, ctx->key, ctx->key_len << 3);
+	esp_aes_crypt_cbc(&aes, ESP_AES_ENCRYPT, len, iv, data, data);
+	esp_aes_free(&aes);
+}
+
+/* see bearssl_block.h */
+const br_block_cbcenc_class br_aes_esp32_cbcenc_vtable = {
+	sizeof(br_aes_esp32_cbcenc_keys),
+	16,
+	4,
+	(void (*)(const br_block_cbcenc_class **, const void *, size_t))
+		&br_aes_esp32_cbcenc_init,
+	(void (*)(const br_block_cbcenc_class *const *, void *, void *, size_t))
+		&br_aes_esp32_cbcenc_run
+};
+
+#else
+
+/* see bearssl_block.h */
+const br_block_cbcenc_class *
+br_aes_esp32_cbcenc_get_vtable(void)
+{
+	return NULL;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2017 Thomas Pornin <pornin@bolet.org>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining 
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be 
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND 
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "../ESP_SSLClient_FS.h"
+#if defined(USE_LIB_SSL_ENGINE)
+
+#include "inner.h"
+
+#if BR_AES_ESP32
+
+#if __has_include(<aes/esp_aes.h>)
+#include <aes/esp_aes.h>
+#else
+#include <esp32/aes.h>
+#endif
+
+/* see bearssl_block.h */
+const br_block_ctr_class *
+br_aes_esp32_ctr_get_vtable(void)
+{
+	return &br_aes_esp32_ctr_vtable;
+}
+
+/* see bearssl_block.h */
+void
+br_aes_esp32_ctr_init(br_aes_esp32_ctr_keys *ctx,
+	const void *key, size_t len)
+{
+	esp_aes_context aes;
+
+	ctx->vtable = &br_aes_esp32_ctr_vtable;
+	memcpy(ctx->key, key, len);
+	ctx->key_len = len;
+
+	/*
+	 * The key length that the accelerator does not support is
+	 * processed by the aes_ct code.
+	 */
+	esp_aes_init(&aes);
+	if (esp_aes_setkey(&aes, ctx->key, len << 3) != 0) {
+		ctx->key_len = 0;
+		br_aes_ct_ctr_init(&ctx->ct, key, len);
+	}
+	esp_aes_free(&aes);
+}
+
+/* see bearssl_block.h */
+uint32_t
+br_aes_esp32_ctr_run(const br_aes_esp32_ctr_keys *ctx,
+	const void *iv, uint32_t cc, void *data, size_t len)
+{
+	esp_aes_context aes;
+	unsigned char ctr[16], stream[16];
+	unsigned char *buf;
+
+	if (ctx->key_len == 0) {
+		return br_aes_ct_ctr_run(&ctx->ct, iv, cc, data, len);
+	}
+
+	esp_aes_init(&aes);
+	esp_aes_setkey(&aes, ctx->key, ctx->key_len << 3);
+	buf = data;
+	while (len > 0) {
+		size_t clen, off;
+		uint64_t room;
+
+		/*
+		 * The 32-bit counter wraps around without the carry to the
+		 * IV, the data after the wrap are processed with a new
+		 * counter block.
+		 */
+		room = ((uint64_t)1 << 32) - cc;
+		clen = len;
+		if ((uint64_t)clen > (room << 4)) {
+			clen = (size_t)(room << 4);
+		}
+		memcpy(ctr, iv, 12);
+		br_enc32be(ctr + 12, cc);
+		off = 0;
+		esp_aes_crypt_ctr(&aes, clen, &off, ctr, stream, buf, buf);
+		cc += (uint32_t)((clen + 15) >> 4);
+		buf += clen;
+		len -= clen;
+	}
+	esp_aes_free(&aes);
+	return cc;
+}
+
+/* see bearssl_block.h */
+const br_block_ctr_class br_aes_esp32_ctr_vtable = {
+	sizeof(br_aes_esp32_ctr_keys),
+	16,
+	4,
+	(void (*)(const br_block_ctr_class **, const void *, size_t))
+		&br_aes_esp32_ctr_init,
+	(uint32_t (*)(const br_block_ctr_class *const *,
+		const void *, uint32_t, void *, size_t))
+		&br_aes_esp32_ctr_run
+};
+
+#else
+
+/* see bearssl_block.h */
+const br_block_ctr_class *
+br_aes_esp32_ctr_get_vtable(void)
+{
+	return NULL;
+}
+
+#endif
+
+#endif
@@ -194,6 +194,17 @@
 #define BR_AES_X86NI   1
  */
 
+/*
+ * When BR_AES_ESP32 is enabled, the AES implementation using the AES
+ * hardware accelerator of ESP32 (through the ESP-IDF esp_aes driver) is
+ * compiled and used by default for the AES-CBC and AES-GCM cipher suites.
+ * If this is not enabled explicitly, then that AES implementation will be
+ * compiled on the ESP32 targets. If set explicitly to 0, the implementation
+ * will not be compiled at all.
+ *
+#define BR_AES_ESP32   1
+ */
+
 /*
  * When BR_SSE2 is enabled, SSE2 intrinsics will be used for some
  * algorithm implementations that use them (e.g. chacha20_sse2). If this
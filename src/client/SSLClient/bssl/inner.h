@@ -287,6 +287,15 @@
 #endif
 #endif
 
+/*
+ * The AES hardware accelerator is available on all ESP32 targets.
+ */
+#ifndef BR_AES_ESP32
+#if defined(ESP32)
+#define BR_AES_ESP32   1
+#endif
+#endif
+
 /*
  * SSE2 intrinsics are available on x86 (32-bit and 64-bit) with
  * GCC 4.4+, Clang 3.7+ and MSC 2005+.
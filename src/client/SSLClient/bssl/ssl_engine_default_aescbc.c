@@ -31,7 +31,7 @@
 void
 br_ssl_engine_set_default_aes_cbc(br_ssl_engine_context *cc)
 {
-#if BR_AES_X86NI || BR_POWER8
+#if BR_AES_X86NI || BR_POWER8 || BR_AES_ESP32
 	const br_block_cbcenc_class *ienc;
 	const br_block_cbcdec_class *idec;
 #endif
@@ -55,6 +55,14 @@ br_ssl_engine_set_default_aes_cbc(br_ssl_engine_context *cc)
 		return;
 	}
 #endif
+#if BR_AES_ESP32
+	ienc = br_aes_esp32_cbcenc_get_vtable();
+	idec = br_aes_esp32_cbcdec_get_vtable();
+	if (ienc != NULL && idec != NULL) {
+		br_ssl_engine_set_aes_cbc(cc, ienc, idec);
+		return;
+	}
+#endif
 #if BR_64
 	br_ssl_engine_set_aes_cbc(cc,
 		&br_aes_ct64_cbcenc_vtable,
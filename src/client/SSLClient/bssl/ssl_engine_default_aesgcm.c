@@ -31,8 +31,10 @@
 void
 br_ssl_engine_set_default_aes_gcm(br_ssl_engine_context *cc)
 {
-#if BR_AES_X86NI || BR_POWER8
+#if BR_AES_X86NI || BR_POWER8 || BR_AES_ESP32
 	const br_block_ctr_class *ictr;
+#endif
+#if BR_AES_X86NI || BR_POWER8
 	br_ghash ighash;
 #endif
 
@@ -61,6 +63,13 @@ br_ssl_engine_set_default_aes_gcm(br_ssl_engine_context *cc)
 		br_ssl_engine_set_aes_ctr(cc, &br_aes_ct_ctr_vtable);
 #endif
 	}
+#elif BR_AES_ESP32
+	ictr = br_aes_esp32_ctr_get_vtable();
+	if (ictr != NULL) {
+		br_ssl_engine_set_aes_ctr(cc, ictr);
+	} else {
+		br_ssl_engine_set_aes_ctr(cc, &br_aes_ct_ctr_vtable);
+	}
 #else
 #if BR_64
 	br_ssl_engine_set_aes_ctr(cc, &br_aes_ct64_ctr_vtable);
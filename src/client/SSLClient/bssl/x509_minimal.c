@@ -1205,6 +1205,28 @@ br_x509_minimal_run(void *t0ctx)
 			T0_CO();
 		}
 	}
+	if (CTX->trust_anchor_dynamic != 0) {
+		const br_x509_trust_anchor *ta;
+		int r;
+
+		/*
+		 * The dynamic store is given the hashed issuer DN, the
+		 * anchor is released after the signature was verified.
+		 */
+		ta = CTX->trust_anchor_dynamic(CTX->trust_anchor_dynamic_ctx,
+			CTX->saved_dn_hash, DNHASH_LEN);
+		if (ta != NULL) {
+			r = verify_signature(CTX, &ta->pkey);
+			if (CTX->trust_anchor_dynamic_free != 0) {
+				CTX->trust_anchor_dynamic_free(
+					CTX->trust_anchor_dynamic_ctx, ta);
+			}
+			if (r == 0) {
+				CTX->err = BR_ERR_X509_OK;
+				T0_CO();
+			}
+		}
+	}
 
 				}
 				break;
@@ -29,6 +29,71 @@
 
 #include "BSSL_CertStore.h"
 
+namespace bssl
+{
+
+  void FlashCertStore::installCertStore(br_x509_minimal_context *ctx)
+  {
+    br_x509_minimal_set_dynamic(ctx, (void *)this, findHashedTA, freeHashedTA);
+  }
+
+  const br_x509_trust_anchor *FlashCertStore::find(const uint8_t *dn_hash)
+  {
+    size_t lo = 0, hi = _count;
+    while (lo < hi)
+    {
+      size_t mid = (lo + hi) / 2;
+      uint8_t hash[sizeof(_entry.dn_hash)];
+      memcpy_P(hash, _anchors[mid].dn_hash, sizeof(hash));
+      int cmp = memcmp(dn_hash, hash, sizeof(hash));
+      if (cmp == 0)
+      {
+        memcpy_P(&_entry, &_anchors[mid], sizeof(_entry));
+        memset(&_ta, 0, sizeof(_ta));
+        // The DN is not compared by the dynamic lookup, the hash is kept as the DN.
+        _ta.dn.data = _entry.dn_hash;
+        _ta.dn.len = sizeof(_entry.dn_hash);
+        _ta.flags = _entry.flags;
+        _ta.pkey.key_type = _entry.key_type;
+        if (_entry.key_type == BR_KEYTYPE_RSA)
+        {
+          _ta.pkey.key.rsa.n = (unsigned char *)_entry.key;
+          _ta.pkey.key.rsa.nlen = _entry.key_len;
+          _ta.pkey.key.rsa.e = (unsigned char *)_entry.exp;
+          _ta.pkey.key.rsa.elen = _entry.exp_len;
+        }
+        else
+        {
+          _ta.pkey.key.ec.curve = _entry.curve;
+          _ta.pkey.key.ec.q = (unsigned char *)_entry.key;
+          _ta.pkey.key.ec.qlen = _entry.key_len;
+        }
+        return &_ta;
+      }
+      if (cmp < 0)
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+    return nullptr;
+  }
+
+  const br_x509_trust_anchor *FlashCertStore::findHashedTA(void *ctx, void *hashed_dn, size_t len)
+  {
+    FlashCertStore *cs = static_cast<FlashCertStore *>(ctx);
+    if (!cs || len != sizeof(cs->_entry.dn_hash))
+      return nullptr;
+    return cs->find((const uint8_t *)hashed_dn);
+  }
+
+  void FlashCertStore::freeHashedTA(void *ctx, const br_x509_trust_anchor *ta)
+  {
+    (void)ctx; // The anchor is not allocated
+    (void)ta;
+  }
+
+}
+
 #if defined(ESP_SSL_FS_SUPPORTED)
 
 #include <memory>
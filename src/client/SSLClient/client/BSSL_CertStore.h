@@ -35,9 +35,6 @@
 #endif
 #endif
 
-#if defined(ESP_SSL_FS_SUPPORTED)
-
-
 #include "../bssl/bearssl.h"
 #include "BSSL_Helper.h"
 
@@ -59,6 +56,47 @@ namespace bssl
     virtual void installCertStore(br_x509_minimal_context *ctx) = 0;
   };
 
+  // The precompiled trust anchor in flash, see resources/tools/trust_anchors.py.
+  // The anchors of the table are sorted by the SHA-256 hash of their subject DN.
+  struct FlashTrustAnchor
+  {
+    uint8_t dn_hash[32];
+    uint8_t flags;    // BR_X509_TA_CA
+    uint8_t key_type; // BR_KEYTYPE_RSA or BR_KEYTYPE_EC
+    uint8_t curve;    // The EC curve (BR_EC_secp256r1, BR_EC_secp384r1 or BR_EC_secp521r1)
+    // The RSA modulus or EC point and the RSA exponent.
+    const uint8_t *key;
+    uint16_t key_len;
+    const uint8_t *exp;
+    uint16_t exp_len;
+  };
+
+  // The cert store of the trust anchor table in flash (PROGMEM), the anchor is found by binary search
+  // of the hashed issuer DN without parsing the certificate or allocating from heap.
+  class FlashCertStore : public CertStoreBase
+  {
+  public:
+    FlashCertStore(const FlashTrustAnchor *anchors, size_t count) : _anchors(anchors), _count(count) {}
+
+    // Installs the cert store into the X509 decoder (normally via static function callbacks)
+    void installCertStore(br_x509_minimal_context *ctx);
+
+    // Returns the anchor of the hashed subject DN or nullptr.
+    const br_x509_trust_anchor *find(const uint8_t *dn_hash);
+
+  protected:
+    const FlashTrustAnchor *_anchors = nullptr;
+    size_t _count = 0;
+    // The anchor that was found, its key data are kept in flash.
+    FlashTrustAnchor _entry;
+    br_x509_trust_anchor _ta;
+
+    static const br_x509_trust_anchor *findHashedTA(void *ctx, void *hashed_dn, size_t len);
+    static void freeHashedTA(void *ctx, const br_x509_trust_anchor *ta);
+  };
+
+#if defined(ESP_SSL_FS_SUPPORTED)
+
   class CertStore : public CertStoreBase
   {
   public:
@@ -92,10 +130,10 @@ namespace bssl
     static CertInfo _preprocessCert(uint32_t length, uint32_t offset, const void *raw);
   };
 
-};
-
 #endif
 
+};
+
 #endif
 
 #endif
@@ -293,11 +293,63 @@ namespace bssl
             br_x509_minimal_set_hash(x509, br_sha512_ID, &br_sha512_vtable);
         }
 
-        // Default initializion for our SSL clients
-        static void br_ssl_client_base_init(br_ssl_client_context *cc, const uint16_t *cipher_list, int cipher_cnt)
+        // Whether AES and GHASH of AES-GCM are accelerated by the CPU (AES-NI and PCLMULQDQ, or POWER8), it is checked at runtime.
+        static bool br_ssl_aes_gcm_accelerated()
+        {
+            return (br_aes_x86ni_ctr_get_vtable() && br_ghash_pclmul_get()) || (br_aes_pwr8_ctr_get_vtable() && br_ghash_pwr8_get());
+        }
+
+        // Move the ChaCha20 suites after the last ECDHE AES-GCM suite, the order of other suites is kept.
+        static void br_ssl_client_prefer_aes_gcm(uint16_t *suites, int cipher_cnt)
+        {
+            int last = -1;
+            for (int i = 0; i < cipher_cnt; i++)
+            {
+                if (suites[i] == BR_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256 || suites[i] == BR_TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256 ||
+                    suites[i] == BR_TLS_ECDHE_ECDSA_WITH_AES_256_GCM_SHA384 || suites[i] == BR_TLS_ECDHE_RSA_WITH_AES_256_GCM_SHA384)
+                    last = i;
+            }
+
+            for (int i = last - 1; i >= 0; i--)
+            {
+                if (suites[i] == BR_TLS_ECDHE_ECDSA_WITH_CHACHA20_POLY1305_SHA256 || suites[i] == BR_TLS_ECDHE_RSA_WITH_CHACHA20_POLY1305_SHA256)
+                {
+                    uint16_t suite = suites[i];
+                    memmove(&suites[i], &suites[i + 1], (last - i) * sizeof(suites[0]));
+                    suites[last--] = suite;
+                }
+            }
+        }
+
+        // Move the ChaCha20 suites before the first ECDHE AES-GCM suite, the order of other suites is kept.
+        static void br_ssl_client_prefer_chacha(uint16_t *suites, int cipher_cnt)
+        {
+            int first = -1;
+            for (int i = 0; i < cipher_cnt; i++)
+            {
+                if (first < 0 && (suites[i] == BR_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256 || suites[i] == BR_TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256 ||
+                                  suites[i] == BR_TLS_ECDHE_ECDSA_WITH_AES_256_GCM_SHA384 || suites[i] == BR_TLS_ECDHE_RSA_WITH_AES_256_GCM_SHA384))
+                    first = i;
+                else if (first > -1 && (suites[i] == BR_TLS_ECDHE_ECDSA_WITH_CHACHA20_POLY1305_SHA256 || suites[i] == BR_TLS_ECDHE_RSA_WITH_CHACHA20_POLY1305_SHA256))
+                {
+                    uint16_t suite = suites[i];
+                    memmove(&suites[first + 1], &suites[first], (i - first) * sizeof(suites[0]));
+                    suites[first++] = suite;
+                }
+            }
+        }
+
+        // Default initializion for our SSL clients, the suites are reordered for the CPU when cpu_order is true.
+        static void br_ssl_client_base_init(br_ssl_client_context *cc, const uint16_t *cipher_list, int cipher_cnt, bool cpu_order = false)
         {
             uint16_t suites[cipher_cnt];
             memcpy_P(suites, cipher_list, cipher_cnt * sizeof(cipher_list[0]));
+            // The accelerated AES-GCM is faster than ChaCha20 which is preferred on the MCU without AES hardware
+            // (the software AES and GHASH are constant-time bit-sliced implementations).
+            if (cpu_order && br_ssl_aes_gcm_accelerated())
+                br_ssl_client_prefer_aes_gcm(suites, cipher_cnt);
+            else if (cpu_order)
+                br_ssl_client_prefer_chacha(suites, cipher_cnt);
             br_ssl_client_zero(cc);
             br_ssl_engine_add_flags(&cc->eng, BR_OPT_NO_RENEGOTIATION); // forbid SSL renegotiation, as we free the Private Key after handshake
             br_ssl_engine_set_versions(&cc->eng, BR_TLS10, BR_TLS12);
@@ -317,6 +369,21 @@ namespace bssl
             br_ssl_engine_set_default_aes_ccm(&cc->eng);
             br_ssl_engine_set_default_des_cbc(&cc->eng);
             br_ssl_engine_set_default_chapol(&cc->eng);
+#endif
+            // The implementations that were pinned for the platform, see the SSLClient/Benchmark example.
+#if defined(ESP_SSLCLIENT_RSA_PUB_IMPL)
+            br_ssl_client_set_rsapub(cc, &ESP_SSLCLIENT_RSA_PUB_IMPL);
+#endif
+#if defined(ESP_SSLCLIENT_RSA_VRFY_IMPL)
+            br_ssl_engine_set_rsavrfy(&cc->eng, &ESP_SSLCLIENT_RSA_VRFY_IMPL);
+#endif
+#if !defined(BEARSSL_SSL_BASIC)
+#if defined(ESP_SSLCLIENT_EC_IMPL)
+            br_ssl_engine_set_ec(&cc->eng, &ESP_SSLCLIENT_EC_IMPL);
+#endif
+#if defined(ESP_SSLCLIENT_ECDSA_VRFY_IMPL)
+            br_ssl_engine_set_ecdsa(&cc->eng, &ESP_SSLCLIENT_ECDSA_VRFY_IMPL);
+#endif
 #endif
         }
 
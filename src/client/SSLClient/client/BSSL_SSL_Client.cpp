@@ -52,6 +52,10 @@
 #define ESP_SSLCLIENT_ESP8266_USE_EXTERNAL_HEAP
 #endif
 
+#if defined(ESP32) && defined(BOARD_HAS_PSRAM) && defined(ESP_SSLCLIENT_USE_PSRAM)
+#include <esp_heap_caps.h>
+#endif
+
 #if defined(USE_EMBED_SSL_ENGINE)
 #include <list>
 #include <errno.h>
@@ -86,7 +90,7 @@ BSSL_SSL_Client::BSSL_SSL_Client(Client *client)
     setClient(client);
     mClear();
     mClearAuthenticationSettings();
-#if defined(ESP_SSL_FS_SUPPORTED)
+#if defined(USE_LIB_SSL_ENGINE)
     _certStore = nullptr; // Don't want to remove cert store on a clear, should be long lived
 #endif
     _sk = nullptr;
@@ -151,6 +155,10 @@ uint8_t BSSL_SSL_Client::connected()
     if (!mIsClientInitialized(false))
         return 0;
 
+    // The connection is not usable until the handshake was completed by connectPoll.
+    if (_handshake_pending)
+        return 0;
+
     if (!_secure)
         return _basic_client->connected();
 
@@ -236,8 +244,8 @@ int BSSL_SSL_Client::available()
         esp_ssl_debug_print(PSTR("SSL Engine closed after update."), _debug_level, esp_ssl_debug_info, __func__);
 #endif
     }
-    // flush the buffer if it's stuck in the SENDAPP state
-    else if (state & BR_SSL_SENDAPP)
+    // flush the buffer if it's stuck in the SENDAPP state (unless it was corked)
+    else if (state & BR_SSL_SENDAPP && !_corked)
         br_ssl_engine_flush(_eng, 0);
     // other state, or client is closed
     return 0;
@@ -459,8 +467,101 @@ int BSSL_SSL_Client::connectSSL(const char *host, uint16_t port)
     return mConnectSSL(host);
 }
 
+int BSSL_SSL_Client::connectStart(const char *host, uint16_t port)
+{
+    if (!_isSSLEnabled || !mIsSecurePort(port))
+        return connect(host, port);
+
+    if (!mIsClientInitialized(true))
+        return 0;
+
+    if (!_basic_client->connected() && !mConnectBasicClient(host, IPAddress(), port))
+        return 0;
+
+    _host = host;
+    _port = port;
+
+    if (!mBeginSSL(host))
+        return 0;
+
+    _handshake_ms = millis();
+    _handshake_pending = true;
+    return 1;
+}
+
+int BSSL_SSL_Client::connectPoll()
+{
+    if (!_handshake_pending)
+        return connected() ? 1 : -1;
+
+    // Process the records that are available without waiting for the server.
+    unsigned state = mUpdateEngine();
+
+    bool timeout = millis() - _handshake_ms > _handshake_timeout;
+
+    if (state == 0 || state == BR_SSL_CLOSED || getWriteError() != esp_ssl_ok || timeout)
+    {
+#if defined(ESP_SSLCLIENT_ENABLE_DEBUG)
+        if (timeout)
+            esp_ssl_debug_print(PSTR("SSL internals timed out!"), _debug_level, esp_ssl_debug_error, __func__);
+        esp_ssl_debug_print(PSTR("Failed to initlalize the SSL layer."), _debug_level, esp_ssl_debug_error, __func__);
+        if (_sc)
+            mPrintSSLError(br_ssl_engine_last_error(_eng), esp_ssl_debug_error, __func__);
+#endif
+        if (timeout)
+            setWriteError(esp_ssl_write_error);
+        mFreeSSL();
+        if (_basic_client)
+            _basic_client->stop();
+        return -1;
+    }
+
+    if (state & BR_SSL_RECVAPP)
+        _recvapp_buf = br_ssl_engine_recvapp_buf(_eng, &_recvapp_len);
+    else if (!(state & BR_SSL_SENDAPP))
+        return 0;
+
+    _handshake_pending = false;
+    _write_idx = 0;
+    mEndSSL();
+    return 1;
+}
+
+// Keep the written data in the record buffer until uncork is called
+void BSSL_SSL_Client::cork()
+{
+    _corked = true;
+}
+
+// Close the record of the data that were written since cork and send it
+void BSSL_SSL_Client::uncork()
+{
+    if (!_corked)
+        return;
+
+    _corked = false;
+
+    if (!_secure || !_sc || !mSoftConnected(__func__))
+        return;
+
+    // acknowledge the pending data, close the record then write it to the socket
+    mUpdateEngine();
+    if (br_ssl_engine_current_state(_eng) & BR_SSL_SENDAPP)
+        br_ssl_engine_flush(_eng, 0);
+    mUpdateEngine();
+}
+
 void BSSL_SSL_Client::stop()
 {
+    // Abort the handshake that was started by connectStart.
+    if (_handshake_pending)
+    {
+        mFreeSSL();
+        if (_basic_client)
+            _basic_client->stop();
+        return;
+    }
+
     if (!_secure)
         return;
 
@@ -568,6 +669,20 @@ int BSSL_SSL_Client::availableForWrite()
 
 void BSSL_SSL_Client::setSession(BearSSL_Session *session) { _session = session; };
 
+void BSSL_SSL_Client::setHostIP(const IPAddress &ip)
+{
+    _host_ip = ip;
+    _host_ip_set = true;
+}
+
+void BSSL_SSL_Client::setALPN(const char **names, size_t count)
+{
+    _alpn_names = names;
+    _alpn_count = names ? count : 0;
+}
+
+const char *BSSL_SSL_Client::selectedProtocol() { return _sc && _alpn_count ? br_ssl_engine_get_selected_protocol(_eng) : nullptr; }
+
 // Assume a given public key, don't validate or use cert info at all
 void BSSL_SSL_Client::setKnownKey(const PublicKey *pk, unsigned usages)
 {
@@ -921,7 +1036,7 @@ int BSSL_SSL_Client::getLastSSLError(char *dest, size_t len)
 }
 
 // Attach a preconfigured certificate store
-#if defined(ESP_SSL_FS_SUPPORTED)
+#if defined(USE_LIB_SSL_ENGINE)
 void BSSL_SSL_Client::setCertStore(CertStoreBase *certStore)
 {
     _certStore = certStore;
@@ -954,6 +1069,11 @@ bool BSSL_SSL_Client::setCiphersLessSecure()
     return setCiphers(faster_suites_P, sizeof(faster_suites_P) / sizeof(faster_suites_P[0]));
 }
 
+void BSSL_SSL_Client::setCipherPolicy(esp_ssl_client_cipher_policy policy)
+{
+    _cipher_policy = policy;
+}
+
 bool BSSL_SSL_Client::setSSLVersion(uint32_t min, uint32_t max)
 {
     if (((min != BR_TLS10) && (min != BR_TLS11) && (min != BR_TLS12)) ||
@@ -1394,7 +1514,13 @@ int BSSL_SSL_Client::mConnectBasicClient(const char *host, IPAddress ip, uint16_
     if (!mConnectionValidate(host, ip, port))
         return 0;
 
-    if (!(host ? _basic_client->connect(host, port) : _basic_client->connect(ip, port)))
+    // The address of host is used once.
+    bool by_ip = !host || _host_ip_set;
+    if (host && _host_ip_set)
+        ip = _host_ip;
+    _host_ip_set = false;
+
+    if (!(by_ip ? _basic_client->connect(ip, port) : _basic_client->connect(host, port)))
     {
 #if defined(ESP_SSLCLIENT_ENABLE_DEBUG)
         esp_ssl_debug_print(PSTR("Failed to connect to server using basic client."), _debug_level, esp_ssl_debug_error, __func__);
@@ -1438,6 +1564,25 @@ bool BSSL_SSL_Client::mSoftConnected(const char *func_name)
 }
 
 int BSSL_SSL_Client::mConnectSSL(const char *host)
+{
+    if (!mBeginSSL(host))
+        return 0;
+
+    if (mRunUntil(BR_SSL_SENDAPP, _handshake_timeout) < 0)
+    {
+#if defined(ESP_SSLCLIENT_ENABLE_DEBUG)
+        esp_ssl_debug_print(PSTR("Failed to initlalize the SSL layer."), _debug_level, esp_ssl_debug_error, __func__);
+        mPrintSSLError(br_ssl_engine_last_error(_eng), esp_ssl_debug_error, __func__);
+#endif
+        mFreeSSL();
+        return 0;
+    }
+
+    mEndSSL();
+    return 1;
+}
+
+bool BSSL_SSL_Client::mBeginSSL(const char *host)
 {
 
 #if defined(ESP_SSLCLIENT_ENABLE_DEBUG)
@@ -1448,7 +1593,7 @@ int BSSL_SSL_Client::mConnectSSL(const char *host)
 
 #if defined(ESP_SSLCLIENT_ENABLE_DEBUG)
     // BearSSL will reject all connections unless an authentication option is set, warn in DEBUG builds
-#if defined(ESP_SSL_FS_SUPPORTED)
+#if defined(USE_LIB_SSL_ENGINE)
 #define CRTSTORECOND &&!_certStore
 #else
 #define CRTSTORECOND
@@ -1462,8 +1607,14 @@ int BSSL_SSL_Client::mConnectSSL(const char *host)
     _sc = std::make_shared<br_ssl_client_context>();
     _eng = &_sc->eng; // Allocation/deallocation taken care of by the _sc shared_ptr
 
-    _iobuf_in = (unsigned char *)mallocImpl(_iobuf_in_size);
-    _iobuf_out = (unsigned char *)mallocImpl(_iobuf_out_size);
+    // The I/O buffers are accessed on every record, keep them in internal RAM unless ESP_SSLCLIENT_IOBUF_USE_PSRAM is defined.
+#if defined(ESP_SSLCLIENT_IOBUF_USE_PSRAM)
+    bool internal = false;
+#else
+    bool internal = true;
+#endif
+    _iobuf_in = (unsigned char *)mallocImpl(_iobuf_in_size, true, internal);
+    _iobuf_out = (unsigned char *)mallocImpl(_iobuf_out_size, true, internal);
 
     if (!_sc || !_iobuf_in || !_iobuf_out)
     {
@@ -1472,14 +1623,14 @@ int BSSL_SSL_Client::mConnectSSL(const char *host)
 #if defined(ESP_SSLCLIENT_ENABLE_DEBUG)
         esp_ssl_debug_print(PSTR("OOM error."), _debug_level, esp_ssl_debug_error, __func__);
 #endif
-        return 0;
+        return false;
     }
 
     // If no cipher list yet set, use defaults
     if (!_cipher_list)
-        bssl::br_ssl_client_base_init(_sc.get(), suites_P, sizeof(suites_P) / sizeof(suites_P[0]));
+        bssl::br_ssl_client_base_init(_sc.get(), suites_P, sizeof(suites_P) / sizeof(suites_P[0]), true);
     else
-        bssl::br_ssl_client_base_init(_sc.get(), _cipher_list, _cipher_cnt);
+        bssl::br_ssl_client_base_init(_sc.get(), _cipher_list, _cipher_cnt, _cipher_policy == esp_ssl_cipher_policy_fastest);
 
     // Only failure possible in the installation is OOM
     if (!mInstallClientX509Validator())
@@ -1489,12 +1640,15 @@ int BSSL_SSL_Client::mConnectSSL(const char *host)
 #if defined(ESP_SSLCLIENT_ENABLE_DEBUG)
         esp_ssl_debug_print(PSTR("Can't install x509 validator."), _debug_level, esp_ssl_debug_error, __func__);
 #endif
-        return 0;
+        return false;
     }
 
     br_ssl_engine_set_buffers_bidi(_eng, _iobuf_in, _iobuf_in_size, _iobuf_out, _iobuf_out_size);
     br_ssl_engine_set_versions(_eng, _tls_min, _tls_max);
 
+    if (_alpn_count)
+        br_ssl_engine_set_protocol_names(_eng, _alpn_names, _alpn_count);
+
     // Apply any client certificates, if supplied.
     if (_sk && _sk->isRSA())
     {
@@ -1512,7 +1666,7 @@ int BSSL_SSL_Client::mConnectSSL(const char *host)
 #if defined(ESP_SSLCLIENT_ENABLE_DEBUG)
         esp_ssl_debug_print(PSTR("Attempting to use EC cert in minimal cipher mode (no EC)."), _debug_level, esp_ssl_debug_error, __func__);
 #endif
-        return 0;
+        return false;
 #endif
     }
     else if (_esp32_sk && _esp32_chain)
@@ -1550,7 +1704,7 @@ int BSSL_SSL_Client::mConnectSSL(const char *host)
 #endif
         setWriteError(esp_ssl_connection_fail);
         mFreeSSL();
-        return 0;
+        return false;
     }
 
 // SSL/TLS handshake
@@ -1558,16 +1712,11 @@ int BSSL_SSL_Client::mConnectSSL(const char *host)
     esp_ssl_debug_print(PSTR("Wait for SSL handshake."), _debug_level, esp_ssl_debug_info, __func__);
 #endif
 
-    if (mRunUntil(BR_SSL_SENDAPP, _handshake_timeout) < 0)
-    {
-#if defined(ESP_SSLCLIENT_ENABLE_DEBUG)
-        esp_ssl_debug_print(PSTR("Failed to initlalize the SSL layer."), _debug_level, esp_ssl_debug_error, __func__);
-        mPrintSSLError(br_ssl_engine_last_error(_eng), esp_ssl_debug_error, __func__);
-#endif
-        mFreeSSL();
-        return 0;
-    }
+    return true;
+}
 
+void BSSL_SSL_Client::mEndSSL()
+{
 #if defined(ESP_SSLCLIENT_ENABLE_DEBUG)
     esp_ssl_debug_print(PSTR("Connection successful!"), _debug_level, esp_ssl_debug_info, __func__);
 #endif
@@ -1583,8 +1732,6 @@ int BSSL_SSL_Client::mConnectSSL(const char *host)
     _x509_minimal = nullptr;
     _x509_insecure = nullptr;
     _x509_knownkey = nullptr;
-
-    return 1;
 }
 
 bool BSSL_SSL_Client::mConnectionValidate(const char *host, IPAddress ip, uint16_t port)
@@ -2001,6 +2148,7 @@ void BSSL_SSL_Client::mClear()
     _session = nullptr;
     freeImpl(&_cipher_list);
     _cipher_cnt = 0;
+    _cipher_policy = esp_ssl_cipher_policy_default;
     _tls_min = BR_TLS10;
     _tls_max = BR_TLS12;
     if (_esp32_ta)
@@ -2091,7 +2239,7 @@ bool BSSL_SSL_Client::mInstallClientX509Validator()
             // Magic constants convert to x509 times
             br_x509_minimal_set_time(_x509_minimal.get(), ((uint32_t)_now) / 86400 + 719528, ((uint32_t)_now) % 86400);
         }
-#if defined(ESP_SSL_FS_SUPPORTED)
+#if defined(USE_LIB_SSL_ENGINE)
         if (_certStore)
         {
             _certStore->installCertStore(_x509_minimal.get());
@@ -2116,6 +2264,8 @@ void BSSL_SSL_Client::mFreeSSL()
     _recvapp_len = 0;
     // This connection is toast
     _handshake_done = false;
+    _handshake_pending = false;
+    _corked = false;
     _timeout = 15000;
     _secure = false;
     _is_connected = false;
@@ -2139,13 +2289,22 @@ uint8_t *BSSL_SSL_Client::mStreamLoad(Stream &stream, size_t size)
 }
 
 // Allocate memory
-void *BSSL_SSL_Client::mallocImpl(size_t len, bool clear)
+void *BSSL_SSL_Client::mallocImpl(size_t len, bool clear, bool internal)
 {
     void *p;
     size_t newLen = getReservedLen(len);
 #if defined(BOARD_HAS_PSRAM) && defined(ESP_SSLCLIENT_USE_PSRAM)
 
-    if (ESP.getPsramSize() > 0)
+#if defined(ESP32)
+    if (internal && (p = heap_caps_malloc(newLen, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)) != NULL)
+    {
+        if (clear)
+            memset(p, 0, newLen);
+        return p;
+    }
+#endif
+
+    if (ESP.getPsramSize() > 0 && !internal)
         p = (void *)ps_malloc(newLen);
     else
         p = (void *)malloc(newLen);
@@ -2160,6 +2319,7 @@ void *BSSL_SSL_Client::mallocImpl(size_t len, bool clear)
 #endif
 
     p = (void *)malloc(newLen);
+    (void)internal;
     bool nn = p ? true : false;
 
 #if defined(ESP_SSLCLIENT_ESP8266_USE_EXTERNAL_HEAP)
@@ -128,6 +128,14 @@ public:
 
     int connectSSL(const char *host, uint16_t port);
 
+    int connectStart(const char *host, uint16_t port);
+
+    int connectPoll();
+
+    void cork();
+
+    void uncork();
+
     void stop() override;
 
     void setTimeout(unsigned int timeoutMs);
@@ -144,6 +152,15 @@ public:
 
     void setSession(BearSSL_Session *session);
 
+    // Set the address of host that is used by the next connection instead of host name lookup, the host name is still used for SNI and certificate validation.
+    void setHostIP(const IPAddress &ip);
+
+    // Set the protocol names (ALPN) that are offered in the handshake, the names should remain valid while they are used.
+    void setALPN(const char **names, size_t count);
+
+    // Returns the protocol name that was selected by server or nullptr.
+    const char *selectedProtocol();
+
     void setKnownKey(const PublicKey *pk, unsigned usages = BR_KEYTYPE_KEYX | BR_KEYTYPE_SIGN);
 
     bool setFingerprint(const uint8_t fingerprint[20]);
@@ -163,7 +180,7 @@ public:
     int getMFLNStatus();
 
     int getLastSSLError(char *dest, size_t len);
-#if defined(ESP_SSL_FS_SUPPORTED)
+#if defined(USE_LIB_SSL_ENGINE)
     void setCertStore(CertStoreBase *certStore);
 #endif
     bool setCiphers(const uint16_t *cipherAry, int cipherCount);
@@ -172,6 +189,8 @@ public:
 
     bool setCiphersLessSecure();
 
+    void setCipherPolicy(esp_ssl_client_cipher_policy policy);
+
     bool setSSLVersion(uint32_t min, uint32_t max);
 
     bool probeMaxFragmentLength(IPAddress ip, uint16_t port, uint16_t len);
@@ -238,6 +257,12 @@ private:
 
     int mConnectSSL(const char *host = nullptr);
 
+    // Set up the engine for the handshake of host.
+    bool mBeginSSL(const char *host);
+
+    // Set the connection states after the handshake was completed.
+    void mEndSSL();
+
     bool mConnectionValidate(const char *host, IPAddress ip, uint16_t port);
 
     int mRunUntil(const unsigned target, unsigned long timeout = 0);
@@ -264,7 +289,7 @@ private:
 
     uint8_t *mStreamLoad(Stream &stream, size_t size);
 
-    void *mallocImpl(size_t len, bool clear = true);
+    void *mallocImpl(size_t len, bool clear = true, bool internal = false);
 
     void freeImpl(void *ptr);
 
@@ -300,7 +325,7 @@ private:
 
     time_t _now = 0;
     const X509List *_ta = nullptr;
-#if defined(ESP_SSL_FS_SUPPORTED)
+#if defined(USE_LIB_SSL_ENGINE)
     CertStoreBase *_certStore = 0;
 #endif
     // Optional client certificate
@@ -323,6 +348,7 @@ private:
     // Custom cipher list pointer or nullptr if default
     uint16_t *_cipher_list = nullptr;
     uint8_t _cipher_cnt = 0;
+    uint8_t _cipher_policy = esp_ssl_cipher_policy_default;
 
     // TLS ciphers allowed
     uint32_t _tls_min = BR_TLS10;
@@ -333,6 +359,11 @@ private:
     PrivateKey *_esp32_sk = nullptr;
 
     bool _handshake_done = false;
+    // The handshake was started by connectStart and is advanced by connectPoll.
+    bool _handshake_pending = false;
+    // The written data are kept in the record buffer until uncork or the buffer is full.
+    bool _corked = false;
+    unsigned long _handshake_ms = 0;
     bool _oom_err = false;
     unsigned char *_recvapp_buf = nullptr;
     size_t _recvapp_len;
@@ -342,6 +373,10 @@ private:
     String _host;
     uint16_t _port = 0;
     IPAddress _ip;
+    IPAddress _host_ip;
+    bool _host_ip_set = false;
+    const char **_alpn_names = nullptr;
+    size_t _alpn_count = 0;
 };
 
 #endif
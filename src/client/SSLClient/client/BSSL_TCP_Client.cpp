@@ -260,6 +260,19 @@ bool BSSL_TCP_Client::connectSSL()
 
 bool BSSL_TCP_Client::connectSSL(const String host, uint16_t port) { return connectSSL(); }
 
+int BSSL_TCP_Client::connectStart(const char *host, uint16_t port)
+{
+    _host = host;
+    _port = port;
+    return _ssl_client.connectStart(host, port);
+}
+
+int BSSL_TCP_Client::connectPoll() { return _ssl_client.connectPoll(); }
+
+void BSSL_TCP_Client::cork() { _ssl_client.cork(); }
+
+void BSSL_TCP_Client::uncork() { _ssl_client.uncork(); }
+
 void BSSL_TCP_Client::stop()
 {
     _ssl_client.stop();
@@ -298,6 +311,12 @@ int BSSL_TCP_Client::availableForWrite() { return _ssl_client.availableForWrite(
 
 void BSSL_TCP_Client::setSession(BearSSL_Session *session) { _ssl_client.setSession(session); };
 
+void BSSL_TCP_Client::setHostIP(const IPAddress &ip) { _ssl_client.setHostIP(ip); }
+
+void BSSL_TCP_Client::setALPN(const char **names, size_t count) { _ssl_client.setALPN(names, count); }
+
+const char *BSSL_TCP_Client::selectedProtocol() { return _ssl_client.selectedProtocol(); }
+
 void BSSL_TCP_Client::setKnownKey(const PublicKey *pk, unsigned usages)
 {
     _ssl_client.setKnownKey(pk, usages);
@@ -345,7 +364,7 @@ int BSSL_TCP_Client::getLastSSLError(char *dest, size_t len)
     return _ssl_client.getLastSSLError(dest, len);
 }
 
-#if defined(ESP_SSL_FS_SUPPORTED)
+#if defined(USE_LIB_SSL_ENGINE)
 void BSSL_TCP_Client::setCertStore(CertStoreBase *certStore)
 {
     _ssl_client.setCertStore(certStore);
@@ -367,6 +386,11 @@ bool BSSL_TCP_Client::setCiphersLessSecure()
     return _ssl_client.setCiphersLessSecure();
 }
 
+void BSSL_TCP_Client::setCipherPolicy(esp_ssl_client_cipher_policy policy)
+{
+    _ssl_client.setCipherPolicy(policy);
+}
+
 bool BSSL_TCP_Client::setSSLVersion(uint32_t min, uint32_t max)
 {
     return _ssl_client.setSSLVersion(min, max);
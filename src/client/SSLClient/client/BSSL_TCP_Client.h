@@ -294,6 +294,37 @@ public:
      */
     bool connectSSL(const String host, uint16_t port);
 
+    /**
+     * Connect to server and start the SSL handshake without waiting for it to complete.
+     *
+     * The handshake is advanced by connectPoll, the connection is not connected until connectPoll returns 1.
+     * The plain (non-SSL) connection is connected when this function returns.
+     *
+     * @param host The server host name.
+     * @param port The server port.
+     * @return 1 when the connection or handshake was started or 0 when failed.
+     */
+    int connectStart(const char *host, uint16_t port);
+
+    /**
+     * Advance the SSL handshake that was started by connectStart with the data that are available.
+     *
+     * @return 1 when the handshake was completed, 0 when it is in progress or -1 when failed or timed out.
+     */
+    int connectPoll();
+
+    /**
+     * Keep the data that are written in the SSL record buffer instead of sending the partial records.
+     *
+     * The records are sent only when the buffer is full until uncork is called.
+     */
+    void cork();
+
+    /**
+     * Send the data that were written since cork in the last record.
+     */
+    void uncork();
+
     /**
      * Stop the TCP connection and release resources.
      */
@@ -335,6 +366,26 @@ public:
 
     void setSession(BearSSL_Session *session);
 
+    /**
+     * Set the address of host that is used by the next connection instead of host name lookup.
+     * @param ip The address of host.
+     * The host name that passes to connect is still used for SNI and certificate validation.
+     */
+    void setHostIP(const IPAddress &ip);
+
+    /**
+     * Set the protocol names (ALPN) that are offered in the handshake e.g. "h2" and "http/1.1".
+     * @param names The array of protocol names that should remain valid while they are used.
+     * @param count The numbers of protocol names.
+     */
+    void setALPN(const char **names, size_t count);
+
+    /**
+     * Get the protocol name that was selected by server in the handshake.
+     * @return The protocol name or nullptr when the server did not select the protocol.
+     */
+    const char *selectedProtocol();
+
     void setKnownKey(const PublicKey *pk, unsigned usages = BR_KEYTYPE_KEYX | BR_KEYTYPE_SIGN);
 
     /**
@@ -360,7 +411,7 @@ public:
     int getMFLNStatus();
 
     int getLastSSLError(char *dest = NULL, size_t len = 0);
-#if defined(ESP_SSL_FS_SUPPORTED)
+#if defined(USE_LIB_SSL_ENGINE)
     void setCertStore(CertStoreBase *certStore);
 #endif
     bool setCiphers(const uint16_t *cipherAry, int cipherCount);
@@ -369,6 +420,16 @@ public:
 
     bool setCiphersLessSecure();
 
+    /**
+     * Set the cipher suites ordering policy.
+     *
+     * @param policy The esp_ssl_cipher_policy_default keeps the order of custom cipher list (setCiphers) or
+     * esp_ssl_cipher_policy_fastest which prefers the AES-GCM suites when AES and GHASH are accelerated by the CPU
+     * or ChaCha20-Poly1305 suites otherwise (ESP8266, ESP32, RP2040 etc.).
+     * The default cipher list is always ordered for the CPU.
+     */
+    void setCipherPolicy(esp_ssl_client_cipher_policy policy);
+
     bool setSSLVersion(uint32_t min = BR_TLS10, uint32_t max = BR_TLS12);
 
     bool probeMaxFragmentLength(IPAddress ip, uint16_t port, uint16_t len);
@@ -32,14 +32,51 @@ using namespace firebase;
 #if defined(ENABLE_CLOUD_STORAGE)
 
 #include "./cloud_storage/DataOptions.h"
+#include "./core/RangeDownload.h"
+#include "./cloud_storage/ComposeUpload.h"
+#include "./core/ListIterator.h"
+#include "./core/ObjectMetaCache.h"
 
 class CloudStorage
 {
 
 public:
-    std::vector<uint32_t> cVec; // AsyncClient vector
+    std::vector<list_handle_t> cVec; // AsyncClient handles
 
-    ~CloudStorage() {}
+    ~CloudStorage()
+    {
+        for (size_t i = 0; i < rangeVec.size(); i++)
+        {
+            range_task_t *t = rangeVec[i];
+            if (t)
+                delete t;
+        }
+        rangeVec.clear();
+
+        for (size_t i = 0; i < composeVec.size(); i++)
+        {
+            compose_task_t *t = composeVec[i];
+            if (t)
+                delete t;
+        }
+        composeVec.clear();
+
+        for (size_t i = 0; i < listVec.size(); i++)
+        {
+            list_task_t *t = listVec[i];
+            if (t)
+                delete t;
+        }
+        listVec.clear();
+
+        for (size_t i = 0; i < iterVec.size(); i++)
+        {
+            ListIterator *it = iterVec[i];
+            if (it)
+                it->ivec = nullptr;
+        }
+        iterVec.clear();
+    }
     CloudStorage(const String &url = "")
     {
         this->service_url = url;
@@ -60,40 +97,50 @@ public:
         this->service_url = url;
     }
 
-    void setApp(uint32_t app_addr, app_token_t *app_token, uint32_t avec_addr)
+    /**
+     * Open the connection to the Google Cloud Storage host and refresh the token that is going to expire before the requests are sent.
+     *
+     * ### Example
+     * ```cpp
+     * // The sensor interrupt was triggered, the data will be sent soon.
+     * cstorage.warmUp(aClient);
+     * ```
+     * @param aClient The async client.
+     * @return bool true when the connect task was added (see AsyncClientClass::preconnect).
+     */
+    bool warmUp(AsyncClientClass &aClient)
     {
-        this->app_addr = app_addr;
-        this->app_token = app_token;
-        this->avec_addr = avec_addr; // AsyncClient vector (list) address
+        return aClient.warmUp(app_handle, cVec, FPSTR("storage.googleapis.com"));
     }
 
-    app_token_t *appToken()
+    void setApp(list_handle_t app_handle, app_token_t *app_token)
     {
-        if (avec_addr > 0)
-        {
-            std::vector<uint32_t> *cVec = reinterpret_cast<std::vector<uint32_t> *>(avec_addr);
-            List vec;
-            if (cVec)
-                return vec.existed(*cVec, app_addr) ? app_token : nullptr;
-        }
-        return nullptr;
+        this->app_handle = app_handle;
+        this->app_token = app_token;
     }
 
+    // Returns the token of app or nullptr when the app was destroyed.
+    app_token_t *appToken() { return Registry::shared().get(app_handle) ? app_token : nullptr; }
+
     /**
      * Perform the async task repeatedly.
      * Should be places in main loop function.
      */
     void loop()
     {
+        List vec;
         for (size_t i = 0; i < cVec.size(); i++)
         {
-            AsyncClientClass *aClient = reinterpret_cast<AsyncClientClass *>(cVec[i]);
+            AsyncClientClass *aClient = Registry::shared().get<AsyncClientClass>(vec.at(cVec, i));
             if (aClient)
             {
                 aClient->process(true);
                 aClient->handleRemove();
             }
         }
+        handleRangeDownload();
+        handleComposeUpload();
+        handleListIterator();
     }
 
     /** Download object from the Google Cloud Storage.
@@ -151,6 +198,37 @@ public:
         sendRequest(aClient, nullptr, cb, uid, parent, file, &options, nullptr, nullptr, GoogleCloudStorage::google_cloud_storage_request_type_download, true);
     }
 
+    /** Download object from the Google Cloud Storage in byte ranges that are fetched concurrently.
+     *
+     * @param aClient The async client, the ranges are limited to the numbers of its connections (see AsyncClientClass::addClient).
+     * @param parent The GoogleCloudStorage::Parent object included Storage bucket Id and object in its constructor.
+     * The bucketid is the Storage bucket Id of object to download.
+     * The object is the object in Storage bucket to download.
+     * @param file The filesystem data (file_config_data) obtained from FileConfig or BlobConfig class object.
+     * @param options Optional. The GoogleCloudStorage::GetOptions that holds the get options.
+     * For the get options, see https://cloud.google.com/storage/docs/json_api/v1/objects/get#optional-parameters
+     * @param parts The numbers of concurrent ranges (up to FIREBASE_RANGE_DOWNLOAD_PARTS_LIMIT).
+     * @param cb The async result callback (AsyncResultCallback) that receives the download progress and the result.
+     * @param uid The user specified UID of async result (optional).
+     *
+     * The size and generation of object are read from its metadata before the ranges are requested, all ranges are
+     * requested from the same generation. The file is written in order, the range of FIREBASE_RANGE_DOWNLOAD_BUFFER_SIZE
+     * bytes that arrives before the preceding ranges is kept in its reorder buffer. The blob is split equally and each
+     * range is written at its offset.
+     *
+     * This function requires CloudStorage::loop to be called in the main loop.
+     *
+     */
+    void parallelDownload(AsyncClientClass &aClient, const GoogleCloudStorage::Parent &parent, file_config_data file, GoogleCloudStorage::GetOptions &options, uint8_t parts, AsyncResultCallback cb, const String &uid = "")
+    {
+        range_task_t *t = new range_task_t(&aClient, parent, options, file, parts < aClient.clientCount() ? parts : aClient.clientCount(), cb, uid);
+        rangeVec.push_back(t);
+
+        // The metadata is always requested, the cached size and generation of object that was changed after it was cached can't be used.
+        file_config_data meta;
+        sendRequest(aClient, &t->download.meta, NULL, uid, parent, meta, &options, nullptr, nullptr, GoogleCloudStorage::google_cloud_storage_request_type_get_meta, true);
+    }
+
     /** Upload file to the Google Cloud Storage.
      *
      * @param aClient The async client.
@@ -210,6 +288,53 @@ public:
         sendRequest(aClient, nullptr, cb, uid, parent, file, nullptr, &options, nullptr, GoogleCloudStorage::google_cloud_storage_request_type_uploads, true);
     }
 
+    /** Upload file or blob to the Google Cloud Storage in parts that are uploaded concurrently.
+     *
+     * @param aClient The async client.
+     * @param parent The GoogleCloudStorage::Parent object included Storage bucket Id and object in its constructor.
+     * The bucketid is the Storage bucket Id of object to upload.
+     * The object is the object to be stored in the Storage bucket.
+     * @param file The filesystem data (file_config_data) obtained from FileConfig or BlobConfig class object.
+     * @param options The GoogleCloudStorage::uploadOptions, the mime and insert properties (options.insertProps) are set to the composed object.
+     * @param parts The number of parts, it is limited by the number of connections in pool of async client and FIREBASE_COMPOSITE_UPLOAD_PARTS_LIMIT.
+     * @param cb The async result callback (AsyncResultCallback).
+     * @param uid The user specified UID of async result (optional).
+     *
+     * The parts are uploaded as the temporary objects "<object>.part<n>" by the connections in pool of async client
+     * (see AsyncClientClass::addClient), composed into the object then deleted.
+     * The upload is performed by upload function when only one connection or part is available.
+     *
+     * This function requires CloudStorage::loop to be called in the main loop.
+     *
+     */
+    void parallelUpload(AsyncClientClass &aClient, const GoogleCloudStorage::Parent &parent, file_config_data &file, GoogleCloudStorage::uploadOptions &options, uint8_t parts, AsyncResultCallback cb, const String &uid = "")
+    {
+        if (parts > aClient.clientCount())
+            parts = aClient.clientCount();
+
+        if (parts < 2)
+            return sendRequest(aClient, nullptr, cb, uid, parent, file, nullptr, &options, nullptr, GoogleCloudStorage::google_cloud_storage_request_type_uploads, true);
+
+        compose_task_t *t = new compose_task_t(&aClient, parent, file, parts, cb, uid);
+
+        t->destination = options.insertProps.c_str();
+        if (options.mime.length())
+        {
+            JSONUtil jut;
+            String mime;
+            jut.addObject(mime, "contentType", options.mime, true, true);
+            if (t->destination.length())
+            {
+                ObjectWriter owriter;
+                owriter.addMember(t->destination, mime, false, "}");
+            }
+            else
+                t->destination = mime;
+        }
+
+        composeVec.push_back(t);
+    }
+
     /** Perform OTA update using a firmware (object) from the Google Cloud Storage.
      *
      * @param aClient The async client.
@@ -320,6 +445,73 @@ public:
         sendRequest(aClient, nullptr, cb, uid, parent, file, &options, nullptr, nullptr, GoogleCloudStorage::google_cloud_storage_request_type_get_meta, true);
     }
 
+    /** Checks if the object exists in Google Cloud Storage data bucket.
+     *
+     * The metadata is requested as the header-only request, its payload is discarded as it arrives.
+     *
+     * @param aClient The async client.
+     * @param parent The GoogleCloudStorage::Parent object included Storage bucket Id and object in its constructor.
+     *
+     * @return Boolean value, indicates the object exists.
+     *
+     */
+    bool existed(AsyncClientClass &aClient, const GoogleCloudStorage::Parent &parent)
+    {
+        AsyncResult result;
+        file_config_data file;
+        GoogleCloudStorage::GetOptions options;
+        aClient.setHeaderOnly(false);
+        sendRequest(aClient, &result, NULL, "", parent, file, &options, nullptr, nullptr, GoogleCloudStorage::google_cloud_storage_request_type_get_meta, false);
+        // The probe is not used when the request was not added.
+        aClient.reqProbe = false;
+        return result.probeInfo().code == FIREBASE_ERROR_HTTP_CODE_OK;
+    }
+
+    /** Get the cached metadata of object in Google Cloud Storage data bucket.
+     *
+     * @param parent The GoogleCloudStorage::Parent object included Storage bucket Id and object in its constructor.
+     * @param meta The object_meta_t that receives the generation, size, md5 hash and ETag of object.
+     *
+     * @return Boolean value, indicates the metadata was cached within FIREBASE_OBJECT_META_CACHE_TTL milliseconds.
+     *
+     * The metadata is cached from the responses of getMetadata, upload and compose, and removed by deleteObject.
+     *
+     */
+    bool getCachedMetadata(const GoogleCloudStorage::Parent &parent, object_meta_t &meta) { return meta_cache.get(ObjectMetaCache::key(parent.getBucketId(), parent.getObject()), meta, FIREBASE_OBJECT_META_CACHE_TTL); }
+
+    /** Clear the cached metadata of objects and the ETag of downloaded files.
+     */
+    void clearMetadataCache()
+    {
+        meta_cache.clear();
+        download_cache.clear();
+        download_state.reset();
+    }
+
+    /** Set the conditional download of file.
+     *
+     * @param enable The boolean value to enable the conditional download.
+     *
+     * When enabled, the file download sends the ETag of last completed download of the same object and file (If-None-Match),
+     * the file is kept and the download is skipped when the object was not modified.
+     *
+     */
+    void setConditionalDownload(bool enable) { conditional_download = enable; }
+
+#if defined(ENABLE_FS)
+    /** Set the callback to persist the session of resumable upload across reboot.
+     *
+     * @param cb The ResumableStoreCallback to save (save is true) or load (save is false) the session data (String)
+     * to or from the storage e.g. NVS or filesystem, the empty data is saved when the session was completed or expired.
+     *
+     * The session URI and the committed offset are saved when the session was initiated and when each range was committed.
+     * The resumable upload of the same object and file (of the same size) continues the stored session,
+     * the committed offset is queried from server and the upload continues from that offset.
+     *
+     */
+    void setResumableStore(ResumableStoreCallback cb) { upload_session.cb = cb; }
+#endif
+
     /** List all objects in Google Cloud Storage data bucket.
      *
      * @param aClient The async client.
@@ -371,6 +563,31 @@ public:
         sendRequest(aClient, nullptr, cb, uid, parent, file, nullptr, nullptr, &options, GoogleCloudStorage::google_cloud_storage_request_type_list, true);
     }
 
+    /** List all objects in Google Cloud Storage data bucket page by page via the list iterator.
+     *
+     * @param aClient The async client.
+     * @param parent The GoogleCloudStorage::Parent object included Storage bucket Id in its constructor.
+     * The bucketid is the Storage bucket Id to list all objects.
+     * @param options The GoogleCloudStorage::ListOptions that holds the list options.
+     * The page token is set by the iterator and the maxResults is FIREBASE_LIST_PAGE_SIZE when it was not set.
+     * @param it The list iterator (ListIterator) that the object entries are taken from by ListIterator::next.
+     *
+     * The pages are requested in order, the next page is requested while the entries of current page are taken.
+     * The listing was finished when ListIterator::isDone returns true.
+     *
+     * This function requires CloudStorage::loop to be called in the main loop.
+     *
+     */
+    void list(AsyncClientClass &aClient, const GoogleCloudStorage::Parent &parent, GoogleCloudStorage::ListOptions &options, ListIterator &it)
+    {
+        releaseIterator(it);
+        it.attach(iterVec);
+        list_task_t *t = new list_task_t(&aClient, parent, options, &it, &iterVec);
+        if (!strstr(t->options.c_str(), "maxResults="))
+            t->options.maxResults(FIREBASE_LIST_PAGE_SIZE);
+        listVec.push_back(t);
+    }
+
     /** Delete the object in Google Cloud Storage data bucket.
      *
      * @param aClient The async client.
@@ -432,17 +649,241 @@ private:
     String path;
     String uid;
     // FirebaseApp address and FirebaseApp vector address
-    uint32_t app_addr = 0, avec_addr = 0;
+    list_handle_t app_handle = 0;
     app_token_t *app_token = nullptr;
     Memory mem;
+#if defined(ENABLE_FS)
+    // The range size of resumable upload that was adapted.
+    resumable_range_state_t range_state;
+    // The session of resumable upload that is persisted with the ResumableStoreCallback.
+    resumable_session_t upload_session;
+#endif
+    // The progress of download that is resumed by range request.
+    download_resume_state_t download_state;
+    // The progress of OTA update that is resumed by range request.
+    download_resume_state_t ota_state;
+    // The metadata of objects and the ETag of downloaded files (keyed by download target).
+    ObjectMetaCache meta_cache, download_cache;
+    bool conditional_download = false;
+
+    static void onObjectMeta(void *ctx, AsyncResult &aResult)
+    {
+        ObjectMetaCache *cache = static_cast<ObjectMetaCache *>(ctx);
+        if (cache && aResult.c_str())
+            cache->update(aResult.c_str());
+    }
+
+    // The response of these requests is the object resource.
+    bool isObjectResource(GoogleCloudStorage::google_cloud_storage_request_type requestType)
+    {
+        return requestType != GoogleCloudStorage::google_cloud_storage_request_type_download &&
+               requestType != GoogleCloudStorage::google_cloud_storage_request_type_download_ota &&
+               requestType != GoogleCloudStorage::google_cloud_storage_request_type_list &&
+               requestType != GoogleCloudStorage::google_cloud_storage_request_type_delete &&
+               requestType != GoogleCloudStorage::google_cloud_storage_request_type_upload_resumable_init;
+    }
+
+    struct range_task_t
+    {
+    public:
+        RangeDownload download;
+        AsyncClientClass *aClient = nullptr;
+        GoogleCloudStorage::Parent parent;
+        GoogleCloudStorage::GetOptions options;
+        bool pinned = false;
+
+        range_task_t(AsyncClientClass *aClient, const GoogleCloudStorage::Parent &parent, const GoogleCloudStorage::GetOptions &options, const file_config_data &file, uint8_t parts, AsyncResultCallback cb, const String &uid)
+            : download(file, parts, cb, uid), aClient(aClient), parent(parent), options(options) {}
+    };
 
-    void sendRequest(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const GoogleCloudStorage::Parent &parent, file_config_data &file, GoogleCloudStorage::BaseOptions *baseOptions, GoogleCloudStorage::uploadOptions *uploadOptions, GoogleCloudStorage::ListOptions *listOptions, GoogleCloudStorage::google_cloud_storage_request_type requestType, bool async)
+    std::vector<range_task_t *> rangeVec; // range_task_t vector
+
+    struct compose_task_t
+    {
+    public:
+        ComposeUpload upload;
+        AsyncClientClass *aClient = nullptr;
+        GoogleCloudStorage::Parent parent;
+        // The destination object resource of compose request.
+        String destination;
+
+        compose_task_t(AsyncClientClass *aClient, const GoogleCloudStorage::Parent &parent, const file_config_data &file, uint8_t parts, AsyncResultCallback cb, const String &uid)
+            : upload(file, parent.getObject(), parts, cb, uid), aClient(aClient), parent(parent) {}
+    };
+
+    std::vector<compose_task_t *> composeVec; // compose_task_t vector
+
+    struct list_task_t
+    {
+    public:
+        ListPage page;
+        AsyncClientClass *aClient = nullptr;
+        GoogleCloudStorage::Parent parent;
+        GoogleCloudStorage::ListOptions options;
+
+        list_task_t(AsyncClientClass *aClient, const GoogleCloudStorage::Parent &parent, const GoogleCloudStorage::ListOptions &options, ListIterator *it, std::vector<ListIterator *> *iVec)
+            : page(it, iVec, ""), aClient(aClient), parent(parent), options(options) {}
+    };
+
+    std::vector<list_task_t *> listVec; // list_task_t vector
+    std::vector<ListIterator *> iterVec; // ListIterator vector
+
+    void releaseIterator(ListIterator &it)
+    {
+        // The pages that were in progress are not written to the iterator that is listed again.
+        for (size_t i = 0; i < listVec.size(); i++)
+        {
+            list_task_t *t = listVec[i];
+            if (t)
+                t->page.release(&it);
+        }
+    }
+
+    void handleListIterator()
+    {
+        for (size_t i = listVec.size(); i > 0; i--)
+        {
+            list_task_t *t = listVec[i - 1];
+            if (!t)
+                continue;
+
+            if (!t->page.process())
+            {
+                if (!t->page.busy)
+                {
+                    listVec.erase(listVec.begin() + i - 1);
+                    delete t;
+                }
+                continue;
+            }
+
+            if (t->page.nextRequest())
+            {
+                if (t->page.token.length())
+                {
+                    URLUtil uut;
+                    t->options.pageToken(uut.encode(t->page.token));
+                }
+                file_config_data file;
+                t->aClient->setPayloadSink(t->page);
+                sendRequest(*t->aClient, &t->page.result, NULL, t->page.uid, t->parent, file, nullptr, nullptr, &t->options, GoogleCloudStorage::google_cloud_storage_request_type_list, true);
+                // The sink is not used when the request was not added.
+                t->aClient->reqSink = nullptr;
+            }
+        }
+    }
+
+    void handleRangeDownload()
+    {
+        for (size_t i = rangeVec.size(); i > 0; i--)
+        {
+            range_task_t *t = rangeVec[i - 1];
+            if (!t)
+                continue;
+
+            if (!t->download.process())
+            {
+                if (!t->download.busy())
+                {
+                    rangeVec.erase(rangeVec.begin() + i - 1);
+                    delete t;
+                }
+                continue;
+            }
+
+            // The ranges of the object that was replaced during download are not mixed.
+            if (!t->pinned && t->download.generation.length())
+            {
+                t->options.generation(strtoull(t->download.generation.c_str(), nullptr, 10));
+                t->pinned = true;
+            }
+
+            RangeDownload::part_t *p = nullptr;
+            while ((p = t->download.nextRequest()) != nullptr)
+            {
+                file_config_data file;
+                sendRequest(*t->aClient, &p->result, NULL, t->download.uid, t->parent, file, &t->options, nullptr, nullptr, GoogleCloudStorage::google_cloud_storage_request_type_download, true, p);
+            }
+        }
+    }
+
+    void handleComposeUpload()
+    {
+        for (size_t i = composeVec.size(); i > 0; i--)
+        {
+            compose_task_t *t = composeVec[i - 1];
+            if (!t)
+                continue;
+
+            if (!t->upload.process())
+            {
+                if (!t->upload.busy())
+                {
+                    composeVec.erase(composeVec.begin() + i - 1);
+                    delete t;
+                }
+                continue;
+            }
+
+            ComposeUpload::part_t *p = nullptr;
+            while ((p = t->upload.nextUpload()) != nullptr)
+            {
+                // The part is uploaded as is, the metadata is set to the composed object.
+                GoogleCloudStorage::uploadOptions options;
+                options.uploadType = GoogleCloudStorage::upload_type_simple;
+                options.mime = FPSTR("application/octet-stream");
+                file_config_data file;
+                t->upload.partFile(p, file);
+                sendRequest(*t->aClient, &p->result, NULL, t->upload.uid, GoogleCloudStorage::Parent(t->parent.getBucketId(), p->name), file, nullptr, &options, nullptr, GoogleCloudStorage::google_cloud_storage_request_type_uploads, true);
+            }
+
+            if (t->upload.composeRequest())
+                composeRequest(t);
+
+            while ((p = t->upload.nextDelete()) != nullptr)
+            {
+                // The empty response of delete request completes the result via the sink.
+                GoogleCloudStorage::DeleteOptions options;
+                file_config_data file;
+                t->aClient->setPayloadSink(*p);
+                sendRequest(*t->aClient, &p->result, NULL, t->upload.uid, GoogleCloudStorage::Parent(t->parent.getBucketId(), p->name), file, &options, nullptr, nullptr, GoogleCloudStorage::google_cloud_storage_request_type_delete, true);
+                // The sink is not used when the request was not added.
+                t->aClient->reqSink = nullptr;
+            }
+        }
+    }
+
+    void composeRequest(compose_task_t *t)
+    {
+        JSONUtil jut;
+        String sources;
+        for (size_t i = 0; i < t->upload.parts.size(); i++)
+        {
+            String source;
+            jut.addObject(source, "name", t->upload.parts[i]->name, true, true);
+            sources += i == 0 ? '[' : ',';
+            sources += source;
+        }
+        sources += ']';
+
+        GoogleCloudStorage::DataOptions options;
+        options.requestType = GoogleCloudStorage::google_cloud_storage_request_type_compose;
+        options.parent = t->parent;
+        jut.addObject(options.payload, "sourceObjects", sources, false, t->destination.length() == 0);
+        if (t->destination.length())
+            jut.addObject(options.payload, "destination", t->destination, false, true);
+
+        GoogleCloudStorage::async_request_data_t aReq(t->aClient, path, async_request_handler_t::http_post, slot_options_t(false, false, true, false, false, false), &options, nullptr, &t->upload.result, NULL, t->upload.uid);
+        asyncRequest(aReq);
+    }
+
+    void sendRequest(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const GoogleCloudStorage::Parent &parent, file_config_data &file, GoogleCloudStorage::BaseOptions *baseOptions, GoogleCloudStorage::uploadOptions *uploadOptions, GoogleCloudStorage::ListOptions *listOptions, GoogleCloudStorage::google_cloud_storage_request_type requestType, bool async, RangeDownload::part_t *part = nullptr)
     {
         GoogleCloudStorage::DataOptions options;
         options.requestType = requestType;
         options.parent = parent;
 
-        if (uploadOptions && strlen(uploadOptions->insertProps.c_str()) && (uploadOptions->uploadType == GoogleCloudStorage::upload_type_multipart || uploadOptions->uploadType == GoogleCloudStorage::upload_type_resumable))
+        if (uploadOptions && strlen(uploadOptions->insertProps.c_str()) && !file.chunked() && (uploadOptions->uploadType == GoogleCloudStorage::upload_type_multipart || uploadOptions->uploadType == GoogleCloudStorage::upload_type_resumable))
             options.payload = uploadOptions->insertProps.c_str();
 
         async_request_handler_t::http_request_method method = async_request_handler_t::http_post;
@@ -466,7 +907,8 @@ private:
             if (requestType == GoogleCloudStorage::google_cloud_storage_request_type_uploads)
             {
                 options.extras += "&uploadType=";
-                if (uploadOptions && uploadOptions->uploadType == GoogleCloudStorage::upload_type_simple)
+                // The data of unknown length is sent without metadata.
+                if (file.chunked() || (uploadOptions && uploadOptions->uploadType == GoogleCloudStorage::upload_type_simple))
                     options.extras += "media";
                 else if (uploadOptions && uploadOptions->uploadType == GoogleCloudStorage::upload_type_multipart)
                     options.extras += "multipart";
@@ -480,12 +922,18 @@ private:
                         options.extras += file.file.size() < 256 * 1024 ? "multipart" : "resumable";
                         file.file.close();
                     }
+                    // The blob and producer source are uploaded in one request.
+                    else
+                        options.extras += "multipart";
 #endif
                 }
             }
         }
         else if (requestType == GoogleCloudStorage::google_cloud_storage_request_type_delete)
+        {
             method = async_request_handler_t::http_delete;
+            meta_cache.remove(ObjectMetaCache::key(parent.getBucketId(), parent.getObject()));
+        }
 
         if (baseOptions && strlen(baseOptions->c_str()))
         {
@@ -508,11 +956,49 @@ private:
         if (uploadOptions && uploadOptions->mime.length() && requestType == GoogleCloudStorage::google_cloud_storage_request_type_uploads)
             aReq.mime = uploadOptions->mime;
 
+        if (part)
+        {
+            aReq.sink = part;
+            aReq.range_first = part->pos;
+            aReq.range_last = part->end - 1;
+        }
+
+#if defined(ENABLE_FS)
+        if (uploadOptions && uploadOptions->uploadType == GoogleCloudStorage::upload_type_resumable)
+        {
+            // The adaptive range size begins with the range size of previous upload.
+            range_state.adaptive = uploadOptions->adaptiveRange;
+            if (!range_state.adaptive || range_state.units == 0)
+                range_state.units = uploadOptions->rangeUnits ? uploadOptions->rangeUnits : FIREBASE_RESUMABLE_RANGE_UNITS;
+            aReq.range_state = &range_state;
+            aReq.slice_size = uploadOptions->sliceSize;
+        }
+#endif
+
         asyncRequest(aReq);
     }
 
+#if defined(ENABLE_FS)
+    // The CRC32C of the opened upload file, the stored session is not continued after the file content was changed.
+    String fileHash(file_config_data &file)
+    {
+        TransferHash hash;
+        hash_data_t out;
+        uint8_t buf[128];
+        int n = 0;
+        hash.begin();
+        while (file.file && (n = file.file.read(buf, sizeof(buf))) > 0)
+            hash.update(buf, n);
+        hash.end(out);
+        if (file.file)
+            file.file.seek(0);
+        return out.crc32cBase64();
+    }
+#endif
+
     void asyncRequest(GoogleCloudStorage::async_request_data_t &request, int beta = 0)
     {
+        AsyncClientClass::SlotGuard guard(request.aClient);
         app_token_t *app_token = appToken();
 
         if (!app_token)
@@ -521,24 +1007,32 @@ private:
         request.opt.app_token = app_token;
         String extras;
 
-        if (request.method == async_request_handler_t::http_post || request.method == async_request_handler_t::http_put)
+        bool compose = request.options->requestType == GoogleCloudStorage::google_cloud_storage_request_type_compose;
+
+        if (!compose && (request.method == async_request_handler_t::http_post || request.method == async_request_handler_t::http_put))
             request.path += "/upload";
 
         request.path += "/storage/v1/b/";
         request.path += request.options->parent.getBucketId();
         request.path += "/o";
 
-        if ((request.method == async_request_handler_t::http_get || request.method == async_request_handler_t::http_delete) && request.options->parent.getObject().length())
+        if ((compose || request.method == async_request_handler_t::http_get || request.method == async_request_handler_t::http_delete) && request.options->parent.getObject().length())
         {
             URLUtil uut;
             request.path += "/";
             request.path += uut.encode(request.options->parent.getObject());
         }
 
+        if (compose)
+            request.path += "/compose";
+
         addParams(request, extras);
 
         url(FPSTR("storage.googleapis.com"));
 
+        if (request.sink)
+            request.aClient->setPayloadSink(*request.sink);
+
         async_data_item_t *sData = request.aClient->createSlot(request.opt);
 
         if (!sData)
@@ -546,6 +1040,15 @@ private:
 
         request.aClient->newRequest(sData, service_url, request.path, extras, request.method, request.opt, request.uid);
 
+        if (isObjectResource(request.options->requestType))
+        {
+            sData->event_handler = onObjectMeta;
+            sData->event_ctx = &meta_cache;
+        }
+
+        if (request.sink && request.method == async_request_handler_t::http_get)
+            request.aClient->setRangeHeader(sData, request.range_first, request.range_last);
+
         if (request.file)
             sData->request.file_data.copy(*request.file);
 
@@ -556,6 +1059,39 @@ private:
             sData->request.ota = true;
             sData->request.base64 = false;
             sData->aResult.download_data.ota = true;
+
+            // The interrupted update of the same object is resumed from the bytes that were written to flash.
+            String target = request.options->parent.getBucketId();
+            target += '/';
+            target += request.options->parent.getObject();
+            OTAUtil otaut;
+            if (ota_state.target == target)
+                ota_state.offset = otaut.updateProgress();
+            ota_state.begin(target);
+            request.aClient->setDownloadResume(sData, &ota_state);
+        }
+
+        if (request.file && request.file->filename.length() && sData->download && !request.opt.ota)
+        {
+            // The interrupted download of the same object and file is resumed from the written bytes.
+            String target = request.options->parent.getBucketId();
+            target += '/';
+            target += request.options->parent.getObject();
+            target += ':';
+            target += request.file->filename;
+            if (download_state.done_target.length())
+            {
+                object_meta_t done;
+                done.etag = download_state.done_etag;
+                download_cache.set(download_state.done_target, done);
+                download_state.done_target.remove(0, download_state.done_target.length());
+            }
+            download_state.begin(target);
+            request.aClient->setDownloadResume(sData, &download_state);
+
+            object_meta_t done;
+            if (conditional_download && download_state.start == 0 && download_cache.get(target, done))
+                request.aClient->setConditionalHeader(sData, done.etag);
         }
 
         if (request.file && sData->upload)
@@ -576,7 +1112,23 @@ private:
                     request.aClient->setContentLength(sData, request.options->payload.length());
 
                     sData->request.file_data.resumable.setSize(sData->request.file_data.file_size);
+                    sData->request.file_data.resumable.setRange(request.range_state, request.slice_size, sData->chunk_size);
                     sData->request.file_data.resumable.updateRange();
+
+                    // The stored session of the same object and file is continued from the offset that was committed by server.
+                    if (upload_session.cb)
+                    {
+                        String id = request.options->parent.getBucketId();
+                        id += '/';
+                        id += request.options->parent.getObject();
+                        id += ':';
+                        id += request.file->filename;
+                        id += ':';
+                        id += sData->request.file_data.file_size;
+                        id += ':';
+                        id += fileHash(sData->request.file_data);
+                        request.aClient->setUploadSession(sData, &upload_session, upload_session.load(id));
+                    }
                 }
                 else if (request.options->extras.indexOf("uploadType=multipart") > -1)
                 {
@@ -605,7 +1157,7 @@ private:
                 request.aClient->setFileContentLength(sData, 0);
             }
 
-            if (sData->request.file_data.file_size == 0)
+            if (sData->request.file_data.file_size == 0 && !sData->request.file_data.chunked())
                 return setClientError(request, FIREBASE_ERROR_FILE_READ);
 
             if (request.options->extras.indexOf("uploadType=media") == -1)
@@ -616,6 +1168,8 @@ private:
         }
         else if (request.options->payload.length())
         {
+            if (compose)
+                request.aClient->setContentType(sData, "application/json; charset=UTF-8");
             sData->request.val[req_hndlr_ns::payload] = request.options->payload;
             request.aClient->setContentLength(sData, request.options->payload.length());
         }
@@ -623,10 +1177,10 @@ private:
         if (request.cb)
             sData->cb = request.cb;
 
-        request.aClient->addRemoveClientVec(reinterpret_cast<uint32_t>(&(cVec)), true);
+        request.aClient->addRemoveClientVec(cVec, true);
 
         if (request.aResult)
-            sData->setRefResult(request.aResult, reinterpret_cast<uint32_t>(&(request.aClient->rVec)));
+            sData->setRefResult(request.aResult);
 
         request.aClient->process(sData->async);
         request.aClient->handleRemove();
@@ -668,6 +1222,16 @@ private:
                             request.method == async_request_handler_t::http_put ||
                             request.method == async_request_handler_t::http_patch;
         }
+        // The sink consumes the download data.
+        else if (request.file && request.file->sink)
+            sData->download = request.method == async_request_handler_t::http_get;
+        else if (request.file && (request.file->source || (request.file->data && request.file->data_size)))
+        {
+            // The blob and producer source are uploaded from memory.
+            sData->upload = request.method == async_request_handler_t::http_post ||
+                            request.method == async_request_handler_t::http_put ||
+                            request.method == async_request_handler_t::http_patch;
+        }
     }
 };
 
@@ -0,0 +1,301 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef GOOGLE_CLOUD_STORAGE_COMPOSE_UPLOAD_H
+#define GOOGLE_CLOUD_STORAGE_COMPOSE_UPLOAD_H
+
+#include <Arduino.h>
+#include <vector>
+#include "./Config.h"
+#include "./core/FileConfig.h"
+#include "./core/AsyncResult/AsyncResult.h"
+
+// The maximum number of parts that are uploaded concurrently, the compose request accepts up to 32 source objects.
+#if !defined(FIREBASE_COMPOSITE_UPLOAD_PARTS_LIMIT)
+#define FIREBASE_COMPOSITE_UPLOAD_PARTS_LIMIT 4
+#endif
+
+// The number of attempts of each part upload that was failed.
+#if !defined(FIREBASE_COMPOSITE_UPLOAD_ATTEMPTS)
+#define FIREBASE_COMPOSITE_UPLOAD_ATTEMPTS 3
+#endif
+
+// The upload of file or blob that is split into the part objects which are uploaded concurrently by the connections in pool,
+// the parts are composed into the destination object then deleted.
+class ComposeUpload
+{
+public:
+    enum compose_upload_step
+    {
+        compose_upload_step_parts,
+        compose_upload_step_compose,
+        compose_upload_step_cleanup,
+        compose_upload_step_done
+    };
+
+    enum compose_part_state
+    {
+        compose_part_state_pending,
+        compose_part_state_uploading,
+        compose_part_state_uploaded,
+        compose_part_state_deleting,
+        compose_part_state_done
+    };
+
+    // The part object, it is also the payload sink of delete request.
+    struct part_t : public Print
+    {
+    public:
+        String name;
+        // The slice [offset, offset + size) of source.
+        size_t offset = 0, size = 0;
+        AsyncResult result;
+        compose_part_state state = compose_part_state_pending;
+        uint8_t attempts = 0;
+
+        size_t write(uint8_t c) override { return write(&c, 1); }
+        size_t write(const uint8_t *buf, size_t size) override
+        {
+            (void)buf;
+            return size;
+        }
+    };
+
+    compose_upload_step step = compose_upload_step_parts;
+    file_config_data file;
+    // The result of compose request, it is the final result.
+    AsyncResult result;
+    AsyncResultCallback cb = NULL;
+    String uid;
+    std::vector<part_t *> parts;
+    size_t total = 0;
+    bool compose_sent = false;
+
+    ComposeUpload(const file_config_data &file, const String &object, uint8_t parts, AsyncResultCallback cb, const String &uid)
+    {
+        this->file.copy(file);
+        this->cb = cb;
+        this->uid = uid;
+
+        if (isBlob())
+            total = this->file.data_size;
+#if defined(ENABLE_FS)
+        else if (this->file.cb && this->file.filename.length())
+        {
+            this->file.cb(this->file.file, this->file.filename.c_str(), file_mode_open_read);
+            if (this->file.file)
+            {
+                total = this->file.file.size();
+                this->file.file.close();
+            }
+        }
+#endif
+        uint8_t count = parts == 0 ? 1 : parts > FIREBASE_COMPOSITE_UPLOAD_PARTS_LIMIT ? FIREBASE_COMPOSITE_UPLOAD_PARTS_LIMIT
+                                                                                       : parts;
+        size_t size = (total + count - 1) / count;
+        for (size_t offset = 0; size > 0 && offset < total; offset += size)
+        {
+            part_t *p = new part_t();
+            p->name = object;
+            p->name += FPSTR(".part");
+            p->name += this->parts.size();
+            p->offset = offset;
+            p->size = offset + size < total ? size : total - offset;
+            this->parts.push_back(p);
+        }
+    }
+
+    ~ComposeUpload()
+    {
+        for (size_t i = 0; i < parts.size(); i++)
+            delete parts[i];
+        parts.clear();
+    }
+
+    // Process the part and compose results, returns false when the upload was finished.
+    bool process()
+    {
+        if (step == compose_upload_step_done)
+            return false;
+
+        if (parts.size() == 0)
+        {
+            fail(FIREBASE_ERROR_FILE_READ, FPSTR("file read error"));
+            return finish();
+        }
+
+        size_t uploaded = 0;
+        bool idle = true;
+        for (size_t i = 0; i < parts.size(); i++)
+        {
+            part_t *p = parts[i];
+            bool completed = p->result.data_available || p->result.error_available;
+
+            if (p->state == compose_part_state_uploading && completed)
+            {
+                int code = p->result.lastError.code();
+                // Only the part that was failed by network or the service was unavailable is uploaded again.
+                bool retry = code < 0 || code == FIREBASE_ERROR_HTTP_CODE_TOO_MANY_REQUESTS || code >= FIREBASE_ERROR_HTTP_CODE_INTERNAL_SERVER_ERROR;
+                if (!p->result.error_available)
+                    p->state = compose_part_state_uploaded;
+                else if (step == compose_upload_step_parts && retry && ++p->attempts < FIREBASE_COMPOSITE_UPLOAD_ATTEMPTS)
+                    p->state = compose_part_state_pending;
+                else
+                {
+                    p->state = compose_part_state_done;
+                    if (step == compose_upload_step_parts)
+                        fail(code, p->result.lastError.message());
+                }
+            }
+            else if (p->state == compose_part_state_deleting && completed)
+                p->state = compose_part_state_done;
+
+            // The part that was not uploaded is not deleted.
+            if (step == compose_upload_step_cleanup && p->state == compose_part_state_pending)
+                p->state = compose_part_state_done;
+
+            if (p->state == compose_part_state_uploaded)
+                uploaded += p->size;
+            else if (p->state == compose_part_state_uploading)
+                uploaded += p->result.upload_data.uploaded;
+
+            if (p->state != compose_part_state_uploaded && p->state != compose_part_state_done)
+                idle = false;
+        }
+
+        if (step == compose_upload_step_parts)
+        {
+            if (result.upload_data.uploaded != uploaded)
+            {
+                result.upload_data.total = total;
+                result.upload_data.uploaded = uploaded;
+                if (result.setUploadProgress() && cb && uploaded < total)
+                {
+                    result.setUID(uid);
+                    cb(result);
+                }
+            }
+
+            if (idle)
+                step = compose_upload_step_compose;
+        }
+        else if (step == compose_upload_step_compose && compose_sent && (result.data_available || result.error_available))
+            step = compose_upload_step_cleanup;
+
+        if (step == compose_upload_step_cleanup && !busy())
+        {
+            for (size_t i = 0; i < parts.size(); i++)
+            {
+                if (parts[i]->state != compose_part_state_done)
+                    return true;
+            }
+            return finish();
+        }
+
+        return true;
+    }
+
+    // The part that waits for its upload request.
+    part_t *nextUpload() { return next(compose_upload_step_parts, compose_part_state_pending, compose_part_state_uploading); }
+
+    // The uploaded part that waits for its delete request.
+    part_t *nextDelete() { return next(compose_upload_step_cleanup, compose_part_state_uploaded, compose_part_state_deleting); }
+
+    // Returns true once when all parts were uploaded and the compose request can be sent.
+    bool composeRequest()
+    {
+        if (step != compose_upload_step_compose || compose_sent)
+            return false;
+        compose_sent = true;
+        result.clear();
+        result.error_available = false;
+        return true;
+    }
+
+    // The file or blob of part upload.
+    void partFile(const part_t *p, file_config_data &f) const
+    {
+        f.copy(file);
+        if (isBlob())
+        {
+            f.data = file.data + p->offset;
+            f.data_size = p->size;
+        }
+        else
+        {
+            f.range_offset = p->offset;
+            f.range_size = p->size;
+        }
+    }
+
+    // The part requests are in progress, the task is not deleted until they were finished.
+    bool busy() const
+    {
+        for (size_t i = 0; i < parts.size(); i++)
+        {
+            if (parts[i]->state == compose_part_state_uploading || parts[i]->state == compose_part_state_deleting)
+                return true;
+        }
+        return false;
+    }
+
+private:
+    bool isBlob() const { return file.data && file.data_size; }
+
+    part_t *next(compose_upload_step s, compose_part_state from, compose_part_state to)
+    {
+        for (size_t i = 0; step == s && i < parts.size(); i++)
+        {
+            part_t *p = parts[i];
+            if (p->state == from)
+            {
+                p->state = to;
+                p->result.clear();
+                p->result.error_available = false;
+                return p;
+            }
+        }
+        return nullptr;
+    }
+
+    // The parts that were uploaded are deleted before the error is reported.
+    void fail(int code, const String &message)
+    {
+        step = compose_upload_step_cleanup;
+        result.clear();
+        result.error_available = true;
+        result.lastError.setLastError(code, message);
+    }
+
+    bool finish()
+    {
+        step = compose_upload_step_done;
+        result.setUID(uid);
+        if (cb)
+            cb(result);
+        return false;
+    }
+};
+
+#endif
@@ -51,7 +51,8 @@ namespace GoogleCloudStorage
         google_cloud_storage_request_type_update_meta,
         google_cloud_storage_request_type_delete,
         google_cloud_storage_request_type_list,
-        google_cloud_storage_request_type_download_ota
+        google_cloud_storage_request_type_download_ota,
+        google_cloud_storage_request_type_compose
     };
 
     enum upload_type
@@ -79,56 +80,38 @@ namespace GoogleCloudStorage
 
     struct BaseOptions : public BaseO8
     {
-
-    protected:
-        ObjectWriter owriter;
-        URLUtil uut;
-        StringUtil sut;
-
-        BaseOptions &setBuf()
-        {
-            owriter.clear(buf[0]);
-            for (size_t i = 1; i < bufSize; i++)
-            {
-                if (buf[i].length())
-                {
-                    if (buf[0].length())
-                        buf[0] += '&';
-                    buf[0] += buf[i];
-                }
-            }
-            return *this;
-        }
-
     public:
+        // The query parameters are joined with '&'.
+        BaseOptions() { buf.setFormat(0, '&', 0); }
+
         BaseOptions &generation(uint64_t value)
         {
-            buf[1] = "generation=" + sut.u64Str(value);
-            return setBuf();
+            buf.set(1, "generation=" + NumberUtil::toString(value));
+            return *this;
         }
 
         BaseOptions &ifGenerationMatch(uint64_t value)
         {
-            buf[2] = "ifGenerationMatch=" + sut.u64Str(value);
-            return setBuf();
+            buf.set(2, "ifGenerationMatch=" + NumberUtil::toString(value));
+            return *this;
         }
 
         BaseOptions &ifGenerationNotMatch(uint64_t value)
         {
-            buf[3] = "ifGenerationNotMatch=" + sut.u64Str(value);
-            return setBuf();
+            buf.set(3, "ifGenerationNotMatch=" + NumberUtil::toString(value));
+            return *this;
         }
 
         BaseOptions &ifMetagenerationMatch(uint64_t value)
         {
-            buf[4] = "ifMetagenerationMatch=" + sut.u64Str(value);
-            return setBuf();
+            buf.set(4, "ifMetagenerationMatch=" + NumberUtil::toString(value));
+            return *this;
         }
 
         BaseOptions &ifMetagenerationNotMatch(uint64_t value)
         {
-            buf[5] = "ifMetagenerationNotMatch=" + sut.u64Str(value);
-            return setBuf();
+            buf.set(5, "ifMetagenerationNotMatch=" + NumberUtil::toString(value));
+            return *this;
         }
     };
 
@@ -138,107 +121,90 @@ namespace GoogleCloudStorage
     public:
         BaseOptions &projection(PROJECTION_OPTIONS value)
         {
-            buf[6] = "projection=";
+            String param = "projection=";
             if (value == PROJECTION_OPTIONS::full)
-                buf[6] += "full";
+                param += "full";
             else if (value == PROJECTION_OPTIONS::noAcl)
-                buf[6] += "noAcl";
-            return setBuf();
+                param += "noAcl";
+            buf.set(6, param);
+            return *this;
         }
     };
 
     struct DeleteOptions : BaseOptions
     {
-    public:
-        const char *c_str() const { return buf[0].c_str(); }
-        void clear() { owriter.clearBuf(buf, bufSize); }
     };
 
     struct InsertOptions : public BaseO10
     {
-
-    private:
-        ObjectWriter owriter;
-        StringUtil sut;
-
-        InsertOptions &setBuf()
-        {
-            owriter.clear(buf[0]);
-            for (size_t i = 1; i < bufSize; i++)
-            {
-                if (buf[i].length())
-                {
-                    if (buf[0].length())
-                        buf[0] += '&';
-                    buf[0] += buf[i];
-                }
-            }
-            return *this;
-        }
-
     public:
+        // The query parameters are joined with '&'.
+        InsertOptions() { buf.setFormat(0, '&', 0); }
+
         InsertOptions &contentEncoding(const String &value)
         {
-            buf[1] = "contentEncoding=" + value;
-            return setBuf();
+            buf.set(1, "contentEncoding=" + value);
+            return *this;
         }
 
         InsertOptions &ifGenerationMatch(uint64_t value)
         {
-            buf[2] = "ifGenerationMatch=" + sut.u64Str(value);
-            return setBuf();
+            buf.set(2, "ifGenerationMatch=" + NumberUtil::toString(value));
+            return *this;
         }
 
         InsertOptions &ifGenerationNotMatch(uint64_t value)
         {
-            buf[3] = "ifGenerationNotMatch=" + sut.u64Str(value);
-            return setBuf();
+            buf.set(3, "ifGenerationNotMatch=" + NumberUtil::toString(value));
+            return *this;
         }
 
         InsertOptions &ifMetagenerationMatch(uint64_t value)
         {
-            buf[4] = "ifMetagenerationMatch=" + sut.u64Str(value);
-            return setBuf();
+            buf.set(4, "ifMetagenerationMatch=" + NumberUtil::toString(value));
+            return *this;
         }
 
         InsertOptions &ifMetagenerationNotMatch(uint64_t value)
         {
-            buf[5] = "ifMetagenerationNotMatch=" + sut.u64Str(value);
-            return setBuf();
+            buf.set(5, "ifMetagenerationNotMatch=" + NumberUtil::toString(value));
+            return *this;
         }
 
         InsertOptions &kmsKeyName(const String &value)
         {
-            buf[6] = "contentEncoding=" + value;
-            return setBuf();
+            buf.set(6, "contentEncoding=" + value);
+            return *this;
         }
 
         InsertOptions &predefinedAcl(ACL_OPTIONS value)
         {
-            buf[7] = "predefinedAcl=";
+            String param = "predefinedAcl=";
             if (value == ACL_OPTIONS::authenticatedRead)
-                buf[7] += "authenticatedRead";
+                param += "authenticatedRead";
             else if (value == ACL_OPTIONS::bucketOwnerFullControl)
-                buf[7] += "bucketOwnerFullControl";
+                param += "bucketOwnerFullControl";
             else if (value == ACL_OPTIONS::bucketOwnerRead)
-                buf[7] += "bucketOwnerRead";
+                param += "bucketOwnerRead";
             else if (value == ACL_OPTIONS::_private)
-                buf[7] += "private";
+                param += "private";
             else if (value == ACL_OPTIONS::projectPrivate)
-                buf[7] += "projectPrivate";
+                param += "projectPrivate";
             else if (value == ACL_OPTIONS::publicRead)
-                buf[7] += "publicRead";
-            return setBuf();
+                param += "publicRead";
+            buf.set(7, param);
+            return *this;
         }
 
         InsertOptions &projection(PROJECTION_OPTIONS value)
         {
-            buf[8] = "projection=";
+            String param = "projection=";
             if (value == PROJECTION_OPTIONS::full)
-                buf[8] += "full";
+                param += "full";
             else if (value == PROJECTION_OPTIONS::noAcl)
-                buf[8] += "noAcl";
-            return setBuf();
+                param += "noAcl";
+            buf.set(8, param);
+            return *this;
         }
     };
 
@@ -247,76 +213,63 @@ namespace GoogleCloudStorage
 
     private:
         ObjectWriter owriter;
-        URLUtil uut;
-
-        ListOptions &setBuf()
-        {
-            owriter.clear(buf[0]);
-            for (size_t i = 1; i < bufSize; i++)
-            {
-                if (buf[i].length())
-                {
-                    if (buf[0].length())
-                        buf[0] += '&';
-                    buf[0] += buf[i];
-                }
-            }
-            return *this;
-        }
 
     public:
+        // The query parameters are joined with '&'.
+        ListOptions() { buf.setFormat(0, '&', 0); }
+
         ListOptions &delimiter(const String &value)
         {
-            buf[1] = "delimiter=" + value;
-            return setBuf();
+            buf.set(1, "delimiter=" + value);
+            return *this;
         }
 
         ListOptions &endOffset(const String &value)
         {
-            buf[2] = "endOffset=" + value;
-            return setBuf();
+            buf.set(2, "endOffset=" + value);
+            return *this;
         }
 
         ListOptions &includeTrailingDelimiter(bool value)
         {
-            buf[3] = "includeTrailingDelimiter=" + owriter.getBoolStr(value);
-            return setBuf();
+            buf.set(3, "includeTrailingDelimiter=" + owriter.getBoolStr(value));
+            return *this;
         }
 
         ListOptions &maxResults(uint32_t value)
         {
-            buf[4] = "maxResults=" + String(value);
-            return setBuf();
+            buf.set(4, "maxResults=" + String(value));
+            return *this;
         }
 
         ListOptions &pageToken(const String &value)
         {
-            buf[5] = "pageToken=" + value;
-            return setBuf();
+            buf.set(5, "pageToken=" + value);
+            return *this;
         }
 
         ListOptions &prefix(const String &value)
         {
-            buf[6] = "prefix=" + value;
-            return setBuf();
+            buf.set(6, "prefix=" + value);
+            return *this;
         }
 
         ListOptions &projection(const String &value)
         {
-            buf[7] = "projection=" + value;
-            return setBuf();
+            buf.set(7, "projection=" + value);
+            return *this;
         }
 
         ListOptions &startOffset(const String &value)
         {
-            buf[8] = "startOffset=" + value;
-            return setBuf();
+            buf.set(8, "startOffset=" + value);
+            return *this;
         }
 
         ListOptions &versions(bool value)
         {
-            buf[9] = "versions=" + owriter.getBoolStr(value);
-            return setBuf();
+            buf.set(9, "versions=" + owriter.getBoolStr(value));
+            return *this;
         }
     };
 
@@ -342,10 +295,10 @@ namespace GoogleCloudStorage
         InsertProperties &md5Hash(const String &value) { return wr.set<InsertProperties &, String>(*this, value, buf, bufSize, 10, FPSTR(__func__)); }
         InsertProperties &metadata(const object_t value)
         {
-            buf[11] = FPSTR("{\"metadata\":{\"firebaseStorageDownloadTokens\":\"a82781ce-a115-442f-bac6-a52f7f63b3e8\"}}");
+            String obj = FPSTR("{\"metadata\":{\"firebaseStorageDownloadTokens\":\"a82781ce-a115-442f-bac6-a52f7f63b3e8\"}}");
             if (strlen(value.c_str()))
-                owriter.addMember(buf[11], value.c_str(), false);
-            owriter.getBuf(buf, bufSize);
+                owriter.addMember(obj, value.c_str(), false);
+            buf.setObject(11, obj);
             return *this;
         }
         InsertProperties &retention(const object_t value) { return wr.set<InsertProperties &, object_t>(*this, value, buf, bufSize, 12, FPSTR(__func__)); }
@@ -410,6 +363,13 @@ namespace GoogleCloudStorage
         GoogleCloudStorage::upload_type uploadType;
         GoogleCloudStorage::InsertOptions insertOptions;
         GoogleCloudStorage::InsertProperties insertProps;
+        // The range size of resumable upload in units of 256 KB, 0 for FIREBASE_RESUMABLE_RANGE_UNITS.
+        // When the range size is adaptive, this is the initial range size.
+        uint8_t rangeUnits = 0;
+        // The range size of resumable upload is adapted to the time and the failure of the ranges.
+        bool adaptiveRange = false;
+        // The bytes of each write, e.g. the transmit buffer size of SSL client, 0 for the chunk size of async client.
+        uint16_t sliceSize = 0;
     };
 
     struct async_request_data_t
@@ -425,6 +385,13 @@ namespace GoogleCloudStorage
         file_config_data *file = nullptr;
         AsyncResult *aResult = nullptr;
         AsyncResultCallback cb = NULL;
+        // The payload sink and byte range [range_first, range_last] of range download.
+        Print *sink = nullptr;
+        size_t range_first = 0, range_last = 0;
+#if defined(ENABLE_FS)
+        resumable_range_state_t *range_state = nullptr;
+        uint16_t slice_size = 0;
+#endif
         async_request_data_t() {}
         async_request_data_t(AsyncClientClass *aClient, const String &path, async_request_handler_t::http_request_method method, slot_options_t opt, DataOptions *options, file_config_data *file, AsyncResult *aResult, AsyncResultCallback cb, const String &uid = "")
         {
@@ -0,0 +1,101 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_ASYNC_AWAIT_H
+#define CORE_ASYNC_AWAIT_H
+
+#include <Arduino.h>
+#include "./core/AsyncResult/AsyncResult.h"
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>) && !defined(FIREBASE_DISABLE_COROUTINE)
+#define FIREBASE_COROUTINE
+#endif
+
+#if defined(FIREBASE_COROUTINE)
+#include <coroutine>
+#include <exception>
+
+// The coroutine that runs until its first co_await when it was called, it is resumed by the async client loop
+// and is destroyed when it was finished.
+struct AsyncTask
+{
+    struct promise_type
+    {
+        AsyncTask get_return_object() { return AsyncTask(); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+// The awaitable that adds the request when the coroutine was suspended and resumes it with the result
+// when the task was removed from the queue of async client.
+template <typename F>
+class AsyncAwaiter
+{
+public:
+    explicit AsyncAwaiter(F start) : start(start) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> h)
+    {
+        handle = h;
+        result.done_cb = resume;
+        result.done_ctx = this;
+        start(result);
+
+        // The task was not added to the queue e.g. the app was not assigned or the value was read from mirror,
+        // the coroutine is continued.
+        if (result.reg_handle == 0)
+        {
+            result.done_cb = NULL;
+            return false;
+        }
+        return true;
+    }
+
+    AsyncResult await_resume() { return result; }
+
+private:
+    F start;
+    AsyncResult result;
+    std::coroutine_handle<> handle;
+
+    static void resume(void *ctx) { static_cast<AsyncAwaiter *>(ctx)->handle.resume(); }
+};
+
+/**
+ * Create the awaitable of request.
+ *
+ * @param start The function that adds the async request with the AsyncResult e.g.
+ * [&](AsyncResult &aResult) { Database.get(aClient, "/path", aResult); }
+ */
+template <typename F>
+AsyncAwaiter<F> asyncAwait(F start) { return AsyncAwaiter<F>(start); }
+
+#endif
+
+#endif
@@ -27,8 +27,12 @@
 #ifndef ASYNC_CLIENT_H
 #define ASYNC_CLIENT_H
 #include <vector>
+#include <new>
+#include <type_traits>
 #include "./core/AsyncClient/RequestHandler.h"
 #include "./core/AsyncClient/ResponseHandler.h"
+#include "./core/AsyncClient/RetryPolicy.h"
+#include "./core/AsyncClient/SlotIndex.h"
 #include "./core/NetConfig.h"
 #include "./core/Memory.h"
 #include "./core/FileConfig.h"
@@ -36,15 +40,69 @@
 #include "./core/Error.h"
 #include "./core/OTA.h"
 #include "./core/AsyncResult/AsyncResult.h"
+#include "./core/AsyncAwait.h"
 #include "./core/AuthConfig.h"
 #include "./core/List.h"
 #include "./core/Core.h"
 #include "./core/URL.h"
+#include "./core/ResponseCache.h"
+#include "./core/TLSSessionCache.h"
+#include "./core/DNSCache.h"
+#include "./core/RateLimiter.h"
+#include "./core/LinkEstimator.h"
+#include "./core/IOPipeline.h"
+#include "./core/Metrics.h"
+#include "./core/Trace.h"
+#if defined(ENABLE_GZIP)
+#include "./core/Inflate.h"
+#include "./core/Deflate.h"
+#endif
+#if defined(ENABLE_DELTA_OTA)
+#include "./core/DeltaOTA.h"
+#endif
 
 #if defined(ENABLE_ASYNC_TCP_CLIENT)
 #include "./core/AsyncTCPConfig.h"
 #endif
 
+// The time in ms that the task waiting for the response can wait before the data arrival was checked again, see nextDeadline.
+#if !defined(FIREBASE_IDLE_POLL_MS)
+#define FIREBASE_IDLE_POLL_MS 50
+#endif
+
+// The deadline of the empty queue.
+#define FIREBASE_IDLE_FOREVER 0xFFFFFFFF
+
+// The time in ms that the async task which was added before the app was authenticated waits for the token.
+#if !defined(FIREBASE_AUTH_WAIT_MS)
+#define FIREBASE_AUTH_WAIT_MS 30 * 1000
+#endif
+
+// The numbers of response spool files that are used in turn, the spool file of result is valid until this numbers of later responses were spooled.
+#if !defined(FIREBASE_SPOOL_RESPONSE_FILES)
+#define FIREBASE_SPOOL_RESPONSE_FILES 2
+#endif
+
+// The remaining payload size of cancelled download that is read and discarded to keep the connection alive.
+#if !defined(FIREBASE_CANCEL_DRAIN_SIZE)
+#define FIREBASE_CANCEL_DRAIN_SIZE 2048
+#endif
+
+// The time in µs that each process call of async tasks can spend before it was returned, 0 for unlimited.
+#if !defined(FIREBASE_PROCESS_BUDGET_US)
+#define FIREBASE_PROCESS_BUDGET_US 0
+#endif
+
+// The time in seconds that the kept-alive connection can be idle before it was closed, 0 for no limit.
+#if !defined(FIREBASE_CONNECTION_MAX_IDLE_SEC)
+#define FIREBASE_CONNECTION_MAX_IDLE_SEC 50
+#endif
+
+// The numbers of times that the waiting task can be passed by the tasks to the other host (host routing).
+#if !defined(FIREBASE_HOST_ROUTING_BYPASS)
+#define FIREBASE_HOST_ROUTING_BYPASS 4
+#endif
+
 using namespace firebase;
 
 enum async_state
@@ -65,6 +123,83 @@ enum function_return_type
     function_return_type_retry = 2
 };
 
+// The priority of task in async queue, the higher priority task is inserted before the lower priority tasks that are not started.
+enum slot_priority
+{
+    slot_priority_control,     // The latency-critical tasks
+    slot_priority_interactive, // The default priority
+    slot_priority_bulk         // The file and OTA transfer tasks
+};
+
+// The function that writes the part of request payload and returns true when more parts follow, the first part is 0.
+// Each part is written twice (for the Content-Length and while sending) and should be the same data every time.
+typedef bool (*AsyncPayloadWriterCallback)(Print &out, size_t part);
+
+// The function that receives the stream event before it was returned to the result, the ctx is the handler object.
+typedef void (*AsyncEventHandlerCallback)(void *ctx, AsyncResult &aResult);
+
+// The function that starts (start is true) or advances the TLS handshake of the network client,
+// it returns 1 when connected, 0 when it is in progress or -1 when failed.
+typedef int (*AsyncHandshakeCallback)(Client *client, const char *host, uint16_t port, bool start);
+
+// The function that holds (cork is true) or sends (cork is false) the written data of the network client.
+typedef void (*AsyncCorkCallback)(Client *client, bool cork);
+
+// The function that is called when the task was added to the queue e.g. to wake up the task that waits for nextDeadline.
+typedef void (*AsyncWakeupCallback)();
+
+// The function that is called when the queue depth reached the high watermark (high is true) or fell to the low watermark.
+typedef void (*AsyncQueueCallback)(size_t depth, bool high);
+
+// The function that is called for the idle connection in every keep-alive interval e.g. to send the probe or TCP keep-alive.
+typedef void (*AsyncKeepAliveCallback)(Client *client, const char *host);
+
+// The token that cancels the tasks that were added with it (see AsyncClientClass::setCancelToken),
+// it should be valid until the tasks were finished.
+class AsyncCancelToken
+{
+public:
+    void cancel() { cancelled = true; }
+    void reset() { cancelled = false; }
+    bool isCancelled() const { return cancelled; }
+
+private:
+    volatile bool cancelled = false;
+};
+
+// The Print that keeps the written data in range [offset, offset + size) and counts the total written size.
+class AsyncPayloadWindow : public Print
+{
+private:
+    uint8_t *buf = nullptr;
+    // The bytes that did not fit in buffer, they are sent first in the next chunk.
+    std::vector<uint8_t> *carry = nullptr;
+    size_t size = 0, len = 0, total = 0;
+
+public:
+    // The bytes are counted only when buf is null.
+    AsyncPayloadWindow(uint8_t *buf, size_t size, std::vector<uint8_t> *carry) : buf(buf), carry(carry), size(buf ? size : 0) {}
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+
+    size_t write(const uint8_t *data, size_t n) override
+    {
+        total += n;
+        if (!buf)
+            return n;
+        size_t i = n < size - len ? n : size - len;
+        memcpy(buf + len, data, i);
+        len += i;
+        if (i < n && carry)
+            carry->insert(carry->end(), data + i, data + n);
+        return n;
+    }
+
+    size_t length() const { return len; }
+    size_t totalLength() const { return total; }
+    bool full() const { return len == size; }
+};
+
 struct async_data_item_t
 {
     friend class FirebaseApp;
@@ -91,30 +226,177 @@ public:
     bool download = false;
     bool upload_progress_enabled = false;
     bool upload = false;
+    // The task only opens the connection to the host of request (preconnect), no request is sent.
+    bool preconnect = false;
+    // The index of connection in async client's connection pool that bound to this slot.
+    int8_t conn_index = -1;
+    slot_priority priority = slot_priority_interactive;
+    // The sink that receives the (chunk decoded) response payload instead of result payload.
+    Print *sink = nullptr;
+    // The sink did not accept all data, the remaining payload is discarded.
+    bool sink_stopped = false;
+    // The maximum response payload size, 0 for no limit.
+    size_t resp_limit = 0;
+    AsyncCancelToken *cancel_token = nullptr;
+    // The task was cancelled and its remaining payload is read and discarded before the connection is reused.
+    bool draining = false;
+    // The header-only request (probe) that its response payload is not stored, the GET request is sent as HEAD request (probe_head).
+    bool probe = false, probe_head = false;
+    // The request of closed byte range that only its 206 response is accepted.
+    bool range_part = false;
+    // The writer that generates the request payload while sending, instead of request payload buffer.
+    AsyncPayloadWriterCallback writer = NULL;
+    size_t writer_len = 0;
+    // The next part of writer and the bytes of written part that were not sent yet.
+    size_t writer_part = 0, writer_carry_pos = 0;
+    bool writer_more = true;
+    std::vector<uint8_t> writer_carry;
+    // The token of rate limiter was taken for the request that was not started yet.
+    bool rate_acquired = false;
+    // The transfer chunk size of task that was set from the chunk size of client when the task was created.
+    uint16_t chunk_size = FIREBASE_CHUNK_SIZE;
+    // The source data size of base64 encoded upload chunk, a multiple of 3.
+    uint16_t base64ChunkSize() const { return chunk_size == FIREBASE_CHUNK_SIZE ? FIREBASE_BASE64_CHUNK_SIZE : (chunk_size / 2 + 2) / 3 * 3; }
+#if defined(ENABLE_FS)
+    // The file that the request payload was spooled to (spool_req) or the response payload is written to (spool_res).
+    FILEOBJ spool_file;
+    bool spool_req = false, spool_res = false, spool_opened = false;
+    size_t spool_len = 0;
+#endif
     uint32_t auth_ts = 0;
-    uint32_t addr = 0;
+    // The id of task in the state transition trace (FIREBASE_TRACE_SIZE).
+    uint16_t trace_id = 0;
+    // The compact id of this task and the hash of its uid (0 for no uid) in the uid index of async client.
+    uint16_t id = 0;
+    uint32_t uid_hash = 0;
+    // The key of request host in the rate limiter, 0 when it was not computed.
+    uint32_t host_key = 0;
     AsyncResult aResult;
     AsyncResult *refResult = nullptr;
-    uint32_t ref_result_addr = 0;
+    // The Registry handle of refResult, the result that was destroyed is not accessed.
+    list_handle_t ref_result_handle = 0;
     AsyncResultCallback cb = NULL;
+    // The results and callbacks of identical reads that were coalesced into this task.
+    struct follower_t
+    {
+        AsyncResult *refResult = nullptr;
+        list_handle_t ref_result_handle = 0;
+        AsyncResultCallback cb = NULL;
+        String uid;
+    };
+    std::vector<follower_t> followers;
+    // The handler of stream events e.g. the Realtime Database mirror.
+    AsyncEventHandlerCallback event_handler = NULL;
+    void *event_ctx = nullptr;
+    // The key of response cache, it is zero when the response is not cached.
+    uint32_t cache_key = 0;
+    // The reconnection backoff of stream.
+    uint8_t sse_retry = 0;
+    unsigned long sse_retry_ms = 0, sse_delay_ms = 0;
+    // The time in ms from when the task was added that the task should be completed, 0 for no deadline.
+    unsigned long deadline_start = 0, deadline_ms = 0;
+    // The retries of failed request (retry policy).
+    uint8_t retry_count = 0;
+    // The numbers of times that this waiting task was passed by the tasks to the other host (host routing).
+    uint8_t bypassed = 0;
+    unsigned long retry_ms = 0, retry_delay_ms = 0;
+    // The hash of initial put of stream, the data was changed after it and the stream was reconnected.
+    uint32_t sse_snapshot = 0;
+    bool sse_changed = false, sse_resumed = false;
+    // The comma separated path filters of stream, the events of the other paths are discarded before they were stored.
+    String sse_filter;
     Timer err_timer;
+    // The arena allocator for chunk buffers, it was reset after each chunk was processed.
+    MemoryArena arena;
+    // The file block that was read ahead (upload), the decoded data that are waiting for writing or the data that
+    // were not accepted by the sink (download).
+    uint8_t *file_block = nullptr;
+    size_t file_block_len = 0;
+    // The hashes of file or blob data that are being sent or received.
+    TransferHash hash;
+    // The decoder of base64 download data.
+    Base64Decoder b64;
+#if defined(ENABLE_GZIP)
+    // The gzip compressed response was accepted and its decoder.
+    bool accept_gzip = false;
+    GzipInflate *inflate = nullptr;
+    // The request payload can be compressed, its encoder and compressed size.
+    bool gzip_req = false;
+    GzipDeflate *deflate = nullptr;
+    size_t deflate_len = 0;
+#endif
+    // The double buffered writer of OTA firmware.
+    OTAWriter *ota_writer = nullptr;
+#if defined(ENABLE_DELTA_OTA)
+    // The decoder of delta patch or compressed firmware.
+    DeltaOTA *ota_delta = nullptr;
+#endif
+    // The memory usage statistics of this slot.
+    memory_stats_t mem_stats;
     async_data_item_t()
     {
-        addr = reinterpret_cast<uint32_t>(this);
         err_timer.feed(0);
+#if defined(FIREBASE_STATIC_BUFFERS)
+        // The buffers capacity are kept (cleared without shrinking) while the slot data is recycled.
+        request.val[req_hndlr_ns::header].reserve(FIREBASE_STATIC_HEADER_SIZE);
+        response.val[res_hndlr_ns::payload].reserve(FIREBASE_STATIC_PAYLOAD_SIZE);
+        aResult.payload_val.reserve(FIREBASE_STATIC_PAYLOAD_SIZE);
+#endif
+    }
+
+    ~async_data_item_t()
+    {
+        freeOTAWriter();
+#if defined(ENABLE_GZIP)
+        freeInflate();
+        freeDeflate();
+#endif
+    }
+
+    void freeOTAWriter()
+    {
+#if defined(ENABLE_DELTA_OTA)
+        if (ota_delta)
+            delete ota_delta;
+        ota_delta = nullptr;
+#endif
+        if (ota_writer)
+            delete ota_writer;
+        ota_writer = nullptr;
+    }
+
+#if defined(ENABLE_GZIP)
+    void freeInflate()
+    {
+        if (inflate)
+            delete inflate;
+        inflate = nullptr;
+    }
+
+    void freeDeflate()
+    {
+        if (deflate)
+            delete deflate;
+        deflate = nullptr;
+        deflate_len = 0;
     }
+#endif
 
-    void setRefResult(AsyncResult *refResult, uint32_t rvec_addr)
+    void setRefResult(AsyncResult *refResult)
     {
         this->refResult = refResult;
-        ref_result_addr = reinterpret_cast<uint32_t>(refResult);
-        this->refResult->rvec_addr = rvec_addr;
-        if (rvec_addr > 0)
-        {
-            std::vector<uint32_t> *rVec = reinterpret_cast<std::vector<uint32_t> *>(rvec_addr);
-            List vec;
-            vec.addRemoveList(*rVec, ref_result_addr, true);
-        }
+        if (refResult->reg_handle == 0)
+            refResult->reg_handle = Registry::shared().add(refResult);
+        ref_result_handle = refResult->reg_handle;
+    }
+
+    // Start the payload writer from its first part.
+    void resetWriter()
+    {
+        writer_part = 0;
+        writer_carry_pos = 0;
+        writer_more = true;
+        writer_carry.clear();
     }
 
     void reset()
@@ -132,8 +414,53 @@ public:
         cancel = false;
         sse = false;
         path_not_existed = false;
+        preconnect = false;
+        priority = slot_priority_interactive;
+        sink = nullptr;
+        sink_stopped = false;
+        resp_limit = 0;
+        cancel_token = nullptr;
+        draining = false;
+        probe = false;
+        probe_head = false;
+        range_part = false;
+        writer = NULL;
+        writer_len = 0;
+        resetWriter();
+        rate_acquired = false;
+        chunk_size = FIREBASE_CHUNK_SIZE;
+#if defined(ENABLE_FS)
+        spool_req = false;
+        spool_res = false;
+        spool_opened = false;
+        spool_len = 0;
+#endif
         cb = NULL;
+        event_handler = NULL;
+        event_ctx = nullptr;
+        followers.clear();
+        cache_key = 0;
+        sse_retry = 0;
+        sse_retry_ms = 0;
+        deadline_ms = 0;
+        retry_count = 0;
+        bypassed = 0;
+        retry_delay_ms = 0;
+        sse_delay_ms = 0;
+        sse_snapshot = 0;
+        sse_changed = false;
+        sse_resumed = false;
+        sse_filter.remove(0, sse_filter.length());
         err_timer.reset();
+        mem_stats.reset();
+        hash.clear();
+        freeOTAWriter();
+#if defined(ENABLE_GZIP)
+        accept_gzip = false;
+        freeInflate();
+        gzip_req = false;
+        freeDeflate();
+#endif
     }
 };
 
@@ -147,6 +474,11 @@ public:
     bool ota = false;
     bool no_etag = false;
     bool auth_param = false;
+    // The connect only task that does not take the options that were set for the next request.
+    bool preconnect = false;
+    slot_priority priority = slot_priority_interactive;
+    // The deadline in ms that covers the waiting in queue, connecting, sending and receiving, 0 for no deadline.
+    uint32_t deadline_ms = 0;
     app_token_t *app_token = nullptr;
     slot_options_t() {}
     slot_options_t(bool auth_used, bool sse, bool async, bool sv, bool ota, bool no_etag, bool auth_param = false)
@@ -161,9 +493,34 @@ public:
     }
 };
 
+struct async_conn_t
+{
+public:
+    Client *client = nullptr;
+    String host;
+    uint16_t port = 0;
+    bool sse = false, keep_alive = false;
+    // The slot data that currently uses this connection.
+    async_data_item_t *slot_data = nullptr;
+    // The non-blocking handshake of network client and the cached TLS session that is used.
+    AsyncHandshakeCallback handshake = NULL;
+    bool handshake_pending = false;
+    int session = -1;
+    // The cached address of host that is used.
+    int dns = -1;
+    // The zero-copy read of network client's buffer.
+    TCPPeekCallback peek = NULL;
+    // The write coalescing of network client, the request is held until it was sent completely.
+    AsyncCorkCallback cork = NULL;
+    bool corked = false;
+    // The time that the kept-alive connection became idle and that the keep-alive callback was called.
+    unsigned long idle_ms = 0, keep_alive_ms = 0;
+};
+
 class AsyncClientClass
 {
     friend class FirebaseApp;
+    friend class ClientScheduler;
     friend class RealtimeDatabase;
     friend class Databases;
     friend class Documents;
@@ -172,13 +529,61 @@ class AsyncClientClass
     friend class Messaging;
     friend class Storage;
     friend class CloudStorage;
+    friend class FirestoreBase;
 
 private:
     FirebaseError lastErr;
     String header, reqEtag, resETag;
+    slot_priority reqPriority = slot_priority_interactive;
+    uint32_t reqDeadline = 0;
+    uint32_t budget_us = FIREBASE_PROCESS_BUDGET_US, budget_start = 0, budget_slot = 0;
+    std::vector<list_handle_t> doneVec; // The handles of AsyncResult that their done callbacks are pending.
+    RetryPolicy retry_policy;
+    RateLimiter rate_limiter;
+    // The estimate of network link from the completed requests and the option to adapt the transfer to it.
+    LinkEstimator link;
+    bool link_adaptive = false;
+    // The numbers of retries in the current minute of retry budget.
+    uint16_t retry_used = 0;
+    unsigned long retry_window_ms = 0;
+    uint32_t max_idle_sec = FIREBASE_CONNECTION_MAX_IDLE_SEC, keep_alive_sec = 0;
+    AsyncKeepAliveCallback keep_alive_cb = NULL;
+    unsigned long idle_check_ms = 0;
+    Print *reqSink = nullptr;
+    size_t reqLimit = 0;
+    String reqFilter;
+    AsyncCancelToken *reqToken = nullptr;
+    AsyncPayloadWriterCallback reqWriter = NULL;
+    bool reqProbe = false, reqProbeHead = false;
+#if defined(ENABLE_FS)
+    FileConfigCallback spool_cb = NULL;
+    String spool_name;
+    size_t spool_threshold = 0;
+    uint8_t spool_res_index = 0;
+#endif
+    AsyncWakeupCallback wakeup_cb = NULL;
+    AsyncQueueCallback queue_cb = NULL;
+    // The tasks of batch_priority or lower priority are held until the batch was flushed (radio batching).
+    slot_priority batch_priority = slot_priority_interactive;
+    uint32_t batch_interval_ms = 0;
+    size_t batch_threshold = 0;
+    bool batch_flushing = false, batch_flush = false;
+    NetworkSleepCallback batch_sleep_cb = NULL;
+    size_t queue_high = 0, queue_low = 0;
+    bool queue_full = false;
+    uint16_t trace_seq = 0;
+    bool hash_verify = false;
+    bool coalesce_reads = false, host_routing = false;
+#if defined(ENABLE_GZIP)
+    bool accept_gzip = false;
+    // The minimum size of request payload that is compressed, 0 for no compression.
+    size_t gzip_req_min = 0;
+#endif
     int netErrState = 0;
+    // The network status that was read and the network event sequence at the time it was read.
+    uint32_t net_status_ms = 0, net_status_seq = 0;
+    bool net_status_valid = false;
     uint32_t auth_ts = 0;
-    uint32_t cvec_addr = 0;
     uint32_t sync_send_timeout_sec = 0, sync_read_timeout_sec = 0;
     Client *client = nullptr;
 #if defined(ENABLE_ASYNC_TCP_CLIENT)
@@ -187,16 +592,187 @@ private:
     void *async_tcp_config = nullptr;
 #endif
     async_request_handler_t::tcp_client_type client_type = async_request_handler_t::tcp_client_type_sync;
-    bool sse = false;
+    bool sse = false, keep_alive = false, skip_snapshot = false;
     String host;
     uint16_t port;
-    std::vector<uint32_t> sVec;
+    std::vector<async_data_item_t *> sVec;
+    // The index of tasks by uid.
+    SlotIndex slot_index;
     Memory mem;
     Base64Util but;
     network_config_data net;
-    uint32_t addr = 0;
+    // The handle of this client in Registry.
+    list_handle_t reg_handle = 0;
     bool inProcess = false;
     bool inStopAsync = false;
+    // The lock of slot queue and the states that are processed, the services hold it while the request is added.
+    AsyncLock slot_lock;
+
+    // Hold the slot lock while the service builds and processes the slot of its request, the slot is built without
+    // the other tasks using the same async client.
+    class SlotGuard
+    {
+    public:
+        explicit SlotGuard(AsyncClientClass *aClient) : guard(aClient->slot_lock) {}
+
+    private:
+        AsyncLockGuard guard;
+    };
+
+    // Refresh the token of app that is going to expire and add the connect task of service host (see warmUp of services),
+    // it is defined in FirebaseApp.h.
+    bool warmUp(list_handle_t app_handle, std::vector<list_handle_t> &cVec, const String &host, uint16_t port = 443);
+
+    // The client was added to ClientScheduler.
+    volatile bool scheduled = false;
+#if defined(FIREBASE_ASYNC_SLOT_POOL)
+    // The preallocated slot data that are recycled instead of allocating from heap.
+    async_data_item_t slotPool[FIREBASE_ASYNC_QUEUE_LIMIT];
+    bool slotPoolUsed[FIREBASE_ASYNC_QUEUE_LIMIT] = {};
+#endif
+    // The connection pool, the first connection is the client that assigned in constructor.
+    async_conn_t conn[FIREBASE_ASYNC_CONNECTION_POOL_LIMIT];
+    uint8_t conn_count = 1, conn_index = 0;
+    // The ETag and payload of GET responses for the conditional requests.
+    ResponseCache res_cache;
+    // The TLS sessions of hosts for resuming the session of the SSL clients.
+    TLSSessionCache session_cache;
+    // The chunk size of the next tasks, 0 for the size that scaled from the fragment length and free heap.
+    uint16_t chunk_size = FIREBASE_CHUNK_SIZE;
+    // The TLS fragment length of the last connection, 0 when it is not known.
+    uint16_t tls_frag_len = 0;
+    // The addresses of hosts for connecting without host name lookup.
+    DNSCache dns_cache;
+    // The networks in priority order, the first is the network of constructor and its connection is kept
+    // here while the other network is used.
+    async_conn_t failover_conn[FIREBASE_NETWORK_FAILOVER_LIMIT];
+    network_config_data failover_net[FIREBASE_NETWORK_FAILOVER_LIMIT];
+    uint8_t failover_count = 0, failover_index = 0, failover_pool = 1;
+    bool failover_up = true;
+    Timer failover_timer;
+
+    template <typename T, typename C, typename S>
+    bool beginSessionCache(T &sslClient, void (C::*)(S *))
+    {
+        // The session object is constructed in the cache buffer, it is copied as bytes for export and import.
+        static_assert(std::is_trivially_destructible<S>::value, "The session object should be plain data");
+        return session_cache.addClient(&sslClient, sizeof(S), [](Client *client, void *session)
+                                       { static_cast<T *>(client)->setSession(static_cast<S *>(session)); }, [](void *session)
+                                       { new (session) S(); });
+    }
+
+    // Hold or send the written data of current connection.
+    void corkConn(bool cork)
+    {
+        async_conn_t &c = conn[conn_index];
+        if (client_type != async_request_handler_t::tcp_client_type_sync || !c.cork || !client || c.corked == cork)
+            return;
+        c.corked = cork;
+        c.cork(client, cork);
+    }
+
+    // Save the current connection states and load states of connection at index.
+    void switchConn(uint8_t index)
+    {
+        if (index == conn_index || index >= conn_count)
+            return;
+
+        conn[conn_index].host = host;
+        conn[conn_index].port = port;
+        conn[conn_index].sse = sse;
+        conn[conn_index].keep_alive = keep_alive;
+
+        conn_index = index;
+        client = conn[index].client;
+        host = conn[index].host;
+        port = conn[index].port;
+        sse = conn[index].sse;
+        keep_alive = conn[index].keep_alive;
+    }
+
+    // Bind the slot data to the free connection in pool and make it current.
+    bool bindConn(async_data_item_t *sData)
+    {
+        if (sData->conn_index > -1)
+        {
+            switchConn(sData->conn_index);
+            return true;
+        }
+
+        int index = -1, score = -1;
+        unsigned long age = 0;
+        String reqHost = getHost(sData, true);
+
+        // The concurrent requests of the lossy link are limited except for the auth task.
+        if (link_adaptive && !sData->auth_used && !sData->sse)
+        {
+            uint8_t busy = 0;
+            for (uint8_t i = 0; i < conn_count; i++)
+                busy += conn[i].slot_data && !conn[i].sse ? 1 : 0;
+            if (busy >= link.window(conn_count))
+                return false;
+        }
+
+        for (uint8_t i = 0; i < conn_count; i++)
+        {
+            if (conn[i].slot_data)
+                continue;
+
+            // The slot options are used as the connection affinity hints.
+            // The tasks of all services prefer the connection that was connected to the same host in the same (SSE) mode,
+            // the auth task then prefers the last connection that is dedicated to the token refresh, then the idle connection
+            // and the kept-alive connection to the other host that was idle for the longest time are used.
+            const String &connHost = i == conn_index ? host : conn[i].host;
+            bool connSSE = i == conn_index ? sse : conn[i].sse;
+            int s = 0;
+            if (connHost.length() && connSSE == sData->sse && strcmp(connHost.c_str(), reqHost.c_str()) == 0)
+                s = 3;
+            else if (sData->auth_used && i == conn_count - 1)
+                s = 2;
+            else if (connHost.length() == 0)
+                s = 1;
+
+            unsigned long a = conn[i].idle_ms ? millis() - conn[i].idle_ms : (unsigned long)-1;
+            if (s > score || (s == 0 && score == 0 && a > age))
+            {
+                score = s;
+                index = i;
+                age = a;
+            }
+        }
+
+        if (index == -1)
+            return false;
+
+        conn[index].slot_data = sData;
+        sData->conn_index = index;
+        switchConn(index);
+        return true;
+    }
+
+    // Returns the connection of network client in pool or in the failover networks.
+    async_conn_t *findConn(Client *netClient)
+    {
+        uint8_t count = failover_index > 0 ? failover_pool : conn_count;
+        for (uint8_t i = 0; i < count; i++)
+        {
+            if (conn[i].client == netClient)
+                return &conn[i];
+        }
+        for (uint8_t i = 0; i < failover_count; i++)
+        {
+            if (i != failover_index && failover_conn[i].client == netClient)
+                return &failover_conn[i];
+        }
+        return nullptr;
+    }
+
+    void unbindConn(async_data_item_t *sData)
+    {
+        if (sData->conn_index > -1 && sData->conn_index < conn_count && conn[sData->conn_index].slot_data == sData)
+            conn[sData->conn_index].slot_data = nullptr;
+        sData->conn_index = -1;
+    }
 
     void closeFile(async_data_item_t *sData)
     {
@@ -218,6 +794,9 @@ private:
         sData->request.file_data.cb(sData->request.file_data.file, sData->request.file_data.filename.c_str(), mode);
         if (!sData->request.file_data.file)
             return false;
+        // The slice of file is read from its offset.
+        if (mode == file_mode_open_read && sData->request.file_data.range_size)
+            sData->request.file_data.file.seek(sData->request.file_data.range_offset);
 #else
         return false;
 #endif
@@ -225,13 +804,34 @@ private:
         return true;
     }
 
+    // Count the new connection, the connection to the host that was previously connected is the reconnection.
+    void countConnect(bool resumed)
+    {
+        FirebaseMetrics &m = FirebaseMetrics::shared();
+        m.add(this->host.length() ? metrics_reconnects : metrics_connects);
+        m.add(resumed ? metrics_tls_resumed : metrics_tls_full);
+    }
+
+    // Stop the current connection unless it is the kept-alive connection to the same host and port in the same (SSE) mode.
     void newCon(async_data_item_t *sData, const char *host, uint16_t port)
     {
-        if ((sse && !sData->sse) || (!sse && sData->sse) || (sData->auth_used && sData->state == async_state_undefined) ||
+        if ((sse && !sData->sse) || (!sse && sData->sse) || (sData->auth_used && sData->state == async_state_undefined && !keep_alive) ||
             strcmp(this->host.c_str(), host) != 0 || this->port != port)
             stop(sData);
     }
 
+    // Returns true if the payload is small enough to send with the header in one write.
+    bool isCoalesced(async_data_item_t *sData, size_t headerLen)
+    {
+#if defined(ENABLE_GZIP)
+        if (sData->deflate)
+            return false;
+#endif
+        size_t len = sData->request.val[req_hndlr_ns::payload].length();
+        return len > 0 && !sData->upload && headerLen + len <= FIREBASE_COALESCE_WRITE_SIZE &&
+               sData->request.method != async_request_handler_t::http_get && sData->request.method != async_request_handler_t::http_delete && sData->request.method != async_request_handler_t::http_head;
+    }
+
     function_return_type sendHeader(async_data_item_t *sData, const char *data)
     {
         return send(sData, (uint8_t *)data, data ? strlen(data) : 0, data ? strlen(data) : 0, async_state_send_header);
@@ -242,11 +842,30 @@ private:
         return send(sData, data, len, len, async_state_send_header);
     }
 
+    // Send the header segment (prefix, token or suffix) at the sent position, the token placeholder is at tokenPos.
+    function_return_type sendHeader(async_data_item_t *sData, int tokenPos, size_t size)
+    {
+        const String &hdr = sData->request.val[req_hndlr_ns::header];
+        const String &tk = sData->request.app_token->val[app_tk_ns::token];
+        size_t pos = tokenPos, index = sData->request.payloadIndex, skip = strlen(FIREBASE_AUTH_PLACEHOLDER);
+
+        if (index < pos)
+            return send(sData, (uint8_t *)hdr.c_str(), pos, size, async_state_send_header);
+        if (index < pos + tk.length())
+            return send(sData, (uint8_t *)tk.c_str(), tk.length(), size, async_state_send_header);
+        return send(sData, (uint8_t *)hdr.c_str() + pos + skip, hdr.length() - pos - skip, size, async_state_send_header);
+    }
+
     function_return_type sendBuff(async_data_item_t *sData, async_state state = async_state_send_payload)
     {
         function_return_type ret = function_return_type_continue;
 
+        // The next block is sent in the next process call.
+        if (budgetSpent(sData))
+            return ret;
+
 #if defined(ENABLE_FS)
+        Memory mem(&sData->arena, &sData->mem_stats);
 
         size_t totalLen = sData->request.file_data.file_size;
         bool fopen = sData->request.payloadIndex == 0;
@@ -281,6 +900,10 @@ private:
                 }
             }
 
+            // The block that was read ahead is not used in the new transfer.
+            releaseBlock(sData);
+            sData->hash.begin();
+
             if (sData->request.base64)
             {
                 ret = send(sData, (uint8_t *)"\"", 1, totalLen, async_state_send_payload);
@@ -289,31 +912,71 @@ private:
             }
         }
 
-        uint8_t *buf = nullptr;
-        int toSend = 0;
-        if (sData->request.file_data.filename.length() > 0 ? sData->request.file_data.file.available() : sData->request.file_data.data_pos < sData->request.file_data.data_size)
+#if defined(ENABLE_CLOUD_STORAGE)
+        // The range that does not follow the sent range e.g. of the resumed session is read from the committed offset.
+        if (sData->request.file_data.resumable.isUpload() && sData->request.file_data.resumable.seekRange())
         {
-            if (sData->request.base64)
+            int offset = sData->request.file_data.resumable.getIndex();
+            if (sData->request.file_data.filename.length() > 0)
             {
-
-                toSend = FIREBASE_BASE64_CHUNK_SIZE;
-
-                if (sData->request.file_data.filename.length() > 0)
+                if (sData->request.file_data.file_status == file_config_data::file_status_closed && !openFile(sData, file_mode_open_read))
                 {
-                    if (sData->request.file_data.file.available() < toSend)
-                        toSend = sData->request.file_data.file.available();
+                    setAsyncError(sData, state, FIREBASE_ERROR_OPEN_FILE, !sData->sse, true);
+                    return function_return_type_failure;
                 }
-                else
+                sData->request.file_data.file.seek(offset);
+            }
+            sData->request.file_data.data_pos = offset;
+            releaseBlock(sData);
+            // The hash of the data that were sent before is not known.
+            if (offset > 0)
+                sData->hash.clear();
+        }
+#endif
+
+        if (sData->request.file_data.chunked())
+        {
+            ret = sendChunk(sData, mem, state);
+            updateMemStats(sData);
+            sData->arena.reset();
+            return ret;
+        }
+
+        uint8_t *buf = nullptr, *out = nullptr;
+        int toSend = 0;
+        bool readAhead = sData->request.base64 && sData->request.file_data.filename.length() > 0;
+        if (sData->request.file_data.filename.length() > 0 ? sData->file_block_len > 0 || sData->request.file_data.file.available() : sData->request.file_data.data_pos < sData->request.file_data.dataLength())
+        {
+            if (readAhead)
+            {
+                // The first block, the next blocks were read after the previous block was sent.
+                if (sData->file_block_len == 0 && !readBlock(sData))
                 {
-                    if ((int)(sData->request.file_data.data_size - sData->request.file_data.data_pos) < toSend)
-                        toSend = sData->request.file_data.data_size - sData->request.file_data.data_pos;
+                    setAsyncError(sData, state, FIREBASE_ERROR_FILE_READ, !sData->sse, true);
+                    ret = function_return_type_failure;
+                    goto exit;
                 }
 
-                buf = reinterpret_cast<uint8_t *>(mem.alloc(toSend));
-                if (sData->request.file_data.filename.length() > 0)
+                sData->hash.update(sData->file_block, sData->file_block_len);
+                buf = reinterpret_cast<uint8_t *>(mem.alloc(but.encodedLength(sData->file_block_len), false, mem_class_file));
+                toSend = Base64Util::encodeChars(sData->file_block, sData->file_block_len, (char *)buf, false);
+                sData->file_block_len = 0;
+            }
+            else if (sData->request.base64)
+            {
+                int len = sData->base64ChunkSize();
+
+                if ((int)(sData->request.file_data.dataLength() - sData->request.file_data.data_pos) < len)
+                    len = sData->request.file_data.dataLength() - sData->request.file_data.data_pos;
+
+                // The source data are read to the end of send buffer and encoded in place, the blob data are encoded from its buffer.
+                size_t size = but.encodedLength(len) - 1;
+                buf = reinterpret_cast<uint8_t *>(mem.alloc(size, false, mem_class_file));
+                const uint8_t *raw = buf + size - len;
+                if (sData->request.file_data.source)
                 {
-                    toSend = sData->request.file_data.file.read(buf, toSend);
-                    if (toSend == 0)
+                    // The base64 encoded block should be complete.
+                    if (readSource(sData, buf + size - len, len) != len)
                     {
                         setAsyncError(sData, state, FIREBASE_ERROR_FILE_READ, !sData->sse, true);
                         ret = function_return_type_failure;
@@ -321,15 +984,11 @@ private:
                     }
                 }
                 else if (sData->request.file_data.data)
-                {
-                    memcpy(buf, sData->request.file_data.data + sData->request.file_data.data_pos, toSend);
-                    sData->request.file_data.data_pos += toSend;
-                }
+                    raw = sData->request.file_data.data + sData->request.file_data.data_pos;
 
-                uint8_t *temp = (uint8_t *)but.encodeToChars(mem, buf, toSend);
-                mem.release(&buf);
-                toSend = strlen((char *)temp);
-                buf = temp;
+                sData->request.file_data.data_pos += len;
+                sData->hash.update(raw, len);
+                toSend = Base64Util::encodeChars(raw, len, (char *)buf, false);
             }
             else
             {
@@ -337,15 +996,14 @@ private:
                 if (sData->request.file_data.resumable.isEnabled() && sData->request.file_data.resumable.isUpload())
                     toSend = sData->request.file_data.resumable.getChunkSize(totalLen, sData->request.payloadIndex, sData->request.file_data.data_pos);
                 else if (sData->request.file_data.multipart.isEnabled() && sData->request.file_data.multipart.getState() == file_upload_multipart_data::multipart_state_send_data_payload)
-                    toSend = sData->request.file_data.multipart.getChunkSize(totalLen, sData->request.payloadIndex, sData->request.file_data.data_pos);
+                    toSend = sData->request.file_data.multipart.getChunkSize(totalLen, sData->request.payloadIndex, sData->request.file_data.data_pos, sData->chunk_size);
                 else
 #endif
-                    toSend = totalLen - sData->request.file_data.data_pos < FIREBASE_CHUNK_SIZE ? totalLen - sData->request.file_data.data_pos : FIREBASE_CHUNK_SIZE;
-
-                buf = reinterpret_cast<uint8_t *>(mem.alloc(toSend));
+                    toSend = totalLen - sData->request.file_data.data_pos < sData->chunk_size ? totalLen - sData->request.file_data.data_pos : sData->chunk_size;
 
                 if (sData->request.file_data.filename.length() > 0)
                 {
+                    buf = reinterpret_cast<uint8_t *>(mem.alloc(toSend, false, mem_class_file));
                     toSend = sData->request.file_data.file.read(buf, toSend);
                     if (toSend == 0)
                     {
@@ -354,71 +1012,442 @@ private:
                         goto exit;
                     }
                 }
+                else if (sData->request.file_data.source)
+                {
+                    buf = reinterpret_cast<uint8_t *>(mem.alloc(toSend, false, mem_class_file));
+                    toSend = readSource(sData, buf, toSend);
+                    if (toSend <= 0)
+                    {
+                        setAsyncError(sData, state, FIREBASE_ERROR_FILE_READ, !sData->sse, true);
+                        ret = function_return_type_failure;
+                        goto exit;
+                    }
+                }
                 else if (sData->request.file_data.data)
                 {
-                    memcpy(buf, sData->request.file_data.data + sData->request.file_data.data_pos, toSend);
+                    // The blob data e.g. the memory-mapped flash of PartitionConfig are sent from its buffer.
+                    out = sData->request.file_data.data + sData->request.file_data.data_pos;
                 }
 
+                sData->hash.update(out ? out : buf, toSend);
                 sData->request.file_data.data_pos += toSend;
             }
 
-            ret = send(sData, buf, toSend, totalLen, async_state_send_payload);
+            ret = send(sData, out ? out : buf, toSend, totalLen, async_state_send_payload);
+
+            // Read the next block while the network stack transmits the sent block.
+            if (readAhead && ret == function_return_type_continue && sData->request.file_data.file.available())
+                readBlock(sData);
         }
         else if (sData->request.base64)
             ret = send(sData, (uint8_t *)"\"", 1, totalLen, async_state_send_payload);
 
+        if (ret != function_return_type_continue)
+            releaseBlock(sData);
+
     exit:
 
+        updateMemStats(sData);
         if (buf)
             mem.release(&buf);
+        sData->arena.reset();
 #endif
 
         return ret;
     }
 
-    function_return_type send(async_data_item_t *sData, const char *data, async_state state = async_state_send_payload)
+#if defined(ENABLE_FS)
+    // Fill the buffer from producer source that may return less data than requested, returns the bytes that were read or -1 for error.
+    int readSource(async_data_item_t *sData, uint8_t *buf, size_t len)
     {
-        return send(sData, (uint8_t *)data, data ? strlen(data) : 0, data ? strlen(data) : 0, state);
+        size_t read = 0;
+        while (read < len)
+        {
+            int ret = sData->request.file_data.source(buf + read, len - read, sData->request.file_data.data_pos + read);
+            if (ret < 0)
+                return -1;
+            if (ret == 0)
+                break;
+            read += ret > (int)(len - read) ? len - read : ret;
+        }
+        return read;
     }
 
-    function_return_type send(async_data_item_t *sData, uint8_t *data, size_t len, size_t size, async_state state = async_state_send_payload)
+    // Send the next block of producer source as the chunk of chunked transfer encoding, the last (empty) chunk is sent when the source has no more data.
+    function_return_type sendChunk(async_data_item_t *sData, Memory &mem, async_state state)
     {
-        sData->state = state;
+        // The chunk size line (up to 4 hex digits and CRLF) is written before the data.
+        const size_t head = 8, cap = sData->chunk_size - head - 2;
+        uint8_t *buf = reinterpret_cast<uint8_t *>(mem.alloc(sData->chunk_size, false, mem_class_file));
+        if (!buf)
+        {
+            setAsyncError(sData, state, FIREBASE_ERROR_FILE_READ, !sData->sse, true);
+            return function_return_type_failure;
+        }
 
-        if (data && len && this->client)
+        int len = readSource(sData, buf + head, cap);
+        if (len < 0)
         {
-            uint16_t toSend = len - sData->request.dataIndex > FIREBASE_CHUNK_SIZE ? FIREBASE_CHUNK_SIZE : len - sData->request.dataIndex;
+            mem.release(&buf);
+            setAsyncError(sData, state, FIREBASE_ERROR_FILE_READ, !sData->sse, true);
+            return function_return_type_failure;
+        }
 
-            size_t sent = sData->request.tcpWrite(client_type, client, async_tcp_config, data + sData->request.dataIndex, toSend);
-            sys_idle();
+        sData->hash.update(buf + head, len);
+        sData->request.file_data.data_pos += len;
 
-            if (sent == toSend)
+        char line[head + 1];
+        int n = snprintf(line, sizeof(line), "%x\r\n", len);
+        uint8_t *chunk = buf + head - n;
+        memcpy(chunk, line, n);
+        // The CRLF of last (empty) chunk is also the end of empty trailer.
+        memcpy(buf + head + len, "\r\n", 2);
+        size_t chunkLen = n + len + 2;
+
+        // The payload length is not known until the last chunk was sent.
+        function_return_type ret = send(sData, chunk, chunkLen, sData->request.payloadIndex + chunkLen + (len == 0 ? 0 : 1), async_state_send_payload);
+        mem.release(&buf);
+        return ret;
+    }
+
+    // Read the next file block to the read-ahead buffer, the block size is a multiple of 3 for base64 encoding.
+    bool readBlock(async_data_item_t *sData)
+    {
+        const size_t blockSize = ((FIREBASE_FILE_BLOCK_SIZE < sData->chunk_size / 4 * 3 ? FIREBASE_FILE_BLOCK_SIZE : sData->chunk_size / 4 * 3) / 3) * 3;
+        if (!sData->file_block)
+        {
+            Memory heap(nullptr, &sData->mem_stats);
+            sData->file_block = reinterpret_cast<uint8_t *>(heap.alloc(blockSize, false, mem_class_file));
+        }
+
+        int len = sData->request.file_data.file.available();
+        if (!sData->file_block || len <= 0)
+            return false;
+
+        sData->file_block_len = sData->request.file_data.file.read(sData->file_block, (size_t)len < blockSize ? len : blockSize);
+        return sData->file_block_len > 0;
+    }
+
+    // Decode to the write-behind buffer, the file is written in blocks and the remaining data are written at the end of payload.
+    bool writeBlock(async_data_item_t *sData, const uint8_t *src, size_t len)
+    {
+        const size_t cap = FIREBASE_FILE_BLOCK_SIZE + sData->chunk_size;
+        if (!sData->file_block)
+        {
+            Memory heap(nullptr, &sData->mem_stats);
+            sData->file_block = reinterpret_cast<uint8_t *>(heap.alloc(cap, false, mem_class_file));
+            sData->file_block_len = 0;
+        }
+
+        size_t written = 0;
+        if (!sData->file_block)
+        {
+            // The data are decoded and written in small pieces.
+            uint8_t out[64];
+            while (len > 0)
             {
-                sData->request.dataIndex += toSend;
-                sData->request.payloadIndex += toSend;
+                size_t n = sData->b64.decode(src, len, out, sizeof(out), written);
+                sData->hash.update(out, written);
+                if (n == 0 || (written && sData->request.file_data.file.write(out, written) != written))
+                    return false;
+                src += n;
+                len -= n;
+            }
+            return true;
+        }
+
+        // The decoded data of chunk are usually less than the chunk size, the remaining characters are decoded
+        // after the full blocks were written.
+        while (true)
+        {
+            size_t n = sData->b64.decode(src, len, sData->file_block + sData->file_block_len, cap - sData->file_block_len, written);
+            sData->hash.update(sData->file_block + sData->file_block_len, written);
+            sData->file_block_len += written;
+            src += n;
+            len -= n;
+
+            bool last = len == 0 && sData->response.payloadRead >= sData->response.payloadLen;
+            size_t flushed = 0;
+            while (sData->file_block_len - flushed >= FIREBASE_FILE_BLOCK_SIZE || (last && sData->file_block_len > flushed))
+            {
+                size_t size = sData->file_block_len - flushed < FIREBASE_FILE_BLOCK_SIZE ? sData->file_block_len - flushed : FIREBASE_FILE_BLOCK_SIZE;
+                if (sData->request.file_data.file.write(sData->file_block + flushed, size) != size)
+                    return false;
+                flushed += size;
+            }
+
+            sData->file_block_len -= flushed;
+            if (flushed && sData->file_block_len)
+                memmove(sData->file_block, sData->file_block + flushed, sData->file_block_len);
+
+            if (len == 0)
+            {
+                if (last)
+                    releaseBlock(sData);
+                return true;
+            }
+
+            // The characters could not be decoded to the block.
+            if (n == 0 && flushed == 0)
+                return false;
+        }
+    }
 
-#if defined(ENABLE_FS)
-                if (sData->upload && sData->upload_progress_enabled && sData->request.file_data.file_size)
-                {
-                    sData->aResult.upload_data.total = size;
-                    sData->aResult.upload_data.uploaded = sData->request.payloadIndex;
-                    returnResult(sData, false);
-                }
 #endif
 
-                if (sData->request.dataIndex == len)
-                    sData->request.dataIndex = 0;
+    void releaseBlock(async_data_item_t *sData)
+    {
+        Memory heap(nullptr, &sData->mem_stats);
+        heap.release(&sData->file_block);
+        sData->file_block_len = 0;
+    }
 
-#if defined(ENABLE_FS) && defined(ENABLE_CLOUD_STORAGE)
+    // The download data that were not accepted by the sink are waiting.
+    bool sinkPending(async_data_item_t *sData) { return sData->download && sData->request.file_data.sink && sData->file_block_len > 0; }
 
-                if (sData->request.file_data.resumable.isEnabled() && sData->request.file_data.resumable.isUpload())
-                {
-                    int ret = sData->request.file_data.resumable.isComplete(size, sData->request.payloadIndex);
-                    if (ret == 2)
-                    {
-                        sData->state = async_state_read_response;
-                        sData->return_type = function_return_type_complete;
-                        sData->request.dataIndex = 0;
+    // Push the download data to the sink, the data that were not accepted are kept until the sink has room.
+    bool writeSink(async_data_item_t *sData, const uint8_t *data, size_t len)
+    {
+        // The data_pos is the bytes that were accepted by the sink.
+        int ret = sData->request.file_data.sink(data, len, sData->request.file_data.data_pos);
+        if (ret < 0)
+            return false;
+
+        size_t accepted = (size_t)ret > len ? len : ret;
+        sData->request.file_data.data_pos += accepted;
+        if (accepted == len)
+            return true;
+
+        // The socket is not read while these data are waiting then the data are not more than one read.
+        if (!sData->file_block)
+        {
+            Memory heap(nullptr, &sData->mem_stats);
+            sData->file_block = reinterpret_cast<uint8_t *>(heap.alloc(sData->chunk_size + 1, false, mem_class_file));
+        }
+
+        if (!sData->file_block || len - accepted > (size_t)sData->chunk_size + 1)
+            return false;
+
+        sData->file_block_len = len - accepted;
+        memcpy(sData->file_block, data + accepted, sData->file_block_len);
+        return true;
+    }
+
+    struct download_sink_t
+    {
+        AsyncClientClass *client;
+        async_data_item_t *sData;
+    };
+
+    // The last stage of download pipeline, the data are written to the file, sink or blob of request.
+    static bool downloadSink(void *arg, const uint8_t *data, size_t len)
+    {
+        download_sink_t *d = reinterpret_cast<download_sink_t *>(arg);
+#if defined(ENABLE_FS)
+        if (d->sData->request.file_data.filename.length() && d->sData->request.file_data.cb)
+            return d->sData->request.file_data.file.write(data, len) == len;
+#endif
+        if (d->sData->request.file_data.sink)
+            return d->client->writeSink(d->sData, data, len);
+        d->sData->request.file_data.outB.write(data, len);
+        return true;
+    }
+
+    // Write the download data through the pipeline read data → [base64 decode] → [hash] → file, sink or blob.
+    // The base64 data are decoded in place of the read buffer.
+    bool writeDownload(async_data_item_t *sData, uint8_t *data, size_t len)
+    {
+        download_sink_t d = {this, sData};
+        IOPipeline pipeline(downloadSink, &d);
+        if (sData->request.base64)
+            pipeline.decodeBase64(sData->b64);
+        return pipeline.hash(sData->hash).write(data, len);
+    }
+
+    // Offer the waiting data to the sink again, returns -1 for sink error, 0 when the data are still waiting or 1 when they were accepted.
+    int drainSink(async_data_item_t *sData)
+    {
+        int ret = sData->request.file_data.sink(sData->file_block, sData->file_block_len, sData->request.file_data.data_pos);
+        if (ret < 0)
+            return -1;
+
+        size_t accepted = (size_t)ret > sData->file_block_len ? sData->file_block_len : ret;
+        sData->request.file_data.data_pos += accepted;
+        sData->file_block_len -= accepted;
+        if (accepted && sData->file_block_len)
+            memmove(sData->file_block, sData->file_block + accepted, sData->file_block_len);
+        return sData->file_block_len == 0 ? 1 : 0;
+    }
+
+#if defined(ENABLE_FS)
+    // The spool file of request is named by the task id, the response spool files are used in turn.
+    String spoolName(async_data_item_t *sData, bool res)
+    {
+        String name = spool_name;
+        name += '.';
+        name += res ? spool_res_index : sData->id;
+        name += res ? FPSTR(".res") : FPSTR(".req");
+        return name;
+    }
+
+    void closeSpool(async_data_item_t *sData)
+    {
+        if (!sData->spool_opened)
+            return;
+        sData->spool_file.close();
+        sData->spool_opened = false;
+    }
+
+    // Write the large request payload to the spool file and free it, the payload is sent from the file.
+    void spoolRequest(async_data_item_t *sData, size_t len)
+    {
+        String &payload = sData->request.val[req_hndlr_ns::payload];
+        if (!spool_cb || !spool_threshold || len <= spool_threshold || payload.length() != len || sData->upload || sData->writer || sData->sse)
+            return;
+
+        String name = spoolName(sData, false);
+        spool_cb(sData->spool_file, name.c_str(), file_mode_open_write);
+        if (!sData->spool_file)
+            return;
+        size_t written = sData->spool_file.write(reinterpret_cast<const uint8_t *>(payload.c_str()), len);
+        sData->spool_file.close();
+        // The payload is kept in memory when it could not be spooled.
+        if (written != len)
+            return;
+
+        payload = String();
+        sData->spool_req = true;
+        sData->spool_len = len;
+    }
+
+    // Send the next chunk of request payload from the spool file.
+    function_return_type sendSpool(async_data_item_t *sData)
+    {
+        // The next chunk is sent in the next process call.
+        if (budgetSpent(sData))
+            return function_return_type_continue;
+
+        if (!sData->spool_opened)
+        {
+            spool_cb(sData->spool_file, spoolName(sData, false).c_str(), file_mode_open_read);
+            if (!sData->spool_file)
+            {
+                setAsyncError(sData, async_state_send_payload, FIREBASE_ERROR_OPEN_FILE, !sData->sse, true);
+                return function_return_type_failure;
+            }
+            sData->spool_opened = true;
+        }
+
+        Memory mem(&sData->arena, &sData->mem_stats);
+        uint8_t *buf = reinterpret_cast<uint8_t *>(mem.alloc(sData->chunk_size, false, mem_class_chunk));
+        int read = 0;
+        if (buf && sData->spool_file.seek(sData->request.payloadIndex))
+            read = sData->spool_file.read(buf, sData->chunk_size);
+
+        function_return_type ret = send(sData, buf, read > 0 ? read : 0, sData->spool_len);
+        mem.release(&buf);
+        sData->arena.reset();
+        if (ret != function_return_type_continue)
+            closeSpool(sData);
+        return ret;
+    }
+
+    // Write the successful response payload that is larger than the spool threshold to the spool file instead of result payload.
+    void spoolResponse(async_data_item_t *sData)
+    {
+        if (!spool_cb || !spool_threshold || sData->response.payloadLen <= spool_threshold || sData->request.ota ||
+            sData->response.httpCode < FIREBASE_ERROR_HTTP_CODE_OK || sData->response.httpCode >= 300)
+            return;
+
+        spool_res_index = (spool_res_index + 1) % FIREBASE_SPOOL_RESPONSE_FILES;
+        String name = spoolName(sData, true);
+        spool_cb(sData->spool_file, name.c_str(), file_mode_open_write);
+        if (!sData->spool_file)
+            return;
+
+        sData->spool_opened = true;
+        sData->spool_res = true;
+        sData->sink = &sData->spool_file;
+        sData->aResult.setSpoolFile(name);
+    }
+#endif
+
+    // Send the next chunk of payload that generated by the payload writer, the writer continues from its next part.
+    function_return_type sendWriter(async_data_item_t *sData)
+    {
+        Memory mem(&sData->arena, &sData->mem_stats);
+        uint8_t *buf = reinterpret_cast<uint8_t *>(mem.alloc(sData->chunk_size, false, mem_class_chunk));
+        size_t len = 0;
+        if (buf)
+        {
+            std::vector<uint8_t> &carry = sData->writer_carry;
+            len = carry.size() - sData->writer_carry_pos < sData->chunk_size ? carry.size() - sData->writer_carry_pos : sData->chunk_size;
+            if (len)
+                memcpy(buf, carry.data() + sData->writer_carry_pos, len);
+            sData->writer_carry_pos += len;
+            if (sData->writer_carry_pos == carry.size())
+            {
+                carry.clear();
+                sData->writer_carry_pos = 0;
+            }
+
+            AsyncPayloadWindow window(buf + len, sData->chunk_size - len, &carry);
+            while (!window.full() && sData->writer_more)
+                sData->writer_more = sData->writer(window, sData->writer_part++);
+            len += window.length();
+        }
+
+        function_return_type ret = send(sData, buf, len, sData->writer_len);
+        mem.release(&buf);
+        sData->arena.reset();
+        return ret;
+    }
+
+    function_return_type send(async_data_item_t *sData, const char *data, async_state state = async_state_send_payload)
+    {
+        return send(sData, (uint8_t *)data, data ? strlen(data) : 0, data ? strlen(data) : 0, state);
+    }
+
+    function_return_type send(async_data_item_t *sData, uint8_t *data, size_t len, size_t size, async_state state = async_state_send_payload)
+    {
+        sData->state = state;
+
+        if (data && len && this->client)
+        {
+            corkConn(true);
+
+            uint16_t toSend = len - sData->request.dataIndex > sData->chunk_size ? sData->chunk_size : len - sData->request.dataIndex;
+
+            size_t sent = sData->request.tcpWrite(client_type, client, async_tcp_config, data + sData->request.dataIndex, toSend);
+            sys_idle();
+
+            if (sent == toSend)
+            {
+                sData->request.dataIndex += toSend;
+                sData->request.payloadIndex += toSend;
+
+#if defined(ENABLE_FS)
+                if (sData->upload && sData->upload_progress_enabled && sData->request.file_data.file_size)
+                {
+                    sData->aResult.upload_data.total = size;
+                    sData->aResult.upload_data.uploaded = sData->request.payloadIndex;
+                    returnResult(sData, false);
+                }
+#endif
+
+                if (sData->request.dataIndex == len)
+                    sData->request.dataIndex = 0;
+
+#if defined(ENABLE_FS) && defined(ENABLE_CLOUD_STORAGE)
+
+                if (sData->request.file_data.resumable.isEnabled() && sData->request.file_data.resumable.isUpload())
+                {
+                    int ret = sData->request.file_data.resumable.isComplete(size, sData->request.payloadIndex);
+                    if (ret == 2)
+                    {
+                        sData->state = async_state_read_response;
+                        sData->return_type = function_return_type_complete;
+                        sData->request.dataIndex = 0;
                         sData->request.payloadIndex = 0;
                         sData->response.clear();
                         return sData->return_type;
@@ -492,6 +1521,14 @@ private:
         return sData->return_type;
     }
 
+    // The async task requires the token that is not issued yet, it waits up to FIREBASE_AUTH_WAIT_MS from when it was created.
+    bool awaitingToken(async_data_item_t *sData)
+    {
+        const app_token_t *tk = sData->request.app_token;
+        return sData->async && !sData->auth_used && tk && tk->auth_data_type != user_auth_data_no_token && tk->auth_data_type != user_auth_data_undefined && !tk->authenticated &&
+               tk->val[app_tk_ns::token].length() == 0 && millis() - sData->deadline_start < FIREBASE_AUTH_WAIT_MS;
+    }
+
     function_return_type send(async_data_item_t *sData)
     {
         if (!sData || !netConnect(sData))
@@ -504,6 +1541,10 @@ private:
 
         if (sData->state == async_state_undefined || sData->state == async_state_send_header)
         {
+            // The task is sent as soon as the token was issued, the connection is not made while waiting.
+            if (sData->state == async_state_undefined && awaitingToken(sData))
+                return function_return_type_continue;
+
             newCon(sData, getHost(sData, true).c_str(), sData->request.port);
 
             if ((client_type == async_request_handler_t::tcp_client_type_sync && !client->connected()) || client_type == async_request_handler_t::tcp_client_type_async)
@@ -524,32 +1565,73 @@ private:
             if (sData->upload)
                 sData->upload_progress_enabled = false;
 
-            if (sData->request.app_token && sData->request.app_token->auth_data_type != user_auth_data_no_token)
+            // The payload is written again from the first part when the header was sent again.
+            if (sData->writer)
+                sData->resetWriter();
+
+            bool token = sData->request.app_token && sData->request.app_token->auth_data_type != user_auth_data_no_token;
+            if (token && sData->request.app_token->val[app_tk_ns::token].length() == 0)
             {
-                if (sData->request.app_token->val[app_tk_ns::token].length() == 0)
-                {
-                    setAsyncError(sData, sData->state, FIREBASE_ERROR_UNAUTHENTICATE, !sData->sse, false);
-                    return function_return_type_failure;
-                }
+                setAsyncError(sData, sData->state, FIREBASE_ERROR_UNAUTHENTICATE, !sData->sse, false);
+                return function_return_type_failure;
+            }
 
-                header = sData->request.val[req_hndlr_ns::header];
+#if defined(ENABLE_GZIP)
+            // The downloaded object is written as is, its stored encoding is not requested.
+            if (sData->accept_gzip && !sData->download)
+                sData->request.val[req_hndlr_ns::header].replace(FPSTR("Accept-Encoding: identity;q=1,chunked;q=0.1,*;q=0"), FPSTR("Accept-Encoding: gzip"));
+
+            if (sData->gzip_req && !sData->upload && !sData->writer)
+                beginDeflate(sData);
+#endif
+
+            size_t headerLen = sData->request.val[req_hndlr_ns::header].length();
+            int tokenPos = token ? sData->request.val[req_hndlr_ns::header].indexOf(FIREBASE_AUTH_PLACEHOLDER) : -1;
+            if (tokenPos > -1)
+                headerLen += sData->request.app_token->val[app_tk_ns::token].length() - strlen(FIREBASE_AUTH_PLACEHOLDER);
+
+            bool coalesced = isCoalesced(sData, headerLen);
+            if (tokenPos == -1 && !coalesced)
+                return sendHeader(sData, sData->request.val[req_hndlr_ns::header].c_str());
+
+            // The token is written from the app token between the header segments without copying the header.
+            if (!coalesced)
+                return sendHeader(sData, tokenPos, headerLen);
+
+            header = sData->request.val[req_hndlr_ns::header];
+            if (tokenPos > -1)
                 header.replace(FIREBASE_AUTH_PLACEHOLDER, sData->request.app_token->val[app_tk_ns::token]);
-                ret = sendHeader(sData, header.c_str());
-                header.remove(0, header.length());
-                return ret;
-            }
-            return sendHeader(sData, sData->request.val[req_hndlr_ns::header].c_str());
+
+            // Send the small payload with header in one write to avoid multiple TLS records and TCP segments.
+            if (coalesced)
+                header += sData->request.val[req_hndlr_ns::payload];
+
+            ret = sendHeader(sData, header.c_str());
+            if (coalesced && ret == function_return_type_complete)
+                sData->state = async_state_read_response;
+            header.remove(0, header.length());
+            return ret;
         }
         else if (sData->state == async_state_send_payload)
         {
             if (sData->upload)
                 sData->upload_progress_enabled = true;
 
-            if (sData->request.method == async_request_handler_t::http_get || sData->request.method == async_request_handler_t::http_delete)
+            if (sData->request.method == async_request_handler_t::http_get || sData->request.method == async_request_handler_t::http_delete || sData->request.method == async_request_handler_t::http_head)
                 sData->state = async_state_read_response;
             else
             {
-                if (sData->request.val[req_hndlr_ns::payload].length())
+                if (sData->writer)
+                    ret = sendWriter(sData);
+#if defined(ENABLE_FS)
+                else if (sData->spool_req)
+                    ret = sendSpool(sData);
+#endif
+#if defined(ENABLE_GZIP)
+                else if (sData->deflate)
+                    ret = sendDeflate(sData);
+#endif
+                else if (sData->request.val[req_hndlr_ns::payload].length())
                     ret = send(sData, sData->request.val[req_hndlr_ns::payload].c_str());
                 else if (sData->upload)
                 {
@@ -605,8 +1687,8 @@ private:
         {
             String ext;
             String host = getHost(sData, false, &ext);
-            if (client)
-                client->stop();
+            keep_alive = sData->response.flags.keep_alive;
+            newCon(sData, host.c_str(), sData->request.port);
             if (connect(sData, host.c_str(), sData->request.port) > function_return_type_failure)
             {
                 URLUtil uut;
@@ -623,6 +1705,15 @@ private:
 
         if (!sData->sse && sData->response.httpCode > 0 && !sData->response.flags.header_remaining && !sData->response.flags.payload_remaining)
         {
+            // Keep the connection open for the next request to the same host.
+            keep_alive = sData->response.flags.keep_alive;
+            if (!keep_alive)
+                stop(sData);
+            else
+            {
+                conn[conn_index].idle_ms = millis();
+                conn[conn_index].keep_alive_ms = conn[conn_index].idle_ms;
+            }
             sData->state = async_state_undefined;
             return function_return_type_complete;
         }
@@ -641,6 +1732,11 @@ private:
         sData->error.state = state;
         sData->error.code = code;
 
+#if defined(ENABLE_FS) && defined(ENABLE_CLOUD_STORAGE)
+        if (sData->upload && sData->request.file_data.resumable.isEnabled())
+            sData->request.file_data.resumable.rangeFailed();
+#endif
+
         if (toRemove)
             sData->to_remove = toRemove;
 
@@ -653,29 +1749,105 @@ private:
     async_data_item_t *getData(uint8_t slot)
     {
         if (slot < sVec.size())
-            return reinterpret_cast<async_data_item_t *>(sVec[slot]);
+            return sVec[slot];
         return nullptr;
     }
 
-    async_data_item_t *addSlot(int index = -1)
+    async_data_item_t *addSlot(int index = -1, bool auth_used = false)
     {
-        async_data_item_t *sData = new async_data_item_t();
+        async_data_item_t *sData = newSlotData(auth_used);
+        sData->id = slot_index.assign();
+        sData->uid_hash = 0;
         if (index > -1)
-            sVec.insert(sVec.begin() + index, sData->addr);
+            sVec.insert(sVec.begin() + index, sData);
         else
-            sVec.push_back(sData->addr);
+            sVec.push_back(sData);
 
         return sData;
     }
 
     AsyncResult *getResult(async_data_item_t *sData)
     {
-        List vec;
-        return vec.existed(rVec, sData->ref_result_addr) ? sData->refResult : nullptr;
+        return Registry::shared().get<AsyncResult>(sData->ref_result_handle);
+    }
+
+    // Returns the slot data from slot pool (if enabled) or heap, the auth task slot data is always allocated from heap
+    // because it is owned and deleted by FirebaseApp.
+    async_data_item_t *newSlotData(bool auth_used)
+    {
+#if defined(FIREBASE_ASYNC_SLOT_POOL)
+        if (!auth_used)
+        {
+            for (size_t i = 0; i < FIREBASE_ASYNC_QUEUE_LIMIT; i++)
+            {
+                if (!slotPoolUsed[i])
+                {
+                    slotPoolUsed[i] = true;
+                    recycleSlotData(&slotPool[i]);
+                    return &slotPool[i];
+                }
+            }
+        }
+#else
+        (void)auth_used;
+#endif
+        return new async_data_item_t();
+    }
+
+    void deleteSlotData(async_data_item_t *sData)
+    {
+#if defined(FIREBASE_ASYNC_SLOT_POOL)
+        if (sData >= slotPool && sData < slotPool + FIREBASE_ASYNC_QUEUE_LIMIT)
+        {
+            slotPoolUsed[sData - slotPool] = false;
+            return;
+        }
+#endif
+        delete sData;
+    }
+
+#if defined(FIREBASE_ASYNC_SLOT_POOL)
+    // Reset all states of the recycled slot data, the String capacity is retained.
+    void recycleSlotData(async_data_item_t *sData)
+    {
+        sData->reset();
+        sData->request.location.remove(0, sData->request.location.length());
+        sData->request.app_token = nullptr;
+        sData->response.auth_data_available = false;
+        sData->download = false;
+        sData->upload = false;
+        sData->upload_progress_enabled = false;
+        sData->conn_index = -1;
+        sData->auth_ts = 0;
+        sData->refResult = nullptr;
+        sData->ref_result_handle = 0;
+        sData->err_timer.feed(0);
+        sData->aResult.clear();
+        sData->aResult.error_available = false;
+#if defined(ENABLE_DATABASE)
+        sData->aResult.setNullETag(false);
+#endif
+    }
+#endif
+
+    // Sample the live bytes of slot buffers (arena, chunk and String buffers).
+    void updateMemStats(async_data_item_t *sData)
+    {
+        size_t live = sData->arena.size() + sData->aResult.payload_val.length();
+        for (size_t i = 0; i < req_hndlr_ns::max_type; i++)
+            live += sData->request.val[i].length();
+        for (size_t i = 0; i < res_hndlr_ns::max_type; i++)
+            live += sData->response.val[i].length();
+        sData->mem_stats.setLive(live);
+        if (sData->mem_stats.peak_bytes > Memory::globalStats().peak_bytes)
+            Memory::globalStats().peak_bytes = sData->mem_stats.peak_bytes;
+        sData->aResult.mem_stats = sData->mem_stats;
     }
 
-    void returnResult(async_data_item_t *sData, bool setData)
+    // The release is set when the slot is going to be removed, the slot then gives up the payload ownership.
+    void returnResult(async_data_item_t *sData, bool setData, bool release = false)
     {
+        updateMemStats(sData);
 
         bool error_notify_timeout = false;
         if (sData->err_timer.remaining() == 0)
@@ -692,17 +1864,36 @@ private:
             if (setData || error_notify_timeout || download_status || upload_status)
             {
                 uint32_t ms = sData->refResult->last_debug_ms;
+                // The payload is excluded from the result copy, it is moved or copied once after.
+                String payload = std::move(sData->aResult.payload_val);
                 *sData->refResult = sData->aResult;
                 // Restore last debug ms after.
                 sData->refResult->last_debug_ms = ms;
 
-                if (setData)
-                    sData->refResult->setPayload(sData->aResult.val[ares_ns::data_payload]);
+#if defined(FIREBASE_STATIC_BUFFERS)
+                // The reserved payload buffer is kept in slot.
+                bool moved = false;
+                (void)release;
+#else
+                bool moved = setData && release && !sData->cb;
+#endif
+                if (moved)
+                    sData->refResult->movePayload(payload);
+                else
+                {
+                    sData->refResult->payload_val = payload;
+                    if (setData && payload.length())
+                        sData->refResult->data_available = true;
+                    sData->refResult->setPayloadRef();
+                }
+
+                if (!moved)
+                    sData->aResult.payload_val = std::move(payload);
 
                 if (sData->aResult.download_data.downloaded == 0 || sData->aResult.upload_data.uploaded == 0)
                 {
-                    sData->refResult->setETag(sData->aResult.val[ares_ns::res_etag]);
-                    sData->refResult->setPath(sData->aResult.val[ares_ns::data_path]);
+                    sData->refResult->setETag(sData->aResult.cval(ares_ns::res_etag));
+                    sData->refResult->setPath(sData->aResult.cval(ares_ns::data_path));
                 }
             }
         }
@@ -735,22 +1926,9 @@ private:
         }
     }
 
-    int readLine(async_data_item_t *sData, String &buf)
+    int readLine(async_data_item_t *sData, String &buf, size_t size = 0)
     {
-        int p = 0;
-
-        while (sData->response.tcpAvailable(client_type, client, async_tcp_config))
-        {
-            int res = sData->response.tcpRead(client_type, client, async_tcp_config);
-            if (res > -1)
-            {
-                buf += (char)res;
-                p++;
-                if (res == '\n')
-                    return p;
-            }
-        }
-        return p;
+        return sData->response.readLine(client_type, client, async_tcp_config, buf, size);
     }
 
     uint32_t hex2int(const char *hex)
@@ -777,11 +1955,20 @@ private:
 
     bool readResponse(async_data_item_t *sData)
     {
-        if (!netConnect(sData) || !client || !sData)
+        if (!sData || !netConnect(sData) || (client_type == async_request_handler_t::tcp_client_type_sync && !client))
             return false;
 
-        if (sData->response.tcpAvailable(client_type, client, async_tcp_config) > 0)
+#if defined(ENABLE_DATABASE)
+        // The remaining events that were received in the same read are dispatched one at a time.
+        if (sData->response.flags.sse && !sData->auth_used && dispatchEvent(sData))
+            return true;
+#endif
+
+        // The data that was kept for the sink is offered again although no data is available.
+        if (sData->response.available(client_type, client, async_tcp_config) > 0 || sinkPending(sData))
         {
+            sData->aResult.timing_data.mark(sData->aResult.timing_data.first_byte_us);
+
             // status line or data?
             if (!readStatusLine(sData))
             {
@@ -798,38 +1985,101 @@ private:
                     {
                         if (!sData->auth_used)
                         {
-                            sData->aResult.setPayload(sData->response.val[res_hndlr_ns::payload]);
+                            // The SSE event is copied to result when it is complete.
+                            if (!sData->response.flags.sse)
+                                sData->aResult.setPayload(sData->response.val[res_hndlr_ns::payload]);
+
+                            if (sData->cache_key && !sData->download && !spooled(sData) && sData->response.httpCode == FIREBASE_ERROR_HTTP_CODE_OK)
+                                res_cache.put(sData->cache_key, sData->aResult.cval(ares_ns::res_etag), sData->response.val[res_hndlr_ns::payload]);
 
                             if (sData->aResult.download_data.total > 0)
                                 sData->aResult.data_available = false;
 #if defined(ENABLE_DATABASE)
 
                             if (sData->request.method == async_request_handler_t::http_post)
-                                sData->aResult.rtdbResult.parseNodeName();
+                                sData->aResult.rtdb().parseNodeName();
 
                             // data available from sse event
-                            if (sData->response.flags.sse && sData->response.val[res_hndlr_ns::payload].length())
-                            {
-                                // order of checking: event, data, newline
-                                if (sData->response.val[res_hndlr_ns::payload].indexOf("event: ") > -1 && sData->response.val[res_hndlr_ns::payload].indexOf("data: ") > -1 && sData->response.val[res_hndlr_ns::payload].indexOf("\n") > -1)
-                                {
-                                    // save payload to slot result
-                                    sData->aResult.setPayload(sData->response.val[res_hndlr_ns::payload]);
-                                    clear(sData->response.val[res_hndlr_ns::payload]);
-                                    sData->aResult.rtdbResult.parseSSE();
-                                    sData->response.flags.payload_available = true;
-                                    returnResult(sData, true);
-                                }
-                            }
+                            if (sData->response.flags.sse)
+                                dispatchEvent(sData);
 #endif
                         }
                     }
                 }
             }
         }
+        // The firmware block is written while no data is available.
+        else if (sData->ota_writer)
+            pollOTA(sData);
+
+        return true;
+    }
+
+#if defined(ENABLE_DATABASE)
+    // Dispatch the next complete event in the event buffer, the incomplete event is kept until its remaining lines were read.
+    bool dispatchEvent(async_data_item_t *sData)
+    {
+        String &payload = sData->response.val[res_hndlr_ns::payload];
+        SSEParser &parser = sData->response.sse_parser;
+        if (!parser.parse(payload))
+            return false;
 
+        // Copy the complete event only to the result.
+        sData->aResult.setPayload(payload);
+        sData->aResult.payload_val.remove(parser.end());
+        sData->aResult.rtdb().parseSSE(parser);
+        bool skip = isSnapshotUnchanged(sData, parser);
+        parser.consume(payload);
+
+        // The stream was connected.
+        sData->sse_retry = 0;
+        sData->sse_delay_ms = 0;
+        if (skip)
+            return true;
+        if (sData->event_handler)
+            sData->event_handler(sData->event_ctx, sData->aResult);
+        sData->response.flags.payload_available = true;
+        returnResult(sData, true);
         return true;
     }
+#endif
+
+    // Check the initial put after reconnection, it is unchanged when the data are the same as the last initial put and no data changed since.
+    bool isSnapshotUnchanged(async_data_item_t *sData, const SSEParser &parser)
+    {
+        if (parser.type() != sse_event_put && parser.type() != sse_event_patch)
+            return false;
+
+        if (parser.type() == sse_event_patch || sData->aResult.rtdb().dataPath() != "/")
+        {
+            sData->sse_changed = true;
+            return false;
+        }
+
+        json_span_t dt = parser.data();
+        uint32_t h = ResponseCache::hash(sData->aResult.payload_val.c_str() + dt.start, dt.length());
+        bool unchanged = skip_snapshot && sData->sse_resumed && !sData->sse_changed && h == sData->sse_snapshot;
+        sData->sse_snapshot = h;
+        sData->sse_changed = false;
+        sData->sse_resumed = false;
+        return unchanged;
+    }
+
+    // Delay the reconnection of stream with the jittered exponential backoff.
+    void setBackoff(async_data_item_t *sData)
+    {
+        unsigned long delay = FIREBASE_SSE_BACKOFF_MIN;
+        for (uint8_t i = 0; i < sData->sse_retry && delay < FIREBASE_SSE_BACKOFF_MAX; i++)
+            delay *= 2;
+        if (delay > FIREBASE_SSE_BACKOFF_MAX)
+            delay = FIREBASE_SSE_BACKOFF_MAX;
+        if (sData->sse_retry < 255)
+            sData->sse_retry++;
+        // The half of delay is random to spread the reconnections of devices after the outage.
+        sData->sse_delay_ms = delay / 2 + random(delay / 2 + 1);
+        sData->sse_retry_ms = millis();
+        sData->sse_resumed = true;
+    }
 
     int getStatusCode(const String &header)
     {
@@ -848,8 +2098,6 @@ private:
         if (sData->response.httpCode > 0)
             return false;
 
-        sData->response.val[res_hndlr_ns::header].reserve(1024);
-
         // the first chunk (line) can be http response status or already connected stream payload
         readLine(sData, sData->response.val[res_hndlr_ns::header]);
         int status = getStatusCode(sData->response.val[res_hndlr_ns::header]);
@@ -858,164 +2106,715 @@ private:
             // http response status
             sData->response.flags.header_remaining = true;
             sData->response.httpCode = status;
+            sData->response.flags.keep_alive = true;
+            clear(sData->response.val[res_hndlr_ns::etag]);
+            clear(sData->response.val[res_hndlr_ns::hash]);
+            clear(sData->response.val[res_hndlr_ns::header]);
         }
         return true;
     }
 
+    // Reserve the payload buffer from Content-Length to avoid the reallocations (and copies) while reading.
+    void reservePayload(async_data_item_t *sData)
+    {
+        size_t len = sData->response.payloadLen;
+        if (FIREBASE_PAYLOAD_RESERVE_LIMIT == 0 || len == 0 || len > FIREBASE_PAYLOAD_RESERVE_LIMIT)
+            return;
+
+        // The payload grows as it is read when the heap is not enough for the payload and its copy in result.
+        size_t maxLen = Memory::maxAllocSize();
+        if (maxLen > 0 && len > maxLen / 2)
+            return;
+
+        sData->response.val[res_hndlr_ns::payload].reserve(len);
+    }
+
+    // Read the header line and store the value of header that is used, the header block is not kept.
     void readHeader(async_data_item_t *sData)
     {
-        if (sData->response.flags.header_remaining)
+        if (!sData->response.flags.header_remaining)
+            return;
+
+        String &line = sData->response.val[res_hndlr_ns::header];
+        if (readLine(sData, line) == 0 || line.length() == 0 || line[line.length() - 1] != '\n')
+            return;
+
+        if (line[0] != '\r' && line[0] != '\n')
         {
-            int read = readLine(sData, sData->response.val[res_hndlr_ns::header]);
-            if ((read == 1 && sData->response.val[res_hndlr_ns::header][sData->response.val[res_hndlr_ns::header].length() - 1] == '\r') ||
-                (read == 2 && sData->response.val[res_hndlr_ns::header][sData->response.val[res_hndlr_ns::header].length() - 2] == '\r' && sData->response.val[res_hndlr_ns::header][sData->response.val[res_hndlr_ns::header].length() - 1] == '\n'))
-            {
-                clear(sData->response.val[res_hndlr_ns::etag]);
-                String temp[5];
-#if defined(ENABLE_FS) && defined(ENABLE_CLOUD_STORAGE)
-                if (sData->upload)
-                    parseRespHeader(sData, sData->response.val[res_hndlr_ns::header], sData->request.file_data.resumable.getLocationRef(), "Location");
-#else
-                parseRespHeader(sData, sData->response.val[res_hndlr_ns::header], sData->response.val[res_hndlr_ns::location], "Location");
+            parseRespHeader(sData, line);
+            clear(line);
+            return;
+        }
 
-#endif
-                parseRespHeader(sData, sData->response.val[res_hndlr_ns::header], sData->response.val[res_hndlr_ns::etag], "ETag");
-                resETag = sData->response.val[res_hndlr_ns::etag];
-                sData->aResult.val[ares_ns::res_etag] = sData->response.val[res_hndlr_ns::etag];
-                sData->aResult.val[ares_ns::data_path] = sData->request.val[req_hndlr_ns::path];
+        // The end of header
+        sData->aResult.timing_data.mark(sData->aResult.timing_data.headers_parsed_us);
+        if (sData->response.httpCode == FIREBASE_ERROR_HTTP_CODE_TOO_MANY_REQUESTS || rate_limiter.active())
+            rate_limiter.observe(hostKey(sData), sData->response.httpCode, sData->response.retryAfter);
+        resETag = sData->response.val[res_hndlr_ns::etag];
+        sData->aResult.setETag(sData->response.val[res_hndlr_ns::etag]);
+        sData->aResult.setPath(sData->request.val[req_hndlr_ns::path]);
 #if defined(ENABLE_DATABASE)
-                sData->aResult.rtdbResult.null_etag = sData->response.val[res_hndlr_ns::etag].indexOf("null_etag") > -1;
+        sData->aResult.setNullETag(sData->response.val[res_hndlr_ns::etag].indexOf("null_etag") > -1);
 #endif
+        bool range_bytes = sData->response.flags.range_bytes;
 
-                parseRespHeader(sData, sData->response.val[res_hndlr_ns::header], temp[0], "Content-Length");
+        clear(sData);
 
-                sData->response.payloadLen = atoi(temp[0].c_str());
+#if defined(ENABLE_FS) && defined(ENABLE_CLOUD_STORAGE)
+        int code = sData->response.httpCode;
+        // The 2xx response of the range or query request (not the session initiation that has the session URI) is final.
+        bool completed = sData->upload && (code == FIREBASE_ERROR_HTTP_CODE_OK || code == FIREBASE_ERROR_HTTP_CODE_CREATED) &&
+                         (!sData->request.file_data.resumable.isEnabled() || sData->request.file_data.resumable.isSessionRequest());
 
-                parseRespHeader(sData, sData->response.val[res_hndlr_ns::header], temp[1], "Connection");
-                sData->response.flags.keep_alive = temp[1].length() && temp[1].indexOf("keep-alive") > -1;
+        if (sData->upload && sData->request.file_data.resumable.isEnabled())
+        {
+            sData->request.file_data.resumable.setHeaderState();
+            if (code == FIREBASE_ERROR_HTTP_CODE_PERMANENT_REDIRECT)
+                sData->request.file_data.resumable.commitRange(range_bytes);
+            // The upload was completed, or the upload of queried session was already completed or the session was expired.
+            else if (completed || sData->request.file_data.resumable.isQuery())
+                sData->request.file_data.resumable.clear();
+        }
 
-                parseRespHeader(sData, sData->response.val[res_hndlr_ns::header], temp[2], "Transfer-Encoding");
-                sData->response.flags.chunks = temp[2].length() && temp[2].indexOf("chunked") > -1;
+        // The persisted session is removed when the upload was completed or the session was not found.
+        resumable_session_t *session = sData->upload ? sData->request.file_data.resumable.getSession() : nullptr;
+        if (session && (completed || code == FIREBASE_ERROR_HTTP_CODE_NOT_FOUND || code == FIREBASE_ERROR_HTTP_CODE_GONE))
+            session->remove();
+#else
+        (void)range_bytes;
+#endif
 
-                parseRespHeader(sData, sData->response.val[res_hndlr_ns::header], temp[3], "Content-Type");
-                sData->response.flags.sse = temp[3].length() && temp[3].indexOf("text/event-stream") > -1;
+        if (sData->response.httpCode > 0 && sData->response.httpCode != FIREBASE_ERROR_HTTP_CODE_NO_CONTENT)
+            sData->response.flags.payload_remaining = true;
 
-                if (sData->upload)
-                    parseRespHeader(sData, sData->response.val[res_hndlr_ns::header], temp[4], "Range");
+        if (!sData->sse && (sData->response.httpCode == FIREBASE_ERROR_HTTP_CODE_OK || sData->response.httpCode == FIREBASE_ERROR_HTTP_CODE_PERMANENT_REDIRECT || sData->response.httpCode == FIREBASE_ERROR_HTTP_CODE_NO_CONTENT) && !sData->response.flags.chunks && sData->response.payloadLen == 0)
+            sData->response.flags.payload_remaining = false;
 
-                clear(sData);
+        if (sData->probe)
+            probeResponse(sData);
 
-#if defined(ENABLE_FS) && defined(ENABLE_CLOUD_STORAGE)
-                if (sData->upload && sData->request.file_data.resumable.isEnabled())
-                {
-                    sData->request.file_data.resumable.setHeaderState();
-                    if (sData->response.httpCode == FIREBASE_ERROR_HTTP_CODE_PERMANENT_REDIRECT && temp[4].indexOf("bytes=") > -1)
-                        sData->request.file_data.resumable.updateRange();
-                }
+#if defined(ENABLE_FS)
+        if (sData->response.flags.payload_remaining && !sData->download && !sData->sse && !sData->sink && !sData->probe && !sData->response.flags.chunks)
+            spoolResponse(sData);
 #endif
-                for (size_t i = 0; i < 5; i++)
-                    temp[i].remove(0, temp[i].length());
 
-                if (sData->response.httpCode > 0 && sData->response.httpCode != FIREBASE_ERROR_HTTP_CODE_NO_CONTENT)
-                    sData->response.flags.payload_remaining = true;
+        if (sData->response.flags.payload_remaining && !sData->download && !sData->sse && !sData->sink && !sData->probe && !sData->response.flags.chunks)
+            reservePayload(sData);
 
-                if (!sData->sse && (sData->response.httpCode == FIREBASE_ERROR_HTTP_CODE_OK || sData->response.httpCode == FIREBASE_ERROR_HTTP_CODE_PERMANENT_REDIRECT || sData->response.httpCode == FIREBASE_ERROR_HTTP_CODE_NO_CONTENT) && !sData->response.flags.chunks && sData->response.payloadLen == 0)
-                    sData->response.flags.payload_remaining = false;
-
-                if (sData->request.method == async_request_handler_t::http_delete && sData->response.httpCode == FIREBASE_ERROR_HTTP_CODE_NO_CONTENT)
-                    sData->aResult.setDebug(FPSTR("Delete operation complete"));
-            }
+        // The event buffers are allocated once and reused for all events.
+        if (sData->response.flags.sse)
+        {
+            sData->response.val[res_hndlr_ns::payload].reserve(FIREBASE_SSE_BUFFER_SIZE);
+            sData->aResult.payload_val.reserve(FIREBASE_SSE_BUFFER_SIZE);
         }
-    }
 
-    void parseRespHeader(async_data_item_t *sData, const String &src, String &out, const char *header)
-    {
-        if (sData->response.httpCode > 0)
+        if (sData->request.method == async_request_handler_t::http_delete && sData->response.httpCode == FIREBASE_ERROR_HTTP_CODE_NO_CONTENT)
+            sData->aResult.setDebug(FPSTR("Delete operation complete"));
+
+        if (sData->cache_key && sData->response.httpCode == FIREBASE_ERROR_HTTP_CODE_NOT_MODIFIED)
+            serveCache(sData);
+
+        // The downloaded file was not modified, it is kept as is.
+        if (sData->download && sData->response.httpCode == FIREBASE_ERROR_HTTP_CODE_NOT_MODIFIED)
         {
-            int p1 = -1, p2 = -1, p3 = -1;
-            p1 = src.indexOf(header);
-            if (p1 > -1)
-                p2 = src.indexOf(':', p1);
+            sData->response.flags.payload_remaining = false;
+            sData->aResult.setDebug(FPSTR("The object was not modified, the download was skipped"));
+        }
+    }
+
+    // Keep the status and size of response of the header-only request, the payload of HEAD response is not sent and the
+    // small payload of GET response is discarded as it arrives (readPayload).
+    void probeResponse(async_data_item_t *sData)
+    {
+        AsyncResult::probe_data_t &p = sData->aResult.probe_data;
+        p.code = sData->response.httpCode;
+        p.size = sData->response.flags.chunks ? 0 : sData->response.payloadLen;
+        p.available = true;
+
+        if (!sData->response.flags.payload_remaining)
+            return;
+
+        if (sData->request.method == async_request_handler_t::http_head)
+            sData->response.payloadLen = 0;
+        // The remaining payload is discarded by closing the connection.
+        else if (sData->response.flags.chunks || !sData->response.flags.keep_alive || sData->response.payloadLen > FIREBASE_CANCEL_DRAIN_SIZE)
+            stop(sData);
+        else
+            return;
+        sData->response.flags.payload_remaining = false;
+    }
 
-            if (p2 > -1)
-                p3 = src.indexOf("\r\n", p2);
+    // Serve the cached payload when the server responds that it was not modified.
+    void serveCache(async_data_item_t *sData)
+    {
+        if (!sData->response.flags.chunks && sData->response.payloadLen == 0)
+            sData->response.flags.payload_remaining = false;
 
-            if (p2 > -1 && p3 > -1)
-                out = src.substring(p2 + 1, p3);
+        if (sData->download || sData->response.flags.payload_remaining || !res_cache.get(sData->cache_key, sData->response.val[res_hndlr_ns::payload]))
+            return;
 
-            out.trim();
+        if (sData->response.val[res_hndlr_ns::etag].length() == 0)
+        {
+            resETag = res_cache.etag(sData->cache_key);
+            sData->aResult.setETag(resETag);
         }
+        sData->response.httpCode = FIREBASE_ERROR_HTTP_CODE_OK;
+        sData->aResult.setPayload(sData->response.val[res_hndlr_ns::payload]);
+        sData->aResult.setDebug(FPSTR("Response served from cache"));
     }
 
-    int getChunkSize(async_data_item_t *sData, Client *client)
+    void parseRespHeader(async_data_item_t *sData, const String &line)
     {
-        String line;
-        readLine(sData, line);
-        int p = line.indexOf(";");
-        if (p == -1)
-            p = line.indexOf("\r\n");
-        if (p != -1)
-            sData->response.chunkInfo.chunkSize = hex2int(line.substring(0, p).c_str());
+        int p = 0;
+        res_hndlr_ns::header_name_type type = sData->response.getHeaderName(line, p);
+        if (type == res_hndlr_ns::header_name_max_type)
+            return;
 
-        return sData->response.chunkInfo.chunkSize;
+        String value = line.substring(p);
+        value.trim();
+
+        switch (type)
+        {
+        case res_hndlr_ns::content_length:
+            sData->response.payloadLen = atoi(value.c_str());
+            break;
+        case res_hndlr_ns::connection:
+            // HTTP/1.1 connection is persistent unless the server asks to close it.
+            sData->response.flags.keep_alive = Scan::indexOf(value, "close") == -1;
+            break;
+        case res_hndlr_ns::transfer_encoding:
+            sData->response.flags.chunks = Scan::indexOf(value, "chunked") > -1;
+            break;
+        case res_hndlr_ns::content_type:
+            sData->response.flags.sse = Scan::indexOf(value, "text/event-stream") > -1;
+            break;
+        case res_hndlr_ns::etag_header:
+            sData->response.val[res_hndlr_ns::etag] = value;
+            break;
+        case res_hndlr_ns::location_header:
+#if defined(ENABLE_FS) && defined(ENABLE_CLOUD_STORAGE)
+            if (sData->upload)
+                sData->request.file_data.resumable.setLocation(value);
+#else
+            sData->response.val[res_hndlr_ns::location] = value;
+#endif
+            break;
+        case res_hndlr_ns::range:
+            if (sData->upload)
+            {
+                sData->response.flags.range_bytes = Scan::indexOf(value, "bytes=") > -1;
+#if defined(ENABLE_FS) && defined(ENABLE_CLOUD_STORAGE)
+                sData->request.file_data.resumable.setCommitted(value);
+#endif
+            }
+            break;
+        case res_hndlr_ns::goog_hash_header:
+            // The crc32c and md5 can be sent in separate headers.
+            if (sData->download)
+            {
+                if (sData->response.val[res_hndlr_ns::hash].length())
+                    sData->response.val[res_hndlr_ns::hash] += ',';
+                sData->response.val[res_hndlr_ns::hash] += value;
+            }
+            break;
+        case res_hndlr_ns::content_encoding:
+            sData->response.flags.gzip = Scan::indexOf(value, "gzip") > -1;
+            break;
+        case res_hndlr_ns::retry_after_header:
+            sData->response.retryAfter = atoi(value.c_str());
+            break;
+        default:
+            break;
+        }
     }
 
     // Returns -1 when complete
+    // Read the SSE event line to the event buffer, the line that exceeds the buffer is discarded when FIREBASE_SSE_DROP_OVERFLOW is defined.
+    void readEventLine(async_data_item_t *sData)
+    {
+        String &payload = sData->response.val[res_hndlr_ns::payload];
+
+#if defined(FIREBASE_SSE_DROP_OVERFLOW)
+        if (sData->response.flags.sse_overflow)
+        {
+            // Discard the remaining data of the line, the event buffer is already cleared.
+            String &line = sData->response.val[res_hndlr_ns::header];
+            sData->response.payloadRead += readLine(sData, line);
+            if (line.length() && line[line.length() - 1] == '\n')
+                sData->response.flags.sse_overflow = false;
+            clear(line);
+            return;
+        }
+#endif
+
+        if (sData->response.flags.sse_skip)
+        {
+            bool eol = false;
+            sData->response.payloadRead += sData->response.skipLine(client_type, client, async_tcp_config, eol);
+            if (eol)
+                sData->response.flags.sse_skip = false;
+            return;
+        }
+
+        // The filtered line is read in small parts until its data path was known.
+        bool filtered = sData->sse_filter.length() && !sData->response.flags.sse_pass;
+        sData->response.payloadRead += readLine(sData, payload, filtered ? FIREBASE_SSE_FILTER_READ_SIZE : 0);
+        if (filtered)
+            filterEvent(sData, payload);
+        if (payload.length() && payload[payload.length() - 1] == '\n')
+            sData->response.flags.sse_pass = false;
+
+#if defined(FIREBASE_SSE_DROP_OVERFLOW)
+        if (payload.length() > FIREBASE_SSE_BUFFER_SIZE)
+        {
+            sData->response.flags.sse_overflow = payload[payload.length() - 1] != '\n';
+            clear(payload);
+            sData->response.sse_parser.reset();
+            sData->aResult.setDebug(FPSTR("The SSE event was discarded (buffer overflow)"));
+        }
+#endif
+    }
+
+    // Discard the event in the event buffer when the data path of its data line does not match the stream filter.
+    void filterEvent(async_data_item_t *sData, String &payload)
+    {
+        size_t len = payload.length(), start = len > 0 ? len - 1 : 0;
+        while (start > 0 && payload[start - 1] != '\n')
+            start--;
+
+        bool eol = len > 0 && payload[len - 1] == '\n';
+        int8_t ret = matchEventLine(sData->sse_filter, payload.c_str() + start, len - start, eol);
+        if (ret < 0)
+            return;
+
+        if (ret > 0)
+        {
+            sData->response.flags.sse_pass = !eol;
+            return;
+        }
+
+        // The event starts after the last blank line, the lines of the event before this line are also removed.
+        size_t ev = start;
+        while (ev > 0)
+        {
+            size_t s = ev - 1;
+            while (s > 0 && payload[s - 1] != '\n')
+                s--;
+            if (ev - 1 - s == 0 || (ev - 1 - s == 1 && payload[s] == '\r'))
+                break;
+            ev = s;
+        }
+        payload.remove(ev);
+        sData->response.sse_parser.reset();
+        sData->response.flags.sse_skip = !eol;
+    }
+
+    // Returns 1 when the event line should be kept, 0 when its data path does not match the filters or -1 when more data are required.
+    int8_t matchEventLine(const String &filter, const char *line, size_t n, bool eol)
+    {
+        static const char *prefix = "data:";
+        for (size_t i = 0; i < 5; i++)
+        {
+            if (i >= n)
+                return eol ? 1 : -1;
+            if (line[i] != prefix[i])
+                return 1;
+        }
+
+        size_t p = 5;
+        if (p < n && line[p] == ' ')
+            p++;
+
+        // The event data without path e.g. keep-alive and cancel events are kept.
+        static const char *key = "{\"path\":\"";
+        for (size_t i = 0; i < 9; i++, p++)
+        {
+            if (p >= n)
+                return eol ? 1 : -1;
+            if (line[p] != key[i])
+                return 1;
+        }
+
+        size_t q = p;
+        while (q < n && line[q] != '"' && line[q] != '\\')
+            q++;
+        if (q >= n)
+            return eol ? 1 : -1;
+        // The escaped path is not compared.
+        if (line[q] == '\\')
+            return 1;
+
+        const char *f = filter.c_str();
+        while (*f)
+        {
+            const char *e = strchr(f, ',');
+            size_t flen = e ? (size_t)(e - f) : strlen(f), next = e ? flen + 1 : flen;
+            while (flen > 0 && f[flen - 1] == ' ')
+                flen--;
+            if (pathMatched(f, flen, line + p, q - p))
+                return 1;
+            f += next;
+        }
+        return 0;
+    }
+
+    // The path is matched when it is the parent or child of the filter path or the same path, the * matches any key.
+    bool pathMatched(const char *f, size_t flen, const char *p, size_t plen)
+    {
+        size_t i = 0, j = 0;
+        while (true)
+        {
+            while (i < flen && (f[i] == '/' || f[i] == ' '))
+                i++;
+            while (j < plen && p[j] == '/')
+                j++;
+            if (i >= flen || j >= plen)
+                return true;
+
+            size_t fs = i, ps = j;
+            while (i < flen && f[i] != '/')
+                i++;
+            while (j < plen && p[j] != '/')
+                j++;
+            bool any = i - fs == 1 && f[fs] == '*';
+            if (!any && (i - fs != j - ps || strncmp(f + fs, p + ps, i - fs) != 0))
+                return false;
+        }
+    }
+
+    // The response payload is written to the spool file.
+    bool spooled(async_data_item_t *sData)
+    {
+#if defined(ENABLE_FS)
+        return sData->spool_res;
+#else
+        (void)sData;
+        return false;
+#endif
+    }
+
+    // The announced (Content-Length or chunk sizes) or read payload exceeds the response limit.
+    bool exceedsLimit(async_data_item_t *sData) { return sData->resp_limit && !sData->download && !spooled(sData) && (sData->response.payloadLen > sData->resp_limit || sData->response.payloadRead > sData->resp_limit); }
+
+    bool abortOversize(async_data_item_t *sData)
+    {
+        if (!exceedsLimit(sData) || sData->error.code != 0)
+            return false;
+        stop(sData);
+        clear(sData->response.val[res_hndlr_ns::payload]);
+        sData->response.flags.payload_remaining = false;
+        setAsyncError(sData, async_state_read_response, FIREBASE_ERROR_RESPONSE_TOO_LARGE, !sData->sse, true);
+        return true;
+    }
+
+    // The full object (200) response of range request is not written to the sink of its range.
+    bool rejectRange(async_data_item_t *sData)
+    {
+        if (!sData->range_part || sData->error.code != 0 || sData->response.httpCode < FIREBASE_ERROR_HTTP_CODE_OK || sData->response.httpCode >= 300 || sData->response.httpCode == FIREBASE_ERROR_HTTP_CODE_PARTIAL_CONTENT)
+            return false;
+        stop(sData);
+        sData->response.flags.payload_remaining = false;
+        setAsyncError(sData, async_state_read_response, FIREBASE_ERROR_RANGE_NOT_SUPPORTED, !sData->sse, true);
+        return true;
+    }
+
+    // The payload sink is used for the successful response only, the error response is kept in result.
+    bool sinkEnabled(async_data_item_t *sData) { return sData->sink && !sData->download && sData->response.httpCode >= FIREBASE_ERROR_HTTP_CODE_OK && sData->response.httpCode < 300; }
+
+    void flushSink(async_data_item_t *sData, String &data)
+    {
+        if (!sinkEnabled(sData) || data.length() == 0)
+            return;
+        if (!sData->sink_stopped && sData->sink->write(reinterpret_cast<const uint8_t *>(data.c_str()), data.length()) < data.length())
+        {
+            // The remaining payload is discarded by closing the connection.
+            sData->sink_stopped = true;
+            stop(sData);
+            sData->response.payloadLen = sData->response.payloadRead;
+        }
+        clear(data);
+    }
+
     int decodeChunks(async_data_item_t *sData, Client *client, String *out)
     {
-        if (!client || !sData || !out)
+        if (!sData || !out || (client_type == async_request_handler_t::tcp_client_type_sync && !client))
             return 0;
-        int res = 0;
 
-        // read chunk-size, chunk-extension (if any) and CRLF
-        if (sData->response.chunkInfo.phase == async_response_handler_t::READ_CHUNK_SIZE)
+        async_response_handler_t::chunk_info_t &info = sData->response.chunkInfo;
+        int steps = 0;
+
+        while (sData->response.available(client_type, client, async_tcp_config) > 0)
+        {
+            // The remaining chunks are decoded in the next process call.
+            if (steps++ > 0 && budgetSpent(sData))
+                break;
+
+            // read chunk-data in blocks and append to entity-body
+            if (info.phase == async_response_handler_t::READ_CHUNK_DATA)
+            {
+#if defined(ENABLE_GZIP)
+                int read = inflateEnabled(sData) ? readInflate(sData, *out, info.chunkSize - info.dataLen) : sData->response.readString(client_type, client, async_tcp_config, *out, info.chunkSize - info.dataLen);
+                if (sData->error.code != 0)
+                    return -1;
+#else
+                int read = sData->response.readString(client_type, client, async_tcp_config, *out, info.chunkSize - info.dataLen);
+#endif
+                if (read <= 0)
+                    break;
+
+                info.dataLen += read;
+                sData->response.payloadRead += read;
+                flushSink(sData, *out);
+                if (sData->sink_stopped)
+                    return -1;
+                if (info.dataLen == info.chunkSize)
+                    info.phase = async_response_handler_t::READ_CHUNK_DATA_END;
+                continue;
+            }
+
+            // read chunk-size and chunk-extension (if any), the CRLF after chunk-data or trailer, line by line
+            if (readLine(sData, info.line) == 0 || info.line[info.line.length() - 1] != '\n')
+                break;
+
+            if (info.phase == async_response_handler_t::READ_CHUNK_SIZE)
+            {
+                int p = info.line.indexOf(";");
+                if (p == -1)
+                    p = info.line.indexOf("\r");
+                if (p == -1)
+                    p = info.line.length() - 1;
+
+                info.chunkSize = hex2int(info.line.substring(0, p).c_str());
+                info.dataLen = 0;
+                sData->response.payloadLen += info.chunkSize;
+                // The chunk is not read when the payload will exceed the limit.
+                if (exceedsLimit(sData))
+                    return -1;
+                // the last chunk is followed by trailer
+                info.phase = info.chunkSize > 0 ? async_response_handler_t::READ_CHUNK_DATA : async_response_handler_t::READ_CHUNK_TRAILER;
+            }
+            else if (info.phase == async_response_handler_t::READ_CHUNK_DATA_END)
+                info.phase = async_response_handler_t::READ_CHUNK_SIZE;
+            else if (info.line[0] == '\r' || info.line[0] == '\n')
+            {
+                clear(info.line);
+                return -1;
+            }
+
+            clear(info.line);
+        }
+
+        return 0;
+    }
+
+    // Write the remaining firmware blocks before the update is finished.
+    void flushOTA(async_data_item_t *sData)
+    {
+#if defined(ENABLE_DELTA_OTA)
+        if (sData->ota_delta)
+        {
+            if (!sData->ota_delta->done() && sData->request.ota_error == 0)
+                sData->request.ota_error = otaError(sData);
+            // The size of new firmware is exact, the base64 pad is not written.
+            if (!sData->ota_delta->passthrough())
+                sData->request.b64Pad = 0;
+        }
+#endif
+        if (sData->ota_writer && !sData->ota_writer->finish() && sData->request.ota_error == 0)
+            sData->request.ota_error = FIREBASE_ERROR_FW_UPDATE_WRITE_FAILED;
+        if (sData->ota_writer)
+            sData->aResult.download_data.write_us += sData->ota_writer->takeWriteTime();
+        sData->freeOTAWriter();
+    }
+
+    void pollOTA(async_data_item_t *sData)
+    {
+        uint32_t us = micros();
+        sData->ota_writer->poll();
+        addDownloadTime(sData, micros() - us, true);
+    }
+
+    // The time (µs) of processing the download data, the write time of OTA firmware is measured by its writer,
+    // the write time of other data that are not decoded is the process time.
+    void addDownloadTime(async_data_item_t *sData, uint32_t us, bool writer)
+    {
+        sData->aResult.download_data.process_us += us;
+        if (writer)
+        {
+            if (sData->ota_writer)
+                sData->aResult.download_data.write_us += sData->ota_writer->takeWriteTime();
+        }
+        else if (!sData->request.base64 && !otaDecoded(sData))
+            sData->aResult.download_data.write_us += us;
+    }
+
+    // The writer of OTA firmware, it is null when the firmware is written to Update directly.
+    Print *otaSink(async_data_item_t *sData)
+    {
+#if defined(ENABLE_DELTA_OTA)
+        if (sData->ota_delta)
+            return sData->ota_delta;
+#endif
+        return sData->ota_writer;
+    }
+
+    int16_t otaError(async_data_item_t *sData)
+    {
+#if defined(ENABLE_DELTA_OTA)
+        if (sData->ota_delta && sData->ota_delta->error() != 0)
+            return sData->ota_delta->error();
+        if (sData->ota_delta && !sData->ota_delta->done() && (!sData->ota_writer || !sData->ota_writer->failed()))
+            return FIREBASE_ERROR_FW_DELTA_PATCH;
+#else
+        (void)sData;
+#endif
+        return FIREBASE_ERROR_FW_UPDATE_WRITE_FAILED;
+    }
+
+    // The firmware is decoded from the delta patch or compressed image.
+    bool otaDecoded(async_data_item_t *sData)
+    {
+#if defined(ENABLE_DELTA_OTA)
+        return sData->ota_delta && !sData->ota_delta->passthrough();
+#else
+        (void)sData;
+#endif
+        return false;
+    }
+
+    // The compressed firmware was written without its size.
+    bool otaSizeUnknown(async_data_item_t *sData)
+    {
+#if defined(ENABLE_DELTA_OTA)
+        return sData->ota_delta && sData->ota_delta->sizeUnknown();
+#else
+        (void)sData;
+#endif
+        return false;
+    }
+
+#if defined(ENABLE_GZIP)
+    // Compress the request payload while it is sent when the compressed size is smaller, the Content-Length header is
+    // set to the compressed size that is computed before the header is sent. The compression is restarted when
+    // the request is sent again.
+    void beginDeflate(async_data_item_t *sData)
+    {
+        String &payload = sData->request.val[req_hndlr_ns::payload];
+        if (sData->deflate)
+        {
+            // The header of the compressed payload is restored when the compression could not be restarted.
+            if (!sData->deflate->begin(reinterpret_cast<const uint8_t *>(payload.c_str()), payload.length()))
+            {
+                sData->freeDeflate();
+                sData->gzip_req = false;
+                setDeflateHeader(sData, false);
+            }
+            return;
+        }
+
+        String &header = sData->request.val[req_hndlr_ns::header];
+        if (payload.length() < gzip_req_min || header.lastIndexOf(FPSTR("Content-Length: ")) < 0)
+            return;
+
+        sData->deflate = new GzipDeflate();
+        sData->deflate_len = sData->deflate->begin(reinterpret_cast<const uint8_t *>(payload.c_str()), payload.length()) ? sData->deflate->length() : 0;
+        if (sData->deflate_len == 0 || sData->deflate_len >= payload.length())
         {
-            sData->response.chunkInfo.phase = async_response_handler_t::READ_CHUNK_DATA;
-            sData->response.chunkInfo.chunkSize = -1;
-            sData->response.chunkInfo.dataLen = 0;
-            res = getChunkSize(sData, client);
-            sData->response.payloadLen += res > -1 ? res : 0;
+            sData->freeDeflate();
+            sData->gzip_req = false;
+            return;
         }
-        // read chunk-data and CRLF
-        // append chunk-data to entity-body
+
+        setDeflateHeader(sData, true);
+    }
+
+    // Set the Content-Encoding and Content-Length headers of the compressed (gzip is true) or plain payload.
+    void setDeflateHeader(async_data_item_t *sData, bool gzip)
+    {
+        String &header = sData->request.val[req_hndlr_ns::header];
+        if (!gzip)
+            header.replace(FPSTR("Content-Encoding: gzip\r\n"), "");
+
+        int p = header.lastIndexOf(FPSTR("Content-Length: "));
+        int e = p > -1 ? header.indexOf("\r\n", p) : -1;
+        if (e < 0)
+            return;
+
+        String len = gzip ? FPSTR("Content-Encoding: gzip\r\nContent-Length: ") : FPSTR("Content-Length: ");
+        if (gzip)
+            len += sData->deflate_len;
         else
+            len += sData->request.val[req_hndlr_ns::payload].length();
+        header.remove(p, e - p);
+        header = header.substring(0, p) + len + header.substring(p);
+    }
+
+    // Send the next chunk of compressed payload, the hash table of encoder is released when the payload was sent.
+    function_return_type sendDeflate(async_data_item_t *sData)
+    {
+        Memory mem(&sData->arena, &sData->mem_stats);
+        uint8_t *buf = reinterpret_cast<uint8_t *>(mem.alloc(sData->chunk_size, false, mem_class_chunk));
+        size_t len = buf ? sData->deflate->read(buf, sData->chunk_size) : 0;
+        function_return_type ret = send(sData, buf, len, sData->deflate_len);
+        mem.release(&buf);
+        sData->arena.reset();
+        if (ret != function_return_type_continue)
+            sData->deflate->end();
+        return ret;
+    }
+
+    // The compressed payload of download is not inflated.
+    bool inflateEnabled(async_data_item_t *sData) { return sData->response.flags.gzip && !sData->download && !sData->sse; }
+
+    // Read up to size bytes of compressed payload and append the inflated data to out, returns the numbers of bytes read.
+    int readInflate(async_data_item_t *sData, String &out, size_t size)
+    {
+        if (!sData->inflate)
         {
-            if (sData->response.chunkInfo.chunkSize > -1)
+            sData->inflate = new GzipInflate();
+            if (!sData->inflate->begin())
             {
-                String chunk;
-                int read = readLine(sData, chunk);
-                if (read && chunk[0] != '\r')
-                    *out += chunk;
-                if (read)
-                {
-                    sData->response.chunkInfo.dataLen += read;
-                    sData->response.payloadRead += read;
-                    // chunk may contain trailing
-                    if (sData->response.chunkInfo.dataLen - 2 >= sData->response.chunkInfo.chunkSize)
-                    {
-                        sData->response.chunkInfo.dataLen = sData->response.chunkInfo.chunkSize;
-                        sData->response.chunkInfo.phase = async_response_handler_t::READ_CHUNK_SIZE;
-                    }
-                }
-                // if all chunks read, returns -1
-                else if (sData->response.chunkInfo.dataLen == sData->response.chunkInfo.chunkSize)
-                    res = -1;
+                setAsyncError(sData, async_state_read_response, FIREBASE_ERROR_INFLATE, !sData->sse, true);
+                return 0;
             }
         }
 
-        return res;
+        Memory mem(&sData->arena, &sData->mem_stats);
+        size_t toRead = size > sData->chunk_size ? sData->chunk_size : size;
+        uint8_t *buf = reinterpret_cast<uint8_t *>(mem.alloc(toRead, false, mem_class_chunk));
+        int read = buf ? sData->response.read(client_type, client, async_tcp_config, buf, toRead) : 0;
+        if (read > 0 && !sData->inflate->write(buf, read, out))
+            setAsyncError(sData, async_state_read_response, FIREBASE_ERROR_INFLATE, !sData->sse, true);
+        mem.release(&buf);
+        return read > 0 ? read : 0;
     }
+#endif
 
     bool readPayload(async_data_item_t *sData)
     {
         uint8_t *buf = nullptr;
         OTAUtil otaut;
-        Memory mem;
+        Memory mem(&sData->arena, &sData->mem_stats), heap(nullptr, &sData->mem_stats);
         Base64Util but;
 
         if (sData->response.flags.payload_remaining)
         {
-            sData->response.feedTimer(!sData->async && sync_read_timeout_sec > 0 ? sync_read_timeout_sec : -1);
+            // The payload is read in the next process call.
+            if (budgetSpent(sData))
+                return true;
+
+            // The payload that exceeds the limit from Content-Length or the full object of range request is not read.
+            if (abortOversize(sData) || rejectRange(sData))
+                return false;
+
+            sData->response.feedTimer(readTimeout(sData));
+
+            // The payload of header-only request is read and discarded.
+            if (sData->probe)
+            {
+                drainPayload(sData);
+                goto exit;
+            }
 
             // the next chunk data is the payload
             if (sData->response.httpCode != FIREBASE_ERROR_HTTP_CODE_NO_CONTENT)
@@ -1030,78 +2829,112 @@ private:
                 {
                     if (sData->download)
                     {
+                        // The socket is not read until the sink has accepted the data that were kept, the server is throttled by TCP flow control.
+                        if (sinkPending(sData))
+                        {
+                            int ret = drainSink(sData);
+                            if (ret < 0)
+                            {
+                                setAsyncError(sData, async_state_read_response, FIREBASE_ERROR_FILE_WRITE, !sData->sse, true);
+                                return false;
+                            }
+
+                            if (ret == 0)
+                                return true;
+
+                            if (sData->response.payloadRead >= sData->response.payloadLen)
+                                goto exit;
+                        }
+
                         if (sData->response.payloadLen)
                         {
                             if (sData->response.payloadRead == 0)
                             {
+                                beginDownloadResume(sData);
+                                sData->aResult.beginDownloadRate(sData->request.resume ? sData->request.resume->start : 0);
+
+                                // The base64 OTA and resumed downloads are not hashed, the other base64 downloads are hashed after decoding.
+                                if (!(sData->request.base64 && sData->request.ota) && (!sData->request.resume || sData->request.resume->start == 0))
+                                    sData->hash.begin();
+
                                 if (sData->request.ota)
                                 {
-                                    otaut.prepareDownloadOTA(sData->response.payloadLen, sData->request.base64, sData->request.ota_error);
+                                    // The update is continued when the remaining bytes of interrupted download were responded.
+                                    bool resumed = sData->request.resume && sData->request.resume->start > 0;
+                                    sData->request.ota_error = 0;
+                                    if (!resumed)
+                                    {
+                                        otaut.abortUpdate();
+#if !defined(OTA_UPDATE_ENABLED) || !defined(ENABLE_DELTA_OTA)
+                                        otaut.prepareDownloadOTA(sData->response.payloadLen, sData->request.base64, sData->request.ota_error);
+#endif
+                                    }
                                     if (sData->request.ota_error != 0)
                                     {
                                         setAsyncError(sData, async_state_read_response, sData->request.ota_error, !sData->sse, false);
                                         return false;
                                     }
+#if defined(OTA_UPDATE_ENABLED)
+                                    // The firmware is written directly when the block buffers could not be allocated.
+                                    sData->freeOTAWriter();
+                                    sData->ota_writer = new OTAWriter();
+                                    if (!sData->ota_writer->begin())
+                                        sData->freeOTAWriter();
+#if defined(ENABLE_DELTA_OTA)
+                                    // The update is started by the decoder when the size of new firmware is known.
+                                    if (!resumed)
+                                        sData->ota_delta = new DeltaOTA(otaut.firmwareSize(sData->response.payloadLen, sData->request.base64), sData->ota_writer);
+#endif
+#endif
                                 }
 #if defined(ENABLE_FS)
                                 else if (sData->request.file_data.filename.length() && sData->request.file_data.cb)
                                 {
                                     closeFile(sData);
 
-                                    if (!openFile(sData, file_mode_open_write))
+                                    if (!openFile(sData, sData->request.resume && sData->request.resume->start > 0 ? file_mode_open_append : file_mode_open_write))
                                     {
                                         setAsyncError(sData, async_state_read_response, FIREBASE_ERROR_OPEN_FILE, !sData->sse, true);
                                         return false;
                                     }
                                 }
 #endif
-                                else
-                                    sData->request.file_data.outB.init(sData->request.file_data.data, sData->request.file_data.data_size);
+                                else if (!sData->request.file_data.sink)
+                                    sData->request.file_data.outB.init(sData->request.file_data.data, sData->request.file_data.data_size, sData->request.resume ? sData->request.resume->start : 0);
                             }
 
-                            int toRead = 0, read = 0;
-                            uint8_t ofs = 0;
-
-                            buf = asyncBase64Buffer(sData, mem, read, toRead);
-
-                            if (sData->response.toFillLen)
-                                return true;
-
-                            if (!buf)
-                            {
-                                ofs = sData->request.base64 && sData->response.payloadRead == 0 ? 1 : 0;
-                                toRead = (int)(sData->response.payloadLen - sData->response.payloadRead) > FIREBASE_CHUNK_SIZE + ofs ? FIREBASE_CHUNK_SIZE + ofs : sData->response.payloadLen - sData->response.payloadRead;
-                                buf = reinterpret_cast<uint8_t *>(mem.alloc(toRead));
-                                read = sData->response.tcpRead(client_type, client, async_tcp_config, buf, toRead);
-                            }
+                            int toRead = (int)(sData->response.payloadLen - sData->response.payloadRead) > sData->chunk_size ? sData->chunk_size : sData->response.payloadLen - sData->response.payloadRead;
+                            buf = reinterpret_cast<uint8_t *>(mem.alloc(toRead, true, mem_class_chunk));
+                            int read = sData->response.read(client_type, client, async_tcp_config, buf, toRead);
 
                             if (read > 0)
                             {
-                                if (sData->request.base64 && read < toRead)
-                                {
-                                    sData->response.toFillIndex += read;
-                                    sData->response.toFillLen = toRead - read;
-                                    sData->response.toFill = reinterpret_cast<uint8_t *>(mem.alloc(toRead));
-                                    memcpy(sData->response.toFill, buf, read);
-                                    goto exit;
-                                }
-
+                                uint32_t us = micros();
+                                bool writer = sData->ota_writer != nullptr;
                                 sData->response.payloadRead += read;
                                 if (sData->request.base64)
                                 {
-                                    otaut.getPad(buf + ofs, read, sData->request.b64Pad);
+                                    // The base64 data are decoded as they are read, the quotes of JSON string are skipped.
+                                    if (sData->response.payloadRead == (size_t)read)
+                                        sData->b64.begin();
+                                    bool last = sData->response.payloadRead >= sData->response.payloadLen;
+
                                     if (sData->request.ota)
                                     {
-                                        otaut.decodeBase64OTA(mem, &but, (const char *)buf, read - ofs, sData->request.ota_error);
+                                        otaut.decodeBase64OTA(mem, sData->b64, buf, read, otaSink(sData), sData->ota_writer, sData->request.ota_error);
+                                        if (sData->request.ota_error != 0)
+                                            sData->request.ota_error = otaError(sData);
                                         if (sData->request.ota_error != 0)
                                         {
                                             setAsyncError(sData, async_state_read_response, sData->request.ota_error, !sData->sse, false);
                                             goto exit;
                                         }
 
-                                        if (sData->request.b64Pad > -1)
+                                        if (last)
                                         {
-                                            otaut.endDownloadOTA(sData->request.b64Pad, sData->request.ota_error);
+                                            sData->request.b64Pad = sData->b64.pad();
+                                            flushOTA(sData);
+                                            otaut.endDownloadOTA(sData->request.b64Pad, sData->request.ota_error, otaSizeUnknown(sData));
                                             if (sData->request.ota_error != 0)
                                             {
                                                 setAsyncError(sData, async_state_read_response, sData->request.ota_error, !sData->sse, false);
@@ -1113,56 +2946,88 @@ private:
                                     else if (sData->request.file_data.filename.length() && sData->request.file_data.cb)
                                     {
 
-                                        if (!but.decodeToFile(mem, sData->request.file_data.file, (const char *)buf + ofs))
+                                        if (!writeBlock(sData, buf, read))
                                         {
                                             setAsyncError(sData, async_state_read_response, FIREBASE_ERROR_FILE_WRITE, !sData->sse, true);
                                             goto exit;
                                         }
                                     }
 #endif
-                                    else
-                                        but.decodeToBlob(mem, &sData->request.file_data.outB, (const char *)buf + ofs);
+                                    else if (!writeDownload(sData, buf, read))
+                                    {
+                                        setAsyncError(sData, async_state_read_response, FIREBASE_ERROR_FILE_WRITE, !sData->sse, true);
+                                        goto exit;
+                                    }
                                 }
                                 else
                                 {
                                     if (sData->request.ota)
                                     {
-                                        but.updateWrite(buf, read);
+                                        if (otaSink(sData))
+                                        {
+                                            if (otaSink(sData)->write(buf, read) < (size_t)read)
+                                            {
+                                                setAsyncError(sData, async_state_read_response, otaError(sData), !sData->sse, false);
+                                                goto exit;
+                                            }
+                                        }
+                                        else
+                                            but.updateWrite(buf, read);
+#if defined(ENABLE_DELTA_OTA)
+                                        // The decoded firmware is not resumed.
+                                        if (sData->request.resume && sData->ota_delta && !sData->ota_delta->passthrough())
+                                            sData->request.resume->clear();
+#endif
 
                                         if (sData->response.payloadRead == sData->response.payloadLen)
                                         {
-                                            otaut.endDownloadOTA(0, sData->request.ota_error);
+                                            flushOTA(sData);
+                                            otaut.endDownloadOTA(0, sData->request.ota_error, otaSizeUnknown(sData));
                                             if (sData->request.ota_error != 0)
                                             {
                                                 setAsyncError(sData, async_state_read_response, sData->request.ota_error, !sData->sse, false);
                                                 goto exit;
                                             }
                                         }
+                                        sData->hash.update(buf, read);
                                     }
-#if defined(ENABLE_FS)
-                                    else if (sData->request.file_data.filename.length() && sData->request.file_data.cb)
+                                    else if (!writeDownload(sData, buf, read))
                                     {
-                                        int write = sData->request.file_data.file.write(buf, read);
-                                        if (write < read)
-                                        {
-                                            setAsyncError(sData, async_state_read_response, FIREBASE_ERROR_FILE_WRITE, !sData->sse, true);
-                                            goto exit;
-                                        }
+                                        setAsyncError(sData, async_state_read_response, FIREBASE_ERROR_FILE_WRITE, !sData->sse, true);
+                                        goto exit;
                                     }
-#endif
-                                    else
-                                        sData->request.file_data.outB.write(buf, read);
+
+                                    if (sData->request.resume)
+                                        sData->request.resume->offset += read;
                                 }
+                                addDownloadTime(sData, micros() - us, writer);
                             }
                         }
 
-                        if (sData->response.httpCode == FIREBASE_ERROR_HTTP_CODE_OK)
+                        if (downloadOK(sData))
                         {
-                            sData->aResult.download_data.total = sData->response.payloadLen;
-                            sData->aResult.download_data.downloaded = sData->response.payloadRead;
+                            setDownloadProgress(sData);
                             returnResult(sData, false);
                         }
                     }
+#if defined(ENABLE_GZIP)
+                    else if (inflateEnabled(sData))
+                    {
+                        String &payload = sData->response.val[res_hndlr_ns::payload];
+                        sData->response.payloadRead += readInflate(sData, payload, sData->response.payloadLen - sData->response.payloadRead);
+                        flushSink(sData, payload);
+                        if (sData->error.code != 0)
+                            sData->response.flags.payload_remaining = false;
+                    }
+#endif
+                    else if (sinkEnabled(sData))
+                    {
+                        String &payload = sData->response.val[res_hndlr_ns::payload];
+                        sData->response.payloadRead += sData->response.readString(client_type, client, async_tcp_config, payload, sData->response.payloadLen - sData->response.payloadRead);
+                        flushSink(sData, payload);
+                    }
+                    else if (sData->response.flags.sse)
+                        readEventLine(sData);
                     else
                         sData->response.payloadRead += readLine(sData, sData->response.val[res_hndlr_ns::payload]);
                 }
@@ -1172,8 +3037,12 @@ private:
 
         if (buf)
             mem.release(&buf);
+        sData->arena.reset();
 
-        if (sData->response.payloadLen > 0 && sData->response.payloadRead >= sData->response.payloadLen && sData->response.tcpAvailable(client_type, client, async_tcp_config) == 0)
+        if (abortOversize(sData))
+            return false;
+
+        if (sData->response.payloadLen > 0 && sData->response.payloadRead >= sData->response.payloadLen && sData->response.available(client_type, client, async_tcp_config) == 0 && !sinkPending(sData))
         {
             // Async payload and header data collision workaround from session reusage.
             if (!sData->response.flags.chunks && sData->response.payloadRead > sData->response.payloadLen)
@@ -1191,20 +3060,41 @@ private:
                 uut.updateDownloadURL(sData->aResult.upload_data.downloadUrl, sData->response.val[res_hndlr_ns::payload]);
             }
 
-            if (sData->response.flags.chunks && sData->auth_used)
-                stop(sData);
+#if defined(ENABLE_GZIP)
+            // The gzip trailer (CRC-32 and size) was not received or verified.
+            if (sData->inflate)
+            {
+                if (!sData->inflate->done() && sData->error.code == 0)
+                    setAsyncError(sData, sData->state, FIREBASE_ERROR_INFLATE, !sData->sse, true);
+                sData->freeInflate();
+            }
+#endif
+
+            if ((sData->upload || sData->download) && sData->response.httpCode < FIREBASE_ERROR_HTTP_CODE_BAD_REQUEST && !verifyHash(sData))
+                setAsyncError(sData, sData->state, FIREBASE_ERROR_HASH_MISMATCH, !sData->sse, true);
+
+            if (sData->response.flags.chunks && sData->auth_used)
+                stop(sData);
 
             if (sData->response.httpCode >= FIREBASE_ERROR_HTTP_CODE_BAD_REQUEST)
             {
+                // The object was changed, the next download starts from the first byte.
+                if (sData->request.resume && (sData->response.httpCode == FIREBASE_ERROR_HTTP_CODE_PRECONDITION_FAILED || sData->response.httpCode == FIREBASE_ERROR_HTTP_CODE_RANGE_NOT_SATISFIABLE))
+                    sData->request.resume->clear();
+
                 setAsyncError(sData, sData->state, sData->response.httpCode, !sData->sse, true);
                 sData->return_type = function_return_type_failure;
-                returnResult(sData, false);
+                // The error is not returned when the request will be retried.
+                if (!canRetry(sData))
+                    returnResult(sData, false);
             }
 
-            if (sData->response.httpCode == FIREBASE_ERROR_HTTP_CODE_OK && sData->download)
+            if (downloadOK(sData) && sData->download)
             {
-                sData->aResult.download_data.total = sData->response.payloadLen;
-                sData->aResult.download_data.downloaded = sData->response.payloadRead;
+                setDownloadProgress(sData);
+                // The download is complete, nothing to resume.
+                if (sData->request.resume && sData->error.code == 0)
+                    sData->request.resume->complete();
                 returnResult(sData, false);
             }
 
@@ -1218,35 +3108,72 @@ private:
         return sData->error.code == 0;
     }
 
-    // non-block memory buffer for collecting the multiple of 4 data prepared for base64 decoding
-    uint8_t *asyncBase64Buffer(async_data_item_t *sData, Memory &mem, int &toRead, int &read)
+    // Get the value of hash e.g. "crc32c" from "crc32c=n03x6A==,md5=..." of x-goog-hash header.
+    String hashValue(const String &header, const char *name)
     {
-        uint8_t *buf = nullptr;
+        String key = name;
+        key += '=';
+        int p = Scan::indexOf(header, key.c_str());
+        if (p == -1)
+            return String();
+        p += key.length();
+        int e = Scan::indexOf(header, ',', p);
+        return header.substring(p, e == -1 ? header.length() : e);
+    }
 
-        if (sData->request.base64)
+    // Compare the hashes of transferred data with the hashes of object metadata in upload response
+    // or the x-goog-hash header of download response, returns false when they are mismatched.
+    bool verifyHash(async_data_item_t *sData)
+    {
+        hash_data_t &h = sData->aResult.hash_data;
+        sData->hash.end(h);
+        if (!hash_verify || !h.available)
+            return true;
+
+        String crc, md5;
+        if (sData->upload)
         {
-            if (sData->response.toFill && sData->response.toFillLen)
-            {
-                int currentRead = sData->response.tcpRead(client_type, client, async_tcp_config, sData->response.toFill + sData->response.toFillIndex, sData->response.toFillLen);
-                if (currentRead == sData->response.toFillLen)
-                {
-                    buf = reinterpret_cast<uint8_t *>(mem.alloc(sData->response.toFillIndex + sData->response.toFillLen));
-                    memcpy(buf, sData->response.toFill, sData->response.toFillIndex + sData->response.toFillLen);
-                    mem.release(&sData->response.toFill);
-                    read = sData->response.toFillLen + sData->response.toFillIndex;
-                    toRead = read;
-                    sData->response.toFillIndex = 0;
-                    sData->response.toFillLen = 0;
-                }
-                else
-                {
-                    sData->response.toFillIndex += currentRead;
-                    sData->response.toFillLen -= currentRead;
-                }
-            }
+            JsonPullParser::get(sData->response.val[res_hndlr_ns::payload], "crc32c", crc);
+            JsonPullParser::get(sData->response.val[res_hndlr_ns::payload], "md5Hash", md5);
+        }
+        else
+        {
+            crc = hashValue(sData->response.val[res_hndlr_ns::hash], "crc32c");
+            md5 = hashValue(sData->response.val[res_hndlr_ns::hash], "md5");
         }
 
-        return buf;
+        if (crc.length() && crc != h.crc32cBase64())
+            return false;
+        if (md5.length() && h.md5_available && md5 != h.md5Base64())
+            return false;
+        h.verified = crc.length() || (md5.length() && h.md5_available);
+        return true;
+    }
+
+    bool downloadOK(async_data_item_t *sData) { return sData->response.httpCode == FIREBASE_ERROR_HTTP_CODE_OK || (sData->response.httpCode == FIREBASE_ERROR_HTTP_CODE_PARTIAL_CONTENT && sData->request.resume); }
+
+    // The progress includes the bytes that were downloaded before resume.
+    void setDownloadProgress(async_data_item_t *sData)
+    {
+        size_t start = sData->request.resume ? sData->request.resume->start : 0;
+        sData->aResult.download_data.total = start + sData->response.payloadLen;
+        sData->aResult.download_data.downloaded = start + sData->response.payloadRead;
+        sData->aResult.setDownloadRate();
+    }
+
+    // The range is resumed only for the partial content of unchanged object, the full content is written from the first byte.
+    void beginDownloadResume(async_data_item_t *sData)
+    {
+        download_resume_state_t *resume = sData->request.resume;
+        if (!resume)
+            return;
+
+        if (resume->start == 0 || sData->response.httpCode != FIREBASE_ERROR_HTTP_CODE_PARTIAL_CONTENT)
+        {
+            resume->start = 0;
+            resume->etag = sData->response.val[res_hndlr_ns::etag];
+        }
+        resume->offset = resume->start;
     }
 
     void clear(async_data_item_t *sData)
@@ -1262,6 +3189,7 @@ private:
         sData->response.chunkInfo.chunkSize = 0;
         sData->response.chunkInfo.dataLen = 0;
         sData->response.chunkInfo.phase = async_response_handler_t::READ_CHUNK_SIZE;
+        clear(sData->response.chunkInfo.line);
     }
 
     void reset(async_data_item_t *sData, bool disconnect)
@@ -1277,6 +3205,11 @@ private:
         sData->aResult.download_data.reset();
         sData->aResult.upload_data.reset();
         clear(sData);
+        releaseBlock(sData);
+#if defined(ENABLE_DATABASE)
+        if (sData->sse)
+            setBackoff(sData);
+#endif
     }
 
     function_return_type connect(async_data_item_t *sData, const char *host, uint16_t port)
@@ -1284,11 +3217,60 @@ private:
         sData->aResult.lastError.clearError();
         lastErr.clearError();
 
-        if (client && !client->connected() && !sData->auth_used) // This info is already show in auth task
+        async_conn_t &c = conn[conn_index];
+
+        if (client && !client->connected() && !sData->auth_used && !c.handshake_pending) // This info is already show in auth task
             sData->aResult.setDebug(FPSTR("Connecting to server..."));
 
+        request_timings_t &t = sData->aResult.timing_data;
+
         if (client && !client->connected() && client_type == async_request_handler_t::tcp_client_type_sync)
-            sData->return_type = client->connect(host, port) > 0 ? function_return_type_complete : function_return_type_failure;
+        {
+            if (!c.handshake_pending)
+            {
+                c.session = session_cache.select(client, host, port);
+                tls_frag_len = session_cache.fragLength(c.session);
+                c.dns = dns_cache.select(client, host);
+                t.mark(t.connect_start_us);
+            }
+
+            if (c.handshake)
+            {
+                int ret = -1;
+                if (!c.handshake_pending)
+                {
+                    c.handshake_pending = c.handshake(client, host, port, true) > 0;
+                    if (c.handshake_pending)
+                        t.mark(t.connect_end_us);
+                }
+
+                // The handshake is advanced once per loop.
+                if (c.handshake_pending)
+                    ret = c.handshake(client, host, port, false);
+
+                if (ret != 0)
+                    c.handshake_pending = false;
+
+                sData->return_type = ret > 0 ? function_return_type_complete : (ret < 0 ? function_return_type_failure : function_return_type_continue);
+            }
+            else
+            {
+                sData->return_type = client->connect(host, port) > 0 ? function_return_type_complete : function_return_type_failure;
+                if (sData->return_type == function_return_type_complete)
+                    t.mark(t.connect_end_us);
+            }
+
+            if (sData->return_type == function_return_type_failure)
+            {
+                session_cache.invalidate(c.session);
+                dns_cache.invalidate(c.dns);
+            }
+            else if (sData->return_type == function_return_type_complete)
+            {
+                t.mark(t.tls_end_us);
+                countConnect(c.session > -1 && session_cache.lastHit());
+            }
+        }
         else if (client_type == async_request_handler_t::tcp_client_type_async)
         {
 
@@ -1301,6 +3283,7 @@ private:
 
                 if (!status)
                 {
+                    t.mark(t.connect_start_us);
                     if (async_tcp_config->tcpConnect)
                         async_tcp_config->tcpConnect(host, port);
 
@@ -1309,10 +3292,17 @@ private:
                 }
 
                 sData->return_type = status ? function_return_type_complete : function_return_type_continue;
+                if (status && t.connect_start_us && !t.connect_end_us)
+                {
+                    t.mark(t.connect_end_us);
+                    t.mark(t.tls_end_us);
+                    countConnect(false);
+                }
             }
 #endif
         }
 
+        FIREBASE_TRACE(trace_event_connect, sData->trace_id, sData->state, sData->return_type, 0);
         this->host = host;
         this->port = port;
         return sData->return_type;
@@ -1399,62 +3389,80 @@ private:
         return strcmp(buf, "0.0.0.0") != 0;
     }
 
+    // Go to the next step of network connection.
+    void bringupNext(firebase_net_bringup_step step)
+    {
+        net.bringup_step = step;
+        net.bringup_ms = millis();
+    }
+
+    bool bringupWait(unsigned long ms) { return millis() - net.bringup_ms < ms; }
+
+    // Advance the GPRS/EPS connection, the modem is polled for network registration instead of waiting for it.
     bool gprsConnect(async_data_item_t *sData)
     {
 #if defined(FIREBASE_GSM_MODEM_IS_AVAILABLE)
         TinyGsm *gsmModem = (TinyGsm *)net.gsm.modem;
-        if (gsmModem)
-        {
-            // Unlock your SIM card with a PIN if needed
-            if (net.gsm.pin.length() && gsmModem->getSimStatus() != 3)
-                gsmModem->simUnlock(net.gsm.pin.c_str());
+        if (!gsmModem)
+            return false;
 
-#if defined(TINY_GSM_MODEM_XBEE)
-            // The XBee must run the gprsConnect function BEFORE waiting for network!
-            gsmModem->gprsConnect(_apn.c_str(), _user.c_str(), _password.c_str());
-#endif
-            if (netErrState == 0 && sData)
-                sData->aResult.setDebug(FPSTR("Waiting for network..."));
-            if (!gsmModem->waitForNetwork())
+        switch (net.bringup_step)
+        {
+        case firebase_net_bringup_gsm_network:
+            if (!gsmModem->isNetworkConnected())
             {
+                if (bringupWait(FIREBASE_GSM_NETWORK_TIMEOUT))
+                    return false;
                 if (netErrState == 0 && sData)
                     sData->aResult.setDebug(FPSTR("Network connection failed"));
                 netErrState = 1;
                 net.network_status = false;
+                bringupNext(firebase_net_bringup_idle);
                 return false;
             }
 
             if (netErrState == 0 && sData)
-                sData->aResult.setDebug(FPSTR("Network connected"));
-
-            if (gsmModem->isNetworkConnected())
             {
+                sData->aResult.setDebug(FPSTR("Network connected"));
+                String debug = FPSTR("Connecting to ");
+                debug += net.gsm.apn.c_str();
+                sData->aResult.setDebug(debug);
+            }
+            bringupNext(firebase_net_bringup_gsm_gprs);
+            return false;
 
-                if (netErrState == 0 && sData)
-                {
-                    String debug = FPSTR("Connecting to ");
-                    debug += net.gsm.apn.c_str();
-                    sData->aResult.setDebug(debug);
-                }
-
-                net.network_status = gsmModem->gprsConnect(net.gsm.apn.c_str(), net.gsm.user.c_str(), net.gsm.password.c_str()) &&
-                                     gsmModem->isGprsConnected();
+        case firebase_net_bringup_gsm_gprs:
+            net.network_status = gsmModem->gprsConnect(net.gsm.apn.c_str(), net.gsm.user.c_str(), net.gsm.password.c_str()) &&
+                                 gsmModem->isGprsConnected();
 
-                if (netErrState == 0 && sData)
-                {
-                    if (net.network_status)
-                        sData->aResult.setDebug(FPSTR("GPRS/EPS connected"));
-                    else
-                        sData->aResult.setDebug(FPSTR("GPRS/EPS connection failed"));
-                }
+            if (netErrState == 0 && sData)
+            {
+                if (net.network_status)
+                    sData->aResult.setDebug(FPSTR("GPRS/EPS connected"));
+                else
+                    sData->aResult.setDebug(FPSTR("GPRS/EPS connection failed"));
             }
 
             if (!net.network_status)
                 netErrState = 1;
 
+            bringupNext(firebase_net_bringup_idle);
             return net.network_status;
-        }
 
+        default:
+            // Unlock your SIM card with a PIN if needed
+            if (net.gsm.pin.length() && gsmModem->getSimStatus() != 3)
+                gsmModem->simUnlock(net.gsm.pin.c_str());
+
+#if defined(TINY_GSM_MODEM_XBEE)
+            // The XBee must run the gprsConnect function BEFORE waiting for network!
+            gsmModem->gprsConnect(net.gsm.apn.c_str(), net.gsm.user.c_str(), net.gsm.password.c_str());
+#endif
+            if (netErrState == 0 && sData)
+                sData->aResult.setDebug(FPSTR("Waiting for network..."));
+            bringupNext(firebase_net_bringup_gsm_network);
+            return false;
+        }
 #endif
         return false;
     }
@@ -1477,63 +3485,92 @@ private:
         return !net.network_status;
     }
 
+    // Advance the Ethernet connection, the module reset and link waiting are timed instead of delayed.
     bool ethernetConnect(async_data_item_t *sData)
     {
         bool ret = false;
 
 #if defined(FIREBASE_ETHERNET_MODULE_IS_AVAILABLE) && defined(ENABLE_ETHERNET_NETWORK)
 
-        if (net.ethernet.ethernet_cs_pin > -1)
-            ETH_MODULE_CLASS.init(net.ethernet.ethernet_cs_pin);
-
-        if (net.ethernet.ethernet_reset_pin > -1)
+        switch (net.bringup_step)
         {
-            if (sData)
-                sData->aResult.setDebug(FPSTR("Resetting Ethernet Board..."));
-
-            pinMode(net.ethernet.ethernet_reset_pin, OUTPUT);
-            digitalWrite(net.ethernet.ethernet_reset_pin, HIGH);
-            delay(200);
+        case firebase_net_bringup_eth_reset_low:
+            if (bringupWait(200))
+                return false;
             digitalWrite(net.ethernet.ethernet_reset_pin, LOW);
-            delay(50);
+            bringupNext(firebase_net_bringup_eth_reset_high);
+            return false;
+
+        case firebase_net_bringup_eth_reset_high:
+            if (bringupWait(50))
+                return false;
             digitalWrite(net.ethernet.ethernet_reset_pin, HIGH);
-            delay(200);
-        }
+            bringupNext(firebase_net_bringup_eth_begin);
+            return false;
 
-        if (sData)
-            sData->aResult.setDebug(FPSTR("Starting Ethernet connection..."));
+        case firebase_net_bringup_eth_begin:
+            if (bringupWait(200))
+                return false;
 
-        if (net.ethernet.static_ip)
-        {
+            if (sData)
+                sData->aResult.setDebug(FPSTR("Starting Ethernet connection..."));
+
+            if (net.ethernet.static_ip)
+            {
 
-            if (net.ethernet.static_ip->optional == false)
-                ETH_MODULE_CLASS.begin(net.ethernet.ethernet_mac, net.ethernet.static_ip->ipAddress, net.ethernet.static_ip->dnsServer, net.ethernet.static_ip->defaultGateway, net.ethernet.static_ip->netMask);
-            else if (!ETH_MODULE_CLASS.begin(net.ethernet.ethernet_mac))
+                if (net.ethernet.static_ip->optional == false)
+                    ETH_MODULE_CLASS.begin(net.ethernet.ethernet_mac, net.ethernet.static_ip->ipAddress, net.ethernet.static_ip->dnsServer, net.ethernet.static_ip->defaultGateway, net.ethernet.static_ip->netMask);
+                else if (!ETH_MODULE_CLASS.begin(net.ethernet.ethernet_mac))
+                {
+                    ETH_MODULE_CLASS.begin(net.ethernet.ethernet_mac, net.ethernet.static_ip->ipAddress, net.ethernet.static_ip->dnsServer, net.ethernet.static_ip->defaultGateway, net.ethernet.static_ip->netMask);
+                }
+            }
+            else
+                ETH_MODULE_CLASS.begin(net.ethernet.ethernet_mac);
+
+            bringupNext(firebase_net_bringup_eth_link);
+            return false;
+
+        case firebase_net_bringup_eth_link:
+            ret = ethernetConnected();
+            if (!ret && bringupWait(FIREBASE_ETHERNET_MODULE_TIMEOUT))
+                return false;
+
+            if (ret && sData)
             {
-                ETH_MODULE_CLASS.begin(net.ethernet.ethernet_mac, net.ethernet.static_ip->ipAddress, net.ethernet.static_ip->dnsServer, net.ethernet.static_ip->defaultGateway, net.ethernet.static_ip->netMask);
+                String debug = FPSTR("Starting Ethernet connection...");
+                debug += ETH_MODULE_CLASS.localIP();
+                sData->aResult.setDebug(debug);
             }
-        }
-        else
-            ETH_MODULE_CLASS.begin(net.ethernet.ethernet_mac);
 
-        net.eth_timer.feed(FIREBASE_ETHERNET_MODULE_TIMEOUT);
+            if (!ret && sData)
+                sData->aResult.setDebug(FPSTR("Can't connect to network"));
 
-        while (ETH_MODULE_CLASS.linkStatus() == LinkOFF && net.eth_timer.remaining() > 0)
-        {
-            delay(100);
-        }
+            bringupNext(firebase_net_bringup_idle);
+            return ret;
 
-        ret = ethernetConnected();
+        default:
+            if (net.ethernet.ethernet_cs_pin > -1)
+                ETH_MODULE_CLASS.init(net.ethernet.ethernet_cs_pin);
 
-        if (ret && sData)
-        {
-            String debug = FPSTR("Starting Ethernet connection...");
-            debug += ETH_MODULE_CLASS.localIP();
-            sData->aResult.setDebug(debug);
-        }
+            if (net.ethernet.ethernet_reset_pin > -1)
+            {
+                if (sData)
+                    sData->aResult.setDebug(FPSTR("Resetting Ethernet Board..."));
 
-        if (!ret && sData)
-            sData->aResult.setDebug(FPSTR("Can't connect to network"));
+                pinMode(net.ethernet.ethernet_reset_pin, OUTPUT);
+                digitalWrite(net.ethernet.ethernet_reset_pin, HIGH);
+                bringupNext(firebase_net_bringup_eth_reset_low);
+            }
+            else
+            {
+                // The begin step is not delayed without the module reset.
+                bringupNext(firebase_net_bringup_eth_begin);
+                net.bringup_ms -= 200;
+                return ethernetConnect(sData);
+            }
+            return false;
+        }
 
 #endif
 
@@ -1544,17 +3581,103 @@ private:
     {
 #if defined(FIREBASE_ETHERNET_MODULE_IS_AVAILABLE)
         net.network_status = ETH_MODULE_CLASS.linkStatus() == LinkON && validIP(ETH_MODULE_CLASS.localIP());
-        if (!net.network_status)
-        {
-            delay(FIREBASE_ETHERNET_MODULE_TIMEOUT);
-            net.network_status = ETH_MODULE_CLASS.linkStatus() == LinkON && validIP(ETH_MODULE_CLASS.localIP());
-        }
 #endif
         return net.network_status;
     }
 
+    // Returns the status of network at index, the current network state is kept.
+    bool probeNetwork(uint8_t index)
+    {
+        failover_net[failover_index].copy(net);
+        net.copy(failover_net[index]);
+        bool status = readNetStatus(nullptr);
+        failover_net[index].copy(net);
+        net.copy(failover_net[failover_index]);
+        return status;
+    }
+
+    // Stop the connections and use the network at index, the in-flight requests are sent again on the new network
+    // except the transfers that can't be restarted and the POST and PATCH requests that were sent completely.
+    void switchNetwork(uint8_t index, async_data_item_t *sData)
+    {
+        for (uint8_t i = conn_count; i > 0; i--)
+        {
+            switchConn(i - 1);
+            stop(nullptr);
+            conn[i - 1].slot_data = nullptr;
+        }
+
+        if (failover_index == 0)
+            failover_pool = conn_count;
+
+        failover_net[failover_index].copy(net);
+        failover_conn[failover_index] = conn[0];
+        failover_index = index;
+        net.copy(failover_net[index]);
+        net_status_valid = false;
+        conn[0] = failover_conn[index];
+        client = conn[0].client;
+        // The connection pool is of the network of constructor.
+        conn_count = index == 0 ? failover_pool : 1;
+
+        for (size_t i = 0; i < sVec.size(); i++)
+        {
+            async_data_item_t *d = getData(i);
+            if (!d)
+                continue;
+            d->conn_index = -1;
+            if (d->state == async_state_undefined)
+                continue;
+            bool sent = d->state == async_state_read_response && !idempotent(d);
+            if (sent || d->upload || d->download || d->writer || d->sink || d->request.ota)
+                setAsyncError(d, d->state, FIREBASE_ERROR_TCP_DISCONNECTED, !d->sse, true);
+            else
+            {
+                reset(d, false);
+                d->request.payloadIndex = 0;
+                d->aResult.timing_data.clearStages();
+            }
+        }
+
+        if (sData)
+            sData->aResult.setDebug(index == 0 ? FPSTR("Failing back to primary network...") : FPSTR("Failing over to secondary network..."));
+    }
+
+    // Use the first network in priority order that is up when the current network is down, and the higher priority
+    // network when it is up again, the networks are probed immediately when the current network was down and then
+    // every FIREBASE_NETWORK_FAILBACK_SEC.
+    void failover(async_data_item_t *sData)
+    {
+        bool up = netStatus(sData);
+        if (up && failover_index == 0)
+        {
+            failover_up = true;
+            return;
+        }
+
+        bool probe = (!up && failover_up) || failover_timer.remaining() == 0;
+        failover_up = up;
+        if (!probe)
+            return;
+
+        failover_timer.feed(FIREBASE_NETWORK_FAILBACK_SEC);
+        uint8_t end = up ? failover_index : failover_count;
+        for (uint8_t i = 0; i < end; i++)
+        {
+            if (i != failover_index && probeNetwork(i))
+            {
+                switchNetwork(i, sData);
+                failover_up = true;
+                return;
+            }
+        }
+    }
+
     bool netConnect(async_data_item_t *sData)
     {
+        if (failover_count > 1)
+            failover(sData);
+
         if (!netStatus(sData))
         {
             bool recon = net.reconnect;
@@ -1565,6 +3688,7 @@ private:
             if (recon && (net.net_timer.remaining() == 0))
             {
                 net.net_timer.feed(FIREBASE_NET_RECONNECT_TIMEOUT_SEC);
+                net_status_valid = false;
 
                 if (sData)
                     sData->aResult.setDebug(FPSTR("Reconnecting to network..."));
@@ -1584,8 +3708,12 @@ private:
                 }
                 else if (net.network_data_type == firebase_network_data_gsm_network)
                 {
-                    gprsDisconnect();
-                    gprsConnect(sData);
+                    // The connection that is in progress is not restarted.
+                    if (net.bringup_step == firebase_net_bringup_idle)
+                    {
+                        gprsDisconnect();
+                        gprsConnect(sData);
+                    }
                 }
                 else if (net.network_data_type == firebase_network_data_ethernet_network)
                 {
@@ -1612,7 +3740,51 @@ private:
         return netStatus(sData);
     }
 
+    // The sequence of WiFi events that the cached network status of all async clients is invalidated.
+    static uint32_t &netEventSeq()
+    {
+        static uint32_t seq = 0;
+        return seq;
+    }
+
+#if defined(ESP32) && defined(FIREBASE_WIFI_IS_AVAILABLE)
+    static void onNetEvent(WiFiEvent_t event)
+    {
+        (void)event;
+        netEventSeq()++;
+    }
+#endif
+
+    // Listen to the WiFi events, it is registered once when the network status is first read.
+    void listenNetEvents()
+    {
+#if defined(ESP32) && defined(FIREBASE_WIFI_IS_AVAILABLE)
+        static bool listening = false;
+        if (!listening)
+        {
+            listening = true;
+            WiFi.onEvent(onNetEvent);
+        }
+#endif
+    }
+
+    // Returns the network status that was read within FIREBASE_NET_STATUS_CACHE_MS when no WiFi event was received
+    // since, instead of reading the link status of SPI network module or modem in every call.
     bool netStatus(async_data_item_t *sData)
+    {
+#if FIREBASE_NET_STATUS_CACHE_MS > 0
+        listenNetEvents();
+        if (net_status_valid && net_status_seq == netEventSeq() && millis() - net_status_ms < FIREBASE_NET_STATUS_CACHE_MS)
+            return net.network_status;
+#endif
+        bool status = readNetStatus(sData);
+        net_status_ms = millis();
+        net_status_seq = netEventSeq();
+        net_status_valid = true;
+        return status;
+    }
+
+    bool readNetStatus(async_data_item_t *sData)
     {
         // We will not invoke the network status request when device has built-in WiFi or Ethernet and it is connected.
         if (net.network_data_type == firebase_network_data_gsm_network)
@@ -1649,7 +3821,7 @@ private:
             slot = 0;
         else
         {
-            int sse_index = -1, auth_index = -1;
+            int sse_index = -1, auth_index = -1, sse_count = 0;
             for (size_t i = 0; i < sVec.size(); i++)
             {
                 if (getData(i))
@@ -1657,7 +3829,11 @@ private:
                     if (getData(i)->auth_used)
                         auth_index = i;
                     else if (getData(i)->sse)
-                        sse_index = i;
+                    {
+                        if (sse_index == -1)
+                            sse_index = i;
+                        sse_count++;
+                    }
                 }
             }
 
@@ -1666,8 +3842,20 @@ private:
             else if (sse_index > -1)
                 slot = sse_index;
 
-            // Multiple SSE modes
-            if ((sse_index > -1 && options.sse) || sVec.size() >= FIREBASE_ASYNC_QUEUE_LIMIT)
+            // Insert before the first lower priority task that is not started.
+            for (size_t i = auth_index + 1; i < sVec.size(); i++)
+            {
+                async_data_item_t *sData = getData(i);
+                if (sData && !sData->sse && sData->state == async_state_undefined && sData->priority > options.priority)
+                {
+                    if (slot == -1 || (int)i < slot)
+                        slot = i;
+                    break;
+                }
+            }
+
+            // Each SSE stream keeps its connection, one connection in pool is left for the other tasks.
+            if ((options.sse && sse_count >= maxStreams()) || sVec.size() >= FIREBASE_ASYNC_QUEUE_LIMIT)
                 slot = -2;
 
             if (slot >= (int)sVec.size())
@@ -1682,10 +3870,82 @@ private:
         sData->request.addContentTypeHeader(type.c_str());
     }
 
+    // Request the remaining bytes of interrupted download, the range is valid only when the object ETag was not changed.
+    void setDownloadResume(async_data_item_t *sData, download_resume_state_t *state)
+    {
+        sData->request.resume = state;
+        if (state && state->start > 0)
+            setRangeHeader(sData, state->start, 0, state->etag);
+    }
+
+#if defined(ENABLE_FS) && defined(ENABLE_CLOUD_STORAGE)
+    // Set the persisted session of resumable upload, the committed offset of the stored session is queried instead of initiating the new session.
+    void setUploadSession(async_data_item_t *sData, resumable_session_t *session, bool resume)
+    {
+        sData->request.file_data.resumable.setSession(session);
+        if (!resume)
+            return;
+
+        sData->request.file_data.resumable.beginQuery();
+        sData->request.val[req_hndlr_ns::url] = session->location;
+        String ext;
+        String host = getHost(sData, false, &ext);
+        sData->request.file_data.resumable.getQueryHeader(sData->request.val[req_hndlr_ns::header], host, ext);
+        clear(sData->request.val[req_hndlr_ns::payload]);
+    }
+#endif
+
+    // Add the Range header (and If-Match header) to GET request, the range is open ended when last is less than first.
+    void setRangeHeader(async_data_item_t *sData, size_t first, size_t last, const String &etag = "")
+    {
+        // Remove the last new line of GET request header.
+        String &header = sData->request.val[req_hndlr_ns::header];
+        header.remove(header.length() - 2);
+        header += FPSTR("Range: bytes=");
+        header += (unsigned long)first;
+        header += '-';
+        if (last >= first)
+            header += (unsigned long)last;
+        sData->request.addNewLine();
+        sData->range_part = last >= first;
+        if (etag.length())
+        {
+            header += FPSTR("If-Match: ");
+            header += etag;
+            sData->request.addNewLine();
+        }
+        sData->request.addNewLine();
+    }
+
+    // Add the If-None-Match header to GET request, the server responds 304 when the object ETag was not changed.
+    void setConditionalHeader(async_data_item_t *sData, const String &etag)
+    {
+        String &header = sData->request.val[req_hndlr_ns::header];
+        if (etag.length() == 0 || header.indexOf("If-None-Match:") > -1)
+            return;
+#if defined(ENABLE_FS)
+        // The local file that was removed or is empty can't be kept, it is downloaded again.
+        if (sData->request.file_data.cb && sData->request.file_data.filename.length())
+        {
+            sData->request.file_data.cb(sData->request.file_data.file, sData->request.file_data.filename.c_str(), file_mode_open_read);
+            bool exists = sData->request.file_data.file && sData->request.file_data.file.size() > 0;
+            if (sData->request.file_data.file)
+                sData->request.file_data.file.close();
+            if (!exists)
+                return;
+        }
+#endif
+        header.remove(header.length() - 2);
+        header += FPSTR("If-None-Match: ");
+        header += etag;
+        sData->request.addNewLine();
+        sData->request.addNewLine();
+    }
+
     void setFileContentLength(async_data_item_t *sData, int headerLen = 0, const String &customHeader = "")
     {
 #if defined(ENABLE_FS)
-        if ((sData->request.file_data.cb && sData->request.file_data.filename.length()) || (sData->request.file_data.data_size && sData->request.file_data.data))
+        if ((sData->request.file_data.cb && sData->request.file_data.filename.length()) || (sData->request.file_data.data_size && sData->request.file_data.data) || sData->request.file_data.source)
         {
             Base64Util but;
             size_t sz = 0;
@@ -1693,9 +3953,26 @@ private:
             {
                 sData->request.file_data.cb(sData->request.file_data.file, sData->request.file_data.filename.c_str(), file_mode_open_read);
                 sz = sData->request.file_data.file.size();
+                if (sData->request.file_data.range_size)
+                {
+                    size_t remaining = sz > sData->request.file_data.range_offset ? sz - sData->request.file_data.range_offset : 0;
+                    sz = remaining < sData->request.file_data.range_size ? remaining : sData->request.file_data.range_size;
+                }
             }
             else
-                sz = sData->request.file_data.data_size;
+                sz = sData->request.file_data.dataLength();
+
+            // The base64 encoded data requires the total length.
+            if (sData->request.file_data.chunked())
+            {
+                sData->request.file_data.file_size = 0;
+                if (!sData->request.base64)
+                {
+                    sData->request.val[req_hndlr_ns::header] += FPSTR("Transfer-Encoding: chunked\r\n");
+                    sData->request.addNewLine();
+                }
+                return;
+            }
 
             sData->request.file_data.file_size = sData->request.base64 ? 2 + but.getBase64Len(sz) : sz;
             if (customHeader.length())
@@ -1726,9 +4003,9 @@ private:
 #if defined(ENABLE_DATABASE)
     void handleEventTimeout(async_data_item_t *sData)
     {
-        if (sData->sse && sData->aResult.rtdbResult.eventTimeout() && sData->aResult.rtdbResult.eventResumeStatus() == RealtimeDatabaseResult::event_resume_status_undefined)
+        if (sData->sse && sData->aResult.rtdb().eventTimeout() && sData->aResult.rtdb().eventResumeStatus() == RealtimeDatabaseResult::event_resume_status_undefined)
         {
-            sData->aResult.rtdbResult.setEventResumeStatus(RealtimeDatabaseResult::event_resume_status_resuming);
+            sData->aResult.rtdb().setEventResumeStatus(RealtimeDatabaseResult::event_resume_status_resuming);
             setAsyncError(sData, sData->state, FIREBASE_ERROR_STREAM_TIMEOUT, false, false);
             returnResult(sData, false);
             reset(sData, true);
@@ -1736,14 +4013,268 @@ private:
     }
 #endif
 
-    bool handleSendTimeout(async_data_item_t *sData)
+    // The time budget of process call was spent by async task (or by the processed slots when sData is null).
+    bool budgetSpent(async_data_item_t *sData = nullptr) { return (!sData || sData->async) && budget_us > 0 && micros() - budget_start >= budget_us; }
+
+    // The async GET request whose response is returned to its result and callback only.
+    bool coalescible(async_data_item_t *sData)
+    {
+        return sData && sData->async && sData->request.method == async_request_handler_t::http_get && !sData->sse && !sData->preconnect && !sData->auth_used && !sData->cancel &&
+               !sData->to_remove && !sData->download && !sData->sink && !sData->writer && !sData->event_handler && !sData->request.ota;
+    }
+
+    // Attach the results and callbacks of the waiting reads to the pending or in-flight read with identical request header
+    // (method, URL, query and headers), the waiting reads are removed.
+    void coalesceReads()
     {
-        if (sData->request.send_timer.remaining() == 0 || sData->cancel)
+        for (size_t slot = 1; slot < slotCount(); slot++)
         {
-            setAsyncError(sData, sData->state, FIREBASE_ERROR_TCP_SEND, !sData->sse, false);
-            sData->return_type = function_return_type_failure;
-            // This requires by WiFiSSLClient before stating a new connection in case session was reused.
-            reset(sData, true);
+            async_data_item_t *sData = getData(slot);
+            if (!coalescible(sData) || sData->state != async_state_undefined || sData->conn_index > -1)
+                continue;
+
+            for (size_t i = 0; i < slot; i++)
+            {
+                async_data_item_t *lead = getData(i);
+                if (!coalescible(lead) || lead->request.val[req_hndlr_ns::header] != sData->request.val[req_hndlr_ns::header])
+                    continue;
+
+                async_data_item_t::follower_t f;
+                if (getResult(sData))
+                {
+                    f.refResult = sData->refResult;
+                    f.ref_result_handle = sData->ref_result_handle;
+                }
+                f.cb = sData->cb;
+                f.uid = sData->aResult.cval(ares_ns::res_uid);
+                lead->followers.push_back(f);
+                for (size_t k = 0; k < sData->followers.size(); k++)
+                    lead->followers.push_back(sData->followers[k]);
+
+                // The slot is removed without returning its result.
+                sData->followers.clear();
+                sData->cb = NULL;
+                sData->ref_result_handle = 0;
+                removeSlot(slot);
+                slot--;
+                break;
+            }
+        }
+    }
+
+    // Return the result of coalesced read to the results and callbacks that were attached.
+    void returnFollowers(async_data_item_t *sData)
+    {
+        for (size_t i = 0; i < sData->followers.size(); i++)
+        {
+            async_data_item_t::follower_t &f = sData->followers[i];
+            AsyncResult *aResult = Registry::shared().get<AsyncResult>(f.ref_result_handle);
+            AsyncResult result;
+            if (aResult)
+            {
+                uint32_t ms = aResult->last_debug_ms;
+                *aResult = sData->aResult;
+                aResult->last_debug_ms = ms;
+                if (aResult->done_cb)
+                    doneVec.push_back(f.ref_result_handle);
+            }
+            else if (f.cb)
+            {
+                result = sData->aResult;
+                aResult = &result;
+            }
+            else
+                continue;
+
+            aResult->setUID(f.uid);
+            if (aResult->payload_val.length() && !aResult->error_available)
+                aResult->data_available = true;
+            aResult->setPayloadRef();
+            if (f.cb)
+                f.cb(*aResult);
+        }
+        sData->followers.clear();
+    }
+
+    bool cancelled(async_data_item_t *sData) { return !sData->auth_used && (sData->cancel || (sData->cancel_token && sData->cancel_token->isCancelled())); }
+
+    // Read and discard the remaining payload of cancelled task, returns true when the payload was read completely.
+    bool drainPayload(async_data_item_t *sData)
+    {
+        uint8_t buf[128];
+        while (sData->response.payloadRead < sData->response.payloadLen && sData->response.available(client_type, client, async_tcp_config) > 0)
+        {
+            size_t len = sData->response.payloadLen - sData->response.payloadRead;
+            int read = sData->response.read(client_type, client, async_tcp_config, buf, len < sizeof(buf) ? len : sizeof(buf));
+            if (read <= 0)
+                break;
+            sData->response.payloadRead += read;
+        }
+        return sData->response.payloadRead >= sData->response.payloadLen;
+    }
+
+    // Abort the cancelled tasks at the I/O boundary, their files, blocks and decoders are released and the results are returned.
+    // The connection is drained and kept alive when the small remaining payload of response is known.
+    void handleCancel()
+    {
+        for (size_t slot = 0; slot < slotCount(); slot++)
+        {
+            async_data_item_t *sData = getData(slot);
+            if (!sData || !cancelled(sData))
+                continue;
+
+            if (sData->draining)
+            {
+                if (conn_count > 1 && !bindConn(sData))
+                    continue;
+                bool done = drainPayload(sData);
+                if (!done && sData->response.read_timer.remaining() > 0)
+                    continue;
+                if (!done || !sData->response.flags.keep_alive)
+                    stop(sData);
+                removeSlot(slot);
+                slot--;
+                continue;
+            }
+
+            bool drain = sData->state == async_state_read_response && !sData->sse && sData->response.httpCode > 0 && !sData->response.flags.header_remaining &&
+                         !sData->response.flags.chunks && sData->response.flags.keep_alive && sData->response.payloadLen - sData->response.payloadRead <= FIREBASE_CANCEL_DRAIN_SIZE;
+
+            if (sData->request.ota && sData->response.payloadRead > 0)
+            {
+                OTAUtil otaut;
+                otaut.abortUpdate();
+            }
+            sData->freeOTAWriter();
+#if defined(ENABLE_GZIP)
+            sData->freeInflate();
+#endif
+            setAsyncError(sData, sData->state, FIREBASE_ERROR_OPERATION_CANCELLED, true, true);
+            releaseBlock(sData);
+            sData->arena.reset();
+            updateMemStats(sData);
+
+            if (drain)
+            {
+                // The result is returned now, the slot is removed when the remaining payload was discarded.
+                sData->aResult.timing_data.mark(sData->aResult.timing_data.complete_us);
+                returnResult(sData, true, true);
+                if (getResult(sData) && sData->refResult->done_cb)
+                    doneVec.push_back(sData->ref_result_handle);
+                if (sData->followers.size())
+                    returnFollowers(sData);
+                sData->cb = NULL;
+                sData->ref_result_handle = 0;
+                sData->draining = true;
+                sData->response.feedTimer();
+                slot--;
+                continue;
+            }
+
+            if (sData->conn_index > -1 || (conn_count == 1 && slot == 0 && sData->state != async_state_undefined))
+                stop(sData);
+            removeSlot(slot);
+            slot--;
+        }
+    }
+
+    // Notify the producer when the queue depth crosses the watermarks.
+    void checkWatermark()
+    {
+        if (!queue_cb)
+            return;
+        size_t depth = queueDepth();
+        if (!queue_full && depth >= queue_high)
+        {
+            queue_full = true;
+            queue_cb(depth, true);
+        }
+        else if (queue_full && depth <= queue_low)
+        {
+            queue_full = false;
+            queue_cb(depth, false);
+        }
+    }
+
+    // Returns the read timeout in seconds of the task, -1 for the default timeout.
+    int readTimeout(async_data_item_t *sData)
+    {
+        if (!sData->async && sync_read_timeout_sec > 0)
+            return sync_read_timeout_sec;
+        uint32_t sec = link_adaptive && sData->async ? link.readTimeout() : 0;
+        return sec ? (int)sec : -1;
+    }
+
+    // Add the round-trip time (from request sent to the first byte of response) and goodput of the completed task to the link estimate.
+    void addLinkSample(async_data_item_t *sData)
+    {
+        const request_timings_t &t = sData->aResult.timing_data;
+        int code = sData->aResult.error_available ? sData->aResult.lastError.code() : 0;
+        uint32_t sent_us = t.body_sent_us ? t.body_sent_us : t.header_sent_us;
+        if (sent_us == 0 && code == 0)
+            return;
+        uint32_t rtt_us = t.first_byte_us > sent_us ? t.first_byte_us - sent_us : 0;
+        uint32_t transfer_us = t.complete_us > t.header_sent_us ? t.complete_us - t.header_sent_us : 0;
+        size_t bytes = sData->request.val[req_hndlr_ns::header].length() + sData->request.payloadIndex + sData->response.payloadRead;
+        link.add(rtt_us, bytes, transfer_us, code);
+    }
+
+    // The size of request header and payload that were not sent.
+    size_t unsentBytes(async_data_item_t *sData)
+    {
+        if (sData->state == async_state_read_response)
+            return 0;
+
+        size_t body = sData->writer ? sData->writer_len : sData->request.val[req_hndlr_ns::payload].length();
+        if (body == 0 && sData->upload)
+            body = sData->request.data && sData->request.dataLen ? sData->request.dataLen : sData->request.file_data.file_size;
+
+        if (sData->state == async_state_send_payload)
+            return body > sData->request.payloadIndex ? body - sData->request.payloadIndex : 0;
+        return sData->request.val[req_hndlr_ns::header].length() + body;
+    }
+
+    // Record the time when the request header and payload were sent.
+    void markSent(async_data_item_t *sData)
+    {
+        request_timings_t &t = sData->aResult.timing_data;
+        if (sData->state == async_state_send_payload || sData->state == async_state_read_response)
+            t.mark(t.header_sent_us);
+        if (sData->state == async_state_read_response)
+            t.mark(t.body_sent_us);
+    }
+
+    bool deadlineExpired(async_data_item_t *sData) { return sData->deadline_ms > 0 && millis() - sData->deadline_start >= sData->deadline_ms; }
+
+    // Fail and remove the tasks that were not started before their deadlines.
+    void handleDeadline()
+    {
+        for (size_t slot = 0; slot < slotCount(); slot++)
+        {
+            async_data_item_t *sData = getData(slot);
+            if (!sData || sData->state != async_state_undefined || !deadlineExpired(sData))
+                continue;
+
+            // The task may be connecting.
+            if (sData->conn_index > -1 || (conn_count == 1 && slot == 0))
+                stop(sData);
+            setAsyncError(sData, sData->state, FIREBASE_ERROR_REQUEST_DEADLINE, true, false);
+            if (sData->async)
+                returnResult(sData, false);
+            removeSlot(slot);
+            slot--;
+        }
+    }
+
+    bool handleSendTimeout(async_data_item_t *sData)
+    {
+        bool expired = deadlineExpired(sData);
+        if (sData->request.send_timer.remaining() == 0 || sData->cancel || expired)
+        {
+            setAsyncError(sData, sData->state, expired ? FIREBASE_ERROR_REQUEST_DEADLINE : FIREBASE_ERROR_TCP_SEND, !sData->sse, false);
+            sData->return_type = function_return_type_failure;
+            // This requires by WiFiSSLClient before stating a new connection in case session was reused.
+            reset(sData, true);
             return true;
         }
         return false;
@@ -1751,9 +4282,10 @@ private:
 
     bool handleReadTimeout(async_data_item_t *sData)
     {
-        if (!sData->sse && (sData->response.read_timer.remaining() == 0 || sData->cancel))
+        bool expired = deadlineExpired(sData);
+        if (!sData->sse && (sData->response.read_timer.remaining() == 0 || sData->cancel || expired))
         {
-            setAsyncError(sData, sData->state, FIREBASE_ERROR_TCP_RECEIVE_TIMEOUT, !sData->sse, false);
+            setAsyncError(sData, sData->state, expired ? FIREBASE_ERROR_REQUEST_DEADLINE : FIREBASE_ERROR_TCP_RECEIVE_TIMEOUT, !sData->sse, false);
             sData->return_type = function_return_type_failure;
             // This requires by WiFiSSLClient before stating a new connection in case session was reused.
             reset(sData, true);
@@ -1762,16 +4294,84 @@ private:
         return false;
     }
 
+    // The POST and PATCH requests are not idempotent, they can be sent again only when they were not sent completely
+    // (the connection or send error) that the server did not receive them.
+    bool replayable(async_data_item_t *sData, int code) { return idempotent(sData) || code == FIREBASE_ERROR_TCP_CONNECTION || code == FIREBASE_ERROR_TCP_SEND; }
+
+    bool idempotent(async_data_item_t *sData) { return sData->request.method != async_request_handler_t::http_post && sData->request.method != async_request_handler_t::http_patch; }
+
+    // The failed async request is retried when its payload is kept in slot (not file, blob, writer, download and sink).
+    bool canRetry(async_data_item_t *sData)
+    {
+        if (retry_policy.attempts == 0 || !sData->async || sData->sse || sData->auth_used || sData->cancel || sData->upload || sData->download || sData->writer || sData->sink || sData->request.ota)
+            return false;
+        if (sData->retry_count >= retry_policy.attempts || !retry_policy.retryable(sData->aResult.lastError.code()) || deadlineExpired(sData))
+            return false;
+        if (!retry_policy.non_idempotent && !replayable(sData, sData->aResult.lastError.code()))
+            return false;
+        if (retry_policy.budget > 0 && millis() - retry_window_ms < 60 * 1000 && retry_used >= retry_policy.budget)
+            return false;
+        return true;
+    }
+
+    // Reset the failed request to be sent again after the backoff delay, the request header and payload are not rebuilt.
+    bool retryTask(async_data_item_t *sData)
+    {
+        if (!canRetry(sData))
+            return false;
+
+        int32_t delay = sData->response.retryAfter > 0 ? sData->response.retryAfter * 1000 : retry_policy.backoff(sData->retry_count);
+        if (retry_policy.cb)
+            delay = retry_policy.cb(sData->aResult.lastError.code(), sData->retry_count, delay);
+        if (delay < 0)
+            return false;
+
+        // The retry that was delayed after the deadline is not made.
+        if (sData->deadline_ms > 0 && millis() + delay - sData->deadline_start >= sData->deadline_ms)
+            return false;
+
+        if (millis() - retry_window_ms >= 60 * 1000)
+        {
+            retry_window_ms = millis();
+            retry_used = 0;
+        }
+        retry_used++;
+        FirebaseMetrics::shared().add(metrics_retries);
+        sData->retry_count++;
+        sData->retry_ms = millis();
+        sData->retry_delay_ms = delay;
+
+        // The connection is kept when the error response was read completely.
+        bool complete = sData->response.httpCode > 0 && !sData->response.flags.header_remaining && !sData->response.flags.payload_remaining && sData->response.flags.keep_alive;
+        reset(sData, !complete);
+        sData->to_remove = false;
+        sData->request.payloadIndex = 0;
+        sData->aResult.timing_data.clearStages();
+        sData->aResult.lastError.clearError();
+        sData->aResult.error_available = false;
+        sData->aResult.setDebug(FPSTR("Retrying the request..."));
+        return true;
+    }
+
     void handleProcessFailure(async_data_item_t *sData)
     {
         if (sData->return_type == function_return_type_failure)
         {
+            if (retryTask(sData))
+                return;
             if (sData->async)
                 returnResult(sData, false);
             reset(sData, false);
         }
     }
 
+    uint32_t hostKey(async_data_item_t *sData)
+    {
+        if (sData->host_key == 0)
+            sData->host_key = RateLimiter::key(getHost(sData, true).c_str());
+        return sData->host_key;
+    }
+
     String getHost(async_data_item_t *sData, bool fromReq, String *ext = nullptr)
     {
 #if defined(ENABLE_FS) && defined(ENABLE_CLOUD_STORAGE)
@@ -1785,10 +4385,26 @@ private:
 
     void stopAsyncImpl(bool all = false, const String &uid = "")
     {
+        AsyncLockGuard guard(slot_lock);
         if (inStopAsync)
             return;
 
         inStopAsync = true;
+        if (uid.length())
+        {
+            // The tasks are found from the uid index, the uid is compared only when its hash was matched.
+            uint32_t h = SlotIndex::hash(uid.c_str());
+            const std::vector<SlotIndex::entry_t> &entries = slot_index.find(h);
+            for (size_t i = 0; i < entries.size(); i++)
+            {
+                async_data_item_t *sData = static_cast<async_data_item_t *>(entries[i].slot);
+                if (entries[i].hash == h && sData->id == entries[i].id && sData->async && !sData->auth_used && !sData->cancel && strcmp(sData->aResult.cval(ares_ns::res_uid).c_str(), uid.c_str()) == 0)
+                    sData->cancel = true;
+            }
+            inStopAsync = false;
+            return;
+        }
+
         size_t size = slotCount();
         if (size)
         {
@@ -1798,30 +4414,227 @@ private:
                 async_data_item_t *sData = getData(i);
                 if (sData && sData->async && !sData->auth_used && !sData->cancel)
                 {
-                    if (uid.length())
-                    {
-                        if (strcmp(sData->aResult.uid().c_str(), uid.c_str()) == 0)
-                            sData->cancel = true;
-                    }
-                    else
+                    sData->cancel = true;
+                    if (!all)
+                        break;
+                }
+            }
+        }
+
+        inStopAsync = false;
+    }
+
+    // Returns true when slot was removed.
+    // Open the connection of preconnect task, the task is removed when the connection was established or failed.
+    bool preconnectSlot(size_t slot, async_data_item_t *sData)
+    {
+        String host = getHost(sData, true);
+        newCon(sData, host.c_str(), sData->request.port);
+
+        function_return_type ret = function_return_type_complete;
+        if ((client_type == async_request_handler_t::tcp_client_type_sync && !client->connected()) || client_type == async_request_handler_t::tcp_client_type_async)
+            ret = connect(sData, host.c_str(), sData->request.port);
+
+        if (ret == function_return_type_continue)
+            return false;
+
+        if (ret == function_return_type_complete)
+        {
+            // The new connection is kept for the next request as the kept-alive connection.
+            sse = false;
+            if (!keep_alive)
+            {
+                keep_alive = true;
+                conn[conn_index].idle_ms = millis();
+                conn[conn_index].keep_alive_ms = conn[conn_index].idle_ms;
+            }
+        }
+        else
+            connErrorHandler(sData, sData->state);
+
+        removeSlot(slot);
+        return true;
+    }
+
+    bool processSlot(size_t slot, bool async)
+    {
+        async_data_item_t *sData = getData(slot);
+
+        // The draining task is read by handleCancel.
+        if (!sData || sData->draining)
+            return false;
+
+        if (!netConnect(sData))
+        {
+            setAsyncError(sData, sData->state, FIREBASE_ERROR_TCP_DISCONNECTED, !sData->sse, false);
+            if (retryTask(sData))
+                return false;
+            if (sData->async)
+            {
+                returnResult(sData, false);
+                reset(sData, true);
+            }
+            return false;
+        }
+
+        if (sData->async && !async)
+            return false;
+
+        if (sData->preconnect)
+            return preconnectSlot(slot, sData);
+
+        // We have to re-start sse when the authenticate changed
+        if (sData->sse && sData->auth_ts != auth_ts)
+        {
+            stop(sData);
+            sData->state = async_state_send_header;
+        }
+
+#if defined(ENABLE_DATABASE)
+        // Wait for the backoff delay before reconnecting the stream.
+        if (sData->sse && sData->state == async_state_undefined && sData->sse_delay_ms > 0 && millis() - sData->sse_retry_ms < sData->sse_delay_ms)
+            return false;
+#endif
+
+        // Wait for the backoff delay before retrying the failed request.
+        if (sData->state == async_state_undefined && sData->retry_delay_ms > 0 && millis() - sData->retry_ms < sData->retry_delay_ms)
+            return false;
+
+        // Wait for the batch to be flushed.
+        if (batchHeld(sData))
+            return false;
+
+        // Wait for the token of host when its request rate is limited, the token is taken once until the request was started.
+        if (sData->state == async_state_undefined && !sData->sse && !sData->rate_acquired && rate_limiter.active())
+        {
+            if (!rate_limiter.acquire(hostKey(sData)))
+                return false;
+            sData->rate_acquired = true;
+        }
+
+        bool sending = false;
+        if (sData->state == async_state_undefined || sData->state == async_state_send_header || sData->state == async_state_send_payload)
+        {
+            sData->response.clear();
+            sData->request.feedTimer(!sData->async && sync_send_timeout_sec > 0 ? sync_send_timeout_sec : -1);
+            sending = true;
+            sData->return_type = send(sData);
+            // The retry of request takes the new token.
+            if (sData->state != async_state_undefined)
+                sData->rate_acquired = false;
+            markSent(sData);
+            FIREBASE_TRACE(trace_event_send, sData->trace_id, sData->state, sData->return_type, sData->request.payloadIndex);
+
+            while (sData->state == async_state_send_header || sData->state == async_state_send_payload)
+            {
+                sData->return_type = send(sData);
+                markSent(sData);
+                FIREBASE_TRACE(trace_event_send, sData->trace_id, sData->state, sData->return_type, sData->request.payloadIndex);
+                sData->response.feedTimer(readTimeout(sData));
+                handleSendTimeout(sData);
+                if (sData->async || sData->return_type == function_return_type_failure)
+                    break;
+            }
+
+            // The held request is sent in the minimum numbers of records when it was written completely.
+            if (sData->return_type == function_return_type_failure || (sData->state != async_state_send_header && sData->state != async_state_send_payload))
+                corkConn(false);
+        }
+
+        if (sending)
+        {
+            handleSendTimeout(sData);
+            if (sData->async && sData->return_type == function_return_type_continue)
+                return false;
+        }
+
+        sys_idle();
+
+        if (sData->state == async_state_read_response)
+        {
+            sData->response.peeker = client_type == async_request_handler_t::tcp_client_type_sync ? conn[conn_index].peek : NULL;
+
+            // if (!sData->download && !sData->upload)
+            //    sData->request.clear();
+
+            // it can be complete response from payload sending
+            if (sData->return_type == function_return_type_complete)
+                sData->return_type = function_return_type_continue;
+
+            if (sData->async && !sData->response.available(client_type, client, async_tcp_config))
+            {
+                if (sData->ota_writer)
+                    pollOTA(sData);
+#if defined(ENABLE_DATABASE)
+                handleEventTimeout(sData);
+#endif
+                handleReadTimeout(sData);
+                return false;
+            }
+            else if (!sData->async) // wait for non async
+            {
+                while (!sData->response.available(client_type, client, async_tcp_config) && netConnect(sData))
+                {
+                    sys_idle();
+                    if (handleReadTimeout(sData))
+                        break;
+                }
+            }
+        }
+
+        // Read until status code > 0, header finished and payload read complete
+        if (sData->state == async_state_read_response)
+        {
+            sData->error.code = 0;
+            while (sData->return_type == function_return_type_continue && (sData->response.httpCode == 0 || sData->response.flags.header_remaining || sData->response.flags.payload_remaining))
+            {
+                sData->response.feedTimer(readTimeout(sData));
+                sData->return_type = receive(sData);
+                FIREBASE_TRACE(trace_event_receive, sData->trace_id, sData->state, sData->return_type, sData->response.payloadRead);
+
+                handleReadTimeout(sData);
+
+                bool allRead = sData->response.httpCode > 0 && sData->response.httpCode != FIREBASE_ERROR_HTTP_CODE_OK && !sData->response.flags.header_remaining && !sData->response.flags.payload_remaining;
+                if (allRead && sData->response.httpCode >= FIREBASE_ERROR_HTTP_CODE_BAD_REQUEST)
+                {
+                    if (sData->sse)
                     {
-                        sData->cancel = true;
-                        if (!all)
-                            break;
+                        sData->aResult.data_available = false;
+#if defined(ENABLE_DATABASE)
+                        sData->aResult.clearSSE();
+#endif
                     }
+                    sData->return_type = function_return_type_failure;
                 }
+
+                if (sData->async || allRead || sData->return_type == function_return_type_failure)
+                    break;
             }
         }
 
-        inStopAsync = false;
+        handleProcessFailure(sData);
+
+#if defined(ENABLE_DATABASE)
+        handleEventTimeout(sData);
+#endif
+
+        setAsyncError(sData, sData->state, 0, !sData->sse && sData->return_type == function_return_type_complete, false);
+
+        if (sData->to_remove)
+        {
+            removeSlot(slot);
+            return true;
+        }
+
+        return false;
     }
 
 public:
-    std::vector<uint32_t> rVec; // AsyncResult vector
     AsyncClientClass(Client &client, network_config_data &net) : client(&client)
     {
+        conn[0].client = &client;
         this->net.copy(net);
-        this->addr = reinterpret_cast<uint32_t>(this);
+        reg_handle = Registry::shared().add(this);
         client_type = async_request_handler_t::tcp_client_type_sync;
     }
 
@@ -1829,101 +4642,825 @@ public:
     AsyncClientClass(AsyncTCPConfig &tcpClientConfig, network_config_data &net) : async_tcp_config(&tcpClientConfig)
     {
         this->net.copy(net);
-        this->addr = reinterpret_cast<uint32_t>(this);
+        reg_handle = Registry::shared().add(this);
         client_type = async_request_handler_t::tcp_client_type_async;
     }
 #endif
 
     ~AsyncClientClass()
     {
-        stop(nullptr);
+        for (uint8_t i = conn_count; i > 0; i--)
+        {
+            switchConn(i - 1);
+            stop(nullptr);
+        }
 
         for (size_t i = 0; i < sVec.size(); i++)
         {
             reset(getData(i), true);
             async_data_item_t *sData = getData(i);
             // if (!sData->auth_used)
-            delete sData;
+            deleteSlotData(sData);
             sData = nullptr;
         }
+        slot_index.clear();
+
+        // The handle that is kept in the client lists of app and services is not resolved after.
+        Registry::shared().remove(reg_handle);
+    }
+
+    bool networkStatus() { return netStatus(nullptr); }
+
+    void stopAsync(bool all = false) { stopAsyncImpl(all); }
+    void stopAsync(const String &uid) { stopAsyncImpl(false, uid); }
+
+    /**
+     * Set the verification of file and blob transfers.
+     *
+     * The CRC32C (and MD5 when FIREBASE_TRANSFER_MD5 is defined) of uploaded and downloaded data are computed
+     * as they are sent or received, see AsyncResult::hashInfo. The base64 and resumed downloads are not hashed.
+     *
+     * @param verify Set true to compare the hashes with the crc32c and md5Hash of upload response metadata or the
+     * x-goog-hash header of download response, the mismatch is reported as FIREBASE_ERROR_HASH_MISMATCH error.
+     */
+    void setHashVerify(bool verify) { hash_verify = verify; }
+
+    /**
+     * Set the maximum idle time of the kept-alive connections.
+     *
+     * The connection that was idle (no task is using it) for this time is closed before the server drops it,
+     * the idle connection that was closed by server or received the unexpected data is also closed, then the
+     * next task connects to server instead of writing to the half-closed connection.
+     *
+     * @param sec The maximum idle time in seconds (default is FIREBASE_CONNECTION_MAX_IDLE_SEC), 0 for no limit.
+     */
+    void setMaxIdle(uint32_t sec) { max_idle_sec = sec; }
+
+    /**
+     * Set the keep-alive callback of the idle connections.
+     *
+     * The callback is called with the network client and host of each idle connection in every interval
+     * e.g. to send the TCP keep-alive or the application probe that keeps the connection warm.
+     *
+     * @param sec The interval in seconds, 0 to disable.
+     * @param cb The AsyncKeepAliveCallback function.
+     */
+    void setKeepAlive(uint32_t sec, AsyncKeepAliveCallback cb)
+    {
+        keep_alive_sec = sec;
+        keep_alive_cb = cb;
+    }
+
+    /**
+     * Open the connection to the host before the request is sent.
+     *
+     * The connect task resolves the host, connects to server and completes the TLS handshake in loop,
+     * then the connection is kept for the next request to this host that is sent without connecting
+     * e.g. when the request will be sent soon after the sensor interrupt. The connection error is
+     * returned by lastError.
+     *
+     * @param host The host name e.g. firestore.googleapis.com.
+     * @param port The port.
+     * @return bool true when the connect task was added to the queue.
+     */
+    bool preconnect(const String &host, uint16_t port = 443)
+    {
+        slot_options_t options;
+        options.async = true;
+        options.preconnect = true;
+        async_data_item_t *sData = host.length() ? createSlot(options) : nullptr;
+        if (!sData)
+            return false;
+        sData->async = true;
+        sData->preconnect = true;
+        sData->request.val[req_hndlr_ns::url] = host;
+        sData->request.port = port;
+        return true;
+    }
+
+    // Add the network client to connection pool, the sync network client is required.
+    bool addClient(Client &client)
+    {
+        if (client_type != async_request_handler_t::tcp_client_type_sync || conn_count >= FIREBASE_ASYNC_CONNECTION_POOL_LIMIT || failover_index > 0)
+            return false;
+
+        conn[conn_count].client = &client;
+        conn_count++;
+        return true;
+    }
+
+    // Returns the numbers of network clients (connections) in connection pool.
+    uint8_t clientCount() const { return conn_count; }
+
+    // Returns the maximum numbers of concurrent SSE streams, one stream per connection in pool except the connection for the other tasks.
+    uint8_t maxStreams() const { return conn_count > 1 ? conn_count - 1 : 1; }
+
+    /**
+     * Add the network that is used when the higher priority networks are down.
+     *
+     * The networks are in the order that they were added after the network of constructor. The in-flight and
+     * queued requests are sent again on the network that is failed over to, the uploads, downloads and OTA
+     * updates that are in progress are failed. The connection pool is used on the network of constructor only.
+     *
+     * ### Example
+     * ```cpp
+     * aClient.addFailover(gsm_client, getNetwork(gsm_network));
+     * ```
+     *
+     * @param client The sync network client of the network e.g. the SSL client over GSM modem client.
+     * @param net The network config data of the network.
+     * @return boolean The status of the setting, false when FIREBASE_NETWORK_FAILOVER_LIMIT was reached.
+     */
+    bool addFailover(Client &client, network_config_data &net)
+    {
+        if (client_type != async_request_handler_t::tcp_client_type_sync || failover_count >= FIREBASE_NETWORK_FAILOVER_LIMIT)
+            return false;
+
+        if (failover_count == 0)
+            failover_count = 1;
+
+        failover_conn[failover_count].client = &client;
+        failover_net[failover_count].copy(net);
+        failover_count++;
+        return true;
+    }
+
+    // Returns the index of network that is used, 0 is the network of constructor.
+    uint8_t networkIndex() const { return failover_index; }
+
+    void stop(async_data_item_t *sData)
+    {
+        if (sData && sData->conn_index > -1)
+            switchConn(sData->conn_index);
+
+        if (sData)
+            sData->aResult.setDebug(FPSTR("Terminating the server connection..."));
+        if (client_type == async_request_handler_t::tcp_client_type_sync)
+        {
+            if (client)
+                client->stop();
+            conn[conn_index].handshake_pending = false;
+            conn[conn_index].corked = false;
+            conn[conn_index].idle_ms = 0;
+        }
+        else
+        {
+#if defined(ENABLE_ASYNC_TCP_CLIENT)
+            if (async_tcp_config && async_tcp_config->tcpStop)
+                async_tcp_config->tcpStop();
+            if (async_tcp_config)
+                async_tcp_config->rxClear();
+#endif
+        }
+
+        clear(host);
+        port = 0;
+        keep_alive = false;
+    }
+
+    FirebaseError lastError() const { return lastErr; }
+
+    String etag() const { return resETag; }
+
+    void setETag(const String &etag) { reqEtag = etag; }
+
+    /**
+     * Set the response cache for GET requests.
+     *
+     * The ETag and payload of the response are kept (keyed by the request URL) and the next GET to the same
+     * URL is sent with If-None-Match header. The cached payload is returned when the server responds that
+     * the data was not modified (304). The least recently used responses are removed when the cache is full.
+     *
+     * The stream, download, OTA and the request that sets the ETag or the payload sink are not cached.
+     *
+     * @param size The maximum bytes of cached payloads, the cache is disabled when it is zero.
+     */
+    void setResponseCache(size_t size = FIREBASE_RESPONSE_CACHE_SIZE) { res_cache.setLimit(size); }
+
+#if defined(ENABLE_FS)
+    /**
+     * Set the response cache for GET requests that keeps the payloads in files.
+     *
+     * ### Example
+     * ```cpp
+     * FileConfig cache_file("/etag_cache", fileCallback);
+     * aClient.setResponseCache(getFile(cache_file), 16384);
+     * ```
+     * @param file The file config data, its file name is used as the index file and the prefix of payload files.
+     * @param size The maximum bytes of cached payloads.
+     */
+    void setResponseCache(file_config_data file, size_t size = FIREBASE_RESPONSE_CACHE_SIZE)
+    {
+        res_cache.setLimit(size);
+        res_cache.setFile(file);
+    }
+#endif
+
+    // Remove all cached responses.
+    void clearResponseCache() { res_cache.clear(); }
+
+    /**
+     * Set the TLS session cache of the SSL client.
+     *
+     * The session of each host is assigned to the SSL client before connecting, the abbreviated handshake
+     * is performed when the server resumes the session. The SSL client should provide the setSession function
+     * e.g. ESP_SSLClient and WiFiClientSecure of ESP8266. The sessions of FIREBASE_TLS_SESSION_CACHE_SIZE hosts are kept.
+     *
+     * @param sslClient The SSL client that was assigned to this async client, added to connection pool or failover networks.
+     * @return boolean The status of cache allocation.
+     */
+    template <typename T>
+    bool setSessionCache(T &sslClient) { return beginSessionCache(sslClient, &T::setSession); }
+
+    /**
+     * Set the TLS buffer sizes of the SSL client for the maximum fragment length of each host.
+     *
+     * The maximum fragment length negotiation (FIREBASE_TLS_MAX_FRAGMENT_LENGTH) of the host is probed once before
+     * the first connection, the result is kept with the TLS session of host. The receive and transmit buffers are
+     * sized for the negotiated fragment length or the receive buffer is 16 KB (transmit buffer is 512 bytes) when
+     * it was not supported. The SSL client should provide the probeMaxFragmentLength and setBufferSizes functions
+     * e.g. ESP_SSLClient and WiFiClientSecure of ESP8266.
+     *
+     * @param sslClient The SSL client that was assigned to this async client, added to connection pool or failover networks.
+     * @return boolean The status of the setting.
+     */
+    template <typename T>
+    bool setBufferAutoSize(T &sslClient)
+    {
+        return session_cache.addSizer(&sslClient, [](Client *client, const char *host, uint16_t port, uint16_t len) -> uint16_t
+                                      {
+            T *c = static_cast<T *>(client);
+            if (!len)
+                len = c->probeMaxFragmentLength(host, port, FIREBASE_TLS_MAX_FRAGMENT_LENGTH) ? FIREBASE_TLS_MAX_FRAGMENT_LENGTH : 16384;
+            c->setBufferSizes(len, len < 16384 ? len : 512);
+            return len; });
+    }
+
+    // Returns the size of data for exporting the TLS sessions.
+    size_t sessionCacheSize() const { return session_cache.exportSize(); }
+
+    /**
+     * Export the TLS sessions e.g. to RTC memory before deep sleep.
+     *
+     * @param buf The buffer to copy the sessions to, its size should not be less than sessionCacheSize().
+     * @param len The size of buffer.
+     * @return size_t The exported size or zero when failed.
+     */
+    size_t exportSessions(uint8_t *buf, size_t len) const { return session_cache.exportTo(buf, len); }
+
+    /**
+     * Import the TLS sessions that were exported.
+     *
+     * @param buf The exported data.
+     * @param len The size of data.
+     * @return boolean The status of import, the data of different session size are ignored.
+     */
+    bool importSessions(const uint8_t *buf, size_t len) { return session_cache.importFrom(buf, len); }
+
+    // Remove all cached TLS sessions.
+    void clearSessionCache() { session_cache.reset(); }
+
+    /**
+     * Set the host address cache of the SSL client.
+     *
+     * The address of host is resolved by resolver once per TTL and the SSL client connects to it without the
+     * host name lookup, the host name is still used for SNI and certificate validation. The address is resolved
+     * again after the connection to it was failed. The SSL client should provide the setHostIP function e.g. ESP_SSLClient.
+     * The addresses of FIREBASE_DNS_CACHE_SIZE hosts are kept.
+     *
+     * @param sslClient The SSL client that was assigned to this async client, added to connection pool or failover networks.
+     * @param resolver The DNSResolveCallback that resolves the host name e.g. with WiFi.hostByName, its ttl_sec
+     * is FIREBASE_DNS_CACHE_TTL_SEC and can be set to the TTL of record.
+     * @return boolean The status of the setting.
+     */
+    template <typename T>
+    bool setDNSCache(T &sslClient, DNSResolveCallback resolver)
+    {
+        dns_cache.setResolver(resolver);
+        return dns_cache.addClient(&sslClient, [](Client *client, const IPAddress &ip)
+                                   { static_cast<T *>(client)->setHostIP(ip); });
+    }
+
+    // Remove all cached host addresses.
+    void clearDNSCache() { dns_cache.clear(); }
+
+    /**
+     * Set the non-blocking TLS handshake of the SSL client.
+     *
+     * The handshake is started and advanced with the data that are available in every loop instead of
+     * waiting for it to complete. The SSL client should provide the connectStart and connectPoll functions
+     * e.g. ESP_SSLClient. The TCP connection is still established by the network client before the handshake.
+     *
+     * @param sslClient The SSL client that was assigned to this async client, added to connection pool or failover networks.
+     * @return boolean The status of the setting, false when the client was not found.
+     */
+    template <typename T>
+    bool setNonBlockingHandshake(T &sslClient)
+    {
+        async_conn_t *c = findConn(&sslClient);
+        if (!c)
+            return false;
+        c->handshake = [](Client *client, const char *host, uint16_t port, bool start) -> int
+        { return start ? static_cast<T *>(client)->connectStart(host, port) : static_cast<T *>(client)->connectPoll(); };
+        return true;
+    }
+
+    /**
+     * Set the write coalescing of the SSL client.
+     *
+     * The header and payload of request are held in the record buffer of SSL client while they are written
+     * and sent in the minimum numbers of full records when the request was written completely. The SSL client
+     * should provide the cork and uncork functions e.g. ESP_SSLClient.
+     *
+     * @param sslClient The SSL client that was assigned to this async client, added to connection pool or failover networks.
+     * @return boolean The status of the setting, false when the client was not found.
+     */
+    template <typename T>
+    bool setWriteCoalescing(T &sslClient)
+    {
+        async_conn_t *c = findConn(&sslClient);
+        if (!c)
+            return false;
+        c->cork = [](Client *client, bool cork)
+        {
+            if (cork)
+                static_cast<T *>(client)->cork();
+            else
+                static_cast<T *>(client)->uncork();
+        };
+        return true;
+    }
+
+    /**
+     * Set the zero-copy read of the SSL client.
+     *
+     * The response headers, chunk framing and payload are parsed from the decrypted data in the buffer of SSL client
+     * instead of copying them to the receive buffer, only the data that were used are consumed. The SSL client should
+     * provide the peekAvailable, peekBuffer and peekConsume functions e.g. ESP_SSLClient and WiFiClientSecure of ESP8266.
+     *
+     * @param sslClient The SSL client that was assigned to this async client, added to connection pool or failover networks.
+     * @return boolean The status of the setting, false when the client was not found.
+     */
+    template <typename T>
+    bool setZeroCopyRead(T &sslClient)
+    {
+        async_conn_t *pc = findConn(&sslClient);
+        if (!pc)
+            return false;
+        pc->peek = [](Client *client, size_t &len, bool consume) -> const uint8_t *
+        {
+            T *c = static_cast<T *>(client);
+            if (consume)
+            {
+                c->peekConsume(len);
+                return nullptr;
+            }
+            len = c->peekAvailable();
+            return reinterpret_cast<const uint8_t *>(c->peekBuffer());
+        };
+        return true;
+    }
+
+    /**
+     * Set the option to skip the initial put event of stream after reconnection when it was not changed.
+     *
+     * The initial put is unchanged when its data are the same as the last initial put and no put or patch
+     * event was received since, the stream keeps the hash of the last initial put only.
+     *
+     * @param enable The option to skip the unchanged initial put.
+     */
+    void setSkipUnchangedSnapshot(bool enable) { skip_snapshot = enable; }
+
+    /**
+     * Set the option to coalesce the identical async reads.
+     *
+     * The GET request that has the same method, URL, query and headers as the pending or in-flight GET request
+     * is not sent, its result and callback are attached to that request and receive the same response.
+     * The SSE, download, OTA and the requests with payload sink are not coalesced.
+     *
+     * @param enable The option to coalesce the identical reads.
+     */
+    void setCoalesceReads(bool enable) { coalesce_reads = enable; }
+
+    /**
+     * Set the option to route the tasks of all services that share this async client by host.
+     *
+     * The new task is queued after the last task to the same host that is waiting or in progress, then
+     * the tasks to the connected host are sent on the kept-alive connection before the tasks to the other
+     * hosts e.g. the Firestore tasks of Documents, Databases and CollectionGroups are sent together before
+     * the Storage task. The task with higher priority, the started and SSE tasks are not passed and each
+     * waiting task is passed up to FIREBASE_HOST_ROUTING_BYPASS times.
+     *
+     * @param enable The option to route the tasks by host.
+     */
+    void setHostRouting(bool enable) { host_routing = enable; }
+
+    // Set the priority of the next task that added to the queue.
+    void setPriority(slot_priority priority) { reqPriority = priority; }
+
+    /**
+     * Set the deadline of the next task that added to the queue (except for SSE task).
+     *
+     * @param ms The time in ms from now that covers the waiting in queue, connecting, sending and receiving.
+     * The task that was not completed before its deadline is failed with FIREBASE_ERROR_REQUEST_DEADLINE error
+     * and removed from the queue. The sync timeouts are still applied.
+     */
+    void setDeadline(uint32_t ms) { reqDeadline = ms; }
+
+    /**
+     * Get the numbers of tasks in queue (except for the authentication task).
+     *
+     * @return size_t The queue depth, the task is not added when it reached FIREBASE_ASYNC_QUEUE_LIMIT.
+     */
+    size_t queueDepth()
+    {
+        AsyncLockGuard guard(slot_lock);
+        size_t depth = 0;
+        for (size_t i = 0; i < sVec.size(); i++)
+        {
+            if (getData(i) && !getData(i)->auth_used)
+                depth++;
+        }
+        return depth;
+    }
+
+    /**
+     * Get the size of request headers and payloads in queue that were not sent.
+     *
+     * @return size_t The pending bytes.
+     */
+    size_t pendingBytes()
+    {
+        AsyncLockGuard guard(slot_lock);
+        size_t bytes = 0;
+        for (size_t i = 0; i < sVec.size(); i++)
+        {
+            if (getData(i) && !getData(i)->auth_used)
+                bytes += unsentBytes(getData(i));
+        }
+        return bytes;
+    }
+
+    /**
+     * Set the queue watermarks callback.
+     *
+     * @param high The queue depth that the callback is called with high = true e.g. FIREBASE_ASYNC_QUEUE_LIMIT - 2, 0 to remove the callback.
+     * @param low The queue depth that the callback is called with high = false after the high watermark was reached.
+     * @param cb The AsyncQueueCallback, it is called from the async client loop or when the task was added.
+     */
+    void setQueueWatermark(size_t high, size_t low, AsyncQueueCallback cb)
+    {
+        queue_high = high;
+        queue_low = low < high ? low : (high > 0 ? high - 1 : 0);
+        queue_full = false;
+        queue_cb = high > 0 ? cb : NULL;
+    }
+
+    /**
+     * Hold the tasks that were not urgent and send them back-to-back when the batch was flushed (radio batching).
+     * The batch is flushed when the oldest held task waited for intervalMs, the numbers of held tasks reached threshold,
+     * the task of higher priority was added or flushBatch was called. The streams and authentication tasks are not held.
+     *
+     * @param priority The priority that its tasks and the tasks of lower priority are held e.g. slot_priority_interactive.
+     * @param intervalMs The maximum time in ms that the task is held, 0 for disabling.
+     * @param threshold The numbers of held tasks that flush the batch, 0 for no threshold.
+     * @param cb The NetworkSleepCallback that is called with sleep = false before the batch was sent and with sleep = true
+     * when all tasks except the streams were finished. The sleep callback of network config is used when it is NULL.
+     */
+    void setRadioBatch(slot_priority priority, uint32_t intervalMs, size_t threshold = 0, NetworkSleepCallback cb = NULL)
+    {
+        AsyncLockGuard guard(slot_lock);
+        batch_priority = priority;
+        batch_interval_ms = intervalMs;
+        batch_threshold = threshold;
+        batch_sleep_cb = cb;
+        batch_flushing = false;
+    }
+
+    // Send the held tasks in the next loop.
+    void flushBatch() { batch_flush = true; }
+
+    // Returns true when the batch is being sent, the radio should be awake.
+    bool batchFlushing() const { return batch_flushing; }
+
+    /**
+     * Set the cancellation token of the next task that added to the queue.
+     *
+     * @param token The AsyncCancelToken that should be valid until the task was finished.
+     * When token.cancel() was called, the task is aborted in the next loop with FIREBASE_ERROR_OPERATION_CANCELLED error,
+     * its file, buffers and decoders are released immediately. The connection is kept alive and the remaining payload
+     * is discarded when it is not larger than FIREBASE_CANCEL_DRAIN_SIZE, otherwise the connection is closed.
+     */
+    void setCancelToken(AsyncCancelToken &token) { reqToken = &token; }
+
+    /**
+     * Set the retry policy of the failed async requests.
+     *
+     * @param policy The RetryPolicy that includes the maximum retries of each request (attempts), the classes of errors
+     * to retry (retry_error_class flags), the backoff delay range, the retry budget per minute and the optional AsyncRetryCallback.
+     *
+     * The request is sent again with the same header and payload after the jittered exponential backoff delay
+     * or the time from Retry-After header. The SSE, upload, download, OTA and the requests that use the payload writer or sink are not retried.
+     */
+    void setRetryPolicy(const RetryPolicy &policy) { retry_policy = policy; }
+
+    /**
+     * Set the time budget of each process call (loop) of async tasks.
+     *
+     * @param us The time in µs, 0 for unlimited (default FIREBASE_PROCESS_BUDGET_US).
+     * The budget is checked between the sending of data blocks, the reading of payload and chunks
+     * and the processing of connections in pool, the task continues in the next call when it was spent.
+     * The single blocking operation e.g. TCP connection and TLS handshake is not divided.
+     */
+    void setProcessBudget(uint32_t us) { budget_us = us; }
+
+    /**
+     * Set the request rate limit of host.
+     *
+     * @param host The host name e.g. fcm.googleapis.com.
+     * @param perMinute The requests per minute, 0 to remove the limit.
+     * @param burst The requests that can be sent at once after idle.
+     * The queued requests to host wait for the token before sending. When the host responds with HTTP 429 error,
+     * the rate is lowered and the requests are paused for the Retry-After time, then the rate is raised again up to perMinute
+     * in each minute without the error. The host that is not set is limited from its first HTTP 429 error (see setRateLearning).
+     */
+    void setRateLimit(const String &host, uint16_t perMinute, uint16_t burst = 1) { rate_limiter.set(host.c_str(), perMinute, burst); }
+
+    /**
+     * Enable the rate limit of the host that was not set when it responds with HTTP 429 error.
+     *
+     * @param enable The limit starts at FIREBASE_RATE_LIMIT_LEARN_RATE requests per minute (default true).
+     */
+    void setRateLearning(bool enable) { rate_limiter.setLearning(enable); }
+
+    /**
+     * Get the current request rate limit of host.
+     *
+     * @param host The host name.
+     * @return The requests per minute, 0 when the host is not limited.
+     */
+    uint16_t rateLimit(const String &host) { return rate_limiter.rate(host.c_str()); }
+
+    /**
+     * Set the transfer chunk size of the next tasks.
+     *
+     * Each payload write, response read, upload slice and base64 encoded upload block is not larger than the chunk size,
+     * the chunk buffer is allocated per write (or read). The size is limited to FIREBASE_CHUNK_SIZE_MIN and FIREBASE_CHUNK_SIZE_MAX.
+     *
+     * When the size is 0, the chunk size is scaled from the TLS fragment length of the last connection (see setBufferAutoSize)
+     * and 1/8 of free heap (ESP32 and ESP8266), up to FIREBASE_CHUNK_SIZE_MAX.
+     *
+     * @param size The chunk size in bytes, 0 for auto size. The default is FIREBASE_CHUNK_SIZE.
+     */
+    void setChunkSize(uint16_t size) { chunk_size = size == 0 ? 0 : (size < FIREBASE_CHUNK_SIZE_MIN ? FIREBASE_CHUNK_SIZE_MIN : (size > FIREBASE_CHUNK_SIZE_MAX ? FIREBASE_CHUNK_SIZE_MAX : size)); }
+
+    // Returns the chunk size of the next tasks.
+    uint16_t chunkSize() const
+    {
+        if (chunk_size)
+            return chunk_size;
+
+        uint32_t size = tls_frag_len ? tls_frag_len : FIREBASE_CHUNK_SIZE_MAX;
+#if defined(ESP32) || defined(ESP8266)
+        uint32_t heap = ESP.getFreeHeap() / 8;
+        if (heap < size)
+            size = heap;
+#endif
+        // The multiple of 256 bytes.
+        size = size / 256 * 256;
+        size = size < FIREBASE_CHUNK_SIZE_MIN ? FIREBASE_CHUNK_SIZE_MIN : (size > FIREBASE_CHUNK_SIZE_MAX ? FIREBASE_CHUNK_SIZE_MAX : size);
+        return link_adaptive ? link.chunkSize(size, FIREBASE_CHUNK_SIZE_MIN) : size;
+    }
+
+    /**
+     * Adapt the transfer to the estimate of network link.
+     *
+     * @param enable When it is true, the auto chunk size (see setChunkSize) is limited to the bytes in flight of the link
+     * and halved on the lossy link, the read timeout of async tasks is scaled to the round-trip time (FIREBASE_LINK_READ_TIMEOUT_MIN_SEC
+     * to FIREBASE_LINK_READ_TIMEOUT_MAX_SEC) and the concurrent requests in connection pool, Firestore pipelined writes and FCM
+     * fan-out are reduced when the requests were failed from the connection. The default is false.
+     */
+    void setLinkAdaptation(bool enable) { link_adaptive = enable; }
+
+    /**
+     * Get the estimate of network link.
+     *
+     * @return The smoothed round-trip time, its variation, the goodput in bytes per second and loss percentage of the completed requests.
+     */
+    const link_estimate_t &linkEstimate() const { return link.estimate(); }
 
-        addRemoveClientVec(cvec_addr, false);
-    }
+    // Returns the numbers of concurrent requests up to max that the link adaptation allows.
+    uint8_t linkWindow(uint8_t max) const { return link_adaptive ? link.window(max) : max; }
 
-    bool networkStatus() { return netStatus(nullptr); }
+#if defined(ENABLE_GZIP)
+    /**
+     * Set the option to accept the gzip compressed response (Accept-Encoding: gzip) of the next requests.
+     *
+     * The response payload is inflated while it is read, the SSE streams and downloads are not compressed.
+     *
+     * @param enable The option to accept the gzip compressed response.
+     */
+    void setGzip(bool enable) { accept_gzip = enable; }
 
-    void stopAsync(bool all = false) { stopAsyncImpl(all); }
-    void stopAsync(const String &uid) { stopAsyncImpl(false, uid); }
+    /**
+     * Set the option to compress the request payload of the next requests (Content-Encoding: gzip).
+     *
+     * The payload e.g. of Realtime Database set and update and Firestore commit and batch write is compressed
+     * while it is sent, the compressed payload is not kept in memory and its size (Content-Length) is computed
+     * before the header is sent. The uploads, the payload writer and the payload that does not become smaller are not compressed.
+     *
+     * @param enable The option to compress the request payload.
+     * @param minSize The minimum payload size in bytes to compress.
+     */
+    void setRequestGzip(bool enable, size_t minSize = FIREBASE_DEFLATE_MIN_SIZE) { gzip_req_min = enable ? (minSize ? minSize : 1) : 0; }
+#endif
 
-    void stop(async_data_item_t *sData)
+#if defined(ENABLE_FS)
+    /**
+     * Set the file spooling of the large request and response payloads.
+     *
+     * The request payload that is larger than threshold is written to the spool file and freed when the task
+     * was added, and it is sent from the file. The successful response payload with Content-Length that is larger
+     * than threshold is written to the spool file instead of result payload, the file name is available from
+     * AsyncResult::spoolFile. The response spool files (FIREBASE_SPOOL_RESPONSE_FILES) are used in turn.
+     *
+     * @param cb The FileConfigCallback that opens the spool file of filename and mode e.g. open, write and remove.
+     * @param name The spool file name prefix e.g. "/spool", the task id and ".req" or the file index and ".res" are appended.
+     * @param threshold The payload size in bytes that is spooled, 0 to disable.
+     */
+    void setSpool(FileConfigCallback cb, const String &name, size_t threshold)
     {
-        if (sData)
-            sData->aResult.setDebug(FPSTR("Terminating the server connection..."));
-        if (client_type == async_request_handler_t::tcp_client_type_sync)
-        {
-            if (client)
-                client->stop();
-        }
-        else
-        {
-#if defined(ENABLE_ASYNC_TCP_CLIENT)
-            if (async_tcp_config && async_tcp_config->tcpStop)
-                async_tcp_config->tcpStop();
+        spool_cb = cb;
+        spool_name = name;
+        spool_threshold = cb ? threshold : 0;
+    }
 #endif
-        }
 
-        clear(host);
-        port = 0;
+    // Set the sink that receives the response payload of the next task as it arrives, the result payload will be empty.
+    void setPayloadSink(Print &sink) { reqSink = &sink; }
+
+    /**
+     * Send the next task as the header-only request (probe) e.g. for checking that the object exists or was changed.
+     *
+     * @param head When it is true, the GET request is sent as HEAD request that has no response payload, use false for
+     * the service that does not support HEAD request.
+     * The status code and size of response are kept in AsyncResult::probeInfo() and the ETag in AsyncResult::etag(), the
+     * response payload is not stored. The payload of GET response up to FIREBASE_CANCEL_DRAIN_SIZE bytes is read and discarded
+     * to keep the connection alive, the connection is closed when the payload is larger or chunk encoded.
+     */
+    void setHeaderOnly(bool head = true)
+    {
+        reqProbe = true;
+        reqProbeHead = head;
     }
 
-    FirebaseError lastError() const { return lastErr; }
+    // Set the comma separated path filters of the next stream, e.g. "/sensors/*/temp,/config", the path can be the parent or child
+    // of the event data path and the * matches any key. The event of the other paths is discarded before it was stored in the event buffer.
+    void setStreamFilter(const String &paths) { reqFilter = paths; }
 
-    String etag() const { return resETag; }
+    // Set the maximum response payload size of the next task, the task is failed with FIREBASE_ERROR_RESPONSE_TOO_LARGE
+    // and the remaining payload is discarded by closing the connection when it was exceeded. The downloads are not limited.
+    void setResponseLimit(size_t maxSize) { reqLimit = maxSize; }
 
-    void setETag(const String &etag) { reqEtag = etag; }
+    // Set the writer that generates the request payload of the next task while sending, the payload passed to the function is not used.
+    // The writer is called part by part for computing the Content-Length and then while sending, it continues from the next part for
+    // every chunk and the bytes of part that did not fit in the chunk are sent in the next chunk. It should write the same data every time.
+    void setPayloadWriter(AsyncPayloadWriterCallback writer) { reqWriter = writer; }
 
     void setSyncSendTimeout(uint32_t timeoutSec) { sync_send_timeout_sec = timeoutSec; }
 
     void setSyncReadTimeout(uint32_t timeoutSec) { sync_read_timeout_sec = timeoutSec; }
 
+    /**
+     * Set the callback that is called when the task was added to the queue.
+     *
+     * @param cb The AsyncWakeupCallback e.g. the function that gives the event group bit or task notification
+     * to the task that waits for nextDeadline. It can be called from the task that added the request.
+     */
+    void setWakeupCallback(AsyncWakeupCallback cb) { wakeup_cb = cb; }
+
+    /**
+     * Get the time in ms that the queue can wait before it is required to be processed (loop).
+     *
+     * @return uint32_t 0 when the task is connecting, sending or the data is available to read,
+     * the reconnect delay of the stream or FIREBASE_IDLE_POLL_MS when the tasks are waiting for the data
+     * and FIREBASE_IDLE_FOREVER when the queue is empty.
+     */
+    uint32_t nextDeadline()
+    {
+        AsyncLockGuard guard(slot_lock);
+        uint32_t deadline = FIREBASE_IDLE_FOREVER;
+        for (size_t slot = 0; slot < slotCount() && deadline > 0; slot++)
+        {
+            async_data_item_t *sData = getData(slot);
+            if (!sData)
+                continue;
+
+            uint32_t ms = 0;
+            if (sData->state == async_state_read_response)
+            {
+                Client *c = sData->conn_index > -1 ? conn[sData->conn_index].client : client;
+                bool avail = client_type == async_request_handler_t::tcp_client_type_sync && c && c->available() > 0;
+                ms = avail ? 0 : FIREBASE_IDLE_POLL_MS;
+            }
+#if defined(ENABLE_DATABASE)
+            else if (sData->sse && sData->state == async_state_undefined && sData->sse_delay_ms > 0 && millis() - sData->sse_retry_ms < sData->sse_delay_ms)
+                ms = sData->sse_delay_ms - (millis() - sData->sse_retry_ms);
+#endif
+            else if (sData->state == async_state_undefined && sData->retry_delay_ms > 0 && millis() - sData->retry_ms < sData->retry_delay_ms)
+                ms = sData->retry_delay_ms - (millis() - sData->retry_ms);
+            else if (batchHeld(sData))
+                ms = millis() - sData->deadline_start < batch_interval_ms ? batch_interval_ms - (millis() - sData->deadline_start) : 0;
+            if (sData->deadline_ms > 0)
+            {
+                uint32_t elapsed = millis() - sData->deadline_start;
+                uint32_t left = elapsed < sData->deadline_ms ? sData->deadline_ms - elapsed : 0;
+                if (left < ms)
+                    ms = left;
+            }
+            if (ms < deadline)
+                deadline = ms;
+        }
+        return deadline;
+    }
+
     async_data_item_t *createSlot(slot_options_t &options)
     {
+        AsyncLockGuard guard(slot_lock);
+        bool req = !options.auth_used && !options.preconnect;
+        if (req)
+        {
+            if (options.priority == slot_priority_interactive)
+                options.priority = options.ota ? slot_priority_bulk : reqPriority;
+            reqPriority = slot_priority_interactive;
+            if (options.deadline_ms == 0 && !options.sse)
+                options.deadline_ms = reqDeadline;
+            reqDeadline = 0;
+        }
+
         int slot_index = sMan(options);
-        // Only one SSE mode is allowed
+        // The SSE streams or queue limit was reached.
         if (slot_index == -2)
+        {
+            FirebaseMetrics::shared().add(metrics_queue_full);
             return nullptr;
-        async_data_item_t *sData = addSlot(slot_index);
+        }
+        async_data_item_t *sData = addSlot(slot_index, options.auth_used);
         sData->reset();
+        sData->priority = options.priority;
+        sData->deadline_ms = options.deadline_ms;
+        sData->deadline_start = millis();
+        sData->aResult.timing_data.begin();
+        sData->trace_id = ++trace_seq;
+        sData->chunk_size = chunkSize();
+        FIREBASE_TRACE(trace_event_create, sData->trace_id, sData->state, sData->return_type, 0);
+        if (req)
+        {
+            if (!options.sse && !options.ota)
+            {
+                sData->sink = reqSink;
+                sData->resp_limit = reqLimit;
+            }
+            if (options.sse)
+            {
+                sData->sse_filter = reqFilter;
+                clear(reqFilter);
+            }
+            sData->writer = reqWriter;
+            sData->cancel_token = reqToken;
+            sData->probe = reqProbe && !options.sse && !options.ota;
+            sData->probe_head = sData->probe && reqProbeHead;
+            reqSink = nullptr;
+            reqLimit = 0;
+            reqWriter = NULL;
+            reqProbe = false;
+            reqToken = nullptr;
+        }
+        if (wakeup_cb)
+            wakeup_cb();
+        if (!options.auth_used)
+            checkWatermark();
         return sData;
     }
 
-    void newRequest(async_data_item_t *sData, const String &url, const String &path, const String &extras, async_request_handler_t::http_request_method method, slot_options_t &options, const String &uid)
+    void newRequest(async_data_item_t *sData, const String &url, const StringRef &path, const String &extras, async_request_handler_t::http_request_method method, slot_options_t &options, const StringRef &uid)
     {
-        sData->async = options.async;
-        sData->request.val[req_hndlr_ns::url] = url;
-        sData->request.val[req_hndlr_ns::path] = path;
-        sData->request.method = method;
-        sData->sse = options.sse;
-        sData->request.val[req_hndlr_ns::etag] = reqEtag;
-
-        clear(reqEtag);
-        sData->aResult.val[ares_ns::res_uid] = uid;
+        if (sData->probe_head && method == async_request_handler_t::http_get)
+            method = async_request_handler_t::http_head;
+        initRequest(sData, url, path, method, options, uid);
         clear(sData->request.val[req_hndlr_ns::header]);
+        // The header is written in the buffer that was reserved once.
+        String reqHost = getHost(sData, true);
+        sData->request.val[req_hndlr_ns::header].reserve(sData->request.headerCapacity(path.length(), extras, reqHost.length()));
         sData->request.addRequestHeaderFirst(method);
-        if (path.length() == 0)
+        if (path.length() == 0 || path[0] != '/')
             sData->request.val[req_hndlr_ns::header] += '/';
-        else if (path.length() && path[0] != '/')
-            sData->request.val[req_hndlr_ns::header] += '/';
-        sData->request.val[req_hndlr_ns::header] += path;
+        path.appendTo(sData->request.val[req_hndlr_ns::header]);
         sData->request.val[req_hndlr_ns::header] += extras;
-        sData->request.addRequestHeaderLast();
-        sData->request.addHostHeader(getHost(sData, true).c_str());
-
-        sData->auth_used = options.auth_used;
+        sData->request.addRequestHeaderLast(reqHost.c_str());
 
         if (!options.auth_used)
         {
-            sData->request.app_token = options.app_token;
             if (options.app_token && !options.auth_param && (options.app_token->auth_type == auth_id_token || options.app_token->auth_type == auth_user_id_token || options.app_token->auth_type == auth_access_token || options.app_token->auth_type == auth_sa_access_token))
             {
                 sData->request.addAuthHeaderFirst(options.app_token->auth_type);
@@ -1931,9 +5468,7 @@ public:
                 sData->request.addNewLine();
             }
 
-            sData->request.val[req_hndlr_ns::header] += FPSTR("Accept-Encoding: identity;q=1,chunked;q=0.1,*;q=0");
-            sData->request.addNewLine();
-            sData->request.addConnectionHeader(true);
+            sData->request.addStaticHeaders();
             if (!options.sv && !options.no_etag && method != async_request_handler_t::http_patch && extras.indexOf("orderBy") == -1)
             {
                 sData->request.val[req_hndlr_ns::header] += FPSTR("X-Firebase-ETag: true");
@@ -1947,6 +5482,19 @@ public:
                 sData->request.addNewLine();
             }
 
+            // The cached response is validated by its ETag.
+            if (res_cache.isEnabled() && method == async_request_handler_t::http_get && !options.sse && !options.ota && !sData->sink && !sData->probe && sData->request.val[req_hndlr_ns::etag].length() == 0)
+            {
+                sData->cache_key = ResponseCache::hash(url + sData->request.val[req_hndlr_ns::path] + extras);
+                String etag = res_cache.etag(sData->cache_key);
+                if (etag.length())
+                {
+                    sData->request.val[req_hndlr_ns::header] += FPSTR("If-None-Match: ");
+                    sData->request.val[req_hndlr_ns::header] += etag;
+                    sData->request.addNewLine();
+                }
+            }
+
             if (options.sse)
             {
                 sData->request.val[req_hndlr_ns::header] += FPSTR("Accept: text/event-stream");
@@ -1954,190 +5502,327 @@ public:
             }
         }
 
-        if (method == async_request_handler_t::http_get || method == async_request_handler_t::http_delete)
+        if (method == async_request_handler_t::http_get || method == async_request_handler_t::http_delete || method == async_request_handler_t::http_head)
             sData->request.addNewLine();
+
+        if (host_routing)
+            routeSlot(sData);
     }
 
-    void setAuthTs(uint32_t ts) { auth_ts = ts; }
+    // Set the request data except the header.
+    void initRequest(async_data_item_t *sData, const String &url, const StringRef &path, async_request_handler_t::http_request_method method, slot_options_t &options, const StringRef &uid)
+    {
+        sData->async = options.async;
+        sData->request.val[req_hndlr_ns::url] = url;
+        path.assignTo(sData->request.val[req_hndlr_ns::path]);
+        sData->request.method = method;
+        sData->sse = options.sse;
+        sData->request.val[req_hndlr_ns::etag] = reqEtag;
+#if defined(ENABLE_GZIP)
+        sData->accept_gzip = accept_gzip && !options.sse && !options.ota && !options.auth_used;
+        sData->gzip_req = gzip_req_min > 0 && !options.sse && !options.ota && !options.auth_used;
+#endif
+
+        clear(reqEtag);
+        sData->aResult.setUID(uid);
+        if (uid.length() && sData->uid_hash == 0)
+        {
+            sData->uid_hash = SlotIndex::hash(sData->aResult.cval(ares_ns::res_uid).c_str());
+            slot_index.add(sData->uid_hash, sData->id, sData);
+        }
+
+        sData->auth_used = options.auth_used;
+        if (!options.auth_used)
+            sData->request.app_token = options.app_token;
+    }
+
+    // The request with the header that was built by the previous request of the same path, method and options,
+    // the auth token placeholder in header is replaced when it was sent.
+    void newPreparedRequest(async_data_item_t *sData, const String &url, const StringRef &path, const String &header, async_request_handler_t::http_request_method method, slot_options_t &options, const StringRef &uid)
+    {
+        initRequest(sData, url, path, method, options, uid);
+        // The header is copied to the buffer that has room for the payload headers.
+        sData->request.val[req_hndlr_ns::header].reserve(header.length() + 64);
+        sData->request.val[req_hndlr_ns::header] = header;
+        if (host_routing)
+            routeSlot(sData);
+    }
+
+    // The gzip options that change the encoding headers of request, the prepared header is rebuilt when they were changed.
+    uint8_t encodingOptions() const
+    {
+#if defined(ENABLE_GZIP)
+        return (accept_gzip ? 1 : 0) | (gzip_req_min > 0 ? 2 : 0);
+#else
+        return 0;
+#endif
+    }
+
+    // Returns true if the header of request does not change between the requests of the same path, method and
+    // options, the conditional (ETag) and cache validated requests are built as normal requests.
+    bool isPreparable(async_request_handler_t::http_request_method method, const slot_options_t &options) const
+    {
+        return reqEtag.length() == 0 && !reqProbe && !options.sse && !options.ota && !options.sv && !options.auth_used && !(res_cache.isEnabled() && method == async_request_handler_t::http_get);
+    }
 
-    void addRemoveClientVec(uint32_t cvec_addr, bool add)
+    // Move the new task after the last task to the same host that is waiting or in progress, the tasks in between
+    // that are passed should be waiting with the same priority.
+    void routeSlot(async_data_item_t *sData)
     {
-        this->cvec_addr = cvec_addr;
-        if (cvec_addr > 0)
+        AsyncLockGuard guard(slot_lock);
+        int index = slotIndex(sData);
+        if (index < 1 || sData->sse || sData->auth_used)
+            return;
+
+        String reqHost = getHost(sData, true);
+        int target = -1;
+        for (int i = index - 1; i >= 0; i--)
         {
-            std::vector<uint32_t> *cVec = reinterpret_cast<std::vector<uint32_t> *>(cvec_addr);
-            List vec;
-            if (cVec)
-                vec.addRemoveList(*cVec, this->addr, add);
+            async_data_item_t *d = getData(i);
+            if (!d || d->auth_used)
+                break;
+            if (!d->sse && strcmp(getHost(d, true).c_str(), reqHost.c_str()) == 0)
+            {
+                target = i + 1;
+                break;
+            }
+            if (d->sse || d->state != async_state_undefined || d->priority != sData->priority || d->bypassed >= FIREBASE_HOST_ROUTING_BYPASS)
+                break;
         }
+
+        if (target < 0 || target == index)
+            return;
+
+        for (int i = target; i < index; i++)
+            getData(i)->bypassed++;
+        sVec.erase(sVec.begin() + index);
+        sVec.insert(sVec.begin() + target, sData);
+    }
+
+    void setAuthTs(uint32_t ts) { auth_ts = ts; }
+
+    // The handle of this client in Registry.
+    list_handle_t handle() const { return reg_handle; }
+
+    // Add or remove this client in the client list (handles) of app or service.
+    void addRemoveClientVec(std::vector<list_handle_t> &cVec, bool add)
+    {
+        List vec;
+        vec.addRemoveList(cVec, reg_handle, add);
     }
 
     void setContentLength(async_data_item_t *sData, size_t len)
     {
         if (sData->request.method == async_request_handler_t::http_post || sData->request.method == async_request_handler_t::http_put || sData->request.method == async_request_handler_t::http_patch)
         {
+            if (sData->writer)
+            {
+                // The payload size is computed from the writer output, the payload buffer is not used.
+                AsyncPayloadWindow counter(nullptr, 0, nullptr);
+                for (size_t part = 0; sData->writer(counter, part); part++)
+                    ;
+                sData->resetWriter();
+                len = counter.totalLength();
+                sData->writer_len = len;
+                clear(sData->request.val[req_hndlr_ns::payload]);
+            }
+#if defined(ENABLE_FS)
+            spoolRequest(sData, len);
+#endif
             sData->request.addContentLengthHeader(len);
             sData->request.addNewLine();
         }
     }
 
+    // Call the done callbacks of results whose tasks were removed, the callback (coroutine) may add the new tasks.
+    void notifyDone()
+    {
+        std::vector<list_handle_t> done;
+        {
+            AsyncLockGuard guard(slot_lock);
+            if (inProcess)
+                return;
+            done.swap(doneVec);
+        }
+
+        for (size_t i = 0; i < done.size(); i++)
+        {
+            AsyncResult *aResult = Registry::shared().get<AsyncResult>(done[i]);
+            if (!aResult || !aResult->done_cb)
+                continue;
+            void (*cb)(void *ctx) = aResult->done_cb;
+            aResult->done_cb = NULL;
+            cb(aResult->done_ctx);
+        }
+    }
+
     void process(bool async)
     {
+        // The async tasks of client that was added to ClientScheduler are processed by its worker tasks.
+        if (async && scheduled)
+            return;
+        processImpl(async);
+        notifyDone();
+    }
+
+    void processImpl(bool async)
+    {
+        AsyncLockGuard guard(slot_lock);
         if (processLocked())
             return;
 
-        if (slotCount())
-        {
-            size_t slot = 0;
-            async_data_item_t *sData = getData(slot);
+        budget_start = micros();
+        handleDeadline();
+        handleCancel();
 
-            if (!sData)
-            {
-                inProcess = false;
-                return;
-            }
+        if (coalesce_reads)
+            coalesceReads();
+
+        handleIdle();
+        handleBatch();
 
-            if (!netConnect(sData))
+        if (conn_count > 1)
+        {
+            // Progress all slots that bound to the connections in pool, the slots that were not processed
+            // because of time budget are processed first in the next call.
+            size_t n = slotCount(), slot = budget_slot < n ? budget_slot : 0;
+            budget_slot = 0;
+            for (size_t i = 0; i < n && slotCount(); i++)
             {
-                setAsyncError(sData, sData->state, FIREBASE_ERROR_TCP_DISCONNECTED, !sData->sse, false);
-                if (sData->async)
+                if (slot >= slotCount())
+                    slot = 0;
+                if (i > 0 && budgetSpent())
                 {
-                    returnResult(sData, false);
-                    reset(sData, true);
+                    budget_slot = slot;
+                    break;
                 }
-                inProcess = false;
-                return;
+                async_data_item_t *sData = getData(slot);
+                if (!(sData && (!sData->async || async) && bindConn(sData) && processSlot(slot, async)))
+                    slot++;
             }
+        }
+        else if (slotCount())
+            processSlot(0, async);
 
-            if (sData->async && !async)
-            {
-                inProcess = false;
-                return;
-            }
+        inProcess = false;
+    }
 
-            // We have to re-start sse when the authenticate changed
-            if (sData->sse && sData->auth_ts != auth_ts)
-            {
-                stop(sData);
-                sData->state = async_state_send_header;
-            }
+    // The task that was not sent is held while the batch was not flushed.
+    bool batchHeld(async_data_item_t *sData)
+    {
+        return batch_interval_ms > 0 && !batch_flushing && sData->state == async_state_undefined && !sData->sse && !sData->auth_used && sData->priority >= batch_priority;
+    }
 
-            bool sending = false;
-            if (sData->state == async_state_undefined || sData->state == async_state_send_header || sData->state == async_state_send_payload)
-            {
-                sData->response.clear();
-                sData->request.feedTimer(!sData->async && sync_send_timeout_sec > 0 ? sync_send_timeout_sec : -1);
-                sending = true;
-                sData->return_type = send(sData);
+    // Flush the batch when the oldest held task waited for batch_interval_ms, the held tasks reached batch_threshold or
+    // the task of higher priority was added, the radio can sleep when all tasks except the streams were finished.
+    void handleBatch()
+    {
+        if (batch_interval_ms == 0)
+            return;
 
-                while (sData->state == async_state_send_header || sData->state == async_state_send_payload)
-                {
-                    sData->return_type = send(sData);
-                    sData->response.feedTimer(!sData->async && sync_read_timeout_sec > 0 ? sync_read_timeout_sec : -1);
-                    handleSendTimeout(sData);
-                    if (sData->async || sData->return_type == function_return_type_failure)
-                        break;
-                }
-            }
+        size_t held = 0, pending = 0;
+        bool due = batch_flush;
+        for (size_t slot = 0; slot < slotCount(); slot++)
+        {
+            async_data_item_t *sData = getData(slot);
+            if (!sData || sData->sse || sData->auth_used)
+                continue;
+            pending++;
+            if (sData->priority < batch_priority || sData->state != async_state_undefined)
+                due = true;
+            else if (++held >= batch_threshold && batch_threshold > 0)
+                due = true;
+            else if (millis() - sData->deadline_start >= batch_interval_ms)
+                due = true;
+        }
 
-            if (sending)
-            {
-                handleSendTimeout(sData);
-                if (sData->async && sData->return_type == function_return_type_continue)
-                {
-                    inProcess = false;
-                    return;
-                }
-            }
+        NetworkSleepCallback cb = batch_sleep_cb ? batch_sleep_cb : net.sleep_cb;
+        if (!batch_flushing && pending > 0 && due)
+        {
+            batch_flushing = true;
+            if (cb)
+                cb(false);
+        }
+        else if (batch_flushing && pending == 0)
+        {
+            batch_flushing = false;
+            if (cb)
+                cb(true);
+        }
+        batch_flush = false;
+    }
 
-            sys_idle();
+    // Returns true when the connection at index is used by the task.
+    bool connInUse(uint8_t index)
+    {
+        if (conn_count > 1)
+            return conn[index].slot_data != nullptr;
+        async_data_item_t *sData = slotCount() ? getData(0) : nullptr;
+        return sData && sData->state != async_state_undefined;
+    }
 
-            if (sData->state == async_state_read_response)
-            {
-                // if (!sData->download && !sData->upload)
-                //    sData->request.clear();
+    // Close the kept-alive connections that were idle for max_idle_sec, that were closed by server or that received
+    // the unexpected data, and call the keep-alive callback of the other idle connections. It is checked once a second.
+    void handleIdle()
+    {
+        if (client_type != async_request_handler_t::tcp_client_type_sync || millis() - idle_check_ms < 1000)
+            return;
+        idle_check_ms = millis();
 
-                // it can be complete response from payload sending
-                if (sData->return_type == function_return_type_complete)
-                    sData->return_type = function_return_type_continue;
+        uint8_t current = conn_index;
+        for (uint8_t i = 0; i < conn_count; i++)
+        {
+            async_conn_t &c = conn[i];
+            if (c.idle_ms == 0 || !c.client || connInUse(i))
+                continue;
 
-                if (sData->async && !sData->response.tcpAvailable(client_type, client, async_tcp_config))
-                {
-#if defined(ENABLE_DATABASE)
-                    handleEventTimeout(sData);
-#endif
-                    handleReadTimeout(sData);
-                    inProcess = false;
-                    return;
-                }
-                else if (!sData->async) // wait for non async
-                {
-                    while (!sData->response.tcpAvailable(client_type, client, async_tcp_config) && netConnect(sData))
-                    {
-                        sys_idle();
-                        if (handleReadTimeout(sData))
-                            break;
-                    }
-                }
+            if (!c.client->connected() || c.client->available() > 0 || (max_idle_sec > 0 && millis() - c.idle_ms >= max_idle_sec * 1000))
+            {
+                switchConn(i);
+                stop(nullptr);
             }
-
-            // Read until status code > 0, header finished and payload read complete
-            if (sData->state == async_state_read_response)
+            else if (keep_alive_cb && keep_alive_sec > 0 && millis() - c.keep_alive_ms >= keep_alive_sec * 1000)
             {
-                sData->error.code = 0;
-                while (sData->return_type == function_return_type_continue && (sData->response.httpCode == 0 || sData->response.flags.header_remaining || sData->response.flags.payload_remaining))
-                {
-                    sData->response.feedTimer(!sData->async && sync_read_timeout_sec > 0 ? sync_read_timeout_sec : -1);
-                    sData->return_type = receive(sData);
-
-                    handleReadTimeout(sData);
-
-                    bool allRead = sData->response.httpCode > 0 && sData->response.httpCode != FIREBASE_ERROR_HTTP_CODE_OK && !sData->response.flags.header_remaining && !sData->response.flags.payload_remaining;
-                    if (allRead && sData->response.httpCode >= FIREBASE_ERROR_HTTP_CODE_BAD_REQUEST)
-                    {
-                        if (sData->sse)
-                        {
-                            sData->aResult.data_available = false;
-#if defined(ENABLE_DATABASE)
-                            sData->aResult.rtdbResult.clearSSE();
-#endif
-                        }
-                        sData->return_type = function_return_type_failure;
-                    }
-
-                    if (sData->async || allRead || sData->return_type == function_return_type_failure)
-                        break;
-                }
+                c.keep_alive_ms = millis();
+                keep_alive_cb(c.client, i == conn_index ? host.c_str() : c.host.c_str());
             }
-
-            handleProcessFailure(sData);
-
-#if defined(ENABLE_DATABASE)
-            handleEventTimeout(sData);
-#endif
-
-            setAsyncError(sData, sData->state, 0, !sData->sse && sData->return_type == function_return_type_complete, false);
-
-            if (sData->to_remove)
-                removeSlot(slot);
         }
-
-        inProcess = false;
+        switchConn(current);
     }
+
     void handleRemove()
     {
-        for (size_t slot = 0; slot < slotCount(); slot++)
         {
-            async_data_item_t *sData = getData(slot);
-            if (sData && sData->to_remove)
-                removeSlot(slot);
+            AsyncLockGuard guard(slot_lock);
+            for (size_t slot = 0; slot < slotCount(); slot++)
+            {
+                async_data_item_t *sData = getData(slot);
+                if (sData && sData->to_remove)
+                    removeSlot(slot);
+            }
         }
+        notifyDone();
     }
 
     size_t slotCount() { return sVec.size(); }
 
+    // The task of slot is waiting for the token of app.
+    bool slotAwaitingToken(uint8_t slot) { return getData(slot) && awaitingToken(getData(slot)); }
+
+    // Returns the index of slot data in queue or -1 when not found.
+    int slotIndex(async_data_item_t *sData)
+    {
+        for (size_t i = 0; i < sVec.size(); i++)
+        {
+            if (getData(i) == sData)
+                return i;
+        }
+        return -1;
+    }
+
     void removeSlot(uint8_t slot, bool sse = true)
     {
+        AsyncLockGuard guard(slot_lock);
         async_data_item_t *sData = getData(slot);
 
         if (!sData)
@@ -2147,17 +5832,50 @@ public:
             return;
 
 #if defined(ENABLE_DATABASE)
-        sData->aResult.rtdbResult.clearSSE();
+        sData->aResult.clearSSE();
 #endif
         closeFile(sData);
+#if defined(ENABLE_FS)
+        closeSpool(sData);
+        if (sData->spool_req)
+        {
+            spool_cb(sData->spool_file, spoolName(sData, false).c_str(), file_mode_remove);
+            sData->spool_req = false;
+        }
+#endif
         setLastError(sData);
+        // The payload was written to the sink or discarded (probe), the result has no payload.
+        if ((sData->sink || sData->probe) && !sData->aResult.error_available)
+            sData->aResult.data_available = true;
+        if (sData->download && sData->response.httpCode == FIREBASE_ERROR_HTTP_CODE_NOT_MODIFIED && !sData->aResult.error_available)
+            sData->aResult.data_available = true;
+        // The complete response e.g. the object resource is handled by its owner.
+        if (!sData->sse && sData->event_handler && !sData->aResult.error_available)
+            sData->event_handler(sData->event_ctx, sData->aResult);
+        if (sData->followers.size())
+            returnFollowers(sData);
+        sData->aResult.timing_data.mark(sData->aResult.timing_data.complete_us);
+        FIREBASE_TRACE(trace_event_remove, sData->trace_id, sData->state, sData->return_type, sData->response.payloadRead);
+        if (!sData->sse && !sData->preconnect)
+        {
+            const request_timings_t &t = sData->aResult.timing_data;
+            const String &slotHost = sData->conn_index > -1 && sData->conn_index != conn_index ? conn[sData->conn_index].host : host;
+            FirebaseMetrics::shared().addRequest(FirebaseMetrics::serviceOf(slotHost), sData->aResult.error_available, t.complete_us, t.first_byte_us);
+            addLinkSample(sData);
+        }
         // data available from sync and asyn request except for sse
-        returnResult(sData, true);
+        returnResult(sData, true, true);
+        if (getResult(sData) && sData->refResult->done_cb)
+            doneVec.push_back(sData->ref_result_handle);
         reset(sData, sData->auth_used);
+        unbindConn(sData);
+        if (sData->uid_hash)
+            slot_index.remove(sData->uid_hash, sData->id);
         if (!sData->auth_used)
-            delete sData;
+            deleteSlotData(sData);
         sData = nullptr;
         sVec.erase(sVec.begin() + slot);
+        checkWatermark();
     }
 };
 
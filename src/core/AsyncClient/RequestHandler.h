@@ -28,17 +28,21 @@
 #include "./Config.h"
 #include "./core/FileConfig.h"
 #include "./core/Timer.h"
+#include "./core/Metrics.h"
 #include "Client.h"
 #include "./core/AuthConfig.h"
+#include "./core/StringRef.h"
 
-#if defined(ENABLE_ASYNC_TCP_CLIENT)
-#include "./core/AsyncTCPConfig.h"
-#endif
+#include "./core/AsyncClient/Transport.h"
 
 #define FIREBASE_TCP_WRITE_TIMEOUT_SEC 30 // Do not change
 
 #define FIREBASE_AUTH_PLACEHOLDER (const char *)FPSTR("<auth_token>")
 
+// The constant header fragments of request that are appended at once.
+static const char firebase_request_line_last[] PROGMEM = " HTTP/1.1\r\nHost: ";
+static const char firebase_request_static_headers[] PROGMEM = "Accept-Encoding: identity;q=1,chunked;q=0.1,*;q=0\r\nConnection: keep-alive\r\n";
+
 #if !defined(FIREBASE_ASYNC_QUEUE_LIMIT)
 #if defined(ESP8266)
 #define FIREBASE_ASYNC_QUEUE_LIMIT 10
@@ -49,6 +53,40 @@
 #endif
 #endif
 
+// The static buffers mode uses the preallocated slots data.
+#if defined(FIREBASE_STATIC_BUFFERS) && !defined(FIREBASE_ASYNC_SLOT_POOL)
+#define FIREBASE_ASYNC_SLOT_POOL
+#endif
+
+// The capacity of request header and response payload buffers that reserved in static buffers mode.
+#if !defined(FIREBASE_STATIC_HEADER_SIZE)
+#define FIREBASE_STATIC_HEADER_SIZE 1024
+#endif
+
+#if !defined(FIREBASE_STATIC_PAYLOAD_SIZE)
+#define FIREBASE_STATIC_PAYLOAD_SIZE 2048
+#endif
+
+// The maximum size of request header and payload that are sent together in one write.
+#if !defined(FIREBASE_COALESCE_WRITE_SIZE)
+#define FIREBASE_COALESCE_WRITE_SIZE 1024
+#endif
+
+// The maximum numbers of network clients (connections) in async client's connection pool.
+#if !defined(FIREBASE_ASYNC_CONNECTION_POOL_LIMIT)
+#define FIREBASE_ASYNC_CONNECTION_POOL_LIMIT 4
+#endif
+
+// The maximum numbers of networks (including the network of constructor) that async client can fail over to.
+#if !defined(FIREBASE_NETWORK_FAILOVER_LIMIT)
+#define FIREBASE_NETWORK_FAILOVER_LIMIT 3
+#endif
+
+// The interval in seconds that the higher priority network is checked for failing back.
+#if !defined(FIREBASE_NETWORK_FAILBACK_SEC)
+#define FIREBASE_NETWORK_FAILBACK_SEC 10
+#endif
+
 typedef void (*NetworkStatus)(bool &status);
 typedef void (*NetworkReconnect)(void);
 
@@ -84,6 +122,7 @@ public:
         http_get,
         http_patch,
         http_delete,
+        http_head,
     };
 
     String val[req_hndlr_ns::max_type];
@@ -92,6 +131,7 @@ public:
     uint16_t port = 443;
     uint8_t *data = nullptr;
     file_config_data file_data;
+    download_resume_state_t *resume = nullptr;
     bool base64 = false;
     bool ota = false;
     uint32_t payloadLen = 0;
@@ -117,6 +157,7 @@ public:
             delete data;
         data = nullptr;
         file_data.clear();
+        resume = nullptr;
         base64 = false;
         ota = false;
         payloadLen = 0;
@@ -169,17 +210,12 @@ public:
         addNewLine();
     }
 
-    void addUAHeader()
-    {
-        val[req_hndlr_ns::header] += FPSTR("User-Agent: ESP");
-        addNewLine();
-    }
+    void addUAHeader() { val[req_hndlr_ns::header] += FPSTR("User-Agent: ESP\r\n"); }
 
-    void addConnectionHeader(bool keepAlive)
-    {
-        val[req_hndlr_ns::header] += keepAlive ? FPSTR("Connection: keep-alive") : FPSTR("Connection: close");
-        addNewLine();
-    }
+    void addConnectionHeader(bool keepAlive) { val[req_hndlr_ns::header] += keepAlive ? FPSTR("Connection: keep-alive\r\n") : FPSTR("Connection: close\r\n"); }
+
+    // The Accept-Encoding and Connection (keep-alive) headers of async client requests.
+    void addStaticHeaders() { val[req_hndlr_ns::header] += FPSTR(firebase_request_static_headers); }
 
     /* Append the string with first request line (HTTP method) */
     bool addRequestHeaderFirst(async_request_handler_t::http_request_method method)
@@ -188,33 +224,34 @@ public:
         switch (method)
         {
         case async_request_handler_t::http_get:
-            val[req_hndlr_ns::header] += FPSTR("GET");
+            val[req_hndlr_ns::header] += FPSTR("GET ");
             break;
         case async_request_handler_t::http_post:
-            val[req_hndlr_ns::header] += FPSTR("POST");
+            val[req_hndlr_ns::header] += FPSTR("POST ");
             post = true;
             break;
 
         case async_request_handler_t::http_patch:
-            val[req_hndlr_ns::header] += FPSTR("PATCH");
+            val[req_hndlr_ns::header] += FPSTR("PATCH ");
             post = true;
             break;
 
         case async_request_handler_t::http_delete:
-            val[req_hndlr_ns::header] += FPSTR("DELETE");
+            val[req_hndlr_ns::header] += FPSTR("DELETE ");
             break;
 
         case async_request_handler_t::http_put:
-            val[req_hndlr_ns::header] += FPSTR("PUT");
+            val[req_hndlr_ns::header] += FPSTR("PUT ");
+            break;
+
+        case async_request_handler_t::http_head:
+            val[req_hndlr_ns::header] += FPSTR("HEAD ");
             break;
 
         default:
             break;
         }
 
-        if (method == async_request_handler_t::http_get || method == async_request_handler_t::http_post || method == async_request_handler_t::http_patch || method == async_request_handler_t::http_delete || method == async_request_handler_t::http_put)
-            val[req_hndlr_ns::header] += FPSTR(" ");
-
         return post;
     }
 
@@ -224,6 +261,22 @@ public:
         val[req_hndlr_ns::header] += FPSTR(" HTTP/1.1\r\n");
     }
 
+    /* Append the string with last request line (HTTP version) and the Host header */
+    void addRequestHeaderLast(const char *host)
+    {
+        val[req_hndlr_ns::header] += FPSTR(firebase_request_line_last);
+        val[req_hndlr_ns::header] += host;
+        addNewLine();
+    }
+
+    // The capacity of request header with the request line and the constant headers, the optional headers are
+    // estimated.
+    size_t headerCapacity(size_t pathLen, const String &extras, size_t hostLen) const
+    {
+        return 8 + pathLen + extras.length() + strlen_P(firebase_request_line_last) + hostLen + 2 +
+               strlen_P(firebase_request_static_headers) + 128;
+    }
+
     /* Append the string with first part of Authorization header */
     void addAuthHeaderFirst(auth_token_type type)
     {
@@ -243,23 +296,9 @@ public:
 
     size_t tcpWrite(async_request_handler_t::tcp_client_type client_type, Client *client, void *atcp_config, uint8_t *data, size_t size)
     {
-        if (client_type == tcp_client_type_sync)
-            return client ? client->write(data, size) : 0;
-        else
-        {
-
-#if defined(ENABLE_ASYNC_TCP_CLIENT)
-
-            AsyncTCPConfig *async_tcp_config = reinterpret_cast<AsyncTCPConfig *>(atcp_config);
-            if (!async_tcp_config && !async_tcp_config->tcpSend)
-                return 0;
-
-            uint32_t sent = 0;
-            async_tcp_config->tcpSend(data, size, sent);
-            return sent;
-#endif
-        }
-        return 0;
+        size_t sent = tcp_transport_t::write(client_type == tcp_client_type_async, client, atcp_config, data, size);
+        FirebaseMetrics::shared().add(metrics_bytes_out, sent);
+        return sent;
     }
 };
 
@@ -27,9 +27,43 @@
 #include <Arduino.h>
 #include <Client.h>
 #include "RequestHandler.h"
+#include "./core/Scan.h"
+#include "./core/SSEParser.h"
 
 #define FIREBASE_TCP_READ_TIMEOUT_SEC 30 // Do not change
 
+// The size of receive buffer that response data was read from network client in blocks.
+#if !defined(FIREBASE_RX_BUFFER_SIZE)
+#define FIREBASE_RX_BUFFER_SIZE 256
+#endif
+
+// The maximum Content-Length of payload that its buffer is reserved before reading (0 for disabling).
+#if !defined(FIREBASE_PAYLOAD_RESERVE_LIMIT)
+#define FIREBASE_PAYLOAD_RESERVE_LIMIT 16384
+#endif
+
+// The size of event buffer that is allocated once when the SSE stream was opened.
+#if !defined(FIREBASE_SSE_BUFFER_SIZE)
+#define FIREBASE_SSE_BUFFER_SIZE 1024
+#endif
+
+// The SSE event line is read in this size until the data path was matched by the stream filter.
+#if !defined(FIREBASE_SSE_FILTER_READ_SIZE)
+#define FIREBASE_SSE_FILTER_READ_SIZE 64
+#endif
+
+// The range of stream reconnection delay in ms, the delay is doubled (with the random half) after each failure.
+#if !defined(FIREBASE_SSE_BACKOFF_MIN)
+#define FIREBASE_SSE_BACKOFF_MIN 1000
+#endif
+#if !defined(FIREBASE_SSE_BACKOFF_MAX)
+#define FIREBASE_SSE_BACKOFF_MAX 60000
+#endif
+
+// The function to get the received data of network client in its buffer without copy (consume is false),
+// or to consume the len bytes of data that were used (consume is true).
+typedef const uint8_t *(*TCPPeekCallback)(Client *client, size_t &len, bool consume);
+
 namespace res_hndlr_ns
 {
     enum data_item_type_t
@@ -38,17 +72,52 @@ namespace res_hndlr_ns
         payload,
         etag,
         location,
+        hash,
         max_type
     };
+
+    enum header_name_type
+    {
+        content_length,
+        connection,
+        transfer_encoding,
+        content_type,
+        etag_header,
+        location_header,
+        range,
+        goog_hash_header,
+        content_encoding,
+        retry_after_header,
+        header_name_max_type
+    };
 }
 
+struct async_response_header_name_t
+{
+    char text[18];
+};
+
+const struct async_response_header_name_t async_response_header_names[res_hndlr_ns::header_name_max_type] PROGMEM = {
+    "Content-Length",
+    "Connection",
+    "Transfer-Encoding",
+    "Content-Type",
+    "ETag",
+    "Location",
+    "Range",
+    "X-Goog-Hash",
+    "Content-Encoding",
+    "Retry-After"};
+
 struct async_response_handler_t
 {
 public:
     enum chunk_phase
     {
         READ_CHUNK_SIZE = 0,
-        READ_CHUNK_DATA = 1
+        READ_CHUNK_DATA = 1,
+        READ_CHUNK_DATA_END = 2,
+        READ_CHUNK_TRAILER = 3
     };
 
     struct response_flags
@@ -60,9 +129,23 @@ public:
         bool sse = false;
         bool chunks = false;
         bool payload_available = false;
+        bool range_bytes = false;
+        // The SSE event line that exceeds the event buffer is being discarded.
+        bool sse_overflow = false;
+        // The remaining data of SSE event line that was filtered out is being discarded.
+        bool sse_skip = false;
+        // The current SSE event line was matched by the stream filter.
+        bool sse_pass = false;
+        // The payload is gzip compressed (Content-Encoding: gzip).
+        bool gzip = false;
 
         void reset()
         {
+            gzip = false;
+            range_bytes = false;
+            sse_overflow = false;
+            sse_skip = false;
+            sse_pass = false;
             header_remaining = false;
             payload_remaining = false;
             keep_alive = false;
@@ -77,6 +160,8 @@ public:
         chunk_phase phase = READ_CHUNK_SIZE;
         int chunkSize = 0;
         int dataLen = 0;
+        // The incomplete chunk-size or trailer line.
+        String line;
     };
 
     struct auth_error_t
@@ -89,26 +174,42 @@ public:
     response_flags flags;
     size_t payloadLen = 0;
     size_t payloadRead = 0;
+    // The delay in seconds of Retry-After header, the HTTP-date is not used.
+    uint32_t retryAfter = 0;
     auth_error_t error;
-    uint8_t *toFill = nullptr;
-    uint16_t toFillLen = 0;
-    uint16_t toFillIndex = 0;
     String val[res_hndlr_ns::max_type];
     chunk_info_t chunkInfo;
+    SSEParser sse_parser;
     Timer read_timer;
     bool auth_data_available = false;
+#if defined(FIREBASE_STATIC_BUFFERS)
+    uint8_t rxBuf[FIREBASE_RX_BUFFER_SIZE];
+#else
+    uint8_t *rxBuf = nullptr;
+#endif
+    uint16_t rxLen = 0;
+    uint16_t rxPos = 0;
+    // The data in receive buffer or the peeked buffer of network client.
+    const uint8_t *rxData = nullptr;
+    // The peek function of network client that the headers, chunk framing and payload are parsed in place.
+    TCPPeekCallback peeker = NULL;
+    bool rxPeeked = false;
 
     async_response_handler_t()
     {
     }
 
+    // The receive buffer is owned by the handler and is not copied.
+    async_response_handler_t(const async_response_handler_t &) = delete;
+    async_response_handler_t &operator=(const async_response_handler_t &) = delete;
+
     ~async_response_handler_t()
     {
-        if (toFill)
-            free(toFill);
-        toFill = nullptr;
-        toFillLen = 0;
-        toFillIndex = 0;
+#if !defined(FIREBASE_STATIC_BUFFERS)
+        if (rxBuf)
+            free(rxBuf);
+        rxBuf = nullptr;
+#endif
     }
 
     void clear()
@@ -117,18 +218,18 @@ public:
         flags.reset();
         payloadLen = 0;
         payloadRead = 0;
+        retryAfter = 0;
         error.resp_code = 0;
         error.string.remove(0, error.string.length());
-        if (toFill)
-            delete toFill;
-        toFill = nullptr;
-        toFillLen = 0;
-        toFillIndex = 0;
         for (size_t i = 0; i < res_hndlr_ns::max_type; i++)
             val[i].remove(0, val[i].length());
         chunkInfo.chunkSize = 0;
         chunkInfo.dataLen = 0;
         chunkInfo.phase = READ_CHUNK_SIZE;
+        chunkInfo.line.remove(0, chunkInfo.line.length());
+        sse_parser.reset();
+        rxLen = 0;
+        rxPos = 0;
     }
 
     void feedTimer(int interval = -1)
@@ -138,110 +239,198 @@ public:
 
     int tcpAvailable(async_request_handler_t::tcp_client_type client_type, Client *client, void *atcp_config)
     {
-        if (client_type == async_request_handler_t::tcp_client_type_sync)
-            return client ? client->available() : 0;
-        else
-        {
-#if defined(ENABLE_ASYNC_TCP_CLIENT)
-            AsyncTCPConfig *async_tcp_config = reinterpret_cast<AsyncTCPConfig *>(atcp_config);
-            if (!async_tcp_config && !async_tcp_config->tcpReceive)
-                return 0;
+        return tcp_transport_t::available(client_type == async_request_handler_t::tcp_client_type_async, client, atcp_config);
+    }
 
-            uint8_t buf[1];
-            async_tcp_config->tcpReceive(buf, 1, async_tcp_config->filledSize, async_tcp_config->available);
+    int tcpRead(async_request_handler_t::tcp_client_type client_type, Client *client, void *atcp_config)
+    {
+        int ret = tcp_transport_t::read(client_type == async_request_handler_t::tcp_client_type_async, client, atcp_config);
+        if (ret > -1)
+            FirebaseMetrics::shared().add(metrics_bytes_in);
+        return ret;
+    }
 
-            if (async_tcp_config->filledSize)
+    int tcpRead(async_request_handler_t::tcp_client_type client_type, Client *client, void *atcp_config, uint8_t *buf, size_t size)
+    {
+        int ret = tcp_transport_t::read(client_type == async_request_handler_t::tcp_client_type_async, client, atcp_config, buf, size);
+        if (ret > 0)
+            FirebaseMetrics::shared().add(metrics_bytes_in, ret);
+        return ret;
+    }
+
+    // Returns the header name type of header line and the position of its value, or header_name_max_type for unused header.
+    res_hndlr_ns::header_name_type getHeaderName(const String &line, int &valuePos)
+    {
+        int colon = Scan::indexOf(line, ':');
+        if (colon < 1)
+            return res_hndlr_ns::header_name_max_type;
+
+        for (uint8_t i = 0; i < res_hndlr_ns::header_name_max_type; i++)
+        {
+            const char *name = async_response_header_names[i].text;
+            int j = 0;
+            while (j < colon)
             {
-                memcpy(async_tcp_config->buff + async_tcp_config->buffPos, buf, async_tcp_config->filledSize);
-                async_tcp_config->buffPos++;
+                char c = pgm_read_byte(name + j);
+                if (c == 0 || tolower(c) != tolower(line[j]))
+                    break;
+                j++;
             }
 
-            return async_tcp_config->available;
-#endif
+            if (j == colon && pgm_read_byte(name + j) == 0)
+            {
+                valuePos = colon + 1;
+                return (res_hndlr_ns::header_name_type)i;
+            }
         }
+        return res_hndlr_ns::header_name_max_type;
+    }
 
-        return 0;
+    // Returns the numbers of bytes in receive buffer and network client.
+    int available(async_request_handler_t::tcp_client_type client_type, Client *client, void *atcp_config)
+    {
+        if (rxPos < rxLen)
+            return rxLen - rxPos;
+        return tcpAvailable(client_type, client, atcp_config);
     }
 
-    int tcpRead(async_request_handler_t::tcp_client_type client_type, Client *client, void *atcp_config)
+    // Read data from receive buffer then network client.
+    int read(async_request_handler_t::tcp_client_type client_type, Client *client, void *atcp_config, uint8_t *buf, size_t size)
     {
-        if (client_type == async_request_handler_t::tcp_client_type_sync)
-            return client ? client->read() : -1;
-        else
+        if (rxPos < rxLen)
         {
-#if defined(ENABLE_ASYNC_TCP_CLIENT)
-
-            AsyncTCPConfig *async_tcp_config = reinterpret_cast<AsyncTCPConfig *>(atcp_config);
-            if (!async_tcp_config && !async_tcp_config->tcpReceive)
-                return 0;
+            size_t len = (size_t)(rxLen - rxPos) > size ? size : rxLen - rxPos;
+            memcpy(buf, rxData + rxPos, len);
+            rxPos += len;
+            return len;
+        }
+        return tcpRead(client_type, client, atcp_config, buf, size);
+    }
 
-            if (async_tcp_config->buffPos)
-            {
-                uint8_t v = async_tcp_config->buff[0];
-                async_tcp_config->buffPos--;
+    // Read the line (including the line ending) and append to buf, returns the numbers of bytes read.
+    // The line is read up to size bytes when size is not zero.
+    int readLine(async_request_handler_t::tcp_client_type client_type, Client *client, void *atcp_config, String &buf, size_t size = 0)
+    {
+        int p = 0;
+        while (rxPos < rxLen || fillRxBuf(client_type, client, atcp_config) > 0)
+        {
+            uint16_t end = rxPos + Scan::findByte(rxData + rxPos, rxLen - rxPos, '\n');
 
-                if (async_tcp_config->buffPos)
-                    memmove(async_tcp_config->buff, async_tcp_config->buff + 1, async_tcp_config->buffPos);
+            bool eol = end < rxLen;
+            if (eol)
+                end++;
 
-                return v;
+            if (size && (size_t)(end - rxPos) > size - p)
+            {
+                end = rxPos + size - p;
+                eol = false;
             }
 
-            async_tcp_config->tcpReceive(async_tcp_config->buff, 1, async_tcp_config->filledSize, async_tcp_config->available);
+            buf.concat(reinterpret_cast<const char *>(rxData + rxPos), end - rxPos);
 
-            if (async_tcp_config->filledSize)
-                async_tcp_config->buffPos = async_tcp_config->filledSize;
-
-            return async_tcp_config->filledSize ? async_tcp_config->buff[0] : -1;
-#endif
+            p += end - rxPos;
+            rxPos = end;
+            if (eol)
+            {
+                releaseRx(client);
+                return p;
+            }
+            if (size && (size_t)p >= size)
+                return p;
         }
-
-        return 0;
+        return p;
     }
 
-    int tcpRead(async_request_handler_t::tcp_client_type client_type, Client *client, void *atcp_config, uint8_t *buf, size_t size)
+    // Discard the data up to the line ending, returns the numbers of bytes discarded, eol is set when the line ending was discarded.
+    int skipLine(async_request_handler_t::tcp_client_type client_type, Client *client, void *atcp_config, bool &eol)
     {
-        if (client_type == async_request_handler_t::tcp_client_type_sync)
-            return client ? client->read(buf, size) : -1;
-        else
+        int p = 0;
+        eol = false;
+        while (rxPos < rxLen || fillRxBuf(client_type, client, atcp_config) > 0)
         {
-#if defined(ENABLE_ASYNC_TCP_CLIENT)
-            AsyncTCPConfig *async_tcp_config = reinterpret_cast<AsyncTCPConfig *>(atcp_config);
-            if (!async_tcp_config && !async_tcp_config->tcpReceive)
-                return 0;
-
-            int pos = 0;
-            if (async_tcp_config->buffPos)
+            uint16_t end = rxPos + Scan::findByte(rxData + rxPos, rxLen - rxPos, '\n');
+            eol = end < rxLen;
+            if (eol)
+                end++;
+            p += end - rxPos;
+            rxPos = end;
+            if (eol)
             {
-                int read = async_tcp_config->buffPos;
-                if (read > (int)size)
-                    read = size;
+                releaseRx(client);
+                return p;
+            }
+        }
+        return p;
+    }
 
-                memcpy(buf, async_tcp_config->buff, read);
-                async_tcp_config->buffPos -= read;
+    // Read up to size bytes and append to buf, returns the numbers of bytes read.
+    int readString(async_request_handler_t::tcp_client_type client_type, Client *client, void *atcp_config, String &buf, size_t size)
+    {
+        if (rxPos >= rxLen && fillRxBuf(client_type, client, atcp_config) == 0)
+            return 0;
 
-                if (async_tcp_config->buffPos)
-                    memmove(async_tcp_config->buff, async_tcp_config->buff + read, async_tcp_config->buffPos);
+        uint16_t len = (size_t)(rxLen - rxPos) > size ? size : rxLen - rxPos;
+        buf.concat(reinterpret_cast<const char *>(rxData + rxPos), len);
 
-                if ((int)size <= read)
-                    return read;
+        rxPos += len;
+        releaseRx(client);
+        return len;
+    }
 
-                pos = read;
-                size -= read;
-            }
+private:
+    // Fill the empty receive buffer with available data from network client.
+    int fillRxBuf(async_request_handler_t::tcp_client_type client_type, Client *client, void *atcp_config)
+    {
+        releaseRx(client);
+        rxLen = 0;
+        rxPos = 0;
 
-            if (size > 0)
+        if (peeker && client && client_type == async_request_handler_t::tcp_client_type_sync)
+        {
+            size_t len = 0;
+            const uint8_t *data = peeker(client, len, false);
+            // The data are copied to receive buffer when the client has no peek buffer (plain connection).
+            if (data && len)
             {
-                async_tcp_config->buffPos = 0;
-                uint8_t buff[size];
-                async_tcp_config->tcpReceive(buff + pos, size, async_tcp_config->filledSize, async_tcp_config->available);
-                return async_tcp_config->filledSize ? async_tcp_config->filledSize : -1;
+                rxData = data;
+                rxLen = len > 0xFFFF ? 0xFFFF : len;
+                rxPeeked = true;
+                return rxLen;
             }
+        }
+
+        int avail = tcpAvailable(client_type, client, atcp_config);
+        if (avail <= 0)
+            return 0;
 
-            return -1;
+#if !defined(FIREBASE_STATIC_BUFFERS)
+        if (!rxBuf)
+            rxBuf = reinterpret_cast<uint8_t *>(malloc(FIREBASE_RX_BUFFER_SIZE));
+
+        if (!rxBuf)
+            return 0;
 #endif
-        }
 
-        return 0;
+        int toRead = avail > FIREBASE_RX_BUFFER_SIZE ? FIREBASE_RX_BUFFER_SIZE : avail;
+        int read = tcpRead(client_type, client, atcp_config, rxBuf, toRead);
+        rxLen = read > 0 ? read : 0;
+        rxData = rxBuf;
+
+        return rxLen;
+    }
+
+    // Consume the used data of peeked buffer, the peeked buffer is not kept between reads.
+    void releaseRx(Client *client)
+    {
+        if (!rxPeeked)
+            return;
+
+        size_t len = rxPos;
+        peeker(client, len, true);
+        FirebaseMetrics::shared().add(metrics_bytes_in, len);
+        rxPeeked = false;
+        rxLen = 0;
+        rxPos = 0;
     }
 };
 
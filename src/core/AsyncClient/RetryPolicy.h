@@ -0,0 +1,122 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_ASYNC_CLIENT_RETRY_POLICY_H
+#define CORE_ASYNC_CLIENT_RETRY_POLICY_H
+
+#include <Arduino.h>
+#include "./core/Error.h"
+
+// The range of retry delay in ms, the delay is doubled (with the random half) after each retry.
+#if !defined(FIREBASE_RETRY_BACKOFF_MIN)
+#define FIREBASE_RETRY_BACKOFF_MIN 500
+#endif
+#if !defined(FIREBASE_RETRY_BACKOFF_MAX)
+#define FIREBASE_RETRY_BACKOFF_MAX 30000
+#endif
+
+// The numbers of retries of all tasks of async client in a minute.
+#if !defined(FIREBASE_RETRY_BUDGET)
+#define FIREBASE_RETRY_BUDGET 10
+#endif
+
+enum retry_error_class
+{
+    retry_error_none = 0,
+    // The TCP connection, send and disconnection errors.
+    retry_error_network = 1 << 0,
+    retry_error_timeout = 1 << 1,
+    // The HTTP 429 error.
+    retry_error_throttled = 1 << 2,
+    // The HTTP 5xx errors.
+    retry_error_server = 1 << 3,
+    // The HTTP 401 error and the request that was sent before the auth token was ready.
+    retry_error_auth = 1 << 4,
+    retry_error_all = 0x1f
+};
+
+/**
+ * The callback that decides the retry of failed request.
+ *
+ * @param code The error code.
+ * @param attempt The numbers of retries that were made.
+ * @param delay The backoff delay or the Retry-After time in ms.
+ * @return The delay in ms before the request is retried or -1 to return the error.
+ */
+typedef int32_t (*AsyncRetryCallback)(int code, uint8_t attempt, int32_t delay);
+
+struct RetryPolicy
+{
+public:
+    // The maximum numbers of retries of each request, 0 for no retry.
+    uint8_t attempts = 0;
+    // The retry_error_class flags of errors to retry.
+    uint8_t classes = retry_error_all;
+    uint32_t min_ms = FIREBASE_RETRY_BACKOFF_MIN, max_ms = FIREBASE_RETRY_BACKOFF_MAX;
+    // The numbers of retries of all requests in a minute, 0 for unlimited.
+    uint16_t budget = FIREBASE_RETRY_BUDGET;
+    // Retry the POST and PATCH requests that were sent completely, the server may have applied them before the error.
+    // These requests are retried only on the connection and send errors by default.
+    bool non_idempotent = false;
+    AsyncRetryCallback cb = NULL;
+
+    RetryPolicy() {}
+    explicit RetryPolicy(uint8_t attempts, uint8_t classes = retry_error_all, AsyncRetryCallback cb = NULL) : attempts(attempts), classes(classes), cb(cb) {}
+
+    static retry_error_class classify(int code)
+    {
+        switch (code)
+        {
+        case FIREBASE_ERROR_TCP_CONNECTION:
+        case FIREBASE_ERROR_TCP_SEND:
+        case FIREBASE_ERROR_TCP_DISCONNECTED:
+            return retry_error_network;
+        case FIREBASE_ERROR_TCP_RECEIVE_TIMEOUT:
+            return retry_error_timeout;
+        case FIREBASE_ERROR_HTTP_CODE_TOO_MANY_REQUESTS:
+            return retry_error_throttled;
+        case FIREBASE_ERROR_HTTP_CODE_UNAUTHORIZED:
+        case FIREBASE_ERROR_UNAUTHENTICATE:
+            return retry_error_auth;
+        default:
+            return code >= FIREBASE_ERROR_HTTP_CODE_INTERNAL_SERVER_ERROR && code < 600 ? retry_error_server : retry_error_none;
+        }
+    }
+
+    bool retryable(int code) const { return (classes & classify(code)) != 0; }
+
+    // Returns the jittered exponential backoff delay of retry.
+    uint32_t backoff(uint8_t attempt) const
+    {
+        uint32_t delay = min_ms;
+        for (uint8_t i = 0; i < attempt && delay < max_ms; i++)
+            delay *= 2;
+        if (delay > max_ms)
+            delay = max_ms;
+        // The half of delay is random to spread the retries of devices after the outage.
+        return delay / 2 + random(delay / 2 + 1);
+    }
+};
+
+#endif
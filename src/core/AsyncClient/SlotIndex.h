@@ -0,0 +1,108 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_ASYNC_CLIENT_SLOT_INDEX_H
+#define CORE_ASYNC_CLIENT_SLOT_INDEX_H
+
+#include <Arduino.h>
+#include <vector>
+#include "./core/FNV.h"
+
+// The number of hash buckets of the uid index of async client tasks.
+#if !defined(FIREBASE_SLOT_INDEX_BUCKETS)
+#define FIREBASE_SLOT_INDEX_BUCKETS 8
+#endif
+
+/**
+ * The index of async client tasks by the uid hash.
+ *
+ * Each task has the compact id that was assigned when it was added, the entry of index is valid while the id of
+ * its task is unchanged. The bucket capacities are kept after the entries were removed.
+ */
+class SlotIndex
+{
+public:
+    struct entry_t
+    {
+        uint32_t hash = 0;
+        uint16_t id = 0;
+        void *slot = nullptr;
+    };
+
+    SlotIndex() {}
+
+    // Returns the next id of task, zero is not used.
+    uint16_t assign()
+    {
+        if (++last_id == 0)
+            last_id = 1;
+        return last_id;
+    }
+
+    void add(uint32_t hash, uint16_t id, void *slot)
+    {
+        entry_t e;
+        e.hash = hash;
+        e.id = id;
+        e.slot = slot;
+        bucket(hash).push_back(e);
+    }
+
+    void remove(uint32_t hash, uint16_t id)
+    {
+        std::vector<entry_t> &b = bucket(hash);
+        for (size_t i = 0; i < b.size(); i++)
+        {
+            if (b[i].id == id)
+            {
+                b[i] = b.back();
+                b.pop_back();
+                return;
+            }
+        }
+    }
+
+    // The entries of the uid hash and the other hashes of its bucket.
+    const std::vector<entry_t> &find(uint32_t hash) { return bucket(hash); }
+
+    void clear()
+    {
+        for (int i = 0; i < FIREBASE_SLOT_INDEX_BUCKETS; i++)
+            buckets[i].clear();
+    }
+
+    // The FNV-1a hash of uid, zero is the task without uid.
+    static uint32_t hash(const char *uid)
+    {
+        return FNV1a::key(FNV1a::hashString(uid));
+    }
+
+private:
+    std::vector<entry_t> buckets[FIREBASE_SLOT_INDEX_BUCKETS];
+    uint16_t last_id = 0;
+
+    std::vector<entry_t> &bucket(uint32_t hash) { return buckets[hash % FIREBASE_SLOT_INDEX_BUCKETS]; }
+};
+
+#endif
@@ -0,0 +1,114 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_ASYNC_CLIENT_TRANSPORT_H
+#define CORE_ASYNC_CLIENT_TRANSPORT_H
+
+#include <Arduino.h>
+#include "./Config.h"
+#include "Client.h"
+
+#if defined(ENABLE_ASYNC_TCP_CLIENT)
+#include "./core/AsyncTCPConfig.h"
+#endif
+
+// The transport of the sync (Arduino Client) network client.
+struct sync_transport_t
+{
+    static int available(Client *client, void *) { return client ? client->available() : 0; }
+
+    static int read(Client *client, void *) { return client ? client->read() : -1; }
+
+    static int read(Client *client, void *, uint8_t *buf, size_t size) { return client ? client->read(buf, size) : -1; }
+
+    static size_t write(Client *client, void *, uint8_t *data, size_t size) { return client ? client->write(data, size) : 0; }
+};
+
+#if defined(ENABLE_ASYNC_TCP_CLIENT)
+
+// The transport of the async TCP client, the config is the AsyncTCPConfig of async client.
+struct async_tcp_transport_t
+{
+    static AsyncTCPConfig *config(void *atcp_config) { return reinterpret_cast<AsyncTCPConfig *>(atcp_config); }
+
+    static int available(Client *, void *atcp_config)
+    {
+        AsyncTCPConfig *cfg = config(atcp_config);
+        return cfg && cfg->tcpReceive ? cfg->rxAvailable() : 0;
+    }
+
+    static int read(Client *, void *atcp_config)
+    {
+        AsyncTCPConfig *cfg = config(atcp_config);
+        return cfg && cfg->tcpReceive ? cfg->rxRead() : -1;
+    }
+
+    static int read(Client *, void *atcp_config, uint8_t *buf, size_t size)
+    {
+        AsyncTCPConfig *cfg = config(atcp_config);
+        return cfg && cfg->tcpReceive ? cfg->rxRead(buf, size) : -1;
+    }
+
+    static size_t write(Client *, void *atcp_config, uint8_t *data, size_t size)
+    {
+        AsyncTCPConfig *cfg = config(atcp_config);
+        if (!cfg || !cfg->tcpSend)
+            return 0;
+        uint32_t sent = 0;
+        cfg->tcpSend(data, size, sent);
+        return sent;
+    }
+};
+
+#endif
+
+/**
+ * The transport calls of the client type.
+ *
+ * The sync transport is called directly when ENABLE_ASYNC_TCP_CLIENT is not defined,
+ * then the client type is not checked on every read and write.
+ */
+template <typename Sync>
+struct basic_tcp_transport_t
+{
+#if defined(ENABLE_ASYNC_TCP_CLIENT)
+#define FIREBASE_TRANSPORT_CALL(fn, ...) (async ? async_tcp_transport_t::fn(__VA_ARGS__) : Sync::fn(__VA_ARGS__))
+#else
+#define FIREBASE_TRANSPORT_CALL(fn, ...) ((void)async, Sync::fn(__VA_ARGS__))
+#endif
+
+    static int available(bool async, Client *client, void *atcp_config) { return FIREBASE_TRANSPORT_CALL(available, client, atcp_config); }
+
+    static int read(bool async, Client *client, void *atcp_config) { return FIREBASE_TRANSPORT_CALL(read, client, atcp_config); }
+
+    static int read(bool async, Client *client, void *atcp_config, uint8_t *buf, size_t size) { return FIREBASE_TRANSPORT_CALL(read, client, atcp_config, buf, size); }
+
+    static size_t write(bool async, Client *client, void *atcp_config, uint8_t *data, size_t size) { return FIREBASE_TRANSPORT_CALL(write, client, atcp_config, data, size); }
+
+#undef FIREBASE_TRANSPORT_CALL
+};
+
+typedef basic_tcp_transport_t<sync_transport_t> tcp_transport_t;
+
+#endif
@@ -29,11 +29,27 @@
 #include "./core/List.h"
 #include "./core/Timer.h"
 #include "./core/StringUtil.h"
+#include "./core/JsonParser.h"
+#include "./core/SSEParser.h"
+#include "./core/Memory.h"
+#include "./core/Hash.h"
+#include "./core/StringRef.h"
 
-#define FIREBASE_CHUNK_SIZE 2048
-#define FIREBASE_BASE64_CHUNK_SIZE 1026
 #define FIREBASE_SSE_TIMEOUT 40 * 1000
 
+// The range of stream timeout in ms that learned from the keep-alive interval.
+#if !defined(FIREBASE_SSE_TIMEOUT_MIN)
+#define FIREBASE_SSE_TIMEOUT_MIN 10 * 1000
+#endif
+#if !defined(FIREBASE_SSE_TIMEOUT_MAX)
+#define FIREBASE_SSE_TIMEOUT_MAX 120 * 1000
+#endif
+
+// The numbers of debug messages in flash that are kept until the debug was read.
+#if !defined(FIREBASE_DEBUG_MESSAGES)
+#define FIREBASE_DEBUG_MESSAGES 4
+#endif
+
 using namespace firebase;
 
 namespace ares_ns
@@ -45,6 +61,7 @@ namespace ares_ns
         data_path,
         data_payload,
         debug_info,
+        spool_file,
         max_type
     };
 }
@@ -82,7 +99,27 @@ namespace firebase
 
     public:
         template <typename T>
-        T to() { return vcon.to<T>(data().c_str()); }
+        auto to() -> typename std::enable_if<ValueConverter::v_number<T>::value || std::is_same<T, bool>::value, T>::type
+        {
+            // The number is converted in place without copying the data.
+            if (data_p1 > 0)
+                return vcon.to<T>(ref_payload->c_str() + data_p1, data_p2 - data_p1);
+            return vcon.to<T>(ref_payload ? ref_payload->c_str() : "");
+        }
+
+        template <typename T>
+        auto to() -> typename std::enable_if<json_schema<T>::value, T>::type
+        {
+            T o;
+            if (data_p1 > 0)
+                JsonSchemaReader::read(ref_payload->c_str() + data_p1, data_p2 - data_p1, o);
+            else if (ref_payload)
+                JsonSchemaReader::read(ref_payload->c_str(), ref_payload->length(), o);
+            return o;
+        }
+
+        template <typename T>
+        auto to() -> typename std::enable_if<!ValueConverter::v_number<T>::value && !std::is_same<T, bool>::value && !json_schema<T>::value, T>::type { return vcon.to<T>(data().c_str()); }
         bool isStream() const { return sse; }
         String name() const { return node_name.c_str(); }
         String ETag() const { return etag.c_str(); }
@@ -97,7 +134,24 @@ namespace firebase
 
         bool eventTimeout() { return sse && sse_timer.remaining() == 0; }
 
-        realtime_database_data_type type() { return vcon.getType(data().c_str()); }
+        // The stream timeout in ms, it is 1.5 times of the keep-alive interval when it was observed.
+        uint32_t streamTimeout() const
+        {
+            if (keepalive_ms == 0)
+                return FIREBASE_SSE_TIMEOUT;
+            uint32_t timeout = keepalive_ms + keepalive_ms / 2;
+            return timeout < (FIREBASE_SSE_TIMEOUT_MIN) ? (FIREBASE_SSE_TIMEOUT_MIN) : (timeout > (FIREBASE_SSE_TIMEOUT_MAX) ? (FIREBASE_SSE_TIMEOUT_MAX) : timeout);
+        }
+
+        realtime_database_data_type type() { return isPrimitive() ? prim_type : vcon.getType(data().c_str()); }
+
+        // The data of stream event is the number or boolean that was decoded while the event was parsed.
+        bool isPrimitive() const { return prim_type != realtime_database_data_type_undefined; }
+
+        // The decoded number or boolean of stream event, 0 when the data is not primitive.
+        int64_t intValue() const { return prim_int ? prim.i : (int64_t)prim.d; }
+        double doubleValue() const { return prim_int ? (double)prim.i : prim.d; }
+        bool boolValue() const { return prim_int ? prim.i != 0 : prim.d != 0; }
 
         void clearSSE()
         {
@@ -109,66 +163,157 @@ namespace firebase
             data_p2 = 0;
             sse = false;
             event_resume_status = event_resume_status_undefined;
+            prim_type = realtime_database_data_type_undefined;
+            prim_int = true;
+            prim.i = 0;
         }
         void parseNodeName()
         {
-            int p1 = 0, p2 = 0;
-            sut.parse(*ref_payload, "\"name\"", "}", p1, p2);
-            if (p1 > -1 && p2 > -1)
-            {
-                node_name = ref_payload->substring(p1 + 1, p2 - 1);
-            }
+            JsonPullParser::get(*ref_payload, "name", node_name);
         }
-        void parseSSE()
+
+        // Set the event from the spans of complete event in the payload.
+        void parseSSE(const SSEParser &parser)
         {
             clearSSE();
-            int p1 = 0, p2 = 0;
-            sut.parse(*ref_payload, "event", "\n", p1, p2);
-            if (p1 > -1 && p2 > -1)
+            json_span_t ev = parser.event(), dt = parser.data();
+            if (ev.valid())
             {
-                event_p1 = p1;
-                event_p2 = p2;
-                p1 = p2;
+                event_p1 = ev.start;
+                event_p2 = ev.end;
                 setEventResumeStatus(event_resume_status_undefined);
-                sse_timer.feed(String(event()).indexOf("cancel") > -1 || String(event()).indexOf("auth_revoked") > -1 ? 0 : FIREBASE_SSE_TIMEOUT);
+
+                // The keep-alive event is sent when the stream was idle, its interval is the server idle period.
+                if (parser.type() == sse_event_keep_alive && event_ms > 0)
+                {
+                    uint32_t interval = millis() - event_ms;
+                    keepalive_ms = keepalive_ms ? (keepalive_ms * 3 + interval) / 4 : interval;
+                }
+                event_ms = millis();
+
+                // The stream will be resumed immediately after the cancel and auth_revoked events.
+                sse_timer.feed(parser.type() == sse_event_cancel || parser.type() == sse_event_auth_revoked ? 0 : (streamTimeout() + 999) / 1000);
                 sse = true;
             }
 
-            sut.parse(*ref_payload, "data", "\n", p1, p2);
-            if (p1 > -1 && p2 > -1)
+            if (dt.valid())
             {
-                int p3 = p1, p4 = p2;
-                if (ref_payload->substring(p1, p2) == "null")
-                {
-                    data_p1 = p1;
-                    data_p2 = p2;
+                data_p1 = dt.start;
+                data_p2 = dt.end;
+
+                // The keep-alive and null data are not JSON object.
+                if (parser.type() == sse_event_keep_alive || (dt.length() == 4 && strncmp(ref_payload->c_str() + dt.start, "null", 4) == 0))
                     return;
-                }
 
-                sut.parse(*ref_payload, "\"path\"", ",", p1, p2);
-                if (p1 > -1 && p2 > -1)
+                if ((parser.type() == sse_event_put || parser.type() == sse_event_patch) && parsePrimitive(dt))
+                    return;
+
+                json_span_t span;
+                JsonPullParser path_parser(ref_payload->c_str() + dt.start, dt.length());
+                if (path_parser.find("path", span))
                 {
-                    data_path_p1 = p1 + 1;
-                    data_path_p2 = p2 - 1;
-                    p1 = p2;
+                    span = span.unquote(ref_payload->c_str() + dt.start);
+                    data_path_p1 = dt.start + span.start;
+                    data_path_p2 = dt.start + span.end;
                 }
 
-                sut.parse(*ref_payload, "\"data\"", "\n", p1, p2);
-                if (p1 > -1 && p2 > -1)
+                JsonPullParser data_parser(ref_payload->c_str() + dt.start, dt.length());
+                if (data_parser.find("data", span))
                 {
-                    if ((*ref_payload)[p2 - 1] == '}')
-                        p2--;
-                    data_p1 = p1;
-                    data_p2 = p2;
+                    data_p1 = dt.start + span.start;
+                    data_p2 = dt.start + span.end;
                 }
+            }
+        }
+
+        // The event data of number or boolean that the server sends as {"path":"<path>","data":<value>} is decoded
+        // without the JSON parser, the other data are parsed by the JSON parser.
+        bool parsePrimitive(const json_span_t &dt)
+        {
+            static const char prefix[] = "{\"path\":\"", sep[] = "\",\"data\":";
+            const char *s = ref_payload->c_str() + dt.start;
+            size_t len = dt.length(), n = sizeof(prefix) - 1, p = n;
+            if (len <= n || strncmp(s, prefix, n) != 0)
+                return false;
+
+            // The path with escaped characters is parsed by the JSON parser.
+            while (p < len && s[p] != '"' && s[p] != '\\')
+                p++;
+            size_t path_end = p;
+            if (len - p < sizeof(sep) - 1 || strncmp(s + p, sep, sizeof(sep) - 1) != 0)
+                return false;
+            p += sizeof(sep) - 1;
+
+            size_t end = len;
+            while (end > p && (s[end - 1] == ' ' || s[end - 1] == '\r' || s[end - 1] == '\n'))
+                end--;
+            if (end <= p || s[end - 1] != '}')
+                return false;
+            end--;
+
+            if (!decodePrimitive(s + p, end - p))
+                return false;
+
+            data_path_p1 = dt.start + n;
+            data_path_p2 = dt.start + path_end;
+            data_p1 = dt.start + p;
+            data_p2 = dt.start + end;
+            return true;
+        }
+
+        // Decode the number or boolean, the value type is the same as type() of the value string.
+        bool decodePrimitive(const char *v, size_t len)
+        {
+            if ((len == 4 && strncmp(v, "true", 4) == 0) || (len == 5 && strncmp(v, "false", 5) == 0))
+            {
+                prim_int = true;
+                prim.i = len == 4;
+                prim_type = realtime_database_data_type_boolean;
+                return true;
+            }
 
-                if (data_p1 == 0)
+            size_t sign = len > 0 && v[0] == '-' ? 1 : 0;
+            if (len == sign || len > 24 || v[sign] < '0' || v[sign] > '9')
+                return false;
+
+            // The integer of up to 18 digits is decoded without overflow.
+            bool integer = len - sign <= 18, dot = false;
+            int64_t i = 0;
+            for (size_t k = sign; k < len; k++)
+            {
+                if (v[k] >= '0' && v[k] <= '9')
+                    i = i * 10 + (v[k] - '0');
+                else if (v[k] == '.' || v[k] == 'e' || v[k] == 'E' || v[k] == '+' || v[k] == '-')
                 {
-                    data_p1 = p3;
-                    data_p2 = p4;
+                    integer = false;
+                    dot |= v[k] == '.';
                 }
+                else
+                    return false;
+            }
+
+            if (integer)
+            {
+                prim_int = true;
+                prim.i = sign ? -i : i;
+                prim_type = prim.i > INT32_MAX || prim.i < INT32_MIN ? realtime_database_data_type_double : realtime_database_data_type_integer;
+                return true;
             }
+
+            // The value is followed by '}' of the event data.
+            char *endp = nullptr;
+            double d = strtod(v, &endp);
+            if (endp != v + len)
+                return false;
+            prim_int = false;
+            prim.d = d;
+            if (dot)
+                prim_type = len <= 8 ? realtime_database_data_type_float : realtime_database_data_type_double;
+            else
+                prim_type = d > INT32_MAX || d < INT32_MIN ? realtime_database_data_type_double : realtime_database_data_type_integer;
+            return true;
         }
+
         void setEventResumeStatus(event_resume_status_t status) { event_resume_status = status; }
 
         event_resume_status_t eventResumeStatus() const { return event_resume_status; }
@@ -178,16 +323,131 @@ namespace firebase
 
     private:
         ValueConverter vcon;
-        StringUtil sut;
         Timer sse_timer;
+        // The time of last event and the average keep-alive interval in ms.
+        unsigned long event_ms = 0;
+        uint32_t keepalive_ms = 0;
         bool sse = false;
         event_resume_status_t event_resume_status = event_resume_status_undefined;
         String node_name, etag;
         uint16_t data_path_p1 = 0, data_path_p2 = 0, event_p1 = 0, event_p2 = 0, data_p1 = 0, data_p2 = 0;
+        // The decoded number or boolean of stream event.
+        realtime_database_data_type prim_type = realtime_database_data_type_undefined;
+        bool prim_int = true;
+        union
+        {
+            int64_t i;
+            double d;
+        } prim = {0};
     };
 #endif
 }
 
+// The value at the key path of the result payload, it refers to the payload buffer.
+class PayloadValue
+{
+    friend class AsyncResult;
+
+private:
+    const char *buf = nullptr;
+    json_span_t span;
+    ValueConverter vcon;
+
+    PayloadValue(const char *buf, const json_span_t &span) : buf(buf), span(span) {}
+
+    template <typename F>
+    auto convert(F f) -> decltype(f(""))
+    {
+        // The small value e.g. number is converted from stack buffer.
+        char tmp[32];
+        if (span.length() < sizeof(tmp))
+        {
+            memcpy(tmp, buf + span.start, span.length());
+            tmp[span.length()] = 0;
+            return f(tmp);
+        }
+        String str = raw();
+        return f(str.c_str());
+    }
+
+public:
+    PayloadValue() {}
+
+    // The value was found.
+    bool isValid() const { return buf && span.valid(); }
+
+    // The raw JSON of value, the quotes of string value are included.
+    String raw() const
+    {
+        String str;
+        if (isValid())
+        {
+            str.reserve(span.length());
+            for (int i = span.start; i < span.end; i++)
+                str += buf[i];
+        }
+        return str;
+    }
+
+    realtime_database_data_type type()
+    {
+        return convert([this](const char *v)
+                       { return vcon.getType(v); });
+    }
+
+    template <typename T>
+    auto to() -> typename std::enable_if<ValueConverter::v_number<T>::value || std::is_same<T, bool>::value, T>::type
+    {
+        return isValid() ? vcon.to<T>(buf + span.start, span.length()) : vcon.to<T>("");
+    }
+
+    template <typename T>
+    auto to() -> typename std::enable_if<ValueConverter::v_sring<T>::value, T>::type
+    {
+        String str = raw();
+        return vcon.to<T>(str.c_str());
+    }
+};
+
+// The request timings in µs since the task was added to the queue, the stage that was not reached is 0.
+struct request_timings_t
+{
+public:
+    // The micros() when the task was added to the queue.
+    uint32_t start_us = 0;
+    // The connection was started and the TCP connection was established, it includes the TLS handshake
+    // when the handshake is not advanced by the async client (network client connect).
+    uint32_t connect_start_us = 0, connect_end_us = 0;
+    uint32_t tls_end_us = 0;
+    uint32_t header_sent_us = 0, body_sent_us = 0;
+    uint32_t first_byte_us = 0, headers_parsed_us = 0, complete_us = 0;
+
+    void begin()
+    {
+        clearStages();
+        start_us = micros();
+    }
+
+    // Clear the stages of the request that is sent again.
+    void clearStages()
+    {
+        connect_start_us = 0;
+        connect_end_us = 0;
+        tls_end_us = 0;
+        header_sent_us = 0;
+        body_sent_us = 0;
+        first_byte_us = 0;
+        headers_parsed_us = 0;
+        complete_us = 0;
+    }
+
+    void mark(uint32_t &stage)
+    {
+        if (stage == 0 && start_us > 0)
+            stage = micros() - start_us + 1;
+    }
+};
+
 class AsyncResult
 {
     friend class AsyncClientClass;
@@ -195,11 +455,16 @@ class AsyncResult
     friend class RealtimeDatabase;
     friend class Messaging;
     friend class Functions;
+    friend class CloudFunctions;
     friend class Storage;
     friend class CloudStorage;
     friend class FirestoreBase;
     friend class FirestoreDocuments;
     friend class async_data_item_t;
+    friend class RangeDownload;
+    friend class ComposeUpload;
+    template <typename F>
+    friend class AsyncAwaiter;
 
     struct download_data_t
     {
@@ -207,6 +472,16 @@ class AsyncResult
         size_t total = 0, downloaded = 0;
         bool progress_available = false, ota = false;
         int progress = -1;
+        // The throughput (bytes/s) of the last second and the average throughput since the first byte of this request.
+        uint32_t rate = 0, avg_rate = 0;
+        // The estimated time to complete and the time since the first byte of this request (ms).
+        uint32_t eta_ms = 0, elapsed_ms = 0;
+        // The elapsed time that was spent on waiting for the network data, writing the data (flash, file or sink) and decoding (ms).
+        uint32_t network_ms = 0, write_ms = 0, decode_ms = 0;
+        // The internal state of throughput, the bytes at the start time and the window start, and the process and write times (µs).
+        uint32_t start_ms = 0, window_ms = 0;
+        size_t start_bytes = 0, window_bytes = 0;
+        uint64_t process_us = 0, write_us = 0;
         void reset()
         {
             total = 0;
@@ -214,6 +489,19 @@ class AsyncResult
             progress_available = false;
             progress = -1;
             ota = false;
+            rate = 0;
+            avg_rate = 0;
+            eta_ms = 0;
+            elapsed_ms = 0;
+            network_ms = 0;
+            write_ms = 0;
+            decode_ms = 0;
+            start_ms = 0;
+            window_ms = 0;
+            start_bytes = 0;
+            window_bytes = 0;
+            process_us = 0;
+            write_us = 0;
         }
     };
 
@@ -234,16 +522,102 @@ class AsyncResult
         }
     };
 
+    // The status and size of response of the header-only request (probe), the ETag is kept in etag().
+    struct probe_data_t
+    {
+    public:
+        int code = 0;
+        // The size from Content-Length header, 0 when it is not known e.g. the chunked response.
+        size_t size = 0;
+        bool available = false;
+        void reset()
+        {
+            code = 0;
+            size = 0;
+            available = false;
+        }
+    };
+
+    // The rarely used fields that are allocated when they are used.
+    struct result_ext_t
+    {
+    public:
+        // The payload is not kept here.
+        String val[ares_ns::max_type];
+#if defined(ENABLE_DATABASE)
+        RealtimeDatabaseResult rtdbResult;
+#endif
+        // The key path index of payload that used by at().
+        JsonPathIndex index;
+    };
+
 private:
-    uint32_t addr = 0;
-    uint32_t rvec_addr = 0;
-    String val[ares_ns::max_type];
+    // The handle in Registry, the result is registered when it was assigned to the task.
+    list_handle_t reg_handle = 0;
+    // The function that is called once by the async client loop when the task of this result was removed from the queue.
+    void (*done_cb)(void *ctx) = NULL;
+    void *done_ctx = nullptr;
+    String payload_val;
+    result_ext_t *ext_data = nullptr;
     bool debug_info_available = false;
     uint32_t debug_ms = 0, last_debug_ms = 0;
+    // The debug messages in flash that follow the debug_info, they are formatted when debug() was called.
+    const __FlashStringHelper *debug_msg[FIREBASE_DEBUG_MESSAGES];
+    uint8_t debug_count = 0;
+
+    // Move the debug messages in flash to the debug_info string.
+    void flattenDebug(String &out) const
+    {
+        for (uint8_t i = 0; i < debug_count; i++)
+        {
+            if (out.length())
+                out += " >> ";
+            out += debug_msg[i];
+        }
+    }
     download_data_t download_data;
     upload_data_t upload_data;
+    probe_data_t probe_data;
+    hash_data_t hash_data;
+    memory_stats_t mem_stats;
+    request_timings_t timing_data;
+
+    result_ext_t &ext()
+    {
+        if (!ext_data)
+        {
+            ext_data = new result_ext_t();
+            setPayloadRef();
+        }
+        return *ext_data;
+    }
+
+    // Get the field for writing, the rarely used fields are allocated here.
+    String &val(ares_ns::data_item_type_t type) { return type == ares_ns::data_payload ? payload_val : ext().val[type]; }
+
+    // Get the field for reading without allocation.
+    const String &cval(ares_ns::data_item_type_t type) const
+    {
+        static String empty;
+        if (type == ares_ns::data_payload)
+            return payload_val;
+        return ext_data ? ext_data->val[type] : empty;
+    }
+
 #if defined(ENABLE_DATABASE)
-    RealtimeDatabaseResult rtdbResult;
+    RealtimeDatabaseResult &rtdb() { return ext().rtdbResult; }
+
+    void setNullETag(bool null_etag)
+    {
+        if (null_etag || ext_data)
+            rtdb().null_etag = null_etag;
+    }
+
+    void clearSSE()
+    {
+        if (ext_data)
+            ext_data->rtdbResult.clearSSE();
+    }
 #endif
 
     void setPayload(const String &data)
@@ -251,15 +625,57 @@ private:
         if (data.length())
         {
             data_available = true;
-            val[ares_ns::data_payload] = data;
+            payload_val = data;
         }
+        setPayloadRef();
+    }
+
+    // Take over the payload buffer without copying, the data is left empty.
+    void movePayload(String &data)
+    {
+        if (data.length())
+            data_available = true;
+        payload_val = std::move(data);
+        setPayloadRef();
+    }
+
+    void setPayloadRef()
+    {
+        if (ext_data)
+            ext_data->index.clear();
 #if defined(ENABLE_DATABASE)
-        rtdbResult.ref_payload = &val[ares_ns::data_payload];
+        if (ext_data)
+            ext_data->rtdbResult.ref_payload = &payload_val;
 #endif
     }
 
-    void setETag(const String &etag) { val[ares_ns::res_etag] = etag; }
-    void setPath(const String &path) { val[ares_ns::data_path] = path; }
+    // Set the rarely used field, the field is not allocated for empty value.
+    void setExt(ares_ns::data_item_type_t type, const String &value)
+    {
+        if (value.length() || ext_data)
+            val(type) = value;
+    }
+
+    void setETag(const String &etag) { setExt(ares_ns::res_etag, etag); }
+    void setSpoolFile(const String &name) { setExt(ares_ns::spool_file, name); }
+    void setPath(const String &path) { setExt(ares_ns::data_path, path); }
+    void setUID(const StringRef &uid)
+    {
+        if (uid.length() || ext_data)
+            uid.assignTo(val(ares_ns::res_uid));
+    }
+
+    void copyExt(const AsyncResult &rhs)
+    {
+        if (rhs.ext_data)
+            ext() = *rhs.ext_data;
+        else if (ext_data)
+        {
+            delete ext_data;
+            ext_data = nullptr;
+        }
+        setPayloadRef();
+    }
 
     bool setDownloadProgress()
     {
@@ -277,6 +693,41 @@ private:
         return false;
     }
 
+    // The throughput is measured from the downloaded bytes (the bytes before resume are not counted).
+    void beginDownloadRate(size_t downloaded)
+    {
+        download_data.start_ms = download_data.window_ms = millis();
+        download_data.start_bytes = download_data.window_bytes = downloaded;
+    }
+
+    // Update the throughput, ETA and the time breakdown from the downloaded bytes and the process and write times.
+    void setDownloadRate()
+    {
+        download_data_t &d = download_data;
+        uint32_t now = millis();
+        d.elapsed_ms = now - d.start_ms;
+        if (d.elapsed_ms > 0)
+            d.avg_rate = (uint64_t)(d.downloaded - d.start_bytes) * 1000 / d.elapsed_ms;
+
+        // The rate of the first second is the average rate.
+        if (now - d.window_ms >= 1000)
+        {
+            d.rate = (uint64_t)(d.downloaded - d.window_bytes) * 1000 / (now - d.window_ms);
+            d.window_ms = now;
+            d.window_bytes = d.downloaded;
+        }
+        else if (d.window_ms == d.start_ms)
+            d.rate = d.avg_rate;
+
+        uint32_t rate = d.rate ? d.rate : d.avg_rate;
+        d.eta_ms = rate && d.total > d.downloaded ? (uint64_t)(d.total - d.downloaded) * 1000 / rate : 0;
+
+        uint32_t process_ms = d.process_us / 1000;
+        d.write_ms = d.write_us / 1000;
+        d.decode_ms = process_ms > d.write_ms ? process_ms - d.write_ms : 0;
+        d.network_ms = d.elapsed_ms > process_ms ? d.elapsed_ms - process_ms : 0;
+    }
+
     bool setUploadProgress()
     {
         upload_data.progress_available = false;
@@ -302,77 +753,158 @@ public:
     {
         // Keeping old message in case unread.
         debug_ms = millis();
-        if (debug_info_available && val[ares_ns::debug_info].length() < 200)
+        if (debug_info_available && debug_count)
+            flattenDebug(val(ares_ns::debug_info));
+        debug_count = 0;
+        if (debug_info_available && cval(ares_ns::debug_info).length() < 200)
         {
-            if (val[ares_ns::debug_info].indexOf(debug) == -1)
+            if (cval(ares_ns::debug_info).indexOf(debug) == -1)
             {
-                val[ares_ns::debug_info] += " >> ";
-                val[ares_ns::debug_info] += debug;
+                val(ares_ns::debug_info) += " >> ";
+                val(ares_ns::debug_info) += debug;
             }
         }
         else
-            val[ares_ns::debug_info] = debug;
+            setExt(ares_ns::debug_info, debug);
         if (debug.length())
             debug_info_available = true;
     }
 
-    AsyncResult()
-    {
-#if defined(ENABLE_DATABASE)
-        rtdbResult.ref_payload = &val[ares_ns::data_payload];
-#endif
-        addr = reinterpret_cast<uint32_t>(this);
-    };
-    ~AsyncResult()
+    // The message in flash is kept as pointer without copying, it is formatted when debug() was called.
+    void setDebug(const __FlashStringHelper *debug)
     {
-        if (rvec_addr > 0)
+        debug_ms = millis();
+        if (!debug_info_available)
         {
-            std::vector<uint32_t> *rVec = reinterpret_cast<std::vector<uint32_t> *>(rvec_addr);
-            if (rVec)
-            {
-                List vec;
-                addr = reinterpret_cast<uint32_t>(this);
-                vec.addRemoveList(*rVec, addr, false);
-            }
+            debug_count = 0;
+            if (ext_data)
+                ext_data->val[ares_ns::debug_info].remove(0, ext_data->val[ares_ns::debug_info].length());
+        }
+
+        for (uint8_t i = 0; i < debug_count; i++)
+        {
+            if (debug_msg[i] == debug)
+                return;
         }
+
+        if (debug_count < FIREBASE_DEBUG_MESSAGES)
+            debug_msg[debug_count++] = debug;
+        debug_info_available = true;
+    }
+
+    AsyncResult() {}
+
+    AsyncResult(const AsyncResult &rhs) { *this = rhs; }
+
+    AsyncResult &operator=(const AsyncResult &rhs)
+    {
+        if (this == &rhs)
+            return *this;
+        payload_val = rhs.payload_val;
+        debug_info_available = rhs.debug_info_available;
+        debug_ms = rhs.debug_ms;
+        last_debug_ms = rhs.last_debug_ms;
+        debug_count = rhs.debug_count;
+        for (uint8_t i = 0; i < debug_count; i++)
+            debug_msg[i] = rhs.debug_msg[i];
+        download_data = rhs.download_data;
+        upload_data = rhs.upload_data;
+        probe_data = rhs.probe_data;
+        hash_data = rhs.hash_data;
+        mem_stats = rhs.mem_stats;
+        timing_data = rhs.timing_data;
+        data_available = rhs.data_available;
+        error_available = rhs.error_available;
+        app_event = rhs.app_event;
+        lastError = rhs.lastError;
+        copyExt(rhs);
+        return *this;
+    }
+
+    ~AsyncResult()
+    {
+        if (ext_data)
+            delete ext_data;
+        ext_data = nullptr;
+
+        if (reg_handle)
+            Registry::shared().remove(reg_handle);
     };
-    const char *c_str() { return val[ares_ns::data_payload].c_str(); }
-    String payload() const { return val[ares_ns::data_payload].c_str(); }
-    String path() const { return val[ares_ns::data_path].c_str(); }
-    String etag() const { return val[ares_ns::res_etag].c_str(); }
-    String uid() const { return val[ares_ns::res_uid].c_str(); }
+    const char *c_str() { return payload_val.c_str(); }
+
+    /**
+     * Get the value at the key path of JSON payload e.g. aResult.at("/a/b/c").to<int>().
+     * The payload is tokenized once at the first lookup and the offset index is used by later lookups.
+     *
+     * @param path The key path that separated by "/", the number is used as array index.
+     * @return PayloadValue The value that refers to the payload, check with isValid().
+     */
+    PayloadValue at(const char *path)
+    {
+        json_span_t span;
+        if (payload_val.length() == 0 || !ext().index.find(payload_val.c_str(), payload_val.length(), path, span))
+            return PayloadValue();
+        return PayloadValue(payload_val.c_str(), span);
+    }
+
+    String payload() const { return payload_val.c_str(); }
+    String path() const { return cval(ares_ns::data_path).c_str(); }
+    String etag() const { return cval(ares_ns::res_etag).c_str(); }
+    String uid() const { return cval(ares_ns::res_uid).c_str(); }
+    // The file that the response payload was spooled to, the payload of result is empty when it was spooled.
+    String spoolFile() const { return cval(ares_ns::spool_file).c_str(); }
     String debug()
     {
         last_debug_ms = millis();
-        return val[ares_ns::debug_info].c_str();
+        String out = cval(ares_ns::debug_info).c_str();
+        flattenDebug(out);
+        return out;
     }
     void clear()
     {
-        for (size_t i = 0; i < ares_ns::max_type; i++)
-            val[i].remove(0, val[i].length());
+        payload_val.remove(0, payload_val.length());
+        if (ext_data)
+        {
+            for (size_t i = 0; i < ares_ns::max_type; i++)
+                ext_data->val[i].remove(0, ext_data->val[i].length());
+            ext_data->index.clear();
+        }
         debug_info_available = false;
+        debug_count = 0;
         lastError.setLastError(0, "");
         app_event.setEvent(0, "");
         data_available = false;
         download_data.reset();
         upload_data.reset();
+        probe_data.reset();
+        hash_data.reset();
 #if defined(ENABLE_DATABASE)
-        rtdbResult.clearSSE();
+        if (ext_data)
+            ext_data->rtdbResult.clearSSE();
 #endif
     }
+    // Parse the payload to struct that has its schema (FIREBASE_JSON_SCHEMA).
+    template <typename T>
+    auto to() -> typename std::enable_if<json_schema<T>::value, T>::type
+    {
+        T o;
+        JsonSchemaReader::read(payload_val.c_str(), payload_val.length(), o);
+        return o;
+    }
+
     template <typename T>
-    T &to()
+    auto to() -> typename std::enable_if<!json_schema<T>::value, T &>::type
     {
         static T o;
         if (std::is_same<T, RealtimeDatabaseResult>::value)
-            return rtdbResult;
+            return rtdb();
         return o;
     }
     int available()
     {
         bool ret = data_available;
         data_available = false;
-        return ret ? val[ares_ns::data_payload].length() : 0;
+        return ret ? payload_val.length() : 0;
     }
 
     app_event_t appEvent() const { return app_event; }
@@ -395,6 +927,21 @@ public:
 
     download_data_t downloadInfo() const { return download_data; }
 
+    // The status code and size of response of the header-only request, the payload of response is not kept.
+    probe_data_t probeInfo() const { return probe_data; }
+
+    // The CRC32C (and MD5) of file or blob data that were uploaded or downloaded.
+    hash_data_t hashInfo() const { return hash_data; }
+
+    // The memory usage statistics of this request e.g. allocation counts, bytes allocated and peak live bytes.
+    memory_stats_t memStats() const { return mem_stats; }
+
+    // The time of request stages since the task was added to the queue (µs), they are available when the task was finished.
+    request_timings_t timings() const { return timing_data; }
+
+    // The memory usage statistics of all requests, its peak_bytes is the high-watermark of all requests.
+    static memory_stats_t globalMemStats() { return Memory::globalStats(); }
+
     bool isOTA() { return download_data.ota; }
 
     bool isError()
@@ -410,7 +957,7 @@ public:
 
     bool isDebug()
     {
-        bool dbg = val[ares_ns::debug_info].length() > 0;
+        bool dbg = cval(ares_ns::debug_info).length() > 0 || debug_count > 0;
         if (debug_info_available && last_debug_ms < debug_ms && debug_ms > 0)
         {
             debug_info_available = false;
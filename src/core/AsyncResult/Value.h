@@ -26,6 +26,8 @@
 #define VALUE_CONVERTER_H
 #include <Arduino.h>
 #include <string>
+#include "./core/Number.h"
+#include "./core/Schema.h"
 
 enum realtime_database_data_type
 {
@@ -40,6 +42,51 @@ enum realtime_database_data_type
     realtime_database_data_type_array = 7
 };
 
+// The Print that appends to String, the capacity is grown geometrically.
+class StringPrint : public Print
+{
+private:
+    String *buf = nullptr;
+    size_t cap = 0;
+
+public:
+    // The reserved is the capacity that was already reserved.
+    StringPrint(String &buf, size_t reserved = 0) : buf(&buf), cap(buf.length() > reserved ? buf.length() : reserved) {}
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+
+    size_t write(const uint8_t *data, size_t n) override
+    {
+        if (buf->length() + n > cap)
+        {
+            cap = buf->length() + n > cap * 2 ? buf->length() + n : cap * 2;
+            buf->reserve(cap);
+        }
+        for (size_t i = 0; i < n; i++)
+            *buf += (char)data[i];
+        return n;
+    }
+};
+
+// The Print that counts the bytes only e.g. for computing the payload length.
+class CountPrint : public Print
+{
+public:
+    size_t count = 0;
+
+    size_t write(uint8_t) override
+    {
+        count++;
+        return 1;
+    }
+
+    size_t write(const uint8_t *, size_t n) override
+    {
+        count += n;
+        return n;
+    }
+};
+
 struct boolean_t : public Printable
 {
 private:
@@ -62,18 +109,41 @@ struct number_t : public Printable
 private:
     String buf;
 
+    template <typename T>
+    auto set(T v, int d) -> typename std::enable_if<std::is_floating_point<T>::value, void>::type
+    {
+        char tmp[FIREBASE_NUMBER_BUF_SIZE];
+        NumberUtil::format(v, d, tmp);
+        buf = tmp;
+    }
+
+    template <typename T>
+    auto set(T v, int) -> typename std::enable_if<std::is_integral<T>::value, void>::type
+    {
+        char tmp[FIREBASE_NUMBER_BUF_SIZE];
+        NumberUtil::format(v, tmp);
+        buf = tmp;
+    }
+
+    template <typename T>
+    auto set(T v, int) -> typename std::enable_if<!std::is_arithmetic<T>::value, void>::type { buf = String(v); }
+
 public:
     number_t() {}
+    // The negative decimal places is for the shortest text that converts back to the same value e.g. number_t(0.1f, -1).
     template <typename T1 = int, typename T = int>
-    number_t(T1 v, T d) { buf = String(v, d); }
+    number_t(T1 v, T d) { set(v, d); }
+    // The float and double are formatted with 2 decimal places.
     template <typename T = int>
-    number_t(T o) { buf = String(o); }
+    number_t(T o) { set(o, 2); }
     const char *c_str() const { return buf.c_str(); }
     size_t printTo(Print &p) const { return p.print(buf.c_str()); }
 };
 
 struct string_t : public Printable
 {
+    friend struct object_t;
+
 private:
     String buf;
 
@@ -89,13 +159,13 @@ public:
             buf += v;
         aq();
     }
-    string_t(number_t v)
+    string_t(const number_t &v)
     {
         aq(true);
         buf += v.c_str();
         aq();
     }
-    string_t(boolean_t v)
+    string_t(const boolean_t &v)
     {
         aq(true);
         buf += v.c_str();
@@ -124,13 +194,13 @@ public:
     void clear() { buf.remove(0, buf.length()); }
 
 private:
+    // Remove the closing quote, the value is appended in place.
     void sap()
     {
-        String temp;
         if (buf.length())
-            temp = buf.substring(1, buf.length() - 1);
-        aq(true);
-        buf += temp;
+            buf.remove(buf.length() - 1, 1);
+        else
+            buf += '"';
     }
     void aq(bool clear = false)
     {
@@ -150,12 +220,15 @@ private:
 public:
     object_t() {}
     object_t(const String &o) { buf = o; }
+    // Take over the buffer without copying.
+    object_t(String &&o) : buf(std::move(o)) {}
     const char *c_str() const { return buf.c_str(); }
     template <typename T = const char *>
     object_t(T o) { buf = String(o); }
-    object_t(boolean_t o) { buf = o.c_str(); }
-    object_t(number_t o) { buf = o.c_str(); }
-    object_t(string_t o) { buf = o.c_str(); }
+    object_t(const boolean_t &o) { buf = o.c_str(); }
+    object_t(const number_t &o) { buf = o.c_str(); }
+    object_t(const string_t &o) { buf = o.c_str(); }
+    object_t(string_t &&o) : buf(std::move(o.buf)) {}
     object_t(bool o) { buf = o ? FPSTR("true") : FPSTR("false"); }
     size_t printTo(Print &p) const { return p.print(buf.c_str()); }
     void clear() { buf.remove(0, buf.length()); }
@@ -204,11 +277,28 @@ public:
     };
 
     template <typename T = object_t>
-    auto getVal(String &buf, T value) -> typename std::enable_if<std::is_same<T, object_t>::value || std::is_same<T, string_t>::value || std::is_same<T, boolean_t>::value || std::is_same<T, number_t>::value, void>::type
+    auto getVal(String &buf, const T &value) -> typename std::enable_if<std::is_same<T, object_t>::value || std::is_same<T, string_t>::value || std::is_same<T, boolean_t>::value || std::is_same<T, number_t>::value, void>::type
     {
         buf = value.c_str();
     }
 
+    // The struct that has its schema (FIREBASE_JSON_SCHEMA) is serialized directly.
+    template <typename T>
+    auto getVal(String &buf, const T &value) -> typename std::enable_if<json_schema<T>::value, void>::type
+    {
+        buf.remove(0, buf.length());
+        JsonSchemaWriter::write(buf, value);
+    }
+
+    // The other Printable e.g. JsonTreeBuilder is printed to the buffer directly.
+    template <typename T>
+    auto getVal(String &buf, const T &value) -> typename std::enable_if<std::is_base_of<Printable, T>::value && !std::is_same<T, object_t>::value && !std::is_same<T, string_t>::value && !std::is_same<T, boolean_t>::value && !std::is_same<T, number_t>::value, void>::type
+    {
+        buf.remove(0, buf.length());
+        StringPrint out(buf);
+        value.printTo(out);
+    }
+
     template <typename T = const char *>
     auto getVal(String &buf, T value) -> typename std::enable_if<(v_number<T>::value || v_sring<T>::value || std::is_same<T, bool>::value) && !std::is_same<T, object_t>::value && !std::is_same<T, string_t>::value && !std::is_same<T, boolean_t>::value && !std::is_same<T, number_t>::value, void>::type
     {
@@ -228,20 +318,21 @@ public:
     }
 
     template <typename T>
-    auto to(const char *payload) -> typename std::enable_if<v_number<T>::value || std::is_same<T, bool>::value, T>::type
+    auto to(const char *payload) -> typename std::enable_if<v_number<T>::value || std::is_same<T, bool>::value, T>::type { return to<T>(payload, strlen(payload)); }
+
+    // Convert the value in place e.g. the span in the payload.
+    template <typename T>
+    auto to(const char *payload, size_t len) -> typename std::enable_if<v_number<T>::value || std::is_same<T, bool>::value, T>::type
     {
-        if (!useLength && strlen(payload) > 0)
+        if (!useLength && len > 0)
         {
-            if (getType(payload) == realtime_database_data_type_boolean)
-                setBool(strcmp(payload, "true") == 0);
+            if (len > 1 && ((payload[0] == 'f' && payload[1] == 'a') || (payload[0] == 't' && payload[1] == 'r')))
+                setBool(len == 4 && strncmp(payload, "true", 4) == 0);
             else
-            {
-                setInt(payload);
-                setFloat(payload);
-            }
+                setNumber(payload, len);
         }
         else
-            setBool(strlen(payload));
+            setBool(len);
 
         if (std::is_same<T, int>::value)
             return iVal.int32;
@@ -307,7 +398,7 @@ public:
                 // response here should be numberic value
                 double d = atof(payload);
                 // find the dot and check its length to determine the type
-                if (String(payload).indexOf('.') != -1)
+                if (strchr(payload, '.'))
                     return p2 <= 7 ? realtime_database_data_type_float : realtime_database_data_type_double;
                 else
                     // no dot, determine the type from its value
@@ -369,26 +460,17 @@ private:
         }
     }
 
-    void setInt(const char *value)
+    void setNumber(const char *value, size_t len)
     {
-        if (strlen(value) > 0)
-        {
-            char *pEnd;
-            value[0] == '-' ? iVal.int64 = strtoll(value, &pEnd, 10) : iVal.uint64 = strtoull(value, &pEnd, 10);
-        }
-        else
-            iVal = {0};
-    }
-
-    void setFloat(const char *value)
-    {
-        if (strlen(value) > 0)
-        {
-            char *pEnd;
-            fVal.setd(strtod(value, &pEnd));
-        }
+        bool neg = false;
+        uint64_t u = 0;
+        double d = 0;
+        NumberUtil::parse(value, len, neg, u, d);
+        if (neg)
+            iVal.int64 = u > 0x8000000000000000ULL ? INT64_MIN : (int64_t)(~u + 1);
         else
-            fVal.setd(0);
+            iVal.uint64 = u;
+        fVal.setd(d);
     }
 };
 
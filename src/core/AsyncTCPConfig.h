@@ -30,6 +30,11 @@
 
 #if defined(ENABLE_ASYNC_TCP_CLIENT)
 
+// The size of ring buffer that keeps the data received from async TCP client.
+#if !defined(FIREBASE_ASYNC_TCP_RX_BUFFER_SIZE)
+#define FIREBASE_ASYNC_TCP_RX_BUFFER_SIZE 512
+#endif
+
 /**
  * Async TCP Client Connection Request Callback.
  * @param host The host to connect.
@@ -68,6 +73,9 @@ typedef void (*AsyncTCPSend)(uint8_t *data, size_t size, uint32_t &sent);
  * If data is available from TCP client, fills (copies) the data to buffer within the buffSize.
  * And set the amount of filled data in filledSize, and the remaining data amount in available.
  *
+ * The buffSize can be up to FIREBASE_ASYNC_TCP_RX_BUFFER_SIZE, the TCP client should fill
+ * as much data as it has (up to buffSize) in one call.
+ *
  * If no data is available, TCP client should set 0 to available.
  * If connection or any receiving failure, sets filledSize with -1.
  */
@@ -85,6 +93,7 @@ class AsyncTCPConfig
     friend class AsyncClientClass;
     friend class async_request_handler_t;
     friend class async_response_handler_t;
+    friend struct async_tcp_transport_t;
 
 private:
     // Async TCP Client Connection Request Callback.
@@ -98,11 +107,81 @@ private:
     // Async TCP Client Connection Stop Request Callback.
     AsyncTCPStop tcpStop = NULL;
 
-    int buffPos = 0;
-    uint8_t buff[100];
+    // The ring buffer of received data.
+    uint8_t buff[FIREBASE_ASYNC_TCP_RX_BUFFER_SIZE];
+    uint16_t buffHead = 0;
+    uint16_t buffCount = 0;
     int32_t filledSize = 0;
     uint32_t available = 0;
 
+    // Receive data from TCP client into the free contiguous space of ring buffer.
+    int fill()
+    {
+        if (!tcpReceive || buffCount == FIREBASE_ASYNC_TCP_RX_BUFFER_SIZE)
+            return buffCount;
+
+        uint16_t tail = (buffHead + buffCount) % FIREBASE_ASYNC_TCP_RX_BUFFER_SIZE;
+        uint16_t len = tail < buffHead ? buffHead - tail : FIREBASE_ASYNC_TCP_RX_BUFFER_SIZE - tail;
+
+        filledSize = 0;
+        tcpReceive(buff + tail, len, filledSize, available);
+        if (filledSize > 0)
+            buffCount += filledSize > len ? len : filledSize;
+        else if (filledSize < 0)
+            available = 0;
+
+        return buffCount;
+    }
+
+    // Returns the numbers of data that are available in ring buffer and TCP client.
+    int rxAvailable()
+    {
+        if (buffCount == 0)
+            fill();
+        return buffCount + available;
+    }
+
+    int rxRead()
+    {
+        if (buffCount == 0 && fill() == 0)
+            return -1;
+
+        uint8_t v = buff[buffHead];
+        buffHead = (buffHead + 1) % FIREBASE_ASYNC_TCP_RX_BUFFER_SIZE;
+        buffCount--;
+        return v;
+    }
+
+    int rxRead(uint8_t *data, size_t size)
+    {
+        size_t read = 0;
+        while (read < size)
+        {
+            if (buffCount == 0 && fill() == 0)
+                break;
+
+            size_t len = FIREBASE_ASYNC_TCP_RX_BUFFER_SIZE - buffHead;
+            if (len > buffCount)
+                len = buffCount;
+            if (len > size - read)
+                len = size - read;
+
+            memcpy(data + read, buff + buffHead, len);
+            read += len;
+            buffHead = (buffHead + len) % FIREBASE_ASYNC_TCP_RX_BUFFER_SIZE;
+            buffCount -= len;
+        }
+        return read > 0 ? (int)read : -1;
+    }
+
+    void rxClear()
+    {
+        buffHead = 0;
+        buffCount = 0;
+        filledSize = 0;
+        available = 0;
+    }
+
 public:
     /**
      * @param tcpConnect Async TCP Client Connection Request Callback.
@@ -247,6 +247,32 @@ namespace firebase
 
     typedef void (*TimeStatusCallback)(uint32_t &ts);
 
+    // The callback to save (save is true) or load (save is false) the persisted app token data, returns true when success.
+    typedef bool (*TokenStoreCallback)(String &data, bool save);
+
+#if defined(ENABLE_SERVICE_AUTH)
+    // The service account credentials that were parsed from the service account JSON file at build time
+    // (see resources/tools/service_account.py), the strings and RSA private key (CRT) components are in flash.
+    struct service_account_key_t
+    {
+        PGM_P client_email;
+        PGM_P project_id;
+        // The JWT claims that are constant e.g. "iss":"<client email>","sub":"<client email>" (JSON formatted without braces).
+        PGM_P claims;
+        uint32_t n_bitlen;
+        const uint8_t *p;
+        size_t plen;
+        const uint8_t *q;
+        size_t qlen;
+        const uint8_t *dp;
+        size_t dplen;
+        const uint8_t *dq;
+        size_t dqlen;
+        const uint8_t *iq;
+        size_t iqlen;
+    };
+#endif
+
     struct user_auth_data
     {
         friend class SAParser;
@@ -286,12 +312,14 @@ namespace firebase
                 this->timestatus_cb = rhs.timestatus_cb;
                 this->expire = rhs.expire;
                 this->step = rhs.step;
+                this->key = rhs.key;
             }
 
             void clear()
             {
                 for (size_t i = 0; i < sa_ns::max_type; i++)
                     val[i].remove(0, val[i].length());
+                key = nullptr;
                 timestatus_cb = NULL;
                 expire = FIREBASE_DEFAULT_TOKEN_TTL;
                 step = jwt_step_begin;
@@ -299,6 +327,8 @@ namespace firebase
 
         protected:
             String val[sa_ns::max_type];
+            // The preparsed credentials, the private key (PEM) is not used when it was set.
+            const service_account_key_t *key = nullptr;
             jwt_step step = jwt_step_begin;
             TimeStatusCallback timestatus_cb = NULL;
             size_t expire = FIREBASE_DEFAULT_TOKEN_TTL;
@@ -864,6 +894,19 @@ namespace firebase
             data.timestatus_cb = timeCb;
         };
 
+        ServiceAuth(TimeStatusCallback timeCb, const service_account_key_t &key, size_t expire = FIREBASE_DEFAULT_TOKEN_TTL)
+        {
+            data.clear();
+            data.sa.val[sa_ns::cm] = FPSTR(key.client_email);
+            data.sa.val[sa_ns::pid] = FPSTR(key.project_id);
+            data.sa.key = &key;
+            data.sa.expire = expire;
+            data.initialized = isInitialized();
+            data.auth_type = auth_sa_access_token;
+            data.auth_data_type = user_auth_data_service_account;
+            data.timestatus_cb = timeCb;
+        };
+
         ServiceAuth(TimeStatusCallback timeCb, file_config_data &safile)
         {
 #if defined(ENABLE_FS)
@@ -884,7 +927,7 @@ namespace firebase
         ~ServiceAuth() { data.clear(); };
         void clear() { data.clear(); }
         user_auth_data &get() { return data; }
-        bool isInitialized() { return data.sa.val[sa_ns::cm].length() > 0 && data.sa.val[sa_ns::pid].length() > 0 && data.sa.val[sa_ns::pk].length() > 0; }
+        bool isInitialized() { return data.sa.val[sa_ns::cm].length() > 0 && data.sa.val[sa_ns::pid].length() > 0 && (data.sa.val[sa_ns::pk].length() > 0 || data.sa.key); }
 
     private:
         user_auth_data data;
@@ -915,6 +958,23 @@ namespace firebase
             data.timestatus_cb = timeCb;
         };
 
+        CustomAuth(TimeStatusCallback timeCb, const String &apiKey, const service_account_key_t &key, const String &uid, const String &scope = "", const String &claims = "", size_t expire = FIREBASE_DEFAULT_TOKEN_TTL)
+        {
+            data.clear();
+            data.sa.val[sa_ns::cm] = FPSTR(key.client_email);
+            data.sa.val[sa_ns::pid] = FPSTR(key.project_id);
+            data.sa.key = &key;
+            data.sa.expire = expire;
+            data.cust.val[cust_ns::api_key] = apiKey;
+            data.cust.val[cust_ns::uid] = uid;
+            data.cust.val[cust_ns::scope] = scope;
+            data.cust.val[cust_ns::claims] = claims;
+            data.initialized = isInitialized();
+            data.auth_type = auth_sa_custom_token;
+            data.auth_data_type = user_auth_data_custom_data;
+            data.timestatus_cb = timeCb;
+        };
+
         CustomAuth(TimeStatusCallback timeCb, file_config_data &safile, const String &uid)
         {
 #if defined(ENABLE_FS)
@@ -941,7 +1001,7 @@ namespace firebase
 
         user_auth_data &get() { return data; }
 
-        bool isInitialized() { return data.sa.val[sa_ns::pk].length() > 0 && data.sa.val[sa_ns::cm].length() > 0 && data.sa.val[sa_ns::pid].length() > 0 && data.sa.val[sa_ns::pk].length() > 0 && data.cust.val[cust_ns::uid].length() > 0; }
+        bool isInitialized() { return (data.sa.val[sa_ns::pk].length() > 0 || data.sa.key) && data.sa.val[sa_ns::cm].length() > 0 && data.sa.val[sa_ns::pid].length() > 0 && data.cust.val[cust_ns::uid].length() > 0; }
 
     private:
         user_auth_data data;
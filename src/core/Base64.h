@@ -37,6 +37,24 @@
 
 static const char firebase_boundary_table[] PROGMEM = "=_abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
 static const unsigned char firebase_base64_table[65] PROGMEM = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+// The values of base64 characters (including the URL safe '-' and '_'), 0x80 is the character that is not base64.
+static const uint8_t firebase_base64_dec_table[256] PROGMEM = {
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x3e, 0x80, 0x3e, 0x80, 0x3f,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+    0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x80, 0x80, 0x80, 0x80, 0x3f,
+    0x80, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80};
 
 template <typename T>
 struct firebase_base64_io_t
@@ -61,6 +79,78 @@ struct firebase_base64_io_t
     bool ota = false;
 };
 
+// The streaming base64 decoder, the bits of incomplete characters quantum are kept for the next data
+// and the characters that are not base64 (e.g. the quotes of JSON string) are skipped.
+class Base64Decoder
+{
+public:
+    void begin()
+    {
+        bits = 0;
+        nbits = 0;
+        pads = 0;
+    }
+
+    // Decode the characters to out (up to size bytes), returns the number of characters that were consumed.
+    size_t decode(const uint8_t *src, size_t len, uint8_t *out, size_t size, size_t &written)
+    {
+        written = 0;
+        size_t i = 0;
+        for (; i < len; i++)
+        {
+            // The complete quantum of 4 characters is decoded to 3 bytes at once.
+            while (nbits == 0 && pads == 0 && i + 4 <= len && written + 3 <= size)
+            {
+                uint8_t a = value(src[i]), b = value(src[i + 1]), c = value(src[i + 2]), d = value(src[i + 3]);
+                if ((a | b | c | d) & 0x80)
+                    break;
+                uint32_t v = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6 | d;
+                out[written++] = v >> 16;
+                out[written++] = v >> 8;
+                out[written++] = v;
+                i += 4;
+            }
+
+            if (i == len)
+                break;
+
+            uint8_t c = src[i];
+            if (c == '=')
+            {
+                pads++;
+                continue;
+            }
+
+            uint8_t v = value(c);
+            if ((v & 0x80) || pads > 0)
+                continue;
+
+            // The decoded byte of this character does not fit.
+            if (nbits >= 2 && written == size)
+                break;
+
+            bits = (bits << 6) | v;
+            nbits += 6;
+            if (nbits >= 8)
+            {
+                nbits -= 8;
+                out[written++] = bits >> nbits;
+                bits &= (1 << nbits) - 1;
+            }
+        }
+        return i;
+    }
+
+    // The number of pad characters.
+    uint8_t pad() const { return pads; }
+
+private:
+    uint16_t bits = 0;
+    uint8_t nbits = 0, pads = 0;
+
+    static uint8_t value(uint8_t c) { return pgm_read_byte(firebase_base64_dec_table + c); }
+};
+
 class Base64Util
 {
 public:
@@ -117,15 +207,34 @@ public:
         return false;
     }
 
-    unsigned char *creatBase64DecBuffer(Memory &mem)
+    // Encode the data to out (4 characters for 3 bytes) without the allocated table, returns the number of characters.
+    // The URL safe characters are used and the pad characters are not added when url is true.
+    // The src can be at the end of out buffer (in place encoding), each 3 bytes are read before their 4 characters are written.
+    static size_t encodeChars(const uint8_t *src, size_t len, char *out, bool url)
     {
+        char *p = out;
+        for (; len >= 3; len -= 3, src += 3)
+        {
+            uint32_t v = (uint32_t)src[0] << 16 | (uint32_t)src[1] << 8 | src[2];
+            *p++ = encChar(v >> 18, url);
+            *p++ = encChar((v >> 12) & 0x3f, url);
+            *p++ = encChar((v >> 6) & 0x3f, url);
+            *p++ = encChar(v & 0x3f, url);
+        }
 
-        unsigned char *base64DecBuf = reinterpret_cast<unsigned char *>(mem.alloc(256, false));
-        memset(base64DecBuf, 0x80, 256);
-        for (size_t i = 0; i < sizeof(firebase_base64_table) - 1; i++)
-            base64DecBuf[firebase_base64_table[i]] = (unsigned char)i;
-        base64DecBuf['='] = 0;
-        return base64DecBuf;
+        if (len > 0)
+        {
+            uint32_t v = (uint32_t)src[0] << 16 | (len > 1 ? (uint32_t)src[1] << 8 : 0);
+            *p++ = encChar(v >> 18, url);
+            *p++ = encChar((v >> 12) & 0x3f, url);
+            if (len > 1)
+                *p++ = encChar((v >> 6) & 0x3f, url);
+            else if (!url)
+                *p++ = '=';
+            if (!url)
+                *p++ = '=';
+        }
+        return p - out;
     }
 
     template <typename T = uint8_t>
@@ -177,86 +286,6 @@ public:
         return true;
     }
 
-    template <typename T>
-    bool decode(Memory &mem, unsigned char *base64DecBuf, const char *src, size_t len, firebase_base64_io_t<T> &out)
-    {
-        // the maximum chunk size that writes to output is limited by out.bufLen, the minimum is depending on the source length
-        bool ret = false;
-        unsigned char *block = reinterpret_cast<unsigned char *>(mem.alloc(4, false));
-        unsigned char temp;
-        size_t i, count;
-        int pad = 0;
-        size_t extra_pad;
-        T *pos = out.outT ? (T *)&out.outT[0] : nullptr;
-        if (len == 0)
-            len = strlen(src);
-
-        count = 0;
-
-        for (i = 0; i < len; i++)
-        {
-            if ((uint8_t)base64DecBuf[(uint8_t)src[i]] != 0x80)
-                count++;
-        }
-
-        if (count == 0)
-            goto skip;
-
-        extra_pad = (4 - count % 4) % 4;
-        count = 0;
-        for (i = 0; i < len + extra_pad; i++)
-        {
-            unsigned char val;
-
-            if (i >= len)
-                val = '=';
-            else
-                val = src[i];
-
-            temp = base64DecBuf[val];
-
-            if (temp == 0x80)
-                continue;
-
-            if (val == '=')
-                pad++;
-
-            block[count] = temp;
-            count++;
-            if (count == 4)
-            {
-
-                setOutput((block[0] << 2) | (block[1] >> 4), out, &pos);
-
-                count = 0;
-                if (pad)
-                {
-                    if (pad == 1)
-                        setOutput((block[1] << 4) | (block[2] >> 2), out, &pos);
-                    else if (pad > 2)
-                        goto skip;
-
-                    break;
-                }
-                else
-                {
-                    setOutput((block[1] << 4) | (block[2] >> 2), out, &pos);
-                    setOutput((block[2] << 6) | block[3], out, &pos);
-                }
-            }
-        }
-
-        // write remaining
-        if (out.bufWrite > 0 && !writeOutput(out))
-            goto skip;
-
-        ret = true;
-
-    skip:
-        mem.release(&block);
-        return ret;
-    }
-
     template <typename T>
     bool encodeLast(unsigned char *base64EncBuf, const unsigned char *in, size_t len, firebase_base64_io_t<T> &out, T **pos)
     {
@@ -321,70 +350,59 @@ public:
 #if defined(ENABLE_FS)
     bool decodeToFile(Memory &mem, FILEOBJ file, const char *src)
     {
-        firebase_base64_io_t<uint8_t> out;
-        out.file = file;
-        uint8_t *buf = reinterpret_cast<uint8_t *>(mem.alloc(out.bufLen));
-        out.outT = buf;
-        unsigned char *base64DecBuf = creatBase64DecBuffer(mem);
-        bool ret = decode<uint8_t>(mem, base64DecBuf, src, strlen(src), out);
+        size_t len = strlen(src), written = 0;
+        uint8_t *buf = reinterpret_cast<uint8_t *>(mem.alloc(1024, false, mem_class_file));
+        bool ret = buf != nullptr;
+        Base64Decoder dec;
+        while (ret && len > 0)
+        {
+            size_t n = dec.decode((const uint8_t *)src, len, buf, 1024, written);
+            ret = n > 0 && file.write(buf, written) == written;
+            src += n;
+            len -= n;
+        }
         mem.release(&buf);
-        mem.release(&base64DecBuf);
         return ret;
     }
 #endif
     bool decodeToBlob(Memory &mem, firebase_blob_writer *bWriter, const char *src)
     {
-        firebase_base64_io_t<uint8_t> out;
-        out.outB = bWriter;
-        uint8_t *buf = reinterpret_cast<uint8_t *>(mem.alloc(out.bufLen));
-        out.outT = buf;
-        unsigned char *base64DecBuf = creatBase64DecBuffer(mem);
-        bool ret = decode<uint8_t>(mem, base64DecBuf, src, strlen(src), out);
-        mem.release(&buf);
-        mem.release(&base64DecBuf);
-        return ret;
+        (void)mem;
+        size_t len = strlen(src), written = 0;
+        uint8_t buf[64];
+        Base64Decoder dec;
+        while (len > 0)
+        {
+            size_t n = dec.decode((const uint8_t *)src, len, buf, sizeof(buf), written);
+            if (n == 0 || bWriter->write(buf, written) != written)
+                return false;
+            src += n;
+            len -= n;
+        }
+        return true;
     }
 
     void encodeUrl(Memory &mem, char *encoded, unsigned char *string, size_t len)
     {
-        size_t i;
-        char *p = encoded;
-        unsigned char *base64EncBuf = creatBase64EncBuffer(mem, true);
-
-        for (i = 0; i < len - 2; i += 3)
-        {
-            *p++ = base64EncBuf[(string[i] >> 2) & 0x3F];
-            *p++ = base64EncBuf[((string[i] & 0x3) << 4) | ((int)(string[i + 1] & 0xF0) >> 4)];
-            *p++ = base64EncBuf[((string[i + 1] & 0xF) << 2) | ((int)(string[i + 2] & 0xC0) >> 6)];
-            *p++ = base64EncBuf[string[i + 2] & 0x3F];
-        }
-
-        if (i < len)
-        {
-            *p++ = base64EncBuf[(string[i] >> 2) & 0x3F];
-            if (i == (len - 1))
-                *p++ = base64EncBuf[((string[i] & 0x3) << 4)];
-            else
-            {
-                *p++ = base64EncBuf[((string[i] & 0x3) << 4) | ((int)(string[i + 1] & 0xF0) >> 4)];
-                *p++ = base64EncBuf[((string[i + 1] & 0xF) << 2)];
-            }
-        }
-
-        *p++ = '\0';
-        mem.release(&base64EncBuf);
+        (void)mem;
+        encoded[encodeChars(string, len, encoded, true)] = '\0';
     }
 
-    char *encodeToChars(Memory &mem, uint8_t *src, size_t len)
+    char *encodeToChars(Memory &mem, const uint8_t *src, size_t len)
     {
-        char *encoded = reinterpret_cast<char *>(mem.alloc(encodedLength(len) + 1));
-        firebase_base64_io_t<char> out;
-        out.outT = encoded;
-        unsigned char *base64EncBuf = creatBase64EncBuffer(mem, false);
-        encode<char>(base64EncBuf, (uint8_t *)src, len, out);
-        mem.release(&base64EncBuf);
+        char *encoded = reinterpret_cast<char *>(mem.alloc(encodedLength(len) + 1, false));
+        if (encoded)
+            encoded[encodeChars(src, len, encoded, false)] = '\0';
         return encoded;
     }
+
+private:
+    static char encChar(uint8_t v, bool url)
+    {
+        if (url && v >= 62)
+            return v == 62 ? '-' : '_';
+        return pgm_read_byte(firebase_base64_table + v);
+    }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,307 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CORE_CLIENT_SCHEDULER_H
+#define CORE_CLIENT_SCHEDULER_H
+
+#include <Arduino.h>
+#include "./Config.h"
+#include "./core/AsyncClient/AsyncClient.h"
+
+#if defined(ESP32) && !defined(FIREBASE_DISABLE_CLIENT_SCHEDULER)
+#define FIREBASE_CLIENT_SCHEDULER
+#endif
+
+#if defined(FIREBASE_CLIENT_SCHEDULER)
+
+#include <atomic>
+
+// The numbers of async clients that can be added to the client scheduler.
+#if !defined(FIREBASE_CLIENT_SCHEDULER_CLIENT_LIMIT)
+#define FIREBASE_CLIENT_SCHEDULER_CLIENT_LIMIT 8
+#endif
+
+// The numbers of worker tasks of the client scheduler.
+#if !defined(FIREBASE_CLIENT_SCHEDULER_WORKER_LIMIT)
+#define FIREBASE_CLIENT_SCHEDULER_WORKER_LIMIT 4
+#endif
+
+// The stack size of each worker task of the client scheduler.
+#if !defined(FIREBASE_CLIENT_SCHEDULER_STACK_SIZE)
+#define FIREBASE_CLIENT_SCHEDULER_STACK_SIZE 8192
+#endif
+
+// The numbers of loop functions that are called by the worker tasks of the client scheduler.
+#if !defined(FIREBASE_CLIENT_SCHEDULER_LOOP_LIMIT)
+#define FIREBASE_CLIENT_SCHEDULER_LOOP_LIMIT 8
+#endif
+
+// The maximum time in ms that the worker task of the client scheduler waits when its clients are idle.
+#if !defined(FIREBASE_CLIENT_SCHEDULER_IDLE_MS)
+#define FIREBASE_CLIENT_SCHEDULER_IDLE_MS 2
+#endif
+
+typedef void (*ClientSchedulerLoop)(void *arg);
+
+// The scheduler of many async clients that are processed by the pool of FreeRTOS tasks on both cores (ESP32).
+// Each client is owned by one worker task, the worker that has no pending tasks in its clients steals (processes)
+// the clients with pending tasks that were not processed by their owner, then one client that is busy in the long
+// read does not hold the other clients.
+// The async tasks of the added clients are not processed by the loop functions of apps and services, their loop
+// functions are still required (or added with addLoop) to handle the service queues.
+// The async result callbacks are called from the worker tasks.
+class ClientScheduler
+{
+public:
+    ClientScheduler() {}
+    ~ClientScheduler() { end(); }
+
+    /**
+     * Add the async client that is processed by the worker tasks.
+     * This should be called before begin.
+     *
+     * @param client The async client.
+     * @return boolean The client was added.
+     */
+    bool addClient(AsyncClientClass &client)
+    {
+        if (worker_count || client_count >= FIREBASE_CLIENT_SCHEDULER_CLIENT_LIMIT)
+            return false;
+        clients[client_count++].client = &client;
+        return true;
+    }
+
+    /**
+     * Add the object that its loop function is called by one of the worker tasks at a time e.g. FirebaseApp or the
+     * service apps. This should be called before begin.
+     *
+     * @param obj The object that provides the loop function.
+     * @return boolean The object was added.
+     */
+    template <typename T>
+    bool addLoop(T &obj)
+    {
+        return addLoop([](void *arg)
+                       { static_cast<T *>(arg)->loop(); }, &obj);
+    }
+
+    bool addLoop(ClientSchedulerLoop fn, void *arg)
+    {
+        if (worker_count || !fn || loop_count >= FIREBASE_CLIENT_SCHEDULER_LOOP_LIMIT)
+            return false;
+        loops[loop_count].fn = fn;
+        loops[loop_count].arg = arg;
+        loop_count++;
+        return true;
+    }
+
+    /**
+     * Start the worker tasks, the tasks are pinned to core 0 and 1 in turn.
+     *
+     * @param workers The numbers of worker tasks (1 to FIREBASE_CLIENT_SCHEDULER_WORKER_LIMIT).
+     * @param priority The task priority.
+     * @return boolean The worker tasks were started.
+     */
+    bool begin(uint8_t workers = 2, UBaseType_t priority = 1)
+    {
+        if (worker_count)
+            return true;
+
+        if (workers == 0)
+            workers = 1;
+        if (workers > FIREBASE_CLIENT_SCHEDULER_WORKER_LIMIT)
+            workers = FIREBASE_CLIENT_SCHEDULER_WORKER_LIMIT;
+
+        for (uint8_t i = 0; i < client_count; i++)
+            clients[i].client->scheduled = true;
+
+        stopping = false;
+        for (uint8_t i = 0; i < workers; i++)
+        {
+            worker_t &w = this->workers[i];
+            w.scheduler = this;
+            w.index = i;
+            w.running = true;
+            if (xTaskCreatePinnedToCore(workerTask, "firebase_sched", FIREBASE_CLIENT_SCHEDULER_STACK_SIZE, &w, priority, &w.task, i % 2) != pdPASS)
+            {
+                w.task = NULL;
+                w.running = false;
+                break;
+            }
+            worker_count++;
+        }
+
+        if (worker_count == 0)
+        {
+            for (uint8_t i = 0; i < client_count; i++)
+                clients[i].client->scheduled = false;
+            return false;
+        }
+
+        // The clients are owned by the worker tasks in turn.
+        for (uint8_t i = 0; i < client_count; i++)
+            clients[i].owner = i % worker_count;
+        return true;
+    }
+
+    // Stop the worker tasks after their current round, the clients are processed by the loop functions again.
+    void end()
+    {
+        if (!worker_count)
+            return;
+        stopping = true;
+        for (uint8_t i = 0; i < worker_count; i++)
+        {
+            if (workers[i].task)
+                xTaskNotifyGive(workers[i].task);
+        }
+        for (uint8_t i = 0; i < worker_count; i++)
+        {
+            while (workers[i].running)
+                vTaskDelay(1);
+            workers[i].task = NULL;
+        }
+        worker_count = 0;
+        for (uint8_t i = 0; i < client_count; i++)
+            clients[i].client->scheduled = false;
+    }
+
+    // Wake up the worker tasks e.g. from the wakeup callback of async client when the task was added.
+    void notify()
+    {
+        for (uint8_t i = 0; i < worker_count; i++)
+        {
+            if (workers[i].task)
+                xTaskNotifyGive(workers[i].task);
+        }
+    }
+
+    bool isRunning() const { return worker_count > 0; }
+
+    // The numbers of processing of the clients that were stolen from the other worker tasks.
+    uint32_t stealCount() const { return steals.load(std::memory_order_relaxed); }
+
+private:
+    struct client_t
+    {
+        AsyncClientClass *client = nullptr;
+        uint8_t owner = 0;
+        // The client is being processed by one of the worker tasks.
+        std::atomic<bool> busy{false};
+    };
+
+    struct worker_t
+    {
+        ClientScheduler *scheduler = nullptr;
+        uint8_t index = 0;
+        TaskHandle_t task = NULL;
+        volatile bool running = false;
+    };
+
+    client_t clients[FIREBASE_CLIENT_SCHEDULER_CLIENT_LIMIT];
+    uint8_t client_count = 0;
+    worker_t workers[FIREBASE_CLIENT_SCHEDULER_WORKER_LIMIT];
+    uint8_t worker_count = 0;
+    struct loop_t
+    {
+        ClientSchedulerLoop fn = NULL;
+        void *arg = nullptr;
+    };
+
+    loop_t loops[FIREBASE_CLIENT_SCHEDULER_LOOP_LIMIT];
+    uint8_t loop_count = 0;
+    std::atomic<bool> loop_busy{false};
+    std::atomic<uint32_t> steals{0};
+    volatile bool stopping = false;
+
+    // Process the client when it was not processed by the other worker task, returns true when it has the tasks.
+    bool run(client_t &c, bool &claimed)
+    {
+        bool expected = false;
+        claimed = c.busy.compare_exchange_strong(expected, true, std::memory_order_acquire);
+        if (!claimed)
+            return false;
+        c.client->processImpl(true);
+        c.client->notifyDone();
+        c.client->handleRemove();
+        bool pending = c.client->slotCount() > 0;
+        c.busy.store(false, std::memory_order_release);
+        return pending;
+    }
+
+    // One round of worker task, returns true when there are pending tasks.
+    bool round(uint8_t index)
+    {
+        bool pending = false, claimed = false;
+        for (uint8_t i = 0; i < client_count; i++)
+        {
+            if (clients[i].owner == index && run(clients[i], claimed))
+                pending = true;
+        }
+
+        // The clients of the other workers that have the pending tasks are stolen when the own clients are idle.
+        // The slot count is read without the lock of client as a hint.
+        if (!pending)
+        {
+            for (uint8_t i = 0; i < client_count; i++)
+            {
+                client_t &c = clients[(index + 1 + i) % client_count];
+                if (c.owner == index || c.client->slotCount() == 0 || c.busy.load(std::memory_order_relaxed))
+                    continue;
+                if (run(c, claimed))
+                    pending = true;
+                if (claimed)
+                    steals.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        bool expected = false;
+        if (loop_count && loop_busy.compare_exchange_strong(expected, true, std::memory_order_acquire))
+        {
+            for (uint8_t i = 0; i < loop_count; i++)
+                loops[i].fn(loops[i].arg);
+            loop_busy.store(false, std::memory_order_release);
+        }
+        return pending;
+    }
+
+    static void workerTask(void *arg)
+    {
+        worker_t *w = reinterpret_cast<worker_t *>(arg);
+        ClientScheduler *scheduler = w->scheduler;
+        while (!scheduler->stopping)
+        {
+            // The worker with pending tasks waits one tick to let the lower priority tasks run.
+            bool pending = scheduler->round(w->index);
+            ulTaskNotifyTake(pdTRUE, pending ? 1 : pdMS_TO_TICKS(FIREBASE_CLIENT_SCHEDULER_IDLE_MS));
+        }
+        w->running = false;
+        vTaskDelete(NULL);
+    }
+};
+
+#endif
+
+#endif
@@ -0,0 +1,180 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_DNS_CACHE_H
+#define CORE_DNS_CACHE_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include "./Config.h"
+#include "./core/FNV.h"
+#include "./core/AsyncClient/RequestHandler.h"
+
+// The maximum number of hosts that their addresses are kept.
+#if !defined(FIREBASE_DNS_CACHE_SIZE)
+#define FIREBASE_DNS_CACHE_SIZE 4
+#endif
+
+// The default time to live of the cached address when the resolver does not provide it.
+#if !defined(FIREBASE_DNS_CACHE_TTL_SEC)
+#define FIREBASE_DNS_CACHE_TTL_SEC 300
+#endif
+
+// The callback that resolves the host name to address, the ttl_sec is the default TTL that can be set to the TTL of record.
+typedef bool (*DNSResolveCallback)(const char *host, IPAddress &ip, uint32_t &ttl_sec);
+
+// The callback that assigns the address of host to the SSL client before connecting by host name (e.g. ESP_SSLClient::setHostIP).
+typedef void (*DNSAddressSetter)(Client *client, const IPAddress &ip);
+
+// The least recently used cache of host addresses, the address is removed when it was expired or the connection to it was failed.
+class DNSCache
+{
+public:
+    DNSCache() {}
+
+    void setResolver(DNSResolveCallback cb) { resolver = cb; }
+
+    // Assign the SSL client that connects to the cached address.
+    bool addClient(Client *client, DNSAddressSetter setter)
+    {
+        if (!client || !setter)
+            return false;
+
+        for (uint8_t i = 0; i < client_count; i++)
+        {
+            if (clients[i].client == client)
+            {
+                clients[i].setter = setter;
+                return true;
+            }
+        }
+
+        if (client_count >= FIREBASE_ASYNC_CONNECTION_POOL_LIMIT)
+            return false;
+        clients[client_count].client = client;
+        clients[client_count++].setter = setter;
+        return true;
+    }
+
+    // Assign the cached or resolved address of host to the client before connecting, returns the entry index or -1 when the host name is used.
+    int select(Client *client, const char *host)
+    {
+        DNSAddressSetter setter = nullptr;
+        for (uint8_t i = 0; i < client_count && !setter; i++)
+        {
+            if (clients[i].client == client)
+                setter = clients[i].setter;
+        }
+
+        if (!setter || !resolver || !host || isAddress(host))
+            return -1;
+
+        uint32_t k = key(host);
+        int index = 0;
+        for (int i = 0; i < FIREBASE_DNS_CACHE_SIZE; i++)
+        {
+            if (entries[i].key == k)
+            {
+                index = i;
+                break;
+            }
+            if (entries[i].used < entries[index].used)
+                index = i;
+        }
+
+        entry_t &e = entries[index];
+        if (e.key != k || millis() - e.resolved_ms >= e.ttl_sec * 1000)
+        {
+            uint32_t ttl = FIREBASE_DNS_CACHE_TTL_SEC;
+            IPAddress ip;
+            if (!resolver(host, ip, ttl) || ttl == 0)
+            {
+                e.key = 0;
+                return -1;
+            }
+            e.key = k;
+            e.ip = ip;
+            e.ttl_sec = ttl;
+            e.resolved_ms = millis();
+        }
+        e.used = ++counter;
+
+        setter(client, e.ip);
+        return index;
+    }
+
+    // The connection to the address of entry was failed, the host is resolved again in the next connection.
+    void invalidate(int index)
+    {
+        if (index >= 0 && index < FIREBASE_DNS_CACHE_SIZE)
+            entries[index].key = 0;
+    }
+
+    void clear()
+    {
+        for (int i = 0; i < FIREBASE_DNS_CACHE_SIZE; i++)
+            entries[i].key = 0;
+    }
+
+private:
+    struct entry_t
+    {
+        uint32_t key = 0;
+        IPAddress ip;
+        uint32_t ttl_sec = 0;
+        uint32_t resolved_ms = 0;
+        uint32_t used = 0;
+    };
+
+    struct client_t
+    {
+        Client *client = nullptr;
+        DNSAddressSetter setter = nullptr;
+    };
+
+    entry_t entries[FIREBASE_DNS_CACHE_SIZE];
+    client_t clients[FIREBASE_ASYNC_CONNECTION_POOL_LIMIT];
+    uint8_t client_count = 0;
+    uint32_t counter = 0;
+    DNSResolveCallback resolver = NULL;
+
+    // The FNV-1a hash of host name, zero is the empty entry.
+    static uint32_t key(const char *host)
+    {
+        return FNV1a::key(FNV1a::hashString(host, true));
+    }
+
+    // The dotted IPv4 address is connected as is.
+    static bool isAddress(const char *host)
+    {
+        for (; *host; host++)
+        {
+            if (*host != '.' && (*host < '0' || *host > '9'))
+                return false;
+        }
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,295 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_DEFLATE_H
+#define CORE_DEFLATE_H
+
+#include <Arduino.h>
+#include "./Config.h"
+#include "./core/Memory.h"
+
+// The hash table size (2^bits entries) of the match finder of deflate, the larger table finds more matches.
+#if !defined(FIREBASE_DEFLATE_HASH_BITS)
+#define FIREBASE_DEFLATE_HASH_BITS 9
+#endif
+
+// The minimum size in bytes of request payload that is compressed (AsyncClientClass::setRequestGzip).
+#if !defined(FIREBASE_DEFLATE_MIN_SIZE)
+#define FIREBASE_DEFLATE_MIN_SIZE 1024
+#endif
+
+// The streaming gzip (RFC 1952) encoder of the data in memory with one fixed Huffman deflate (RFC 1951) block.
+// The compressed data are read in any pieces, the source data are used as the LZ77 window and only the hash table is allocated.
+// The output is the same for the same data, then the compressed size can be computed before the data are read.
+class GzipDeflate
+{
+public:
+    GzipDeflate() {}
+
+    ~GzipDeflate()
+    {
+        Memory mem;
+        mem.release(&table);
+    }
+
+    // Start the compression of data, the data should be kept until all compressed data were read.
+    bool begin(const uint8_t *data, size_t len)
+    {
+        Memory mem;
+        if (!table)
+            table = reinterpret_cast<uint32_t *>(mem.alloc(sizeof(uint32_t) << FIREBASE_DEFLATE_HASH_BITS, false, mem_class_chunk));
+        if (table)
+            memset(table, 0, sizeof(uint32_t) << FIREBASE_DEFLATE_HASH_BITS);
+        src = data;
+        src_len = len;
+        pos = 0;
+        crc = 0xFFFFFFFF;
+        bitbuf = 0;
+        bitcnt = 0;
+        pend_len = pend_pos = 0;
+        phase = table ? phase_header : phase_done;
+        return table != nullptr;
+    }
+
+    // Read up to size bytes of compressed data, returns the numbers of bytes that were read, 0 when all data were read.
+    size_t read(uint8_t *out, size_t size)
+    {
+        size_t n = 0;
+        while (n < size)
+        {
+            if (pend_pos < pend_len)
+            {
+                size_t k = (size_t)(pend_len - pend_pos) < size - n ? pend_len - pend_pos : size - n;
+                memcpy(out + n, pend + pend_pos, k);
+                pend_pos += k;
+                n += k;
+                continue;
+            }
+            pend_len = pend_pos = 0;
+            if (!step())
+                break;
+        }
+        return n;
+    }
+
+    // Returns the size of compressed data, the compression is started again.
+    size_t length()
+    {
+        uint8_t buf[32];
+        size_t total = 0, n = 0;
+        begin(src, src_len);
+        while ((n = read(buf, sizeof(buf))) > 0)
+            total += n;
+        begin(src, src_len);
+        return total;
+    }
+
+    bool done() const { return phase == phase_done && pend_pos == pend_len; }
+
+    // Release the hash table, the compression can be started again by begin.
+    void end()
+    {
+        Memory mem;
+        mem.release(&table);
+        phase = phase_done;
+    }
+
+private:
+    enum deflate_phase
+    {
+        phase_header,
+        phase_data,
+        phase_trailer,
+        phase_done
+    };
+
+    const uint8_t *src = nullptr;
+    size_t src_len = 0, pos = 0;
+    uint32_t *table = nullptr;
+    uint32_t crc = 0xFFFFFFFF, bitbuf = 0;
+    uint8_t bitcnt = 0;
+    // The whole bytes of the last symbol that were not read.
+    uint8_t pend[16];
+    uint8_t pend_len = 0, pend_pos = 0;
+    deflate_phase phase = phase_done;
+
+    void put(uint8_t b) { pend[pend_len++] = b; }
+
+    // Append the bits (up to 16) in LSB first order.
+    void putBits(uint32_t v, uint8_t n)
+    {
+        bitbuf |= v << bitcnt;
+        bitcnt += n;
+        while (bitcnt >= 8)
+        {
+            put(bitbuf & 0xff);
+            bitbuf >>= 8;
+            bitcnt -= 8;
+        }
+    }
+
+    // The Huffman code is written from its most significant bit.
+    void putCode(uint16_t code, uint8_t n)
+    {
+        uint16_t rev = 0;
+        for (uint8_t i = 0; i < n; i++)
+            rev |= ((code >> i) & 1) << (n - 1 - i);
+        putBits(rev, n);
+    }
+
+    // The fixed Huffman code of literal/length symbol.
+    void putSymbol(uint16_t sym)
+    {
+        if (sym < 144)
+            putCode(0x30 + sym, 8);
+        else if (sym < 256)
+            putCode(0x190 + sym - 144, 9);
+        else if (sym < 280)
+            putCode(sym - 256, 7);
+        else
+            putCode(0xC0 + sym - 280, 8);
+    }
+
+    void putMatch(uint16_t len, uint16_t dist)
+    {
+        static const uint16_t len_base[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static const uint8_t len_extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        static const uint16_t dist_base[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+        static const uint8_t dist_extra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+        uint8_t i = 28;
+        while (len_base[i] > len)
+            i--;
+        putSymbol(257 + i);
+        if (len_extra[i])
+            putBits(len - len_base[i], len_extra[i]);
+
+        uint8_t d = 29;
+        while (dist_base[d] > dist)
+            d--;
+        putCode(d, 5);
+        if (dist_extra[d])
+            putBits(dist - dist_base[d], dist_extra[d]);
+    }
+
+    void update(const uint8_t *p, size_t n)
+    {
+        static const uint32_t crc_table[16] = {0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+                                               0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+        for (size_t i = 0; i < n; i++)
+        {
+            crc ^= p[i];
+            crc = (crc >> 4) ^ crc_table[crc & 15];
+            crc = (crc >> 4) ^ crc_table[crc & 15];
+        }
+    }
+
+    uint32_t hash(size_t p) const
+    {
+        uint32_t v = ((uint32_t)src[p] << 16) | ((uint32_t)src[p + 1] << 8) | src[p + 2];
+        return (uint32_t)(v * 2654435761UL) >> (32 - FIREBASE_DEFLATE_HASH_BITS);
+    }
+
+    // The table keeps the last position + 1 of each hash, 0 is empty.
+    void insert(size_t p)
+    {
+        if (p + 2 < src_len)
+            table[hash(p)] = p + 1;
+    }
+
+    // Encode the next header, symbol or trailer, returns false when all data were encoded.
+    bool step()
+    {
+        if (phase == phase_header)
+        {
+            static const uint8_t header[10] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff};
+            memcpy(pend, header, sizeof(header));
+            pend_len = sizeof(header);
+            // The final block with fixed Huffman codes.
+            putBits(1, 1);
+            putBits(1, 2);
+            phase = phase_data;
+            return true;
+        }
+
+        if (phase == phase_data)
+        {
+            if (pos >= src_len)
+            {
+                putSymbol(256);
+                if (bitcnt)
+                    putBits(0, 8 - bitcnt);
+                phase = phase_trailer;
+                return true;
+            }
+
+            uint16_t len = 0;
+            size_t dist = 0;
+            if (pos + 2 < src_len)
+            {
+                uint32_t h = hash(pos), cand = table[h];
+                table[h] = pos + 1;
+                dist = cand ? pos - (cand - 1) : 0;
+                if (dist > 0 && dist <= 32768)
+                {
+                    size_t max = src_len - pos < 258 ? src_len - pos : 258;
+                    const uint8_t *a = src + pos, *b = a - dist;
+                    while (len < max && a[len] == b[len])
+                        len++;
+                }
+            }
+
+            if (len >= 3)
+            {
+                putMatch(len, dist);
+                update(src + pos, len);
+                for (size_t i = 1; i < len; i++)
+                    insert(pos + i);
+                pos += len;
+            }
+            else
+            {
+                putSymbol(src[pos]);
+                update(src + pos, 1);
+                pos++;
+            }
+            return true;
+        }
+
+        if (phase == phase_trailer)
+        {
+            uint32_t v = crc ^ 0xFFFFFFFF;
+            for (uint8_t i = 0; i < 4; i++)
+                put(v >> (8 * i));
+            for (uint8_t i = 0; i < 4; i++)
+                put((uint32_t)src_len >> (8 * i));
+            phase = phase_done;
+            return true;
+        }
+
+        return false;
+    }
+};
+
+#endif
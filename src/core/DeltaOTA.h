@@ -0,0 +1,317 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_DELTA_OTA_H
+#define CORE_DELTA_OTA_H
+
+#include <Arduino.h>
+#include "./Config.h"
+#include "./core/Memory.h"
+#include "./core/FileConfig.h"
+#include "./core/Base64.h"
+#include "./core/Inflate.h"
+#include "./core/Error.h"
+
+#if defined(OTA_UPDATE_ENABLED) && defined(ESP32)
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#define FIREBASE_DELTA_OTA_SOURCE
+#endif
+
+// The size of buffer that the running firmware is read for applying the patch.
+#if !defined(FIREBASE_DELTA_OTA_BUFFER_SIZE)
+#define FIREBASE_DELTA_OTA_BUFFER_SIZE 256
+#endif
+
+// The window size (2^bits bytes) of inflate for the compressed firmware, the firmware should be compressed with the same or smaller window.
+#if !defined(FIREBASE_OTA_INFLATE_WINDOW_BITS)
+#define FIREBASE_OTA_INFLATE_WINDOW_BITS FIREBASE_INFLATE_WINDOW_BITS
+#endif
+
+// The decoder of OTA firmware that is the full image or the delta patch against the running firmware, either of them can be gzip compressed.
+// The patch is the ENDSLEY/BSDIFF43 header and the (uncompressed) control, diff and extra data, its diff data are added to the running firmware (ESP32).
+// The update is started when the size of new firmware is known, the new firmware is written to the output (see OTAWriter) or to Update.
+class DeltaOTA : public Print
+{
+public:
+    enum delta_state
+    {
+        delta_state_detect,
+        delta_state_image,
+        delta_state_header,
+        delta_state_control,
+        delta_state_diff,
+        delta_state_extra,
+        delta_state_done,
+        delta_state_error
+    };
+
+    // The size is the firmware size of full image that was not compressed.
+    DeltaOTA(size_t size, Print *out) : fw_size(size), out(out) {}
+
+    ~DeltaOTA()
+    {
+        if (inflate)
+            delete inflate;
+        inflate = nullptr;
+    }
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+
+    size_t write(const uint8_t *data, size_t size) override
+    {
+        if (state == delta_state_error)
+            return 0;
+
+        // The gzip data is inflated before decoding.
+        if (!inflate && !received && size > 0 && data[0] == 0x1f)
+        {
+            inflate = new GzipInflate(FIREBASE_OTA_INFLATE_WINDOW_BITS);
+            if (!inflate->begin())
+                return fail(FIREBASE_ERROR_INFLATE);
+        }
+
+        received += size;
+
+        if (inflate)
+        {
+            inflated.clear();
+            if (!inflate->write(data, size, inflated))
+                return fail(FIREBASE_ERROR_INFLATE);
+            return decode(inflated.data(), inflated.size()) ? size : 0;
+        }
+
+        return decode(data, size) ? size : 0;
+    }
+
+    // The new firmware was written completely.
+    bool done() const { return (state == delta_state_done || (state == delta_state_image && new_pos > 0)) && (!inflate || inflate->done()); }
+
+    // The data are written as is, the firmware size of full image is used.
+    bool passthrough() const { return state == delta_state_image && !inflate; }
+
+    bool isPatch() const { return state >= delta_state_header && state <= delta_state_done; }
+
+    // The update of compressed full image was started without its size, the update size is the bytes written.
+    bool sizeUnknown() const { return state == delta_state_image && inflate; }
+
+    int16_t error() const { return code; }
+
+private:
+    size_t fw_size = 0;
+    Print *out = nullptr;
+    GzipInflate *inflate = nullptr;
+    // The inflated data of the last write, the buffer is reused.
+    std::vector<uint8_t> inflated;
+    delta_state state = delta_state_detect;
+    int16_t code = 0;
+    size_t received = 0;
+    // The header or control data that are being read.
+    uint8_t hdr[24];
+    uint8_t hdr_len = 0;
+    int64_t new_size = 0, new_pos = 0, old_pos = 0, old_size = 0;
+    int64_t diff_len = 0, extra_len = 0, seek = 0;
+#if defined(FIREBASE_DELTA_OTA_SOURCE)
+    const esp_partition_t *source = nullptr;
+#endif
+
+    size_t fail(int16_t err)
+    {
+        state = delta_state_error;
+        code = err;
+        return 0;
+    }
+
+    // The sign-magnitude 64-bit integer of bsdiff.
+    static int64_t offtin(const uint8_t *buf)
+    {
+        int64_t y = buf[7] & 0x7F;
+        for (int i = 6; i >= 0; i--)
+            y = y * 256 + buf[i];
+        return (buf[7] & 0x80) ? -y : y;
+    }
+
+    bool decode(const uint8_t *data, size_t len)
+    {
+        while (len > 0 && state != delta_state_error)
+        {
+            size_t n = 0;
+            switch (state)
+            {
+            case delta_state_detect:
+                if (data[0] == 'E')
+                    state = delta_state_header;
+                else if (!beginUpdate(inflate ? 0 : fw_size))
+                    return false;
+                else
+                    state = delta_state_image;
+                break;
+
+            case delta_state_image:
+                if (!output(data, len))
+                    return false;
+                new_pos += len;
+                n = len;
+                break;
+
+            case delta_state_header:
+            case delta_state_control:
+                n = sizeof(hdr) - hdr_len < len ? sizeof(hdr) - hdr_len : len;
+                memcpy(hdr + hdr_len, data, n);
+                hdr_len += n;
+                if (hdr_len == sizeof(hdr) && !parseHeader())
+                    return false;
+                break;
+
+            case delta_state_diff:
+            {
+                // The new data are the running firmware data plus the diff data.
+                uint8_t buf[FIREBASE_DELTA_OTA_BUFFER_SIZE];
+                n = (int64_t)len < diff_len ? len : (size_t)diff_len;
+                if (n > sizeof(buf))
+                    n = sizeof(buf);
+                if (!readSource(buf, n))
+                    return fail(FIREBASE_ERROR_FW_DELTA_PATCH);
+                for (size_t i = 0; i < n; i++)
+                    buf[i] += data[i];
+                if (!output(buf, n))
+                    return false;
+                old_pos += n;
+                new_pos += n;
+                diff_len -= n;
+                next();
+                break;
+            }
+
+            case delta_state_extra:
+                n = (int64_t)len < extra_len ? len : (size_t)extra_len;
+                if (!output(data, n))
+                    return false;
+                new_pos += n;
+                extra_len -= n;
+                next();
+                break;
+
+            default:
+                // The data after the new firmware are ignored.
+                n = len;
+                break;
+            }
+            data += n;
+            len -= n;
+        }
+        return state != delta_state_error;
+    }
+
+    bool parseHeader()
+    {
+        hdr_len = 0;
+        if (state == delta_state_header)
+        {
+            new_size = offtin(hdr + 16);
+            if (memcmp(hdr, "ENDSLEY/BSDIFF43", 16) != 0 || new_size <= 0)
+                return fail(FIREBASE_ERROR_FW_DELTA_PATCH);
+            if (!openSource())
+                return fail(FIREBASE_ERROR_FW_DELTA_PATCH);
+            if (!beginUpdate(new_size))
+                return false;
+            state = delta_state_control;
+            return true;
+        }
+
+        diff_len = offtin(hdr);
+        extra_len = offtin(hdr + 8);
+        seek = offtin(hdr + 16);
+        if (diff_len < 0 || extra_len < 0 || new_pos + diff_len + extra_len > new_size)
+            return fail(FIREBASE_ERROR_FW_DELTA_PATCH);
+        state = delta_state_diff;
+        next();
+        return true;
+    }
+
+    // The diff and extra data that are empty are skipped, the control of next block or all data were read.
+    void next()
+    {
+        if (state == delta_state_diff && diff_len == 0)
+            state = delta_state_extra;
+        if (state == delta_state_extra && extra_len == 0)
+        {
+            old_pos += seek;
+            state = new_pos < new_size ? delta_state_control : delta_state_done;
+        }
+    }
+
+    bool openSource()
+    {
+#if defined(FIREBASE_DELTA_OTA_SOURCE)
+        source = esp_ota_get_running_partition();
+        old_size = source ? source->size : 0;
+        return source != nullptr;
+#endif
+        return false;
+    }
+
+    // Read the running firmware data at old_pos, the data out of its range are zero.
+    bool readSource(uint8_t *buf, size_t n)
+    {
+        memset(buf, 0, n);
+        int64_t start = old_pos < 0 ? 0 : old_pos, end = old_pos + (int64_t)n > old_size ? old_size : old_pos + (int64_t)n;
+        if (end <= start)
+            return true;
+#if defined(FIREBASE_DELTA_OTA_SOURCE)
+        return esp_partition_read(source, start, buf + (start - old_pos), end - start) == ESP_OK;
+#endif
+        return false;
+    }
+
+    // The size is zero when it is unknown (compressed full image).
+    bool beginUpdate(size_t size)
+    {
+#if defined(OTA_UPDATE_ENABLED) && defined(ESP32)
+        if (!Update.begin(size > 0 ? size : UPDATE_SIZE_UNKNOWN))
+            return fail(FIREBASE_ERROR_FW_UPDATE_TOO_LOW_FREE_SKETCH_SPACE);
+#elif defined(OTA_UPDATE_ENABLED) && defined(ESP8266)
+        // The free sketch space is the maximum size of firmware.
+        if (size == 0)
+            size = (ESP.getFreeSketchSpace() - 0x1000) & 0xFFFFF000;
+        if (!Update.begin(size))
+            return fail(FIREBASE_ERROR_FW_UPDATE_TOO_LOW_FREE_SKETCH_SPACE);
+#elif defined(OTA_UPDATE_ENABLED) && defined(CORE_ARDUINO_PICO)
+        if (size == 0 || !Update.begin(size))
+            return fail(FIREBASE_ERROR_FW_UPDATE_TOO_LOW_FREE_SKETCH_SPACE);
+#else
+        (void)size;
+#endif
+        return true;
+    }
+
+    bool output(const uint8_t *data, size_t len)
+    {
+        if (out ? out->write(data, len) < len : !Base64Util().updateWrite(const_cast<uint8_t *>(data), len))
+            return fail(FIREBASE_ERROR_FW_UPDATE_WRITE_FAILED);
+        return true;
+    }
+};
+
+#endif
@@ -31,10 +31,13 @@
 
 /// HTTP codes see RFC7231
 #define FIREBASE_ERROR_HTTP_CODE_OK 200
+#define FIREBASE_ERROR_HTTP_CODE_CREATED 201
 #define FIREBASE_ERROR_HTTP_CODE_NON_AUTHORITATIVE_INFORMATION 203
 #define FIREBASE_ERROR_HTTP_CODE_NO_CONTENT 204
+#define FIREBASE_ERROR_HTTP_CODE_PARTIAL_CONTENT 206
 #define FIREBASE_ERROR_HTTP_CODE_MOVED_PERMANENTLY 301
 #define FIREBASE_ERROR_HTTP_CODE_FOUND 302
+#define FIREBASE_ERROR_HTTP_CODE_NOT_MODIFIED 304
 #define FIREBASE_ERROR_HTTP_CODE_USE_PROXY 305
 #define FIREBASE_ERROR_HTTP_CODE_TEMPORARY_REDIRECT 307
 #define FIREBASE_ERROR_HTTP_CODE_PERMANENT_REDIRECT 308
@@ -46,10 +49,13 @@
 #define FIREBASE_ERROR_HTTP_CODE_NOT_ACCEPTABLE 406
 #define FIREBASE_ERROR_HTTP_CODE_PROXY_AUTHENTICATION_REQUIRED 407
 #define FIREBASE_ERROR_HTTP_CODE_REQUEST_TIMEOUT 408
+#define FIREBASE_ERROR_HTTP_CODE_CONFLICT 409
+#define FIREBASE_ERROR_HTTP_CODE_GONE 410
 #define FIREBASE_ERROR_HTTP_CODE_LENGTH_REQUIRED 411
 #define FIREBASE_ERROR_HTTP_CODE_PRECONDITION_FAILED 412
 #define FIREBASE_ERROR_HTTP_CODE_PAYLOAD_TOO_LARGE 413
 #define FIREBASE_ERROR_HTTP_CODE_URI_TOO_LONG 414
+#define FIREBASE_ERROR_HTTP_CODE_RANGE_NOT_SATISFIABLE 416
 #define FIREBASE_ERROR_HTTP_CODE_MISDIRECTED_REQUEST 421
 #define FIREBASE_ERROR_HTTP_CODE_UNPROCESSABLE_ENTITY 422
 #define FIREBASE_ERROR_HTTP_CODE_TOO_MANY_REQUESTS 429
@@ -92,6 +98,13 @@
 #define FIREBASE_ERROR_OPERATION_CANCELLED -118
 #define FIREBASE_ERROR_TIME_IS_NOT_SET_OR_INVALID -119
 #define FIREBASE_ERROR_JWT_CREATION_REQUIRED -120
+#define FIREBASE_ERROR_HASH_MISMATCH -121
+#define FIREBASE_ERROR_INFLATE -122
+#define FIREBASE_ERROR_FW_DELTA_PATCH -123
+#define FIREBASE_ERROR_REQUEST_DEADLINE -124
+#define FIREBASE_ERROR_RESPONSE_TOO_LARGE -125
+#define FIREBASE_ERROR_RANGE_NOT_SUPPORTED -126
+#define FIREBASE_ERROR_INVALID_ARGUMENT -127
 
 #if !defined(FPSTR)
 #define FPSTR
@@ -126,113 +139,109 @@ private:
 
     void setResponseError(const String &message, int code)
     {
-        if (code == FIREBASE_ERROR_HTTP_CODE_PRECONDITION_FAILED)
-            err.message = FPSTR("precondition failed (ETag does not match)");
-        else if (code == FIREBASE_ERROR_HTTP_CODE_UNAUTHORIZED)
-            err.message = FPSTR("unauthorized");
-        else if (message.length())
-            err.message = message;
+        // The messages of status codes are formatted when message() was called.
+        if (code == FIREBASE_ERROR_HTTP_CODE_PRECONDITION_FAILED || code == FIREBASE_ERROR_HTTP_CODE_UNAUTHORIZED || message.length() == 0)
+            err.message.remove(0, err.message.length());
         else
-        {
-            err.message = FPSTR("HTTP Status ");
-            err.message += code;
-        }
+            err.message = message;
         err.code = code;
     }
 
     void setClientError(int code)
     {
+        err.message.remove(0, err.message.length());
         err.code = code;
-        if (code < 0)
+    }
+
+    // The message of error code is kept in flash and it is copied only when it was read.
+    String codeMessage(int code) const
+    {
+        if (code == FIREBASE_ERROR_HTTP_CODE_PRECONDITION_FAILED)
+            return FPSTR("precondition failed (ETag does not match)");
+        if (code == FIREBASE_ERROR_HTTP_CODE_UNAUTHORIZED)
+            return FPSTR("unauthorized");
+        if (code > 0)
+        {
+            String msg = FPSTR("HTTP Status ");
+            msg += code;
+            return msg;
+        }
+
+        switch (code)
         {
-            switch (code)
-            {
-            case FIREBASE_ERROR_TCP_CONNECTION:
-                err.message = FPSTR("TCP connection failed");
-                break;
-            case FIREBASE_ERROR_TCP_SEND:
-                err.message = FPSTR("TCP send failed");
-                break;
-            case FIREBASE_ERROR_TCP_RECEIVE_TIMEOUT:
-                err.message = FPSTR("TCP receive time out");
-                break;
-            case FIREBASE_ERROR_TCP_DISCONNECTED:
-                err.message = FPSTR("TCP disconnected");
-                break;
-            case FIREBASE_ERROR_TCP_CLIENT_UNDEFINED:
-                err.message = FPSTR("TCP client was undefined");
-                break;
-            case FIREBASE_ERROR_NETWORK_DISCONNECTED:
-                err.message = FPSTR("network disconnected");
-                break;
-            case FIREBASE_ERROR_NETWORK_CONNECTION_CALLBACK:
-                err.message = FPSTR("network connection callback was undefined");
-                break;
-            case FIREBASE_ERROR_NETWORK_STATUS_CALLBACK:
-                err.message = FPSTR("network status callback was undefined");
-                break;
-            case FIREBASE_ERROR_OPEN_FILE:
-                err.message = FPSTR("error opening file");
-                break;
-            case FIREBASE_ERROR_FILE_READ:
-                err.message = FPSTR("error reading file");
-                break;
-            case FIREBASE_ERROR_FILE_WRITE:
-                err.message = FPSTR("error writing file");
-                break;
-            case FIREBASE_ERROR_UNAUTHENTICATE:
-                err.message = FPSTR("unauthenticate");
-                break;
-            case FIREBASE_ERROR_SERVER_RESPONSE:
-                err.message = FPSTR("server responses ");
-                break;
-            case FIREBASE_ERROR_PATH_NOT_EXIST:
-                err.message = FPSTR("path does not exists");
-                break;
-            case FIREBASE_ERROR_MAX_REDIRECT_REACHED:
-                err.message = FPSTR("maximum redirection reaches");
-                break;
-            case FIREBASE_ERROR_TOKEN_PARSE_PK:
-                err.message = FPSTR("parse private key");
-                break;
-            case FIREBASE_ERROR_TOKEN_SIGN:
-                err.message = FPSTR("sign JWT token");
-                break;
-            case FIREBASE_ERROR_FW_UPDATE_TOO_LOW_FREE_SKETCH_SPACE:
-                err.message = FPSTR("too low sketch space");
-                break;
-            case FIREBASE_ERROR_FW_UPDATE_WRITE_FAILED:
-                err.message = FPSTR("firmware write failed");
-                break;
-            case FIREBASE_ERROR_FW_UPDATE_END_FAILED:
-                err.message = FPSTR("firmware end failed");
-                break;
-            case FIREBASE_ERROR_STREAM_TIMEOUT:
-                err.message = FPSTR("stream time out");
-                break;
-            case FIREBASE_ERROR_STREAM_AUTH_REVOKED:
-                err.message = FPSTR("auth revoked");
-                break;
-            case FIREBASE_ERROR_APP_WAS_NOT_ASSIGNED:
-                err.message = FPSTR("app was not assigned");
-                break;
-            case FIREBASE_ERROR_OPERATION_CANCELLED:
-                err.message = FPSTR("operation was cancelled");
-                break;
-            case FIREBASE_ERROR_TIME_IS_NOT_SET_OR_INVALID:
-                err.message = FPSTR("time was not set or not valid");
-                break;
-            default:
-                err.message = FPSTR("undefined");
-                break;
-            }
+        case FIREBASE_ERROR_TCP_CONNECTION:
+            return FPSTR("TCP connection failed");
+        case FIREBASE_ERROR_TCP_SEND:
+            return FPSTR("TCP send failed");
+        case FIREBASE_ERROR_TCP_RECEIVE_TIMEOUT:
+            return FPSTR("TCP receive time out");
+        case FIREBASE_ERROR_TCP_DISCONNECTED:
+            return FPSTR("TCP disconnected");
+        case FIREBASE_ERROR_TCP_CLIENT_UNDEFINED:
+            return FPSTR("TCP client was undefined");
+        case FIREBASE_ERROR_NETWORK_DISCONNECTED:
+            return FPSTR("network disconnected");
+        case FIREBASE_ERROR_NETWORK_CONNECTION_CALLBACK:
+            return FPSTR("network connection callback was undefined");
+        case FIREBASE_ERROR_NETWORK_STATUS_CALLBACK:
+            return FPSTR("network status callback was undefined");
+        case FIREBASE_ERROR_OPEN_FILE:
+            return FPSTR("error opening file");
+        case FIREBASE_ERROR_FILE_READ:
+            return FPSTR("error reading file");
+        case FIREBASE_ERROR_FILE_WRITE:
+            return FPSTR("error writing file");
+        case FIREBASE_ERROR_UNAUTHENTICATE:
+            return FPSTR("unauthenticate");
+        case FIREBASE_ERROR_SERVER_RESPONSE:
+            return FPSTR("server responses ");
+        case FIREBASE_ERROR_PATH_NOT_EXIST:
+            return FPSTR("path does not exists");
+        case FIREBASE_ERROR_MAX_REDIRECT_REACHED:
+            return FPSTR("maximum redirection reaches");
+        case FIREBASE_ERROR_TOKEN_PARSE_PK:
+            return FPSTR("parse private key");
+        case FIREBASE_ERROR_TOKEN_SIGN:
+            return FPSTR("sign JWT token");
+        case FIREBASE_ERROR_FW_UPDATE_TOO_LOW_FREE_SKETCH_SPACE:
+            return FPSTR("too low sketch space");
+        case FIREBASE_ERROR_FW_UPDATE_WRITE_FAILED:
+            return FPSTR("firmware write failed");
+        case FIREBASE_ERROR_FW_UPDATE_END_FAILED:
+            return FPSTR("firmware end failed");
+        case FIREBASE_ERROR_STREAM_TIMEOUT:
+            return FPSTR("stream time out");
+        case FIREBASE_ERROR_STREAM_AUTH_REVOKED:
+            return FPSTR("auth revoked");
+        case FIREBASE_ERROR_APP_WAS_NOT_ASSIGNED:
+            return FPSTR("app was not assigned");
+        case FIREBASE_ERROR_OPERATION_CANCELLED:
+            return FPSTR("operation was cancelled");
+        case FIREBASE_ERROR_TIME_IS_NOT_SET_OR_INVALID:
+            return FPSTR("time was not set or not valid");
+        case FIREBASE_ERROR_HASH_MISMATCH:
+            return FPSTR("hash mismatch");
+        case FIREBASE_ERROR_INFLATE:
+            return FPSTR("gzip payload inflate failed");
+        case FIREBASE_ERROR_FW_DELTA_PATCH:
+            return FPSTR("firmware delta patch is not valid");
+        case FIREBASE_ERROR_REQUEST_DEADLINE:
+            return FPSTR("request deadline exceeded");
+        case FIREBASE_ERROR_RESPONSE_TOO_LARGE:
+            return FPSTR("response payload exceeds the limit");
+        case FIREBASE_ERROR_RANGE_NOT_SUPPORTED:
+            return FPSTR("byte range request is not supported");
+        case FIREBASE_ERROR_INVALID_ARGUMENT:
+            return FPSTR("invalid argument");
+        default:
+            return FPSTR("undefined");
         }
     }
 
 public:
     FirebaseError() {}
     ~FirebaseError() {}
-    String message() const { return err.message; }
+    String message() const { return err.message.length() || err.code == 0 ? err.message : codeMessage(err.code); }
     int code() const { return err.code; }
     void setLastError(int code, const String &msg)
     {
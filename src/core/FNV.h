@@ -0,0 +1,57 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_FNV_H
+#define CORE_FNV_H
+
+#include <Arduino.h>
+
+// The 32-bit FNV-1a hash that is used for the lookup keys of caches and indexes.
+class FNV1a
+{
+public:
+    static const uint32_t offset_basis = 2166136261UL;
+
+    static uint32_t add(uint32_t h, uint8_t c) { return (h ^ c) * 16777619UL; }
+
+    static uint32_t hash(const char *data, size_t len, uint32_t h = offset_basis)
+    {
+        for (size_t i = 0; i < len; i++)
+            h = add(h, (uint8_t)data[i]);
+        return h;
+    }
+
+    // The hash of null terminated string, the letters are hashed in lower case when ignore_case is true.
+    static uint32_t hashString(const char *str, bool ignore_case = false, uint32_t h = offset_basis)
+    {
+        for (; str && *str; str++)
+            h = add(h, ignore_case ? (uint8_t)tolower(*str) : (uint8_t)*str);
+        return h;
+    }
+
+    // The non-zero hash for the key that zero is the empty entry.
+    static uint32_t key(uint32_t h) { return h ? h : 1; }
+};
+
+#endif
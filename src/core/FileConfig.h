@@ -28,6 +28,7 @@
 #include <Arduino.h>
 #include "./Config.h"
 #include "./core/Memory.h"
+#include "./core/JsonParser.h"
 
 #if defined(ENABLE_FS)
 #include <FS.h>
@@ -36,7 +37,11 @@
 
 #endif
 
-#define FIREBASE_CHUNK_SIZE 2048
+// The size of file block in bytes that is read ahead (or written behind) in the base64 file transfer.
+// It should be a multiple of 3 and of the SD card sector size, the read block is limited to 3/4 of FIREBASE_CHUNK_SIZE.
+#if !defined(FIREBASE_FILE_BLOCK_SIZE)
+#define FIREBASE_FILE_BLOCK_SIZE 1536
+#endif
 
 enum file_operating_mode
 {
@@ -50,11 +55,11 @@ struct firebase_blob_writer
 {
 public:
     firebase_blob_writer() {}
-    void init(uint8_t *data, size_t size)
+    void init(uint8_t *data, size_t size, size_t offset = 0)
     {
         this->data = data;
         this->size = size;
-        index = 0;
+        index = offset < size ? offset : size;
     }
 
     size_t curIndex() const { return index; }
@@ -78,12 +83,148 @@ private:
     uint32_t index = 0;
 };
 
+// The download progress that is kept for the range request resume of the same object and target.
+struct download_resume_state_t
+{
+public:
+    String target, etag;
+    // The bytes that were written to the target.
+    size_t offset = 0;
+    // The first byte of current request.
+    size_t start = 0;
+
+    // Returns true when the download can be resumed, the progress of other target is cleared.
+    bool begin(const String &target)
+    {
+        if (this->target != target)
+        {
+            clear();
+            this->target = target;
+        }
+        start = etag.length() ? offset : 0;
+        return start > 0;
+    }
+
+    void clear()
+    {
+        target.remove(0, target.length());
+        etag.remove(0, etag.length());
+        offset = 0;
+        start = 0;
+    }
+
+    // The target and ETag of the last complete download, nothing to resume.
+    String done_target, done_etag;
+
+    void complete()
+    {
+        done_target = target;
+        done_etag = etag;
+        clear();
+    }
+
+    // Clear the progress and the last complete download.
+    void reset()
+    {
+        clear();
+        done_target.remove(0, done_target.length());
+        done_etag.remove(0, done_etag.length());
+    }
+};
+
 #if defined(ENABLE_FS)
 typedef void (*FileConfigCallback)(FILEOBJ &file, const char *filename, file_operating_mode mode);
 #endif
 
+// The producer of upload data, fills the buffer with up to len bytes of data from index and returns the number of bytes,
+// 0 when there is no more data or negative for error.
+typedef int (*UploadSourceCallback)(uint8_t *buf, size_t len, size_t index);
+
+// The consumer of download data, takes up to len bytes of data at index and returns the number of bytes that were accepted,
+// 0 when it is full (the data is offered again later) or negative for error.
+typedef int (*DownloadSinkCallback)(const uint8_t *data, size_t len, size_t index);
+
 #if defined(ENABLE_FS) && defined(ENABLE_CLOUD_STORAGE)
 
+// The range size of resumable upload in units of 256 KB.
+#if !defined(FIREBASE_RESUMABLE_RANGE_UNITS)
+#define FIREBASE_RESUMABLE_RANGE_UNITS 1
+#endif
+
+// The maximum range size of adaptive resumable upload in units of 256 KB.
+#if !defined(FIREBASE_RESUMABLE_RANGE_MAX_UNITS)
+#define FIREBASE_RESUMABLE_RANGE_MAX_UNITS 32
+#endif
+
+// The target time in ms of each range of adaptive resumable upload.
+// The range that was sent in less than half of this time is doubled and the range that took more than twice of this time or failed is halved.
+#if !defined(FIREBASE_RESUMABLE_RANGE_TARGET_MS)
+#define FIREBASE_RESUMABLE_RANGE_TARGET_MS 5000
+#endif
+
+// The callback to save (save is true) or load (save is false) the persisted resumable upload session, returns true when success.
+typedef bool (*ResumableStoreCallback)(String &data, bool save);
+
+// The resumable upload session that is persisted to resume the upload of the same object and file after reboot.
+struct resumable_session_t
+{
+public:
+    ResumableStoreCallback cb = NULL;
+    // The identity of upload (bucket/object:file:size:crc32c) and the session URI.
+    String id, location;
+    // The bytes that were committed by server.
+    size_t offset = 0;
+
+    void save()
+    {
+        if (!cb || id.length() == 0)
+            return;
+        String data;
+        data.reserve(id.length() + location.length() + 48);
+        data = FPSTR("{\"id\":\"");
+        data += id;
+        data += FPSTR("\",\"location\":\"");
+        data += location;
+        data += FPSTR("\",\"offset\":");
+        data += offset;
+        data += '}';
+        cb(data, true);
+    }
+
+    // Returns true when the stored session belongs to this upload.
+    bool load(const String &id)
+    {
+        this->id = id;
+        location.remove(0, location.length());
+        offset = 0;
+        String data, val;
+        if (!cb || !cb(data, false) || !JsonPullParser::get(data, "id", val) || val != id || !JsonPullParser::get(data, "location", location))
+            return false;
+        if (JsonPullParser::get(data, "offset", val))
+            offset = strtoul(val.c_str(), nullptr, 10);
+        return location.length() > 0;
+    }
+
+    // The session was completed or expired, the stored data is removed.
+    void remove()
+    {
+        if (!cb || location.length() == 0)
+            return;
+        location.remove(0, location.length());
+        offset = 0;
+        String data;
+        cb(data, true);
+    }
+};
+
+// The range size that is kept between the resumable uploads.
+struct resumable_range_state_t
+{
+public:
+    uint8_t units = 0;
+    bool adaptive = false;
+};
+
 struct file_upload_resumable_data
 {
 private:
@@ -101,6 +242,31 @@ private:
     String location;
     int len = 0;
     resume_state state = resume_state_undefined;
+    resumable_range_state_t *range_state = nullptr;
+    uint8_t units = FIREBASE_RESUMABLE_RANGE_UNITS;
+    // The bytes of each write.
+    uint16_t slice = FIREBASE_CHUNK_SIZE;
+    unsigned long range_ms = 0;
+    resumable_session_t *session = nullptr;
+    // The bytes that were committed by server (the Range header of 308 response).
+    size_t committed = 0;
+    // The committed offset of persisted session is queried, and the next range is read from its offset.
+    bool query = false, seek = false;
+    // The range or query request was sent to the session URI, its 2xx response completes the upload.
+    bool session_request = false;
+
+    void adaptRange(bool failed)
+    {
+        if (!range_state || !range_state->adaptive)
+            return;
+
+        unsigned long ms = millis() - range_ms;
+        if (failed || ms > FIREBASE_RESUMABLE_RANGE_TARGET_MS * 2)
+            units = units > 1 ? units / 2 : 1;
+        else if (ms < FIREBASE_RESUMABLE_RANGE_TARGET_MS / 2 && read == units * 256 * 1024 && units < FIREBASE_RESUMABLE_RANGE_MAX_UNITS)
+            units = units * 2 < FIREBASE_RESUMABLE_RANGE_MAX_UNITS ? units * 2 : FIREBASE_RESUMABLE_RANGE_MAX_UNITS;
+        range_state->units = units;
+    }
 
 public:
     file_upload_resumable_data() {}
@@ -110,20 +276,88 @@ public:
         this->size = size;
         enable = size > 0;
     }
+    void setRange(resumable_range_state_t *state, uint16_t sliceSize, uint16_t chunk = FIREBASE_CHUNK_SIZE)
+    {
+        range_state = state;
+        units = state && state->units ? state->units : FIREBASE_RESUMABLE_RANGE_UNITS;
+        slice = sliceSize ? sliceSize : chunk;
+    }
     void getRange()
     {
-        int minChunkSize = 256 * 1024; // required by google
-        read = size - index <= minChunkSize ? size - index : minChunkSize;
+        int rangeSize = units * 256 * 1024; // the multiple of 256 KB is required by google
+        read = size - index <= rangeSize ? size - index : rangeSize;
     }
     void updateRange()
     {
+        if (read > 0)
+            adaptRange(false);
         index += read;
         getRange();
         len = read;
+        range_ms = millis();
+    }
+    // The server committed the bytes before its offset, the next range begins there.
+    void commitRange(bool hasRange)
+    {
+        size_t offset = hasRange ? committed : 0;
+        if (read > 0 && !query)
+            adaptRange(false);
+        seek = query || offset != (size_t)(index + read);
+        query = false;
+        index = offset;
+        getRange();
+        len = read;
+        range_ms = millis();
+        if (session)
+        {
+            session->offset = offset;
+            session->save();
+        }
+    }
+    // Parse the committed bytes from the Range header e.g. bytes=0-262143.
+    void setCommitted(const String &range)
+    {
+        int p = range.lastIndexOf('-');
+        committed = p > -1 ? strtoul(range.c_str() + p + 1, nullptr, 10) + 1 : 0;
+    }
+    void setSession(resumable_session_t *session) { this->session = session; }
+    resumable_session_t *getSession() { return session; }
+    // The upload continues the persisted session, its committed offset is queried first.
+    void beginQuery()
+    {
+        location = session->location;
+        query = true;
+    }
+    bool isQuery() { return query; }
+    bool isSessionRequest() { return session_request; }
+    // Returns true once when the next range does not follow the sent range.
+    bool seekRange()
+    {
+        bool ret = seek;
+        seek = false;
+        return ret;
+    }
+    int getIndex() { return index; }
+    void setLocation(const String &value)
+    {
+        bool created = location.length() == 0;
+        location = value;
+        if (created && session)
+        {
+            session->location = value;
+            session->offset = 0;
+            session->save();
+        }
+    }
+    // The range was not sent, the next upload begins with the smaller range.
+    void rangeFailed()
+    {
+        if (state == resume_state_send_payload || state == resume_state_read_response)
+            adaptRange(true);
     }
     int getChunkSize(int size, int payloadIndex, int dataIndex)
     {
-        int chunkSize = size - dataIndex < FIREBASE_CHUNK_SIZE ? size - dataIndex : FIREBASE_CHUNK_SIZE;
+        int chunkSize = size - dataIndex < slice ? size - dataIndex : slice;
 
         if (payloadIndex + chunkSize > index + read)
             chunkSize = index + read - payloadIndex;
@@ -165,6 +399,7 @@ public:
     }
     void getHeader(String &header, const String &host, const String &ext)
     {
+        session_request = true;
         header = FPSTR("PUT ");
         header += ext;
         header += FPSTR(" HTTP/1.1\r\nHost: ");
@@ -179,6 +414,17 @@ public:
         header += size;
         header += FPSTR("\r\n\r\n");
     }
+    void getQueryHeader(String &header, const String &host, const String &ext)
+    {
+        session_request = true;
+        header = FPSTR("PUT ");
+        header += ext;
+        header += FPSTR(" HTTP/1.1\r\nHost: ");
+        header += host;
+        header += FPSTR("\r\nConnection: keep-alive\r\nContent-Length: 0\r\nContent-Range: bytes */");
+        header += size;
+        header += FPSTR("\r\n\r\n");
+    }
     void clear()
     {
         location.remove(0, location.length());
@@ -187,6 +433,9 @@ public:
         read = 0;
         enable = false;
         len = 0;
+        range_state = nullptr;
+        query = false;
+        seek = false;
     }
     String &getLocationRef() { return location; }
     String getLocation() { return location.c_str(); }
@@ -220,9 +469,9 @@ public:
         this->size = size;
         enable = size > 0;
     }
-    int getChunkSize(int size, int payloadIndex, int dataIndex)
+    int getChunkSize(int size, int payloadIndex, int dataIndex, int chunk = FIREBASE_CHUNK_SIZE)
     {
-        int chunkSize = size - dataIndex < FIREBASE_CHUNK_SIZE ? size - dataIndex : FIREBASE_CHUNK_SIZE;
+        int chunkSize = size - dataIndex < chunk ? size - dataIndex : chunk;
 
         if (state == multipart_state_send_options_payload && options_part.length() && payloadIndex + chunkSize > index + (int)options_part.length())
         {
@@ -381,6 +630,14 @@ struct file_config_data
     uint8_t *data = nullptr;
     size_t data_pos = 0;
     size_t data_size = 0;
+    // The slice [range_offset, range_offset + range_size) of file to upload, the whole file when range_size is 0.
+    size_t range_offset = 0;
+    size_t range_size = 0;
+    // The producer of upload data and its total length, 0 for unknown length that is sent with chunked transfer encoding.
+    UploadSourceCallback source = NULL;
+    size_t source_size = 0;
+    // The consumer of download data.
+    DownloadSinkCallback sink = NULL;
     bool internal_data = false;
     firebase_blob_writer outB;
     bool initialized = false;
@@ -396,6 +653,12 @@ struct file_config_data
         internal_data = false;
     }
 
+    // The data is pulled from producer with unknown total length.
+    bool chunked() const { return source && source_size == 0; }
+
+    // The length of blob or producer data.
+    size_t dataLength() const { return source ? source_size : data_size; }
+
     void initBlobWriter(size_t size)
     {
         clearInternalData();
@@ -415,7 +678,7 @@ public:
         return *this;
     }
 
-    void copy(file_config_data rhs)
+    void copy(const file_config_data &rhs)
     {
 #if defined(ENABLE_FS)
         this->file = rhs.file;
@@ -432,6 +695,11 @@ public:
             this->internal_data = false;
         }
 
+        this->range_offset = rhs.range_offset;
+        this->range_size = rhs.range_size;
+        this->source = rhs.source;
+        this->source_size = rhs.source_size;
+        this->sink = rhs.sink;
         this->initialized = rhs.initialized;
     }
 
@@ -444,6 +712,11 @@ public:
 #endif
         data = nullptr;
         data_size = 0;
+        range_offset = 0;
+        range_size = 0;
+        source = NULL;
+        source_size = 0;
+        sink = NULL;
         internal_data = false;
         initialized = false;
     }
@@ -528,10 +801,146 @@ private:
     file_config_data data;
 };
 
+#if defined(ESP32) && __has_include(<esp_partition.h>)
+#include <esp_partition.h>
+#if defined(ESP_IDF_VERSION_MAJOR) && ESP_IDF_VERSION_MAJOR >= 5
+#define FIREBASE_PARTITION_MMAP_HANDLE esp_partition_mmap_handle_t
+#define FIREBASE_PARTITION_MUNMAP esp_partition_munmap
+#else
+#define FIREBASE_PARTITION_MMAP_HANDLE spi_flash_mmap_handle_t
+#define FIREBASE_PARTITION_MUNMAP spi_flash_munmap
+#endif
+#if !defined(SPI_FLASH_MMU_PAGE_SIZE)
+#define SPI_FLASH_MMU_PAGE_SIZE 0x10000
+#endif
+
+class PartitionConfig
+{
+
+public:
+    /**
+     * The upload data in the data partition that is memory-mapped, the data are read from the cache-mapped flash
+     * while they are sent or base64 encoded, without the copy to RAM buffer.
+     *
+     * The partition should keep the raw data e.g. the static asset that was written with esptool or
+     * esp_partition_write, the files of SPIFFS or LittleFS partition are not contiguous and cannot be mapped.
+     *
+     * @param label The label of data partition in the partition table.
+     * @param offset The offset of data in the partition.
+     * @param size The length of data, 0 for the data to the end of partition.
+     */
+    PartitionConfig(const char *label, size_t offset = 0, size_t size = 0)
+    {
+        data.clear();
+        data.initialized = true;
+
+        const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+        if (!part || offset >= part->size)
+            return;
+
+        if (size == 0 || size > part->size - offset)
+            size = part->size - offset;
+
+        // The mapping starts at the MMU page boundary.
+        size_t page = offset - offset % SPI_FLASH_MMU_PAGE_SIZE;
+        const void *ptr = nullptr;
+        if (esp_partition_mmap(part, page, offset - page + size, ESP_PARTITION_MMAP_DATA, &ptr, &handle) != ESP_OK)
+            return;
+
+        mapped = true;
+        data.data = const_cast<uint8_t *>(reinterpret_cast<const uint8_t *>(ptr)) + (offset - page);
+        data.data_size = size;
+        data.internal_data = false;
+    }
+
+    PartitionConfig(const PartitionConfig &) = delete;
+    PartitionConfig &operator=(const PartitionConfig &) = delete;
+
+    ~PartitionConfig()
+    {
+        if (mapped)
+            FIREBASE_PARTITION_MUNMAP(handle);
+    }
+
+    // The data were mapped and can be uploaded.
+    bool isMapped() const { return mapped; }
+
+    const uint8_t *blob() const { return data.data; }
+    size_t size() const { return data.data_size; }
+
+    file_config_data &getData() { return data; }
+
+private:
+    file_config_data data;
+    FIREBASE_PARTITION_MMAP_HANDLE handle = 0;
+    bool mapped = false;
+};
+#endif
+
+class SourceConfig
+{
+
+public:
+    /**
+     * The upload data that is pulled from the producer callback on demand.
+     *
+     * @param cb The UploadSourceCallback function.
+     * @param size The total length of data, 0 for unknown length that is sent with chunked transfer encoding.
+     * The Realtime Database upload (base64 encoded) requires the total length.
+     */
+    SourceConfig(UploadSourceCallback cb = NULL, size_t size = 0)
+    {
+        clear();
+        data.source = cb;
+        data.source_size = size;
+        data.initialized = true;
+    }
+    ~SourceConfig() {}
+    void clear() { data.clear(); }
+
+    size_t size() const { return data.source_size; }
+
+    file_config_data &getData() { return data; }
+
+private:
+    file_config_data data;
+};
+
+class SinkConfig
+{
+
+public:
+    /**
+     * The download data that is pushed to the consumer callback.
+     * The socket is not read while the consumer is full, the data that was not accepted is offered again later.
+     *
+     * @param cb The DownloadSinkCallback function.
+     */
+    SinkConfig(DownloadSinkCallback cb = NULL)
+    {
+        clear();
+        data.sink = cb;
+        data.initialized = true;
+    }
+    ~SinkConfig() {}
+    void clear() { data.clear(); }
+
+    file_config_data &getData() { return data; }
+
+private:
+    file_config_data data;
+};
+
 template <typename T>
 static file_config_data &getFile(T &file) { return file.get(); }
 
 template <typename T>
 static file_config_data &getBlob(T &blob) { return blob.getData(); }
 
+template <typename T>
+static file_config_data &getSource(T &source) { return source.getData(); }
+
+template <typename T>
+static file_config_data &getSink(T &sink) { return sink.getData(); }
+
 #endif
\ No newline at end of file
@@ -29,11 +29,18 @@
 #include "./core/AuthConfig.h"
 #include "./core/AsyncClient/AsyncClient.h"
 #include "./core/List.h"
+#include "./core/JsonParser.h"
+#include "./core/FNV.h"
 #if defined(ENABLE_JWT)
 #include "./core/JWT.h"
 #endif
 #include "./core/Timer.h"
 
+// The seconds before the token expiry that the token is refreshed by warm-up (FirebaseApp::refreshAhead).
+#if !defined(FIREBASE_WARMUP_TOKEN_SEC)
+#define FIREBASE_WARMUP_TOKEN_SEC 300
+#endif
+
 namespace firebase
 {
 
@@ -56,9 +63,10 @@ namespace firebase
         async_data_item_t *sData = nullptr;
         auth_data_t auth_data;
         AsyncClientClass *aClient = nullptr;
-        uint32_t aclient_addr = 0, app_addr = 0, ref_ts = 0;
-        std::vector<uint32_t> aVec; // FirebaseApp vector
-        std::vector<uint32_t> cVec; // AsyncClient vector
+        // The Registry handles of auth client and this app.
+        list_handle_t aclient_handle = 0, app_handle = 0;
+        uint32_t ref_ts = 0;
+        std::vector<list_handle_t> cVec; // AsyncClient handles
         AsyncResultCallback resultCb = NULL;
         Timer req_timer, auth_timer, err_timer;
         List vec;
@@ -67,6 +75,8 @@ namespace firebase
         JSONUtil json;
         String extras, subdomain, host;
         slot_options_t sop;
+        TokenStoreCallback token_store_cb = NULL;
+        TimeStatusCallback token_time_cb = NULL;
 
 #if defined(ENABLE_JWT)
 
@@ -78,116 +88,155 @@ namespace firebase
 
 #endif
 
-        bool parseItem(StringUtil &sut, const String &src, String &dest, const String &name, const String &delim, int &p1, int &p2)
+        bool parseItem(const String &src, String &dest, const char *path)
         {
-            sut.parse(src, name, delim, p1, p2);
-            if (p1 > -1 && p2 > -1)
-            {
-                if (src[p1] == '"')
-                    p1++;
-                if (src[p2] == '"')
-                    p2--;
-                dest = src.substring(p1, p2);
-                p1 = p2;
-                return true;
-            }
-            p1 = 0;
-            p2 = 0;
-            return false;
+            return JsonPullParser::get(src, path, dest);
         }
 
         template <typename T = int>
-        bool parseItem(StringUtil &sut, const String &src, T &dest, const String &name, const String &delim, int &p1, int &p2)
+        bool parseItem(const String &src, T &dest, const char *path)
         {
-            sut.parse(src, name, delim, p1, p2);
-            if (p1 > -1 && p2 > -1)
-            {
-                if (src[p1] == '"')
-                    p1++;
-                if (src[p2] == '"')
-                    p2--;
-                dest = atoi(src.substring(p1, p2).c_str());
-                p1 = p2;
-                return true;
-            }
-            p1 = 0;
-            p2 = 0;
-            return false;
+            json_span_t span;
+            if (!JsonPullParser::get(src, path, span))
+                return false;
+            dest = atoi(src.c_str() + span.unquote(src.c_str()).start);
+            return true;
         }
 
+        // Parse the token to the temporary app token that swapped in when success, the current token is kept for the requests in queue.
         bool parseToken(const String &payload)
         {
-            StringUtil sut;
-            int p1 = 0, p2 = 0;
-            auth_data.app_token.clear();
+            app_token_t app_token;
+            app_token.clear();
             String token, refresh;
+            json_span_t span;
 
-            if (payload.indexOf("\"error\"") > -1)
+            if (JsonPullParser::get(payload, "error", span))
             {
+                int code = 0;
                 String str;
-                if (parseItem(sut, payload, str, "\"error\"", auth_data.user_auth.auth_type == auth_user_id_token || auth_data.user_auth.auth_type == auth_sa_custom_token ? "}" : ",", p1, p2))
-                {
-                    int code = 0;
-                    str = "";
-                    p1 = 0;
-                    p2 = 0;
-                    parseItem(sut, payload, code, "\"code\"", ",", p1, p2);
-                    parseItem(sut, payload, str, "\"message\"", ",", p1, p2);
-                    parseItem(sut, payload, str, "\"error_description\"", "}", p1, p2);
-                    if (str[str.length() - 1] == '"')
-                        str[str.length() - 1] = '\0';
-                    setLastError(sData ? &sData->aResult : nullptr, code, str);
-                }
+                parseItem(payload, code, "error/code");
+                if (!parseItem(payload, str, "error/message"))
+                    parseItem(payload, str, "error_description");
+                setLastError(sData ? &sData->aResult : nullptr, code, str);
             }
-            else if (payload.indexOf("\"idToken\"") > -1)
+            else if (parseItem(payload, token, "idToken"))
             {
-                parseItem(sut, payload, auth_data.app_token.val[app_tk_ns::uid], "\"localId\"", ",", p1, p2);
-                p1 = 0;
-                p2 = 0;
-                sut.trim(auth_data.app_token.val[app_tk_ns::uid]);
-                if (parseItem(sut, payload, token, "\"idToken\"", ",", p1, p2))
-                {
-                    sut.trim(token);
-                    parseItem(sut, payload, refresh, "\"refreshToken\"", ",", p1, p2);
-                    sut.trim(refresh);
-                    parseItem(sut, payload, auth_data.app_token.expire, "\"expiresIn\"", "}", p1, p2);
-                }
+                parseItem(payload, app_token.val[app_tk_ns::uid], "localId");
+                parseItem(payload, refresh, "refreshToken");
+                parseItem(payload, app_token.expire, "expiresIn");
             }
-            else if (payload.indexOf("\"id_token\"") > -1)
+            else if (parseItem(payload, token, "id_token"))
             {
-                parseItem(sut, payload, auth_data.app_token.expire, "\"expires_in\"", ",", p1, p2);
-                parseItem(sut, payload, refresh, "\"refresh_token\"", ",", p1, p2);
-                parseItem(sut, payload, token, "\"id_token\"", ",", p1, p2);
-                parseItem(sut, payload, auth_data.app_token.val[app_tk_ns::uid], "\"user_id\"", ",", p1, p2);
-                sut.trim(refresh);
-                sut.trim(token);
-                sut.trim(auth_data.app_token.val[app_tk_ns::uid]);
+                parseItem(payload, app_token.expire, "expires_in");
+                parseItem(payload, refresh, "refresh_token");
+                parseItem(payload, app_token.val[app_tk_ns::uid], "user_id");
             }
-            else if (payload.indexOf("\"access_token\"") > -1)
+            else if (parseItem(payload, token, "access_token"))
             {
-                if (parseItem(sut, payload, token, "\"access_token\"", ",", p1, p2))
-                {
-                    parseItem(sut, payload, auth_data.app_token.expire, "\"expires_in\"", ",", p1, p2);
-                    parseItem(sut, payload, auth_data.app_token.val[app_tk_ns::type], "\"token_type\"", "}", p1, p2);
-                }
+                parseItem(payload, app_token.expire, "expires_in");
+                parseItem(payload, app_token.val[app_tk_ns::type], "token_type");
             }
 
-            if (token.length() > 0 && token[token.length() - 1] == '"')
-                token.remove(token.length() - 1, 1);
+            if (token.length() == 0)
+                return false;
+
+            app_token.val[app_tk_ns::token] = token;
+            app_token.val[app_tk_ns::refresh] = refresh;
+            app_token.val[app_tk_ns::pid] = auth_data.user_auth.sa.val[sa_ns::pid];
+            app_token.authenticated = auth_data.app_token.authenticated;
+            app_token.auth_type = auth_data.app_token.auth_type;
+            app_token.auth_data_type = auth_data.app_token.auth_data_type;
+            auth_data.app_token = app_token;
+            return true;
+        }
 
-            if (refresh.length() > 0 && refresh[refresh.length() - 1] == '"')
-                refresh.remove(refresh.length() - 1, 1);
+        uint32_t storeTime() { return WallClock::shared().now(token_time_cb ? token_time_cb : auth_data.user_auth.timestatus_cb); }
 
-            auth_data.app_token.val[app_tk_ns::token] = token;
-            auth_data.app_token.val[app_tk_ns::refresh] = refresh;
-            auth_data.app_token.val[app_tk_ns::pid] = auth_data.user_auth.sa.val[sa_ns::pid];
-            return token.length() > 0;
+        // The FNV-1a hash of auth type and account that the stored token belongs to.
+        uint32_t storeId()
+        {
+            String id = String((int)auth_data.user_auth.auth_type);
+#if defined(ENABLE_SERVICE_AUTH)
+            if (auth_data.user_auth.auth_type == auth_sa_access_token)
+                id += auth_data.user_auth.sa.val[sa_ns::cm];
+#endif
+#if defined(ENABLE_CUSTOM_AUTH)
+            if (auth_data.user_auth.auth_type == auth_sa_custom_token)
+                id += auth_data.user_auth.cust.val[cust_ns::uid];
+#endif
+#if defined(ENABLE_USER_AUTH)
+            if (auth_data.user_auth.auth_type == auth_user_id_token)
+                id += auth_data.user_auth.user.val[user_ns::em];
+#endif
+            return FNV1a::hash(id.c_str(), id.length());
         }
 
-        AsyncClientClass *getClient()
+        void saveToken(uint32_t ttl)
         {
-            List vec;
-            return vec.existed(cVec, aclient_addr) ? aClient : nullptr;
+            uint32_t now = token_store_cb ? storeTime() : 0;
+            if (!now)
+                return;
+
+            String data;
+            json.addObject(data, "id", String(storeId()), true);
+            json.addObject(data, "exp", String(now + ttl), false);
+            // The token values are keyed by their app_tk_ns index.
+            for (size_t i = 0; i < app_tk_ns::max_type; i++)
+            {
+                if (auth_data.app_token.val[i].length())
+                    json.addObject(data, String(i), auth_data.app_token.val[i], true);
+            }
+            data += '}';
+            token_store_cb(data, true);
+        }
+
+        // Restore the persisted token that belongs to this auth and is not expired.
+        bool restoreToken()
+        {
+            uint32_t now = token_store_cb ? storeTime() : 0;
+            String data;
+            if (!now || !token_store_cb(data, false))
+                return false;
+
+            String id;
+            uint32_t exp = 0;
+            if (!parseItem(data, id, "id") || id != String(storeId()) || !parseItem(data, exp, "exp") || exp <= now)
+                return false;
+
+            auth_data.app_token.clear();
+            for (size_t i = 0; i < app_tk_ns::max_type; i++)
+                parseItem(data, auth_data.app_token.val[i], String(i).c_str());
+
+            if (auth_data.app_token.val[app_tk_ns::token].length() == 0)
+                return false;
+
+            auth_data.app_token.expire = exp - now;
+            auth_data.app_token.authenticated = true;
+            auth_data.app_token.auth_type = auth_data.user_auth.auth_type;
+            auth_data.app_token.auth_data_type = auth_data.user_auth.auth_data_type;
+            auth_timer.feed(exp - now);
+            setEvent(auth_event_ready);
+            return true;
+        }
+
+        // Set the auth time of all async clients that share this app token, their SSE tasks are restarted with the new token.
+        void setAuthTs(uint32_t ts)
+        {
+            for (size_t i = 0; i < cVec.size(); i++)
+            {
+                AsyncClientClass *client = Registry::shared().get<AsyncClientClass>(vec.at(cVec, i));
+                if (client)
+                    client->setAuthTs(ts);
+            }
+        }
+
+        AsyncClientClass *getClient() { return Registry::shared().get<AsyncClientClass>(aclient_handle); }
+
+        void setClient(AsyncClientClass &client)
+        {
+            aClient = &client;
+            aclient_handle = client.handle();
         }
 
         void setEvent(firebase_auth_event_type event)
@@ -302,11 +351,16 @@ namespace firebase
             if (!aClient)
                 return;
 
-            aClient->stop(sData);
+            // The other connections in pool are kept for the tasks in queue.
+            if (aClient->clientCount() == 1 || (sData && sData->conn_index > -1))
+                aClient->stop(sData);
 
             if (sData)
             {
-                aClient->removeSlot(slot, false);
+                // The auth slot index may be changed by the tasks that were added or removed.
+                int index = aClient->slotIndex(sData);
+                if (index > -1)
+                    aClient->removeSlot(index, false);
                 if (sData)
                     delete sData;
                 sData = nullptr;
@@ -401,10 +455,15 @@ namespace firebase
                     sop.auth_used = true;
 
                     // Remove all slots except sse in case ServiceAuth and CustomAuth to free up memory.
+                    // The tasks in queue are kept with connection pool, they are executed on the other connections while authenticating.
+                    // The task that is waiting for the token is kept, it is sent after the token was issued.
                     if (getClient())
                     {
-                        for (size_t i = aClient->slotCount() - 1; i == 0; i--)
-                            aClient->removeSlot(i, false);
+                        for (size_t i = aClient->slotCount() - 1; aClient->clientCount() == 1 && i == 0; i--)
+                        {
+                            if (!aClient->slotAwaitingToken(i))
+                                aClient->removeSlot(i, false);
+                        }
 
                         createSlot(aClient, sop);
                     }
@@ -572,12 +631,13 @@ namespace firebase
                     if (parseToken(sData->response.val[res_hndlr_ns::payload].c_str()))
                     {
                         sData->response.val[res_hndlr_ns::payload].remove(0, sData->response.val[res_hndlr_ns::payload].length());
-                        auth_timer.feed(expire && expire < auth_data.app_token.expire ? expire : auth_data.app_token.expire - 2 * 60);
+                        uint32_t ttl = expire && expire < auth_data.app_token.expire ? expire : auth_data.app_token.expire - 2 * 60;
+                        auth_timer.feed(ttl);
                         auth_data.app_token.authenticated = true;
-                        if (getClient())
-                            aClient->setAuthTs(millis());
+                        setAuthTs(millis());
                         auth_data.app_token.auth_type = auth_data.user_auth.auth_type;
                         auth_data.app_token.auth_data_type = auth_data.user_auth.auth_data_type;
+                        saveToken(ttl);
                         setEvent(auth_event_ready);
                     }
                     else
@@ -593,15 +653,15 @@ namespace firebase
     public:
         FirebaseApp()
         {
-            app_addr = reinterpret_cast<uint32_t>(this);
-            vec.addRemoveList(aVec, app_addr, true);
+            app_handle = Registry::shared().add(this);
         };
         ~FirebaseApp()
         {
             if (sData)
                 delete sData;
             sData = nullptr;
-            vec.addRemoveList(aVec, app_addr, false);
+            // The services that were assigned to this app are not accessing it after.
+            Registry::shared().remove(app_handle);
         };
 
         bool isInitialized() const { return auth_data.user_auth.initialized; }
@@ -611,12 +671,23 @@ namespace firebase
             auth_data.user_auth.jwt_loop = true;
             processAuth();
             auth_data.user_auth.jwt_loop = false;
+
+            // The auth client was processed by processAuth.
+            for (size_t i = 0; i < cVec.size(); i++)
+            {
+                AsyncClientClass *client = Registry::shared().get<AsyncClientClass>(vec.at(cVec, i));
+                if (client && client != aClient)
+                {
+                    client->process(true);
+                    client->handleRemove();
+                }
+            }
         }
 
         bool ready() { return processAuth() && auth_data.app_token.authenticated; }
 
         template <typename T>
-        void getApp(T &app) { app.setApp(app_addr, &auth_data.app_token, reinterpret_cast<uint32_t>(&aVec)); }
+        void getApp(T &app) { app.setApp(app_handle, &auth_data.app_token); }
 
         String getToken() const { return auth_data.app_token.val[app_tk_ns::token]; }
 
@@ -628,8 +699,47 @@ namespace firebase
 
         bool isExpired() { return auth_timer.remaining() == 0; }
 
+        /**
+         * Get the time in ms that the app and its async clients can wait before loop is required.
+         *
+         * @return uint32_t 0 when the authentication is in progress, otherwise the minimum of the time
+         * to the next timer (e.g. token refresh) and AsyncClientClass::nextDeadline of the async clients (see addClient).
+         */
+        uint32_t nextDeadline()
+        {
+            if (processing || auth_data.user_auth.jwt_signing)
+                return 0;
+
+            // The token refresh and the other running timers of the library.
+            uint32_t deadline = TimerWheel::shared().nextDeadline();
+            for (size_t i = 0; i < cVec.size() && deadline > 0; i++)
+            {
+                AsyncClientClass *client = Registry::shared().get<AsyncClientClass>(vec.at(cVec, i));
+                uint32_t ms = client ? client->nextDeadline() : FIREBASE_IDLE_FOREVER;
+                if (ms < deadline)
+                    deadline = ms;
+            }
+            return deadline;
+        }
+
         unsigned long ttl() { return auth_timer.remaining(); }
 
+        /**
+         * Refresh the token in loop when it expires within the time.
+         *
+         * The token is refreshed before the requests are sent e.g. in warm-up instead of when the requests are waiting.
+         *
+         * @param sec The seconds before the token expiry.
+         * @return bool true when the token refresh was started.
+         */
+        bool refreshAhead(uint32_t sec = FIREBASE_WARMUP_TOKEN_SEC)
+        {
+            if (processing || !auth_data.app_token.authenticated || !auth_timer.isRunning() || auth_timer.remaining() == 0 || auth_timer.remaining() > sec)
+                return false;
+            auth_timer.feed(0);
+            return true;
+        }
+
         void setCallback(AsyncResultCallback cb)
         {
             this->resultCb = cb;
@@ -637,7 +747,54 @@ namespace firebase
         }
 
         auth_data_t *getAuth() { return &auth_data; }
+
+        /** Add the async client that shares the token of this app.
+         *
+         * @param aClient The async client.
+         *
+         * The async client that used in FirebaseClient::initializeApp is added by default.
+         * The tasks of added clients are processed in FirebaseApp::loop and their SSE tasks are restarted
+         * when the token was refreshed. The client should be removed before it was destroyed.
+         */
+        void addClient(AsyncClientClass &aClient) { aClient.addRemoveClientVec(cVec, true); }
+
+        /** Remove the async client that was added by FirebaseApp::addClient.
+         *
+         * @param aClient The async client.
+         */
+        void removeClient(AsyncClientClass &aClient)
+        {
+            if (&aClient != this->aClient)
+                aClient.addRemoveClientVec(cVec, false);
+        }
+
+        /** Set the callback to persist the auth token across reboot and deep sleep.
+         *
+         * @param cb The TokenStoreCallback to save (save is true) or load (save is false) the token data (String)
+         * to or from the storage e.g. NVS, RTC memory or filesystem.
+         * @param timeCb The optional TimeStatusCallback that provides the current timestamp (epoch seconds).
+         *
+         * The token is saved when the token was issued and is restored in FirebaseClient::initializeApp
+         * when it belongs to the same auth and is not expired.
+         * The valid current time is required, the time status callback of the auth is used if timeCb was not set.
+         * This works with service account, custom auth and user auth.
+         */
+        void setTokenStore(TokenStoreCallback cb, TimeStatusCallback timeCb = NULL)
+        {
+            token_store_cb = cb;
+            token_time_cb = timeCb;
+        }
     };
 };
 
+inline bool AsyncClientClass::warmUp(list_handle_t app_handle, std::vector<list_handle_t> &cVec, const String &host, uint16_t port)
+{
+    FirebaseApp *app = Registry::shared().get<FirebaseApp>(app_handle);
+    if (app)
+        app->refreshAhead(FIREBASE_WARMUP_TOKEN_SEC);
+    // The connect task is processed in loop of the service.
+    addRemoveClientVec(cVec, true);
+    return preconnect(host, port);
+}
+
 #endif
\ No newline at end of file
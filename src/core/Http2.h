@@ -0,0 +1,1401 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_HTTP2_H
+#define CORE_HTTP2_H
+
+#include <Arduino.h>
+#include <Client.h>
+
+// The maximum numbers of network clients (streams) of one HTTP/2 session.
+#if !defined(FIREBASE_HTTP2_MAX_STREAMS)
+#define FIREBASE_HTTP2_MAX_STREAMS 4
+#endif
+
+// The receive window and buffer size in bytes of each stream.
+#if !defined(FIREBASE_HTTP2_STREAM_WINDOW)
+#define FIREBASE_HTTP2_STREAM_WINDOW 4096
+#endif
+
+// The size in bytes of HPACK dynamic table of the request headers.
+#if !defined(FIREBASE_HTTP2_HPACK_TABLE_SIZE)
+#define FIREBASE_HTTP2_HPACK_TABLE_SIZE 512
+#endif
+
+// The maximum size in bytes of the request and response header blocks.
+#if !defined(FIREBASE_HTTP2_HEADER_BLOCK_SIZE)
+#define FIREBASE_HTTP2_HEADER_BLOCK_SIZE 2048
+#endif
+
+// The time in ms that the request body is waited for the send window of server.
+#if !defined(FIREBASE_HTTP2_WRITE_TIMEOUT_MS)
+#define FIREBASE_HTTP2_WRITE_TIMEOUT_MS 10000
+#endif
+
+enum h2_frame_type
+{
+    h2_frame_data,
+    h2_frame_headers,
+    h2_frame_priority,
+    h2_frame_rst_stream,
+    h2_frame_settings,
+    h2_frame_push_promise,
+    h2_frame_ping,
+    h2_frame_goaway,
+    h2_frame_window_update,
+    h2_frame_continuation
+};
+
+#define H2_FLAG_END_STREAM 0x1
+#define H2_FLAG_ACK 0x1
+#define H2_FLAG_END_HEADERS 0x4
+#define H2_FLAG_PADDED 0x8
+#define H2_FLAG_PRIORITY 0x20
+
+// The byte buffer of header block.
+struct h2_buf_t
+{
+    uint8_t *data = nullptr;
+    size_t cap = 0, len = 0;
+
+    bool put(uint8_t b)
+    {
+        if (len >= cap)
+            return false;
+        data[len++] = b;
+        return true;
+    }
+
+    bool put(const char *s, size_t n)
+    {
+        if (len + n > cap)
+            return false;
+        memcpy(data + len, s, n);
+        len += n;
+        return true;
+    }
+};
+
+/**
+ * The HPACK (RFC 7541) header compression of the requests and decompression of the responses.
+ *
+ * The request headers are indexed in the dynamic table of FIREBASE_HTTP2_HPACK_TABLE_SIZE bytes, the strings
+ * are sent without Huffman coding. The dynamic table of responses is disabled by settings, the Huffman coded
+ * response strings are decoded and the headers of invalid strings are skipped.
+ */
+class Http2Hpack
+{
+private:
+    struct entry_t
+    {
+        String name, value;
+    };
+
+    static const uint8_t static_count = 61;
+    static const uint8_t dyn_limit = FIREBASE_HTTP2_HPACK_TABLE_SIZE / 32 + 1;
+    entry_t dyn[dyn_limit];
+    uint8_t dyn_head = 0, dyn_count = 0;
+    size_t dyn_size = 0, dyn_max = FIREBASE_HTTP2_HPACK_TABLE_SIZE;
+    bool size_update = false;
+
+    static const char *staticName(uint8_t i)
+    {
+        static const char *const names[static_count] = {
+            ":authority", ":method", ":method", ":path", ":path", ":scheme", ":scheme", ":status", ":status", ":status",
+            ":status", ":status", ":status", ":status", "accept-charset", "accept-encoding", "accept-language",
+            "accept-ranges", "accept", "access-control-allow-origin", "age", "allow", "authorization", "cache-control",
+            "content-disposition", "content-encoding", "content-language", "content-length", "content-location",
+            "content-range", "content-type", "cookie", "date", "etag", "expect", "expires", "from", "host", "if-match",
+            "if-modified-since", "if-none-match", "if-range", "if-unmodified-since", "last-modified", "link", "location",
+            "max-forwards", "proxy-authenticate", "proxy-authorization", "range", "referer", "refresh", "retry-after",
+            "server", "set-cookie", "strict-transport-security", "transfer-encoding", "user-agent", "vary", "via",
+            "www-authenticate"};
+        return names[i - 1];
+    }
+
+    static const char *staticValue(uint8_t i)
+    {
+        switch (i)
+        {
+        case 2:
+            return "GET";
+        case 3:
+            return "POST";
+        case 4:
+            return "/";
+        case 5:
+            return "/index.html";
+        case 6:
+            return "http";
+        case 7:
+            return "https";
+        case 8:
+            return "200";
+        case 9:
+            return "204";
+        case 10:
+            return "206";
+        case 11:
+            return "304";
+        case 12:
+            return "400";
+        case 13:
+            return "404";
+        case 14:
+            return "500";
+        case 16:
+            return "gzip, deflate";
+        default:
+            return "";
+        }
+    }
+
+    entry_t &dynAt(uint8_t i) { return dyn[(dyn_head + dyn_limit - 1 - i) % dyn_limit]; }
+
+    void evict(size_t room)
+    {
+        while (dyn_count && dyn_size + room > dyn_max)
+        {
+            entry_t &e = dynAt(dyn_count - 1);
+            dyn_size -= e.name.length() + e.value.length() + 32;
+            e.name.remove(0, e.name.length());
+            e.value.remove(0, e.value.length());
+            dyn_count--;
+        }
+    }
+
+    void insert(const String &name, const String &value)
+    {
+        size_t size = name.length() + value.length() + 32;
+        evict(size);
+        // The entry that is larger than the table empties it.
+        if (size > dyn_max)
+            return;
+        dyn[dyn_head].name = name;
+        dyn[dyn_head].value = value;
+        dyn_head = (dyn_head + 1) % dyn_limit;
+        dyn_count++;
+        dyn_size += size;
+    }
+
+    static bool putInt(h2_buf_t &out, uint8_t flags, uint8_t prefix, uint32_t value)
+    {
+        uint32_t max = (1UL << prefix) - 1;
+        if (value < max)
+            return out.put(flags | value);
+        if (!out.put(flags | max))
+            return false;
+        value -= max;
+        while (value >= 128)
+        {
+            if (!out.put((value & 0x7f) | 0x80))
+                return false;
+            value >>= 7;
+        }
+        return out.put(value);
+    }
+
+    static bool putString(h2_buf_t &out, const String &s) { return putInt(out, 0, 7, s.length()) && out.put(s.c_str(), s.length()); }
+
+    static bool getInt(const uint8_t *data, size_t len, size_t &pos, uint8_t prefix, uint32_t &value)
+    {
+        if (pos >= len)
+            return false;
+        uint32_t max = (1UL << prefix) - 1;
+        value = data[pos++] & max;
+        if (value < max)
+            return true;
+        uint8_t shift = 0;
+        while (pos < len && shift < 28)
+        {
+            uint8_t b = data[pos++];
+            value += (uint32_t)(b & 0x7f) << shift;
+            if (!(b & 0x80))
+                return true;
+            shift += 7;
+        }
+        return false;
+    }
+
+    // Decode the Huffman coded string of the canonical code (RFC 7541 Appendix B), false when the string is not valid.
+    static bool huffmanDecode(const uint8_t *data, size_t len, String &out)
+    {
+        // The numbers of codes of lengths 5 to 30 bits and the symbols in order of their codes.
+        static const uint8_t counts[] = {10, 26, 32, 6, 0, 5, 3, 2, 6, 2, 3, 0, 0, 0, 3, 8, 13, 26, 29, 12, 4, 15, 19, 29, 0, 3};
+        static const uint8_t symbols[] = {
+            0x30, 0x31, 0x32, 0x61, 0x63, 0x65, 0x69, 0x6f, 0x73, 0x74, 0x20, 0x25, 0x2d, 0x2e, 0x2f, 0x33,
+            0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3d, 0x41, 0x5f, 0x62, 0x64, 0x66, 0x67, 0x68, 0x6c, 0x6d,
+            0x6e, 0x70, 0x72, 0x75, 0x3a, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x4b, 0x4c,
+            0x4d, 0x4e, 0x4f, 0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x59, 0x6a, 0x6b, 0x71, 0x76,
+            0x77, 0x78, 0x79, 0x7a, 0x26, 0x2a, 0x2c, 0x3b, 0x58, 0x5a, 0x21, 0x22, 0x28, 0x29, 0x3f, 0x27,
+            0x2b, 0x7c, 0x23, 0x3e, 0x00, 0x24, 0x40, 0x5b, 0x5d, 0x7e, 0x5e, 0x7d, 0x3c, 0x60, 0x7b, 0x5c,
+            0xc3, 0xd0, 0x80, 0x82, 0x83, 0xa2, 0xb8, 0xc2, 0xe0, 0xe2, 0x99, 0xa1, 0xa7, 0xac, 0xb0, 0xb1,
+            0xb3, 0xd1, 0xd8, 0xd9, 0xe3, 0xe5, 0xe6, 0x81, 0x84, 0x85, 0x86, 0x88, 0x92, 0x9a, 0x9c, 0xa0,
+            0xa3, 0xa4, 0xa9, 0xaa, 0xad, 0xb2, 0xb5, 0xb9, 0xba, 0xbb, 0xbd, 0xbe, 0xc4, 0xc6, 0xe4, 0xe8,
+            0xe9, 0x01, 0x87, 0x89, 0x8a, 0x8b, 0x8c, 0x8d, 0x8f, 0x93, 0x95, 0x96, 0x97, 0x98, 0x9b, 0x9d,
+            0x9e, 0xa5, 0xa6, 0xa8, 0xae, 0xaf, 0xb4, 0xb6, 0xb7, 0xbc, 0xbf, 0xc5, 0xe7, 0xef, 0x09, 0x8e,
+            0x90, 0x91, 0x94, 0x9f, 0xab, 0xce, 0xd7, 0xe1, 0xec, 0xed, 0xc7, 0xcf, 0xea, 0xeb, 0xc0, 0xc1,
+            0xc8, 0xc9, 0xca, 0xcd, 0xd2, 0xd5, 0xda, 0xdb, 0xee, 0xf0, 0xf2, 0xf3, 0xff, 0xcb, 0xcc, 0xd3,
+            0xd4, 0xd6, 0xdd, 0xde, 0xdf, 0xf1, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe,
+            0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x0b, 0x0c, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14,
+            0x15, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x7f, 0xdc, 0xf9, 0x0a, 0x0d, 0x16};
+        // The first code and the index of its symbol of current code length.
+        uint32_t code = 0, first = 0;
+        uint16_t index = 0;
+        uint8_t bits = 0;
+        for (size_t i = 0; i < len; i++)
+        {
+            for (int8_t b = 7; b >= 0; b--)
+            {
+                code = (code << 1) | ((data[i] >> b) & 1);
+                if (++bits < 5)
+                    continue;
+                uint8_t n = counts[bits - 5];
+                if (code >= first && code - first < n)
+                {
+                    out += (char)symbols[index + code - first];
+                    code = first = index = bits = 0;
+                }
+                else
+                {
+                    // The longest code that was not matched is EOS.
+                    if (bits == 30)
+                        return false;
+                    first = (first + n) << 1;
+                    index += n;
+                }
+            }
+        }
+        // The padding is the most significant bits of EOS (all ones) that are shorter than 8 bits.
+        return bits < 8 && code == (1UL << bits) - 1;
+    }
+
+    static bool getString(const uint8_t *data, size_t len, size_t &pos, String &out, bool &known)
+    {
+        if (pos >= len)
+            return false;
+        bool huffman = data[pos] & 0x80;
+        uint32_t n = 0;
+        if (!getInt(data, len, pos, 7, n) || pos + n > len)
+            return false;
+        if (huffman)
+            known = huffmanDecode(data + pos, n, out) && known;
+        else
+            out.concat(reinterpret_cast<const char *>(data + pos), n);
+        pos += n;
+        return true;
+    }
+
+    // Returns the index of header in tables, full is true when the value is also matched.
+    int find(const String &name, const String &value, bool &full)
+    {
+        int index = 0;
+        full = false;
+        for (uint8_t i = 1; i <= static_count; i++)
+        {
+            if (strcmp(staticName(i), name.c_str()) == 0)
+            {
+                if (strcmp(staticValue(i), value.c_str()) == 0)
+                {
+                    full = true;
+                    return i;
+                }
+                if (!index)
+                    index = i;
+            }
+        }
+        for (uint8_t i = 0; i < dyn_count; i++)
+        {
+            entry_t &e = dynAt(i);
+            if (e.name == name)
+            {
+                if (e.value == value)
+                {
+                    full = true;
+                    return static_count + 1 + i;
+                }
+                if (!index)
+                    index = static_count + 1 + i;
+            }
+        }
+        return index;
+    }
+
+public:
+    // Reset the dynamic table for the new connection.
+    void reset(uint32_t peer_table_size)
+    {
+        while (dyn_count)
+            evict(dyn_max + 1);
+        dyn_head = 0;
+        dyn_max = peer_table_size < FIREBASE_HTTP2_HPACK_TABLE_SIZE ? peer_table_size : FIREBASE_HTTP2_HPACK_TABLE_SIZE;
+        // The table size that is smaller than the default of decoder is sent in the first header block.
+        size_update = dyn_max != 4096;
+    }
+
+    // The maximum table size of decoder (SETTINGS_HEADER_TABLE_SIZE of server) was changed.
+    void setPeerTableSize(uint32_t size)
+    {
+        size_t max = size < FIREBASE_HTTP2_HPACK_TABLE_SIZE ? size : FIREBASE_HTTP2_HPACK_TABLE_SIZE;
+        if (max != dyn_max)
+        {
+            dyn_max = max;
+            evict(0);
+            size_update = true;
+        }
+    }
+
+    // Begin the header block, the dynamic table size update is sent when it was changed.
+    bool begin(h2_buf_t &out)
+    {
+        out.len = 0;
+        if (!size_update)
+            return true;
+        size_update = false;
+        return putInt(out, 0x20, 5, dyn_max);
+    }
+
+    // Encode the header field, the name should be in lowercase.
+    bool encode(h2_buf_t &out, const String &name, const String &value)
+    {
+        bool full = false;
+        int index = find(name, value, full);
+        if (full)
+            return putInt(out, 0x80, 7, index);
+
+        // The literal with incremental indexing.
+        bool ok = putInt(out, 0x40, 6, index);
+        if (ok && !index)
+            ok = putString(out, name);
+        ok = ok && putString(out, value);
+        if (ok)
+            insert(name, value);
+        return ok;
+    }
+
+    /**
+     * Decode the response header block.
+     *
+     * @param cb The function that is called with each header field that was decoded.
+     * @return boolean The status of decoding, false when the block is malformed.
+     */
+    template <typename F>
+    static bool decode(const uint8_t *data, size_t len, F cb)
+    {
+        size_t pos = 0;
+        while (pos < len)
+        {
+            uint8_t b = data[pos];
+            uint32_t index = 0;
+            if (b & 0x80)
+            {
+                // The indexed field, the dynamic table of responses is empty.
+                if (!getInt(data, len, pos, 7, index))
+                    return false;
+                if (index >= 1 && index <= static_count)
+                    cb(String(staticName(index)), String(staticValue(index)));
+                continue;
+            }
+
+            if ((b & 0xe0) == 0x20)
+            {
+                // The dynamic table size update.
+                if (!getInt(data, len, pos, 5, index))
+                    return false;
+                continue;
+            }
+
+            if (!getInt(data, len, pos, (b & 0x40) ? 6 : 4, index))
+                return false;
+
+            String name, value;
+            bool known = true;
+            if (index == 0)
+            {
+                if (!getString(data, len, pos, name, known))
+                    return false;
+            }
+            else if (index <= static_count)
+                name = staticName(index);
+            else
+                known = false;
+
+            if (!getString(data, len, pos, value, known))
+                return false;
+            if (known)
+                cb(name, value);
+        }
+        return true;
+    }
+};
+
+class Http2Client;
+
+/**
+ * The HTTP/2 connection over the SSL client that supports ALPN (e.g. ESP_SSLClient), that is shared by
+ * the Http2Client clients (streams) for multiplexing the requests to the same host.
+ *
+ * ### Example
+ * ```cpp
+ * Http2Session h2(ssl_client);
+ * Http2Client h2_client1(h2), h2_client2(h2);
+ * AsyncClient aClient(h2_client1, getNetwork(network));
+ * aClient.addClient(h2_client2);
+ * ```
+ */
+class Http2Session
+{
+    friend class Http2Client;
+
+private:
+    typedef bool (*ALPNCheckCallback)(Client *client);
+
+    Client *transport = nullptr;
+    ALPNCheckCallback alpn_cb = NULL;
+    Http2Client *clients[FIREBASE_HTTP2_MAX_STREAMS] = {};
+    Http2Hpack hpack;
+    String host;
+    uint16_t port = 0;
+    bool goaway = false;
+    // The number of connections that were established, the client is connected to the current one.
+    uint32_t generation = 0;
+    uint32_t last_stream_id = 0x7fffffff, next_stream_id = 1;
+    int32_t send_window = 65535;
+    uint32_t peer_initial_window = 65535, peer_max_frame = 16384, recv_consumed = 0;
+
+    // The frame that is being read.
+    uint8_t fh[9];
+    uint8_t fh_len = 0;
+    uint32_t f_len = 0, f_read = 0, f_stream = 0;
+    uint8_t f_type = 0, f_flags = 0, f_pad = 0;
+    uint8_t fbuf[64];
+    uint8_t hbuf[FIREBASE_HTTP2_HEADER_BLOCK_SIZE];
+    h2_buf_t hblock;
+    uint32_t h_stream = 0;
+    bool h_end_stream = false, h_overflow = false;
+
+    static uint32_t get32(const uint8_t *p) { return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3]; }
+
+    static void put32(uint8_t *p, uint32_t v)
+    {
+        p[0] = v >> 24;
+        p[1] = v >> 16;
+        p[2] = v >> 8;
+        p[3] = v;
+    }
+
+    bool sendFrame(uint8_t type, uint8_t flags, uint32_t stream_id, const uint8_t *payload, size_t len)
+    {
+        uint8_t h[9] = {(uint8_t)(len >> 16), (uint8_t)(len >> 8), (uint8_t)len, type, flags};
+        put32(h + 5, stream_id & 0x7fffffff);
+        if (transport->write(h, 9) != 9)
+            return false;
+        return len == 0 || transport->write(payload, len) == len;
+    }
+
+    bool sendWindowUpdate(uint32_t stream_id, uint32_t inc)
+    {
+        uint8_t p[4];
+        put32(p, inc);
+        return sendFrame(h2_frame_window_update, 0, stream_id, p, 4);
+    }
+
+    void sendRstStream(uint32_t stream_id, uint32_t code)
+    {
+        uint8_t p[4];
+        put32(p, code);
+        sendFrame(h2_frame_rst_stream, 0, stream_id, p, 4);
+    }
+
+    Http2Client *findStream(uint32_t stream_id);
+
+    bool attach(Http2Client *client)
+    {
+        for (uint8_t i = 0; i < FIREBASE_HTTP2_MAX_STREAMS; i++)
+        {
+            if (!clients[i])
+            {
+                clients[i] = client;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void detach(Http2Client *client)
+    {
+        for (uint8_t i = 0; i < FIREBASE_HTTP2_MAX_STREAMS; i++)
+        {
+            if (clients[i] == client)
+                clients[i] = nullptr;
+        }
+    }
+
+    bool hasActiveStreams();
+
+    bool alive() { return transport && transport->connected() && host.length() && !goaway; }
+
+    bool connect(const char *h, uint16_t p);
+
+    uint32_t openStream()
+    {
+        if (!alive() || next_stream_id > 0x7ffffffd)
+            return 0;
+        uint32_t id = next_stream_id;
+        next_stream_id += 2;
+        return id;
+    }
+
+    // Return the consumed bytes to the connection receive window of server.
+    void credit(uint32_t n)
+    {
+        recv_consumed += n;
+        if (recv_consumed >= 16384)
+        {
+            sendWindowUpdate(0, recv_consumed);
+            recv_consumed = 0;
+        }
+    }
+
+    void processFrame();
+
+    void processHeaders();
+
+    size_t readData(Http2Client *client, size_t len);
+
+    int readBlock(size_t left);
+
+    int readDiscard(size_t left);
+
+public:
+    template <typename T>
+    explicit Http2Session(T &sslClient) : transport(&sslClient)
+    {
+        static const char *protocols[] = {"h2"};
+        sslClient.setALPN(protocols, 1);
+        alpn_cb = [](Client *client) -> bool
+        {
+            const char *p = static_cast<T *>(client)->selectedProtocol();
+            return p && strcmp(p, "h2") == 0;
+        };
+        hblock.data = hbuf;
+        hblock.cap = sizeof(hbuf);
+    }
+
+    // Read and process the frames that are available.
+    void poll();
+
+    // Close the connection, the streams of all clients are reset.
+    void stop();
+
+    // Returns true when the connection was established with HTTP/2.
+    bool connected() { return alive(); }
+};
+
+/**
+ * The network client that sends the HTTP/1.1 requests of async client as the HTTP/2 streams of Http2Session
+ * and returns the responses in HTTP/1.1 format (chunked transfer encoding).
+ *
+ * The pseudo-header fields are created from the request line and Host header, the connection-specific headers
+ * are removed. The response headers that are not valid (see Http2Hpack) are not returned.
+ */
+class Http2Client : public Client
+{
+    friend class Http2Session;
+
+private:
+    enum write_phase
+    {
+        write_head,
+        write_body,
+        write_chunk_size,
+        write_chunk_data,
+        write_chunk_crlf,
+        write_trailer,
+        write_done
+    };
+
+    Http2Session *session = nullptr;
+    bool attached = false;
+    uint32_t generation = 0, stream_id = 0;
+    write_phase phase = write_head;
+    String req;
+    uint32_t body_left = 0, chunk_left = 0;
+    int32_t send_window = 0;
+    bool reset_by_peer = false, ended = false, eof = false, chunked_res = false;
+
+    // The response header in HTTP/1.1 format, the chunk size line or CRLF and the received data.
+    String head;
+    size_t head_pos = 0;
+    char stage[16];
+    uint8_t stage_len = 0, stage_pos = 0;
+    uint32_t res_chunk_left = 0, consumed = 0;
+    uint8_t *ring = nullptr;
+    size_t ring_head = 0, ring_count = 0;
+
+    bool sendData(const uint8_t *data, size_t len, bool end)
+    {
+        do
+        {
+            unsigned long ms = millis();
+            while (session->alive() && !reset_by_peer && (send_window <= 0 || session->send_window <= 0) && millis() - ms < FIREBASE_HTTP2_WRITE_TIMEOUT_MS)
+            {
+                session->poll();
+                yield();
+            }
+
+            int32_t window = send_window < session->send_window ? send_window : session->send_window;
+            if (!session->alive() || reset_by_peer || window <= 0)
+                return false;
+
+            size_t n = len < (size_t)window ? len : window;
+            if (n > session->peer_max_frame)
+                n = session->peer_max_frame;
+            if (!session->sendFrame(h2_frame_data, end && n == len ? H2_FLAG_END_STREAM : 0, stream_id, data, n))
+                return false;
+            send_window -= n;
+            session->send_window -= n;
+            data += n;
+            len -= n;
+        } while (len > 0);
+        return true;
+    }
+
+    // Send the request head as HEADERS frame (and CONTINUATION frames).
+    bool sendHead()
+    {
+        String method, path, authority;
+        int p1 = req.indexOf(' '), p2 = p1 > 0 ? req.indexOf(' ', p1 + 1) : -1, eol = req.indexOf("\r\n");
+        if (p1 < 0 || p2 < 0 || eol < p2)
+            return false;
+        method = req.substring(0, p1);
+        path = req.substring(p1 + 1, p2);
+
+        bool chunked = false;
+        body_left = 0;
+        h2_buf_t &out = session->hblock;
+        Http2Hpack &hpack = session->hpack;
+        bool ok = hpack.begin(out) && hpack.encode(out, ":method", method) && hpack.encode(out, ":scheme", "https");
+
+        // The authority is encoded after the headers were scanned for Host.
+        size_t pos = eol + 2;
+        String fields;
+        while (ok && pos < req.length())
+        {
+            int end = req.indexOf("\r\n", pos);
+            if (end < 0 || end == (int)pos)
+                break;
+            int colon = req.indexOf(':', pos);
+            if (colon > 0 && colon < end)
+            {
+                String name = req.substring(pos, colon), value = req.substring(colon + 1, end);
+                name.toLowerCase();
+                value.trim();
+                if (name == "host")
+                    authority = value;
+                else if (name == "transfer-encoding")
+                    chunked = value.indexOf("chunked") > -1;
+                else if (name != "connection" && name != "keep-alive" && name != "proxy-connection" && name != "upgrade" && name != "te")
+                {
+                    if (name == "content-length")
+                        body_left = value.toInt();
+                    fields += name;
+                    fields += '\n';
+                    fields += value;
+                    fields += '\n';
+                }
+            }
+            pos = end + 2;
+        }
+
+        ok = ok && hpack.encode(out, ":authority", authority.length() ? authority : session->host) && hpack.encode(out, ":path", path);
+
+        pos = 0;
+        while (ok && pos < fields.length())
+        {
+            int p = fields.indexOf('\n', pos), q = fields.indexOf('\n', p + 1);
+            ok = hpack.encode(out, fields.substring(pos, p), fields.substring(p + 1, q));
+            pos = q + 1;
+        }
+
+        if (!ok)
+            return false;
+
+        stream_id = session->openStream();
+        if (!stream_id)
+            return false;
+
+        send_window = session->peer_initial_window;
+        phase = chunked ? write_chunk_size : (body_left ? write_body : write_done);
+        uint8_t flags = phase == write_done ? H2_FLAG_END_STREAM : 0;
+
+        size_t sent = 0;
+        do
+        {
+            size_t n = out.len - sent < session->peer_max_frame ? out.len - sent : session->peer_max_frame;
+            uint8_t type = sent == 0 ? h2_frame_headers : h2_frame_continuation;
+            uint8_t f = (sent == 0 ? flags : 0) | (sent + n == out.len ? H2_FLAG_END_HEADERS : 0);
+            if (!session->sendFrame(type, f, stream_id, out.data + sent, n))
+                return false;
+            sent += n;
+        } while (sent < out.len);
+
+        return true;
+    }
+
+    // Remove the chunk framing of the request payload and send the chunk data.
+    size_t writeChunked(const uint8_t *buf, size_t size)
+    {
+        size_t i = 0;
+        while (i < size)
+        {
+            uint8_t c = buf[i];
+            if (phase == write_chunk_size)
+            {
+                i++;
+                if (isxdigit(c))
+                    chunk_left = (chunk_left << 4) | (uint32_t)(isdigit(c) ? c - '0' : (tolower(c) - 'a' + 10));
+                else if (c == '\n')
+                    phase = chunk_left ? write_chunk_data : write_trailer;
+            }
+            else if (phase == write_chunk_data)
+            {
+                size_t n = size - i < chunk_left ? size - i : chunk_left;
+                if (!sendData(buf + i, n, false))
+                    return 0;
+                i += n;
+                chunk_left -= n;
+                if (chunk_left == 0)
+                    phase = write_chunk_crlf;
+            }
+            else if (phase == write_chunk_crlf)
+            {
+                i++;
+                if (c == '\n')
+                    phase = write_chunk_size;
+            }
+            else if (phase == write_trailer)
+            {
+                // The last chunk is followed by the empty line (the trailer fields are not sent).
+                i++;
+                if (c == '\n' && chunk_left == 0)
+                {
+                    if (!sendData(nullptr, 0, true))
+                        return 0;
+                    phase = write_done;
+                }
+                else if (c != '\r')
+                    chunk_left = c == '\n' ? 0 : 1;
+            }
+            else
+                break;
+        }
+        return i;
+    }
+
+    // Reset the stream that was not finished and release the buffer.
+    void closeStream()
+    {
+        if (stream_id && session && session->alive() && (!ended || phase != write_done) && !reset_by_peer)
+            session->sendRstStream(stream_id, 0x8 /* CANCEL */);
+        // The received data that were not read are returned to the connection window.
+        if (ring_count && open())
+            session->credit(ring_count);
+        stream_id = 0;
+        phase = write_head;
+        req.remove(0, req.length());
+        head.remove(0, head.length());
+        head_pos = 0;
+        stage_len = stage_pos = 0;
+        res_chunk_left = 0;
+        ring_head = ring_count = 0;
+        consumed = 0;
+        reset_by_peer = ended = eof = chunked_res = false;
+        if (ring)
+        {
+            delete[] ring;
+            ring = nullptr;
+        }
+    }
+
+    // The response header block of stream was decoded.
+    void setHeaders(const uint8_t *data, size_t len, bool end_stream)
+    {
+        String status, fields;
+        bool ok = Http2Hpack::decode(data, len, [&](const String &name, const String &value)
+                                     {
+            if (name == ":status")
+                status = value;
+            else if (name[0] != ':' && name != "content-length" && name != "transfer-encoding" && name != "connection")
+            {
+                fields += name;
+                fields += ": ";
+                fields += value;
+                fields += "\r\n";
+            } });
+
+        // The informational (1xx) response and the trailer fields are not returned.
+        if (!ok || head.length() || status.length() != 3 || status[0] == '1')
+        {
+            if (!ok)
+                reset_by_peer = true;
+            return;
+        }
+
+        chunked_res = !end_stream;
+        head = "HTTP/1.1 ";
+        head += status;
+        head += " H2\r\n";
+        head += fields;
+        head += chunked_res ? "Transfer-Encoding: chunked\r\n\r\n" : "Content-Length: 0\r\n\r\n";
+        if (chunked_res && !ring)
+            ring = new uint8_t[FIREBASE_HTTP2_STREAM_WINDOW];
+    }
+
+    // The session is alive and was not reconnected (e.g. to other host) after this client was connected.
+    bool open() { return attached && generation && generation == session->generation && session->alive(); }
+
+    size_t ringFree() const { return ring ? FIREBASE_HTTP2_STREAM_WINDOW - ring_count : 0; }
+
+    // Stage the chunk size line of the received data or the last chunk.
+    void prepare()
+    {
+        if (head_pos < head.length() || stage_pos < stage_len || res_chunk_left > 0 || !chunked_res)
+            return;
+        stage_pos = 0;
+        if (ring_count)
+        {
+            res_chunk_left = ring_count;
+            stage_len = snprintf(stage, sizeof(stage), "%lX\r\n", (unsigned long)ring_count);
+        }
+        else if (ended && !eof)
+        {
+            eof = true;
+            memcpy(stage, "0\r\n\r\n", 5);
+            stage_len = 5;
+        }
+        else
+            stage_len = 0;
+    }
+
+public:
+    explicit Http2Client(Http2Session &session) : session(&session) { attached = session.attach(this); }
+
+    ~Http2Client()
+    {
+        closeStream();
+        if (session)
+            session->detach(this);
+    }
+
+    int connect(IPAddress ip, uint16_t port) override
+    {
+        (void)ip;
+        (void)port;
+        // The host name is required for SNI and :authority.
+        return 0;
+    }
+
+    int connect(const char *host, uint16_t port) override
+    {
+        closeStream();
+        generation = attached && session->connect(host, port) ? session->generation : 0;
+        return generation ? 1 : 0;
+    }
+
+    size_t write(uint8_t b) override { return write(&b, 1); }
+
+    size_t write(const uint8_t *buf, size_t size) override
+    {
+        if (!open())
+            return 0;
+
+        // The new request is written after the previous request was sent.
+        if (phase == write_done)
+            closeStream();
+
+        size_t i = 0;
+        if (phase == write_head)
+        {
+            while (i < size && phase == write_head)
+            {
+                req += (char)buf[i++];
+                if (req.endsWith("\r\n\r\n") && !sendHead())
+                    return 0;
+                if (req.length() > FIREBASE_HTTP2_HEADER_BLOCK_SIZE * 2)
+                    return 0;
+            }
+            if (phase != write_head)
+                req.remove(0, req.length());
+        }
+
+        if (i < size && phase == write_body)
+        {
+            size_t n = size - i < body_left ? size - i : body_left;
+            if (!sendData(buf + i, n, n == body_left))
+                return 0;
+            body_left -= n;
+            i += n;
+            if (body_left == 0)
+                phase = write_done;
+        }
+        else if (i < size && phase >= write_chunk_size && phase <= write_trailer)
+        {
+            size_t n = writeChunked(buf + i, size - i);
+            if (n == 0)
+                return 0;
+            i += n;
+        }
+
+        return size;
+    }
+
+    int available() override
+    {
+        if (!attached)
+            return 0;
+        session->poll();
+        prepare();
+        return (head.length() - head_pos) + (stage_len - stage_pos) + (res_chunk_left < ring_count ? res_chunk_left : ring_count);
+    }
+
+    int read() override
+    {
+        uint8_t b = 0;
+        return read(&b, 1) == 1 ? b : -1;
+    }
+
+    int read(uint8_t *buf, size_t size) override
+    {
+        if (available() == 0)
+            return -1;
+
+        size_t n = 0;
+        while (n < size)
+        {
+            prepare();
+            if (head_pos < head.length())
+            {
+                size_t k = head.length() - head_pos < size - n ? head.length() - head_pos : size - n;
+                memcpy(buf + n, head.c_str() + head_pos, k);
+                head_pos += k;
+                n += k;
+            }
+            else if (stage_pos < stage_len)
+            {
+                size_t k = (size_t)(stage_len - stage_pos) < size - n ? stage_len - stage_pos : size - n;
+                memcpy(buf + n, stage + stage_pos, k);
+                stage_pos += k;
+                n += k;
+            }
+            else if (res_chunk_left > 0 && ring_count > 0)
+            {
+                size_t k = res_chunk_left < size - n ? res_chunk_left : size - n;
+                size_t contiguous = FIREBASE_HTTP2_STREAM_WINDOW - ring_head;
+                if (k > contiguous)
+                    k = contiguous;
+                if (k > ring_count)
+                    k = ring_count;
+                memcpy(buf + n, ring + ring_head, k);
+                ring_head = (ring_head + k) % FIREBASE_HTTP2_STREAM_WINDOW;
+                ring_count -= k;
+                res_chunk_left -= k;
+                consumed += k;
+                // Every consumed byte is returned to the connection window, the session sends it in batches.
+                session->credit(k);
+                n += k;
+                if (res_chunk_left == 0)
+                {
+                    memcpy(stage, "\r\n", 2);
+                    stage_len = 2;
+                    stage_pos = 0;
+                }
+            }
+            else
+                break;
+        }
+
+        // Return the consumed bytes to the stream receive window.
+        if (consumed >= FIREBASE_HTTP2_STREAM_WINDOW / 2 && stream_id && !ended)
+        {
+            session->sendWindowUpdate(stream_id, consumed);
+            consumed = 0;
+        }
+
+        return n;
+    }
+
+    int peek() override
+    {
+        if (available() == 0)
+            return -1;
+        if (head_pos < head.length())
+            return (uint8_t)head[head_pos];
+        if (stage_pos < stage_len)
+            return (uint8_t)stage[stage_pos];
+        return ring[ring_head];
+    }
+
+    void flush() override {}
+
+    // Reset the stream, the connection of session is kept for the other streams.
+    void stop() override
+    {
+        closeStream();
+        generation = 0;
+    }
+
+    uint8_t connected() override { return open() && !reset_by_peer ? 1 : (attached && available() > 0); }
+
+    operator bool() override { return connected(); }
+
+    // Returns the stream identifier of the current request, 0 when no request was sent.
+    uint32_t streamId() const { return stream_id; }
+};
+
+inline Http2Client *Http2Session::findStream(uint32_t stream_id)
+{
+    for (uint8_t i = 0; i < FIREBASE_HTTP2_MAX_STREAMS; i++)
+    {
+        if (clients[i] && clients[i]->stream_id == stream_id)
+            return clients[i];
+    }
+    return nullptr;
+}
+
+inline bool Http2Session::hasActiveStreams()
+{
+    for (uint8_t i = 0; i < FIREBASE_HTTP2_MAX_STREAMS; i++)
+    {
+        if (clients[i] && clients[i]->stream_id && !clients[i]->ended && !clients[i]->reset_by_peer)
+            return true;
+    }
+    return false;
+}
+
+inline bool Http2Session::connect(const char *h, uint16_t p)
+{
+    if (alive() && host == h && port == p)
+        return true;
+
+    // The connection is used by the streams to the other host.
+    if (alive() && hasActiveStreams())
+        return false;
+
+    stop();
+    if (!transport->connect(h, p))
+        return false;
+    if (!alpn_cb(transport))
+    {
+        transport->stop();
+        return false;
+    }
+
+    goaway = false;
+    last_stream_id = 0x7fffffff;
+    next_stream_id = 1;
+    send_window = 65535;
+    peer_initial_window = 65535;
+    peer_max_frame = 16384;
+    recv_consumed = 0;
+    fh_len = 0;
+    hblock.len = 0;
+    h_stream = 0;
+    hpack.reset(4096);
+
+    static const char preface[] = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+    // The dynamic table of responses and server push are disabled, the stream window is the receive buffer size.
+    uint8_t settings[18] = {0, 1, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 4};
+    put32(settings + 14, FIREBASE_HTTP2_STREAM_WINDOW);
+    if (transport->write(reinterpret_cast<const uint8_t *>(preface), 24) != 24 || !sendFrame(h2_frame_settings, 0, 0, settings, sizeof(settings)))
+    {
+        transport->stop();
+        return false;
+    }
+
+    host = h;
+    port = p;
+    generation++;
+    return true;
+}
+
+inline void Http2Session::stop()
+{
+    if (alive())
+    {
+        uint8_t p[8] = {};
+        put32(p, next_stream_id > 1 ? next_stream_id - 2 : 0);
+        sendFrame(h2_frame_goaway, 0, 0, p, 8);
+    }
+    if (transport)
+        transport->stop();
+    for (uint8_t i = 0; i < FIREBASE_HTTP2_MAX_STREAMS; i++)
+    {
+        if (clients[i] && clients[i]->stream_id)
+            clients[i]->reset_by_peer = true;
+    }
+    host.remove(0, host.length());
+    port = 0;
+}
+
+inline size_t Http2Session::readData(Http2Client *client, size_t len)
+{
+    size_t n = 0;
+    if (client && client->ring)
+    {
+        size_t free = client->ringFree(), tail = (client->ring_head + client->ring_count) % FIREBASE_HTTP2_STREAM_WINDOW;
+        size_t contiguous = FIREBASE_HTTP2_STREAM_WINDOW - tail;
+        n = len < free ? len : free;
+        if (n > contiguous)
+            n = contiguous;
+        int ret = n ? transport->read(client->ring + tail, n) : 0;
+        n = ret > 0 ? ret : 0;
+        client->ring_count += n;
+        if (n < len && client->ringFree())
+            return n;
+    }
+
+    if (n < len && (!client || !client->ring || !client->ringFree()))
+    {
+        // The data of the stream that was closed (or overflowed) are discarded and returned to the connection window.
+        uint8_t buf[32];
+        int ret = transport->read(buf, len - n < sizeof(buf) ? len - n : sizeof(buf));
+        if (ret > 0)
+        {
+            n += ret;
+            credit(ret);
+        }
+    }
+    return n;
+}
+
+inline int Http2Session::readDiscard(size_t left)
+{
+    uint8_t buf[32];
+    return transport->read(buf, left < sizeof(buf) ? left : sizeof(buf));
+}
+
+// Read the header block fragment of HEADERS or CONTINUATION frame, the pad length, priority fields and padding of HEADERS frame are not stored.
+inline int Http2Session::readBlock(size_t left)
+{
+    bool headers = f_type == h2_frame_headers;
+    if (headers && (f_flags & H2_FLAG_PADDED) && f_read == 0)
+        return transport->read(&f_pad, 1);
+
+    size_t fields = headers ? ((f_flags & H2_FLAG_PADDED) ? 1 : 0) + ((f_flags & H2_FLAG_PRIORITY) ? 5 : 0) : 0;
+    if (f_read < fields)
+        return readDiscard(fields - f_read);
+
+    size_t pad = headers ? f_pad : 0;
+    if (left <= pad || hblock.len >= hblock.cap)
+    {
+        h_overflow = h_overflow || left > pad;
+        return readDiscard(left);
+    }
+
+    size_t n = left - pad < hblock.cap - hblock.len ? left - pad : hblock.cap - hblock.len;
+    int ret = transport->read(hblock.data + hblock.len, n);
+    if (ret > 0)
+        hblock.len += ret;
+    return ret;
+}
+
+inline void Http2Session::poll()
+{
+    if (!transport)
+        return;
+
+    while (transport->available() > 0)
+    {
+        if (fh_len < 9)
+        {
+            int ret = transport->read(fh + fh_len, 9 - fh_len);
+            if (ret <= 0)
+                return;
+            fh_len += ret;
+            if (fh_len < 9)
+                continue;
+            f_len = ((uint32_t)fh[0] << 16) | ((uint32_t)fh[1] << 8) | fh[2];
+            f_type = fh[3];
+            f_flags = fh[4];
+            f_stream = get32(fh + 5) & 0x7fffffff;
+            f_read = 0;
+            f_pad = 0;
+            if (f_type == h2_frame_headers)
+            {
+                hblock.len = 0;
+                h_stream = f_stream;
+                h_end_stream = f_flags & H2_FLAG_END_STREAM;
+                h_overflow = false;
+            }
+            if (f_len > 0)
+                continue;
+        }
+
+        if (f_read < f_len)
+        {
+            size_t left = f_len - f_read;
+            int ret = 0;
+            if (f_type == h2_frame_data)
+            {
+                if ((f_flags & H2_FLAG_PADDED) && f_read == 0)
+                {
+                    ret = transport->read(&f_pad, 1);
+                    if (ret > 0)
+                        credit(1);
+                }
+                else if (left <= f_pad)
+                {
+                    // The padding is discarded, it is also returned to the stream window.
+                    ret = readData(nullptr, left);
+                    Http2Client *client = findStream(f_stream);
+                    if (ret > 0 && client && client->stream_id)
+                        client->consumed += ret;
+                }
+                else
+                {
+                    Http2Client *client = findStream(f_stream);
+                    ret = readData(client && client->stream_id ? client : nullptr, left - f_pad);
+                }
+            }
+            else if (f_type == h2_frame_headers || f_type == h2_frame_continuation)
+                ret = readBlock(left);
+            else if (f_read < sizeof(fbuf))
+                ret = transport->read(fbuf + f_read, left < sizeof(fbuf) - f_read ? left : sizeof(fbuf) - f_read);
+            else
+                ret = readDiscard(left);
+
+            if (ret <= 0)
+                return;
+            f_read += ret;
+        }
+
+        if (f_read == f_len)
+        {
+            processFrame();
+            fh_len = 0;
+        }
+    }
+}
+
+inline void Http2Session::processFrame()
+{
+    Http2Client *client = f_stream ? findStream(f_stream) : nullptr;
+    switch (f_type)
+    {
+    case h2_frame_data:
+        if (client && (f_flags & H2_FLAG_END_STREAM))
+            client->ended = true;
+        break;
+
+    case h2_frame_headers:
+    case h2_frame_continuation:
+        if (f_flags & H2_FLAG_END_HEADERS)
+            processHeaders();
+        break;
+
+    case h2_frame_rst_stream:
+        if (client)
+            client->reset_by_peer = true;
+        break;
+
+    case h2_frame_settings:
+        if (f_flags & H2_FLAG_ACK)
+            break;
+        for (uint32_t i = 0; i + 6 <= f_len && i + 6 <= sizeof(fbuf); i += 6)
+        {
+            uint16_t id = (fbuf[i] << 8) | fbuf[i + 1];
+            uint32_t value = get32(fbuf + i + 2);
+            if (id == 1)
+                hpack.setPeerTableSize(value);
+            else if (id == 4)
+            {
+                // The change of initial window is applied to the open streams.
+                for (uint8_t k = 0; k < FIREBASE_HTTP2_MAX_STREAMS; k++)
+                {
+                    if (clients[k] && clients[k]->stream_id)
+                        clients[k]->send_window += (int32_t)(value - peer_initial_window);
+                }
+                peer_initial_window = value;
+            }
+            else if (id == 5)
+                peer_max_frame = value;
+        }
+        sendFrame(h2_frame_settings, H2_FLAG_ACK, 0, nullptr, 0);
+        break;
+
+    case h2_frame_ping:
+        if (!(f_flags & H2_FLAG_ACK) && f_len == 8)
+            sendFrame(h2_frame_ping, H2_FLAG_ACK, 0, fbuf, 8);
+        break;
+
+    case h2_frame_goaway:
+        if (f_len >= 8)
+        {
+            goaway = true;
+            last_stream_id = get32(fbuf) & 0x7fffffff;
+            for (uint8_t i = 0; i < FIREBASE_HTTP2_MAX_STREAMS; i++)
+            {
+                if (clients[i] && clients[i]->stream_id > last_stream_id)
+                    clients[i]->reset_by_peer = true;
+            }
+        }
+        break;
+
+    case h2_frame_window_update:
+        if (f_len == 4)
+        {
+            int32_t inc = get32(fbuf) & 0x7fffffff;
+            if (!f_stream)
+                send_window += inc;
+            else if (client)
+                client->send_window += inc;
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+inline void Http2Session::processHeaders()
+{
+    Http2Client *client = findStream(h_stream);
+    if (!client || !client->stream_id)
+        return;
+
+    if (h_overflow)
+    {
+        sendRstStream(h_stream, 0x8 /* CANCEL */);
+        client->reset_by_peer = true;
+        return;
+    }
+
+    client->setHeaders(hblock.data, hblock.len, h_end_stream);
+    if (h_end_stream)
+        client->ended = true;
+    hblock.len = 0;
+}
+
+#endif
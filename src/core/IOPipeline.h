@@ -0,0 +1,80 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_IO_PIPELINE_H
+#define CORE_IO_PIPELINE_H
+
+#include <Arduino.h>
+#include "./Config.h"
+#include "./core/Base64.h"
+#include "./core/Hash.h"
+
+// The streaming pipeline of the transferred data, read data → [base64 decode] → [hash] → sink.
+// The stages process the data in place of the buffer that was written, then the data are not copied between the stages.
+class IOPipeline
+{
+public:
+    // The sink of the processed data, returns false when the data could not be written.
+    typedef bool (*Sink)(void *arg, const uint8_t *data, size_t len);
+
+    IOPipeline(Sink sink = nullptr, void *arg = nullptr) : sink(sink), arg(arg) {}
+
+    // Decode the base64 characters, the characters that are not base64 (e.g. the quotes of JSON string) are skipped.
+    IOPipeline &decodeBase64(Base64Decoder &decoder)
+    {
+        this->decoder = &decoder;
+        return *this;
+    }
+
+    // Update the hashes of the data after they were decoded.
+    IOPipeline &hash(TransferHash &hash)
+    {
+        this->hasher = &hash;
+        return *this;
+    }
+
+    // Process the data by the stages and write the result to the sink, the data buffer is modified.
+    bool write(uint8_t *data, size_t len)
+    {
+        if (decoder && len > 0)
+        {
+            // The decoded bytes are less than the characters, the output does not overtake the unread input.
+            size_t written = 0;
+            if (decoder->decode(data, len, data, len, written) < len)
+                return false;
+            len = written;
+        }
+        if (hasher && len > 0)
+            hasher->update(data, len);
+        return len == 0 || !sink || sink(arg, data, len);
+    }
+
+private:
+    Base64Decoder *decoder = nullptr;
+    TransferHash *hasher = nullptr;
+    Sink sink = nullptr;
+    void *arg = nullptr;
+};
+
+#endif
@@ -0,0 +1,559 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_INFLATE_H
+#define CORE_INFLATE_H
+
+#include <Arduino.h>
+#include <vector>
+#include "./Config.h"
+#include "./core/Memory.h"
+
+// The window size (2^bits bytes) of inflate, the smaller window saves memory but the stream that refers
+// to the data beyond the window (the server compresses with 32 KB window) is failed.
+#if !defined(FIREBASE_INFLATE_WINDOW_BITS)
+#define FIREBASE_INFLATE_WINDOW_BITS 15
+#endif
+
+// The size of input buffer of inflate that keeps the compressed data of block header or symbol that was not completely received.
+#if !defined(FIREBASE_INFLATE_INPUT_SIZE)
+#define FIREBASE_INFLATE_INPUT_SIZE 640
+#endif
+
+// The streaming gzip (RFC 1952) decoder of deflate (RFC 1951) data.
+// The compressed data can be written in any pieces, the decoder is resumed from the last complete symbol.
+class GzipInflate
+{
+public:
+    enum inflate_state
+    {
+        inflate_state_header,
+        inflate_state_block,
+        inflate_state_stored,
+        inflate_state_codes,
+        inflate_state_trailer,
+        inflate_state_done,
+        inflate_state_error
+    };
+
+    // The window bits can be less than FIREBASE_INFLATE_WINDOW_BITS for the data that were compressed with the smaller window.
+    explicit GzipInflate(uint8_t window_bits = FIREBASE_INFLATE_WINDOW_BITS) : window_bits(window_bits) {}
+
+    ~GzipInflate()
+    {
+        Memory mem;
+        mem.release(&window);
+    }
+
+    bool begin()
+    {
+        Memory mem;
+        if (!window)
+            window = reinterpret_cast<uint8_t *>(mem.alloc(1UL << window_bits, false, mem_class_file));
+        state = window ? inflate_state_header : inflate_state_error;
+        in_len = in_pos = 0;
+        bitbuf = 0;
+        bitcnt = 0;
+        wpos = total = 0;
+        match_len = match_dist = 0;
+        last = false;
+        crc = 0xFFFFFFFF;
+        return window != nullptr;
+    }
+
+    // Inflate the compressed data and append to out (String or std::vector<uint8_t> for the binary data),
+    // returns false when the data is not valid.
+    template <typename T>
+    bool write(const uint8_t *data, size_t len, T &out)
+    {
+        while (len > 0 && state != inflate_state_error)
+        {
+            if (state == inflate_state_done)
+                return true;
+
+            size_t n = FIREBASE_INFLATE_INPUT_SIZE - in_len < len ? FIREBASE_INFLATE_INPUT_SIZE - in_len : len;
+            // The header or symbol is larger than input buffer.
+            if (n == 0)
+                return fail();
+            memcpy(in + in_len, data, n);
+            in_len += n;
+            data += n;
+            len -= n;
+            run(out);
+        }
+        return state != inflate_state_error;
+    }
+
+    // All blocks and the trailer were inflated and verified.
+    bool done() const { return state == inflate_state_done; }
+
+    bool failed() const { return state == inflate_state_error; }
+
+private:
+    uint8_t in[FIREBASE_INFLATE_INPUT_SIZE];
+    uint8_t *window = nullptr;
+    uint8_t window_bits = FIREBASE_INFLATE_WINDOW_BITS;
+    size_t in_len = 0, in_pos = 0, save_pos = 0;
+    uint32_t bitbuf = 0, save_buf = 0, crc = 0xFFFFFFFF, total = 0, wpos = 0;
+    uint8_t bitcnt = 0, save_cnt = 0;
+    uint16_t match_len = 0, match_dist = 0, stored_len = 0;
+    bool last = false;
+    inflate_state state = inflate_state_header;
+    // The canonical Huffman tables (the number of codes of each length and the symbols in code order).
+    uint16_t lit_count[16], lit_sym[288], dist_count[16], dist_sym[30];
+
+    bool fail()
+    {
+        state = inflate_state_error;
+        return false;
+    }
+
+    void save()
+    {
+        save_pos = in_pos;
+        save_buf = bitbuf;
+        save_cnt = bitcnt;
+    }
+
+    void restore()
+    {
+        in_pos = save_pos;
+        bitbuf = save_buf;
+        bitcnt = save_cnt;
+    }
+
+    bool need(uint8_t n)
+    {
+        while (bitcnt < n)
+        {
+            if (in_pos >= in_len)
+                return false;
+            bitbuf |= (uint32_t)in[in_pos++] << bitcnt;
+            bitcnt += 8;
+        }
+        return true;
+    }
+
+    uint32_t bits(uint8_t n)
+    {
+        uint32_t v = bitbuf & ((1UL << n) - 1);
+        bitbuf = n < 32 ? bitbuf >> n : 0;
+        bitcnt -= n;
+        return v;
+    }
+
+    bool getBits(uint8_t n, uint32_t &v)
+    {
+        if (!need(n))
+            return false;
+        v = bits(n);
+        return true;
+    }
+
+    void align() { bits(bitcnt & 7); }
+
+    static void put(String &out, uint8_t c) { out += (char)c; }
+
+    static void put(std::vector<uint8_t> &out, uint8_t c) { out.push_back(c); }
+
+    template <typename T>
+    void emit(uint8_t c, T &out)
+    {
+        static const uint32_t crc_table[16] = {0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+                                               0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+        crc ^= c;
+        crc = (crc >> 4) ^ crc_table[crc & 15];
+        crc = (crc >> 4) ^ crc_table[crc & 15];
+        window[wpos] = c;
+        wpos = (wpos + 1) & ((1UL << window_bits) - 1);
+        total++;
+        put(out, c);
+    }
+
+    // Returns 1 for the symbol, 0 for more input required and -1 for invalid code.
+    int decode(const uint16_t *count, const uint16_t *sym, uint16_t &value)
+    {
+        int code = 0, first = 0, index = 0;
+        for (uint8_t len = 1; len < 16; len++)
+        {
+            if (!need(1))
+                return 0;
+            code |= bits(1);
+            int n = count[len];
+            if (code - first < n)
+            {
+                value = sym[index + code - first];
+                return 1;
+            }
+            index += n;
+            first += n;
+            first <<= 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+
+    bool build(uint16_t *count, uint16_t *sym, const uint8_t *lengths, uint16_t n)
+    {
+        uint16_t offs[16];
+        memset(count, 0, 16 * sizeof(uint16_t));
+        for (uint16_t i = 0; i < n; i++)
+            count[lengths[i]]++;
+        count[0] = 0;
+
+        // The over-subscribed code is not valid.
+        int left = 1;
+        for (uint8_t len = 1; len < 16; len++)
+        {
+            left <<= 1;
+            left -= count[len];
+            if (left < 0)
+                return false;
+        }
+
+        offs[1] = 0;
+        for (uint8_t len = 1; len < 15; len++)
+            offs[len + 1] = offs[len] + count[len];
+        for (uint16_t i = 0; i < n; i++)
+        {
+            if (lengths[i])
+                sym[offs[lengths[i]]++] = i;
+        }
+        return true;
+    }
+
+    void fixedTables()
+    {
+        uint8_t lengths[288];
+        memset(lengths, 8, 144);
+        memset(lengths + 144, 9, 112);
+        memset(lengths + 256, 7, 24);
+        memset(lengths + 280, 8, 8);
+        build(lit_count, lit_sym, lengths, 288);
+        memset(lengths, 5, 30);
+        build(dist_count, dist_sym, lengths, 30);
+    }
+
+    // Returns 1 for the tables, 0 for more input required and -1 for invalid header.
+    int dynamicTables()
+    {
+        static const uint8_t order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+        uint8_t lengths[320];
+        uint16_t cl_count[16], cl_sym[19];
+        uint32_t hlit, hdist, hclen, v;
+
+        if (!getBits(5, hlit) || !getBits(5, hdist) || !getBits(4, hclen))
+            return 0;
+        hlit += 257;
+        hdist += 1;
+        hclen += 4;
+        if (hlit > 286 || hdist > 30)
+            return -1;
+
+        memset(lengths, 0, 19);
+        for (uint8_t i = 0; i < hclen; i++)
+        {
+            if (!getBits(3, v))
+                return 0;
+            lengths[order[i]] = v;
+        }
+
+        if (!build(cl_count, cl_sym, lengths, 19))
+            return -1;
+
+        uint16_t i = 0;
+        while (i < hlit + hdist)
+        {
+            uint16_t sym = 0;
+            int ret = decode(cl_count, cl_sym, sym);
+            if (ret <= 0)
+                return ret;
+
+            if (sym < 16)
+            {
+                lengths[i++] = sym;
+                continue;
+            }
+
+            uint8_t len = 0;
+            uint32_t rep = 0;
+            if (sym == 16)
+            {
+                if (i == 0)
+                    return -1;
+                len = lengths[i - 1];
+                if (!getBits(2, rep))
+                    return 0;
+                rep += 3;
+            }
+            else if (sym == 17)
+            {
+                if (!getBits(3, rep))
+                    return 0;
+                rep += 3;
+            }
+            else
+            {
+                if (!getBits(7, rep))
+                    return 0;
+                rep += 11;
+            }
+
+            if (i + rep > hlit + hdist)
+                return -1;
+            while (rep--)
+                lengths[i++] = len;
+        }
+
+        // The end of block code is required.
+        if (lengths[256] == 0)
+            return -1;
+
+        if (!build(lit_count, lit_sym, lengths, hlit) || !build(dist_count, dist_sym, lengths + hlit, hdist))
+            return -1;
+        return 1;
+    }
+
+    // Returns 1 for the header, 0 for more input required and -1 for invalid header.
+    int header()
+    {
+        uint32_t id1, id2, cm, flg, v;
+        if (!getBits(8, id1) || !getBits(8, id2) || !getBits(8, cm) || !getBits(8, flg))
+            return 0;
+        if (id1 != 0x1f || id2 != 0x8b || cm != 8)
+            return -1;
+
+        // MTIME, XFL and OS
+        for (uint8_t i = 0; i < 6; i++)
+        {
+            if (!getBits(8, v))
+                return 0;
+        }
+
+        // FEXTRA
+        if (flg & 4)
+        {
+            uint32_t xlen;
+            if (!getBits(16, xlen))
+                return 0;
+            while (xlen--)
+            {
+                if (!getBits(8, v))
+                    return 0;
+            }
+        }
+
+        // FNAME and FCOMMENT
+        for (uint8_t f = 8; f <= 16; f <<= 1)
+        {
+            if (flg & f)
+            {
+                do
+                {
+                    if (!getBits(8, v))
+                        return 0;
+                } while (v != 0);
+            }
+        }
+
+        // FHCRC
+        if ((flg & 2) && !getBits(16, v))
+            return 0;
+
+        return 1;
+    }
+
+    // Returns 1 for the length and distance, 0 for more input required and -1 for invalid code.
+    int match(uint16_t sym)
+    {
+        static const uint16_t len_base[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static const uint8_t len_extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        static const uint16_t dist_base[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+        static const uint8_t dist_extra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+        sym -= 257;
+        if (sym >= 29)
+            return -1;
+
+        uint32_t extra = 0;
+        if (!getBits(len_extra[sym], extra))
+            return 0;
+        uint16_t len = len_base[sym] + extra;
+
+        uint16_t dsym = 0;
+        int ret = decode(dist_count, dist_sym, dsym);
+        if (ret <= 0)
+            return ret;
+        if (dsym >= 30)
+            return -1;
+        if (!getBits(dist_extra[dsym], extra))
+            return 0;
+        uint16_t dist = dist_base[dsym] + extra;
+
+        // The distance is beyond the output or window.
+        if (dist > total || dist > (1UL << window_bits))
+            return -1;
+
+        match_len = len;
+        match_dist = dist;
+        return 1;
+    }
+
+    template <typename T>
+    void run(T &out)
+    {
+        int ret = 1;
+        while (ret > 0 && state != inflate_state_done && state != inflate_state_error)
+        {
+            save();
+            ret = 1;
+            switch (state)
+            {
+            case inflate_state_header:
+                ret = header();
+                if (ret > 0)
+                    state = inflate_state_block;
+                break;
+
+            case inflate_state_block:
+            {
+                uint32_t v = 0;
+                if (!getBits(3, v))
+                {
+                    ret = 0;
+                    break;
+                }
+                last = v & 1;
+                v >>= 1;
+                if (v == 0)
+                {
+                    uint32_t len, nlen;
+                    align();
+                    if (!getBits(16, len) || !getBits(16, nlen))
+                        ret = 0;
+                    else if ((len ^ 0xFFFF) != nlen)
+                        ret = -1;
+                    else
+                    {
+                        stored_len = len;
+                        state = inflate_state_stored;
+                    }
+                }
+                else if (v == 1)
+                {
+                    fixedTables();
+                    state = inflate_state_codes;
+                }
+                else if (v == 2)
+                {
+                    ret = dynamicTables();
+                    if (ret > 0)
+                        state = inflate_state_codes;
+                }
+                else
+                    ret = -1;
+            }
+            break;
+
+            case inflate_state_stored:
+            {
+                uint32_t v = 0;
+                while (stored_len > 0 && getBits(8, v))
+                {
+                    emit(v, out);
+                    stored_len--;
+                }
+                if (stored_len > 0)
+                {
+                    save();
+                    ret = 0;
+                }
+                else
+                    state = last ? inflate_state_trailer : inflate_state_block;
+            }
+            break;
+
+            case inflate_state_codes:
+            {
+                if (match_len > 0)
+                {
+                    while (match_len > 0)
+                    {
+                        emit(window[(wpos - match_dist) & ((1UL << window_bits) - 1)], out);
+                        match_len--;
+                    }
+                    break;
+                }
+
+                uint16_t sym = 0;
+                ret = decode(lit_count, lit_sym, sym);
+                if (ret <= 0)
+                    break;
+                if (sym < 256)
+                    emit(sym, out);
+                else if (sym == 256)
+                    state = last ? inflate_state_trailer : inflate_state_block;
+                else
+                    ret = match(sym);
+            }
+            break;
+
+            case inflate_state_trailer:
+            {
+                uint32_t c0, c1, s0, s1;
+                align();
+                if (!getBits(16, c0) || !getBits(16, c1) || !getBits(16, s0) || !getBits(16, s1))
+                    ret = 0;
+                else if ((c0 | (c1 << 16)) != (crc ^ 0xFFFFFFFF) || (s0 | (s1 << 16)) != total)
+                    ret = -1;
+                else
+                    state = inflate_state_done;
+            }
+            break;
+
+            default:
+                break;
+            }
+        }
+
+        if (ret < 0)
+        {
+            fail();
+            return;
+        }
+
+        // The incomplete header or symbol is decoded again when more data was received.
+        if (ret == 0)
+            restore();
+
+        if (in_pos > 0)
+        {
+            memmove(in, in + in_pos, in_len - in_pos);
+            in_len -= in_pos;
+            in_pos = 0;
+        }
+    }
+};
+
+#endif
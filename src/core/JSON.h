@@ -106,7 +106,7 @@ public:
         }
         tmp += ']';
         addObject(buf, name, tmp, false, last);
-        delete p;
+        delete[] p;
     }
 
     String toString(const String &value)
@@ -119,6 +119,212 @@ public:
     }
 };
 
+// The JSON writer that writes the tokens to Print directly e.g. within the payload writer callback.
+class JsonStreamWriter
+{
+private:
+    Print *out = nullptr;
+    // The bit of each nesting level is set until its first member was written.
+    uint32_t first = 1;
+    uint8_t depth = 0;
+
+    void sep()
+    {
+        if (!(first & (1UL << depth)))
+            out->print(',');
+        first &= ~(1UL << depth);
+    }
+
+    void name(const char *key)
+    {
+        sep();
+        if (key)
+        {
+            quoted(key);
+            out->print(':');
+        }
+    }
+
+    void open(char c)
+    {
+        out->print(c);
+        if (depth < 31)
+            depth++;
+        first |= (1UL << depth);
+    }
+
+    void close(char c)
+    {
+        if (depth > 0)
+            depth--;
+        out->print(c);
+    }
+
+    void quoted(const char *v)
+    {
+        out->print('"');
+        for (const char *p = v; p && *p; p++)
+        {
+            if (*p == '"' || *p == '\\')
+                out->print('\\');
+            out->print(*p);
+        }
+        out->print('"');
+    }
+
+public:
+    // The output should be set by setOutput before writing.
+    JsonStreamWriter() {}
+
+    JsonStreamWriter(Print &out) : out(&out) {}
+
+    // Set the output and keep the nesting state e.g. for the next part of payload writer.
+    void setOutput(Print &out) { this->out = &out; }
+
+    // Clear the nesting state.
+    void clear()
+    {
+        first = 1;
+        depth = 0;
+    }
+
+    // The key should be nullptr for array element.
+    void beginObject(const char *key = nullptr)
+    {
+        name(key);
+        open('{');
+    }
+
+    void endObject() { close('}'); }
+
+    void beginArray(const char *key = nullptr)
+    {
+        name(key);
+        open('[');
+    }
+
+    void endArray() { close(']'); }
+
+    void add(const char *key, const char *value)
+    {
+        name(key);
+        quoted(value);
+    }
+
+    void add(const char *key, const String &value) { add(key, value.c_str()); }
+
+    void add(const char *key, bool value)
+    {
+        name(key);
+        out->print(value ? FPSTR("true") : FPSTR("false"));
+    }
+
+    template <typename T>
+    auto add(const char *key, T value) -> typename std::enable_if<ValueConverter::v_number<T>::value, void>::type
+    {
+        name(key);
+        out->print(value);
+    }
+
+    // Add the serialized JSON value e.g. object_t.
+    void addRaw(const char *key, const char *json)
+    {
+        name(key);
+        out->print(json);
+    }
+};
+
+// The JSON template of fixed-shape payload, its skeleton is kept in flash and only the values are formatted at runtime.
+// The value placeholder in skeleton is '%' and "%%" is the literal '%' e.g.
+// static const char reading[] PROGMEM = "{\"t\":%,\"v\":%,\"s\":\"%\"}";
+class JsonTemplate
+{
+private:
+    PGM_P tpl = nullptr;
+    size_t tpl_len = 0, static_len = 0;
+
+    // Write the skeleton until the next placeholder.
+    size_t skeleton(Print &out, size_t &pos)
+    {
+        size_t n = 0;
+        while (pos < tpl_len)
+        {
+            char c = pgm_read_byte(tpl + pos++);
+            if (c == '%')
+            {
+                if (pos < tpl_len && pgm_read_byte(tpl + pos) == '%')
+                    pos++;
+                else
+                    break;
+            }
+            n += out.write(c);
+        }
+        return n;
+    }
+
+    size_t value(Print &out, bool v) { return out.print(v ? FPSTR("true") : FPSTR("false")); }
+
+    template <typename T>
+    auto value(Print &out, const T &v) -> typename std::enable_if<!std::is_same<T, bool>::value, size_t>::type { return out.print(v); }
+
+    size_t values(Print &out, size_t &pos) { return skeleton(out, pos); }
+
+    template <typename T, typename... Args>
+    size_t values(Print &out, size_t &pos, const T &v, const Args &...args)
+    {
+        size_t n = skeleton(out, pos);
+        n += value(out, v);
+        return n + values(out, pos, args...);
+    }
+
+public:
+    JsonTemplate(PGM_P tpl) : tpl(tpl), tpl_len(tpl ? strlen_P(tpl) : 0)
+    {
+        // The skeleton length without placeholders.
+        for (size_t i = 0; i < tpl_len; i++, static_len++)
+        {
+            if (pgm_read_byte(tpl + i) == '%' && (i + 1 == tpl_len || pgm_read_byte(tpl + i + 1) != '%'))
+                static_len--;
+            else if (pgm_read_byte(tpl + i) == '%')
+                i++;
+        }
+    }
+
+    // The length of skeleton without values.
+    size_t staticLength() const { return static_len; }
+
+    // Get the exact length of payload e.g. for Content-Length, only the values are formatted.
+    template <typename... Args>
+    size_t length(const Args &...args)
+    {
+        CountPrint counter;
+        // Start at the end of skeleton which counts the values only.
+        size_t pos = tpl_len;
+        return static_len + values(counter, pos, args...);
+    }
+
+    // Write the payload to Print e.g. within the payload writer callback.
+    template <typename... Args>
+    size_t print(Print &out, const Args &...args)
+    {
+        size_t pos = 0;
+        return values(out, pos, args...);
+    }
+
+    // Create the payload with exact capacity.
+    template <typename... Args>
+    object_t create(const Args &...args)
+    {
+        String buf;
+        size_t len = length(args...);
+        buf.reserve(len);
+        StringPrint sp(buf, len);
+        size_t pos = 0;
+        values(sp, pos, args...);
+        return object_t(std::move(buf));
+    }
+};
+
 class JsonWriter
 {
 
@@ -151,7 +357,7 @@ private:
             pp = end;
         }
 
-        delete p;
+        delete[] p;
         return i;
     }
     void ek(object_t &obj, int i)
@@ -179,7 +385,7 @@ public:
     }
 
     template <typename T>
-    auto create(object_t &obj, const String &path, T value) -> typename std::enable_if<std::is_same<T, object_t>::value || std::is_same<T, string_t>::value || std::is_same<T, number_t>::value || std::is_same<T, boolean_t>::value, void>::type
+    auto create(object_t &obj, const String &path, const T &value) -> typename std::enable_if<std::is_same<T, object_t>::value || std::is_same<T, string_t>::value || std::is_same<T, number_t>::value || std::is_same<T, boolean_t>::value, void>::type
     {
         int i = prek(obj, path);
         obj += value.c_str();
@@ -209,4 +415,188 @@ public:
     }
 };
 
+// The builder that collects the values by key path into the tree and serializes them at once.
+// The flat tree is for multi-location update e.g. {"a/b":1,"a/c":2} which does not replace the other children of "a".
+class JsonTreeBuilder : public Printable
+{
+private:
+    struct json_tree_node_t
+    {
+        // The key and value spans in pool.
+        uint32_t key_pos = 0, val_pos = 0;
+        uint16_t key_len = 0;
+        uint32_t val_len = 0;
+        int32_t first_child = -1, last_child = -1, next_sibling = -1;
+        bool leaf = false;
+    };
+
+    std::vector<json_tree_node_t> nodes;
+    String pool, tmp;
+    ValueConverter vcon;
+    bool flat = false;
+
+    bool keyIs(const json_tree_node_t &node, const char *key, size_t len) const { return node.key_len == len && strncmp(pool.c_str() + node.key_pos, key, len) == 0; }
+
+    int32_t node(const char *path)
+    {
+        if (nodes.size() == 0)
+            nodes.push_back(json_tree_node_t());
+
+        int32_t cur = 0;
+        while (path && *path)
+        {
+            if (*path == '/')
+            {
+                path++;
+                continue;
+            }
+
+            const char *end = strchr(path, '/');
+            size_t len = end ? (size_t)(end - path) : strlen(path);
+
+            // The leaf becomes the branch.
+            nodes[cur].leaf = false;
+
+            int32_t child = nodes[cur].first_child;
+            while (child > -1 && !keyIs(nodes[child], path, len))
+                child = nodes[child].next_sibling;
+
+            if (child == -1)
+            {
+                json_tree_node_t n;
+                n.key_pos = pool.length();
+                n.key_len = len;
+                for (size_t i = 0; i < len; i++)
+                    pool += path[i];
+
+                child = nodes.size();
+                if (nodes[cur].last_child == -1)
+                    nodes[cur].first_child = child;
+                else
+                    nodes[nodes[cur].last_child].next_sibling = child;
+                nodes[cur].last_child = child;
+                nodes.push_back(n);
+            }
+
+            cur = child;
+            path = end;
+        }
+        return cur;
+    }
+
+    size_t printKey(Print &out, const json_tree_node_t &n) const { return out.write((const uint8_t *)pool.c_str() + n.key_pos, n.key_len); }
+
+    size_t printValue(Print &out, const json_tree_node_t &n) const { return out.write((const uint8_t *)pool.c_str() + n.val_pos, n.val_len); }
+
+    size_t printNode(Print &out, int32_t idx) const
+    {
+        const json_tree_node_t &n = nodes[idx];
+        if (n.leaf)
+            return printValue(out, n);
+
+        size_t len = out.print('{');
+        for (int32_t c = n.first_child; c > -1; c = nodes[c].next_sibling)
+        {
+            if (c != n.first_child)
+                len += out.print(',');
+            len += out.print('"');
+            len += printKey(out, nodes[c]);
+            len += out.print(FPSTR("\":"));
+            len += printNode(out, c);
+        }
+        return len + out.print('}');
+    }
+
+    size_t printFlat(Print &out, int32_t idx, std::vector<int32_t> &path, bool &first) const
+    {
+        size_t len = 0;
+        const json_tree_node_t &n = nodes[idx];
+        if (n.leaf)
+        {
+            if (!first)
+                len += out.print(',');
+            first = false;
+            len += out.print('"');
+            for (size_t i = 0; i < path.size(); i++)
+            {
+                if (i > 0)
+                    len += out.print('/');
+                len += printKey(out, nodes[path[i]]);
+            }
+            len += out.print(FPSTR("\":"));
+            return len + printValue(out, n);
+        }
+
+        for (int32_t c = n.first_child; c > -1; c = nodes[c].next_sibling)
+        {
+            path.push_back(c);
+            len += printFlat(out, c, path, first);
+            path.pop_back();
+        }
+        return len;
+    }
+
+public:
+    JsonTreeBuilder(bool flat = false) : flat(flat) {}
+
+    /**
+     * Add the value at the key path, the value at the same path is replaced.
+     *
+     * @param path The key path that separated by "/".
+     * @param value The value, the types are the same as RealtimeDatabase::set.
+     */
+    template <typename T>
+    JsonTreeBuilder &add(const String &path, const T &value)
+    {
+        vcon.getVal(tmp, value);
+        json_tree_node_t &n = nodes[node(path.c_str())];
+        n.leaf = true;
+        n.first_child = -1;
+        n.last_child = -1;
+        n.val_pos = pool.length();
+        n.val_len = tmp.length();
+        pool += tmp;
+        return *this;
+    }
+
+    void clear()
+    {
+        nodes.clear();
+        pool.remove(0, pool.length());
+    }
+
+    // The exact length of serialized JSON.
+    size_t length() const
+    {
+        CountPrint counter;
+        return printTo(counter);
+    }
+
+    size_t printTo(Print &out) const
+    {
+        if (nodes.size() == 0)
+            return out.print(FPSTR("{}"));
+
+        if (!flat || nodes[0].leaf)
+            return printNode(out, 0);
+
+        std::vector<int32_t> path;
+        bool first = true;
+        size_t len = out.print('{');
+        len += printFlat(out, 0, path, first);
+        return len + out.print('}');
+    }
+
+    // Serialize the tree in single pass with exact capacity.
+    void create(object_t &obj) const
+    {
+        String buf;
+        size_t len = length();
+        buf.reserve(len);
+        StringPrint out(buf, len);
+        printTo(out);
+        obj = object_t(std::move(buf));
+    }
+};
+
 #endif
\ No newline at end of file
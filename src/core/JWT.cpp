@@ -34,37 +34,127 @@
 #include "./core/JSON.h"
 #include "./core/Error.h"
 #include "./core/Core.h"
+#include "./core/FNV.h"
 
 #if defined(ENABLE_JWT)
 
 #include "JWT.h"
 
-#if defined(USE_EMBED_SSL_ENGINE) && !defined(CORE_MOCK)
-extern "C"
-{
-#if defined(ESP8266)
-    make_stack_thunk(br_rsa_i15_pkcs1_sign);
-#endif
-};
-#endif
-
 JWTClass::JWTClass()
 {
     err_timer.feed(1);
-#if defined(USE_EMBED_SSL_ENGINE)
-    stack_thunk_add_ref();
-#endif
+    memset(&rsa_key, 0, sizeof(br_rsa_private_key));
+    memset(jwt_data.hash, 0, sizeof(jwt_data.hash));
 }
 
 JWTClass::~JWTClass()
 {
-#if defined(USE_EMBED_SSL_ENGINE)
-    stack_thunk_del_ref();
+    exit(false);
+    clearKey();
+}
+
+void JWTClass::clearKey()
+{
+    if (rsa_key_buf)
+    {
+        signer.clear();
+        volatile uint8_t *p = rsa_key_buf;
+        for (size_t i = 0; i < rsa_key.plen + rsa_key.qlen + rsa_key.dplen + rsa_key.dqlen + rsa_key.iqlen; i++)
+            p[i] = 0;
+        mem.release(&rsa_key_buf);
+    }
+    memset(&rsa_key, 0, sizeof(br_rsa_private_key));
+    rsa_key_id = 0;
+}
+
+bool JWTClass::loadKey(const String &pem)
+{
+    // The FNV-1a hash of PEM key that the cached key was decoded from.
+    uint32_t id = FNV1a::hash(pem.c_str(), pem.length());
+
+    if (rsa_key_buf && rsa_key_id == id)
+        return true;
+
+    clearKey();
+
+    PrivateKey pk(pem.c_str());
+    if (!pk.isRSA())
+        return false;
+
+    const br_rsa_private_key *sk = pk.getRSA();
+    if (!allocKey(sk->n_bitlen, sk->plen, sk->qlen, sk->dplen, sk->dqlen, sk->iqlen))
+        return false;
+
+    memcpy(rsa_key.p, sk->p, sk->plen);
+    memcpy(rsa_key.q, sk->q, sk->qlen);
+    memcpy(rsa_key.dp, sk->dp, sk->dplen);
+    memcpy(rsa_key.dq, sk->dq, sk->dqlen);
+    memcpy(rsa_key.iq, sk->iq, sk->iqlen);
+    rsa_key_id = id;
+    return true;
+}
+
+#if defined(ENABLE_SERVICE_AUTH)
+bool JWTClass::loadKey(const service_account_key_t *key)
+{
+    // The preparsed key is identified by its address, it is copied from flash without decoding.
+    uint32_t id = (uint32_t)(uintptr_t)key;
+    if (rsa_key_buf && rsa_key_id == id)
+        return true;
+
+    clearKey();
+
+    if (!key->p || !key->q || !key->dp || !key->dq || !key->iq)
+        return false;
+
+    if (!allocKey(key->n_bitlen, key->plen, key->qlen, key->dplen, key->dqlen, key->iqlen))
+        return false;
+
+    memcpy_P(rsa_key.p, key->p, key->plen);
+    memcpy_P(rsa_key.q, key->q, key->qlen);
+    memcpy_P(rsa_key.dp, key->dp, key->dplen);
+    memcpy_P(rsa_key.dq, key->dq, key->dqlen);
+    memcpy_P(rsa_key.iq, key->iq, key->iqlen);
+    rsa_key_id = id;
+    return true;
+}
 #endif
+
+bool JWTClass::allocKey(uint32_t n_bitlen, size_t plen, size_t qlen, size_t dplen, size_t dqlen, size_t iqlen)
+{
+    rsa_key_buf = reinterpret_cast<uint8_t *>(mem.alloc(plen + qlen + dplen + dqlen + iqlen, false, mem_class_key));
+    if (!rsa_key_buf)
+        return false;
+
+    uint8_t *p = rsa_key_buf;
+    rsa_key.n_bitlen = n_bitlen;
+    rsa_key.p = p, rsa_key.plen = plen, p += plen;
+    rsa_key.q = p, rsa_key.qlen = qlen, p += qlen;
+    rsa_key.dp = p, rsa_key.dplen = dplen, p += dplen;
+    rsa_key.dq = p, rsa_key.dqlen = dqlen, p += dqlen;
+    rsa_key.iq = p, rsa_key.iqlen = iqlen;
+    return true;
 }
 
 const char *JWTClass::token() { return jwt_data.token.c_str(); }
 
+void JWTClass::appendEncoded(const uint8_t *data, size_t len, JWTHash *hash)
+{
+    // 48 bytes are encoded to 64 characters.
+    char buf[65];
+    while (len > 0)
+    {
+        size_t n = len > 48 ? 48 : len;
+        size_t c = but.encodeChars(data, n, buf, true);
+        buf[c] = '\0';
+        if (hash)
+            hash->update(buf, c);
+        jwt_data.token += buf;
+        data += n;
+        len -= n;
+    }
+}
+
 void JWTClass::clear()
 {
     jwt_data.token.remove(0, jwt_data.token.length());
@@ -75,7 +165,7 @@ void JWTClass::clear()
         this->auth_data->user_auth.sa.step = jwt_step_begin;
         this->auth_data->user_auth.jwt_ts = 0;
     }
-    processing = false;
+    exit(false);
 }
 
 bool JWTClass::ready()
@@ -93,6 +183,14 @@ bool JWTClass::loop(auth_data_t *auth_data)
             sendErrCB(auth_data ? auth_data->cb : NULL, nullptr);
         return ret;
     }
+    // The RSA signing is continued.
+    else if (auth_data && this->auth_data == auth_data && auth_data->user_auth.sa.step == jwt_step_sign && signer.busy())
+    {
+        bool ret = create();
+        if (!ret)
+            sendErrCB(auth_data->cb, nullptr);
+        return ret;
+    }
     return false;
 }
 
@@ -142,12 +240,17 @@ bool JWTClass::create()
     if (auth_data->user_auth.sa.step == jwt_step_begin)
     {
 
-        uint32_t now = 0;
-        if (auth_data->user_auth.timestatus_cb)
-            auth_data->user_auth.timestatus_cb(now);
+        uint32_t now = WallClock::shared().now(auth_data->user_auth.timestatus_cb);
 
         if (now < FIREBASE_DEFAULT_TS)
         {
+            // The private key is decoded while waiting for the network and time, it is not decoded again at signing.
+            const String &pem = jwt_data.pk.length() > 0 ? jwt_data.pk : auth_data->user_auth.sa.val[sa_ns::pk];
+            if (auth_data->user_auth.sa.key)
+                loadKey(auth_data->user_auth.sa.key);
+            else if (pem.length() > 0)
+                loadKey(pem);
+
             jwt_data.err_code = FIREBASE_ERROR_TIME_IS_NOT_SET_OR_INVALID;
             jwt_data.msg = (const char *)FPSTR("JWT, time was not set or not valid");
             return exit(false);
@@ -163,8 +266,17 @@ bool JWTClass::create()
         // {"iss":"<email>","sub":"<email>","aud":"<audience>","iat":<timstamp>,"exp":<expire>,"scope":"<scope>"}
         // {"iss":"<email>","sub":"<email>","aud":"<audience>","iat":<timstamp>,"exp":<expire>,"uid":"<uid>","claims":"<claims>"}
 
-        json.addObject(payload, "iss", auth_data->user_auth.sa.val[sa_ns::cm], true);
-        json.addObject(payload, "sub", auth_data->user_auth.sa.val[sa_ns::cm], true);
+        if (auth_data->user_auth.sa.key)
+        {
+            // The preformatted constant claims of preparsed credentials.
+            payload = '{';
+            payload += FPSTR(auth_data->user_auth.sa.key->claims);
+        }
+        else
+        {
+            json.addObject(payload, "iss", auth_data->user_auth.sa.val[sa_ns::cm], true);
+            json.addObject(payload, "sub", auth_data->user_auth.sa.val[sa_ns::cm], true);
+        }
 
         String t = FPSTR("https://");
         if (auth_data->user_auth.auth_type == auth_sa_custom_token)
@@ -243,85 +355,75 @@ bool JWTClass::create()
                 json.addObject(payload, "claims", auth_data->user_auth.cust.val[cust_ns::claims], true, true);
         }
 
-        len = but.encodedLength(payload.length());
-        char *buf = reinterpret_cast<char *>(mem.alloc(len));
-        but.encodeUrl(mem, buf, (unsigned char *)payload.c_str(), payload.length());
-        payload.remove(0, payload.length());
+        // The token is reserved for the encoded payload and the 2048-bit RSA signature (342 characters).
+        len = (payload.length() * 4 + 2) / 3;
+        jwt_data.token.reserve(jwt_data.token.length() + len + 2 + 342);
         jwt_data.token += '.';
-        jwt_data.token += buf;
-        mem.release(&buf);
-
-        // create message digest from encoded header and payload
-        br_sha256_context mc;
-        br_sha256_init(&mc);
-        br_sha256_update(&mc, jwt_data.token.c_str(), jwt_data.token.length());
-        if (!jwt_data.hash)
-            jwt_data.hash = reinterpret_cast<char *>(mem.alloc(32));
-        br_sha256_out(&mc, jwt_data.hash);
+
+        // create message digest from encoded header and payload while the payload is encoded
+        JWTHash hash;
+        hash.begin();
+        hash.update(jwt_data.token.c_str(), jwt_data.token.length());
+        appendEncoded((const uint8_t *)payload.c_str(), payload.length(), &hash);
+        payload.remove(0, payload.length());
+        hash.end(jwt_data.hash);
         jwt_data.token += '.';
 
         auth_data->user_auth.sa.step = jwt_step_sign;
     }
     else if (auth_data->user_auth.sa.step == jwt_step_sign)
     {
-        // RSA private key
-        PrivateKey *pk = nullptr;
         sys_idle();
-        // parse priv key
-        if (jwt_data.pk.length() > 0)
-            pk = new PrivateKey(jwt_data.pk.c_str());
-        else if (auth_data->user_auth.sa.val[sa_ns::pk].length() > 0)
-            pk = new PrivateKey(auth_data->user_auth.sa.val[sa_ns::pk].c_str());
 
-        jwt_data.pk.remove(0, jwt_data.pk.length());
-
-        if (!pk)
+        if (!signer.busy())
         {
-            jwt_data.err_code = FIREBASE_ERROR_TOKEN_PARSE_PK;
-            jwt_data.msg = (const char *)FPSTR("JWT, private key parsing fail");
-            auth_data->user_auth.sa.step = jwt_step_error;
-            return exit(false);
-        }
+            // The PEM private key is decoded only when it was changed.
+            const String &pem = jwt_data.pk.length() > 0 ? jwt_data.pk : auth_data->user_auth.sa.val[sa_ns::pk];
 
-        if (!pk->isRSA())
-        {
-            delete pk;
-            pk = nullptr;
-            jwt_data.err_code = FIREBASE_ERROR_TOKEN_PARSE_PK;
-            jwt_data.msg = (const char *)FPSTR("JWT, invalid RSA private key");
-            auth_data->user_auth.sa.step = jwt_step_error;
-            return exit(false);
-        }
+            if (auth_data->user_auth.sa.key == nullptr && pem.length() == 0)
+            {
+                jwt_data.err_code = FIREBASE_ERROR_TOKEN_PARSE_PK;
+                jwt_data.msg = (const char *)FPSTR("JWT, private key parsing fail");
+                auth_data->user_auth.sa.step = jwt_step_error;
+                return exit(false);
+            }
 
-        const br_rsa_private_key *br_rsa_key = pk->getRSA();
+            bool loaded = auth_data->user_auth.sa.key ? loadKey(auth_data->user_auth.sa.key) : loadKey(pem);
+            jwt_data.pk.remove(0, jwt_data.pk.length());
 
-        // generate RSA signature from private key and message digest
-        sys_idle();
-        if (!jwt_data.signature)
-            jwt_data.signature = reinterpret_cast<unsigned char *>(mem.alloc(256));
-        int ret = br_rsa_i15_pkcs1_sign(BR_HASH_OID_SHA256, (const unsigned char *)jwt_data.hash, br_sha256_SIZE, br_rsa_key, jwt_data.signature);
-        sys_idle();
+            if (!loaded)
+            {
+                jwt_data.err_code = FIREBASE_ERROR_TOKEN_PARSE_PK;
+                jwt_data.msg = (const char *)FPSTR("JWT, invalid RSA private key");
+                auth_data->user_auth.sa.step = jwt_step_error;
+                return exit(false);
+            }
 
-        if (jwt_data.hash)
-            mem.release(&jwt_data.hash);
+            // The RSA signature of message digest is generated in time slices of the following loops.
+            if (!signer.begin(&rsa_key, jwt_data.hash))
+            {
+                jwt_data.err_code = FIREBASE_ERROR_TOKEN_SIGN;
+                jwt_data.msg = (const char *)FPSTR("JWT, token signing fail");
+                auth_data->user_auth.sa.step = jwt_step_error;
+                return exit(false);
+            }
+            return true;
+        }
 
-        size_t len = but.encodedLength(256);
-        char *buf = reinterpret_cast<char *>(mem.alloc(len));
-        but.encodeUrl(mem, buf, jwt_data.signature, 256);
+        int ret = signer.step();
+        if (ret == 0)
+            return true;
 
-        delete pk;
-        pk = nullptr;
+        memset(jwt_data.hash, 0, sizeof(jwt_data.hash));
 
         // get the signed JWT
         if (ret > 0)
         {
-            jwt_data.token += buf;
-            mem.release(&buf);
+            appendEncoded(signer.signature(), signer.signatureLength(), nullptr);
             auth_data->user_auth.sa.step = jwt_step_ready;
         }
         else
         {
-            mem.release(&buf);
             jwt_data.err_code = FIREBASE_ERROR_TOKEN_SIGN;
             jwt_data.msg = (const char *)FPSTR("JWT, token signing fail");
             auth_data->user_auth.sa.step = jwt_step_error;
@@ -35,6 +35,7 @@
 #include "./core/Error.h"
 #include "./core/Core.h"
 #include "./core/Timer.h"
+#include "./core/RSASigner.h"
 
 #if defined(ENABLE_JWT)
 
@@ -44,6 +45,13 @@
 #include "./client/SSLClient/ESP_SSLClient.h"
 #endif
 
+// The SHA256 of ESP32 mbedtls uses the SHA peripheral.
+#if defined(ESP32) && !defined(FIREBASE_DISABLE_HW_SHA256) && __has_include(<mbedtls/sha256.h>)
+#include <mbedtls/sha256.h>
+#include <mbedtls/version.h>
+#define FIREBASE_JWT_HW_SHA256
+#endif
+
 using namespace firebase;
 
 namespace firebase
@@ -64,8 +72,60 @@ namespace firebase
         int err_code = 0;
         String msg;
         String pk;
-        char *hash = nullptr;               // SHA256 size (256 bits or 32 bytes)
-        unsigned char *signature = nullptr; // 256 bytes
+        uint8_t hash[32]; // SHA256 size (256 bits or 32 bytes)
+    };
+
+    // The incremental SHA256 of JWT signing input.
+    class JWTHash
+    {
+    private:
+#if defined(FIREBASE_JWT_HW_SHA256)
+        mbedtls_sha256_context ctx;
+#else
+        br_sha256_context ctx;
+#endif
+
+    public:
+        void begin()
+        {
+#if defined(FIREBASE_JWT_HW_SHA256)
+            mbedtls_sha256_init(&ctx);
+#if MBEDTLS_VERSION_MAJOR >= 3
+            mbedtls_sha256_starts(&ctx, 0);
+#else
+            mbedtls_sha256_starts_ret(&ctx, 0);
+#endif
+#else
+            br_sha256_init(&ctx);
+#endif
+        }
+
+        void update(const char *data, size_t len)
+        {
+#if defined(FIREBASE_JWT_HW_SHA256)
+#if MBEDTLS_VERSION_MAJOR >= 3
+            mbedtls_sha256_update(&ctx, (const unsigned char *)data, len);
+#else
+            mbedtls_sha256_update_ret(&ctx, (const unsigned char *)data, len);
+#endif
+#else
+            br_sha256_update(&ctx, data, len);
+#endif
+        }
+
+        void end(uint8_t *out)
+        {
+#if defined(FIREBASE_JWT_HW_SHA256)
+#if MBEDTLS_VERSION_MAJOR >= 3
+            mbedtls_sha256_finish(&ctx, out);
+#else
+            mbedtls_sha256_finish_ret(&ctx, out);
+#endif
+            mbedtls_sha256_free(&ctx);
+#else
+            br_sha256_out(&ctx, out);
+#endif
+        }
     };
 
     class JWTClass
@@ -83,19 +143,33 @@ namespace firebase
         Timer err_timer;
         auth_data_t *auth_data = nullptr;
         bool processing = false;
+        // The RSA signing that is continued in every loop.
+        RSASigner signer;
+        // The decoded RSA private key components in one buffer that is kept between the token refreshes.
+        br_rsa_private_key rsa_key;
+        uint8_t *rsa_key_buf = nullptr;
+        uint32_t rsa_key_id = 0;
 
         bool exit(bool ret)
         {
             processing = false;
-            if (jwt_data.signature)
-                mem.release(&jwt_data.signature);
-            if (jwt_data.hash && !ret)
-                mem.release(&jwt_data.hash);
+            signer.clear();
+            if (!ret)
+                memset(jwt_data.hash, 0, sizeof(jwt_data.hash));
             return ret;
         }
 
+        // Append the base64url characters of data to the token in small chunks (and update the hash).
+        void appendEncoded(const uint8_t *data, size_t len, JWTHash *hash);
+
         bool begin(auth_data_t *auth_data);
         bool create();
+        bool loadKey(const String &pem);
+#if defined(ENABLE_SERVICE_AUTH)
+        bool loadKey(const service_account_key_t *key);
+#endif
+        // Allocate the key components buffer and set the component pointers of rsa_key.
+        bool allocKey(uint32_t n_bitlen, size_t plen, size_t qlen, size_t dplen, size_t dqlen, size_t iqlen);
         void sendErrCB(AsyncResultCallback cb, AsyncResult *aResult = nullptr);
 
     public:
@@ -105,6 +179,13 @@ namespace firebase
         bool ready();
         void clear();
         bool loop(auth_data_t *auth_data);
+
+        /** Wipe and free the cached decoded private key.
+         *
+         * The private key is decoded once and kept between the token refreshes,
+         * it will be decoded again at the next token signing.
+         */
+        void clearKey();
     };
 
 }
@@ -0,0 +1,119 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_JSON_ESCAPE_H
+#define CORE_JSON_ESCAPE_H
+
+#include <Arduino.h>
+
+// The escape of JSON string content, the quote, backslash and control characters (below 0x20) are escaped.
+class JsonEscape
+{
+public:
+    // Write the escape sequence of character to out (7 bytes at least), returns its length or 0 when it is not escaped.
+    static uint8_t sequence(uint8_t c, char *out)
+    {
+        static const char hex[] PROGMEM = "0123456789abcdef";
+        if (c >= 0x20 && c != '"' && c != '\\')
+            return 0;
+        out[0] = '\\';
+        char s = 0;
+        switch (c)
+        {
+        case '"':
+        case '\\':
+            s = (char)c;
+            break;
+        case '\n':
+            s = 'n';
+            break;
+        case '\r':
+            s = 'r';
+            break;
+        case '\t':
+            s = 't';
+            break;
+        case '\b':
+            s = 'b';
+            break;
+        case '\f':
+            s = 'f';
+            break;
+        default:
+            break;
+        }
+        if (s)
+        {
+            out[1] = s;
+            out[2] = 0;
+            return 2;
+        }
+        memcpy(out + 1, "u00", 3);
+        out[4] = (char)pgm_read_byte(hex + (c >> 4));
+        out[5] = (char)pgm_read_byte(hex + (c & 0x0f));
+        out[6] = 0;
+        return 6;
+    }
+
+    // The length of escaped data.
+    static size_t length(const char *s, size_t len)
+    {
+        char tmp[7];
+        size_t n = 0;
+        for (size_t i = 0; i < len; i++)
+        {
+            uint8_t k = sequence((uint8_t)s[i], tmp);
+            n += k ? k : 1;
+        }
+        return n;
+    }
+
+    static void append(String &out, const char *s, size_t len)
+    {
+        char tmp[7];
+        for (size_t i = 0; i < len; i++)
+        {
+            if (sequence((uint8_t)s[i], tmp))
+                out += tmp;
+            else
+                out += s[i];
+        }
+    }
+
+    static void append(String &out, const String &s) { append(out, s.c_str(), s.length()); }
+
+    static size_t print(Print &out, const char *s, size_t len)
+    {
+        char tmp[7];
+        size_t n = 0;
+        for (size_t i = 0; i < len; i++)
+        {
+            uint8_t k = sequence((uint8_t)s[i], tmp);
+            n += k ? out.write((const uint8_t *)tmp, k) : out.write((uint8_t)s[i]);
+        }
+        return n;
+    }
+};
+
+#endif
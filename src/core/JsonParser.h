@@ -0,0 +1,464 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_JSON_PARSER_H
+#define CORE_JSON_PARSER_H
+
+#include <Arduino.h>
+#include <vector>
+#include "./core/Scan.h"
+
+enum json_token_type
+{
+    json_token_undefined,
+    json_token_object_begin,
+    json_token_object_end,
+    json_token_array_begin,
+    json_token_array_end,
+    json_token_key,
+    json_token_string,
+    json_token_primitive, // number, true, false and null
+    json_token_end,
+    json_token_error
+};
+
+// The span [start, end) in the source buffer.
+struct json_span_t
+{
+public:
+    int start = -1;
+    int end = -1;
+
+    bool valid() const { return start > -1 && end >= start; }
+    size_t length() const { return valid() ? end - start : 0; }
+
+    // Exclude the quotes of string value.
+    json_span_t unquote(const char *buf) const
+    {
+        json_span_t s = *this;
+        if (s.length() >= 2 && buf[s.start] == '"' && buf[s.end - 1] == '"')
+        {
+            s.start++;
+            s.end--;
+        }
+        return s;
+    }
+};
+
+// The JSON tokenizer that works in place over the source buffer, no memory is allocated.
+class JsonPullParser
+{
+private:
+    const char *buf = nullptr;
+    size_t len = 0, pos = 0;
+    // The bit of each nesting level is set for object.
+    uint32_t stack = 0;
+    uint8_t level = 0;
+    bool expect_key = false;
+    json_token_type tk = json_token_undefined;
+    size_t tk_start = 0, tk_end = 0;
+
+    bool inObject() const { return level > 0 && (stack & (1UL << (level - 1))); }
+
+    json_token_type setToken(json_token_type type, size_t start, size_t end)
+    {
+        tk_start = start;
+        tk_end = end;
+        return tk = type;
+    }
+
+public:
+    JsonPullParser(const char *buf, size_t len) : buf(buf), len(buf ? len : 0) {}
+    JsonPullParser(const String &str) : buf(str.c_str()), len(str.length()) {}
+
+    // Read the next token.
+    json_token_type next()
+    {
+        while (pos < len)
+        {
+            char c = buf[pos];
+            if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+                pos++;
+            else if (c == ',')
+            {
+                expect_key = inObject();
+                pos++;
+            }
+            else if (c == ':')
+            {
+                expect_key = false;
+                pos++;
+            }
+            else if (c == '{' || c == '[')
+            {
+                if (level >= 32)
+                    return setToken(json_token_error, pos, pos);
+                if (c == '{')
+                    stack |= (1UL << level);
+                else
+                    stack &= ~(1UL << level);
+                level++;
+                expect_key = c == '{';
+                pos++;
+                return setToken(c == '{' ? json_token_object_begin : json_token_array_begin, pos - 1, pos);
+            }
+            else if (c == '}' || c == ']')
+            {
+                if (level > 0)
+                    level--;
+                expect_key = false;
+                pos++;
+                return setToken(c == '}' ? json_token_object_end : json_token_array_end, pos - 1, pos);
+            }
+            else if (c == '"')
+            {
+                size_t start = ++pos;
+                while (pos < len)
+                {
+                    pos += Scan::findAny(buf + pos, len - pos, "\"\\");
+                    if (pos >= len || buf[pos] == '"')
+                        break;
+                    // Skip the escaped character.
+                    pos += 2;
+                }
+                if (pos >= len)
+                    return setToken(json_token_error, start, len);
+                pos++;
+                bool key = expect_key && inObject();
+                expect_key = false;
+                return setToken(key ? json_token_key : json_token_string, start, pos - 1);
+            }
+            else
+            {
+                size_t start = pos;
+                while (pos < len && buf[pos] != ',' && buf[pos] != '}' && buf[pos] != ']' && buf[pos] != ' ' && buf[pos] != '\t' && buf[pos] != '\r' && buf[pos] != '\n')
+                    pos++;
+                return setToken(json_token_primitive, start, pos);
+            }
+        }
+        return setToken(json_token_end, len, len);
+    }
+
+    json_token_type type() const { return tk; }
+
+    // The nesting level after the current token.
+    uint8_t depth() const { return level; }
+
+    // The span of current token, the quotes of key and string are not included.
+    json_span_t span() const
+    {
+        json_span_t s;
+        s.start = tk_start;
+        s.end = tk_end;
+        return s;
+    }
+
+    // Compare the current token with the text without copying.
+    bool equals(const char *text, size_t textLen) const { return tk_end - tk_start == textLen && strncmp(buf + tk_start, text, textLen) == 0; }
+
+    // Skip the value that starts at the current token, returns the span of whole value (the quotes of string are included).
+    json_span_t skipValue()
+    {
+        json_span_t s;
+        if (tk == json_token_string)
+        {
+            s.start = tk_start - 1;
+            s.end = tk_end + 1;
+        }
+        else if (tk == json_token_primitive)
+            s = span();
+        else if (tk == json_token_object_begin || tk == json_token_array_begin)
+        {
+            s.start = tk_start;
+            uint8_t target = level - 1;
+            while (level > target)
+            {
+                json_token_type t = next();
+                if (t == json_token_end || t == json_token_error)
+                    return json_span_t();
+            }
+            s.end = tk_end;
+        }
+        return s;
+    }
+
+    /**
+     * Find the value at the path e.g. "error/message" or "items/0/name".
+     *
+     * @param path The key path that separated by "/", the number is used as array index.
+     * @param out The span of value in source buffer, the quotes of string value are included.
+     * @return boolean The value was found.
+     */
+    bool find(const char *path, json_span_t &out)
+    {
+        while (path && *path == '/')
+            path++;
+
+        if (next() == json_token_end)
+            return false;
+
+        while (path && *path)
+        {
+            const char *seg_end = strchr(path, '/');
+            size_t seg_len = seg_end ? (size_t)(seg_end - path) : strlen(path);
+            bool found = false;
+
+            if (tk == json_token_object_begin)
+            {
+                uint8_t member_level = level;
+                while (next() == json_token_key && level == member_level)
+                {
+                    bool match = equals(path, seg_len);
+                    next();
+                    if (match)
+                    {
+                        found = true;
+                        break;
+                    }
+                    if (!skipValue().valid())
+                        return false;
+                }
+            }
+            else if (tk == json_token_array_begin)
+            {
+                int index = atoi(path);
+                uint8_t member_level = level;
+                for (int i = 0; next() != json_token_array_end && level >= member_level; i++)
+                {
+                    if (tk == json_token_end || tk == json_token_error)
+                        return false;
+                    if (i == index)
+                    {
+                        found = true;
+                        break;
+                    }
+                    if (!skipValue().valid())
+                        return false;
+                }
+            }
+
+            if (!found)
+                return false;
+
+            path = seg_end ? seg_end + 1 : nullptr;
+        }
+
+        out = skipValue();
+        return out.valid();
+    }
+
+    // Find the value at the path in JSON and copy to dest (the quotes of string value are not included).
+    static bool get(const String &json, const char *path, String &dest)
+    {
+        JsonPullParser parser(json);
+        json_span_t s;
+        if (!parser.find(path, s))
+            return false;
+        s = s.unquote(json.c_str());
+        dest.remove(0, dest.length());
+        dest.reserve(s.length());
+        for (int i = s.start; i < s.end; i++)
+            dest += json[i];
+        return true;
+    }
+
+    // Find the span of value at the path in JSON, the quotes of string value are included.
+    static bool get(const String &json, const char *path, json_span_t &out)
+    {
+        JsonPullParser parser(json);
+        return parser.find(path, out);
+    }
+};
+
+// The offset index of all values in JSON, it is built once and the lookup does not rescan the source buffer.
+class JsonPathIndex
+{
+private:
+    struct json_node_t
+    {
+        json_span_t value;
+        // The key span for object member or the index for array element.
+        uint32_t key_start = 0;
+        uint16_t key_len = 0;
+        int32_t index = -1;
+        int32_t first_child = -1, next_sibling = -1;
+    };
+
+    std::vector<json_node_t> nodes;
+    const char *src = nullptr;
+    size_t src_len = 0;
+    bool built = false;
+
+    bool keyIs(const json_node_t &node, const char *key, size_t len) const { return node.index == -1 && node.key_len == len && strncmp(src + node.key_start, key, len) == 0; }
+
+    bool build()
+    {
+        nodes.clear();
+        built = true;
+
+        JsonPullParser parser(src, src_len);
+        std::vector<int32_t> parents, last_childs;
+        json_span_t key;
+        bool has_key = false;
+
+        for (json_token_type t = parser.next(); t != json_token_end; t = parser.next())
+        {
+            if (t == json_token_error)
+            {
+                nodes.clear();
+                return false;
+            }
+
+            if (t == json_token_key)
+            {
+                key = parser.span();
+                has_key = true;
+                continue;
+            }
+
+            if (t == json_token_object_end || t == json_token_array_end)
+            {
+                if (parents.size() == 0)
+                    break;
+                nodes[parents.back()].value.end = parser.span().end;
+                parents.pop_back();
+                last_childs.pop_back();
+                if (parents.size() == 0)
+                    break;
+                continue;
+            }
+
+            json_node_t node;
+            node.value = parser.span();
+            if (t == json_token_string)
+            {
+                node.value.start--;
+                node.value.end++;
+            }
+
+            int32_t idx = nodes.size();
+            if (parents.size())
+            {
+                json_node_t &parent = nodes[parents.back()];
+                int32_t &last = last_childs.back();
+                if (has_key)
+                {
+                    node.key_start = key.start;
+                    node.key_len = key.length();
+                }
+                else
+                    node.index = last == -1 ? 0 : nodes[last].index + 1;
+
+                if (last == -1)
+                    parent.first_child = idx;
+                else
+                    nodes[last].next_sibling = idx;
+                last = idx;
+            }
+            has_key = false;
+            nodes.push_back(node);
+
+            if (t == json_token_object_begin || t == json_token_array_begin)
+            {
+                parents.push_back(idx);
+                last_childs.push_back(-1);
+            }
+            else if (parents.size() == 0)
+                break;
+        }
+
+        if (parents.size())
+            nodes.clear();
+
+        return nodes.size() > 0;
+    }
+
+public:
+    JsonPathIndex() {}
+
+    // Release the index, it will be rebuilt at the next lookup.
+    void clear()
+    {
+        nodes.clear();
+        src = nullptr;
+        src_len = 0;
+        built = false;
+    }
+
+    // The numbers of indexed values.
+    size_t size() const { return nodes.size(); }
+
+    /**
+     * Find the value at the path e.g. "/a/b/c" or "items/0/name".
+     * The index is built at the first lookup or when the source buffer was changed.
+     *
+     * @param buf The JSON buffer.
+     * @param len The length of JSON buffer.
+     * @param path The key path that separated by "/", the number is used as array index.
+     * @param out The span of value in source buffer, the quotes of string value are included.
+     * @return boolean The value was found.
+     */
+    bool find(const char *buf, size_t len, const char *path, json_span_t &out)
+    {
+        if (!built || buf != src || len != src_len)
+        {
+            src = buf;
+            src_len = len;
+            build();
+        }
+
+        if (nodes.size() == 0)
+            return false;
+
+        int32_t cur = 0;
+        while (path && *path)
+        {
+            if (*path == '/')
+            {
+                path++;
+                continue;
+            }
+
+            const char *seg_end = strchr(path, '/');
+            size_t seg_len = seg_end ? (size_t)(seg_end - path) : strlen(path);
+            bool array = src[nodes[cur].value.start] == '[';
+            int32_t index = array ? atoi(path) : -1;
+
+            int32_t child = nodes[cur].first_child;
+            while (child > -1 && !(array ? nodes[child].index == index : keyIs(nodes[child], path, seg_len)))
+                child = nodes[child].next_sibling;
+
+            if (child == -1)
+                return false;
+
+            cur = child;
+            path = seg_end;
+        }
+
+        out = nodes[cur].value;
+        return out.valid();
+    }
+};
+
+#endif
@@ -0,0 +1,156 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_LINK_ESTIMATOR_H
+#define CORE_LINK_ESTIMATOR_H
+
+#include <Arduino.h>
+#include "./Config.h"
+#include "./core/Error.h"
+
+// The minimum and maximum read timeout in seconds that is adapted to the round-trip time.
+#if !defined(FIREBASE_LINK_READ_TIMEOUT_MIN_SEC)
+#define FIREBASE_LINK_READ_TIMEOUT_MIN_SEC 10
+#endif
+
+#if !defined(FIREBASE_LINK_READ_TIMEOUT_MAX_SEC)
+#define FIREBASE_LINK_READ_TIMEOUT_MAX_SEC 60
+#endif
+
+// The multiple of retransmission timeout that is used as the read timeout, the round-trip time only covers
+// the first byte of response and the server processing time of the slow request is not sampled.
+#if !defined(FIREBASE_LINK_READ_TIMEOUT_FACTOR)
+#define FIREBASE_LINK_READ_TIMEOUT_FACTOR 8
+#endif
+
+// The minimum bytes of request and response that the goodput is sampled.
+#if !defined(FIREBASE_LINK_GOODPUT_MIN_BYTES)
+#define FIREBASE_LINK_GOODPUT_MIN_BYTES 2048
+#endif
+
+// The estimate of network link from the completed requests.
+struct link_estimate_t
+{
+public:
+    // The smoothed round-trip time (from request sent to the first byte of response) and its variation in ms.
+    uint32_t rtt_ms = 0, rtt_var_ms = 0;
+    // The smoothed bytes per second of the requests and responses.
+    uint32_t goodput = 0;
+    // The smoothed percentage of requests that failed because of the connection.
+    uint8_t loss = 0;
+    // The numbers of completed requests.
+    uint32_t samples = 0;
+};
+
+/**
+ * The round-trip time, goodput and loss of network link.
+ *
+ * The round-trip time and its variation are smoothed as the TCP retransmission timer (RFC 6298), the goodput and loss
+ * are the moving averages of the last requests. The estimate scales the chunk size to the bytes in flight of the link,
+ * the read timeout to the round-trip time and the numbers of concurrent requests to the loss.
+ */
+class LinkEstimator
+{
+public:
+    LinkEstimator() {}
+
+    // Add the sample of completed request, the transfer time is from request sent to the end of response.
+    void add(uint32_t rtt_us, size_t bytes, uint32_t transfer_us, int code)
+    {
+        bool failed = code <= FIREBASE_ERROR_TCP_CONNECTION && code >= FIREBASE_ERROR_TCP_DISCONNECTED;
+        // The loss is kept in 1/256 percent.
+        loss_fp = loss_fp - loss_fp / 8 + (failed ? (100 << 8) / 8 : 0);
+        est.loss = loss_fp >> 8;
+        est.samples++;
+
+        if (failed || rtt_us == 0)
+            return;
+
+        uint32_t rtt = rtt_us / 1000;
+        if (est.rtt_ms == 0)
+        {
+            est.rtt_ms = rtt;
+            est.rtt_var_ms = rtt / 2;
+        }
+        else
+        {
+            uint32_t diff = rtt > est.rtt_ms ? rtt - est.rtt_ms : est.rtt_ms - rtt;
+            est.rtt_var_ms = est.rtt_var_ms - est.rtt_var_ms / 4 + diff / 4;
+            est.rtt_ms = est.rtt_ms - est.rtt_ms / 8 + rtt / 8;
+        }
+
+        if (bytes >= FIREBASE_LINK_GOODPUT_MIN_BYTES && transfer_us > 0)
+        {
+            uint32_t bps = (uint64_t)bytes * 1000000 / transfer_us;
+            est.goodput = est.goodput == 0 ? bps : est.goodput - est.goodput / 4 + bps / 4;
+        }
+    }
+
+    const link_estimate_t &estimate() const { return est; }
+
+    void clear()
+    {
+        est = link_estimate_t();
+        loss_fp = 0;
+    }
+
+    // Returns the chunk size that is limited to the half of bytes in flight (goodput x round-trip time), and halved on the lossy link.
+    uint16_t chunkSize(uint16_t size, uint16_t min) const
+    {
+        if (est.samples == 0)
+            return size;
+        uint32_t s = size;
+        uint32_t bdp = est.goodput && est.rtt_ms ? (uint64_t)est.goodput * est.rtt_ms / 2000 : 0;
+        if (bdp && bdp < s)
+            s = bdp;
+        if (est.loss >= 10)
+            s /= 2;
+        s = s / 256 * 256;
+        return s < min ? min : s;
+    }
+
+    // Returns the read timeout in seconds from FIREBASE_LINK_READ_TIMEOUT_FACTOR x the retransmission timeout
+    // (round-trip time + 4 x variation), 0 when it is not known.
+    uint32_t readTimeout() const
+    {
+        if (est.rtt_ms == 0)
+            return 0;
+        uint32_t sec = (est.rtt_ms + 4 * est.rtt_var_ms) * FIREBASE_LINK_READ_TIMEOUT_FACTOR / 1000;
+        return sec < FIREBASE_LINK_READ_TIMEOUT_MIN_SEC ? FIREBASE_LINK_READ_TIMEOUT_MIN_SEC : (sec > FIREBASE_LINK_READ_TIMEOUT_MAX_SEC ? FIREBASE_LINK_READ_TIMEOUT_MAX_SEC : sec);
+    }
+
+    // Returns the numbers of concurrent requests up to max, it is reduced when the requests were failed from the connection.
+    uint8_t window(uint8_t max) const
+    {
+        if (max <= 1 || est.loss < 5)
+            return max;
+        return est.loss >= 20 ? 1 : (max + 1) / 2;
+    }
+
+private:
+    link_estimate_t est;
+    uint16_t loss_fp = 0;
+};
+
+#endif
@@ -26,6 +26,7 @@
 #define CORE_LIST_H
 #include <Arduino.h>
 #include <vector>
+#include "./core/Lock.h"
 
 namespace firebase
 {
@@ -36,8 +37,18 @@ namespace firebase
         List() {}
         ~List() {}
 
-        void addRemoveList(std::vector<uint32_t> &vec, uint32_t addr, bool add)
+        // The lock of all address lists, it is held only while the list is read or changed.
+        static AsyncLock &listLock()
         {
+            static AsyncLock lock;
+            return lock;
+        }
+
+        // The list of objects (pointers) or handles, the item is added once.
+        template <typename T>
+        void addRemoveList(std::vector<T> &vec, T addr, bool add)
+        {
+            AsyncLockGuard guard(listLock());
             for (size_t i = 0; i < vec.size(); i++)
             {
                 if (vec[i] == addr)
@@ -52,8 +63,18 @@ namespace firebase
                 vec.push_back(addr);
         }
 
-        bool existed(std::vector<uint32_t> &vec, uint32_t addr)
+        // Returns the item at index or the empty item (nullptr or 0) when the index is out of range.
+        template <typename T>
+        T at(std::vector<T> &vec, size_t index)
         {
+            AsyncLockGuard guard(listLock());
+            return index < vec.size() ? vec[index] : T();
+        }
+
+        template <typename T>
+        bool existed(std::vector<T> &vec, T addr)
+        {
+            AsyncLockGuard guard(listLock());
             for (size_t i = 0; i < vec.size(); i++)
             {
                 if (vec[i] == addr)
@@ -62,6 +83,92 @@ namespace firebase
             return false;
         }
     };
+
+    // The handle of registered object, the low 16 bits are the entry index + 1 and the high 16 bits are its generation, 0 is invalid.
+    typedef uint32_t list_handle_t;
+
+    /**
+     * The registry of live objects (FirebaseApp, AsyncClientClass and AsyncResult).
+     *
+     * The object is added when it is constructed (or used) and removed when it is destroyed, then the handle
+     * that is kept by other object is resolved in O(1) and the removed object is not accessed.
+     * The entry of removed object is reused with the new generation, the object address is not stored in integer.
+     */
+    class Registry
+    {
+    public:
+        static Registry &shared()
+        {
+            static Registry registry;
+            return registry;
+        }
+
+        list_handle_t add(void *obj)
+        {
+            AsyncLockGuard guard(List::listLock());
+            uint16_t index = 0;
+            if (free_head > 0)
+            {
+                index = free_head - 1;
+                free_head = entries[index].next_free;
+            }
+            else
+            {
+                if (entries.size() >= 0xffff)
+                    return 0;
+                entries.push_back(entry_t());
+                index = entries.size() - 1;
+            }
+            entries[index].obj = obj;
+            entries[index].next_free = 0;
+            return ((uint32_t)entries[index].gen << 16) | (index + 1);
+        }
+
+        void remove(list_handle_t handle)
+        {
+            AsyncLockGuard guard(List::listLock());
+            entry_t *e = find(handle);
+            if (!e)
+                return;
+            e->obj = nullptr;
+            // The generation 0 is not used.
+            e->gen = e->gen == 0xffff ? 1 : e->gen + 1;
+            e->next_free = free_head;
+            free_head = (handle & 0xffff);
+        }
+
+        // Returns the object of handle or nullptr when it was removed.
+        void *get(list_handle_t handle)
+        {
+            AsyncLockGuard guard(List::listLock());
+            entry_t *e = find(handle);
+            return e ? e->obj : nullptr;
+        }
+
+        template <typename T>
+        T *get(list_handle_t handle) { return static_cast<T *>(get(handle)); }
+
+    private:
+        struct entry_t
+        {
+            void *obj = nullptr;
+            uint16_t gen = 1;
+            // The index + 1 of the next free entry.
+            uint16_t next_free = 0;
+        };
+
+        std::vector<entry_t> entries;
+        uint16_t free_head = 0;
+
+        entry_t *find(list_handle_t handle)
+        {
+            uint16_t index = handle & 0xffff;
+            if (index == 0 || index > entries.size())
+                return nullptr;
+            entry_t &e = entries[index - 1];
+            return e.obj && e.gen == (handle >> 16) ? &e : nullptr;
+        }
+    };
 };
 
 #endif
@@ -0,0 +1,308 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_LIST_ITERATOR_H
+#define CORE_LIST_ITERATOR_H
+
+#include <Arduino.h>
+#include <vector>
+#include "./Config.h"
+#include "./core/List.h"
+#include "./core/JsonParser.h"
+#include "./core/AsyncResult/AsyncResult.h"
+
+using namespace firebase;
+
+// The number of entries in each page of list iterator, the entries of up to two pages are kept in memory.
+#if !defined(FIREBASE_LIST_PAGE_SIZE)
+#define FIREBASE_LIST_PAGE_SIZE 50
+#endif
+
+// The number of attempts of each page request that was failed.
+#if !defined(FIREBASE_LIST_PAGE_ATTEMPTS)
+#define FIREBASE_LIST_PAGE_ATTEMPTS 3
+#endif
+
+// The object entry of list iterator.
+struct list_item_t
+{
+public:
+    // The object name.
+    String name;
+    // The object resource JSON.
+    String json;
+};
+
+// The object entries that are streamed from the pages of list response.
+class ListIterator
+{
+    friend class ListPage;
+    friend class Storage;
+    friend class CloudStorage;
+
+public:
+    FirebaseError lastError;
+
+    ListIterator() {}
+
+    ~ListIterator() { detach(); }
+
+    // Take the next entry, returns false when no entry is available yet.
+    bool next(list_item_t &item)
+    {
+        if (entries.size() == 0)
+            return false;
+        item.json = entries[0];
+        entries.erase(entries.begin());
+        item.name.remove(0, item.name.length());
+        JsonPullParser::get(item.json, "name", item.name);
+        return true;
+    }
+
+    // The number of entries that are available.
+    size_t available() const { return entries.size(); }
+
+    // All pages were listed and all entries were taken.
+    bool isDone() const { return done && entries.size() == 0; }
+
+    bool isError() const { return lastError.code() != 0; }
+
+private:
+    std::vector<String> entries;
+    bool done = false;
+    // The list iterator vector (list) of the service.
+    std::vector<ListIterator *> *ivec = nullptr;
+
+    void attach(std::vector<ListIterator *> &vec)
+    {
+        detach();
+        entries.clear();
+        done = false;
+        lastError.setLastError(0, "");
+        ivec = &vec;
+        List list;
+        list.addRemoveList(vec, this, true);
+    }
+
+    void detach()
+    {
+        if (ivec)
+        {
+            List list;
+            list.addRemoveList(*ivec, this, false);
+        }
+        ivec = nullptr;
+    }
+};
+
+// The payload sink of list request, the entries of "items" array are written to the iterator while the page is received.
+// The next page is requested when the page was finished and the entries of no more than one page are left in the iterator.
+class ListPage : public Print
+{
+public:
+    AsyncResult result;
+    // The page token of the current request.
+    String uid, token;
+    bool busy = false;
+
+    ListPage(ListIterator *it, std::vector<ListIterator *> *ivec, const String &uid) : uid(uid), it(it), ivec(ivec) {}
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+
+    size_t write(const uint8_t *buf, size_t size) override
+    {
+        for (size_t i = 0; i < size; i++)
+            parse(buf[i]);
+        return size;
+    }
+
+    // Process the page result, returns false when all pages were listed or the iterator was gone.
+    bool process()
+    {
+        if (!finished && !iterator())
+            finished = true;
+
+        if (!busy || (!result.data_available && !result.error_available))
+            return !finished;
+
+        busy = false;
+        if (finished)
+            return false;
+
+        if (result.error_available)
+        {
+            int code = result.lastError.code();
+            bool retry = code < 0 || code == FIREBASE_ERROR_HTTP_CODE_TOO_MANY_REQUESTS || code >= FIREBASE_ERROR_HTTP_CODE_INTERNAL_SERVER_ERROR;
+            if (retry && ++attempts < FIREBASE_LIST_PAGE_ATTEMPTS)
+            {
+                // The entries that were written are skipped when the page is requested again.
+                return true;
+            }
+            return finish(code, result.lastError.message());
+        }
+
+        attempts = 0;
+        token = next_token;
+        if (token.length() == 0)
+            return finish(0, "");
+        return true;
+    }
+
+    // The page is not written to the iterator anymore.
+    void release(ListIterator *it)
+    {
+        if (this->it == it)
+            this->it = nullptr;
+    }
+
+    // Returns true when the page should be requested.
+    bool nextRequest()
+    {
+        if (finished || busy || !iterator() || it->entries.size() > FIREBASE_LIST_PAGE_SIZE)
+            return false;
+
+        busy = true;
+        result.clear();
+        result.error_available = false;
+        if (attempts == 0)
+            received = 0;
+        emitted = 0;
+        depth = 0;
+        in_str = esc = is_value = in_items = capture = false;
+        key.remove(0, key.length());
+        next_token.remove(0, next_token.length());
+        return true;
+    }
+
+private:
+    ListIterator *it = nullptr;
+    std::vector<ListIterator *> *ivec = nullptr;
+    String key, str, item, next_token;
+    // The number of entries of current response and of the page that were written to the iterator.
+    size_t emitted = 0, received = 0;
+    uint8_t depth = 0, attempts = 0;
+    bool in_str = false, esc = false, is_value = false, in_items = false, capture = false, finished = false;
+
+    ListIterator *iterator()
+    {
+        List list;
+        if (it && ivec && !list.existed(*ivec, it))
+            it = nullptr;
+        return it;
+    }
+
+    // The JSON is scanned by character, only the keys and values of top level object and the entries are kept.
+    void parse(char c)
+    {
+        bool end_item = false;
+        if (in_str)
+        {
+            if (esc)
+                esc = false;
+            else if (c == '\\')
+                esc = true;
+            else if (c == '"')
+            {
+                in_str = false;
+                if (depth == 1)
+                {
+                    if (!is_value)
+                        key = str;
+                    else if (key == "nextPageToken")
+                        next_token = str;
+                }
+            }
+
+            if (in_str && depth == 1)
+                str += c;
+        }
+        else
+        {
+            switch (c)
+            {
+            case '"':
+                in_str = true;
+                str.remove(0, str.length());
+                break;
+            case ':':
+                if (depth == 1)
+                    is_value = true;
+                break;
+            case ',':
+                if (depth == 1)
+                    is_value = false;
+                break;
+            case '{':
+            case '[':
+                depth++;
+                if (depth == 2 && c == '[' && key == "items")
+                    in_items = true;
+                else if (depth == 3 && c == '{' && in_items)
+                {
+                    capture = true;
+                    item.remove(0, item.length());
+                }
+                break;
+            case '}':
+            case ']':
+                if (depth == 3 && capture)
+                    end_item = true;
+                else if (depth == 2)
+                    in_items = false;
+                if (depth > 0)
+                    depth--;
+                break;
+            default:
+                break;
+            }
+        }
+
+        if (capture)
+            item += c;
+
+        if (end_item)
+        {
+            capture = false;
+            if (emitted++ >= received && iterator())
+            {
+                it->entries.push_back(item);
+                received++;
+            }
+            item.remove(0, item.length());
+        }
+    }
+
+    bool finish(int code, const String &message)
+    {
+        finished = true;
+        if (iterator())
+        {
+            it->lastError.setLastError(code, message);
+            it->done = true;
+        }
+        return false;
+    }
+};
+
+#endif
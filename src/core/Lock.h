@@ -0,0 +1,80 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_LOCK_H
+#define CORE_LOCK_H
+
+#include <Arduino.h>
+
+#if defined(ESP32) && !defined(FIREBASE_DISABLE_TASK_LOCK)
+#define FIREBASE_TASK_LOCK
+#endif
+
+// The recursive mutex that guards the data shared by tasks (ESP32), it does nothing on the other devices.
+class AsyncLock
+{
+public:
+#if defined(FIREBASE_TASK_LOCK)
+    AsyncLock() { mutex = xSemaphoreCreateRecursiveMutex(); }
+    ~AsyncLock()
+    {
+        if (mutex)
+            vSemaphoreDelete(mutex);
+    }
+    void lock()
+    {
+        if (mutex)
+            xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    }
+    void unlock()
+    {
+        if (mutex)
+            xSemaphoreGiveRecursive(mutex);
+    }
+#else
+    AsyncLock() {}
+    void lock() {}
+    void unlock() {}
+#endif
+    AsyncLock(const AsyncLock &) = delete;
+    AsyncLock &operator=(const AsyncLock &) = delete;
+
+private:
+#if defined(FIREBASE_TASK_LOCK)
+    SemaphoreHandle_t mutex = NULL;
+#endif
+};
+
+// Hold the lock in the scope.
+class AsyncLockGuard
+{
+public:
+    explicit AsyncLockGuard(AsyncLock &lock) : lk(lock) { lk.lock(); }
+    ~AsyncLockGuard() { lk.unlock(); }
+
+private:
+    AsyncLock &lk;
+};
+
+#endif
@@ -36,51 +36,240 @@
 #endif
 #endif
 
+#if defined(ESP32)
+#include <esp_heap_caps.h>
+#endif
+
+// The minimum allocation size that is placed in PSRAM when placement is mem_placement_auto.
+#if !defined(FIREBASE_PSRAM_MIN_ALLOC_SIZE)
+#define FIREBASE_PSRAM_MIN_ALLOC_SIZE 1024
+#endif
+
+// The size of memory block of arena (bump) allocator that used by slot for the chunk buffers.
+#if !defined(FIREBASE_MEMORY_ARENA_SIZE)
+#define FIREBASE_MEMORY_ARENA_SIZE 4096
+#endif
+
+// The default size of transfer chunk in bytes, each payload write, response read and upload slice is not larger than
+// the chunk size of async client (see AsyncClientClass::setChunkSize).
+#if !defined(FIREBASE_CHUNK_SIZE)
+#define FIREBASE_CHUNK_SIZE 2048
+#endif
+
+// The default size of source data in bytes of each base64 encoded upload chunk, a multiple of 3.
+#if !defined(FIREBASE_BASE64_CHUNK_SIZE)
+#define FIREBASE_BASE64_CHUNK_SIZE 1026
+#endif
+
+// The range of chunk size that can be set at run time.
+#if !defined(FIREBASE_CHUNK_SIZE_MIN)
+#define FIREBASE_CHUNK_SIZE_MIN 256
+#endif
+
+#if !defined(FIREBASE_CHUNK_SIZE_MAX)
+#define FIREBASE_CHUNK_SIZE_MAX 16384
+#endif
+
+// The allocation class that used for selecting the memory placement.
+enum memory_alloc_class
+{
+    mem_class_default,
+    // The hot buffers that used while reading the response e.g. chunk and payload buffers.
+    mem_class_chunk,
+    // The cold staging buffers for file, blob and OTA data.
+    mem_class_file,
+    // The decoded private key that is kept between the token refreshes.
+    mem_class_key,
+    mem_class_max
+};
+
+enum memory_placement
+{
+    // PSRAM for allocation size that is not less than FIREBASE_PSRAM_MIN_ALLOC_SIZE.
+    mem_placement_auto,
+    mem_placement_internal,
+    mem_placement_psram
+};
+
+// The memory usage statistics.
+struct memory_stats_t
+{
+public:
+    // The numbers of allocation.
+    uint32_t alloc_count = 0;
+    // The total bytes that were allocated.
+    uint32_t alloc_bytes = 0;
+    // The live bytes at the last sampling.
+    uint32_t live_bytes = 0;
+    // The highest live bytes.
+    uint32_t peak_bytes = 0;
+
+    void addAlloc(size_t len)
+    {
+        alloc_count++;
+        alloc_bytes += len;
+    }
+
+    void setLive(size_t len)
+    {
+        live_bytes = len;
+        if (live_bytes > peak_bytes)
+            peak_bytes = live_bytes;
+    }
+
+    void reset()
+    {
+        alloc_count = 0;
+        alloc_bytes = 0;
+        live_bytes = 0;
+        peak_bytes = 0;
+    }
+};
+
+// The arena (bump) allocator, its memory block is allocated once and all allocations are reset at once.
+class MemoryArena
+{
+    friend class Memory;
+
+private:
+#if defined(FIREBASE_STATIC_BUFFERS) && FIREBASE_MEMORY_ARENA_SIZE > 0
+    uint8_t data[FIREBASE_MEMORY_ARENA_SIZE];
+    uint8_t *block = data;
+#else
+    uint8_t *block = nullptr;
+#endif
+    size_t pos = 0, last = 0;
+
+    void *take(size_t len)
+    {
+        if (!block || pos + len > FIREBASE_MEMORY_ARENA_SIZE)
+            return NULL;
+        last = pos;
+        pos += len;
+        return block + last;
+    }
+
+    bool owns(void *p) const { return block && (uint8_t *)p >= block && (uint8_t *)p < block + FIREBASE_MEMORY_ARENA_SIZE; }
+
+    void put(void *p)
+    {
+        // Only the last allocation can be returned before reset.
+        if ((uint8_t *)p == block + last)
+            pos = last;
+    }
+
+public:
+    MemoryArena() {}
+    ~MemoryArena()
+    {
+#if !defined(FIREBASE_STATIC_BUFFERS)
+        if (block)
+            free(block);
+        block = nullptr;
+#endif
+    }
+
+    // The size of memory block that was allocated.
+    size_t size() const { return block ? FIREBASE_MEMORY_ARENA_SIZE : 0; }
+
+    // Reset all allocations, the memory block is kept for reuse.
+    void reset()
+    {
+        pos = 0;
+        last = 0;
+    }
+};
+
 class Memory
 {
 private:
+    MemoryArena *arena = nullptr;
+    memory_stats_t *stats = nullptr;
+
 public:
     Memory() {}
+    // The memory will be allocated from arena (if available) instead of heap.
+    // The allocations will be counted to stats (if available) and global stats.
+    Memory(MemoryArena *arena, memory_stats_t *stats = nullptr) : arena(arena), stats(stats) {}
     ~Memory() {}
 
+    /**
+     * Set the memory placement of allocation class.
+     * This takes effect only when PSRAM is available (BOARD_HAS_PSRAM).
+     *
+     * @param cls The memory_alloc_class enum.
+     * @param placement The memory_placement enum.
+     */
+    static void setPlacement(memory_alloc_class cls, memory_placement placement)
+    {
+        if (cls < mem_class_max)
+            placements()[cls] = placement;
+    }
+
+    static memory_placement getPlacement(memory_alloc_class cls) { return cls < mem_class_max ? placements()[cls] : mem_placement_auto; }
+
+    // The size of the largest free block that can be allocated, 0 if unknown.
+    static size_t maxAllocSize()
+    {
+#if defined(ESP32)
+        return heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+#elif defined(ESP8266)
+        return ESP.getMaxFreeBlockSize();
+#else
+        return 0;
+#endif
+    }
+
+    // The memory usage statistics of all allocations, its peak_bytes is the high-watermark of all requests.
+    static memory_stats_t &globalStats()
+    {
+        static memory_stats_t global_stats;
+        return global_stats;
+    }
+
     // Free reserved memory at pointer.
     void release(void *ptr)
     {
         void **p = (void **)ptr;
         if (*p)
         {
-            free(*p);
+            if (arena && arena->owns(*p))
+                arena->put(*p);
+            else
+                free(*p);
             *p = 0;
         }
     }
 
-    void *alloc(size_t len, bool clear = true)
+    void *alloc(size_t len, bool clear = true, memory_alloc_class cls = mem_class_default)
     {
         void *p;
         size_t newLen = getReservedLen(len);
-#if defined(BOARD_HAS_PSRAM)
-        if (ESP.getPsramSize() > 0)
-            p = (void *)ps_malloc(newLen);
-        else
-            p = (void *)malloc(newLen);
 
-        if (!p)
-            return NULL;
-#else
+        if (arena && FIREBASE_MEMORY_ARENA_SIZE > 0)
+        {
+            if (!arena->block)
+            {
+                arena->block = reinterpret_cast<uint8_t *>(heapAlloc(FIREBASE_MEMORY_ARENA_SIZE, mem_class_chunk));
+                if (arena->block)
+                    count(FIREBASE_MEMORY_ARENA_SIZE);
+            }
 
-#if defined(ESP8266_USE_EXTERNAL_HEAP)
-        ESP.setExternalHeap();
-#endif
-        p = (void *)malloc(newLen);
-        bool nn = p ? true : false;
-#if defined(ESP8266_USE_EXTERNAL_HEAP)
-        ESP.resetHeap();
-#endif
+            p = arena->take(newLen);
+            if (p)
+            {
+                if (clear)
+                    memset(p, 0, newLen);
+                return p;
+            }
+        }
 
-        if (!nn)
+        p = heapAlloc(newLen, cls);
+        if (!p)
             return NULL;
 
-#endif
+        count(newLen);
+
         if (clear)
             memset(p, 0, newLen);
         return p;
@@ -94,6 +283,52 @@ public:
             newlen += 4;
         return (size_t)newlen;
     }
+
+private:
+    void count(size_t len)
+    {
+        if (stats)
+            stats->addAlloc(len);
+        globalStats().addAlloc(len);
+    }
+
+    static memory_placement *placements()
+    {
+        static memory_placement placement[mem_class_max] = {mem_placement_auto, mem_placement_internal, mem_placement_psram, mem_placement_internal};
+        return placement;
+    }
+
+    void *heapAlloc(size_t newLen, memory_alloc_class cls)
+    {
+        void *p = NULL;
+#if defined(BOARD_HAS_PSRAM)
+        memory_placement placement = getPlacement(cls);
+        bool psram = placement == mem_placement_psram || (placement == mem_placement_auto && newLen >= FIREBASE_PSRAM_MIN_ALLOC_SIZE);
+#if defined(ESP32)
+        p = heap_caps_malloc(newLen, psram ? (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT) : (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+        // Fallback to any memory.
+        if (!p)
+            p = (void *)malloc(newLen);
+#else
+        if (psram && ESP.getPsramSize() > 0)
+            p = (void *)ps_malloc(newLen);
+        else
+            p = (void *)malloc(newLen);
+#endif
+#else
+        (void)cls;
+
+#if defined(ESP8266_USE_EXTERNAL_HEAP)
+        ESP.setExternalHeap();
+#endif
+        p = (void *)malloc(newLen);
+#if defined(ESP8266_USE_EXTERNAL_HEAP)
+        ESP.resetHeap();
+#endif
+
+#endif
+        return p;
+    }
 };
 
 #endif
\ No newline at end of file
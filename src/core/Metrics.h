@@ -0,0 +1,255 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_METRICS_H
+#define CORE_METRICS_H
+
+#include <Arduino.h>
+#include "./core/Memory.h"
+
+// The numbers of latency histogram buckets, the bucket n counts the latency in [2^(n-1), 2^n) ms.
+#if !defined(FIREBASE_METRICS_BUCKETS)
+#define FIREBASE_METRICS_BUCKETS 16
+#endif
+
+enum metrics_service
+{
+    metrics_service_auth,
+    metrics_service_rtdb,
+    metrics_service_firestore,
+    metrics_service_messaging,
+    metrics_service_storage,
+    metrics_service_cloud_storage,
+    metrics_service_functions,
+    metrics_service_other,
+    metrics_service_max
+};
+
+enum metrics_counter
+{
+    metrics_errors,
+    metrics_bytes_in,
+    metrics_bytes_out,
+    // The new connections and the new connections that were made after the previous connection was closed.
+    metrics_connects,
+    metrics_reconnects,
+    // The connections that were made without and with the cached TLS session that offered for resumption.
+    metrics_tls_full,
+    metrics_tls_resumed,
+    metrics_retries,
+    // The tasks that were rejected by the queue limit.
+    metrics_queue_full,
+    metrics_counter_max
+};
+
+// The histogram of latency in ms with the fixed log2 buckets.
+struct metrics_histogram_t
+{
+public:
+    uint32_t buckets[FIREBASE_METRICS_BUCKETS] = {};
+    uint32_t count = 0, max_ms = 0;
+    uint64_t sum_ms = 0;
+
+    void add(uint32_t ms)
+    {
+        uint8_t i = 0;
+        while (i < FIREBASE_METRICS_BUCKETS - 1 && (ms >> i) > 0)
+            i++;
+        buckets[i]++;
+        count++;
+        sum_ms += ms;
+        if (ms > max_ms)
+            max_ms = ms;
+    }
+
+    // Returns the upper bound in ms of the bucket that includes the percentile (0 - 100).
+    uint32_t percentile(uint8_t p) const
+    {
+        uint32_t n = 0, target = ((uint64_t)count * p + 99) / 100;
+        for (uint8_t i = 0; i < FIREBASE_METRICS_BUCKETS && count; i++)
+        {
+            n += buckets[i];
+            if (n >= target)
+                return i == FIREBASE_METRICS_BUCKETS - 1 ? max_ms : (1UL << i) - 1;
+        }
+        return 0;
+    }
+
+    void reset() { *this = metrics_histogram_t(); }
+
+    void toJSON(String &buf) const
+    {
+        buf += "{\"count\":";
+        buf += count;
+        buf += ",\"avg_ms\":";
+        buf += count ? (uint32_t)(sum_ms / count) : 0;
+        buf += ",\"p50_ms\":";
+        buf += percentile(50);
+        buf += ",\"p95_ms\":";
+        buf += percentile(95);
+        buf += ",\"max_ms\":";
+        buf += max_ms;
+        buf += ",\"buckets\":[";
+        for (uint8_t i = 0; i < FIREBASE_METRICS_BUCKETS; i++)
+        {
+            if (i > 0)
+                buf += ',';
+            buf += buckets[i];
+        }
+        buf += "]}";
+    }
+};
+
+// The process-wide counters and latency histograms of all async clients, the counters are not updated when FIREBASE_DISABLE_METRICS is defined.
+class FirebaseMetrics
+{
+private:
+    uint32_t counters[metrics_counter_max] = {};
+    uint32_t requests[metrics_service_max] = {};
+    metrics_histogram_t latency_hist, ttfb_hist;
+    uint32_t heap_min = 0;
+
+    void sampleHeap()
+    {
+#if defined(ESP32) || defined(ESP8266)
+        uint32_t heap = ESP.getFreeHeap();
+        if (heap_min == 0 || heap < heap_min)
+            heap_min = heap;
+#endif
+    }
+
+public:
+    static FirebaseMetrics &shared()
+    {
+        static FirebaseMetrics metrics;
+        return metrics;
+    }
+
+    void add(metrics_counter c, uint32_t n = 1)
+    {
+#if !defined(FIREBASE_DISABLE_METRICS)
+        counters[c] += n;
+#else
+        (void)c;
+        (void)n;
+#endif
+    }
+
+    // Count the finished request of service and its latency and time to first byte (µs, 0 when not available).
+    void addRequest(metrics_service s, bool error, uint32_t latency_us, uint32_t ttfb_us)
+    {
+#if !defined(FIREBASE_DISABLE_METRICS)
+        requests[s]++;
+        if (error)
+            counters[metrics_errors]++;
+        if (latency_us)
+            latency_hist.add(latency_us / 1000);
+        if (ttfb_us)
+            ttfb_hist.add(ttfb_us / 1000);
+        sampleHeap();
+#else
+        (void)s;
+        (void)error;
+        (void)latency_us;
+        (void)ttfb_us;
+#endif
+    }
+
+    uint32_t counter(metrics_counter c) const { return counters[c]; }
+    uint32_t requestCount(metrics_service s) const { return requests[s]; }
+    const metrics_histogram_t &latency() const { return latency_hist; }
+    const metrics_histogram_t &timeToFirstByte() const { return ttfb_hist; }
+
+    // The lowest free heap that was sampled when the requests were finished (ESP32 and ESP8266), 0 if unknown.
+    uint32_t heapMinFree() const { return heap_min; }
+
+    void reset()
+    {
+        memset(counters, 0, sizeof(counters));
+        memset(requests, 0, sizeof(requests));
+        latency_hist.reset();
+        ttfb_hist.reset();
+        heap_min = 0;
+    }
+
+    // Returns the service of request from its host.
+    static metrics_service serviceOf(const String &host)
+    {
+        if (host.indexOf("firebaseio.com") > -1 || host.indexOf("firebasedatabase.app") > -1)
+            return metrics_service_rtdb;
+        if (host.indexOf("firestore.") > -1)
+            return metrics_service_firestore;
+        if (host.indexOf("fcm.") > -1)
+            return metrics_service_messaging;
+        if (host.indexOf("firebasestorage.") > -1)
+            return metrics_service_storage;
+        if (host.indexOf("storage.googleapis.com") > -1)
+            return metrics_service_cloud_storage;
+        if (host.indexOf("cloudfunctions.") > -1)
+            return metrics_service_functions;
+        if (host.indexOf("identitytoolkit.") > -1 || host.indexOf("securetoken.") > -1 || host.indexOf("oauth2.") > -1)
+            return metrics_service_auth;
+        return metrics_service_other;
+    }
+
+    /**
+     * Get the metrics as JSON object string e.g. to print or to set to the database.
+     */
+    String toJSON() const
+    {
+        static const char *const services[metrics_service_max] = {"auth", "rtdb", "firestore", "messaging", "storage", "cloud_storage", "functions", "other"};
+        static const char *const names[metrics_counter_max] = {"errors", "bytes_in", "bytes_out", "connects", "reconnects", "tls_full", "tls_resumed", "retries", "queue_full"};
+
+        String buf = "{\"requests\":{";
+        for (uint8_t i = 0; i < metrics_service_max; i++)
+        {
+            if (i > 0)
+                buf += ',';
+            buf += '"';
+            buf += services[i];
+            buf += "\":";
+            buf += requests[i];
+        }
+        buf += '}';
+        for (uint8_t i = 0; i < metrics_counter_max; i++)
+        {
+            buf += ",\"";
+            buf += names[i];
+            buf += "\":";
+            buf += counters[i];
+        }
+        buf += ",\"heap_peak\":";
+        buf += Memory::globalStats().peak_bytes;
+        buf += ",\"heap_min_free\":";
+        buf += heap_min;
+        buf += ",\"latency\":";
+        latency_hist.toJSON(buf);
+        buf += ",\"ttfb\":";
+        ttfb_hist.toJSON(buf);
+        buf += '}';
+        return buf;
+    }
+};
+
+#endif
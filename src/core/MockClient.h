@@ -0,0 +1,285 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_MOCK_CLIENT_H
+#define CORE_MOCK_CLIENT_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include <vector>
+
+// The numbers of request bytes that are kept by MockClient for lastRequest.
+#if !defined(FIREBASE_MOCK_CLIENT_CAPTURE_SIZE)
+#define FIREBASE_MOCK_CLIENT_CAPTURE_SIZE 1024
+#endif
+
+/**
+ * The network client that replays the canned responses from memory or stream (file), or forwards to the other client
+ * and records its traffic, for benchmarking and profiling of the async client without network.
+ *
+ * The next response is replayed when the request is written after the previous response was read.
+ */
+class MockClient : public Client
+{
+public:
+    MockClient() {}
+
+    // The traffic of forward client is forwarded and counted, the responses are not replayed.
+    explicit MockClient(Client *forward) : forward(forward) {}
+
+    // Add the response that is replayed, the data should remain valid while it is used.
+    void addResponse(const char *data, size_t len = 0)
+    {
+        response_t r;
+        r.data = reinterpret_cast<const uint8_t *>(data);
+        r.len = len ? len : strlen(data);
+        responses.push_back(r);
+    }
+
+    // Add the response that is replayed from stream e.g. the file that was recorded by setRecorder, the stream should remain valid while it is used.
+    void addResponse(Stream &stream)
+    {
+        response_t r;
+        r.stream = &stream;
+        responses.push_back(r);
+    }
+
+    // Write the received data (server byte stream) of forward client to out e.g. the file to be replayed by addResponse.
+    void setRecorder(Print *out) { recorder = out; }
+
+    // Replay the responses repeatedly, the first response is replayed after the last one.
+    void setLoop(bool enable) { loop = enable; }
+
+    // The maximum bytes returned by available and each read to emulate the fragmented segments, 0 for no limit.
+    void setChunkSize(size_t size) { chunk_size = size; }
+
+    // Close the connection after each response to emulate the server that does not keep the connection alive.
+    void setCloseAfterResponse(bool enable) { close_after = enable; }
+
+    // Fail the connect to emulate the unreachable server.
+    void setConnectFail(bool fail) { connect_fail = fail; }
+
+    // Reset the counters and replay from the first response, the responses are kept.
+    void reset()
+    {
+        stop();
+        next = 0;
+        rx_pos = 0;
+        current = -1;
+        bytes_in = bytes_out = 0;
+        connects = requests = 0;
+        capture.remove(0, capture.length());
+    }
+
+    // Reset and remove the responses to replay the other responses.
+    void clearResponses()
+    {
+        reset();
+        responses.clear();
+    }
+
+    size_t bytesIn() const { return bytes_in; }
+    size_t bytesOut() const { return bytes_out; }
+    uint32_t connectCount() const { return connects; }
+    uint32_t requestCount() const { return requests; }
+
+    // The first FIREBASE_MOCK_CLIENT_CAPTURE_SIZE bytes of the last request.
+    const String &lastRequest() const { return capture; }
+
+    int connect(IPAddress ip, uint16_t port) override
+    {
+        if (forward)
+            return countConnect(forward->connect(ip, port));
+        return countConnect(!connect_fail);
+    }
+
+    int connect(const char *host, uint16_t port) override
+    {
+        if (forward)
+            return countConnect(forward->connect(host, port));
+        return countConnect(!connect_fail);
+    }
+
+    size_t write(uint8_t b) override { return write(&b, 1); }
+
+    size_t write(const uint8_t *buf, size_t size) override
+    {
+        if (!connected())
+            return 0;
+
+        size_t sent = forward ? forward->write(buf, size) : size;
+        if (!forward && current < 0 && nextResponse())
+        {
+            requests++;
+            capture.remove(0, capture.length());
+        }
+        else if (forward && !writing)
+        {
+            requests++;
+            capture.remove(0, capture.length());
+        }
+        writing = true;
+
+        for (size_t i = 0; i < sent && capture.length() < FIREBASE_MOCK_CLIENT_CAPTURE_SIZE; i++)
+            capture += (char)buf[i];
+        bytes_out += sent;
+        return sent;
+    }
+
+    int available() override
+    {
+        if (forward)
+            return forward->available();
+        if (current < 0)
+            return 0;
+        size_t avail = responses[current].stream ? responses[current].stream->available() : responses[current].len - rx_pos;
+        return chunk_size && avail > chunk_size ? chunk_size : avail;
+    }
+
+    int read() override
+    {
+        uint8_t b = 0;
+        return read(&b, 1) == 1 ? b : -1;
+    }
+
+    int read(uint8_t *buf, size_t size) override
+    {
+        if (forward)
+        {
+            int ret = forward->read(buf, size);
+            if (ret > 0)
+            {
+                writing = false;
+                bytes_in += ret;
+                if (recorder)
+                    recorder->write(buf, ret);
+            }
+            return ret;
+        }
+
+        size_t avail = available();
+        if (avail == 0)
+            return -1;
+        if (size > avail)
+            size = avail;
+        response_t &r = responses[current];
+        if (r.stream)
+            size = r.stream->readBytes(buf, size);
+        else
+            memcpy(buf, r.data + rx_pos, size);
+        rx_pos += size;
+        bytes_in += size;
+        if (r.stream ? r.stream->available() == 0 : rx_pos == r.len)
+            endResponse();
+        return size;
+    }
+
+    int peek() override
+    {
+        if (forward)
+            return forward->peek();
+        if (!available())
+            return -1;
+        return responses[current].stream ? responses[current].stream->peek() : responses[current].data[rx_pos];
+    }
+
+    void flush() override
+    {
+        if (forward)
+            forward->flush();
+    }
+
+    void stop() override
+    {
+        if (forward)
+            forward->stop();
+        is_connected = false;
+        writing = false;
+        current = -1;
+        rx_pos = 0;
+    }
+
+    uint8_t connected() override
+    {
+        if (forward)
+            return forward->connected();
+        // The connection is kept until the replayed response was read.
+        return is_connected || current > -1;
+    }
+
+    operator bool() override { return connected(); }
+
+private:
+    struct response_t
+    {
+        const uint8_t *data = nullptr;
+        size_t len = 0;
+        Stream *stream = nullptr;
+    };
+
+    std::vector<response_t> responses;
+    Client *forward = nullptr;
+    Print *recorder = nullptr;
+    size_t next = 0, rx_pos = 0, chunk_size = 0;
+    int current = -1;
+    bool loop = false, close_after = false, connect_fail = false, is_connected = false, writing = false;
+    size_t bytes_in = 0, bytes_out = 0;
+    uint32_t connects = 0, requests = 0;
+    String capture;
+
+    int countConnect(int ret)
+    {
+        if (ret > 0)
+        {
+            connects++;
+            is_connected = true;
+            writing = false;
+        }
+        return ret;
+    }
+
+    bool nextResponse()
+    {
+        if (next >= responses.size())
+        {
+            if (!loop || responses.size() == 0)
+                return false;
+            next = 0;
+        }
+        current = next++;
+        rx_pos = 0;
+        return true;
+    }
+
+    void endResponse()
+    {
+        current = -1;
+        rx_pos = 0;
+        writing = false;
+        if (close_after)
+            is_connected = false;
+    }
+};
+
+#endif
@@ -32,6 +32,28 @@
 
 #define FIREBASE_NET_RECONNECT_TIMEOUT_SEC 10000
 
+// The time in ms that the network status is used before the link status was read again, 0 for no caching.
+#if !defined(FIREBASE_NET_STATUS_CACHE_MS)
+#define FIREBASE_NET_STATUS_CACHE_MS 100
+#endif
+
+// The time in ms to wait the GSM modem to register to the network.
+#if !defined(FIREBASE_GSM_NETWORK_TIMEOUT)
+#define FIREBASE_GSM_NETWORK_TIMEOUT 60000
+#endif
+
+// The steps of Ethernet and GSM network connection that are advanced in every network status check.
+enum firebase_net_bringup_step
+{
+    firebase_net_bringup_idle,
+    firebase_net_bringup_eth_reset_low,
+    firebase_net_bringup_eth_reset_high,
+    firebase_net_bringup_eth_begin,
+    firebase_net_bringup_eth_link,
+    firebase_net_bringup_gsm_network,
+    firebase_net_bringup_gsm_gprs
+};
+
 struct network_config_data
 {
     friend class DefaultNetwork;
@@ -125,8 +147,11 @@ private:
     bool network_status = false;
     bool reconnect = true;
     FirebaseWiFi *wifi = nullptr;
+    NetworkSleepCallback sleep_cb = NULL;
     Timer net_timer;
     Timer eth_timer;
+    firebase_net_bringup_step bringup_step = firebase_net_bringup_idle;
+    unsigned long bringup_ms = 0;
 
 public:
     ~network_config_data() { clear(); }
@@ -154,11 +179,14 @@ public:
         this->network_status = rhs.network_status;
         this->reconnect = rhs.reconnect;
         this->wifi = rhs.wifi;
+        this->sleep_cb = rhs.sleep_cb;
 #if defined(FIREBASE_ETH_IS_AVAILABLE) && defined(ENABLE_ETHERNET_NETWORK)
         this->eth = rhs.eth;
 #endif
         this->net_timer = rhs.net_timer;
         this->net_timer.start();
+        this->bringup_step = rhs.bringup_step;
+        this->bringup_ms = rhs.bringup_ms;
     }
 
     void clear()
@@ -175,11 +203,13 @@ public:
         network_status = false;
         reconnect = true;
         wifi = nullptr;
+        sleep_cb = NULL;
 #if defined(FIREBASE_ETH_IS_AVAILABLE) && defined(ENABLE_ETHERNET_NETWORK)
         eth = NULL;
 #endif
         net_timer.stop();
         net_timer.setInterval(0);
+        bringup_step = firebase_net_bringup_idle;
     }
 };
 
@@ -200,6 +230,10 @@ public:
     }
     network_config_data &get() { return network_data; }
 
+    // Set the function that lets the radio sleep between the request batches of async client (radio batching),
+    // it should be set before the network config was passed to async client.
+    void setSleepCallback(NetworkSleepCallback cb) { network_data.sleep_cb = cb; }
+
 protected:
     network_config_data network_data;
 
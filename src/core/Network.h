@@ -32,6 +32,8 @@
 
 typedef void (*NetworkConnectionCallback)(void);
 typedef void (*NetworkStatusCallback)(bool &);
+// The function that lets the radio sleep (sleep is true) or wakes it up e.g. WiFi.setSleep or the modem PSM.
+typedef void (*NetworkSleepCallback)(bool sleep);
 
 #if __has_include(<esp_idf_version.h>)
 #include <esp_idf_version.h>
@@ -0,0 +1,191 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_NETWORK_WORKER_H
+#define CORE_NETWORK_WORKER_H
+
+#include <Arduino.h>
+#include "./Config.h"
+
+#if defined(ESP32) && !defined(FIREBASE_DISABLE_NETWORK_WORKER)
+#define FIREBASE_NETWORK_WORKER
+#endif
+
+#if defined(FIREBASE_NETWORK_WORKER)
+
+#include <atomic>
+
+// The stack size of the network worker task.
+#if !defined(FIREBASE_NETWORK_WORKER_STACK_SIZE)
+#define FIREBASE_NETWORK_WORKER_STACK_SIZE 8192
+#endif
+
+// The numbers of submitted jobs that are waiting for the network worker task.
+#if !defined(FIREBASE_NETWORK_WORKER_QUEUE_SIZE)
+#define FIREBASE_NETWORK_WORKER_QUEUE_SIZE 8
+#endif
+
+// The numbers of loop functions that are called by the network worker task.
+#if !defined(FIREBASE_NETWORK_WORKER_LOOP_LIMIT)
+#define FIREBASE_NETWORK_WORKER_LOOP_LIMIT 8
+#endif
+
+// The maximum time in ms that the network worker task waits for the submitted job between the loops.
+#if !defined(FIREBASE_NETWORK_WORKER_IDLE_MS)
+#define FIREBASE_NETWORK_WORKER_IDLE_MS 2
+#endif
+
+typedef void (*NetworkWorkerJob)(void *arg);
+
+// The FreeRTOS task that runs the loops of apps and services (ESP32).
+// The jobs e.g. the service function calls are submitted from one application task through the lock-free
+// single-producer single-consumer queue and are executed by the worker task before the loops.
+// The async result callbacks are called from the worker task.
+class NetworkWorker
+{
+public:
+    NetworkWorker() {}
+    ~NetworkWorker() { end(); }
+
+    /**
+     * Add the object that its loop function is called by the worker task e.g. FirebaseApp or the service apps.
+     * This should be called before begin.
+     *
+     * @param obj The object that provides the loop function.
+     * @return boolean The object was added.
+     */
+    template <typename T>
+    bool addLoop(T &obj)
+    {
+        return addLoop([](void *arg)
+                       { static_cast<T *>(arg)->loop(); }, &obj);
+    }
+
+    bool addLoop(NetworkWorkerJob fn, void *arg)
+    {
+        if (task || !fn || loop_count >= FIREBASE_NETWORK_WORKER_LOOP_LIMIT)
+            return false;
+        loops[loop_count].fn = fn;
+        loops[loop_count].arg = arg;
+        loop_count++;
+        return true;
+    }
+
+    /**
+     * Start the worker task.
+     *
+     * @param core The core that the task is pinned to, the application core is 1 in Arduino ESP32.
+     * @param priority The task priority.
+     * @return boolean The task was started.
+     */
+    bool begin(BaseType_t core = 0, UBaseType_t priority = 1)
+    {
+        if (task)
+            return true;
+        stopping = false;
+        running = true;
+        if (xTaskCreatePinnedToCore(workerTask, "firebase_net", FIREBASE_NETWORK_WORKER_STACK_SIZE, this, priority, &task, core) != pdPASS)
+        {
+            task = NULL;
+            running = false;
+        }
+        return task != NULL;
+    }
+
+    // Stop the worker task after the current loop, the jobs that were not executed are discarded.
+    void end()
+    {
+        if (!task)
+            return;
+        stopping = true;
+        xTaskNotifyGive(task);
+        while (running)
+            vTaskDelay(1);
+        task = NULL;
+        head.store(tail.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    /**
+     * Submit the job to the worker task, this should be called from one task only.
+     *
+     * @param fn The job function e.g. the capture-less lambda that calls the service function.
+     * @param arg The argument of job function.
+     * @return boolean The job was queued, false when the queue is full.
+     */
+    bool submit(NetworkWorkerJob fn, void *arg = nullptr)
+    {
+        uint8_t h = head.load(std::memory_order_relaxed), next = (h + 1) % (FIREBASE_NETWORK_WORKER_QUEUE_SIZE + 1);
+        if (!fn || next == tail.load(std::memory_order_acquire))
+            return false;
+        jobs[h].fn = fn;
+        jobs[h].arg = arg;
+        head.store(next, std::memory_order_release);
+        if (task)
+            xTaskNotifyGive(task);
+        return true;
+    }
+
+    bool isRunning() const { return task != NULL; }
+
+private:
+    struct job_t
+    {
+        NetworkWorkerJob fn = NULL;
+        void *arg = nullptr;
+    };
+
+    // The ring buffer has one empty entry to distinguish the full queue from the empty queue.
+    job_t jobs[FIREBASE_NETWORK_WORKER_QUEUE_SIZE + 1];
+    std::atomic<uint8_t> head{0}, tail{0};
+    job_t loops[FIREBASE_NETWORK_WORKER_LOOP_LIMIT];
+    uint8_t loop_count = 0;
+    TaskHandle_t task = NULL;
+    volatile bool stopping = false, running = false;
+
+    static void workerTask(void *arg)
+    {
+        NetworkWorker *worker = reinterpret_cast<NetworkWorker *>(arg);
+        while (!worker->stopping)
+        {
+            uint8_t t = worker->tail.load(std::memory_order_relaxed);
+            while (t != worker->head.load(std::memory_order_acquire))
+            {
+                worker->jobs[t].fn(worker->jobs[t].arg);
+                t = (t + 1) % (FIREBASE_NETWORK_WORKER_QUEUE_SIZE + 1);
+                worker->tail.store(t, std::memory_order_release);
+            }
+
+            for (uint8_t i = 0; i < worker->loop_count; i++)
+                worker->loops[i].fn(worker->loops[i].arg);
+
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(FIREBASE_NETWORK_WORKER_IDLE_MS));
+        }
+        worker->running = false;
+        vTaskDelete(NULL);
+    }
+};
+
+#endif
+
+#endif
@@ -0,0 +1,385 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_NUMBER_H
+#define CORE_NUMBER_H
+
+#include <Arduino.h>
+#include <math.h>
+#include <type_traits>
+
+// The buffer size that fits any formatted number.
+#define FIREBASE_NUMBER_BUF_SIZE 32
+
+// The number formatting and the parsing without memory allocation.
+class NumberUtil
+{
+private:
+    static double pow10(int e)
+    {
+        static const double tbl[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                     1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+        if (e >= 0 && e <= 22)
+            return tbl[e];
+        return pow(10.0, e);
+    }
+
+    static uint64_t pow10u(int e)
+    {
+        uint64_t v = 1;
+        while (e-- > 0)
+            v *= 10;
+        return v;
+    }
+
+    // Write the digits from the end of buffer, returns the digits count.
+    static size_t digits(uint64_t v, char *end)
+    {
+        char *p = end;
+        // The 32-bit division is used when possible, the 64-bit division is slow on 32-bit devices.
+        while (v > 0xffffffffULL)
+        {
+            *--p = '0' + v % 10;
+            v /= 10;
+        }
+        uint32_t v32 = (uint32_t)v;
+        do
+        {
+            *--p = '0' + v32 % 10;
+            v32 /= 10;
+        } while (v32);
+        return end - p;
+    }
+
+    static size_t special(double v, char *out)
+    {
+        const char *s = isnan(v) ? "nan" : (v < 0 ? "-inf" : "inf");
+        strcpy(out, s);
+        return strlen(s);
+    }
+
+    static size_t shortest(double v, bool single, char *out)
+    {
+        size_t len = 0;
+        if (v < 0)
+        {
+            out[len++] = '-';
+            v = -v;
+        }
+
+        if (v == 0)
+        {
+            out[len++] = '0';
+            out[len] = 0;
+            return len;
+        }
+
+        // Find the least significant digits that convert back to the same value.
+        // The check is exact only when the digits and the power of ten are exact doubles.
+        int e10 = (int)floor(log10(v));
+        int max_digits = single ? 9 : 17;
+        uint64_t n = 0;
+        int scale = 0;
+        bool found = false;
+        for (int p = 1; p <= max_digits && !found; p++)
+        {
+            scale = p - 1 - e10;
+            if (scale < -22 || scale > 22)
+                break;
+            double m = scale >= 0 ? v * pow10(scale) : v / pow10(-scale);
+            n = (uint64_t)(m + 0.5);
+            if (n >= (1ULL << 53))
+                break;
+            double back = scale >= 0 ? n / pow10(scale) : n * pow10(-scale);
+            found = single ? (float)back == (float)v : back == v;
+        }
+
+        if (!found)
+        {
+            // The rare case e.g. very large or small exponent and 17 digits.
+            for (int p = single ? 6 : 15; p <= 17; p++)
+            {
+                snprintf(out + len, FIREBASE_NUMBER_BUF_SIZE - len, "%.*g", p, v);
+                double back = strtod(out + len, nullptr);
+                if (single ? (float)back == (float)v : back == v)
+                    break;
+            }
+            return strlen(out);
+        }
+
+        while (n && n % 10 == 0)
+        {
+            n /= 10;
+            scale--;
+        }
+
+        char tmp[FIREBASE_NUMBER_BUF_SIZE];
+        size_t k = digits(n, tmp + sizeof(tmp));
+        const char *d = tmp + sizeof(tmp) - k;
+        // The numbers of digits before the decimal point.
+        int pos = (int)k - scale;
+
+        if (pos > 0 && pos <= 21)
+        {
+            for (int i = 0; i < pos; i++)
+                out[len++] = i < (int)k ? d[i] : '0';
+            if (pos < (int)k)
+            {
+                out[len++] = '.';
+                for (size_t i = pos; i < k; i++)
+                    out[len++] = d[i];
+            }
+        }
+        else if (pos <= 0 && pos > -6)
+        {
+            out[len++] = '0';
+            out[len++] = '.';
+            for (int i = 0; i < -pos; i++)
+                out[len++] = '0';
+            for (size_t i = 0; i < k; i++)
+                out[len++] = d[i];
+        }
+        else
+        {
+            out[len++] = d[0];
+            if (k > 1)
+            {
+                out[len++] = '.';
+                for (size_t i = 1; i < k; i++)
+                    out[len++] = d[i];
+            }
+            out[len++] = 'e';
+            len += format((int32_t)(pos - 1), out + len);
+        }
+        out[len] = 0;
+        return len;
+    }
+
+public:
+    /**
+     * Format the integer to decimal.
+     *
+     * @param v The integer value, the 64-bit integer is supported.
+     * @param out The buffer that should be at least FIREBASE_NUMBER_BUF_SIZE bytes.
+     * @return size_t The length of text.
+     */
+    template <typename T>
+    static auto format(T v, char *out) -> typename std::enable_if<std::is_integral<T>::value, size_t>::type
+    {
+        size_t len = 0;
+        uint64_t u = (uint64_t)v;
+        if (std::is_signed<T>::value && v < 0)
+        {
+            out[len++] = '-';
+            u = ~u + 1;
+        }
+        char tmp[FIREBASE_NUMBER_BUF_SIZE];
+        size_t k = digits(u, tmp + sizeof(tmp));
+        memcpy(out + len, tmp + sizeof(tmp) - k, k);
+        len += k;
+        out[len] = 0;
+        return len;
+    }
+
+    /**
+     * Format the floating point number to decimal.
+     *
+     * @param v The float or double value.
+     * @param decimals The decimal places, the negative value is for the shortest text that converts back to the same value.
+     * @param out The buffer that should be at least FIREBASE_NUMBER_BUF_SIZE bytes.
+     * @return size_t The length of text.
+     */
+    template <typename T>
+    static auto format(T v, int decimals, char *out) -> typename std::enable_if<std::is_floating_point<T>::value, size_t>::type
+    {
+        double d = v;
+        if (isnan(d) || isinf(d))
+            return special(d, out);
+
+        if (decimals < 0)
+            return shortest(d, std::is_same<T, float>::value, out);
+
+        if (decimals > 15)
+            decimals = 15;
+
+        size_t len = 0;
+        if (d < 0)
+        {
+            out[len++] = '-';
+            d = -d;
+        }
+
+        double scaled = d * pow10(decimals) + 0.5;
+        if (scaled >= 1.8e19)
+        {
+            // Too large for the integer path.
+            len += shortest(d, std::is_same<T, float>::value, out + len);
+            return len;
+        }
+
+        uint64_t u = (uint64_t)scaled, div = pow10u(decimals);
+        len += format(u / div, out + len);
+        if (decimals > 0)
+        {
+            out[len++] = '.';
+            char tmp[FIREBASE_NUMBER_BUF_SIZE];
+            size_t k = digits(u % div, tmp + sizeof(tmp));
+            for (int i = k; i < decimals; i++)
+                out[len++] = '0';
+            memcpy(out + len, tmp + sizeof(tmp) - k, k);
+            len += k;
+        }
+        out[len] = 0;
+        return len;
+    }
+
+    template <typename T>
+    static auto toString(T v) -> typename std::enable_if<std::is_integral<T>::value, String>::type
+    {
+        char buf[FIREBASE_NUMBER_BUF_SIZE];
+        format(v, buf);
+        return buf;
+    }
+
+    template <typename T>
+    static auto toString(T v, int decimals) -> typename std::enable_if<std::is_floating_point<T>::value, String>::type
+    {
+        char buf[FIREBASE_NUMBER_BUF_SIZE];
+        format(v, decimals, buf);
+        return buf;
+    }
+
+    /**
+     * Parse the number in place e.g. the span in the payload.
+     *
+     * @param buf The text buffer, it is not required to be null-terminated.
+     * @param len The length of text.
+     * @param neg The number is negative.
+     * @param u The magnitude of integer part.
+     * @param d The floating point value.
+     * @return size_t The numbers of characters parsed, 0 if it is not a number.
+     */
+    static size_t parse(const char *buf, size_t len, bool &neg, uint64_t &u, double &d)
+    {
+        size_t i = 0;
+        neg = false;
+        u = 0;
+        d = 0;
+
+        while (i < len && buf[i] == ' ')
+            i++;
+
+        size_t start = i;
+        if (i < len && (buf[i] == '-' || buf[i] == '+'))
+            neg = buf[i++] == '-';
+
+        uint64_t m = 0;
+        int sig = 0, exp = 0;
+        bool overflow = false, digit = false;
+
+        for (; i < len && buf[i] >= '0' && buf[i] <= '9'; i++)
+        {
+            digit = true;
+            uint8_t c = buf[i] - '0';
+            if (!overflow)
+            {
+                if (u > (0xffffffffffffffffULL - c) / 10)
+                {
+                    overflow = true;
+                    u = 0xffffffffffffffffULL;
+                }
+                else
+                    u = u * 10 + c;
+            }
+            if (sig < 19)
+            {
+                if (m || c)
+                    sig++;
+                m = m * 10 + c;
+            }
+            else
+                exp++;
+        }
+
+        if (i < len && buf[i] == '.')
+        {
+            for (i++; i < len && buf[i] >= '0' && buf[i] <= '9'; i++)
+            {
+                digit = true;
+                if (sig < 19)
+                {
+                    uint8_t c = buf[i] - '0';
+                    if (m || c)
+                        sig++;
+                    m = m * 10 + c;
+                    exp--;
+                }
+            }
+        }
+
+        if (!digit)
+            return 0;
+
+        bool exact = sig <= 15;
+        if (i < len && (buf[i] == 'e' || buf[i] == 'E'))
+        {
+            size_t j = i + 1;
+            bool eneg = false;
+            if (j < len && (buf[j] == '-' || buf[j] == '+'))
+                eneg = buf[j++] == '-';
+            if (j < len && buf[j] >= '0' && buf[j] <= '9')
+            {
+                int e = 0;
+                for (; j < len && buf[j] >= '0' && buf[j] <= '9'; j++)
+                    if (e < 10000)
+                        e = e * 10 + (buf[j] - '0');
+                exp += eneg ? -e : e;
+                i = j;
+            }
+        }
+
+        if (exact && exp >= -22 && exp <= 22)
+        {
+            // The exact conversion, both the mantissa and the power of ten are exact doubles.
+            d = exp >= 0 ? (double)m * pow10(exp) : (double)m / pow10(-exp);
+        }
+        else if (i - start < FIREBASE_NUMBER_BUF_SIZE)
+        {
+            char tmp[FIREBASE_NUMBER_BUF_SIZE];
+            memcpy(tmp, buf + start, i - start);
+            tmp[i - start] = 0;
+            d = strtod(tmp, nullptr);
+            return i;
+        }
+        else
+            d = (double)m * pow10(exp);
+
+        if (neg)
+            d = -d;
+
+        return i;
+    }
+};
+
+#endif
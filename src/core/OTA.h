@@ -33,57 +33,329 @@
 #include "./core/Base64.h"
 #include "./core/Error.h"
 
-class OTAUtil
+// The size of firmware block that is written to flash, the next block is received while the other block is written.
+#if !defined(FIREBASE_OTA_BLOCK_SIZE)
+#define FIREBASE_OTA_BLOCK_SIZE 4096
+#endif
+
+#if defined(OTA_UPDATE_ENABLED) && defined(ESP32) && !defined(FIREBASE_DISABLE_OTA_WRITE_TASK)
+#define FIREBASE_OTA_WRITE_TASK
+#endif
+
+// The stack size of the task that writes the firmware blocks to flash (ESP32).
+#if !defined(FIREBASE_OTA_WRITE_TASK_STACK_SIZE)
+#define FIREBASE_OTA_WRITE_TASK_STACK_SIZE 4096
+#endif
+
+// The double buffered firmware writer.
+// On ESP32, the full block is written by the write task while the next block is received.
+// On other devices, the full block is written when no data is available to read (see poll)
+// or when the other block is also full.
+class OTAWriter : public Print
 {
 public:
-    void getPad(uint8_t *s, int &len, int8_t &pad)
+    OTAWriter() {}
+    ~OTAWriter() { release(); }
+
+    bool begin()
+    {
+        release();
+        Memory mem;
+        for (int i = 0; i < 2; i++)
+        {
+            buf[i] = reinterpret_cast<uint8_t *>(mem.alloc(FIREBASE_OTA_BLOCK_SIZE, false, mem_class_file));
+            len[i] = 0;
+            if (!buf[i])
+            {
+                release();
+                return false;
+            }
+        }
+        error = false;
+#if defined(FIREBASE_OTA_WRITE_TASK)
+        fill = -1;
+        full_q = xQueueCreate(2, sizeof(uint8_t));
+        free_q = xQueueCreate(2, sizeof(uint8_t));
+        if (!full_q || !free_q || xTaskCreate(writeTask, "ota_write", FIREBASE_OTA_WRITE_TASK_STACK_SIZE, this, 1, &task) != pdPASS)
+        {
+            task = NULL;
+            release();
+            return false;
+        }
+        for (uint8_t i = 0; i < 2; i++)
+            xQueueSend(free_q, &i, portMAX_DELAY);
+#else
+        fill = 0;
+        pending = -1;
+#endif
+        return true;
+    }
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+
+    // Copy the data to the block buffer, the full block is queued for writing.
+    // Returns zero when the previous flash write was failed.
+    size_t write(const uint8_t *data, size_t size) override
+    {
+        size_t total = size;
+        while (size > 0 && !error)
+        {
+#if defined(FIREBASE_OTA_WRITE_TASK)
+            nextBlock();
+#endif
+            size_t n = FIREBASE_OTA_BLOCK_SIZE - len[fill];
+            if (n > size)
+                n = size;
+            memcpy(buf[fill] + len[fill], data, n);
+            len[fill] += n;
+            data += n;
+            size -= n;
+            if (len[fill] == FIREBASE_OTA_BLOCK_SIZE)
+                submit();
+        }
+        return error ? 0 : total;
+    }
+
+    // The free space of block buffer that the data can be written to directly, see commit.
+    uint8_t *space(size_t &avail)
+    {
+        avail = 0;
+        if (error)
+            return nullptr;
+#if defined(FIREBASE_OTA_WRITE_TASK)
+        nextBlock();
+#endif
+        avail = FIREBASE_OTA_BLOCK_SIZE - len[fill];
+        return buf[fill] + len[fill];
+    }
+
+    // The data of size bytes were written to the space, the full block is queued for writing.
+    void commit(size_t size)
+    {
+        len[fill] += size;
+        if (len[fill] == FIREBASE_OTA_BLOCK_SIZE)
+            submit();
+    }
+
+    // Write the full block that is waiting, it is called while no data is available to read.
+    void poll()
+    {
+#if !defined(FIREBASE_OTA_WRITE_TASK)
+        if (pending > -1)
+        {
+            writeBlock(pending);
+            pending = -1;
+        }
+#endif
+    }
+
+    // Write the remaining data and wait until all blocks were written.
+    bool finish()
+    {
+#if defined(FIREBASE_OTA_WRITE_TASK)
+        if (fill > -1 && len[fill] > 0)
+            submit();
+        uint32_t us = micros();
+        wait();
+        write_us += micros() - us;
+#else
+        poll();
+        if (len[fill] > 0)
+            writeBlock(fill);
+#endif
+        return !error;
+    }
+
+    bool failed() const { return error; }
+
+    // The time (µs) that the caller was blocked by the flash writes since the last call, it is reset.
+    uint32_t takeWriteTime()
+    {
+        uint32_t us = write_us;
+        write_us = 0;
+        return us;
+    }
+
+    void release()
+    {
+#if defined(FIREBASE_OTA_WRITE_TASK)
+        if (task)
+        {
+            wait();
+            vTaskDelete(task);
+            task = NULL;
+        }
+        if (full_q)
+            vQueueDelete(full_q);
+        if (free_q)
+            vQueueDelete(free_q);
+        full_q = NULL;
+        free_q = NULL;
+#endif
+        Memory mem;
+        for (int i = 0; i < 2; i++)
+        {
+            mem.release(&buf[i]);
+            len[i] = 0;
+        }
+    }
+
+private:
+    uint8_t *buf[2] = {nullptr, nullptr};
+    size_t len[2] = {0, 0};
+    // The block that is being filled.
+    int8_t fill = 0;
+    volatile bool error = false;
+    uint32_t write_us = 0;
+#if defined(FIREBASE_OTA_WRITE_TASK)
+    TaskHandle_t task = NULL;
+    // The indices of blocks that are waiting for writing and the blocks that were written.
+    QueueHandle_t full_q = NULL, free_q = NULL;
+
+    static void writeTask(void *arg)
     {
-        pad = -1;
-        if (len > 1)
+        OTAWriter *writer = reinterpret_cast<OTAWriter *>(arg);
+        uint8_t i = 0;
+        for (;;)
         {
-            if (s[len - 1] == '"')
+            if (xQueueReceive(writer->full_q, &i, portMAX_DELAY) == pdTRUE)
             {
-                pad = 0;
-                if (len > 2)
-                {
-                    if (s[len - 2] == '=')
-                        pad++;
-                }
-                if (len > 3)
-                {
-                    if (s[len - 3] == '=')
-                        pad++;
-                }
-                s[len - 1] = 0;
-                len--;
+                writer->writeBlock(i);
+                xQueueSend(writer->free_q, &i, portMAX_DELAY);
             }
         }
     }
 
-    bool decodeBase64OTA(Memory &mem, Base64Util *but, const char *src, size_t len, int16_t &code)
+    // Wait for the block that was written.
+    void nextBlock()
     {
+        if (fill < 0)
+        {
+            uint8_t i = 0;
+            uint32_t us = micros();
+            xQueueReceive(free_q, &i, portMAX_DELAY);
+            write_us += micros() - us;
+            fill = i;
+        }
+    }
+
+    // Wait until the write task is idle, the buffers are then free for filling.
+    void wait()
+    {
+        uint8_t i = 0, idle = fill > -1 ? 1 : 0;
+        while (idle < 2 && xQueueReceive(free_q, &i, portMAX_DELAY) == pdTRUE)
+            idle++;
+        fill = -1;
+        for (i = 0; i < 2; i++)
+            xQueueSend(free_q, &i, portMAX_DELAY);
+    }
 
+    void submit()
+    {
+        uint8_t i = fill;
+        fill = -1;
+        xQueueSend(full_q, &i, portMAX_DELAY);
+    }
+#else
+    // The full block that is waiting for writing.
+    int8_t pending = -1;
+
+    void submit()
+    {
+        // Both blocks are full, the waiting block is written first.
+        poll();
+        pending = fill;
+        fill = 1 - fill;
+    }
+#endif
+
+    void writeBlock(int8_t i)
+    {
+        Base64Util but;
+#if !defined(FIREBASE_OTA_WRITE_TASK)
+        uint32_t us = micros();
+#endif
+        if (!error && len[i] > 0 && !but.updateWrite(buf[i], len[i]))
+            error = true;
+        len[i] = 0;
+#if !defined(FIREBASE_OTA_WRITE_TASK)
+        write_us += micros() - us;
+#endif
+    }
+};
+
+class OTAUtil
+{
+public:
+    // Decode the base64 firmware, the decoded data are written to the block buffer of writer directly,
+    // or via the temporary buffer to the other sink (see DeltaOTA) or to Update.
+    bool decodeBase64OTA(Memory &mem, Base64Decoder &dec, const uint8_t *src, size_t len, Print *sink, OTAWriter *writer, int16_t &code)
+    {
         bool ret = true;
-        firebase_base64_io_t<uint8_t> out;
-        uint8_t *buf = reinterpret_cast<uint8_t *>(mem.alloc(out.bufLen));
-        out.ota = true;
-        out.outT = buf;
-        unsigned char *base64DecBuf = but->creatBase64DecBuffer(mem);
-        if (!but->decode<uint8_t>(mem, base64DecBuf, src, strlen(src), out))
+        size_t written = 0;
+        if (writer && sink == writer)
         {
-            code = FIREBASE_ERROR_FW_UPDATE_WRITE_FAILED;
-            ret = false;
+            while (ret && len > 0)
+            {
+                size_t avail = 0;
+                uint8_t *dst = writer->space(avail);
+                size_t n = dst ? dec.decode(src, len, dst, avail, written) : 0;
+                writer->commit(written);
+                ret = n > 0 && !writer->failed();
+                src += n;
+                len -= n;
+            }
+        }
+        else
+        {
+            uint8_t *decoded = reinterpret_cast<uint8_t *>(mem.alloc(len, false, mem_class_file));
+            ret = decoded != nullptr;
+            // The decoded bytes are less than the characters, all characters should be consumed.
+            if (ret)
+                ret = dec.decode(src, len, decoded, len, written) == len;
+            if (ret && written > 0)
+            {
+                Base64Util but;
+                ret = sink ? sink->write(decoded, written) == written : but.updateWrite(decoded, written);
+            }
+            mem.release(&decoded);
         }
-        mem.release(&buf);
-        mem.release(&base64DecBuf);
+
+        if (!ret)
+            code = FIREBASE_ERROR_FW_UPDATE_WRITE_FAILED;
         return ret;
     }
 
+    // The bytes that were written to the update that is running.
+    size_t updateProgress()
+    {
+#if defined(OTA_UPDATE_ENABLED) && (defined(ESP32) || defined(ESP8266) || defined(CORE_ARDUINO_PICO))
+        return Update.isRunning() ? Update.progress() : 0;
+#endif
+        return 0;
+    }
+
+    // Abort the update of interrupted download that was not resumed.
+    void abortUpdate()
+    {
+#if defined(OTA_UPDATE_ENABLED) && defined(ESP32)
+        if (Update.isRunning())
+            Update.abort();
+#elif defined(OTA_UPDATE_ENABLED) && (defined(ESP8266) || defined(CORE_ARDUINO_PICO))
+        // The updater has no abort, the end of unfinished update resets it without committing the firmware.
+        if (Update.isRunning() && !Update.isFinished())
+            Update.end();
+#endif
+    }
+
+    // The firmware size of payload, the base64 payload is the JSON string.
+    size_t firmwareSize(size_t payloadLen, bool base64) { return base64 ? (3 * (payloadLen - 2) / 4) : payloadLen; }
+
     void prepareDownloadOTA(size_t payloadLen, bool base64, int16_t &code)
     {
         code = 0;
 #if defined(OTA_UPDATE_ENABLED) && (defined(ESP32) || defined(ESP8266) || defined(CORE_ARDUINO_PICO))
-        int size = base64 ? (3 * (payloadLen - 2) / 4) : payloadLen;
+        int size = firmwareSize(payloadLen, base64);
 #if defined(ESP32) || defined(CORE_ARDUINO_PICO)
         if (!Update.begin(size))
             code = FIREBASE_ERROR_FW_UPDATE_TOO_LOW_FREE_SKETCH_SPACE;
@@ -95,7 +367,8 @@ public:
 #endif
     }
 
-    bool endDownloadOTA(int pad, int16_t &code)
+    // The update size is the bytes that were written when remaining is true (the size of firmware was unknown).
+    bool endDownloadOTA(int pad, int16_t &code, bool remaining = false)
     {
 
 #if defined(OTA_UPDATE_ENABLED) && (defined(ESP32) || defined(ESP8266) || defined(CORE_ARDUINO_PICO))
@@ -110,13 +383,14 @@ public:
 
         if (code == 0)
         {
-            if (!Update.end())
+            if (!Update.end(remaining))
                 code = FIREBASE_ERROR_FW_UPDATE_END_FAILED;
         }
 
         return code == 0;
 
 #endif
+        (void)remaining;
         return false;
     }
 };
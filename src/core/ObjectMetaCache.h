@@ -0,0 +1,147 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_OBJECT_META_CACHE_H
+#define CORE_OBJECT_META_CACHE_H
+
+#include <Arduino.h>
+#include <vector>
+#include "./Config.h"
+#include "./core/JsonParser.h"
+#include "./core/ResponseCache.h"
+
+// The maximum number of objects that their metadata are cached.
+#if !defined(FIREBASE_OBJECT_META_CACHE_SIZE)
+#define FIREBASE_OBJECT_META_CACHE_SIZE 8
+#endif
+
+// The time in milliseconds that the cached metadata is used without request.
+#if !defined(FIREBASE_OBJECT_META_CACHE_TTL)
+#define FIREBASE_OBJECT_META_CACHE_TTL 300000
+#endif
+
+// The object metadata that are cached.
+struct object_meta_t
+{
+public:
+    String generation, md5, etag;
+    size_t size = 0;
+};
+
+// The least recently used cache of object metadata, the entries are keyed by bucket and object (or download target).
+class ObjectMetaCache
+{
+public:
+    ObjectMetaCache() {}
+
+    static String key(const String &bucket, const String &object)
+    {
+        String k = bucket;
+        k += '/';
+        k += object;
+        return k;
+    }
+
+    // Set the metadata from object resource (JSON) e.g. the response of get metadata and upload.
+    bool update(const String &json)
+    {
+        String bucket, name, size;
+        object_meta_t meta;
+        if (!JsonPullParser::get(json, "bucket", bucket) || !JsonPullParser::get(json, "name", name) || !JsonPullParser::get(json, "generation", meta.generation))
+            return false;
+        JsonPullParser::get(json, "size", size);
+        JsonPullParser::get(json, "md5Hash", meta.md5);
+        JsonPullParser::get(json, "etag", meta.etag);
+        meta.size = strtoul(size.c_str(), nullptr, 10);
+        set(key(bucket, name), meta);
+        return true;
+    }
+
+    void set(const String &key, const object_meta_t &meta)
+    {
+        remove(key);
+        if (FIREBASE_OBJECT_META_CACHE_SIZE == 0)
+            return;
+        if (entries.size() >= FIREBASE_OBJECT_META_CACHE_SIZE)
+            entries.pop_back();
+        entry_t entry;
+        entry.hash = ResponseCache::hash(key);
+        entry.key = key;
+        entry.ts = millis();
+        entry.meta = meta;
+        entries.insert(entries.begin(), entry);
+    }
+
+    // Get the metadata that was cached within ttl milliseconds (0 for any age).
+    bool get(const String &key, object_meta_t &meta, uint32_t ttl = 0)
+    {
+        int i = find(key);
+        if (i < 0 || (ttl > 0 && millis() - entries[i].ts > ttl))
+            return false;
+        meta = entries[i].meta;
+        // The used entry is the most recently used.
+        if (i > 0)
+        {
+            entry_t entry = entries[i];
+            entries.erase(entries.begin() + i);
+            entries.insert(entries.begin(), entry);
+        }
+        return true;
+    }
+
+    void remove(const String &key)
+    {
+        int i = find(key);
+        if (i > -1)
+            entries.erase(entries.begin() + i);
+    }
+
+    void clear() { entries.clear(); }
+
+private:
+    struct entry_t
+    {
+        uint32_t hash = 0;
+        String key;
+        unsigned long ts = 0;
+        object_meta_t meta;
+    };
+
+    // The most recently used entry is the first.
+    std::vector<entry_t> entries;
+
+    // The hash is compared first, the key is compared for the hash collision.
+    int find(const String &key) const
+    {
+        uint32_t hash = ResponseCache::hash(key);
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            if (entries[i].hash == hash && entries[i].key == key)
+                return i;
+        }
+        return -1;
+    }
+};
+
+#endif
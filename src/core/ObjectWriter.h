@@ -26,6 +26,7 @@
 #define CORE_OBJECT_WRITER_H
 
 #include <Arduino.h>
+#include <vector>
 #include "./Config.h"
 
 #include "./core/JSON.h"
@@ -38,33 +39,40 @@ private:
     JSONUtil jut;
 
 public:
+    // Append the member in place before the closing token, the buffer capacity grows geometrically.
     void addMember(String &buf, const String &v, bool isString, const String &token = "}}")
     {
         int p = buf.lastIndexOf(token);
-        String str = buf.substring(0, p);
-        str += ',';
-        // Add to object
-        if (token[0] == '}')
-        {
-            String tmp;
-            if (isString)
-                tmp += '"';
-            tmp += v;
-            if (isString)
-                tmp += '"';
-            str += tmp.substring(1, tmp.length() - 1);
-        }
-        // Add to array
-        else
+        if (p > -1)
+            buf.remove(p);
+
+        // Add to object, the enclosing braces of non-string member are not included.
+        size_t from = 0, to = v.length();
+        bool quote = isString && token[0] != '}';
+        if (token[0] == '}' && !isString)
         {
-            if (isString)
-                str += '"';
-            str += v;
-            if (isString)
-                str += '"';
+            from = 1;
+            if (to > 0)
+                to--;
         }
-        str += token;
-        buf = str;
+
+        reserve(buf, buf.length() + 1 + (to - from) + (quote ? 2 : 0) + token.length());
+        buf += ',';
+        if (quote)
+            buf += '"';
+        for (size_t i = from; i < to; i++)
+            buf += v[i];
+        if (quote)
+            buf += '"';
+        buf += token;
+    }
+
+    void reserve(String &buf, size_t len)
+    {
+        size_t cap = 32;
+        while (cap < len)
+            cap <<= 1;
+        buf.reserve(cap);
     }
 
     void addObject(String &buf, const String &object, const String &token, bool clear = false)
@@ -80,49 +88,6 @@ public:
         }
     }
 
-    void addMapArrayMember(String *buf, size_t size, uint8_t index, const String &key, const String &memberValue, bool isString)
-    {
-        if (index < size)
-        {
-            if (buf[index].length() == 0)
-            {
-                String temp;
-                jut.addArray(temp, memberValue, isString, true);
-                jut.addObject(buf[index], key, temp, false, true);
-            }
-            else
-                addMember(buf[index], memberValue, isString, "]}");
-
-            getBuf(buf, size);
-        }
-    }
-
-    void getBuf(String *buf, size_t size)
-    {
-        clear(buf[0]);
-        for (size_t i = 1; i < size; i++)
-            addObject(buf[0], buf[i], "}", i == 0);
-    }
-
-    void setObject(String *buf, size_t size, uint8_t index, const String &key, const String &value, bool isString, bool last)
-    {
-        if (index < size)
-        {
-            if (key.length())
-            {
-                clear(buf[index]);
-                jut.addObject(buf[index], key, value, isString, last);
-            }
-            getBuf(buf, size);
-        }
-    }
-
-    void clearBuf(String *buf, size_t size)
-    {
-        for (size_t i = 0; i < size; i++)
-            clear(buf[i]);
-    }
-
     void clear(String &buf) { buf.remove(0, buf.length()); }
 
     const char *setPair(String &buf, const String &key, const String &value, bool isArrayValue = false)
@@ -168,6 +133,207 @@ public:
     }
 };
 
+/**
+ * The fields of option object that are kept sparsely in one buffer with the presence bits.
+ *
+ * The buffer is the serialized JSON object (or query parameters) of the fields in index order, the member of field
+ * is spliced in place then the setter does not rebuild the other fields.
+ */
+class ObjectFields
+{
+public:
+    ObjectFields() {}
+
+    // Set the tokens that enclose and separate the members e.g. ('?', '&', 0) for the query parameters.
+    void setFormat(char open, char separator, char close)
+    {
+        clear();
+        this->open = open;
+        this->separator = separator;
+        this->close = close;
+    }
+
+    const char *c_str() const { return data.c_str(); }
+
+    bool isSet(uint8_t index) const { return index < 32 && (present & (1UL << index)); }
+
+    // Set the member text e.g. "key":value of field, the empty member removes the field.
+    void set(uint8_t index, const char *member, size_t len)
+    {
+        if (index >= 32)
+            return;
+
+        if (raw)
+            clear();
+
+        size_t k = 0, pos = open ? 1 : 0;
+        while (k < fields.size() && fields[k].index < index)
+            pos += fields[k++].len + 1;
+
+        bool found = isSet(index);
+        if (found && len == 0)
+        {
+            // Remove the member with its separator.
+            size_t from = k > 0 ? pos - 1 : pos, to = pos + fields[k].len + (k > 0 ? 0 : 1);
+            fields.erase(fields.begin() + k);
+            present &= ~(1UL << index);
+            if (fields.size() == 0)
+                data.remove(0, data.length());
+            else
+                data.remove(from, to - from);
+            return;
+        }
+
+        if (len == 0)
+            return;
+
+        String out;
+        out.reserve(data.length() + len + 3);
+        if (fields.size() == 0)
+        {
+            if (open)
+                out += open;
+            out.concat(member, len);
+            if (close)
+                out += close;
+        }
+        else if (found)
+        {
+            out.concat(data.c_str(), pos);
+            out.concat(member, len);
+            out.concat(data.c_str() + pos + fields[k].len, data.length() - pos - fields[k].len);
+        }
+        else if (k < fields.size())
+        {
+            out.concat(data.c_str(), pos);
+            out.concat(member, len);
+            out += separator;
+            out.concat(data.c_str() + pos, data.length() - pos);
+        }
+        else
+        {
+            out.concat(data.c_str(), data.length() - (close ? 1 : 0));
+            out += separator;
+            out.concat(member, len);
+            if (close)
+                out += close;
+        }
+        data = out;
+
+        if (found)
+            fields[k].len = len;
+        else
+        {
+            field_t f;
+            f.index = index;
+            f.len = len;
+            fields.insert(fields.begin() + k, f);
+            present |= 1UL << index;
+        }
+    }
+
+    void set(uint8_t index, const String &member) { set(index, member.c_str(), member.length()); }
+
+    // Set the members of JSON object e.g. {"key":value} to field.
+    void setObject(uint8_t index, const String &object)
+    {
+        if (object.length() > 1 && object[0] == '{')
+            set(index, object.c_str() + 1, object.length() - 2);
+        else
+            set(index, "", 0);
+    }
+
+    // Add the value to the array member ("key":[values]) of field, the member is created when it was not set.
+    void append(uint8_t index, const String &key, const String &value, bool isString)
+    {
+        String member;
+        size_t pos = 0, len = 0;
+        if (!raw && locate(index, pos, len) && data[pos + len - 1] == ']')
+        {
+            member.reserve(len + value.length() + 3);
+            member.concat(data.c_str() + pos, len - 1);
+            member += ',';
+        }
+        else
+        {
+            member.reserve(key.length() + value.length() + 7);
+            member += '"';
+            member += key;
+            member += FPSTR("\":[");
+        }
+        // The quoted string value is not quoted again.
+        if (isString && value[0] != '"')
+            member += '"';
+        member += value;
+        if (isString && value[value.length() - 1] != '"')
+            member += '"';
+        member += ']';
+        set(index, member);
+    }
+
+    // Get the JSON object of field e.g. {"key":value}, it is empty when the field was not set.
+    String get(uint8_t index) const
+    {
+        String object;
+        size_t pos = 0, len = 0;
+        if (!raw && locate(index, pos, len))
+        {
+            object.reserve(len + 2);
+            object += '{';
+            object.concat(data.c_str() + pos, len);
+            object += '}';
+        }
+        return object;
+    }
+
+    void clear()
+    {
+        data.remove(0, data.length());
+        fields.clear();
+        present = 0;
+        raw = false;
+    }
+
+    // Set the serialized object, the fields are cleared and the next setter starts the new object.
+    void setContent(const String &content)
+    {
+        clear();
+        data = content;
+        raw = data.length() > 0;
+    }
+
+private:
+    struct field_t
+    {
+        uint8_t index = 0;
+        uint32_t len = 0;
+    };
+
+    String data;
+    // The fields that are set in index order.
+    std::vector<field_t> fields;
+    uint32_t present = 0;
+    bool raw = false;
+    char open = '{', separator = ',', close = '}';
+
+    bool locate(uint8_t index, size_t &pos, size_t &len) const
+    {
+        if (!isSet(index))
+            return false;
+        pos = open ? 1 : 0;
+        for (size_t k = 0; k < fields.size(); k++)
+        {
+            if (fields[k].index == index)
+            {
+                len = fields[k].len;
+                return true;
+            }
+            pos += fields[k].len + 1;
+        }
+        return false;
+    }
+};
+
 class BufWriter
 {
 private:
@@ -188,9 +354,21 @@ private:
         static bool const value = std::is_same<T, const char *>::value || std::is_same<T, std::string>::value || std::is_same<T, String>::value;
     };
 
-    void setObject(String *buf, size_t bufSize, uint8_t index, const String &key, const String &value, bool isString, bool last)
+    void setObject(ObjectFields &buf, size_t bufSize, uint8_t index, const String &key, const String &value, bool isString)
+    {
+        if (index < bufSize && key.length())
+        {
+            String temp;
+            jut.addObject(temp, key, value, isString, true);
+            // The member without the enclosing braces.
+            buf.set(index, temp.c_str() + 1, temp.length() - 2);
+        }
+    }
+
+    void addArrayMember(ObjectFields &buf, size_t bufSize, uint8_t index, const String &key, const String &value, bool isString)
     {
-        owriter.setObject(buf, bufSize, index, key, value, isString, last);
+        if (index < bufSize)
+            buf.append(index, key, value, isString);
     }
 
 public:
@@ -228,62 +406,61 @@ public:
     }
 
     template <typename T1, typename T2>
-    T1 set(T1 ret, bool value, String *buf, size_t bufSize, uint8_t index, const String &name)
+    T1 set(T1 ret, bool value, ObjectFields &buf, size_t bufSize, uint8_t index, const String &name)
     {
-        setObject(buf, bufSize, index, name, owriter.getBoolStr(value), false, true);
+        setObject(buf, bufSize, index, name, owriter.getBoolStr(value), false);
         return ret;
     }
 
     template <typename T1, typename T2>
-    auto set(T1 ret, const T2 &value, String *buf, size_t bufSize, uint8_t index, const String &name) -> typename std::enable_if<v_number<T2>::value, T1>::type
+    auto set(T1 ret, const T2 &value, ObjectFields &buf, size_t bufSize, uint8_t index, const String &name) -> typename std::enable_if<v_number<T2>::value, T1>::type
     {
-        setObject(buf, bufSize, index, name, String(value), false, true);
+        setObject(buf, bufSize, index, name, String(value), false);
         return ret;
     }
 
     template <typename T1, typename T2>
-    auto set(T1 ret, const T2 &value, String *buf, size_t bufSize, uint8_t index, const String &name) -> typename std::enable_if<v_sring<T2>::value, T1>::type
+    auto set(T1 ret, const T2 &value, ObjectFields &buf, size_t bufSize, uint8_t index, const String &name) -> typename std::enable_if<v_sring<T2>::value, T1>::type
     {
-        setObject(buf, bufSize, index, name, value, true, true);
+        setObject(buf, bufSize, index, name, value, true);
         return ret;
     }
 
     template <typename T1, typename T2>
-    auto set(T1 ret, const T2 &value, String *buf, size_t bufSize, uint8_t index, const String &name) -> typename std::enable_if<(!v_sring<T2>::value && !v_number<T2>::value && !std::is_same<T2, bool>::value), T1>::type
+    auto set(T1 ret, const T2 &value, ObjectFields &buf, size_t bufSize, uint8_t index, const String &name) -> typename std::enable_if<(!v_sring<T2>::value && !v_number<T2>::value && !std::is_same<T2, bool>::value), T1>::type
     {
-        setObject(buf, bufSize, index, name, value.c_str(), false, true);
+        setObject(buf, bufSize, index, name, value.c_str(), false);
         return ret;
     }
 
     template <typename T1, typename T2>
-    T1 append(T1 ret, bool value, String *buf, size_t bufSize, uint8_t index, const String &name)
+    T1 append(T1 ret, bool value, ObjectFields &buf, size_t bufSize, uint8_t index, const String &name)
     {
-        owriter.addMapArrayMember(buf, bufSize, index, name, owriter.getBoolStr(value), false);
+        addArrayMember(buf, bufSize, index, name, owriter.getBoolStr(value), false);
         return ret;
     }
 
     template <typename T1, typename T2>
-    auto append(T1 ret, const T2 &value, String *buf, size_t bufSize, uint8_t index, const String &name) -> typename std::enable_if<v_number<T2>::value, T1>::type
+    auto append(T1 ret, const T2 &value, ObjectFields &buf, size_t bufSize, uint8_t index, const String &name) -> typename std::enable_if<v_number<T2>::value, T1>::type
     {
-        owriter.addMapArrayMember(buf, bufSize, index, name, String(value), false);
+        addArrayMember(buf, bufSize, index, name, String(value), false);
         return ret;
     }
 
     template <typename T1, typename T2>
-    auto append(T1 ret, const T2 &value, String *buf, size_t bufSize, uint8_t index, const String &name) -> typename std::enable_if<v_sring<T2>::value, T1>::type
+    auto append(T1 ret, const T2 &value, ObjectFields &buf, size_t bufSize, uint8_t index, const String &name) -> typename std::enable_if<v_sring<T2>::value, T1>::type
     {
-        owriter.addMapArrayMember(buf, bufSize, index, name, value, true);
+        addArrayMember(buf, bufSize, index, name, value, true);
         return ret;
     }
 
     template <typename T1, typename T2>
-    auto append(T1 ret, const T2 &value, String *buf, size_t bufSize, uint8_t index, const String &name) -> typename std::enable_if<(!v_sring<T2>::value && !v_number<T2>::value && !std::is_same<T2, bool>::value), T1>::type
+    auto append(T1 ret, const T2 &value, ObjectFields &buf, size_t bufSize, uint8_t index, const String &name) -> typename std::enable_if<(!v_sring<T2>::value && !v_number<T2>::value && !std::is_same<T2, bool>::value), T1>::type
     {
-        owriter.addMapArrayMember(buf, bufSize, index, name, value.c_str(), false);
+        addArrayMember(buf, bufSize, index, name, value.c_str(), false);
         return ret;
     }
     void clear(String &buf) { buf.remove(0, buf.length()); }
-    void clear(String *buf, size_t bufSize) { owriter.clearBuf(buf, bufSize); }
 };
 
 class BaseO1 : public Printable
@@ -310,19 +487,15 @@ class BaseO2 : public Printable
 
 protected:
     static const size_t bufSize = 2;
-    String buf[bufSize];
+    ObjectFields buf;
     BufWriter wr;
 
 public:
     BaseO2() {}
-    const char *c_str() const { return buf[0].c_str(); }
-    size_t printTo(Print &p) const { return p.print(buf[0].c_str()); }
-    void clear() { wr.clear(buf, bufSize); }
-    void setContent(const String &content)
-    {
-        clear();
-        buf[0] = content;
-    }
+    const char *c_str() const { return buf.c_str(); }
+    size_t printTo(Print &p) const { return p.print(buf.c_str()); }
+    void clear() { buf.clear(); }
+    void setContent(const String &content) { buf.setContent(content); }
 };
 
 class BaseO4 : public Printable
@@ -330,19 +503,15 @@ class BaseO4 : public Printable
 
 protected:
     static const size_t bufSize = 4;
-    String buf[bufSize];
+    ObjectFields buf;
     BufWriter wr;
 
 public:
     BaseO4() {}
-    const char *c_str() const { return buf[0].c_str(); }
-    size_t printTo(Print &p) const { return p.print(buf[0].c_str()); }
-    void clear() { wr.clear(buf, bufSize); }
-    void setContent(const String &content)
-    {
-        clear();
-        buf[0] = content;
-    }
+    const char *c_str() const { return buf.c_str(); }
+    size_t printTo(Print &p) const { return p.print(buf.c_str()); }
+    void clear() { buf.clear(); }
+    void setContent(const String &content) { buf.setContent(content); }
 };
 
 class BaseO6 : public Printable
@@ -350,38 +519,30 @@ class BaseO6 : public Printable
 
 protected:
     static const size_t bufSize = 6;
-    String buf[bufSize];
+    ObjectFields buf;
     BufWriter wr;
 
 public:
     BaseO6() {}
-    const char *c_str() const { return buf[0].c_str(); }
-    size_t printTo(Print &p) const { return p.print(buf[0].c_str()); }
-    void clear() { wr.clear(buf, bufSize); }
-    void setContent(const String &content)
-    {
-        clear();
-        buf[0] = content;
-    }
+    const char *c_str() const { return buf.c_str(); }
+    size_t printTo(Print &p) const { return p.print(buf.c_str()); }
+    void clear() { buf.clear(); }
+    void setContent(const String &content) { buf.setContent(content); }
 };
 
 class BaseO8 : public Printable
 {
 protected:
     static const size_t bufSize = 8;
-    String buf[bufSize];
+    ObjectFields buf;
     BufWriter wr;
 
 public:
     BaseO8() {}
-    const char *c_str() const { return buf[0].c_str(); }
-    size_t printTo(Print &p) const { return p.print(buf[0].c_str()); }
-    void clear() { wr.clear(buf, bufSize); }
-    void setContent(const String &content)
-    {
-        clear();
-        buf[0] = content;
-    }
+    const char *c_str() const { return buf.c_str(); }
+    size_t printTo(Print &p) const { return p.print(buf.c_str()); }
+    void clear() { buf.clear(); }
+    void setContent(const String &content) { buf.setContent(content); }
 };
 
 class BaseO10 : public Printable
@@ -389,19 +550,15 @@ class BaseO10 : public Printable
 
 protected:
     static const size_t bufSize = 10;
-    String buf[bufSize];
+    ObjectFields buf;
     BufWriter wr;
 
 public:
     BaseO10() {}
-    const char *c_str() const { return buf[0].c_str(); }
-    size_t printTo(Print &p) const { return p.print(buf[0].c_str()); }
-    void clear() { wr.clear(buf, bufSize); }
-    void setContent(const String &content)
-    {
-        clear();
-        buf[0] = content;
-    }
+    const char *c_str() const { return buf.c_str(); }
+    size_t printTo(Print &p) const { return p.print(buf.c_str()); }
+    void clear() { buf.clear(); }
+    void setContent(const String &content) { buf.setContent(content); }
 };
 
 class BaseO12 : public Printable
@@ -409,57 +566,45 @@ class BaseO12 : public Printable
 
 protected:
     static const size_t bufSize = 12;
-    String buf[bufSize];
+    ObjectFields buf;
     BufWriter wr;
 
 public:
     BaseO12() {}
-    const char *c_str() const { return buf[0].c_str(); }
-    size_t printTo(Print &p) const { return p.print(buf[0].c_str()); }
-    void clear() { wr.clear(buf, bufSize); }
-    void setContent(const String &content)
-    {
-        clear();
-        buf[0] = content;
-    }
+    const char *c_str() const { return buf.c_str(); }
+    size_t printTo(Print &p) const { return p.print(buf.c_str()); }
+    void clear() { buf.clear(); }
+    void setContent(const String &content) { buf.setContent(content); }
 };
 
 class BaseO16 : public Printable
 {
 protected:
     static const size_t bufSize = 16;
-    String buf[bufSize];
+    ObjectFields buf;
     BufWriter wr;
 
 public:
     BaseO16() {}
-    const char *c_str() const { return buf[0].c_str(); }
-    size_t printTo(Print &p) const { return p.print(buf[0].c_str()); }
-    void clear() { wr.clear(buf, bufSize); }
-    void setContent(const String &content)
-    {
-        clear();
-        buf[0] = content;
-    }
+    const char *c_str() const { return buf.c_str(); }
+    size_t printTo(Print &p) const { return p.print(buf.c_str()); }
+    void clear() { buf.clear(); }
+    void setContent(const String &content) { buf.setContent(content); }
 };
 
 class BaseO26 : public Printable
 {
 protected:
     static const size_t bufSize = 26;
-    String buf[bufSize];
+    ObjectFields buf;
     BufWriter wr;
 
 public:
     BaseO26() {}
-    const char *c_str() const { return buf[0].c_str(); }
-    size_t printTo(Print &p) const { return p.print(buf[0].c_str()); }
-    void clear() { wr.clear(buf, bufSize); }
-    void setContent(const String &content)
-    {
-        clear();
-        buf[0] = content;
-    }
+    const char *c_str() const { return buf.c_str(); }
+    size_t printTo(Print &p) const { return p.print(buf.c_str()); }
+    void clear() { buf.clear(); }
+    void setContent(const String &content) { buf.setContent(content); }
 };
 
 namespace firebase
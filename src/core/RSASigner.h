@@ -0,0 +1,312 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_RSA_SIGNER_H
+#define CORE_RSA_SIGNER_H
+
+#include <Arduino.h>
+#include "./Config.h"
+#include "./core/Memory.h"
+
+#if defined(ENABLE_JWT)
+
+#if __has_include(<ESP_SSLClient.h>)
+#include <ESP_SSLClient.h>
+#else
+#include "./client/SSLClient/ESP_SSLClient.h"
+#endif
+
+// The time in ms of RSA private key operation that is performed in each call of RSASigner::step (JWTClass::loop).
+#if !defined(FIREBASE_RSA_SIGN_SLICE_MS)
+#define FIREBASE_RSA_SIGN_SLICE_MS 20
+#endif
+
+// The big integer (15-bit words) functions of BearSSL that are used by the RSA private key operation.
+extern "C"
+{
+    void br_i15_decode(uint16_t *x, const void *src, size_t len);
+    void br_i15_decode_reduce(uint16_t *x, const void *src, size_t len, const uint16_t *m);
+    void br_i15_encode(void *dst, size_t len, const uint16_t *x);
+    uint16_t br_i15_ninv15(uint16_t x);
+    void br_i15_montymul(uint16_t *d, const uint16_t *x, const uint16_t *y, const uint16_t *m, uint16_t m0i);
+    void br_i15_to_monty(uint16_t *x, const uint16_t *m);
+    void br_i15_from_monty(uint16_t *x, const uint16_t *m, uint16_t m0i);
+    void br_i15_reduce(uint16_t *x, const uint16_t *a, const uint16_t *m);
+    uint32_t br_i15_add(uint16_t *a, const uint16_t *b, uint32_t ctl);
+    uint32_t br_i15_sub(uint16_t *a, const uint16_t *b, uint32_t ctl);
+    void br_i15_mulacc(uint16_t *d, const uint16_t *a, const uint16_t *b);
+    void br_ccopy(uint32_t ctl, void *dst, const void *src, size_t len);
+}
+
+// The DER encoded DigestInfo prefix of SHA-256.
+static const uint8_t rsa_sha256_prefix[19] PROGMEM = {0x30, 0x31, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x01, 0x05, 0x00, 0x04, 0x20};
+
+// The RSA PKCS#1 v1.5 (SHA-256) signing that the private key operation is performed in time slices.
+// The CRT exponentiations (mod q then mod p) are done with the constant-time 4-bit fixed window in the
+// Montgomery domain as br_rsa_i15_private, the state is kept in heap between steps.
+class RSASigner
+{
+public:
+    RSASigner() {}
+    ~RSASigner() { clear(); }
+
+    // Start signing the SHA-256 hash, the key should be valid until the signing was finished or cleared.
+    bool begin(const br_rsa_private_key *sk, const uint8_t *hash)
+    {
+        clear();
+
+        const unsigned char *p = sk->p, *q = sk->q;
+        size_t plen = sk->plen, qlen = sk->qlen;
+        while (plen > 0 && *p == 0)
+            p++, plen--;
+        while (qlen > 0 && *q == 0)
+            q++, qlen--;
+
+        xlen = (sk->n_bitlen + 7) >> 3;
+        if (!plen || !qlen || xlen < sizeof(rsa_sha256_prefix) + br_sha256_SIZE + 11)
+            return false;
+
+        // The factor length in words (rounded up to even).
+        long z = (long)(plen > qlen ? plen : qlen) << 3;
+        fwlen = 1;
+        while (z > 0)
+        {
+            z -= 15;
+            fwlen++;
+        }
+        fwlen += (fwlen & 1);
+
+        mem_words = reinterpret_cast<uint16_t *>(mem.alloc((slot_max * fwlen + 1) * sizeof(uint16_t)));
+        out = reinterpret_cast<uint8_t *>(mem.alloc(xlen));
+        if (!mem_words || !out)
+        {
+            clear();
+            return false;
+        }
+
+        // The value words (after the bit length word) are 32-bit aligned.
+        words = reinterpret_cast<uintptr_t>(mem_words) & 2 ? mem_words : mem_words + 1;
+
+        // EMSA-PKCS1-v1_5 encoding 00 01 FF..FF 00 DigestInfo hash.
+        size_t pad = xlen - sizeof(rsa_sha256_prefix) - br_sha256_SIZE;
+        out[0] = 0x00;
+        out[1] = 0x01;
+        memset(out + 2, 0xFF, pad - 3);
+        out[pad - 1] = 0x00;
+        memcpy_P(out + pad, rsa_sha256_prefix, sizeof(rsa_sha256_prefix));
+        memcpy(out + pad + sizeof(rsa_sha256_prefix), hash, br_sha256_SIZE);
+
+        br_i15_decode(slot(slot_mq), q, qlen);
+        br_i15_decode(slot(slot_mp), p, plen);
+        q0i = br_i15_ninv15(slot(slot_mq)[1]);
+        p0i = br_i15_ninv15(slot(slot_mp)[1]);
+        // The even factors are invalid.
+        if (!(q0i & p0i & 1))
+        {
+            clear();
+            return false;
+        }
+
+        this->sk = sk;
+        phase = phase_mod_q;
+        powBegin();
+        return true;
+    }
+
+    // Perform the private key operation for FIREBASE_RSA_SIGN_SLICE_MS, it returns 1 when the signature is ready,
+    // 0 when it is in progress or -1 when failed.
+    int step()
+    {
+        if (phase == phase_done)
+            return 1;
+
+        if (phase == phase_idle)
+            return -1;
+
+        unsigned long ms = millis();
+        do
+        {
+            if (win < elen * 2)
+                powWindow();
+            else if (phase == phase_mod_q)
+            {
+                powEnd();
+                phase = phase_mod_p;
+                powBegin();
+            }
+            else
+            {
+                powEnd();
+                combine();
+                phase = phase_done;
+                return 1;
+            }
+        } while (millis() - ms < FIREBASE_RSA_SIGN_SLICE_MS);
+
+        return 0;
+    }
+
+    // The signature (modulus length) when step returns 1.
+    const uint8_t *signature() const { return phase == phase_done ? out : nullptr; }
+
+    size_t signatureLength() const { return xlen; }
+
+    bool busy() const { return phase == phase_mod_q || phase == phase_mod_p; }
+
+    void clear()
+    {
+        if (mem_words)
+        {
+            // The key material in the big integers.
+            memset(mem_words, 0, (slot_max * fwlen + 1) * sizeof(uint16_t));
+            mem.release(&mem_words);
+        }
+        mem.release(&out);
+        words = nullptr;
+        sk = nullptr;
+        phase = phase_idle;
+        win = 0;
+        elen = 0;
+    }
+
+private:
+    enum phase_t
+    {
+        phase_idle,
+        phase_mod_q,
+        phase_mod_p,
+        phase_done
+    };
+
+    // The big integers, s2 is followed by its extension for the (non-modular) CRT recombination.
+    enum slot_t
+    {
+        slot_mq,
+        slot_s2,
+        slot_s2_ext,
+        slot_mp,
+        slot_s1,
+        slot_acc,
+        slot_tmp,
+        slot_sel,
+        slot_table,
+        slot_max = slot_table + 16
+    };
+
+    Memory mem;
+    const br_rsa_private_key *sk = nullptr;
+    uint16_t *mem_words = nullptr, *words = nullptr;
+    uint8_t *out = nullptr;
+    size_t fwlen = 0, xlen = 0;
+    uint16_t q0i = 0, p0i = 0;
+    phase_t phase = phase_idle;
+    // The exponent and the index of its next 4-bit window.
+    const unsigned char *e = nullptr;
+    size_t elen = 0, win = 0;
+
+    uint16_t *slot(int index) { return words + index * fwlen; }
+
+    // The modulus of current exponentiation.
+    uint16_t *mod() { return slot(phase == phase_mod_q ? slot_mq : slot_mp); }
+
+    uint16_t mod0i() const { return phase == phase_mod_q ? q0i : p0i; }
+
+    size_t wordLen(const uint16_t *m) const { return ((m[0] + 15) >> 4) + 1; }
+
+    // Reduce the message and precompute its powers 0..15 in the Montgomery domain.
+    void powBegin()
+    {
+        uint16_t *m = mod();
+        size_t len = wordLen(m) * sizeof(uint16_t);
+        uint16_t *t0 = slot(slot_table), *t1 = slot(slot_table + 1);
+
+        memset(t0, 0, len);
+        t0[0] = m[0];
+        t0[1] = 1;
+        br_i15_to_monty(t0, m);
+
+        br_i15_decode_reduce(t1, out, xlen, m);
+        br_i15_to_monty(t1, m);
+
+        for (int i = 2; i < 16; i++)
+            br_i15_montymul(slot(slot_table + i), slot(slot_table + i - 1), t1, m, mod0i());
+
+        memcpy(slot(slot_acc), t0, len);
+
+        e = phase == phase_mod_q ? sk->dq : sk->dp;
+        elen = phase == phase_mod_q ? sk->dqlen : sk->dplen;
+        win = 0;
+    }
+
+    // Square the accumulator four times then multiply it with the power of window (selected in constant time).
+    void powWindow()
+    {
+        uint16_t *m = mod(), *acc = slot(slot_acc), *tmp = slot(slot_tmp), *sel = slot(slot_sel);
+        uint16_t m0i = mod0i();
+        size_t len = wordLen(m) * sizeof(uint16_t);
+        uint32_t w = e[win >> 1];
+        w = win & 1 ? w & 0x0F : w >> 4;
+
+        br_i15_montymul(tmp, acc, acc, m, m0i);
+        br_i15_montymul(acc, tmp, tmp, m, m0i);
+        br_i15_montymul(tmp, acc, acc, m, m0i);
+        br_i15_montymul(acc, tmp, tmp, m, m0i);
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            uint32_t q = i ^ w;
+            br_ccopy(1 - ((q | (0 - q)) >> 31), sel, slot(slot_table + i), len);
+        }
+
+        br_i15_montymul(tmp, acc, sel, m, m0i);
+        memcpy(acc, tmp, len);
+        win++;
+    }
+
+    void powEnd()
+    {
+        uint16_t *m = mod(), *acc = slot(slot_acc);
+        br_i15_from_monty(acc, m, mod0i());
+        memcpy(slot(phase == phase_mod_q ? slot_s2 : slot_s1), acc, wordLen(m) * sizeof(uint16_t));
+    }
+
+    // h = (s1 - s2) * (1 / q) mod p, s = s2 + q * h.
+    void combine()
+    {
+        uint16_t *mp = slot(slot_mp), *s1 = slot(slot_s1), *s2 = slot(slot_s2);
+        uint16_t *t1 = slot(slot_acc), *t2 = slot(slot_tmp);
+
+        br_i15_reduce(t2, s2, mp);
+        br_i15_add(s1, mp, br_i15_sub(s1, t2, 1));
+        br_i15_to_monty(s1, mp);
+        br_i15_decode_reduce(t1, sk->iq, sk->iqlen, mp);
+        br_i15_montymul(t2, s1, t1, mp, p0i);
+        br_i15_mulacc(s2, slot(slot_mq), t2);
+        br_i15_encode(out, xlen, s2);
+    }
+};
+
+#endif
+
+#endif
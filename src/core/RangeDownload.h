@@ -0,0 +1,327 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_RANGE_DOWNLOAD_H
+#define CORE_RANGE_DOWNLOAD_H
+
+#include <Arduino.h>
+#include <vector>
+#include "./Config.h"
+#include "./core/FileConfig.h"
+#include "./core/JsonParser.h"
+#include "./core/AsyncResult/AsyncResult.h"
+
+// The maximum number of ranges that are downloaded concurrently.
+#if !defined(FIREBASE_RANGE_DOWNLOAD_PARTS_LIMIT)
+#define FIREBASE_RANGE_DOWNLOAD_PARTS_LIMIT 4
+#endif
+
+// The range size in bytes of file download, the range that arrives before the preceding ranges were written
+// is kept in its reorder buffer then the memory of reorder buffers is limited to (parts - 1) * this size.
+#if !defined(FIREBASE_RANGE_DOWNLOAD_BUFFER_SIZE)
+#define FIREBASE_RANGE_DOWNLOAD_BUFFER_SIZE 8192
+#endif
+
+// The number of attempts of each range that was failed.
+#if !defined(FIREBASE_RANGE_DOWNLOAD_ATTEMPTS)
+#define FIREBASE_RANGE_DOWNLOAD_ATTEMPTS 3
+#endif
+
+// The download of object that is split into byte ranges and fetched concurrently by the connections in pool.
+// The blob is written at the offset of each range, the file is written in order via the reorder buffers.
+class RangeDownload
+{
+public:
+    enum range_download_step
+    {
+        range_download_step_size,
+        range_download_step_ranges,
+        range_download_step_done
+    };
+
+    // The payload sink of range request.
+    struct part_t : public Print
+    {
+    public:
+        RangeDownload *owner = nullptr;
+        // The range [start, end) and the next byte to receive.
+        size_t start = 0, end = 0, pos = 0, req_pos = 0;
+        // The reorder buffer of the range data that arrived before the preceding ranges were written.
+        std::vector<uint8_t> pending;
+        AsyncResult result;
+        bool busy = false;
+        uint8_t attempts = 0;
+
+        size_t write(uint8_t c) override { return write(&c, 1); }
+        size_t write(const uint8_t *buf, size_t size) override { return owner ? owner->receive(*this, buf, size) : 0; }
+    };
+
+    range_download_step step = range_download_step_size;
+    file_config_data file;
+    AsyncResult meta, result;
+    AsyncResultCallback cb = NULL;
+    // The object generation from metadata that the ranges can be pinned to.
+    String uid, generation;
+    std::vector<part_t *> parts;
+    size_t total = 0, next = 0, written = 0, range_size = 0;
+    uint8_t max_parts = 1;
+    bool file_opened = false;
+
+    RangeDownload(const file_config_data &file, uint8_t parts, AsyncResultCallback cb, const String &uid)
+    {
+        this->file.copy(file);
+        this->max_parts = parts == 0 ? 1 : parts > FIREBASE_RANGE_DOWNLOAD_PARTS_LIMIT ? FIREBASE_RANGE_DOWNLOAD_PARTS_LIMIT
+                                                                                         : parts;
+        this->cb = cb;
+        this->uid = uid;
+    }
+
+    ~RangeDownload()
+    {
+        closeFile();
+        for (size_t i = 0; i < parts.size(); i++)
+            delete parts[i];
+        parts.clear();
+    }
+
+    // Process the metadata and range results, returns false when the download was finished.
+    bool process()
+    {
+        if (step == range_download_step_done)
+        {
+            for (size_t i = 0; i < parts.size(); i++)
+            {
+                if (parts[i]->result.data_available || parts[i]->result.error_available)
+                    parts[i]->busy = false;
+            }
+            return false;
+        }
+
+        if (step == range_download_step_size)
+        {
+            if (!meta.data_available && !meta.error_available)
+                return true;
+
+            if (meta.error_available)
+                return finish(meta.lastError.code(), meta.lastError.message());
+
+            String size;
+            JsonPullParser::get(meta.c_str(), "size", size);
+            total = atoll(size.c_str());
+            JsonPullParser::get(meta.c_str(), "generation", generation);
+            meta.clear();
+
+            if (total == 0)
+                return finish(0, "");
+
+            if (isBlob() && file.data_size < total)
+                return finish(FIREBASE_ERROR_FILE_WRITE, FPSTR("blob size is too small"));
+
+            if (!isBlob() && !openFile())
+                return finish(FIREBASE_ERROR_OPEN_FILE, FPSTR("file open error"));
+
+            // The blob ranges are not reordered, the object is split equally.
+            range_size = isBlob() ? (total + max_parts - 1) / max_parts : FIREBASE_RANGE_DOWNLOAD_BUFFER_SIZE;
+            for (uint8_t i = 0; i < max_parts; i++)
+            {
+                part_t *p = new part_t();
+                p->owner = this;
+                parts.push_back(p);
+            }
+            step = range_download_step_ranges;
+        }
+
+        bool idle = true;
+        for (size_t i = 0; i < parts.size(); i++)
+        {
+            part_t *p = parts[i];
+            if (p->busy && (p->result.data_available || p->result.error_available))
+            {
+                p->busy = false;
+                if (p->result.error_available || p->pos == p->req_pos)
+                {
+                    int code = p->result.error_available ? p->result.lastError.code() : FIREBASE_ERROR_SERVER_RESPONSE;
+                    // Only the range that was not reached or the service was unavailable is requested again,
+                    // the server that responds the full object instead of the range is not retried.
+                    bool retry = (code < 0 && code != FIREBASE_ERROR_RANGE_NOT_SUPPORTED) || code == FIREBASE_ERROR_HTTP_CODE_TOO_MANY_REQUESTS || code >= FIREBASE_ERROR_HTTP_CODE_INTERNAL_SERVER_ERROR;
+                    if (!retry || ++p->attempts >= FIREBASE_RANGE_DOWNLOAD_ATTEMPTS)
+                        return finish(code, p->result.error_available ? p->result.lastError.message() : String(FPSTR("range download failed")));
+                }
+            }
+
+            if (p->pending.size() && written == p->pos - p->pending.size() && !flush(*p))
+                return finish(FIREBASE_ERROR_FILE_WRITE, FPSTR("file write error"));
+
+            // The empty part takes the next range.
+            if (!p->busy && p->pos >= p->end && p->pending.size() == 0 && next < total)
+            {
+                p->start = next;
+                p->pos = next;
+                p->end = next + range_size < total ? next + range_size : total;
+                p->attempts = 0;
+                next = p->end;
+            }
+
+            if (p->busy || p->pos < p->end || p->pending.size())
+                idle = false;
+        }
+
+        if (result.download_data.downloaded != written)
+        {
+            result.download_data.total = total;
+            result.download_data.downloaded = written;
+            if (result.setDownloadProgress() && cb && written < total)
+            {
+                result.setUID(uid);
+                cb(result);
+            }
+        }
+
+        if (idle && next >= total)
+            return finish(0, "");
+
+        return true;
+    }
+
+    // The part that waits for its range request.
+    part_t *nextRequest()
+    {
+        for (size_t i = 0; step == range_download_step_ranges && i < parts.size(); i++)
+        {
+            part_t *p = parts[i];
+            if (!p->busy && p->pos < p->end)
+            {
+                p->busy = true;
+                p->req_pos = p->pos;
+                p->result.clear();
+                p->result.error_available = false;
+                return p;
+            }
+        }
+        return nullptr;
+    }
+
+    // The range requests are in progress, the task is not deleted until they were finished.
+    bool busy() const
+    {
+        for (size_t i = 0; i < parts.size(); i++)
+        {
+            if (parts[i]->busy)
+                return true;
+        }
+        return false;
+    }
+
+private:
+    bool isBlob() const { return file.data && file.data_size; }
+
+    size_t receive(part_t &p, const uint8_t *buf, size_t size)
+    {
+        size_t n = p.pos + size > p.end ? p.end - p.pos : size;
+        if (n == 0)
+            return 0;
+
+        if (isBlob())
+        {
+            memcpy(file.data + p.pos, buf, n);
+            written += n;
+        }
+        else if (p.pending.size() == 0 && written == p.pos)
+        {
+            // The range in order is written through.
+            if (writeFile(buf, n) < n)
+                return 0;
+            written += n;
+        }
+        else
+        {
+            if (p.pending.size() == 0)
+                p.pending.reserve(p.end - p.pos);
+            p.pending.insert(p.pending.end(), buf, buf + n);
+        }
+        p.pos += n;
+        return n;
+    }
+
+    bool flush(part_t &p)
+    {
+        size_t len = p.pending.size();
+        if (writeFile(p.pending.data(), len) < len)
+            return false;
+        written += len;
+        p.pending.clear();
+        return true;
+    }
+
+    bool openFile()
+    {
+#if defined(ENABLE_FS)
+        if (file.cb && file.filename.length())
+        {
+            file.cb(file.file, file.filename.c_str(), file_mode_open_write);
+            file_opened = file.file ? true : false;
+        }
+#endif
+        return file_opened;
+    }
+
+    size_t writeFile(const uint8_t *buf, size_t len)
+    {
+#if defined(ENABLE_FS)
+        if (file_opened)
+            return file.file.write(buf, len);
+#endif
+        return 0;
+    }
+
+    void closeFile()
+    {
+#if defined(ENABLE_FS)
+        if (file_opened)
+            file.file.close();
+#endif
+        file_opened = false;
+    }
+
+    bool finish(int code, const String &message)
+    {
+        // The data of range requests in progress are discarded.
+        for (size_t i = 0; i < parts.size(); i++)
+            parts[i]->owner = nullptr;
+        closeFile();
+        step = range_download_step_done;
+        result.download_data.total = total;
+        result.download_data.downloaded = written;
+        result.setDownloadProgress();
+        result.error_available = code != 0;
+        result.data_available = code == 0;
+        result.lastError.setLastError(code, message);
+        result.setUID(uid);
+        if (cb)
+            cb(result);
+        return false;
+    }
+};
+
+#endif
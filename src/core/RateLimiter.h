@@ -0,0 +1,221 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_RATE_LIMITER_H
+#define CORE_RATE_LIMITER_H
+
+#include <Arduino.h>
+#include "./Config.h"
+#include "./core/Error.h"
+#include "./core/FNV.h"
+
+// The maximum number of hosts that their request rates are limited.
+#if !defined(FIREBASE_RATE_LIMIT_HOSTS)
+#define FIREBASE_RATE_LIMIT_HOSTS 4
+#endif
+
+// The initial rate in requests per minute of the host that was limited from the HTTP 429 error.
+#if !defined(FIREBASE_RATE_LIMIT_LEARN_RATE)
+#define FIREBASE_RATE_LIMIT_LEARN_RATE 60
+#endif
+
+/**
+ * The token bucket of request rate of each host.
+ *
+ * The rate is decreased by a quarter and the requests are paused for the Retry-After time (or one request interval)
+ * when the host responds with HTTP 429 error, and it is increased by an eighth after each minute without the error
+ * up to the rate that was set, then the requests are sent just under the quota of service.
+ */
+class RateLimiter
+{
+public:
+    RateLimiter() {}
+
+    // Set the rate in requests per minute and the burst of host, the zero rate removes the limit.
+    void set(const char *host, uint16_t perMinute, uint16_t burst)
+    {
+        uint32_t k = key(host);
+        bucket_t *b = find(k);
+        if (perMinute == 0)
+        {
+            if (b)
+            {
+                *b = bucket_t();
+                used--;
+            }
+            return;
+        }
+
+        if (!b)
+            b = alloc(k);
+        if (!b)
+            return;
+        b->max_rate = perMinute;
+        b->rate = perMinute;
+        b->burst = burst > 0 ? burst : 1;
+        b->tokens = (uint32_t)b->burst * unit;
+        b->refill_ms = millis();
+    }
+
+    // Enable the limit of host that responded with HTTP 429 error, it is enabled by default.
+    void setLearning(bool enable) { learning = enable; }
+
+    bool active() const { return used > 0; }
+
+    // Take the token of request to host, returns false when the request should wait.
+    bool acquire(uint32_t k)
+    {
+        bucket_t *b = find(k);
+        if (!b)
+            return true;
+
+        if (b->block_ms > 0)
+        {
+            if (millis() - b->blocked_ms < b->block_ms)
+                return false;
+            // The first request is sent when the pause was ended.
+            b->block_ms = 0;
+            b->refill_ms = millis();
+            b->tokens = unit;
+        }
+
+        refill(*b);
+        if (b->tokens < unit)
+            return false;
+        b->tokens -= unit;
+        return true;
+    }
+
+    // Update the rate of host from the HTTP status and the Retry-After seconds of response.
+    void observe(uint32_t k, int code, uint32_t retryAfter)
+    {
+        bucket_t *b = find(k);
+        if (code == FIREBASE_ERROR_HTTP_CODE_TOO_MANY_REQUESTS)
+        {
+            if (!b && learning && (b = alloc(k)) != nullptr)
+            {
+                b->rate = FIREBASE_RATE_LIMIT_LEARN_RATE;
+                b->burst = 1;
+            }
+            else if (b)
+                b->rate = b->rate > 4 ? b->rate - b->rate / 4 : 1;
+
+            if (!b)
+                return;
+            b->tokens = 0;
+            b->blocked_ms = millis();
+            b->block_ms = retryAfter > 0 ? retryAfter * 1000 : 60000UL / b->rate;
+            b->probe_ms = millis();
+            return;
+        }
+
+        if (!b || code <= 0 || code >= 400 || millis() - b->probe_ms < 60000UL)
+            return;
+
+        b->probe_ms = millis();
+        uint32_t rate = b->rate + (b->rate / 8 > 0 ? b->rate / 8 : 1);
+        uint32_t max = b->max_rate > 0 ? b->max_rate : 0xffff;
+        b->rate = rate < max ? rate : max;
+    }
+
+    // The rate of host in requests per minute, 0 when it is not limited.
+    uint16_t rate(const char *host)
+    {
+        bucket_t *b = find(key(host));
+        return b ? b->rate : 0;
+    }
+
+    void clear()
+    {
+        for (int i = 0; i < FIREBASE_RATE_LIMIT_HOSTS; i++)
+            buckets[i] = bucket_t();
+        used = 0;
+    }
+
+    // The FNV-1a hash of host name, zero is the empty bucket.
+    static uint32_t key(const char *host)
+    {
+        return FNV1a::key(FNV1a::hashString(host, true));
+    }
+
+private:
+    // The tokens are counted in 1/60000 of request, the bucket gains the rate units in every ms.
+    static const uint32_t unit = 60000UL;
+
+    struct bucket_t
+    {
+        uint32_t key = 0;
+        // The current and the maximum (0 for no maximum) rates in requests per minute.
+        uint16_t rate = 0, max_rate = 0, burst = 1;
+        uint32_t tokens = 0;
+        unsigned long refill_ms = 0, blocked_ms = 0, block_ms = 0, probe_ms = 0;
+    };
+
+    bucket_t buckets[FIREBASE_RATE_LIMIT_HOSTS];
+    uint8_t used = 0;
+    bool learning = true;
+
+    bucket_t *find(uint32_t k)
+    {
+        for (int i = 0; i < FIREBASE_RATE_LIMIT_HOSTS && used > 0; i++)
+        {
+            if (buckets[i].key == k)
+                return &buckets[i];
+        }
+        return nullptr;
+    }
+
+    bucket_t *alloc(uint32_t k)
+    {
+        for (int i = 0; i < FIREBASE_RATE_LIMIT_HOSTS; i++)
+        {
+            if (buckets[i].key == 0)
+            {
+                buckets[i] = bucket_t();
+                buckets[i].key = k;
+                buckets[i].refill_ms = millis();
+                used++;
+                return &buckets[i];
+            }
+        }
+        return nullptr;
+    }
+
+    void refill(bucket_t &b)
+    {
+        uint32_t cap = (uint32_t)b.burst * unit;
+        unsigned long elapsed = millis() - b.refill_ms;
+        b.refill_ms = millis();
+        if (b.tokens >= cap)
+            return;
+        // The elapsed time is limited to avoid the overflow, the bucket is full after it.
+        if (elapsed > cap / b.rate + 1)
+            elapsed = cap / b.rate + 1;
+        b.tokens += elapsed * b.rate;
+        if (b.tokens > cap)
+            b.tokens = cap;
+    }
+};
+
+#endif
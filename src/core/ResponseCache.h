@@ -0,0 +1,364 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_RESPONSE_CACHE_H
+#define CORE_RESPONSE_CACHE_H
+
+#include <Arduino.h>
+#include <vector>
+#include "./core/FNV.h"
+#include "./core/FileConfig.h"
+
+// The default maximum bytes of cached response payloads.
+#if !defined(FIREBASE_RESPONSE_CACHE_SIZE)
+#define FIREBASE_RESPONSE_CACHE_SIZE 4096
+#endif
+
+// The ETag and the payload of GET responses that keyed by the request URL, the least recently used entry is evicted first.
+class ResponseCache
+{
+private:
+    struct cache_entry_t
+    {
+    public:
+        uint32_t key = 0;
+        // The full key of entry that was stored by name, it is compared after the hash.
+        String name;
+        String etag;
+        // The payload is kept in file when the file is assigned.
+        String body;
+        size_t size = 0;
+        uint32_t used = 0;
+        uint16_t id = 0;
+    };
+
+    std::vector<cache_entry_t> entries;
+    size_t limit = 0, usage = 0;
+    uint32_t tick = 0;
+#if defined(ENABLE_FS)
+    file_config_data file;
+#endif
+
+    int find(uint32_t key) const
+    {
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            if (entries[i].key == key)
+                return i;
+        }
+        return -1;
+    }
+
+    int find(const String &name) const
+    {
+        uint32_t key = hash(name);
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            if (entries[i].key == key && entries[i].name == name)
+                return i;
+        }
+        return -1;
+    }
+
+    size_t oldest() const
+    {
+        size_t index = 0;
+        for (size_t i = 1; i < entries.size(); i++)
+        {
+            if (entries[i].used < entries[index].used)
+                index = i;
+        }
+        return index;
+    }
+
+    bool hasFile() const
+    {
+#if defined(ENABLE_FS)
+        return file.cb && file.filename.length();
+#else
+        return false;
+#endif
+    }
+
+#if defined(ENABLE_FS)
+    String bodyFile(uint16_t id) const { return file.filename + String(id); }
+
+    uint16_t freeId() const
+    {
+        for (uint16_t id = 0;; id++)
+        {
+            bool used = false;
+            for (size_t i = 0; i < entries.size() && !used; i++)
+                used = entries[i].id == id;
+            if (!used)
+                return id;
+        }
+    }
+
+    // Rewrite the index file, the file is removed when the cache is empty.
+    void saveIndex()
+    {
+        if (entries.size() == 0)
+        {
+            file.cb(file.file, file.filename.c_str(), file_mode_remove);
+            return;
+        }
+
+        file.cb(file.file, file.filename.c_str(), file_mode_open_write);
+        if (!file.file)
+            return;
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            file.file.print(entries[i].key);
+            file.file.print('\t');
+            file.file.print(entries[i].id);
+            file.file.print('\t');
+            file.file.print(entries[i].size);
+            file.file.print('\t');
+            file.file.print(entries[i].etag);
+            if (entries[i].name.length())
+            {
+                file.file.print('\t');
+                file.file.print(entries[i].name);
+            }
+            file.file.print('\n');
+        }
+        file.file.close();
+    }
+
+    void loadIndex()
+    {
+        file.cb(file.file, file.filename.c_str(), file_mode_open_read);
+        if (!file.file)
+            return;
+
+        String line;
+        while (file.file.available())
+        {
+            int c = file.file.read();
+            if (c < 0)
+                break;
+            if (c != '\n')
+            {
+                line += (char)c;
+                continue;
+            }
+            int p1 = line.indexOf('\t'), p2 = line.indexOf('\t', p1 + 1), p3 = line.indexOf('\t', p2 + 1);
+            if (p1 > 0 && p2 > p1 && p3 > p2)
+            {
+                int p4 = line.indexOf('\t', p3 + 1);
+                cache_entry_t e;
+                e.key = strtoul(line.substring(0, p1).c_str(), nullptr, 10);
+                e.id = atoi(line.substring(p1 + 1, p2).c_str());
+                e.size = atoi(line.substring(p2 + 1, p3).c_str());
+                e.etag = p4 > p3 ? line.substring(p3 + 1, p4) : line.substring(p3 + 1);
+                if (p4 > p3)
+                    e.name = line.substring(p4 + 1);
+                usage += e.size;
+                entries.push_back(e);
+            }
+            line.remove(0, line.length());
+        }
+        file.file.close();
+    }
+#endif
+
+    void erase(size_t index)
+    {
+#if defined(ENABLE_FS)
+        if (hasFile())
+            file.cb(file.file, bodyFile(entries[index].id).c_str(), file_mode_remove);
+#endif
+        usage -= entries[index].size;
+        entries.erase(entries.begin() + index);
+    }
+
+public:
+    ResponseCache() {}
+
+    static uint32_t hash(const char *buf, size_t len)
+    {
+        // The zero key is not used.
+        return FNV1a::key(FNV1a::hash(buf, len));
+    }
+
+    static uint32_t hash(const String &url) { return hash(url.c_str(), url.length()); }
+
+    // Set the maximum bytes of cached payloads, the cache is disabled when it is zero.
+    void setLimit(size_t size)
+    {
+        limit = size;
+        if (limit == 0)
+            clear();
+        while (usage > limit && entries.size())
+            removeAt(oldest());
+    }
+
+    bool isEnabled() const { return limit > 0; }
+
+#if defined(ENABLE_FS)
+    // Keep the payloads in files, the file name is used as the index file and the prefix of payload files.
+    void setFile(const file_config_data &file)
+    {
+        entries.clear();
+        usage = 0;
+        this->file.copy(file);
+        if (hasFile())
+            loadIndex();
+        setLimit(limit);
+    }
+#endif
+
+    // The bytes of cached payloads (in memory or in files).
+    size_t usedBytes() const { return usage; }
+
+    // Returns the ETag of cached response or empty string.
+    String etag(uint32_t key) const { return etagAt(find(key)); }
+
+    // Returns the ETag of response that was stored by its full key or empty string.
+    String etag(const String &name) const { return etagAt(find(name)); }
+
+    // Copy the cached payload, returns false if it is not cached.
+    bool get(uint32_t key, String &body) { return getAt(find(key), body); }
+
+    // Copy the payload that was stored by its full key, returns false if it is not cached.
+    bool get(const String &name, String &body) { return getAt(find(name), body); }
+
+    // Store the payload with its ETag, the payload that is larger than limit is not stored.
+    void put(uint32_t key, const String &etag, const String &body) { putAt(find(key), key, String(), etag, body); }
+
+    // Store the payload with its ETag by its full key, the entries of the same hash and other key are kept.
+    void put(const String &name, const String &etag, const String &body) { putAt(find(name), hash(name), name, etag, body); }
+
+    void remove(uint32_t key) { removeAt(find(key)); }
+
+    void remove(const String &name) { removeAt(find(name)); }
+
+    void clear()
+    {
+        for (size_t i = entries.size(); i > 0; i--)
+            erase(i - 1);
+#if defined(ENABLE_FS)
+        if (hasFile())
+            saveIndex();
+#endif
+        tick = 0;
+    }
+
+private:
+    String etagAt(int index) const { return index > -1 ? entries[index].etag : String(); }
+
+    bool getAt(int index, String &body)
+    {
+        if (index == -1)
+            return false;
+
+        cache_entry_t &e = entries[index];
+        e.used = ++tick;
+        if (!hasFile())
+        {
+            body = e.body;
+            return true;
+        }
+
+#if defined(ENABLE_FS)
+        file.cb(file.file, bodyFile(e.id).c_str(), file_mode_open_read);
+        if (!file.file)
+        {
+            erase(index);
+            saveIndex();
+            return false;
+        }
+        body.remove(0, body.length());
+        body.reserve(e.size);
+        while (file.file.available() && body.length() < e.size)
+        {
+            int c = file.file.read();
+            if (c < 0)
+                break;
+            body += (char)c;
+        }
+        file.file.close();
+#endif
+        return true;
+    }
+
+    void putAt(int index, uint32_t key, const String &name, const String &etag, const String &body)
+    {
+        if (index > -1)
+            erase(index);
+
+        if (!isEnabled() || etag.length() == 0 || body.length() > limit)
+        {
+#if defined(ENABLE_FS)
+            if (index > -1 && hasFile())
+                saveIndex();
+#endif
+            return;
+        }
+
+        while (usage + body.length() > limit && entries.size())
+            erase(oldest());
+
+        cache_entry_t e;
+        e.key = key;
+        e.name = name;
+        e.etag = etag;
+        e.size = body.length();
+        e.used = ++tick;
+#if defined(ENABLE_FS)
+        if (hasFile())
+        {
+            e.id = freeId();
+            file.cb(file.file, bodyFile(e.id).c_str(), file_mode_open_write);
+            if (!file.file)
+                return;
+            file.file.print(body);
+            file.file.close();
+        }
+        else
+#endif
+            e.body = body;
+
+        usage += e.size;
+        entries.push_back(e);
+#if defined(ENABLE_FS)
+        if (hasFile())
+            saveIndex();
+#endif
+    }
+
+    void removeAt(int index)
+    {
+        if (index == -1)
+            return;
+        erase(index);
+#if defined(ENABLE_FS)
+        if (hasFile())
+            saveIndex();
+#endif
+    }
+};
+
+#endif
@@ -0,0 +1,166 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_SSE_PARSER_H
+#define CORE_SSE_PARSER_H
+
+#include <Arduino.h>
+#include "./core/Scan.h"
+#include "./core/JsonParser.h"
+
+enum sse_event_type
+{
+    sse_event_undefined,
+    sse_event_put,
+    sse_event_patch,
+    sse_event_keep_alive,
+    sse_event_cancel,
+    sse_event_auth_revoked,
+    sse_event_other
+};
+
+// The incremental text/event-stream parser that works in place over the event buffer.
+// Only the lines that were not parsed are scanned, the event is complete at the blank line.
+class SSEParser
+{
+private:
+    size_t pos = 0;
+    json_span_t ev, dt;
+    sse_event_type ev_type = sse_event_undefined;
+
+    bool nameIs(const char *buf, size_t start, size_t end, const char *name) const { return end - start == strlen(name) && strncmp(buf + start, name, end - start) == 0; }
+
+    sse_event_type getType(const char *buf) const
+    {
+        static const char *names[] = {"put", "patch", "keep-alive", "cancel", "auth_revoked"};
+        for (uint8_t i = 0; i < 5; i++)
+        {
+            if (nameIs(buf, ev.start, ev.end, names[i]))
+                return (sse_event_type)(sse_event_put + i);
+        }
+        return sse_event_other;
+    }
+
+    // Append the next data line to the data field, the lines are joined with '\n' in place.
+    void appendData(String &buf, size_t start, size_t &end, size_t &line_end)
+    {
+        if (!dt.valid())
+        {
+            dt.start = start;
+            dt.end = end;
+            return;
+        }
+
+        // The field lines are expected in order of event and data.
+        if (ev.valid() && ev.start > dt.end)
+            return;
+
+        size_t n = start - dt.end - 1;
+        buf.setCharAt(dt.end, '\n');
+        buf.remove(dt.end + 1, n);
+        end -= n;
+        line_end -= n;
+        dt.end = end;
+    }
+
+public:
+    void reset()
+    {
+        pos = 0;
+        ev = json_span_t();
+        dt = json_span_t();
+        ev_type = sse_event_undefined;
+    }
+
+    /**
+     * Parse the complete lines of event buffer that were not parsed yet.
+     *
+     * @param buf The event buffer.
+     * @return boolean The event is complete, its spans are valid until consume() is called.
+     */
+    bool parse(String &buf)
+    {
+        if (pos > buf.length())
+            reset();
+
+        while (pos < buf.length())
+        {
+            size_t line_end = pos + Scan::findByte(buf.c_str() + pos, buf.length() - pos, '\n');
+            if (line_end == buf.length())
+                return false;
+
+            size_t end = line_end > pos && buf[line_end - 1] == '\r' ? line_end - 1 : line_end;
+
+            if (end == pos)
+            {
+                pos = line_end + 1;
+                if (ev.valid() || dt.valid())
+                    return true;
+                // The blank line between events.
+                buf.remove(0, pos);
+                reset();
+                continue;
+            }
+
+            size_t colon = pos + Scan::findByte(buf.c_str() + pos, end - pos, ':');
+            // The line that starts with colon is the comment.
+            if (colon > pos)
+            {
+                size_t start = colon < end ? colon + 1 : end;
+                if (start < end && buf[start] == ' ')
+                    start++;
+
+                if (nameIs(buf.c_str(), pos, colon, "event"))
+                {
+                    ev.start = start;
+                    ev.end = end;
+                    ev_type = getType(buf.c_str());
+                }
+                else if (nameIs(buf.c_str(), pos, colon, "data"))
+                    appendData(buf, start, end, line_end);
+            }
+            pos = line_end + 1;
+        }
+        return false;
+    }
+
+    // Remove the complete event from the event buffer and start the next event.
+    void consume(String &buf)
+    {
+        buf.remove(0, pos);
+        reset();
+    }
+
+    // The length of complete event in the event buffer.
+    size_t end() const { return pos; }
+
+    json_span_t event() const { return ev; }
+
+    // The data of multi-line data field is joined with '\n'.
+    json_span_t data() const { return dt; }
+
+    sse_event_type type() const { return ev_type; }
+};
+
+#endif
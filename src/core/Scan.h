@@ -0,0 +1,190 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_SCAN_H
+#define CORE_SCAN_H
+
+#include <Arduino.h>
+
+// The delimiter search that tests 4 bytes per step, the buffer should be in RAM.
+class Scan
+{
+private:
+    static const uint32_t ones = 0x01010101UL;
+    static const uint32_t highs = 0x80808080UL;
+
+    // The high bit of each zero byte is set.
+    static uint32_t zeros(uint32_t w) { return (w - ones) & ~w & highs; }
+
+    static uint32_t load(const uint8_t *p)
+    {
+        uint32_t w;
+        memcpy(&w, p, 4);
+        return w;
+    }
+
+    template <typename M>
+    static size_t scan(const uint8_t *buf, size_t len, M match, uint32_t (*test)(uint32_t, const uint32_t *), const uint32_t *patterns)
+    {
+        size_t i = 0;
+        // The unaligned head.
+        while (i < len && ((uintptr_t)(buf + i) & 3))
+        {
+            if (match(buf[i]))
+                return i;
+            i++;
+        }
+
+        for (; i + 4 <= len; i += 4)
+        {
+            if (test(load(buf + i), patterns))
+            {
+                for (size_t j = 0; j < 4; j++)
+                {
+                    if (match(buf[i + j]))
+                        return i + j;
+                }
+            }
+        }
+
+        for (; i < len; i++)
+        {
+            if (match(buf[i]))
+                return i;
+        }
+        return len;
+    }
+
+    static uint32_t testOne(uint32_t w, const uint32_t *p) { return zeros(w ^ p[0]); }
+
+    static uint32_t testAny(uint32_t w, const uint32_t *p)
+    {
+        uint32_t r = 0;
+        for (uint8_t i = 0; i < 4 && p[i]; i++)
+            r |= zeros(w ^ p[i]);
+        return r;
+    }
+
+public:
+    /**
+     * Find the byte in buffer.
+     *
+     * @param buf The buffer.
+     * @param len The length of buffer.
+     * @param c The byte to find.
+     * @return size_t The position of byte or len if not found.
+     */
+    static size_t findByte(const uint8_t *buf, size_t len, uint8_t c)
+    {
+        uint32_t pattern = ones * c;
+        return scan(
+            buf, len, [c](uint8_t b)
+            { return b == c; },
+            testOne, &pattern);
+    }
+
+    static size_t findByte(const char *buf, size_t len, char c) { return findByte((const uint8_t *)buf, len, (uint8_t)c); }
+
+    /**
+     * Find any byte of set (up to 4 non-zero bytes) in buffer.
+     *
+     * @param buf The buffer.
+     * @param len The length of buffer.
+     * @param set The bytes to find e.g. "\"\\".
+     * @return size_t The position of byte or len if not found.
+     */
+    static size_t findAny(const char *buf, size_t len, const char *set)
+    {
+        uint32_t patterns[4] = {0, 0, 0, 0};
+        uint8_t n = 0;
+        while (n < 4 && set[n])
+        {
+            patterns[n] = ones * (uint8_t)set[n];
+            n++;
+        }
+
+        return scan(
+            (const uint8_t *)buf, len, [set, n](uint8_t b)
+            {
+                for (uint8_t i = 0; i < n; i++)
+                {
+                    if (b == (uint8_t)set[i])
+                        return true;
+                }
+                return false; },
+            testAny, patterns);
+    }
+
+    /**
+     * Find the text in buffer.
+     *
+     * @param buf The buffer.
+     * @param len The length of buffer.
+     * @param text The text to find.
+     * @param textLen The length of text.
+     * @return size_t The position of text or len if not found.
+     */
+    static size_t find(const char *buf, size_t len, const char *text, size_t textLen)
+    {
+        if (textLen == 0)
+            return 0;
+
+        size_t i = 0;
+        while (i + textLen <= len)
+        {
+            size_t p = findByte(buf + i, len - i, text[0]);
+            if (p == len - i || i + p + textLen > len)
+                break;
+            i += p;
+            if (memcmp(buf + i, text, textLen) == 0)
+                return i;
+            i++;
+        }
+        return len;
+    }
+
+    static size_t find(const char *buf, size_t len, const char *text) { return find(buf, len, text, strlen(text)); }
+
+    // Find the "\r\n" in buffer, returns its position or len if not found.
+    static size_t findCRLF(const char *buf, size_t len) { return find(buf, len, "\r\n", 2); }
+
+    // The String.indexOf that uses the word search, returns -1 if not found.
+    static int indexOf(const String &str, const char *text, size_t from = 0)
+    {
+        if (from >= str.length())
+            return -1;
+        size_t p = find(str.c_str() + from, str.length() - from, text);
+        return p == str.length() - from ? -1 : (int)(from + p);
+    }
+
+    static int indexOf(const String &str, char c, size_t from = 0)
+    {
+        if (from >= str.length())
+            return -1;
+        size_t p = findByte(str.c_str() + from, str.length() - from, c);
+        return p == str.length() - from ? -1 : (int)(from + p);
+    }
+};
+
+#endif
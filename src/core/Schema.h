@@ -0,0 +1,219 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_SCHEMA_H
+#define CORE_SCHEMA_H
+
+#include <Arduino.h>
+#include "./core/Number.h"
+#include "./core/JsonEscape.h"
+#include "./core/JsonParser.h"
+
+/**
+ * The field schema of user struct, it is declared with FIREBASE_JSON_SCHEMA at global scope e.g.
+ *
+ * struct Reading
+ * {
+ *     uint32_t ts;
+ *     float value;
+ *     String state;
+ * };
+ *
+ * FIREBASE_JSON_SCHEMA(Reading, FIREBASE_JSON_FIELD(ts) FIREBASE_JSON_FIELD(value) FIREBASE_JSON_FIELD(state))
+ *
+ * The field type can be bool, integer, float, double, String and the struct that has its schema.
+ */
+template <typename T>
+struct json_schema
+{
+    static const bool value = false;
+};
+
+#define FIREBASE_JSON_FIELD(name) v.field(#name, o.name);
+
+#define FIREBASE_JSON_SCHEMA(type, fields)   \
+    template <>                              \
+    struct json_schema<type>                 \
+    {                                        \
+        static const bool value = true;      \
+        template <typename V, typename O>    \
+        static void visit(V &v, O &o)        \
+        {                                    \
+            fields                           \
+        }                                    \
+    };
+
+// Serialize the struct to JSON object directly.
+class JsonSchemaWriter
+{
+private:
+    String *buf = nullptr;
+    bool first = true;
+
+    JsonSchemaWriter(String &buf) : buf(&buf) {}
+
+    void value(bool v) { *buf += v ? FPSTR("true") : FPSTR("false"); }
+
+    template <typename T>
+    auto value(const T &v) -> typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, void>::type
+    {
+        char tmp[FIREBASE_NUMBER_BUF_SIZE];
+        NumberUtil::format(v, tmp);
+        *buf += tmp;
+    }
+
+    template <typename T>
+    auto value(const T &v) -> typename std::enable_if<std::is_floating_point<T>::value, void>::type
+    {
+        char tmp[FIREBASE_NUMBER_BUF_SIZE];
+        NumberUtil::format(v, -1, tmp);
+        *buf += tmp;
+    }
+
+    void value(const char *v)
+    {
+        *buf += '"';
+        if (v)
+            JsonEscape::append(*buf, v, strlen(v));
+        *buf += '"';
+    }
+
+    void value(const String &v) { value(v.c_str()); }
+
+    template <typename T>
+    auto value(const T &v) -> typename std::enable_if<json_schema<T>::value, void>::type { write(*buf, v); }
+
+public:
+    template <typename T>
+    static auto write(String &buf, const T &o) -> typename std::enable_if<json_schema<T>::value, void>::type
+    {
+        JsonSchemaWriter w(buf);
+        buf += '{';
+        json_schema<T>::visit(w, o);
+        buf += '}';
+    }
+
+    template <typename T>
+    void field(const char *name, const T &v)
+    {
+        if (!first)
+            *buf += ',';
+        first = false;
+        *buf += '"';
+        *buf += name;
+        *buf += '"';
+        *buf += ':';
+        value(v);
+    }
+};
+
+// Parse the JSON object to struct in place, the object members that are not in schema are ignored.
+class JsonSchemaReader
+{
+private:
+    const char *buf = nullptr;
+    json_span_t key, val;
+    bool done = false;
+
+    JsonSchemaReader(const char *buf, const json_span_t &key, const json_span_t &val) : buf(buf), key(key), val(val) {}
+
+    void parse(bool &v) { v = val.length() && buf[val.start] == 't'; }
+
+    template <typename T>
+    auto parse(T &v) -> typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, void>::type
+    {
+        bool neg = false;
+        uint64_t u = 0;
+        double d = 0;
+        json_span_t s = val.unquote(buf);
+        NumberUtil::parse(buf + s.start, s.length(), neg, u, d);
+        if (std::is_floating_point<T>::value)
+            v = (T)d;
+        else
+            v = neg ? (T)(~u + 1) : (T)u;
+    }
+
+    void parse(String &v)
+    {
+        json_span_t s = val.unquote(buf);
+        v.remove(0, v.length());
+        v.reserve(s.length());
+        for (int i = s.start; i < s.end; i++)
+        {
+            if (buf[i] == '\\' && i + 1 < s.end)
+            {
+                i++;
+                v += buf[i] == 'n' ? '\n' : buf[i] == 't' ? '\t'
+                                        : buf[i] == 'r'   ? '\r'
+                                                          : buf[i];
+            }
+            else
+                v += buf[i];
+        }
+    }
+
+    template <typename T>
+    auto parse(T &v) -> typename std::enable_if<json_schema<T>::value, void>::type { read(buf + val.start, val.length(), v); }
+
+public:
+    /**
+     * Parse the JSON object to struct.
+     *
+     * @param buf The JSON buffer e.g. the response payload.
+     * @param len The length of JSON.
+     * @param o The struct that has its schema.
+     * @return boolean The JSON is the object.
+     */
+    template <typename T>
+    static auto read(const char *buf, size_t len, T &o) -> typename std::enable_if<json_schema<T>::value, bool>::type
+    {
+        JsonPullParser parser(buf, len);
+        if (parser.next() != json_token_object_begin)
+            return false;
+
+        uint8_t level = parser.depth();
+        while (parser.next() == json_token_key && parser.depth() == level)
+        {
+            json_span_t key = parser.span();
+            parser.next();
+            json_span_t val = parser.skipValue();
+            if (!val.valid())
+                return false;
+            JsonSchemaReader r(buf, key, val);
+            json_schema<T>::visit(r, o);
+        }
+        return true;
+    }
+
+    template <typename T>
+    void field(const char *name, T &v)
+    {
+        if (done || key.length() != strlen(name) || strncmp(buf + key.start, name, key.length()) != 0)
+            return;
+        done = true;
+        parse(v);
+    }
+};
+
+#endif
@@ -0,0 +1,534 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_SOCKET_CLIENT_H
+#define CORE_SOCKET_CLIENT_H
+
+#include <Arduino.h>
+#include <Client.h>
+
+#if defined(ESP32) && __has_include(<lwip/sockets.h>)
+#include <lwip/sockets.h>
+#include <lwip/netdb.h>
+#include <lwip/dns.h>
+#include <lwip/tcpip.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <atomic>
+#define FIREBASE_SOCKET_CLIENT
+#define FIREBASE_SOCKET_CLIENT_ASYNC_DNS
+#elif !defined(ARDUINO) && __has_include(<sys/socket.h>)
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#define FIREBASE_SOCKET_CLIENT
+#endif
+
+#if defined(FIREBASE_SOCKET_CLIENT)
+
+// The size of receive buffer of SocketClient, the reads that are larger than buffer are received directly.
+#if !defined(FIREBASE_SOCKET_RX_BUFFER_SIZE)
+#define FIREBASE_SOCKET_RX_BUFFER_SIZE 1460
+#endif
+
+// The size of socket send and receive buffers that are requested from the TCP stack, 0 for the stack default.
+#if !defined(FIREBASE_SOCKET_BUFFER_SIZE)
+#define FIREBASE_SOCKET_BUFFER_SIZE 8192
+#endif
+
+/**
+ * The network client that uses the non-blocking BSD sockets of lwIP (ESP32) directly instead of WiFiClient.
+ *
+ * The data are received in bulk into the receive buffer or directly to the buffer of large reads, the readiness
+ * is checked with select and the request can be written with scatter/gather write. It can be used as the
+ * basic client of ESP_SSLClient.
+ *
+ * The connectStart and connectPoll functions resolve the host with the lwIP DNS callback and connect without
+ * waiting, they are used by the async client with setNonBlockingHandshake.
+ */
+class SocketClient : public Client
+{
+public:
+    SocketClient() {}
+
+    ~SocketClient()
+    {
+        stop();
+        abandonQuery();
+    }
+
+    // Set the connect and write timeouts in ms.
+    void setTimeouts(uint32_t connectMs, uint32_t writeMs)
+    {
+        connect_timeout_ms = connectMs;
+        write_timeout_ms = writeMs;
+    }
+
+    int connect(IPAddress ip, uint16_t port) override
+    {
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(((uint32_t)ip[0] << 24) | ((uint32_t)ip[1] << 16) | ((uint32_t)ip[2] << 8) | ip[3]);
+        return connectAddr(reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr));
+    }
+
+    int connect(const char *host, uint16_t port) override
+    {
+        struct addrinfo hints, *res = nullptr;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+
+        char service[6];
+        snprintf(service, sizeof(service), "%u", port);
+        if (getaddrinfo(host, service, &hints, &res) != 0 || !res)
+            return 0;
+
+        int ret = connectAddr(res->ai_addr, res->ai_addrlen);
+        freeaddrinfo(res);
+        return ret;
+    }
+
+    /**
+     * Start to resolve the host and connect to server without waiting.
+     *
+     * The host is resolved with the lwIP DNS callback on ESP32, the host system resolver is used otherwise.
+     *
+     * @param host The host name or IP address.
+     * @param port The port.
+     * @return int 1 when it was started and should be polled with connectPoll, 0 when it failed.
+     */
+    int connectStart(const char *host, uint16_t port)
+    {
+        stop();
+        abandonQuery();
+        conn_port = port;
+        conn_ms = millis();
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        if (inet_aton(host, &addr.sin_addr))
+            return beginConnect(reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0 ? 0 : 1;
+
+#if defined(FIREBASE_SOCKET_CLIENT_ASYNC_DNS)
+        query = new dns_query_t();
+        ip_addr_t ip;
+        err_t err;
+#if defined(LOCK_TCPIP_CORE)
+        LOCK_TCPIP_CORE();
+#endif
+        err = dns_gethostbyname(host, &ip, dnsFound, query);
+#if defined(LOCK_TCPIP_CORE)
+        UNLOCK_TCPIP_CORE();
+#endif
+        if (err == ERR_INPROGRESS)
+            return 1;
+
+        delete query;
+        query = nullptr;
+        if (err != ERR_OK)
+            return 0;
+        addr.sin_addr.s_addr = ip4_addr_get_u32(ip_2_ip4(&ip));
+        return beginConnect(reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0 ? 0 : 1;
+#else
+        struct addrinfo hints, *res = nullptr;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+
+        char service[6];
+        snprintf(service, sizeof(service), "%u", port);
+        if (getaddrinfo(host, service, &hints, &res) != 0 || !res)
+            return 0;
+
+        int ret = beginConnect(res->ai_addr, res->ai_addrlen);
+        freeaddrinfo(res);
+        return ret < 0 ? 0 : 1;
+#endif
+    }
+
+    /**
+     * Advance the connection that was started by connectStart.
+     *
+     * @return int 1 when it was connected, 0 when it is in progress, -1 when it failed or timed out.
+     */
+    int connectPoll()
+    {
+        bool timeout = millis() - conn_ms > connect_timeout_ms;
+
+#if defined(FIREBASE_SOCKET_CLIENT_ASYNC_DNS)
+        if (query)
+        {
+            uint8_t state = query->state.load();
+            if (state == dns_query_t::pending)
+            {
+                if (!timeout)
+                    return 0;
+                abandonQuery();
+                return -1;
+            }
+
+            struct sockaddr_in addr;
+            memset(&addr, 0, sizeof(addr));
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(conn_port);
+            addr.sin_addr.s_addr = query->addr;
+            delete query;
+            query = nullptr;
+            if (state != dns_query_t::found || beginConnect(reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0)
+                return -1;
+        }
+#endif
+
+        if (fd < 0)
+            return -1;
+
+        if (!connecting)
+            return 1;
+
+        int err = 0;
+        socklen_t errLen = sizeof(err);
+        if (!waitFor(false, 0))
+        {
+            if (!timeout)
+                return 0;
+        }
+        else if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errLen) == 0 && err == 0)
+        {
+            connecting = false;
+            return 1;
+        }
+
+        closeSocket();
+        return -1;
+    }
+
+    size_t write(uint8_t b) override { return write(&b, 1); }
+
+    size_t write(const uint8_t *buf, size_t size) override
+    {
+        struct iovec iov;
+        iov.iov_base = const_cast<uint8_t *>(buf);
+        iov.iov_len = size;
+        return write(&iov, 1);
+    }
+
+    /**
+     * Write the buffers in order with the minimum numbers of socket calls.
+     *
+     * @param iov The buffers to write, the array is modified while it is written.
+     * @param count The numbers of buffers.
+     * @return size_t The numbers of bytes that were written.
+     */
+    size_t write(struct iovec *iov, int count)
+    {
+        size_t sent = 0;
+        unsigned long ms = millis();
+        while (fd > -1 && count > 0)
+        {
+            ssize_t ret = writev(fd, iov, count);
+            if (ret < 0)
+            {
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                {
+                    closeSocket();
+                    break;
+                }
+                // The send buffer is full, wait until it has space.
+                if (millis() - ms > write_timeout_ms || !waitFor(false, write_timeout_ms))
+                    break;
+                continue;
+            }
+
+            sent += ret;
+            // Skip the buffers that were written.
+            while (count > 0 && (size_t)ret >= iov->iov_len)
+            {
+                ret -= iov->iov_len;
+                iov++;
+                count--;
+            }
+            if (count > 0)
+            {
+                iov->iov_base = static_cast<uint8_t *>(iov->iov_base) + ret;
+                iov->iov_len -= ret;
+            }
+        }
+        return sent;
+    }
+
+    int available() override
+    {
+        int avail = rx_len - rx_pos;
+        if (fd > -1)
+        {
+            int pending = 0;
+            if (ioctl(fd, FIONREAD, &pending) == 0 && pending > 0)
+                avail += pending;
+        }
+        return avail;
+    }
+
+    int read() override
+    {
+        if (rx_pos == rx_len && fill() <= 0)
+            return -1;
+        return rx_buf[rx_pos++];
+    }
+
+    int read(uint8_t *buf, size_t size) override
+    {
+        size_t n = 0;
+        if (rx_pos < rx_len)
+        {
+            n = rx_len - rx_pos < size ? rx_len - rx_pos : size;
+            memcpy(buf, rx_buf + rx_pos, n);
+            rx_pos += n;
+        }
+
+        // The remaining of large read is received to the destination without copy.
+        if (n < size && fd > -1)
+        {
+            if (size - n >= sizeof(rx_buf))
+            {
+                ssize_t ret = recvData(buf + n, size - n);
+                if (ret > 0)
+                    n += ret;
+            }
+            else if (fill() > 0)
+                return n + read(buf + n, size - n);
+        }
+        return n > 0 ? (int)n : -1;
+    }
+
+    int peek() override
+    {
+        if (rx_pos == rx_len && fill() <= 0)
+            return -1;
+        return rx_buf[rx_pos];
+    }
+
+    void flush() override {}
+
+    void stop() override
+    {
+        closeSocket();
+        rx_pos = 0;
+        rx_len = 0;
+    }
+
+    uint8_t connected() override { return (fd > -1 && !connecting) || rx_pos < rx_len; }
+
+    operator bool() override { return connected(); }
+
+    // The numbers of received data in receive buffer, the buffer is filled when it is empty.
+    size_t peekAvailable()
+    {
+        if (rx_pos == rx_len)
+            fill();
+        return rx_len - rx_pos;
+    }
+
+    const char *peekBuffer() { return reinterpret_cast<const char *>(rx_buf + rx_pos); }
+
+    void peekConsume(size_t consume) { rx_pos += consume < rx_len - rx_pos ? consume : rx_len - rx_pos; }
+
+    // Hold the written data in the TCP stack until uncork (TCP_CORK) or send them without delay when the stack has no cork option.
+    void cork() { setCork(true); }
+
+    void uncork() { setCork(false); }
+
+    /**
+     * Wait until the data are available to read or the timeout.
+     *
+     * @param timeoutMs The timeout in ms.
+     * @return boolean The data are available or the connection was closed.
+     */
+    bool waitReadable(uint32_t timeoutMs) { return rx_pos < rx_len || (fd > -1 && waitFor(true, timeoutMs)); }
+
+    // The socket descriptor e.g. to wait for the readiness of several sockets, -1 when it is not connected.
+    int socketFd() const { return fd; }
+
+private:
+    int fd = -1;
+    uint8_t rx_buf[FIREBASE_SOCKET_RX_BUFFER_SIZE];
+    size_t rx_pos = 0, rx_len = 0;
+    uint32_t connect_timeout_ms = 10000, write_timeout_ms = 10000;
+    // The connection that was started by connectStart is in progress.
+    bool connecting = false;
+    uint16_t conn_port = 0;
+    unsigned long conn_ms = 0;
+
+#if defined(FIREBASE_SOCKET_CLIENT_ASYNC_DNS)
+    // The DNS query that is shared with the lwIP callback, it is deleted by whichever side finishes last.
+    struct dns_query_t
+    {
+        enum : uint8_t
+        {
+            pending,
+            found,
+            failed,
+            abandoned
+        };
+        std::atomic<uint8_t> state{pending};
+        uint32_t addr = 0;
+    };
+    dns_query_t *query = nullptr;
+
+    static void dnsFound(const char *, const ip_addr_t *ip, void *arg)
+    {
+        dns_query_t *q = static_cast<dns_query_t *>(arg);
+        if (ip)
+            q->addr = ip4_addr_get_u32(ip_2_ip4(ip));
+        if (q->state.exchange(ip ? dns_query_t::found : dns_query_t::failed) == dns_query_t::abandoned)
+            delete q;
+    }
+#endif
+
+    // Release the DNS query that is in progress, the callback that comes later deletes it.
+    void abandonQuery()
+    {
+#if defined(FIREBASE_SOCKET_CLIENT_ASYNC_DNS)
+        if (query && query->state.exchange(dns_query_t::abandoned) != dns_query_t::pending)
+            delete query;
+        query = nullptr;
+#endif
+    }
+
+    int connectAddr(const struct sockaddr *addr, socklen_t len)
+    {
+        stop();
+        int ret = beginConnect(addr, len);
+        if (ret < 0)
+            return 0;
+
+        int err = 0;
+        socklen_t errLen = sizeof(err);
+        if (ret == 0 && (!waitFor(false, connect_timeout_ms) || getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errLen) != 0 || err != 0))
+        {
+            closeSocket();
+            return 0;
+        }
+        connecting = false;
+        return 1;
+    }
+
+    // Create the non-blocking socket and start to connect, 1 when it was connected, 0 when it is in progress, -1 when it failed.
+    int beginConnect(const struct sockaddr *addr, socklen_t len)
+    {
+        fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (fd < 0)
+            return -1;
+
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#if FIREBASE_SOCKET_BUFFER_SIZE > 0
+        int size = FIREBASE_SOCKET_BUFFER_SIZE;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+#endif
+
+        if (::connect(fd, addr, len) == 0)
+            return 1;
+
+        if (errno != EINPROGRESS)
+        {
+            closeSocket();
+            return -1;
+        }
+        connecting = true;
+        return 0;
+    }
+
+    // Wait for the socket to be readable (read is true) or writable.
+    bool waitFor(bool read, uint32_t timeoutMs)
+    {
+        fd_set set;
+        FD_ZERO(&set);
+        FD_SET(fd, &set);
+        struct timeval tv;
+        tv.tv_sec = timeoutMs / 1000;
+        tv.tv_usec = (timeoutMs % 1000) * 1000;
+        return select(fd + 1, read ? &set : nullptr, read ? nullptr : &set, nullptr, &tv) > 0;
+    }
+
+    ssize_t recvData(uint8_t *buf, size_t size)
+    {
+        ssize_t ret = recv(fd, buf, size, MSG_DONTWAIT);
+        // The connection was closed by server or failed.
+        if (ret == 0 || (ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+            closeSocket();
+        return ret;
+    }
+
+    int fill()
+    {
+        rx_pos = 0;
+        rx_len = 0;
+        if (fd < 0)
+            return -1;
+        ssize_t ret = recvData(rx_buf, sizeof(rx_buf));
+        if (ret > 0)
+            rx_len = ret;
+        return ret;
+    }
+
+    void setCork(bool cork)
+    {
+        if (fd < 0)
+            return;
+#if defined(TCP_CORK)
+        int val = cork;
+        setsockopt(fd, IPPROTO_TCP, TCP_CORK, &val, sizeof(val));
+#else
+        int val = !cork;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &val, sizeof(val));
+#endif
+    }
+
+    void closeSocket()
+    {
+        if (fd > -1)
+            close(fd);
+        fd = -1;
+        connecting = false;
+    }
+};
+
+#endif
+
+#endif
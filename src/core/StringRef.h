@@ -0,0 +1,86 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_STRING_REF_H
+#define CORE_STRING_REF_H
+
+#include <Arduino.h>
+
+// The reference of C string, flash string or String that is passed to the functions without copy, the string
+// should be valid until the function returned. The string is copied when it was assigned to the String e.g. of slot
+// that its buffer is reused.
+class StringRef
+{
+private:
+    const char *ptr = "";
+    size_t len = 0;
+    bool flash = false;
+
+public:
+    StringRef() {}
+    StringRef(const char *s) : ptr(s ? s : ""), len(s ? strlen(s) : 0) {}
+    StringRef(const String &s) : ptr(s.c_str()), len(s.length()) {}
+    StringRef(const __FlashStringHelper *s) : ptr(s ? (const char *)s : ""), len(s ? strlen_P((const char *)s) : 0), flash(s != nullptr) {}
+
+    size_t length() const { return len; }
+
+    char operator[](size_t index) const { return index < len ? (flash ? (char)pgm_read_byte(ptr + index) : ptr[index]) : 0; }
+
+    // Append the string to the String.
+    void appendTo(String &out) const
+    {
+        if (flash)
+            out += reinterpret_cast<const __FlashStringHelper *>(ptr);
+        else
+            out.concat(ptr, len);
+    }
+
+    // Replace the content of String, its buffer is reused when it is large enough.
+    void assignTo(String &out) const
+    {
+        out.remove(0, out.length());
+        appendTo(out);
+    }
+
+    String toString() const
+    {
+        String out;
+        appendTo(out);
+        return out;
+    }
+
+    bool equals(const String &s) const
+    {
+        if (s.length() != len)
+            return false;
+        for (size_t i = 0; i < len; i++)
+        {
+            if ((*this)[i] != s[i])
+                return false;
+        }
+        return true;
+    }
+};
+
+#endif
@@ -28,6 +28,7 @@
 #include <Arduino.h>
 #include <Client.h>
 #include "./Config.h"
+#include "./core/Scan.h"
 
 #if defined(ARDUINO_UNOWIFIR4) || defined(ARDUINO_MINIMA) || defined(ARDUINO_PORTENTA_C33)
 #define FIREBASE_STRSEP strsepImpl
@@ -63,10 +64,10 @@ public:
 
     void parse(const String &str, const String &name, const String &delim, int &p1, int &p2)
     {
-        p1 = str.indexOf(name, p1);
+        p1 = p1 < 0 ? -1 : Scan::indexOf(str, name.c_str(), p1);
         if (p1 > -1)
         {
-            p2 = str.indexOf(':', p1);
+            p2 = Scan::indexOf(str, ':', p1);
             if (p1 > -1 && str.substring(p1, p2) == name)
             {
                 p1 = p2 + 1;
@@ -75,7 +76,7 @@ public:
                     p1++;
                 }
 
-                p2 = str.indexOf(delim, p2);
+                p2 = Scan::indexOf(str, delim.c_str(), p2);
                 if (p2 == -1)
                     p2 = str.length() - 1;
 
@@ -97,22 +98,6 @@ public:
     }
 
     void addSp(String &buf) { buf += ' '; }
-
-    String u64Str(uint64_t val)
-    {
-        // Some cores do not provide 64-bit integer to string conversion.
-        String v;
-        char buffer[21];
-        char *ndx = &buffer[sizeof(buffer) - 1];
-        *ndx = '\0';
-        do
-        {
-            *--ndx = val % 10 + '0';
-            val = val / 10;
-        } while (val != 0);
-        v = ndx;
-        return v;
-    }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,320 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_TLS_SESSION_CACHE_H
+#define CORE_TLS_SESSION_CACHE_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include "./Config.h"
+#include "./core/Memory.h"
+#include "./core/FNV.h"
+#include "./core/AsyncClient/RequestHandler.h"
+
+// The maximum number of hosts that their TLS sessions are kept.
+#if !defined(FIREBASE_TLS_SESSION_CACHE_SIZE)
+#define FIREBASE_TLS_SESSION_CACHE_SIZE 4
+#endif
+
+// The maximum fragment length (512, 1024, 2048 or 4096) that is negotiated for sizing the TLS buffers.
+#if !defined(FIREBASE_TLS_MAX_FRAGMENT_LENGTH)
+#define FIREBASE_TLS_MAX_FRAGMENT_LENGTH 4096
+#endif
+
+// The callback that assigns the session object (e.g. BearSSL_Session) to the SSL client before connecting.
+typedef void (*TLSSessionSetter)(Client *client, void *session);
+
+// The callback that constructs the session object in its buffer.
+typedef void (*TLSSessionInit)(void *session);
+
+// The callback that sets the TLS buffer sizes of the SSL client for the fragment length before connecting,
+// the fragment length of host is probed when len is zero, it returns the fragment length that was set.
+typedef uint16_t (*TLSBufferSizer)(Client *client, const char *host, uint16_t port, uint16_t len);
+
+// The least recently used cache of TLS session parameters and the negotiated fragment lengths, the entries are keyed by host and port.
+// The SSL client keeps the pointer to session object that was assigned, reads it for resuming the session and
+// updates it after handshake. The session object is plain data (its default value is zero), it can be exported
+// and imported e.g. for keeping in RTC memory during deep sleep.
+class TLSSessionCache
+{
+public:
+    TLSSessionCache() {}
+    ~TLSSessionCache() { clear(); }
+
+    // Assign the SSL client that its sessions are cached, the session size is the size of its session object.
+    bool addClient(Client *client, size_t session_size, TLSSessionSetter setter, TLSSessionInit init = nullptr)
+    {
+        if (!client || !setter || !session_size || (size && size != session_size))
+            return false;
+
+        client_t *c = find(client);
+        if (!c && client_count >= FIREBASE_ASYNC_CONNECTION_POOL_LIMIT)
+            return false;
+
+        if (!size)
+            this->init = init;
+
+        if (!allocate(session_size))
+            return false;
+
+        if (!c)
+        {
+            c = &clients[client_count++];
+            c->client = client;
+        }
+        c->setter = setter;
+        return true;
+    }
+
+    // Assign the SSL client that its buffer sizes are set for the fragment length of host.
+    bool addSizer(Client *client, TLSBufferSizer sizer)
+    {
+        if (!client || !sizer)
+            return false;
+
+        client_t *c = find(client);
+        if (!c)
+        {
+            if (client_count >= FIREBASE_ASYNC_CONNECTION_POOL_LIMIT)
+                return false;
+            c = &clients[client_count++];
+            c->client = client;
+        }
+        c->sizer = sizer;
+        return true;
+    }
+
+    // Assign the session and buffer sizes of host and port to the client before connecting, returns the entry index or -1.
+    int select(Client *client, const char *host, uint16_t port)
+    {
+        client_t *c = find(client);
+        if (!c)
+            return -1;
+
+        uint32_t k = key(host, port);
+        int index = 0;
+        for (int i = 0; i < FIREBASE_TLS_SESSION_CACHE_SIZE; i++)
+        {
+            if (entries[i].key == k)
+            {
+                index = i;
+                break;
+            }
+            // The least recently used entry is replaced.
+            if (entries[i].used < entries[index].used)
+                index = i;
+        }
+
+        last_hit = entries[index].key == k && c->setter;
+        if (entries[index].key != k)
+        {
+            initSession(entries[index].data);
+            entries[index].key = k;
+            entries[index].frag_len = 0;
+        }
+        entries[index].used = ++counter;
+
+        if (c->setter && entries[index].data)
+            c->setter(client, entries[index].data);
+
+        // The fragment length is probed once per host.
+        if (c->sizer)
+            entries[index].frag_len = c->sizer(client, host, port, entries[index].frag_len);
+
+        return index;
+    }
+
+    // The handshake of the session was failed, the session parameters and fragment length are cleared.
+    void invalidate(int index)
+    {
+        if (index < 0 || index >= FIREBASE_TLS_SESSION_CACHE_SIZE)
+            return;
+        initSession(entries[index].data);
+        entries[index].frag_len = 0;
+    }
+
+    // Returns the fragment length of entry that was probed by the buffer sizer, 0 when it is not known.
+    uint16_t fragLength(int index) const { return index < 0 || index >= FIREBASE_TLS_SESSION_CACHE_SIZE ? 0 : entries[index].frag_len; }
+
+    // Returns true if the session of last selected host and port was set to the client for resumption.
+    bool lastHit() const { return last_hit; }
+
+    // The size of exported data.
+    size_t exportSize() const { return client_count ? sizeof(uint32_t) + FIREBASE_TLS_SESSION_CACHE_SIZE * (entry_header + size) : 0; }
+
+    // Copy the entries to buf, returns the exported size or zero when buf is too small.
+    size_t exportTo(uint8_t *buf, size_t len) const
+    {
+        if (!client_count || len < exportSize())
+            return 0;
+
+        uint8_t *p = buf;
+        uint32_t sz = size;
+        memcpy(p, &sz, sizeof(sz));
+        p += sizeof(sz);
+        for (int i = 0; i < FIREBASE_TLS_SESSION_CACHE_SIZE; i++)
+        {
+            memcpy(p, &entries[i].key, sizeof(uint32_t));
+            memcpy(p + sizeof(uint32_t), &entries[i].used, sizeof(uint32_t));
+            memcpy(p + 2 * sizeof(uint32_t), &entries[i].frag_len, sizeof(uint16_t));
+            if (size)
+                memcpy(p + entry_header, entries[i].data, size);
+            p += entry_header + size;
+        }
+        return p - buf;
+    }
+
+    // Restore the entries that were exported, the data of other session size are ignored.
+    bool importFrom(const uint8_t *buf, size_t len)
+    {
+        uint32_t sz = 0;
+        if (!client_count || len < exportSize())
+            return false;
+
+        memcpy(&sz, buf, sizeof(sz));
+        if (sz != size)
+            return false;
+
+        const uint8_t *p = buf + sizeof(sz);
+        for (int i = 0; i < FIREBASE_TLS_SESSION_CACHE_SIZE; i++)
+        {
+            memcpy(&entries[i].key, p, sizeof(uint32_t));
+            memcpy(&entries[i].used, p + sizeof(uint32_t), sizeof(uint32_t));
+            memcpy(&entries[i].frag_len, p + 2 * sizeof(uint32_t), sizeof(uint16_t));
+            if (size)
+                memcpy(entries[i].data, p + entry_header, size);
+            if (entries[i].used > counter)
+                counter = entries[i].used;
+            p += entry_header + size;
+        }
+        return true;
+    }
+
+    // Clear all sessions, the clients are kept.
+    void reset()
+    {
+        for (int i = 0; i < FIREBASE_TLS_SESSION_CACHE_SIZE; i++)
+        {
+            initSession(entries[i].data);
+            entries[i].key = 0;
+            entries[i].used = 0;
+            entries[i].frag_len = 0;
+        }
+    }
+
+    void clear()
+    {
+        Memory mem;
+        for (int i = 0; i < FIREBASE_TLS_SESSION_CACHE_SIZE; i++)
+        {
+            mem.release(&entries[i].data);
+            entries[i].key = 0;
+            entries[i].used = 0;
+            entries[i].frag_len = 0;
+        }
+        client_count = 0;
+        size = 0;
+        init = nullptr;
+    }
+
+private:
+    struct entry_t
+    {
+        uint32_t key = 0, used = 0;
+        // The negotiated fragment length or 16384 when it was not supported, zero when it was not probed.
+        uint16_t frag_len = 0;
+        uint8_t *data = nullptr;
+    };
+
+    struct client_t
+    {
+        Client *client = nullptr;
+        TLSSessionSetter setter = nullptr;
+        TLSBufferSizer sizer = nullptr;
+    };
+
+    // The key, used and frag_len of exported entry.
+    static const size_t entry_header = 2 * sizeof(uint32_t) + sizeof(uint16_t);
+
+    entry_t entries[FIREBASE_TLS_SESSION_CACHE_SIZE];
+    client_t clients[FIREBASE_ASYNC_CONNECTION_POOL_LIMIT];
+    uint8_t client_count = 0;
+    size_t size = 0;
+    TLSSessionInit init = nullptr;
+    uint32_t counter = 0;
+    bool last_hit = false;
+
+    bool allocate(size_t session_size)
+    {
+        if (size)
+            return true;
+
+        Memory mem;
+        for (int i = 0; i < FIREBASE_TLS_SESSION_CACHE_SIZE; i++)
+        {
+            entries[i].data = reinterpret_cast<uint8_t *>(mem.alloc(session_size));
+            if (!entries[i].data)
+            {
+                for (int j = 0; j < i; j++)
+                    mem.release(&entries[j].data);
+                return false;
+            }
+        }
+        size = session_size;
+        for (int i = 0; i < FIREBASE_TLS_SESSION_CACHE_SIZE; i++)
+            initSession(entries[i].data);
+        return true;
+    }
+
+    // The session object is constructed in its zero filled buffer, the buffer is used as is when there is no constructor.
+    void initSession(uint8_t *data)
+    {
+        if (!data || !size)
+            return;
+        memset(data, 0, size);
+        if (init)
+            init(data);
+    }
+
+    client_t *find(Client *client)
+    {
+        for (uint8_t i = 0; i < client_count; i++)
+        {
+            if (clients[i].client == client)
+                return &clients[i];
+        }
+        return nullptr;
+    }
+
+    // The FNV-1a hash of host and port.
+    static uint32_t key(const char *host, uint16_t port)
+    {
+        uint32_t h = FNV1a::hashString(host);
+        h = FNV1a::add(h, port & 0xff);
+        h = FNV1a::add(h, port >> 8);
+        return FNV1a::key(h);
+    }
+};
+
+#endif
@@ -27,33 +27,247 @@
 
 #include <Arduino.h>
 #include "./Config.h"
+#include "./core/Lock.h"
 
+// The seconds that the wall clock is advanced by millis before it was synced from the time status callback again.
+#if !defined(FIREBASE_TIME_RESYNC_SEC)
+#define FIREBASE_TIME_RESYNC_SEC 21600
+#endif
+
+// The number of slot bits of each level of timer wheel, the 4 levels of 32 slots (1 ms, 32 ms, 1 s and 33 s) cover
+// about 17 minutes, the longer timer is cascaded from the last level again until it was expired.
+#if !defined(FIREBASE_TIMER_WHEEL_BITS)
+#define FIREBASE_TIMER_WHEEL_BITS 5
+#endif
+
+#define FIREBASE_TIMER_WHEEL_LEVELS 4
+
+// The hierarchical timer wheel of ms resolution that the running timers are registered with.
+// The timers are expired when the wheel was advanced to the current time, the empty levels are skipped.
+class TimerWheel
+{
+public:
+    struct node_t
+    {
+        uint32_t deadline = 0;
+        node_t *prev = nullptr, *next = nullptr;
+        uint8_t level = 0, slot = 0;
+        bool linked = false, expired = false;
+    };
+
+    // The wheel that shared by all timers, it is never destroyed then the timers of static objects can be
+    // removed from it in any order of static destruction.
+    static TimerWheel &shared()
+    {
+        static TimerWheel *wheel = new TimerWheel();
+        return *wheel;
+    }
+
+    // Add or move the node that is expired when the deadline (ms) was reached.
+    void add(node_t *node, uint32_t deadline)
+    {
+        AsyncLockGuard guard(lock);
+        unlink(node);
+        advanceTo(millis());
+        node->deadline = deadline;
+        node->expired = false;
+        place(node);
+    }
+
+    void remove(node_t *node)
+    {
+        AsyncLockGuard guard(lock);
+        unlink(node);
+    }
+
+    // Expire the nodes that their deadlines were reached.
+    void advance()
+    {
+        AsyncLockGuard guard(lock);
+        advanceTo(millis());
+    }
+
+    // Get the time in ms to the nearest deadline, 0xFFFFFFFF when no timer is running.
+    uint32_t nextDeadline()
+    {
+        AsyncLockGuard guard(lock);
+        advanceTo(millis());
+        uint32_t next = 0xFFFFFFFF;
+        for (uint8_t level = 0; level < FIREBASE_TIMER_WHEEL_LEVELS; level++)
+        {
+            if (counts[level] == 0)
+                continue;
+            // The slots after the current slot are in deadline order, the scan is stopped at the slot that has the
+            // node of its time range, the nodes that were beyond the last level are later than their slots.
+            uint8_t shift = FIREBASE_TIMER_WHEEL_BITS * level;
+            uint32_t index = current >> shift;
+            bool found = false;
+            for (uint32_t i = 1; i <= slotCount() && !found; i++)
+            {
+                for (node_t *node = slots[level][(index + i) & slotMask()]; node; node = node->next)
+                {
+                    uint32_t left = (int32_t)(node->deadline - current) > 0 ? node->deadline - current : 0;
+                    if (left < next)
+                        next = left;
+                    if ((node->deadline >> shift) == ((index + i) & (0xFFFFFFFFUL >> shift)))
+                        found = true;
+                }
+            }
+        }
+        return next;
+    }
+
+    size_t size() const { return count; }
+
+private:
+    node_t *slots[FIREBASE_TIMER_WHEEL_LEVELS][1 << FIREBASE_TIMER_WHEEL_BITS] = {};
+    uint16_t counts[FIREBASE_TIMER_WHEEL_LEVELS] = {};
+    size_t count = 0;
+    uint32_t current = 0;
+    AsyncLock lock;
+
+    static constexpr uint32_t slotCount() { return 1UL << FIREBASE_TIMER_WHEEL_BITS; }
+    static constexpr uint32_t slotMask() { return slotCount() - 1; }
+    // The ticks (ms) of the slots of lower levels of the level.
+    static constexpr uint32_t span(uint8_t level) { return 1UL << (FIREBASE_TIMER_WHEEL_BITS * level); }
+
+    void place(node_t *node)
+    {
+        uint32_t delta = node->deadline - current;
+        if ((int32_t)delta <= 0)
+        {
+            node->expired = true;
+            return;
+        }
+
+        uint8_t level = 0;
+        while (level < FIREBASE_TIMER_WHEEL_LEVELS - 1 && delta >= span(level + 1))
+            level++;
+
+        // The node that is beyond the last level is placed in its farthest slot.
+        uint32_t at = delta < span(FIREBASE_TIMER_WHEEL_LEVELS) ? node->deadline : current + span(FIREBASE_TIMER_WHEEL_LEVELS) - 1;
+        node->level = level;
+        node->slot = (at >> (FIREBASE_TIMER_WHEEL_BITS * level)) & slotMask();
+        node->prev = nullptr;
+        node->next = slots[level][node->slot];
+        if (node->next)
+            node->next->prev = node;
+        slots[level][node->slot] = node;
+        node->linked = true;
+        counts[level]++;
+        count++;
+    }
+
+    void unlink(node_t *node)
+    {
+        if (!node->linked)
+            return;
+        if (node->prev)
+            node->prev->next = node->next;
+        else
+            slots[node->level][node->slot] = node->next;
+        if (node->next)
+            node->next->prev = node->prev;
+        node->prev = nullptr;
+        node->next = nullptr;
+        node->linked = false;
+        counts[node->level]--;
+        count--;
+    }
+
+    // Take the nodes of slot and place them again (cascade) or expire them (level 0).
+    void takeSlot(uint8_t level, uint8_t slot)
+    {
+        node_t *node = slots[level][slot];
+        while (node)
+        {
+            node_t *next = node->next;
+            unlink(node);
+            if (level == 0)
+                node->expired = true;
+            else
+                place(node);
+            node = next;
+        }
+    }
+
+    void advanceTo(uint32_t now)
+    {
+        while (count > 0 && (int32_t)(now - current) > 0)
+        {
+            uint8_t low = 0;
+            while (counts[low] == 0)
+                low++;
+
+            // The ticks of empty lower levels are skipped to the last tick of the current slot of level that has nodes.
+            if (low > 0)
+            {
+                uint32_t last = current | (span(low) - 1);
+                if ((int32_t)(now - last) <= 0)
+                    break;
+                current = last;
+            }
+
+            current++;
+            for (uint8_t level = FIREBASE_TIMER_WHEEL_LEVELS - 1; level > 0; level--)
+            {
+                if ((current & (span(level) - 1)) == 0)
+                    takeSlot(level, (current >> (FIREBASE_TIMER_WHEEL_BITS * level)) & slotMask());
+            }
+            takeSlot(0, current & slotMask());
+        }
+        current = now;
+    }
+};
+
+// The timer of second or ms interval, the running timer is expired by TimerWheel.
 class Timer
 {
 private:
-    unsigned long ts = 0;
-    unsigned long end = 0;
+    TimerWheel::node_t node;
     unsigned long period = 0;
-    unsigned long now = 0;
-    unsigned long ms = 0;
     bool enable = false;
     uint8_t feed_count = 0;
 
 public:
     Timer(unsigned long sec = 60) { setInterval(sec); }
-    ~Timer() {}
-    void reset() { end = ts + period; }
+    Timer(const Timer &rhs) { *this = rhs; }
+    Timer &operator=(const Timer &rhs)
+    {
+        if (this == &rhs)
+            return *this;
+        TimerWheel::shared().remove(&node);
+        period = rhs.period;
+        enable = rhs.enable;
+        feed_count = rhs.feed_count;
+        node.expired = rhs.node.expired;
+        if (rhs.node.linked)
+            TimerWheel::shared().add(&node, rhs.node.deadline);
+        return *this;
+    }
+    ~Timer() { TimerWheel::shared().remove(&node); }
+    void reset()
+    {
+        if (enable)
+            TimerWheel::shared().add(&node, millis() + (period < 0x7FFFFFFF ? period : 0x7FFFFFFF));
+        else
+            node.expired = period == 0;
+    }
     void start()
     {
         enable = true;
-        loop();
         reset();
     }
-    void stop() { enable = false; }
-    void setInterval(unsigned long sec)
+    void stop()
     {
         loop();
-        period = sec;
+        enable = false;
+        TimerWheel::shared().remove(&node);
+    }
+    void setInterval(unsigned long sec) { setIntervalMs(sec * 1000); }
+    void setIntervalMs(unsigned long ms)
+    {
+        period = ms;
         reset();
     }
     void feed(unsigned long sec)
@@ -67,27 +281,73 @@ public:
     }
     void loop()
     {
-        if (enable && (unsigned long)(millis() - now) > 100)
-        {
-            now = millis();
-            if (now / 1000 >= ts)
-            {
-                ts = now / 1000;
-                ms = now;
-            }
-            else // millis overflow handling
-                ts += (unsigned long)(now - ms) / 1000;
-        }
+        if (node.linked)
+            TimerWheel::shared().advance();
     }
 
-    unsigned long remaining() { return ready() ? 0 : end - ts; }
+    unsigned long remaining() { return (remainingMs() + 999) / 1000; }
+    unsigned long remainingMs()
+    {
+        if (ready())
+            return 0;
+        if (!node.linked)
+            return period;
+        int32_t left = node.deadline - millis();
+        return left > 0 ? left : 1;
+    }
     uint8_t feedCount() const { return feed_count; }
     bool isRunning() const { return enable; };
     bool ready()
     {
+        // The wheel is not locked until the deadline of running timer was reached.
+        if (node.linked && (int32_t)(millis() - node.deadline) < 0)
+            return false;
         loop();
-        return ts >= end;
+        return node.expired;
     }
 };
 
+// The wall time that is anchored to the last valid timestamp from the time status callback and advanced by millis.
+class WallClock
+{
+private:
+    uint32_t anchor_ts = 0;
+    unsigned long anchor_ms = 0;
+
+public:
+    // The clock that shared by all auth.
+    static WallClock &shared()
+    {
+        static WallClock clock;
+        return clock;
+    }
+
+    /**
+     * Get the current timestamp (epoch seconds), 0 when the time is not valid.
+     *
+     * @param cb The time status callback that called only when the clock was not synced or
+     * FIREBASE_TIME_RESYNC_SEC was elapsed since the last sync.
+     */
+    uint32_t now(void (*cb)(uint32_t &ts))
+    {
+        unsigned long elapsed = millis() - anchor_ms;
+        if (anchor_ts && elapsed / 1000 < FIREBASE_TIME_RESYNC_SEC)
+            return anchor_ts + elapsed / 1000;
+
+        uint32_t ts = 0;
+        if (cb)
+            cb(ts);
+
+        if (ts < FIREBASE_DEFAULT_TS)
+            return anchor_ts ? anchor_ts + elapsed / 1000 : 0;
+
+        anchor_ts = ts;
+        anchor_ms = millis();
+        return ts;
+    }
+
+    // Clear the anchor time e.g. when the device time was changed, the next call of now will sync the clock.
+    void reset() { anchor_ts = 0; }
+};
+
 #endif
\ No newline at end of file
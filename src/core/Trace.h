@@ -0,0 +1,133 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef CORE_TRACE_H
+#define CORE_TRACE_H
+
+#include <Arduino.h>
+
+enum trace_event
+{
+    trace_event_create,
+    trace_event_connect,
+    trace_event_send,
+    trace_event_receive,
+    trace_event_remove
+};
+
+// The trace record of task state transition, the bytes is the sent or read payload progress of task.
+struct trace_record_t
+{
+    uint32_t us = 0;
+    uint32_t bytes = 0;
+    uint16_t slot_id = 0;
+    uint8_t event = 0;
+    // The async_state and function_return_type of task.
+    uint8_t state = 0;
+    int8_t ret = 0;
+};
+
+#if defined(FIREBASE_TRACE_SIZE)
+
+/**
+ * The ring buffer of the last FIREBASE_TRACE_SIZE (power of two) task state transitions of all async clients,
+ * the oldest records are overwritten.
+ */
+class AsyncTrace
+{
+    static_assert(FIREBASE_TRACE_SIZE > 0 && (FIREBASE_TRACE_SIZE & (FIREBASE_TRACE_SIZE - 1)) == 0, "FIREBASE_TRACE_SIZE should be power of two");
+
+public:
+    static AsyncTrace &shared()
+    {
+        static AsyncTrace trace;
+        return trace;
+    }
+
+    void add(uint8_t event, uint16_t slot_id, uint8_t state, int8_t ret, uint32_t bytes)
+    {
+        trace_record_t &r = records[head++ & (FIREBASE_TRACE_SIZE - 1)];
+        r.us = micros();
+        r.bytes = bytes;
+        r.slot_id = slot_id;
+        r.event = event;
+        r.state = state;
+        r.ret = ret;
+    }
+
+    // The numbers of records in the ring.
+    size_t size() const { return head < FIREBASE_TRACE_SIZE ? head : FIREBASE_TRACE_SIZE; }
+
+    // The numbers of records that were overwritten.
+    uint32_t dropped() const { return head - size(); }
+
+    // Get the record at index, the index 0 is the oldest record.
+    const trace_record_t &at(size_t index) const { return records[(head - size() + index) & (FIREBASE_TRACE_SIZE - 1)]; }
+
+    // Print the records as the CSV lines "us,slot,event,state,ret,bytes" from the oldest one.
+    size_t dump(Print &out) const
+    {
+        size_t n = out.println(FPSTR("us,slot,event,state,ret,bytes"));
+        for (size_t i = 0; i < size(); i++)
+        {
+            const trace_record_t &r = at(i);
+            n += out.print(r.us);
+            n += out.print(',');
+            n += out.print(r.slot_id);
+            n += out.print(',');
+            n += out.print(r.event);
+            n += out.print(',');
+            n += out.print(r.state);
+            n += out.print(',');
+            n += out.print(r.ret);
+            n += out.print(',');
+            n += out.println(r.bytes);
+        }
+        return n;
+    }
+
+    // Copy the records from the oldest one to buf e.g. to upload as blob, returns the copied size.
+    size_t exportTo(uint8_t *buf, size_t len) const
+    {
+        size_t count = size();
+        if (count > len / sizeof(trace_record_t))
+            count = len / sizeof(trace_record_t);
+        for (size_t i = 0; i < count; i++)
+            memcpy(buf + i * sizeof(trace_record_t), &at(size() - count + i), sizeof(trace_record_t));
+        return count * sizeof(trace_record_t);
+    }
+
+    void clear() { head = 0; }
+
+private:
+    trace_record_t records[FIREBASE_TRACE_SIZE];
+    uint32_t head = 0;
+};
+
+#define FIREBASE_TRACE(event, slot_id, state, ret, bytes) AsyncTrace::shared().add(event, slot_id, state, ret, bytes)
+#else
+#define FIREBASE_TRACE(event, slot_id, state, ret, bytes)
+#endif
+
+#endif
@@ -29,6 +29,7 @@
 #include <Client.h>
 #include "./Config.h"
 #include "./core/StringUtil.h"
+#include "./core/JsonParser.h"
 #include "./core/Memory.h"
 
 class URLUtil
@@ -211,13 +212,11 @@ public:
 
     void updateDownloadURL(String &url, const String &payload)
     {
-        int p1 = payload.indexOf(FPSTR("\"downloadTokens\": \""));
-        if (p1 > -1)
+        json_span_t span;
+        if (JsonPullParser::get(payload, "downloadTokens", span))
         {
-            p1 += 19;
-            int p2 = payload.indexOf("\"", p1);
-            if (p2 > -1)
-                url.replace(FPSTR("a82781ce-a115-442f-bac6-a52f7f63b3e8"), payload.substring(p1, p2));
+            span = span.unquote(payload.c_str());
+            url.replace(FPSTR("a82781ce-a115-442f-bac6-a52f7f63b3e8"), payload.substring(span.start, span.end));
         }
     }
 };
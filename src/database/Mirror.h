@@ -0,0 +1,440 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef ASYNC_DATABASE_MIRROR_H
+#define ASYNC_DATABASE_MIRROR_H
+
+#include <Arduino.h>
+#include <vector>
+#include "./core/JsonParser.h"
+#include "./core/AsyncResult/AsyncResult.h"
+
+#if defined(ENABLE_DATABASE)
+
+// The default memory limit of mirror cache in bytes.
+#if !defined(FIREBASE_RTDB_MIRROR_SIZE)
+#define FIREBASE_RTDB_MIRROR_SIZE 4096
+#endif
+
+// The maximum numbers of evicted paths that are kept, the mirror is out of sync when it was exceeded.
+#define FIREBASE_RTDB_MIRROR_HOLES 8
+
+enum rtdb_mirror_eviction
+{
+    rtdb_mirror_evict_lru,    // The least recently used value is evicted first
+    rtdb_mirror_evict_largest // The largest value is evicted first
+};
+
+// The local copy of stream node that is updated from put and patch events of the stream.
+// The value is kept in flat list of leaf paths that sorted by path, the object is built when it was read.
+class RealtimeDatabaseMirror
+{
+    friend class RealtimeDatabase;
+
+private:
+    struct mirror_entry_t
+    {
+        String path, value;
+        uint32_t used = 0;
+    };
+
+    std::vector<mirror_entry_t> entries;
+    // The paths of evicted values.
+    std::vector<String> holes;
+    String root;
+    size_t limit = FIREBASE_RTDB_MIRROR_SIZE, mem = 0;
+    uint32_t tick = 0;
+    bool synced = false;
+    rtdb_mirror_eviction eviction = rtdb_mirror_evict_lru;
+    // The handle in Registry, the database and the stream keep this handle instead of the mirror address.
+    list_handle_t reg_handle = 0;
+
+    size_t entrySize(const mirror_entry_t &e) const { return sizeof(mirror_entry_t) + e.path.length() + e.value.length(); }
+
+    // Compare the paths that the '/' is the lowest character, the child paths are placed right after their parent.
+    static int compare(const char *a, const char *b)
+    {
+        while (*a && *a == *b)
+        {
+            a++;
+            b++;
+        }
+        uint8_t ca = *a == '/' ? 1 : (uint8_t)*a, cb = *b == '/' ? 1 : (uint8_t)*b;
+        return (int)ca - (int)cb;
+    }
+
+    // The path is the same path or child path of parent.
+    static bool isUnder(const String &path, const String &parent)
+    {
+        if (parent.length() == 0)
+            return true;
+        return path.startsWith(parent) && (path.length() == parent.length() || path[parent.length()] == '/');
+    }
+
+    // Remove the trailing slash and make sure the path starts with slash, the root path is empty.
+    static String normalize(const String &path)
+    {
+        String p;
+        if (path.length() && path[0] != '/')
+            p += '/';
+        p += path;
+        while (p.length() && p[p.length() - 1] == '/')
+            p.remove(p.length() - 1, 1);
+        return p;
+    }
+
+    size_t lowerBound(const String &path) const
+    {
+        size_t lo = 0, hi = entries.size();
+        while (lo < hi)
+        {
+            size_t mid = (lo + hi) / 2;
+            if (compare(entries[mid].path.c_str(), path.c_str()) < 0)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    // The entries range [first, last) of the path and its child paths.
+    void range(const String &path, size_t &first, size_t &last) const
+    {
+        first = lowerBound(path);
+        last = first;
+        while (last < entries.size() && isUnder(entries[last].path, path))
+            last++;
+    }
+
+    // The index of leaf entry at the parent path (under the stream path) of path.
+    int leafParent(const String &path) const
+    {
+        for (int s = path.lastIndexOf('/'); s >= (int)root.length(); s = s > 0 ? path.lastIndexOf('/', s - 1) : -1)
+        {
+            String parent = path.substring(0, s);
+            size_t i = lowerBound(parent);
+            if (i < entries.size() && entries[i].path == parent)
+                return i;
+        }
+        return -1;
+    }
+
+    void removeRange(size_t first, size_t last)
+    {
+        for (size_t i = first; i < last; i++)
+            mem -= entrySize(entries[i]);
+        entries.erase(entries.begin() + first, entries.begin() + last);
+    }
+
+    void addHole(const String &path)
+    {
+        for (size_t i = 0; i < holes.size(); i++)
+        {
+            if (isUnder(path, holes[i]))
+                return;
+        }
+
+        if (holes.size() >= FIREBASE_RTDB_MIRROR_HOLES)
+        {
+            clear();
+            return;
+        }
+        holes.push_back(path);
+    }
+
+    void insert(const String &path, const char *value, size_t len)
+    {
+        mirror_entry_t e;
+        e.path = path;
+        e.value.reserve(len);
+        for (size_t i = 0; i < len; i++)
+            e.value += value[i];
+        e.used = ++tick;
+        mem += entrySize(e);
+        entries.insert(entries.begin() + lowerBound(path), e);
+    }
+
+    // Add the leaf values of JSON value at path.
+    void flatten(const String &path, const char *buf, size_t len)
+    {
+        JsonPullParser parser(buf, len);
+        json_token_type t = parser.next();
+        if (t == json_token_end || t == json_token_error || (t == json_token_primitive && parser.equals("null", 4)))
+            return;
+
+        if (t != json_token_object_begin)
+        {
+            insert(path, buf, len);
+            return;
+        }
+
+        uint8_t level = parser.depth();
+        while (parser.next() == json_token_key && parser.depth() == level)
+        {
+            json_span_t key = parser.span();
+            parser.next();
+            json_span_t val = parser.skipValue();
+            if (!val.valid())
+                return;
+            String child = path;
+            child += '/';
+            for (int i = key.start; i < key.end; i++)
+                child += buf[i];
+            flatten(child, buf + val.start, val.length());
+        }
+    }
+
+    // Replace the value at path e.g. from put event.
+    void put(const String &path, const char *buf, size_t len)
+    {
+        size_t first, last;
+        range(path, first, last);
+        removeRange(first, last);
+
+        for (size_t i = holes.size(); i > 0; i--)
+        {
+            if (isUnder(holes[i - 1], path))
+                holes.erase(holes.begin() + i - 1);
+        }
+
+        // The leaf value at parent path becomes the object, the array elements are not merged.
+        int i = leafParent(path);
+        if (i > -1)
+        {
+            if (entries[i].value[0] == '[')
+                addHole(entries[i].path);
+            removeRange(i, i + 1);
+        }
+
+        flatten(path, buf, len);
+        evict();
+    }
+
+    void evict()
+    {
+        while (mem > limit && entries.size())
+        {
+            size_t victim = 0;
+            for (size_t i = 1; i < entries.size(); i++)
+            {
+                if (eviction == rtdb_mirror_evict_lru ? entries[i].used < entries[victim].used : entrySize(entries[i]) > entrySize(entries[victim]))
+                    victim = i;
+            }
+            addHole(entries[victim].path);
+            if (entries.size() == 0)
+                return;
+            removeRange(victim, victim + 1);
+        }
+    }
+
+    // Write the object of entries in [first, last) that their paths start with the same parent path of length offset.
+    void build(String &out, size_t first, size_t last, size_t offset)
+    {
+        out += '{';
+        size_t i = first;
+        while (i < last)
+        {
+            const String &p = entries[i].path;
+            int end = p.indexOf('/', offset + 1);
+            size_t seg_end = end == -1 ? p.length() : (size_t)end;
+
+            // The entries of the same child key.
+            size_t j = i + 1;
+            while (j < last && entries[j].path.length() > seg_end && strncmp(entries[j].path.c_str(), p.c_str(), seg_end) == 0 && entries[j].path[seg_end] == '/')
+                j++;
+
+            if (i > first)
+                out += ',';
+            out += '"';
+            for (size_t k = offset + 1; k < seg_end; k++)
+                out += p[k];
+            out += FPSTR("\":");
+
+            if (end == -1)
+                out += entries[i].value;
+            else
+                build(out, i, j, seg_end);
+            i = j;
+        }
+        out += '}';
+    }
+
+public:
+    /**
+     * The mirror cache of Realtime Database stream.
+     *
+     * @param limit The memory limit in bytes.
+     * @param eviction The eviction policy i.e. rtdb_mirror_evict_lru and rtdb_mirror_evict_largest.
+     */
+    RealtimeDatabaseMirror(size_t limit = FIREBASE_RTDB_MIRROR_SIZE, rtdb_mirror_eviction eviction = rtdb_mirror_evict_lru) : limit(limit), eviction(eviction) { reg_handle = Registry::shared().add(this); }
+
+    RealtimeDatabaseMirror(const RealtimeDatabaseMirror &) = delete;
+    RealtimeDatabaseMirror &operator=(const RealtimeDatabaseMirror &) = delete;
+
+    ~RealtimeDatabaseMirror()
+    {
+        if (reg_handle)
+            Registry::shared().remove(reg_handle);
+    }
+
+    void setLimit(size_t limit)
+    {
+        this->limit = limit;
+        evict();
+    }
+
+    void setEviction(rtdb_mirror_eviction eviction) { this->eviction = eviction; }
+
+    // The stream node path that the mirror keeps.
+    void setPath(const String &path)
+    {
+        clear();
+        root = normalize(path);
+    }
+
+    String path() const { return root.length() ? root.c_str() : "/"; }
+
+    // The memory usage in bytes.
+    size_t memoryUsage() const { return mem; }
+
+    // The mirror was updated from the whole node at stream path and no value was evicted from it.
+    bool isSynced() const { return synced; }
+
+    void clear()
+    {
+        entries.clear();
+        holes.clear();
+        mem = 0;
+        synced = false;
+    }
+
+    /**
+     * Apply the stream event to the mirror.
+     *
+     * @param event The event type e.g. "put" and "patch".
+     * @param dataPath The path of changed data that relative to the stream path.
+     * @param data The JSON data of event.
+     * @return boolean The mirror was changed.
+     */
+    bool apply(const String &event, const String &dataPath, const String &data)
+    {
+        String path = root + normalize(dataPath);
+
+        if (event == "put")
+        {
+            if (path == root)
+            {
+                clear();
+                synced = true;
+            }
+            put(path, data.c_str(), data.length());
+            return true;
+        }
+
+        if (event == "patch")
+        {
+            JsonPullParser parser(data);
+            if (parser.next() != json_token_object_begin)
+                return false;
+
+            uint8_t level = parser.depth();
+            while (parser.next() == json_token_key && parser.depth() == level)
+            {
+                json_span_t key = parser.span();
+                parser.next();
+                json_span_t val = parser.skipValue();
+                if (!val.valid())
+                    return false;
+                String child = path;
+                child += '/';
+                for (int i = key.start; i < key.end; i++)
+                    child += data[i];
+                put(child, data.c_str() + val.start, val.length());
+            }
+            return true;
+        }
+
+        // The stream was cancelled or the credential was revoked, the next events are not guaranteed.
+        if (event == "cancel" || event == "auth_revoked")
+            clear();
+
+        return false;
+    }
+
+    bool apply(AsyncResult &aResult)
+    {
+        RealtimeDatabaseResult &r = aResult.to<RealtimeDatabaseResult>();
+        return r.isStream() && apply(r.event(), r.dataPath(), r.data());
+    }
+
+    /**
+     * Get the JSON value at the node path from the mirror.
+     *
+     * @param path The absolute node path e.g. "/config/interval".
+     * @param json The JSON value, the "null" is for the non-existent node.
+     * @return boolean The path is in the mirror.
+     */
+    bool get(const String &path, String &json)
+    {
+        if (!synced)
+            return false;
+
+        String p = normalize(path);
+        if (!isUnder(p, root))
+            return false;
+
+        for (size_t i = 0; i < holes.size(); i++)
+        {
+            if (isUnder(p, holes[i]) || isUnder(holes[i], p))
+                return false;
+        }
+
+        json.remove(0, json.length());
+
+        int i = leafParent(p);
+        if (i > -1)
+        {
+            // The child of primitive value is not existed, the array element is not kept.
+            json = FPSTR("null");
+            return entries[i].value[0] != '[';
+        }
+
+        size_t first, last;
+        range(p, first, last);
+        for (size_t i = first; i < last; i++)
+            entries[i].used = ++tick;
+
+        if (first == last)
+            json = FPSTR("null");
+        else if (last - first == 1 && entries[first].path.length() == p.length())
+            json = entries[first].value;
+        else
+            build(json, first, last, p.length());
+        return true;
+    }
+};
+
+#endif
+
+#endif
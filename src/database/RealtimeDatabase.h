@@ -26,18 +26,72 @@
 #define ASYNC_DATABASE_H
 #include <Arduino.h>
 #include "./core/FirebaseApp.h"
+#include "./core/FNV.h"
 #include "./database/DataOptions.h"
+#include "./database/Mirror.h"
+#include "./database/ShallowSink.h"
 
 using namespace firebase;
 
 #if defined(ENABLE_DATABASE)
 
+// The maximum numbers of node paths in offline write queue, the oldest write is dropped when it was exceeded.
+#if !defined(FIREBASE_RTDB_WRITE_QUEUE_LIMIT)
+#define FIREBASE_RTDB_WRITE_QUEUE_LIMIT 100
+#endif
+
+// The interval in ms to resend the offline write queue after the network error.
+#define FIREBASE_RTDB_WRITE_QUEUE_RETRY 5000
+
+// The maximum numbers of send attempts of offline write queue entry, the entry is dropped when it was reached (0 for no limit).
+#if !defined(FIREBASE_RTDB_WRITE_QUEUE_ATTEMPTS)
+#define FIREBASE_RTDB_WRITE_QUEUE_ATTEMPTS 20
+#endif
+
+// The maximum numbers of leaf values in the object of diff write.
+#if !defined(FIREBASE_RTDB_DIFF_LEAF_LIMIT)
+#define FIREBASE_RTDB_DIFF_LEAF_LIMIT 256
+#endif
+
+// The maximum numbers of field requests of select that are queued on the async client at a time.
+#if !defined(FIREBASE_RTDB_SELECT_WINDOW)
+#define FIREBASE_RTDB_SELECT_WINDOW 4
+#endif
+
+// The callback of each child in iterate, the value is the JSON value of child (the string value is quoted).
+typedef void (*DatabaseChildCallback)(const String &key, const String &value);
+
+// The request to the node path that is sent repeatedly, the request line and headers that were built by the first
+// send are reused by the next sends.
+class DatabaseRequest
+{
+    friend class RealtimeDatabase;
+
+private:
+    list_handle_t client_handle = 0;
+    String path, url, header;
+    async_request_handler_t::http_request_method method = async_request_handler_t::http_undefined;
+    DatabaseOptions options;
+    // The auth of cached header, the header is rebuilt when it was changed.
+    auth_token_type auth_type = auth_unknown_token;
+    bool auth_param = false;
+    // The gzip options (Accept-Encoding and Content-Encoding) of client when the header was cached.
+    uint8_t encoding = 0;
+
+public:
+    // Returns true if the request line and headers were cached by the previous send.
+    bool prepared() const { return header.length() > 0; }
+
+    // Clear the cached request line and headers, they are rebuilt by the next send.
+    void reset() { header.remove(0, header.length()); }
+};
+
 class RealtimeDatabase
 {
     friend class FirebaseApp;
 
 public:
-    std::vector<uint32_t> cVec; // AsyncClient vector
+    std::vector<list_handle_t> cVec; // AsyncClient handles
 
     RealtimeDatabase(const String &url = "")
     {
@@ -50,27 +104,51 @@ public:
         return *this;
     }
 
-    void setApp(uint32_t app_addr, app_token_t *app_token, uint32_t avec_addr)
+    void setApp(list_handle_t app_handle, app_token_t *app_token)
     {
-        this->app_addr = app_addr;
+        this->app_handle = app_handle;
         this->app_token = app_token;
-        this->avec_addr = avec_addr; // AsyncClient vector (list) address
     }
 
-    app_token_t *appToken()
+    // Returns the token of app or nullptr when the app was destroyed.
+    app_token_t *appToken() { return Registry::shared().get(app_handle) ? app_token : nullptr; }
+
+    ~RealtimeDatabase()
     {
-        if (avec_addr > 0)
+        // The writes in batch that were not sent or acknowledged will never complete.
+        if (batch)
         {
-            std::vector<uint32_t> *cVec = reinterpret_cast<std::vector<uint32_t> *>(avec_addr);
-            List vec;
-            if (cVec)
-                return vec.existed(*cVec, app_addr) ? app_token : nullptr;
+            notifyItems(batch->items, FIREBASE_ERROR_OPERATION_CANCELLED);
+            delete batch;
         }
-        return nullptr;
-    }
+        batch = nullptr;
 
-    ~RealtimeDatabase()
-    {
+        for (size_t i = 0; i < batchVec.size(); i++)
+        {
+            write_batch_t *b = batchVec[i];
+            if (b)
+            {
+                notifyItems(b->items, FIREBASE_ERROR_OPERATION_CANCELLED);
+                delete b;
+            }
+        }
+        batchVec.clear();
+
+        for (size_t i = 0; i < iterVec.size(); i++)
+        {
+            iterate_task_t *t = iterVec[i];
+            if (t)
+                delete t;
+        }
+        iterVec.clear();
+
+        for (size_t i = 0; i < selectVec.size(); i++)
+        {
+            select_task_t *t = selectVec[i];
+            if (t)
+                delete t;
+        }
+        selectVec.clear();
     }
 
     /**
@@ -86,12 +164,15 @@ public:
      *
      */
     template <typename T = int>
-    auto get(AsyncClientClass &aClient, const String &path) -> typename std::enable_if<!std::is_same<T, void>::value && !std::is_same<T, AsyncResult>::value, T>::type
+    auto get(AsyncClientClass &aClient, const StringRef &path) -> typename std::enable_if<!std::is_same<T, void>::value && !std::is_same<T, AsyncResult>::value, T>::type
     {
         AsyncResult result;
-        async_request_data_t aReq(&aClient, path, async_request_handler_t::http_get, slot_options_t(), nullptr, nullptr, &result, NULL);
-        asyncRequest(aReq);
-        return result.rtdbResult.to<T>();
+        if (!getMirror(path, &result, NULL))
+        {
+            async_request_data_t aReq(&aClient, path, async_request_handler_t::http_get, slot_options_t(), nullptr, nullptr, &result, NULL);
+            asyncRequest(aReq);
+        }
+        return result.rtdb().to<T>();
     }
 
     /**
@@ -134,12 +215,12 @@ public:
      *
      */
     template <typename T = int>
-    auto get(AsyncClientClass &aClient, const String &path, DatabaseOptions &options) -> typename std::enable_if<!std::is_same<T, void>::value && !std::is_same<T, AsyncResult>::value, T>::type
+    auto get(AsyncClientClass &aClient, const StringRef &path, DatabaseOptions &options) -> typename std::enable_if<!std::is_same<T, void>::value && !std::is_same<T, AsyncResult>::value, T>::type
     {
         AsyncResult result;
         async_request_data_t aReq(&aClient, path, async_request_handler_t::http_get, slot_options_t(false, false, false, false, false, false, options.shallow), &options, nullptr, &result, NULL);
         asyncRequest(aReq);
-        return result.rtdbResult.to<T>();
+        return result.rtdb().to<T>();
     }
 
     /**
@@ -155,12 +236,54 @@ public:
      * @param sse The Server-sent events (Stream) mode
      *
      */
-    void get(AsyncClientClass &aClient, const String &path, AsyncResult &aResult, bool sse = false)
+    void get(AsyncClientClass &aClient, const StringRef &path, AsyncResult &aResult, bool sse = false)
     {
+        if (!sse && getMirror(path, &aResult, NULL))
+            return;
         async_request_data_t aReq(&aClient, path, async_request_handler_t::http_get, slot_options_t(false, sse, true, false, false, false), nullptr, nullptr, &aResult, NULL);
         asyncRequest(aReq);
     }
 
+#if defined(FIREBASE_COROUTINE)
+    /**
+     * Get value at the node path in the coroutine (C++20).
+     *
+     * ### Example
+     * ```cpp
+     * AsyncTask readWrite()
+     * {
+     *     AsyncResult result = co_await Database.getAsync(aClient, "/path/to/data");
+     *     if (!result.isError())
+     *         co_await Database.setAsync<int>(aClient, "/path/to/copy", result.payload().toInt());
+     * }
+     * ```
+     * @param aClient The async client.
+     * @param path The node path to get value.
+     * @return The awaitable that resumes the coroutine with the AsyncResult when the task was finished.
+     *
+     */
+    auto getAsync(AsyncClientClass &aClient, const String &path)
+    {
+        return asyncAwait([this, &aClient, path](AsyncResult &aResult)
+                          { get(aClient, path, aResult); });
+    }
+
+    /**
+     * Get value at the node path in the coroutine (C++20).
+     *
+     * @param aClient The async client.
+     * @param path The node path to get value.
+     * @param options The database options (DatabaseOptions).
+     * @return The awaitable that resumes the coroutine with the AsyncResult when the task was finished.
+     *
+     */
+    auto getAsync(AsyncClientClass &aClient, const String &path, DatabaseOptions &options)
+    {
+        return asyncAwait([this, &aClient, path, &options](AsyncResult &aResult)
+                          { get(aClient, path, options, aResult); });
+    }
+#endif
+
     /**
      * Get value at the node path.
      *
@@ -175,12 +298,61 @@ public:
      * @param uid The user specified UID of async result (optional).
      *
      */
-    void get(AsyncClientClass &aClient, const String &path, AsyncResultCallback cb, bool sse = false, const String &uid = "")
+    void get(AsyncClientClass &aClient, const StringRef &path, AsyncResultCallback cb, bool sse = false, const StringRef &uid = "")
     {
+        if (!sse && getMirror(path, nullptr, cb, uid))
+            return;
         async_request_data_t aReq(&aClient, path, async_request_handler_t::http_get, slot_options_t(false, sse, true, false, false, false), nullptr, nullptr, nullptr, cb, uid);
         asyncRequest(aReq);
     }
 
+    /**
+     * Get value at the node path in SSE mode (HTTP Streaming) and keep the node in mirror cache.
+     * The get functions (without options) of the path under this node are served from the mirror while it was synced.
+     *
+     * ### Example
+     * ```cpp
+     * RealtimeDatabaseMirror mirror(4096);
+     * Database.get(aClient, "/config", mirror, cb);
+     * int interval = Database.get<int>(aClient, "/config/interval");
+     * ```
+     * @param aClient The async client.
+     * @param path The node path to get value.
+     * @param mirror The mirror cache (RealtimeDatabaseMirror).
+     * @param cb The async result callback (AsyncResultCallback).
+     * @param uid The user specified UID of async result (optional).
+     *
+     */
+    void get(AsyncClientClass &aClient, const StringRef &path, RealtimeDatabaseMirror &mirror, AsyncResultCallback cb, const StringRef &uid = "")
+    {
+        async_request_data_t aReq(&aClient, path, async_request_handler_t::http_get, slot_options_t(false, true, true, false, false, false), nullptr, nullptr, nullptr, cb, uid);
+        aReq.mirror = &mirror;
+        asyncRequest(aReq);
+    }
+
+    /**
+     * Get value at the node path in SSE mode (HTTP Streaming) and keep the node in mirror cache.
+     *
+     * @param aClient The async client.
+     * @param path The node path to get value.
+     * @param mirror The mirror cache (RealtimeDatabaseMirror).
+     * @param aResult The async result (AsyncResult).
+     *
+     */
+    void get(AsyncClientClass &aClient, const StringRef &path, RealtimeDatabaseMirror &mirror, AsyncResult &aResult)
+    {
+        async_request_data_t aReq(&aClient, path, async_request_handler_t::http_get, slot_options_t(false, true, true, false, false, false), nullptr, nullptr, &aResult, NULL);
+        aReq.mirror = &mirror;
+        asyncRequest(aReq);
+    }
+
+    // Stop serving the get functions from the mirror, the destroyed mirror is removed automatically.
+    void removeMirror(RealtimeDatabaseMirror &mirror)
+    {
+        List vec;
+        vec.addRemoveList(mirrorVec, mirror.reg_handle, false);
+    }
+
     /**
      * Get value at the node path.
      *
@@ -201,7 +373,7 @@ public:
      * @return value that casts from response payload.
      *
      */
-    void get(AsyncClientClass &aClient, const String &path, DatabaseOptions &options, AsyncResult &aResult)
+    void get(AsyncClientClass &aClient, const StringRef &path, DatabaseOptions &options, AsyncResult &aResult)
     {
         async_request_data_t aReq(&aClient, path, async_request_handler_t::http_get, slot_options_t(false, false, true, false, false, false), &options, nullptr, &aResult, NULL);
         asyncRequest(aReq);
@@ -228,7 +400,7 @@ public:
      * @param uid The user specified UID of async result (optional).
      *
      */
-    void get(AsyncClientClass &aClient, const String &path, DatabaseOptions &options, AsyncResultCallback cb, const String &uid = "")
+    void get(AsyncClientClass &aClient, const StringRef &path, DatabaseOptions &options, AsyncResultCallback cb, const StringRef &uid = "")
     {
         async_request_data_t aReq(&aClient, path, async_request_handler_t::http_get, slot_options_t(false, false, true, false, false, false), &options, nullptr, nullptr, cb, uid);
         asyncRequest(aReq);
@@ -275,7 +447,7 @@ public:
      * The file_operating_mode included file_mode_open_read, file_mode_open_write, file_mode_open_append and file_mode_open_remove.
      * @param aResult The async result (AsyncResult)
      */
-    void get(AsyncClientClass &aClient, const String &path, file_config_data file, AsyncResult &aResult)
+    void get(AsyncClientClass &aClient, const StringRef &path, file_config_data file, AsyncResult &aResult)
     {
         async_request_data_t aReq(&aClient, path, async_request_handler_t::http_get, slot_options_t(), nullptr, &file, &aResult, NULL);
         asyncRequest(aReq);
@@ -323,7 +495,7 @@ public:
      * @param uid The user specified UID of async result (optional).
      *
      */
-    void get(AsyncClientClass &aClient, const String &path, file_config_data file, AsyncResultCallback cb, const String &uid = "")
+    void get(AsyncClientClass &aClient, const StringRef &path, file_config_data file, AsyncResultCallback cb, const StringRef &uid = "")
     {
         async_request_data_t aReq(&aClient, path, async_request_handler_t::http_get, slot_options_t(), nullptr, &file, nullptr, cb, uid);
         asyncRequest(aReq);
@@ -332,6 +504,8 @@ public:
     /**
      * Checks if path exists in database
      *
+     * The shallow query is used, the child nodes are not downloaded and the payload is discarded as it arrives.
+     *
      * ### Example
      * ```cpp
      * bool status = Database.existed(aClient, "/path/to/data");
@@ -341,14 +515,37 @@ public:
      * @return boolean value indicates the operating status.
      *
      */
-    bool existed(AsyncClientClass &aClient, const String &path)
+    bool existed(AsyncClientClass &aClient, const StringRef &path)
     {
+        ShallowSink sink;
         AsyncResult result;
-        DatabaseOptions options;
-        options.silent = true;
-        async_request_data_t aReq(&aClient, path, async_request_handler_t::http_get, slot_options_t(), &options, nullptr, &result, NULL);
-        asyncRequest(aReq);
-        return !result.rtdbResult.null_etag;
+        getShallow(aClient, path, sink, result);
+        if (result.error_available)
+            return false;
+        return sink.size() > 0 ? !sink.isNull() : !result.rtdb().null_etag;
+    }
+
+    /**
+     * Get the keys of child nodes at the node path.
+     *
+     * The shallow query is used, the child nodes are not downloaded and only the keys are kept from the payload.
+     *
+     * ### Example
+     * ```cpp
+     * std::vector<String> keys = Database.childKeys(aClient, "/path/to/data");
+     * ```
+     * @param aClient The async client.
+     * @param path The node path to get the keys.
+     * @return std::vector<String> The keys of child nodes, it is empty when the node does not exist or it is not an object.
+     *
+     */
+    std::vector<String> childKeys(AsyncClientClass &aClient, const StringRef &path)
+    {
+        std::vector<String> keys;
+        ShallowSink sink(&keys);
+        AsyncResult result;
+        getShallow(aClient, path, sink, result);
+        return keys;
     }
 
     /**
@@ -365,7 +562,7 @@ public:
      * @param aResult The async result (AsyncResult)
      *
      */
-    void ota(AsyncClientClass &aClient, const String &path, AsyncResult &aResult)
+    void ota(AsyncClientClass &aClient, const StringRef &path, AsyncResult &aResult)
     {
         async_request_data_t aReq(&aClient, path, async_request_handler_t::http_get, slot_options_t(false, false, false, false, true, false), nullptr, nullptr, &aResult, NULL);
         asyncRequest(aReq);
@@ -386,7 +583,7 @@ public:
      * The data of node to download should be base64 encoded string of the firmware file.
      *
      */
-    void ota(AsyncClientClass &aClient, const String &path, AsyncResultCallback cb, const String &uid = "")
+    void ota(AsyncClientClass &aClient, const StringRef &path, AsyncResultCallback cb, const StringRef &uid = "")
     {
         async_request_data_t aReq(&aClient, path, async_request_handler_t::http_get, slot_options_t(false, false, false, false, true, false), nullptr, nullptr, nullptr, cb, uid);
         asyncRequest(aReq);
@@ -412,7 +609,7 @@ public:
      * ```
      */
     template <typename T = const char *>
-    bool set(AsyncClientClass &aClient, const String &path, T value)
+    bool set(AsyncClientClass &aClient, const StringRef &path, T value)
     {
         AsyncResult result;
         return storeAsync(aClient, path, value, async_request_handler_t::http_put, false, &result, NULL, "");
@@ -438,11 +635,28 @@ public:
      * ```
      */
     template <typename T = const char *>
-    void set(AsyncClientClass &aClient, const String &path, T value, AsyncResult &aResult)
+    void set(AsyncClientClass &aClient, const StringRef &path, T value, AsyncResult &aResult)
     {
         storeAsync(aClient, path, value, async_request_handler_t::http_put, true, &aResult, NULL, "");
     }
 
+#if defined(FIREBASE_COROUTINE)
+    /**
+     * Set value to database in the coroutine (C++20).
+     *
+     * @param aClient The async client.
+     * @param path The node path to set the value.
+     * @param value The value to set.
+     * @return The awaitable that resumes the coroutine with the AsyncResult when the task was finished.
+     */
+    template <typename T = const char *>
+    auto setAsync(AsyncClientClass &aClient, const String &path, T value)
+    {
+        return asyncAwait([this, &aClient, path, value](AsyncResult &aResult)
+                          { set<T>(aClient, path, value, aResult); });
+    }
+#endif
+
     /**
      * Set value to database.
      * @param aClient The async client.
@@ -464,7 +678,7 @@ public:
      * ```
      */
     template <typename T = const char *>
-    void set(AsyncClientClass &aClient, const String &path, T value, AsyncResultCallback cb, const String &uid = "")
+    void set(AsyncClientClass &aClient, const StringRef &path, T value, AsyncResultCallback cb, const StringRef &uid = "")
     {
         storeAsync(aClient, path, value, async_request_handler_t::http_put, true, nullptr, cb, uid);
     }
@@ -508,7 +722,7 @@ public:
      * The file_operating_mode included file_mode_open_read, file_mode_open_write, file_mode_open_append and file_mode_open_remove.
      * @param aResult The async result (AsyncResult)
      */
-    void set(AsyncClientClass &aClient, const String &path, file_config_data file, AsyncResult &aResult)
+    void set(AsyncClientClass &aClient, const StringRef &path, file_config_data file, AsyncResult &aResult)
     {
         async_request_data_t aReq(&aClient, path, async_request_handler_t::http_put, slot_options_t(false, false, true, false, true, false), nullptr, &file, &aResult, nullptr);
         asyncRequest(aReq);
@@ -554,7 +768,7 @@ public:
      * @param cb The async result callback (AsyncResultCallback).
      * @param uid The user specified UID of async result (optional).
      */
-    void set(AsyncClientClass &aClient, const String &path, file_config_data file, AsyncResultCallback cb, const String &uid = "")
+    void set(AsyncClientClass &aClient, const StringRef &path, file_config_data file, AsyncResultCallback cb, const StringRef &uid = "")
     {
         async_request_data_t aReq(&aClient, path, async_request_handler_t::http_put, slot_options_t(false, false, true, false, true, false), nullptr, &file, nullptr, cb, uid);
         asyncRequest(aReq);
@@ -581,7 +795,7 @@ public:
      *
      */
     template <typename T = const char *>
-    String push(AsyncClientClass &aClient, const String &path, T value)
+    String push(AsyncClientClass &aClient, const StringRef &path, T value)
     {
         ValueConverter vcon;
         AsyncResult result;
@@ -589,7 +803,7 @@ public:
         vcon.getVal<T>(payload, value);
         async_request_data_t aReq(&aClient, path, async_request_handler_t::http_post, slot_options_t(), nullptr, nullptr, &result, NULL);
         asyncRequest(aReq, payload.c_str());
-        return result.rtdbResult.name();
+        return result.rtdb().name();
     }
 
     /**
@@ -612,7 +826,7 @@ public:
      * @param aResult The async result (AsyncResult).
      */
     template <typename T = const char *>
-    void push(AsyncClientClass &aClient, const String &path, T value, AsyncResult &aResult)
+    void push(AsyncClientClass &aClient, const StringRef &path, T value, AsyncResult &aResult)
     {
         ValueConverter vcon;
         String payload;
@@ -642,7 +856,7 @@ public:
      * @param uid The user specified UID of async result (optional).
      */
     template <typename T = const char *>
-    void push(AsyncClientClass &aClient, const String &path, T value, AsyncResultCallback cb, const String &uid = "")
+    void push(AsyncClientClass &aClient, const StringRef &path, T value, AsyncResultCallback cb, const StringRef &uid = "")
     {
         ValueConverter vcon;
         String payload;
@@ -691,7 +905,7 @@ public:
      * @param aResult The async result (AsyncResult)
      *
      */
-    void push(AsyncClientClass &aClient, const String &path, file_config_data file, AsyncResult &aResult)
+    void push(AsyncClientClass &aClient, const StringRef &path, file_config_data file, AsyncResult &aResult)
     {
         async_request_data_t aReq(&aClient, path, async_request_handler_t::http_post, slot_options_t(false, false, true, false, false, false), nullptr, &file, &aResult, nullptr);
         asyncRequest(aReq);
@@ -736,7 +950,7 @@ public:
      * The file_operating_mode included file_mode_open_read, file_mode_open_write, file_mode_open_append and file_mode_open_remove.
      *
      */
-    void push(AsyncClientClass &aClient, const String &path, file_config_data file, AsyncResultCallback cb, const String &uid = "")
+    void push(AsyncClientClass &aClient, const StringRef &path, file_config_data file, AsyncResultCallback cb, const StringRef &uid = "")
     {
         async_request_data_t aReq(&aClient, path, async_request_handler_t::http_post, slot_options_t(false, false, true, false, false, false), nullptr, &file, nullptr, cb, uid);
         asyncRequest(aReq);
@@ -756,7 +970,7 @@ public:
      *
      */
     template <typename T = object_t>
-    bool update(AsyncClientClass &aClient, const String &path, const T &value)
+    bool update(AsyncClientClass &aClient, const StringRef &path, const T &value)
     {
         AsyncResult result;
         return storeAsync(aClient, path, value, async_request_handler_t::http_patch, false, &result, NULL, "");
@@ -775,11 +989,28 @@ public:
      * @param aResult The async result (AsyncResult).
      */
     template <typename T = object_t>
-    void update(AsyncClientClass &aClient, const String &path, const T &value, AsyncResult &aResult)
+    void update(AsyncClientClass &aClient, const StringRef &path, const T &value, AsyncResult &aResult)
     {
         storeAsync(aClient, path, value, async_request_handler_t::http_patch, true, &aResult, NULL, "");
     }
 
+#if defined(FIREBASE_COROUTINE)
+    /**
+     * Update (patch) JSON representation data to database in the coroutine (C++20).
+     *
+     * @param aClient The async client.
+     * @param path The node path to update.
+     * @param value The JSON representation data (object_t) to update.
+     * @return The awaitable that resumes the coroutine with the AsyncResult when the task was finished.
+     */
+    template <typename T = object_t>
+    auto updateAsync(AsyncClientClass &aClient, const String &path, const T &value)
+    {
+        return asyncAwait([this, &aClient, path, value](AsyncResult &aResult)
+                          { update<T>(aClient, path, value, aResult); });
+    }
+#endif
+
     /**
      * Update (patch) JSON representation data to database.
      *
@@ -794,7 +1025,7 @@ public:
      * @param uid The user specified UID of async result (optional).
      */
     template <typename T = object_t>
-    void update(AsyncClientClass &aClient, const String &path, const T &value, AsyncResultCallback cb, const String &uid = "")
+    void update(AsyncClientClass &aClient, const StringRef &path, const T &value, AsyncResultCallback cb, const StringRef &uid = "")
     {
         storeAsync(aClient, path, value, async_request_handler_t::http_patch, true, nullptr, cb, uid);
     }
@@ -811,12 +1042,13 @@ public:
      * @return boolean value indicates the operating status.
      *
      */
-    bool remove(AsyncClientClass &aClient, const String &path)
+    bool remove(AsyncClientClass &aClient, const StringRef &path)
     {
         AsyncResult result;
+        removeDiff(path);
         async_request_data_t aReq(&aClient, path, async_request_handler_t::http_delete, slot_options_t(), nullptr, nullptr, &result, nullptr);
         asyncRequest(aReq);
-        return result.rtdbResult.null_etag && String(result.rtdbResult.data()).indexOf("null") > -1;
+        return result.rtdb().null_etag && String(result.rtdb().data()).indexOf("null") > -1;
     }
 
     /**
@@ -831,8 +1063,9 @@ public:
      * @param aResult The async result (AsyncResult).
      *
      */
-    void remove(AsyncClientClass &aClient, const String &path, AsyncResult &aResult)
+    void remove(AsyncClientClass &aClient, const StringRef &path, AsyncResult &aResult)
     {
+        removeDiff(path);
         async_request_data_t aReq(&aClient, path, async_request_handler_t::http_delete, slot_options_t(false, false, true, false, false, false), nullptr, nullptr, &aResult, nullptr);
         asyncRequest(aReq);
     }
@@ -849,14 +1082,112 @@ public:
      * @param cb The async result callback (AsyncResultCallback).
      * @param uid The user specified UID of async result (optional).
      */
-    void remove(AsyncClientClass &aClient, const String &path, AsyncResultCallback cb, const String &uid = "")
+    void remove(AsyncClientClass &aClient, const StringRef &path, AsyncResultCallback cb, const StringRef &uid = "")
     {
+        removeDiff(path);
         async_request_data_t aReq(&aClient, path, async_request_handler_t::http_delete, slot_options_t(false, false, true, false, false, false), nullptr, nullptr, nullptr, cb, uid);
         asyncRequest(aReq);
     }
 
+    /**
+     * Prepare the request to the node path that is sent repeatedly.
+     *
+     * The request line and headers that were built by the first send of prepared request are reused by the next sends,
+     * only the payload and the auth token are added. The headers are rebuilt when the database URL, the auth or the gzip options of client were changed.
+     *
+     * The send with the server value (.sv), the conditional (ETag) write and the get with response cache is built as
+     * the normal request. The write batching, diff write and offline write queue are applied to the set and update
+     * as they were sent with set and update functions without options.
+     *
+     * ### Example
+     * ```cpp
+     * DatabaseRequest req = Database.prepare(aClient, "/path/to/data", async_request_handler_t::http_put);
+     *
+     * Database.send<int>(req, 123, cb);
+     * ```
+     * @param aClient The async client.
+     * @param path The node path.
+     * @param method The request method i.e. async_request_handler_t::http_get, http_put, http_post, http_patch and http_delete.
+     * @return DatabaseRequest The prepared request.
+     */
+    DatabaseRequest prepare(AsyncClientClass &aClient, const StringRef &path, async_request_handler_t::http_request_method method)
+    {
+        DatabaseOptions options;
+        return prepare(aClient, path, method, options);
+    }
+
+    /**
+     * Prepare the request to the node path that is sent repeatedly.
+     *
+     * @param aClient The async client.
+     * @param path The node path.
+     * @param method The request method i.e. async_request_handler_t::http_get, http_put, http_post, http_patch and http_delete.
+     * @param options The database options (DatabaseOptions) that are applied to every send.
+     * @return DatabaseRequest The prepared request.
+     */
+    DatabaseRequest prepare(AsyncClientClass &aClient, const StringRef &path, async_request_handler_t::http_request_method method, DatabaseOptions &options)
+    {
+        DatabaseRequest request;
+        request.client_handle = aClient.handle();
+        request.path = path.toString();
+        request.method = method;
+        request.options.copy(options);
+        return request;
+    }
+
+    /**
+     * Send the value with the prepared request.
+     * @param request The prepared request (DatabaseRequest) of set, push or update.
+     * @param value The value to send, the value types are the same as set.
+     * @param cb The async result callback (AsyncResultCallback).
+     * @param uid The user specified UID of async result (optional).
+     */
+    template <typename T = const char *>
+    void send(DatabaseRequest &request, T value, AsyncResultCallback cb, const StringRef &uid = "")
+    {
+        sendAsync(request, value, true, nullptr, cb, uid);
+    }
+
+    /**
+     * Send the value with the prepared request.
+     * @param request The prepared request (DatabaseRequest) of set, push or update.
+     * @param value The value to send, the value types are the same as set.
+     * @param aResult The async result (AsyncResult).
+     */
+    template <typename T = const char *>
+    void send(DatabaseRequest &request, T value, AsyncResult &aResult)
+    {
+        sendAsync(request, value, true, &aResult, NULL, "");
+    }
+
+    /**
+     * Send the prepared request without payload.
+     * @param request The prepared request (DatabaseRequest) of get or remove.
+     * @param cb The async result callback (AsyncResultCallback).
+     * @param uid The user specified UID of async result (optional).
+     */
+    void send(DatabaseRequest &request, AsyncResultCallback cb, const StringRef &uid = "")
+    {
+        sendAsync<const char *>(request, "", false, nullptr, cb, uid);
+    }
+
+    /**
+     * Send the prepared request without payload.
+     * @param request The prepared request (DatabaseRequest) of get or remove.
+     * @param aResult The async result (AsyncResult).
+     */
+    void send(DatabaseRequest &request, AsyncResult &aResult)
+    {
+        sendAsync<const char *>(request, "", false, &aResult, NULL, "");
+    }
+
     /**
      * Set the Firebase database URL
+     *
+     * The request to the other database instance of the same project can be sent by using its URL as the node path
+     * e.g. "https://other-db.firebaseio.com/path/to/node", the write batching, diff write and offline write queue are
+     * not applied to these requests.
+     *
      * @param url The Firebase database URL.
      */
     void url(const String &url)
@@ -873,90 +1204,1522 @@ public:
     }
 
     /**
-     * Perform the async task repeatedly.
-     * Should be places in main loop function.
+     * Open the connection to the database host and refresh the token that is going to expire before the requests are sent.
+     *
+     * ### Example
+     * ```cpp
+     * // The sensor interrupt was triggered, the data will be sent soon.
+     * Database.warmUp(aClient);
+     * ```
+     * @param aClient The async client.
+     * @param url The URL of the other database instance to connect, the database URL is used when it is empty.
+     * @return bool true when the connect task was added (see AsyncClientClass::preconnect).
      */
-    void loop()
+    bool warmUp(AsyncClientClass &aClient, const String &url = "")
     {
-        for (size_t i = 0; i < cVec.size(); i++)
+        URLUtil uut;
+        String host, node;
+        if (!routeInstance(url, host, node))
         {
-            AsyncClientClass *aClient = reinterpret_cast<AsyncClientClass *>(cVec[i]);
-            if (aClient)
-            {
-                aClient->process(true);
-                aClient->handleRemove();
-            }
+            // The URL of the host that is not database instance is not connected.
+            if (isInstanceUrl(url))
+                return false;
+            host = service_url;
         }
+        return host.length() && aClient.warmUp(app_handle, cVec, uut.getHost(host));
     }
 
-private:
-    String service_url;
-    // FirebaseApp address and FirebaseApp vector address
-    uint32_t app_addr = 0, avec_addr = 0;
-    app_token_t *app_token = nullptr;
-
-    struct async_request_data_t
+    /**
+     * Set the write batching for async set and update.
+     *
+     * When enabled, the async set and update operations are collected and sent as one multi-location update
+     * (HTTP PATCH) at their common parent node when the time window or the maximum numbers of writes is reached.
+     * The result of batch request is returned to the async result (AsyncResult) or the async result callback
+     * (AsyncResultCallback) of each write. The writes in batch that were not completed when the RealtimeDatabase
+     * object was destroyed are failed with FIREBASE_ERROR_OPERATION_CANCELLED error.
+     *
+     * The sync operations, the conditional (ETag) writes and the writes to the overlapped node paths are not batched,
+     * the writes in batch are sent before these operations.
+     *
+     * ### Example
+     * ```cpp
+     * // Collect the writes within 200 ms or up to 10 writes.
+     * Database.setBatchWrite(200, 10);
+     * ```
+     * @param interval The time window in ms (0 to disable).
+     * @param count The maximum numbers of writes in batch.
+     */
+    void setBatchWrite(uint32_t interval, uint16_t count = 10)
     {
-    public:
-        AsyncClientClass *aClient = nullptr;
-        String path;
-        String uid;
-        async_request_handler_t::http_request_method method = async_request_handler_t::http_undefined;
-        slot_options_t opt;
-        DatabaseOptions *options = nullptr;
-        file_config_data *file = nullptr;
-        AsyncResult *aResult = nullptr;
-        AsyncResultCallback cb = NULL;
-        async_request_data_t() {}
-        async_request_data_t(AsyncClientClass *aClient, const String &path, async_request_handler_t::http_request_method method, slot_options_t opt, DatabaseOptions *options, file_config_data *file, AsyncResult *aResult, AsyncResultCallback cb, const String &uid = "")
-        {
-            this->aClient = aClient;
-            this->path = path;
-            this->method = method;
-            this->opt = opt;
-            this->options = options;
-            this->file = file;
-            this->aResult = aResult;
-            this->cb = cb;
-            this->uid = uid;
-        }
-    };
+        batch_interval_ms = interval;
+        batch_count = count;
+        if (batch_interval_ms == 0)
+            flushBatch();
+    }
 
-    template <typename T = object_t>
-    bool storeAsync(AsyncClientClass &aClient, const String &path, const T &value, async_request_handler_t::http_request_method mode, bool async, AsyncResult *aResult, AsyncResultCallback cb, const String &uid)
+    /**
+     * Set the offline write queue for async set and update.
+     *
+     * The writes are kept in queue (and appended to the file) and sent as the multi-location updates
+     * when the network is connected, the write replaces the pending writes at the same (or child) node path.
+     * The writes are kept in queue until they were sent successfully, rejected by server or failed for
+     * FIREBASE_RTDB_WRITE_QUEUE_ATTEMPTS attempts, the writes that were stored in the file are loaded and sent after restart.
+     *
+     * The root node, sync and conditional (ETag) writes are not queued.
+     *
+     * ### Example
+     * ```cpp
+     * FileConfig queue_file("/rtdb_queue.txt", fileCallback);
+     * Database.setOfflineQueue(aClient, getFile(queue_file), 20);
+     * ```
+     * @param aClient The async client that sends the queue.
+     * @param file The file config data of the queue file.
+     * @param count The maximum numbers of node paths in each multi-location update.
+     */
+#if defined(ENABLE_FS)
+    void setOfflineQueue(AsyncClientClass &aClient, file_config_data file, uint16_t count = 20)
     {
-        ValueConverter vcon;
-        String payload;
-        vcon.getVal<T>(payload, value);
-        DatabaseOptions options;
-        if (!async && aClient.reqEtag.length() == 0)
-            options.silent = true;
-        async_request_data_t aReq(&aClient, path, mode, slot_options_t(false, false, async, payload.indexOf("\".sv\"") > -1, false, false), &options, nullptr, aResult, cb, uid);
-        asyncRequest(aReq, payload.c_str());
-        if (!async)
-            return aResult->lastError.code() == 0;
-        return true;
+        setOfflineQueue(aClient, count);
+        queue.file.copy(file);
+        loadQueue();
     }
+#endif
 
-    void asyncRequest(async_request_data_t &request, const char *payload = "")
+    // Set the offline write queue that is kept in memory.
+    void setOfflineQueue(AsyncClientClass &aClient, uint16_t count = 20)
     {
-        app_token_t *app_token = appToken();
+        queue.aClient = &aClient;
+        queue.count = count > 0 ? count : 1;
+    }
+
+    // Returns the numbers of node paths in offline write queue.
+    size_t offlineQueueSize() const { return queue.entries.size(); }
+
+    /**
+     * Set the diff write for async set and update of JSON object.
+     *
+     * The hash of each leaf value of the last acknowledged write at the node path is kept and
+     * only the changed leaf values are sent as the multi-location update. The whole object is sent
+     * when the previous write was failed, the previous write is not acknowledged, the (set) object
+     * has fewer leaves than the last object or the node was written by other functions.
+     *
+     * The diff write assumes that this device is the only writer of the node.
+     *
+     * ### Example
+     * ```cpp
+     * Database.setDiffWrite(true);
+     * ```
+     * @param enable The option to enable the diff write.
+     */
+    void setDiffWrite(bool enable)
+    {
+        diff_write = enable;
+        if (!enable)
+            diffVec.clear();
+    }
+
+    /**
+     * Iterate the children of large list page by page in key order.
+     *
+     * The page is requested with orderBy="$key", startAt (the last key of previous page) and limitToFirst,
+     * the next page is requested before the children of current page are delivered.
+     * The children are delivered in key order one at a time and at most two pages are kept in memory.
+     * The result callback is called when all children were delivered or the error occurred.
+     *
+     * ### Example
+     * ```cpp
+     * void onChild(const String &key, const String &value)
+     * {
+     *     Serial.println(key);
+     * }
+     *
+     * Database.iterate(aClient, "/logs", 50, onChild, asyncCB);
+     * ```
+     * @param aClient The async client.
+     * @param path The node path of list.
+     * @param pageSize The numbers of children in each page.
+     * @param childCb The callback function that receives each child.
+     * @param cb The async result callback (AsyncResultCallback) that is called when iteration was finished.
+     * @param uid The user specified UID of async result (optional).
+     */
+    void iterate(AsyncClientClass &aClient, const StringRef &path, uint16_t pageSize, DatabaseChildCallback childCb, AsyncResultCallback cb = NULL, const StringRef &uid = "")
+    {
+        iterate_task_t *t = new iterate_task_t();
+        t->aClient = &aClient;
+        t->path = path.toString();
+        t->size = pageSize > 0 ? pageSize : 1;
+        t->childCb = childCb;
+        t->cb = cb;
+        t->uid = uid.toString();
+        iterVec.push_back(t);
+        requestPage(t);
+    }
+
+    /**
+     * Get the selected fields of each child of the node, the children are filtered by the server and only the fields
+     * are downloaded.
+     *
+     * The keys of children are requested first with the filter (or the shallow query when the filter is empty), only
+     * the keys are kept from the response. Each field of children is requested with the small get, up to
+     * FIREBASE_RTDB_SELECT_WINDOW requests are queued on the async client and sent on its kept-alive connection.
+     * The children are delivered in the order of keys as the JSON object of their fields, the null (missing) fields
+     * are not included.
+     *
+     * ### Example
+     * ```cpp
+     * void onChild(const String &key, const String &value)
+     * {
+     *     Serial.println(key + ": " + value); // e.g. s1: {"temp":25,"hum":60}
+     * }
+     *
+     * DatabaseFilter filter;
+     * filter.orderBy("active").equalTo(true);
+     * Database.select(aClient, "/sensors", filter, "temp,hum", onChild, asyncCB);
+     * ```
+     * @param aClient The async client.
+     * @param path The node path of children.
+     * @param filter The DatabaseFilter object of children to select.
+     * @param fields The paths of fields in child to get, use comma (,) to separate between the fields.
+     * @param childCb The callback function that receives each child.
+     * @param cb The async result callback (AsyncResultCallback) that is called when all children were delivered or
+     * the error occurred.
+     * @param uid The user specified UID of async result (optional).
+     */
+    void select(AsyncClientClass &aClient, const StringRef &path, DatabaseFilter &filter, const String &fields, DatabaseChildCallback childCb, AsyncResultCallback cb = NULL, const StringRef &uid = "")
+    {
+        select_task_t *t = new select_task_t();
+        t->aClient = &aClient;
+        t->path = path.toString();
+        t->childCb = childCb;
+        t->cb = cb;
+        t->uid = uid.toString();
+
+        int start = 0;
+        for (int i = 0; i <= (int)fields.length(); i++)
+        {
+            if (i == (int)fields.length() || fields[i] == ',')
+            {
+                String field = fields.substring(start, i);
+                field.trim();
+                if (field.length())
+                    t->fields.push_back(field);
+                start = i + 1;
+            }
+        }
+
+        // The requests of all fields of child are in the window.
+        t->window.resize(t->fields.size() > FIREBASE_RTDB_SELECT_WINDOW ? t->fields.size() : FIREBASE_RTDB_SELECT_WINDOW);
+        selectVec.push_back(t);
+
+        // The server does not accept the shallow query with the filter.
+        DatabaseOptions options;
+        options.filter.copy(filter);
+        options.shallow = !options.filter.complete;
+        t->result.clear();
+        t->result.error_available = false;
+        aClient.setPayloadSink(t->sink);
+        async_request_data_t aReq(&aClient, t->path, async_request_handler_t::http_get, slot_options_t(false, false, true, false, false, false), &options, nullptr, &t->result, NULL, t->uid);
+        asyncRequest(aReq);
+        // The sink is not used when the request was not added.
+        aClient.reqSink = nullptr;
+    }
+
+    /**
+     * Get the selected fields of each child of the node, see select with the filter.
+     *
+     * @param aClient The async client.
+     * @param path The node path of children.
+     * @param fields The paths of fields in child to get, use comma (,) to separate between the fields.
+     * @param childCb The callback function that receives each child.
+     * @param cb The async result callback (AsyncResultCallback) that is called when all children were delivered or
+     * the error occurred.
+     * @param uid The user specified UID of async result (optional).
+     */
+    void select(AsyncClientClass &aClient, const StringRef &path, const String &fields, DatabaseChildCallback childCb, AsyncResultCallback cb = NULL, const StringRef &uid = "")
+    {
+        DatabaseFilter filter;
+        select(aClient, path, filter, fields, childCb, cb, uid);
+    }
+
+    /**
+     * Perform the async task repeatedly.
+     * Should be places in main loop function.
+     */
+    void loop()
+    {
+        List vec;
+        for (size_t i = 0; i < cVec.size(); i++)
+        {
+            AsyncClientClass *aClient = Registry::shared().get<AsyncClientClass>(vec.at(cVec, i));
+            if (aClient)
+            {
+                aClient->process(true);
+                aClient->handleRemove();
+            }
+        }
+
+        handleQueue();
+        handleBatch();
+        handleIterate();
+        handleSelect();
+    }
+
+private:
+    String service_url;
+    // FirebaseApp address and FirebaseApp vector address
+    list_handle_t app_handle = 0;
+    app_token_t *app_token = nullptr;
+
+    struct write_batch_item_t
+    {
+    public:
+        AsyncResult *aResult = nullptr;
+        AsyncResultCallback cb = NULL;
+        String uid;
+    };
+
+    // The hashes of leaf value in diff write.
+    struct diff_leaf_t
+    {
+    public:
+        // The hashes of top level key, leaf path (relative to the node) and value.
+        uint32_t top = 0, path = 0, value = 0;
+    };
+
+    struct diff_node_t
+    {
+    public:
+        String path;
+        std::vector<diff_leaf_t> leaves;
+        // The leaves were from set (all leaves of node are known).
+        bool complete = false;
+        bool pending = false;
+    };
+
+    struct write_batch_t
+    {
+    public:
+        AsyncClientClass *aClient = nullptr;
+        std::vector<String> paths;
+        std::vector<String> values;
+        std::vector<write_batch_item_t> items;
+        bool sv = false;
+        unsigned long ms = 0;
+        // The numbers of offline queue entries that were sent in this batch.
+        size_t queued = 0;
+        // The leaves of diff write that are kept when the write was acknowledged.
+        String diff_path;
+        bool diff_set = false;
+        std::vector<uint32_t> diff_tops;
+        std::vector<diff_leaf_t> diff_leaves;
+        // The result of batch request that returns to all writes in batch.
+        AsyncResult result;
+    };
+
+    struct write_queue_entry_t
+    {
+    public:
+        String path, value;
+        // The writes that were completed by this entry.
+        std::vector<write_batch_item_t> items;
+        // The numbers of failed send attempts.
+        uint16_t attempts = 0;
+    };
+
+    struct write_queue_t
+    {
+    public:
+        AsyncClientClass *aClient = nullptr;
+        std::vector<write_queue_entry_t> entries;
+#if defined(ENABLE_FS)
+        file_config_data file;
+#endif
+        uint16_t count = 0;
+        bool sending = false;
+        unsigned long ms = 0;
+    };
+
+    // The offline write queue.
+    write_queue_t queue;
+    // The leaves of last acknowledged diff writes.
+    std::vector<diff_node_t> diffVec;
+    bool diff_write = false;
+
+    // The writes that are waiting for sending.
+    write_batch_t *batch = nullptr;
+    // The batches that were sent and waiting for result.
+    std::vector<write_batch_t *> batchVec;
+    uint32_t batch_interval_ms = 0;
+    uint16_t batch_count = 0;
+    // The Registry handles of mirror caches of streams.
+    std::vector<list_handle_t> mirrorVec;
+
+    struct iterate_task_t
+    {
+    public:
+        AsyncClientClass *aClient = nullptr;
+        String path, uid;
+        uint16_t size = 0;
+        DatabaseChildCallback childCb = NULL;
+        AsyncResultCallback cb = NULL;
+        // The page results, the next page is fetched into the other result while the current page is delivered.
+        AsyncResult result[2];
+        uint8_t current = 0;
+        // The last key of previous page, it is the first key of next page.
+        String last;
+    };
+
+    // The iterations that are waiting for their pages.
+    std::vector<iterate_task_t *> iterVec;
+
+    struct select_task_t
+    {
+    public:
+        AsyncClientClass *aClient = nullptr;
+        String path, uid;
+        std::vector<String> fields, keys;
+        // The keys of children are kept from the response, the values are discarded as they arrive.
+        ShallowSink sink;
+        DatabaseChildCallback childCb = NULL;
+        AsyncResultCallback cb = NULL;
+        // The result of keys request and the results of field requests that are in flight.
+        AsyncResult result;
+        std::vector<AsyncResult> window;
+        // The index (child * fields + field) of the next request to send and the next child to deliver.
+        size_t next = 0, child = 0;
+        bool listed = false, failed = false;
+        select_task_t() : sink(&keys) {}
+    };
+
+    // The selections that are waiting for their field values.
+    std::vector<select_task_t *> selectVec;
+
+    struct async_request_data_t
+    {
+    public:
+        AsyncClientClass *aClient = nullptr;
+        // The path and uid of the function arguments that are valid until the request was built.
+        StringRef path;
+        StringRef uid;
+        async_request_handler_t::http_request_method method = async_request_handler_t::http_undefined;
+        slot_options_t opt;
+        DatabaseOptions *options = nullptr;
+        file_config_data *file = nullptr;
+        AsyncResult *aResult = nullptr;
+        AsyncResultCallback cb = NULL;
+        RealtimeDatabaseMirror *mirror = nullptr;
+        DatabaseRequest *prepared = nullptr;
+        async_request_data_t() {}
+        async_request_data_t(AsyncClientClass *aClient, const StringRef &path, async_request_handler_t::http_request_method method, slot_options_t opt, DatabaseOptions *options, file_config_data *file, AsyncResult *aResult, AsyncResultCallback cb, const StringRef &uid = "")
+        {
+            this->aClient = aClient;
+            this->path = path;
+            this->method = method;
+            this->opt = opt;
+            this->options = options;
+            this->file = file;
+            this->aResult = aResult;
+            this->cb = cb;
+            this->uid = uid;
+        }
+    };
+
+    template <typename T = object_t>
+    bool storeAsync(AsyncClientClass &aClient, const StringRef &path, const T &value, async_request_handler_t::http_request_method mode, bool async, AsyncResult *aResult, AsyncResultCallback cb, const StringRef &uid)
+    {
+        ValueConverter vcon;
+        String payload;
+        vcon.getVal<T>(payload, value);
+
+        // The writes to the other database instance are sent directly.
+        bool direct = isInstanceUrl(path);
+
+        if (!direct && diff_write && async && queue.aClient != &aClient && aClient.reqEtag.length() == 0 && addDiff(aClient, path.toString(), payload, mode, aResult, cb, uid.toString()))
+            return true;
+        removeDiff(path);
+
+        if (!direct && async && queue.aClient == &aClient && aClient.reqEtag.length() == 0 && addQueue(path.toString(), payload, mode, aResult, cb, uid.toString()))
+            return true;
+
+        if (!direct && async && batch_interval_ms > 0 && aClient.reqEtag.length() == 0 && addBatch(aClient, path.toString(), payload, mode, aResult, cb, uid.toString()))
+            return true;
+
+        DatabaseOptions options;
+        if (!async && aClient.reqEtag.length() == 0)
+            options.silent = true;
+        async_request_data_t aReq(&aClient, path, mode, slot_options_t(false, false, async, payload.indexOf("\".sv\"") > -1, false, false), &options, nullptr, aResult, cb, uid);
+        asyncRequest(aReq, payload.c_str());
+        if (!async)
+            return aResult->lastError.code() == 0;
+        return true;
+    }
+
+    template <typename T = const char *>
+    void sendAsync(DatabaseRequest &request, const T &value, bool hasValue, AsyncResult *aResult, AsyncResultCallback cb, const StringRef &uid)
+    {
+        AsyncClientClass *aClient = Registry::shared().get<AsyncClientClass>(request.client_handle);
+        bool write = request.method == async_request_handler_t::http_put || request.method == async_request_handler_t::http_patch;
+
+        // The set and update are batched, diffed or queued as they were sent without prepared request.
+        if (aClient && hasValue && write && (diff_write || queue.aClient == aClient || batch_interval_ms > 0))
+        {
+            storeAsync(*aClient, request.path, value, request.method, true, aResult, cb, uid);
+            return;
+        }
+
+        String payload;
+        if (hasValue)
+        {
+            ValueConverter vcon;
+            vcon.getVal<T>(payload, value);
+        }
+
+        async_request_data_t aReq(aClient, request.path, request.method, slot_options_t(false, false, true, payload.indexOf("\".sv\"") > -1, false, false), &request.options, nullptr, aResult, cb, uid);
+        if (!aClient)
+            return setClientError(aReq, FIREBASE_ERROR_TCP_CLIENT_UNDEFINED);
+
+        aReq.prepared = &request;
+        asyncRequest(aReq, payload.c_str());
+    }
+
+    // Returns true when the path starts with the URL of database instance e.g. "https://other-db.firebaseio.com/path".
+    bool isInstanceUrl(const StringRef &path)
+    {
+        for (size_t i = 0; i + 2 < path.length() && path[i] != '/'; i++)
+        {
+            if (path[i] == ':' && path[i + 1] == '/' && path[i + 2] == '/')
+                return true;
+        }
+        return false;
+    }
+
+    // Split the path that starts with the URL of database instance to the database host and node path, false when
+    // the URL is not https or its host is not Realtime Database host (the token is not sent to the other hosts).
+    bool routeInstance(const StringRef &path, String &url, String &node)
+    {
+        if (!isInstanceUrl(path))
+            return false;
+        path.assignTo(url);
+        int p = url.indexOf('/', 8);
+        node = p > -1 ? url.substring(p) : String("/");
+        if (p > -1)
+            url.remove(p);
+        if (!url.startsWith("https://") || !isInstanceHost(url.substring(8)))
+        {
+            url.remove(0, url.length());
+            node.remove(0, node.length());
+            return false;
+        }
+        url.remove(0, 8);
+        return true;
+    }
+
+    // Returns true when the host is the host of database URL or *.firebaseio.com and *.firebasedatabase.app host.
+    bool isInstanceHost(const String &host)
+    {
+        for (size_t i = 0; i < host.length(); i++)
+        {
+            char c = host[i];
+            if (!((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '.'))
+                return false;
+        }
+        URLUtil uut;
+        String db = service_url;
+        return host.endsWith(".firebaseio.com") || host.endsWith(".firebasedatabase.app") || (host.length() && host == uut.getHost(db));
+    }
+
+    // Normalize the node path without leading and trailing slashes.
+    String batchPath(const String &path)
+    {
+        String out = path;
+        out.trim();
+        while (out.length() && out[0] == '/')
+            out.remove(0, 1);
+        while (out.length() && out[out.length() - 1] == '/')
+            out.remove(out.length() - 1, 1);
+        return out;
+    }
+
+    // Returns true if the node paths are the same or one is the ancestor of another.
+    bool isOverlapped(const String &a, const String &b)
+    {
+        if (a.length() == 0 || b.length() == 0)
+            return true;
+        const String &s = a.length() < b.length() ? a : b;
+        const String &l = a.length() < b.length() ? b : a;
+        return l.startsWith(s) && (l.length() == s.length() || l[s.length()] == '/');
+    }
+
+    // Parse the top level members of JSON object, returns false if it is not a (non-empty) JSON object.
+    bool parseMembers(const String &json, std::vector<String> &keys, std::vector<String> &values)
+    {
+        size_t i = 0, len = json.length();
+        while (i < len && isspace(json[i]))
+            i++;
+        if (i == len || json[i] != '{')
+            return false;
+        i++;
+
+        while (i < len)
+        {
+            while (i < len && isspace(json[i]))
+                i++;
+            if (i == len || json[i] != '"')
+                break;
+
+            size_t k = ++i;
+            while (i < len && json[i] != '"')
+                i += json[i] == '\\' ? 2 : 1;
+            if (i >= len)
+                break;
+            String key = json.substring(k, i++);
+
+            while (i < len && isspace(json[i]))
+                i++;
+            if (i == len || json[i] != ':')
+                break;
+
+            size_t v = ++i;
+            int depth = 0;
+            bool str = false;
+            while (i < len)
+            {
+                char c = json[i];
+                if (str)
+                {
+                    if (c == '\\')
+                        i++;
+                    else if (c == '"')
+                        str = false;
+                }
+                else if (c == '"')
+                    str = true;
+                else if (c == '{' || c == '[')
+                    depth++;
+                else if (c == '}' || c == ']')
+                {
+                    if (depth == 0)
+                        break;
+                    depth--;
+                }
+                else if (c == ',' && depth == 0)
+                    break;
+                i++;
+            }
+
+            if (i >= len)
+                break;
+
+            String value = json.substring(v, i);
+            value.trim();
+            keys.push_back(key);
+            values.push_back(value);
+
+            if (json[i++] == '}')
+                return keys.size() > 0;
+        }
+
+        keys.clear();
+        values.clear();
+        return false;
+    }
+
+    // Split the set and update to the node paths and values of multi-location update, returns false if it is not possible.
+    bool splitWrite(const String &path, const String &payload, async_request_handler_t::http_request_method mode, std::vector<String> &paths, std::vector<String> &values)
+    {
+        String node = batchPath(path);
+
+        if (mode == async_request_handler_t::http_put)
+        {
+            if (node.length() == 0)
+                return false;
+            paths.push_back(node);
+            values.push_back(payload);
+        }
+        else if (mode == async_request_handler_t::http_patch && parseMembers(payload, paths, values))
+        {
+            for (size_t i = 0; i < paths.size(); i++)
+                paths[i] = node.length() ? node + "/" + batchPath(paths[i]) : batchPath(paths[i]);
+        }
+        else
+            return false;
+        return true;
+    }
+
+    // Add the write to batch, returns false if the write should be sent directly.
+    bool addBatch(AsyncClientClass &aClient, const String &path, const String &payload, async_request_handler_t::http_request_method mode, AsyncResult *aResult, AsyncResultCallback cb, const String &uid)
+    {
+        std::vector<String> paths, values;
+        if (!splitWrite(path, payload, mode, paths, values))
+            return false;
+
+        // The writes to other client or overlapped node paths require the pending writes to be sent first.
+        if (batch && batch->aClient != &aClient)
+            flushBatch();
+
+        for (size_t i = 0; batch && i < batch->paths.size(); i++)
+        {
+            for (size_t j = 0; j < paths.size(); j++)
+            {
+                if (isOverlapped(batch->paths[i], paths[j]))
+                {
+                    flushBatch();
+                    break;
+                }
+            }
+        }
+
+        if (!batch)
+        {
+            batch = new write_batch_t();
+            batch->aClient = &aClient;
+            batch->ms = millis();
+        }
+
+        for (size_t i = 0; i < paths.size(); i++)
+        {
+            batch->paths.push_back(paths[i]);
+            batch->values.push_back(values[i]);
+        }
+
+        write_batch_item_t item;
+        item.aResult = aResult;
+        item.cb = cb;
+        item.uid = uid;
+        batch->items.push_back(item);
+        batch->sv |= payload.indexOf("\".sv\"") > -1;
+
+        if (batch->items.size() >= batch_count)
+            flushBatch();
+
+        return true;
+    }
+
+    // Collect the leaf values of JSON value, the primitive, array and empty object are the leaves.
+    void collectLeaves(const String &payload, const json_span_t &span, const String &rel, uint32_t top, std::vector<diff_leaf_t> &leaves, std::vector<String> &paths, std::vector<json_span_t> &spans)
+    {
+        if (leaves.size() > FIREBASE_RTDB_DIFF_LEAF_LIMIT)
+            return;
+
+        JsonPullParser parser(payload.c_str() + span.start, span.length());
+        if (parser.next() == json_token_object_begin)
+        {
+            uint8_t level = parser.depth();
+            size_t members = 0;
+            while (parser.next() == json_token_key && parser.depth() == level)
+            {
+                json_span_t key = parser.span();
+                parser.next();
+                json_span_t val = parser.skipValue();
+                if (!val.valid())
+                    return;
+
+                String child = rel;
+                if (child.length())
+                    child += '/';
+                for (int i = key.start; i < key.end; i++)
+                    child += payload[span.start + i];
+
+                json_span_t s;
+                s.start = span.start + val.start;
+                s.end = span.start + val.end;
+                collectLeaves(payload, s, child, rel.length() ? top : FNV1a::hash(child.c_str(), child.length()), leaves, paths, spans);
+                members++;
+            }
+            if (members)
+                return;
+        }
+
+        diff_leaf_t leaf;
+        leaf.top = top;
+        leaf.path = FNV1a::hash(rel.c_str(), rel.length());
+        leaf.value = FNV1a::hash(payload.c_str() + span.start, span.length());
+        leaves.push_back(leaf);
+        paths.push_back(rel);
+        spans.push_back(span);
+    }
+
+    int findDiff(const String &path)
+    {
+        for (size_t i = 0; i < diffVec.size(); i++)
+        {
+            if (diffVec[i].path == path)
+                return i;
+        }
+        return -1;
+    }
+
+    // Remove the leaves of nodes that overlapped with the node path, the leaves of the same node path are kept if keepNode is true.
+    void removeDiff(const StringRef &path, bool keepNode = false)
+    {
+        if (diffVec.size() == 0)
+            return;
+        String node = batchPath(path.toString());
+        for (size_t i = diffVec.size(); i > 0; i--)
+        {
+            if (isOverlapped(diffVec[i - 1].path, node) && !(keepNode && diffVec[i - 1].path == node))
+                diffVec.erase(diffVec.begin() + i - 1);
+        }
+    }
+
+    // Send the changed leaves of JSON object as multi-location update, returns false if the write should be sent directly.
+    bool addDiff(AsyncClientClass &aClient, const String &path, const String &payload, async_request_handler_t::http_request_method mode, AsyncResult *aResult, AsyncResultCallback cb, const String &uid)
+    {
+        String node = batchPath(path);
+        std::vector<String> tops, topValues;
+        if (node.length() == 0 || !splitWrite(path, payload, mode == async_request_handler_t::http_put ? async_request_handler_t::http_patch : mode, tops, topValues))
+            return false;
+
+        std::vector<diff_leaf_t> leaves;
+        std::vector<String> rels;
+        std::vector<json_span_t> spans;
+        json_span_t all;
+        all.start = 0;
+        all.end = payload.length();
+        collectLeaves(payload, all, "", 0, leaves, rels, spans);
+        if (leaves.size() == 0 || leaves.size() > FIREBASE_RTDB_DIFF_LEAF_LIMIT)
+            return false;
+
+        removeDiff(node, true);
+        int index = findDiff(node);
+
+        // The next write before the previous write was acknowledged.
+        if (index > -1 && diffVec[index].pending)
+        {
+            diffVec.erase(diffVec.begin() + index);
+            return false;
+        }
+
+        if (batch)
+            flushBatch();
+
+        write_batch_t *b = new write_batch_t();
+        b->aClient = &aClient;
+        b->sv = payload.indexOf("\".sv\"") > -1;
+        b->diff_path = node;
+        b->diff_set = mode == async_request_handler_t::http_put;
+        b->diff_leaves = leaves;
+
+        std::vector<uint32_t> topHashes;
+        for (size_t i = 0; i < tops.size(); i++)
+        {
+            String key = tops[i].substring(node.length() + 1);
+            topHashes.push_back(FNV1a::hash(key.c_str(), key.length()));
+        }
+        b->diff_tops = topHashes;
+
+        diff_node_t *prev = index > -1 ? &diffVec[index] : nullptr;
+        bool full = !prev || (b->diff_set && !prev->complete);
+
+        // The leaves of the last object that are not in the set object.
+        for (size_t i = 0; prev && !full && b->diff_set && i < prev->leaves.size(); i++)
+        {
+            bool found = false;
+            for (size_t j = 0; j < topHashes.size() && !found; j++)
+                found = prev->leaves[i].top == topHashes[j];
+            full = !found;
+        }
+
+        if (full && b->diff_set)
+        {
+            b->paths.push_back(node);
+            b->values.push_back(payload);
+        }
+        else
+        {
+            for (size_t t = 0; t < tops.size(); t++)
+            {
+                // The object at top level key is sent when some of its last leaves were removed.
+                size_t stored = 0, matched = 0;
+                for (size_t i = 0; prev && i < prev->leaves.size(); i++)
+                    stored += prev->leaves[i].top == topHashes[t];
+
+                std::vector<size_t> changed;
+                for (size_t i = 0; i < leaves.size(); i++)
+                {
+                    if (leaves[i].top != topHashes[t])
+                        continue;
+                    bool same = false;
+                    for (size_t j = 0; prev && j < prev->leaves.size(); j++)
+                    {
+                        if (prev->leaves[j].path == leaves[i].path)
+                        {
+                            matched++;
+                            same = prev->leaves[j].value == leaves[i].value;
+                            break;
+                        }
+                    }
+                    if (!same)
+                        changed.push_back(i);
+                }
+
+                if (full || stored == 0 || stored > matched)
+                {
+                    b->paths.push_back(tops[t]);
+                    b->values.push_back(topValues[t]);
+                }
+                else
+                {
+                    for (size_t i = 0; i < changed.size(); i++)
+                    {
+                        b->paths.push_back(node + "/" + rels[changed[i]]);
+                        b->values.push_back(payload.substring(spans[changed[i]].start, spans[changed[i]].end));
+                    }
+                }
+            }
+        }
+
+        write_batch_item_t item;
+        item.aResult = aResult;
+        item.cb = cb;
+        item.uid = uid;
+        b->items.push_back(item);
+
+        if (index == -1)
+        {
+            diff_node_t n;
+            n.path = node;
+            diffVec.push_back(n);
+            index = diffVec.size() - 1;
+        }
+        diffVec[index].pending = true;
+
+        if (b->paths.size() == 0)
+        {
+            // No changed value.
+            b->result.setPayload("{}");
+            b->result.setDebug(FPSTR("No changed value to write"));
+            List vec;
+            vec.addRemoveList(batchVec, b, true);
+            return true;
+        }
+
+        sendBatch(b);
+        return true;
+    }
+
+    // Keep the leaves of acknowledged write, the leaves are removed when the write was failed.
+    void handleDiffResult(write_batch_t *b)
+    {
+        int index = findDiff(b->diff_path);
+        if (index == -1)
+            return;
+
+        if (b->result.error_available)
+        {
+            diffVec.erase(diffVec.begin() + index);
+            return;
+        }
+
+        diff_node_t &n = diffVec[index];
+        n.pending = false;
+        if (b->diff_set)
+        {
+            n.leaves = b->diff_leaves;
+            n.complete = true;
+            return;
+        }
+
+        for (size_t i = n.leaves.size(); i > 0; i--)
+        {
+            for (size_t j = 0; j < b->diff_tops.size(); j++)
+            {
+                if (n.leaves[i - 1].top == b->diff_tops[j])
+                {
+                    n.leaves.erase(n.leaves.begin() + i - 1);
+                    break;
+                }
+            }
+        }
+        n.leaves.insert(n.leaves.end(), b->diff_leaves.begin(), b->diff_leaves.end());
+
+        if (n.leaves.size() > FIREBASE_RTDB_DIFF_LEAF_LIMIT)
+            diffVec.erase(diffVec.begin() + index);
+    }
+
+    // Add the write to offline queue, returns false if the write should be sent directly.
+    bool addQueue(const String &path, const String &payload, async_request_handler_t::http_request_method mode, AsyncResult *aResult, AsyncResultCallback cb, const String &uid)
+    {
+        std::vector<String> paths, values;
+        if (!splitWrite(path, payload, mode, paths, values))
+            return false;
+
+        // Keep the order of writes in batch and queue.
+        if (batch)
+            flushBatch();
+
+        write_batch_item_t item;
+        item.aResult = aResult;
+        item.cb = cb;
+        item.uid = uid;
+
+        for (size_t i = 0; i < paths.size(); i++)
+        {
+            // The new line is not allowed in the queue file line, it is the whitespace in JSON.
+            values[i].replace("\n", " ");
+            enqueue(paths[i], values[i], i == paths.size() - 1 ? &item : nullptr);
+#if defined(ENABLE_FS)
+            appendQueue(paths[i], values[i]);
+#endif
+        }
+        return true;
+    }
+
+    void enqueue(const String &path, const String &value, write_batch_item_t *item)
+    {
+        write_queue_entry_t entry;
+        entry.path = path;
+        entry.value = value;
+
+        // The pending writes at the same or child node path are replaced, except the entry that is being sent.
+        size_t sent = queue.sending ? sendingCount() : 0;
+        for (size_t i = queue.entries.size(); i > sent; i--)
+        {
+            write_queue_entry_t &e = queue.entries[i - 1];
+            if (isOverlapped(e.path, path) && e.path.length() >= path.length())
+            {
+                entry.items.insert(entry.items.end(), e.items.begin(), e.items.end());
+                queue.entries.erase(queue.entries.begin() + i - 1);
+            }
+        }
+
+        if (item)
+            entry.items.push_back(*item);
+        queue.entries.push_back(entry);
+
+        if (queue.entries.size() > FIREBASE_RTDB_WRITE_QUEUE_LIMIT && queue.entries.size() > sent + 1)
+        {
+            notifyQueue(queue.entries[sent], FIREBASE_ERROR_OPERATION_CANCELLED);
+            queue.entries.erase(queue.entries.begin() + sent);
+        }
+    }
+
+    // The numbers of entries in the batch that is being sent.
+    size_t sendingCount()
+    {
+        for (size_t i = 0; i < batchVec.size(); i++)
+        {
+            write_batch_t *b = batchVec[i];
+            if (b && b->queued > 0)
+                return b->queued;
+        }
+        return 0;
+    }
+
+    void notifyQueue(write_queue_entry_t &entry, int code) { notifyItems(entry.items, code); }
+
+    // Return the client error to the writes.
+    void notifyItems(std::vector<write_batch_item_t> &items, int code)
+    {
+        AsyncResult result;
+        result.error_available = true;
+        result.lastError.setClientError(code);
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            result.setUID(items[i].uid);
+            if (items[i].aResult)
+                *items[i].aResult = result;
+            if (items[i].cb)
+                items[i].cb(result);
+        }
+    }
+
+    // Send the first entries that their node paths are not overlapped as one multi-location update.
+    void handleQueue()
+    {
+        if (!queue.aClient || queue.sending || queue.entries.size() == 0 || (queue.ms > 0 && millis() - queue.ms < FIREBASE_RTDB_WRITE_QUEUE_RETRY) || !queue.aClient->networkStatus())
+            return;
+
+        write_batch_t *b = new write_batch_t();
+        b->aClient = queue.aClient;
+        for (size_t i = 0; i < queue.entries.size() && b->paths.size() < queue.count; i++)
+        {
+            bool overlapped = false;
+            for (size_t j = 0; j < b->paths.size() && !overlapped; j++)
+                overlapped = isOverlapped(b->paths[j], queue.entries[i].path);
+            if (overlapped)
+                break;
+            b->paths.push_back(queue.entries[i].path);
+            b->values.push_back(queue.entries[i].value);
+            b->sv |= queue.entries[i].value.indexOf("\".sv\"") > -1;
+        }
+        b->queued = b->paths.size();
+        queue.sending = true;
+        sendBatch(b);
+    }
+
+    // Remove the sent entries unless the network or server error that can be retried,
+    // the entries that were failed for FIREBASE_RTDB_WRITE_QUEUE_ATTEMPTS attempts are removed with this error.
+    void handleQueueResult(write_batch_t *b)
+    {
+        queue.sending = false;
+        int code = b->result.error_available ? b->result.lastError.code() : 0;
+        size_t n = b->queued < queue.entries.size() ? b->queued : queue.entries.size();
+        if (code < 0 || code == FIREBASE_ERROR_HTTP_CODE_UNAUTHORIZED || code >= 500)
+        {
+            queue.ms = millis();
+#if defined(ENABLE_FS)
+            size_t size = queue.entries.size();
+#endif
+            for (size_t i = n; i > 0; i--)
+            {
+                write_queue_entry_t &e = queue.entries[i - 1];
+                if (FIREBASE_RTDB_WRITE_QUEUE_ATTEMPTS == 0 || ++e.attempts < FIREBASE_RTDB_WRITE_QUEUE_ATTEMPTS)
+                    continue;
+                b->items.insert(b->items.end(), e.items.begin(), e.items.end());
+                queue.entries.erase(queue.entries.begin() + i - 1);
+            }
+#if defined(ENABLE_FS)
+            if (queue.entries.size() != size)
+                saveQueue();
+#endif
+            return;
+        }
+
+        queue.ms = 0;
+        for (size_t i = 0; i < n; i++)
+            b->items.insert(b->items.end(), queue.entries[i].items.begin(), queue.entries[i].items.end());
+        queue.entries.erase(queue.entries.begin(), queue.entries.begin() + n);
+#if defined(ENABLE_FS)
+        saveQueue();
+#endif
+    }
+
+#if defined(ENABLE_FS)
+    void appendQueue(const String &path, const String &value)
+    {
+        if (!queue.file.cb || !queue.file.filename.length())
+            return;
+        queue.file.cb(queue.file.file, queue.file.filename.c_str(), file_mode_open_append);
+        if (!queue.file.file)
+            return;
+        queue.file.file.print(path);
+        queue.file.file.print('\t');
+        queue.file.file.print(value);
+        queue.file.file.print('\n');
+        queue.file.file.close();
+    }
+
+    // Rewrite the file with the entries in queue, the file is removed when the queue is empty.
+    void saveQueue()
+    {
+        if (!queue.file.cb || !queue.file.filename.length())
+            return;
+
+        if (queue.entries.size() == 0)
+        {
+            queue.file.cb(queue.file.file, queue.file.filename.c_str(), file_mode_remove);
+            return;
+        }
+
+        queue.file.cb(queue.file.file, queue.file.filename.c_str(), file_mode_open_write);
+        if (!queue.file.file)
+            return;
+        for (size_t i = 0; i < queue.entries.size(); i++)
+        {
+            queue.file.file.print(queue.entries[i].path);
+            queue.file.file.print('\t');
+            queue.file.file.print(queue.entries[i].value);
+            queue.file.file.print('\n');
+        }
+        queue.file.file.close();
+    }
+
+    // Load the writes that were stored in the file, the replaced writes are removed from the file.
+    void loadQueue()
+    {
+        if (!queue.file.cb || !queue.file.filename.length())
+            return;
+
+        queue.file.cb(queue.file.file, queue.file.filename.c_str(), file_mode_open_read);
+        if (!queue.file.file)
+            return;
+
+        String line;
+        while (queue.file.file.available())
+        {
+            int c = queue.file.file.read();
+            if (c < 0)
+                break;
+            if (c != '\n')
+            {
+                line += (char)c;
+                continue;
+            }
+            int p = line.indexOf('\t');
+            if (p > 0)
+                enqueue(line.substring(0, p), line.substring(p + 1), nullptr);
+            line.remove(0, line.length());
+        }
+        queue.file.file.close();
+        saveQueue();
+    }
+#endif
+
+    void flushBatch()
+    {
+        write_batch_t *b = batch;
+        batch = nullptr;
+        sendBatch(b);
+    }
+
+    // Send the pending writes as one multi-location update at their common parent node.
+    void sendBatch(write_batch_t *b)
+    {
+        if (!b)
+            return;
+
+        if (b->paths.size() == 0)
+        {
+            delete b;
+            return;
+        }
+
+        String parent = b->paths[0].lastIndexOf('/') > -1 ? b->paths[0].substring(0, b->paths[0].lastIndexOf('/')) : "";
+        for (size_t i = 1; i < b->paths.size() && parent.length(); i++)
+        {
+            while (parent.length() && !(b->paths[i].startsWith(parent) && b->paths[i][parent.length()] == '/'))
+                parent = parent.lastIndexOf('/') > -1 ? parent.substring(0, parent.lastIndexOf('/')) : "";
+        }
+
+        String payload = "{";
+        for (size_t i = 0; i < b->paths.size(); i++)
+        {
+            if (i > 0)
+                payload += ',';
+            payload += '"';
+            payload += parent.length() ? b->paths[i].substring(parent.length() + 1) : b->paths[i];
+            payload += "\":";
+            payload += b->values[i];
+        }
+        payload += '}';
+
+        b->paths.clear();
+        b->values.clear();
+
+        List vec;
+        vec.addRemoveList(batchVec, b, true);
+
+        DatabaseOptions options;
+        String path = "/" + parent;
+        async_request_data_t aReq(b->aClient, path, async_request_handler_t::http_patch, slot_options_t(false, false, true, b->sv, false, false), &options, nullptr, &b->result, NULL);
+        asyncRequest(aReq, payload.c_str());
+    }
+
+    // Send the pending writes when time window was reached and return the batch results to the writes.
+    void handleBatch()
+    {
+        if (batch && (batch_interval_ms == 0 || millis() - batch->ms >= batch_interval_ms))
+            flushBatch();
+
+        for (size_t i = batchVec.size(); i > 0; i--)
+        {
+            write_batch_t *b = batchVec[i - 1];
+            if (!b || (!b->result.data_available && !b->result.error_available))
+                continue;
+
+            if (b->queued > 0)
+                handleQueueResult(b);
+
+            if (b->diff_path.length())
+                handleDiffResult(b);
+
+            for (size_t j = 0; j < b->items.size(); j++)
+            {
+                b->result.setUID(b->items[j].uid);
+                if (b->items[j].aResult)
+                    *b->items[j].aResult = b->result;
+                if (b->items[j].cb)
+                    b->items[j].cb(b->result);
+            }
+
+            batchVec.erase(batchVec.begin() + i - 1);
+            delete b;
+        }
+    }
+
+    // Request the page of iteration into the current result.
+    void requestPage(iterate_task_t *t)
+    {
+        DatabaseOptions options;
+        options.filter.orderBy("$key");
+        // The first child of next page is the last child of previous page.
+        if (t->last.length())
+            options.filter.startAt(t->last).limitToFirst(t->size + 1);
+        else
+            options.filter.limitToFirst(t->size);
+
+        AsyncResult &r = t->result[t->current];
+        r.clear();
+        r.error_available = false;
+        async_request_data_t aReq(t->aClient, t->path, async_request_handler_t::http_get, slot_options_t(false, false, true, false, false, false), &options, nullptr, &r, NULL);
+        asyncRequest(aReq);
+    }
+
+    static bool intKey(const char *s, size_t len, int64_t &v)
+    {
+        size_t i = len > 0 && s[0] == '-' ? 1 : 0;
+        if (i >= len || len - i > 10 || (s[i] == '0' && (len - i > 1 || i > 0)))
+            return false;
+        v = 0;
+        for (; i < len; i++)
+        {
+            if (s[i] < '0' || s[i] > '9')
+                return false;
+            v = v * 10 + (s[i] - '0');
+        }
+        if (s[0] == '-')
+            v = -v;
+        return v >= -2147483648LL && v <= 2147483647LL;
+    }
+
+    // The order of orderBy="$key", the 32-bit integer keys are first in numeric order then the other keys in lexicographical order.
+    static bool keyLess(const char *a, size_t alen, const char *b, size_t blen)
+    {
+        int64_t ia = 0, ib = 0;
+        bool na = intKey(a, alen, ia), nb = intKey(b, blen, ib);
+        if (na != nb)
+            return na;
+        if (na)
+            return ia < ib;
+        int c = strncmp(a, b, alen < blen ? alen : blen);
+        return c < 0 || (c == 0 && alen < blen);
+    }
+
+    // Collect the children of page in key order, the server does not keep the order in JSON object.
+    void parsePage(const String &payload, std::vector<json_span_t> &keys, std::vector<json_span_t> &values)
+    {
+        JsonPullParser parser(payload);
+        if (parser.next() != json_token_object_begin)
+            return;
+
+        uint8_t level = parser.depth();
+        while (parser.next() == json_token_key && parser.depth() == level)
+        {
+            json_span_t key = parser.span();
+            parser.next();
+            json_span_t val = parser.skipValue();
+            if (!val.valid())
+                return;
+
+            size_t pos = keys.size();
+            while (pos > 0 && keyLess(payload.c_str() + key.start, key.length(), payload.c_str() + keys[pos - 1].start, keys[pos - 1].length()))
+                pos--;
+            keys.insert(keys.begin() + pos, key);
+            values.insert(values.begin() + pos, val);
+        }
+    }
+
+    void handleIterate()
+    {
+        for (size_t i = iterVec.size(); i > 0; i--)
+        {
+            iterate_task_t *t = iterVec[i - 1];
+            if (!t || (!t->result[t->current].data_available && !t->result[t->current].error_available))
+                continue;
+
+            AsyncResult &r = t->result[t->current];
+
+            std::vector<json_span_t> keys, values;
+            if (!r.error_available)
+                parsePage(r.payload_val, keys, values);
+
+            String prev = t->last;
+            bool more = keys.size() > 0 && keys.size() >= (prev.length() ? (size_t)t->size + 1 : t->size);
+
+            // Prefetch the next page before delivering the children of this page.
+            if (more)
+            {
+                t->last = r.payload_val.substring(keys.back().start, keys.back().end);
+                t->current ^= 1;
+                requestPage(t);
+            }
+
+            for (size_t j = 0; j < keys.size(); j++)
+            {
+                String key = r.payload_val.substring(keys[j].start, keys[j].end);
+                if (j == 0 && prev.length() && key == prev)
+                    continue;
+                if (t->childCb)
+                    t->childCb(key, r.payload_val.substring(values[j].start, values[j].end));
+            }
+
+            if (more)
+            {
+                r.clear();
+                continue;
+            }
+
+            if (!r.error_available)
+            {
+                r.payload_val.remove(0, r.payload_val.length());
+                r.setDebug(FPSTR("Iteration complete"));
+            }
+            r.setUID(t->uid);
+            if (t->cb)
+                t->cb(r);
+
+            iterVec.erase(iterVec.begin() + i - 1);
+            delete t;
+        }
+    }
+
+    // Queue the field requests of the children that fit in the window.
+    void requestFields(select_task_t *t)
+    {
+        size_t total = t->keys.size() * t->fields.size();
+        while (!t->failed && t->next < total && t->next < t->child * t->fields.size() + t->window.size())
+        {
+            AsyncResult &r = t->window[t->next % t->window.size()];
+            r.clear();
+            r.error_available = false;
+            String path = t->path;
+            path += '/';
+            path += t->keys[t->next / t->fields.size()];
+            path += '/';
+            path += t->fields[t->next % t->fields.size()];
+            t->next++;
+            async_request_data_t aReq(t->aClient, path, async_request_handler_t::http_get, slot_options_t(false, false, true, false, false, false), nullptr, nullptr, &r, NULL, t->uid);
+            asyncRequest(aReq);
+        }
+    }
+
+    void handleSelect()
+    {
+        for (size_t i = selectVec.size(); i > 0; i--)
+        {
+            select_task_t *t = selectVec[i - 1];
+            if (!t)
+                continue;
+
+            if (!t->listed)
+            {
+                if (!t->result.data_available && !t->result.error_available)
+                    continue;
+                t->listed = true;
+                t->failed = t->result.error_available;
+                if (t->fields.size() == 0)
+                    t->keys.clear();
+            }
+
+            // Deliver the children that all fields were received.
+            size_t nfields = t->fields.size();
+            while (!t->failed && t->child < t->keys.size() && (t->child + 1) * nfields <= t->next)
+            {
+                String value;
+                bool ready = true;
+                for (size_t f = 0; f < nfields && ready; f++)
+                {
+                    AsyncResult &r = t->window[(t->child * nfields + f) % t->window.size()];
+                    ready = r.data_available || r.error_available;
+                    if (r.error_available)
+                    {
+                        t->failed = true;
+                        t->result = r;
+                    }
+                    else if (ready && r.payload_val.length() && r.payload_val != "null")
+                    {
+                        value += value.length() ? ',' : '{';
+                        value += '"';
+                        value += t->fields[f];
+                        value += FPSTR("\":");
+                        value += r.payload_val;
+                    }
+                }
+
+                if (!ready || t->failed)
+                    break;
+
+                value += value.length() ? "}" : "null";
+                if (t->childCb)
+                    t->childCb(t->keys[t->child], value);
+                t->child++;
+            }
+
+            requestFields(t);
+
+            // The error is returned when the requests that were sent were completed.
+            bool pending = false;
+            for (size_t j = t->child * nfields; j < t->next; j++)
+            {
+                AsyncResult &r = t->window[j % t->window.size()];
+                if (!r.data_available && !r.error_available)
+                    pending = true;
+            }
+
+            if (pending || (!t->failed && t->child < t->keys.size()))
+                continue;
+
+            if (!t->failed)
+            {
+                t->result.clear();
+                t->result.error_available = false;
+                t->result.setDebug(FPSTR("Select complete"));
+            }
+            t->result.setUID(t->uid);
+            if (t->cb)
+                t->cb(t->result);
+
+            selectVec.erase(selectVec.begin() + i - 1);
+            delete t;
+        }
+    }
+
+    void asyncRequest(async_request_data_t &request, const char *payload = "")
+    {
+        AsyncClientClass::SlotGuard guard(request.aClient);
+        // Keep the order of writes in batch and other requests.
+        if (batch)
+            flushBatch();
+
+        app_token_t *app_token = appToken();
 
         if (!app_token)
             return setClientError(request, FIREBASE_ERROR_APP_WAS_NOT_ASSIGNED);
 
         request.opt.app_token = app_token;
         request.opt.auth_param = app_token->auth_data_type != user_auth_data_no_token && app_token->auth_type != auth_access_token && app_token->auth_type != auth_sa_access_token;
-        String extras = request.opt.auth_param ? ".json?auth=" + String(FIREBASE_AUTH_PLACEHOLDER) : ".json";
 
-        addParams(request.opt.auth_param, extras, request.method, request.options, request.file);
+        // The path that starts with the URL of other database instance is routed to its host, the connection pool of
+        // async client keeps the connection of each host.
+        String instance_url, instance_path;
+        if (routeInstance(request.path, instance_url, instance_path))
+            request.path = instance_path;
+        else if (isInstanceUrl(request.path))
+            return setClientError(request, FIREBASE_ERROR_INVALID_ARGUMENT);
+        const String &url = instance_url.length() ? instance_url : service_url;
+
+        // The cached header of prepared request is reused when the host and auth were not changed.
+        DatabaseRequest *prepared = request.prepared && request.aClient->isPreparable(request.method, request.opt) ? request.prepared : nullptr;
+        bool reuse = prepared && prepared->prepared() && prepared->url == url && prepared->auth_type == app_token->auth_type && prepared->auth_param == request.opt.auth_param &&
+                     prepared->encoding == request.aClient->encodingOptions();
+
+        String extras;
+        if (!reuse)
+        {
+            extras = request.opt.auth_param ? ".json?auth=" + String(FIREBASE_AUTH_PLACEHOLDER) : ".json";
+            addParams(request.opt.auth_param, extras, request.method, request.options, request.file);
+        }
 
         async_data_item_t *sData = request.aClient->createSlot(request.opt);
 
         if (!sData)
             return setClientError(request, FIREBASE_ERROR_OPERATION_CANCELLED);
 
-        request.aClient->newRequest(sData, service_url, request.path, extras, request.method, request.opt, request.uid);
+        if (reuse)
+            request.aClient->newPreparedRequest(sData, url, request.path, prepared->header, request.method, request.opt, request.uid);
+        else
+            request.aClient->newRequest(sData, url, request.path, extras, request.method, request.opt, request.uid);
+
+        // The header is kept before the payload headers were added.
+        if (prepared && !reuse)
+        {
+            prepared->header = sData->request.val[req_hndlr_ns::header];
+            prepared->url = url;
+            prepared->auth_type = app_token->auth_type;
+            prepared->auth_param = request.opt.auth_param;
+            prepared->encoding = request.aClient->encodingOptions();
+        }
 
         if (request.file)
             sData->request.file_data.copy(*request.file);
@@ -987,15 +2750,78 @@ private:
         if (request.cb)
             sData->cb = request.cb;
 
-        request.aClient->addRemoveClientVec(reinterpret_cast<uint32_t>(&(cVec)), true);
+        if (request.mirror)
+        {
+            request.mirror->setPath(request.path.toString());
+            sData->event_handler = onMirrorEvent;
+            // The mirror is resolved from its handle for each event, the mirror that was destroyed is not accessed.
+            sData->event_ctx = reinterpret_cast<void *>(static_cast<uintptr_t>(request.mirror->reg_handle));
+            List vec;
+            vec.addRemoveList(mirrorVec, request.mirror->reg_handle, true);
+        }
+
+        request.aClient->addRemoveClientVec(cVec, true);
 
         if (request.aResult)
-            sData->setRefResult(request.aResult, reinterpret_cast<uint32_t>(&(request.aClient->rVec)));
+            sData->setRefResult(request.aResult);
 
         request.aClient->process(sData->async);
         request.aClient->handleRemove();
     }
 
+    static void onMirrorEvent(void *ctx, AsyncResult &aResult)
+    {
+        RealtimeDatabaseMirror *mirror = Registry::shared().get<RealtimeDatabaseMirror>(static_cast<list_handle_t>(reinterpret_cast<uintptr_t>(ctx)));
+        if (mirror)
+            mirror->apply(aResult);
+    }
+
+    // The sync shallow get that writes the payload to the sink.
+    void getShallow(AsyncClientClass &aClient, const StringRef &path, ShallowSink &sink, AsyncResult &result)
+    {
+        DatabaseOptions options;
+        options.shallow = true;
+        aClient.setPayloadSink(sink);
+        async_request_data_t aReq(&aClient, path, async_request_handler_t::http_get, slot_options_t(false, false, false, false, false, false, true), &options, nullptr, &result, NULL);
+        asyncRequest(aReq);
+        // The sink is not used when the request was not added.
+        aClient.reqSink = nullptr;
+    }
+
+    // Serve the get request from the mirror that keeps the path, the result is returned immediately.
+    bool getMirror(const StringRef &path, AsyncResult *aResult, AsyncResultCallback cb, const StringRef &uid = "")
+    {
+        if (mirrorVec.size() == 0)
+            return false;
+
+        String node = path.toString(), json;
+        bool found = false;
+        for (size_t i = 0; i < mirrorVec.size() && !found;)
+        {
+            RealtimeDatabaseMirror *mirror = Registry::shared().get<RealtimeDatabaseMirror>(mirrorVec[i]);
+            if (!mirror)
+            {
+                mirrorVec.erase(mirrorVec.begin() + i);
+                continue;
+            }
+            found = mirror->get(node, json);
+            i++;
+        }
+
+        if (!found)
+            return false;
+
+        AsyncResult result;
+        AsyncResult *r = aResult ? aResult : &result;
+        r->setUID(uid);
+        r->setPath(node);
+        r->setPayload(json);
+        r->setDebug(FPSTR("The value was read from mirror"));
+        if (cb)
+            cb(*r);
+        return true;
+    }
+
     void addParams(bool hasQueryParams, String &extras, async_request_handler_t::http_request_method method, DatabaseOptions *options, bool isFile)
     {
         URLUtil uut;
@@ -1047,9 +2873,21 @@ private:
                             request.method == async_request_handler_t::http_put ||
                             request.method == async_request_handler_t::http_patch;
         }
+        // The sink consumes the download data.
+        else if (request.file && request.file->sink)
+            sData->download = request.method == async_request_handler_t::http_get;
+        else if (request.file && (request.file->source || (request.file->data && request.file->data_size)))
+        {
+            // The blob and producer source are uploaded from memory.
+            sData->upload = request.method == async_request_handler_t::http_post ||
+                            request.method == async_request_handler_t::http_put ||
+                            request.method == async_request_handler_t::http_patch;
+        }
     }
 };
 
+#include "./database/Telemetry.h"
+
 #endif
 
 #endif
\ No newline at end of file
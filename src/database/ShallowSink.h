@@ -0,0 +1,132 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef ASYNC_DATABASE_SHALLOW_SINK_H
+#define ASYNC_DATABASE_SHALLOW_SINK_H
+
+#include <Arduino.h>
+#include <vector>
+#include "./Config.h"
+
+#if defined(ENABLE_DATABASE)
+
+// The payload sink of shallow request that keeps only the top level keys, the payload is discarded as it arrives.
+class ShallowSink : public Print
+{
+private:
+    std::vector<String> *keys = nullptr;
+    String key, head;
+    size_t count = 0, elements = 0;
+    uint8_t depth = 0;
+    bool in_str = false, esc = false, in_key = false, expect_key = false, expect_value = false, array = false;
+
+public:
+    // The keys are collected to the vector when it was assigned.
+    ShallowSink(std::vector<String> *keys = nullptr) : keys(keys) {}
+
+    size_t write(uint8_t c) override
+    {
+        count++;
+        if (head.length() < 4 && c != ' ' && c != '\r' && c != '\n')
+            head += (char)c;
+
+        if (in_str)
+        {
+            if (esc)
+                esc = false;
+            else if (c == '\\')
+                esc = true;
+            else if (c == '"')
+            {
+                in_str = false;
+                if (in_key)
+                {
+                    keys->push_back(key);
+                    key.remove(0, key.length());
+                    in_key = false;
+                }
+                return 1;
+            }
+            if (in_key)
+                key += (char)c;
+            return 1;
+        }
+
+        if (c == ' ' || c == '\r' || c == '\n' || c == '\t')
+            return 1;
+
+        if (array && depth == 1 && expect_value && c != ']')
+            elements++;
+        expect_value = false;
+
+        if (c == '"')
+        {
+            in_str = true;
+            in_key = keys && depth == 1 && expect_key;
+            expect_key = false;
+        }
+        else if (c == '{' || c == '[')
+        {
+            if (depth == 0)
+                array = c == '[';
+            depth++;
+            expect_key = depth == 1 && c == '{';
+            expect_value = depth == 1 && c == '[';
+        }
+        else if (c == '}' || c == ']')
+        {
+            if (depth > 0)
+                depth--;
+            // The array indices are the keys.
+            if (depth == 0 && array && keys)
+            {
+                for (size_t i = 0; i < elements; i++)
+                    keys->push_back(String(i));
+            }
+        }
+        else if (c == ',' && depth == 1)
+        {
+            expect_key = !array;
+            expect_value = array;
+        }
+        return 1;
+    }
+
+    size_t write(const uint8_t *buf, size_t size) override
+    {
+        for (size_t i = 0; i < size; i++)
+            write(buf[i]);
+        return size;
+    }
+
+    // The numbers of payload bytes that were received.
+    size_t size() const { return count; }
+
+    // The payload is null (the node does not exist).
+    bool isNull() const { return head == "null"; }
+};
+
+#endif
+
+#endif
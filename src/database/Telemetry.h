@@ -0,0 +1,378 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef ASYNC_DATABASE_TELEMETRY_H
+#define ASYNC_DATABASE_TELEMETRY_H
+
+#include <Arduino.h>
+#include <vector>
+#include "./Config.h"
+#include "./core/Number.h"
+#include "./database/RealtimeDatabase.h"
+
+#if defined(ENABLE_DATABASE)
+
+// The default size in bytes of the sample ring buffer of Realtime Database telemetry batcher.
+#if !defined(FIREBASE_RTDB_TELEMETRY_SIZE)
+#define FIREBASE_RTDB_TELEMETRY_SIZE 2048
+#endif
+
+// The client-side push ID generator, the IDs are ordered by the time in ms and the order of generation.
+class RealtimeDatabasePushId
+{
+private:
+    uint64_t last_ms = 0;
+    uint8_t last_rand[12];
+
+public:
+    // Generate the 20 characters push ID of the time in ms since epoch to id.
+    void generate(uint64_t ms, char *id)
+    {
+        static const char chars[] PROGMEM = "-0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ_abcdefghijklmnopqrstuvwxyz";
+
+        // The time is not allowed to go back, then the IDs are always in order.
+        bool same = ms <= last_ms && last_ms > 0;
+        if (same)
+            ms = last_ms;
+        last_ms = ms;
+
+        for (int i = 7; i >= 0; i--)
+        {
+            id[i] = pgm_read_byte(chars + (ms % 64));
+            ms /= 64;
+        }
+
+        if (!same)
+        {
+            for (int i = 0; i < 12; i++)
+                last_rand[i] = random(64);
+        }
+        else
+        {
+            // Increment the random characters of the ID of the same ms.
+            int i = 11;
+            for (; i >= 0 && last_rand[i] == 63; i--)
+                last_rand[i] = 0;
+            if (i >= 0)
+                last_rand[i]++;
+        }
+
+        for (int i = 0; i < 12; i++)
+            id[8 + i] = pgm_read_byte(chars + last_rand[i]);
+        id[20] = 0;
+    }
+};
+
+/**
+ * The batcher of the telemetry samples that are pushed to the Realtime Database node.
+ *
+ * The samples are kept in the binary ring buffer and are written periodically as one update of many children
+ * with the push IDs that are generated from the sample time, instead of one push (POST) request per sample.
+ */
+class RealtimeDatabaseTelemetry
+{
+private:
+    enum sample_type
+    {
+        sample_type_double,
+        sample_type_int,
+        sample_type_json
+    };
+
+    // The record header: type (1), time in ms (6) and data length (2).
+    static const size_t header_size = 9;
+
+    RealtimeDatabase *db = nullptr;
+    AsyncClientClass *client = nullptr;
+    String path;
+    std::vector<uint8_t> buf;
+    // The sending bytes and records are of the batch that was written or is retried, they are not dropped.
+    size_t head = 0, count = 0, sending = 0, records = 0, sending_records = 0;
+    uint32_t interval_ms = 0, dropped = 0, sent = 0, flush_ms = 0;
+    uint16_t max_records = 0;
+    int8_t decimals = -1;
+    TimeStatusCallback time_cb = NULL;
+    uint64_t time_base_ms = 0;
+    RealtimeDatabasePushId push_id;
+    String payload;
+    bool in_flight = false;
+    AsyncResult result;
+
+    void put(size_t pos, const uint8_t *data, size_t len)
+    {
+        for (size_t i = 0; i < len; i++)
+            buf[(pos + i) % buf.size()] = data[i];
+    }
+
+    void get(size_t pos, uint8_t *data, size_t len) const
+    {
+        for (size_t i = 0; i < len; i++)
+            data[i] = buf[(pos + i) % buf.size()];
+    }
+
+    void recordHeader(size_t pos, uint8_t &type, uint64_t &ms, uint16_t &len) const
+    {
+        uint8_t h[header_size];
+        get(pos, h, header_size);
+        type = h[0];
+        ms = 0;
+        for (int i = 6; i >= 1; i--)
+            ms = (ms << 8) | h[i];
+        len = h[7] | (h[8] << 8);
+    }
+
+    // Remove the oldest record that is not being sent.
+    bool dropOldest()
+    {
+        if (count == sending)
+            return false;
+        uint8_t type;
+        uint64_t ms;
+        uint16_t len;
+        size_t pos = (head + sending) % buf.size();
+        recordHeader(pos, type, ms, len);
+        size_t size = header_size + len;
+        // Move the records that are being sent over the dropped record.
+        for (size_t i = sending; i > 0; i--)
+            buf[(head + i - 1 + size) % buf.size()] = buf[(head + i - 1) % buf.size()];
+        head = (head + size) % buf.size();
+        count -= size;
+        records--;
+        dropped++;
+        return true;
+    }
+
+    uint64_t now()
+    {
+        if (time_cb)
+        {
+            uint32_t ts = 0;
+            time_cb(ts);
+            // The time base is set once from the time in seconds, the ms are counted by millis.
+            if (ts > 0 && (time_base_ms == 0 || (uint64_t)ts * 1000 > time_base_ms + millis() + 2000 || (uint64_t)ts * 1000 + 2000 < time_base_ms + millis()))
+                time_base_ms = (uint64_t)ts * 1000 - millis();
+        }
+        return time_base_ms ? time_base_ms + millis() : 0;
+    }
+
+    bool addRecord(uint8_t type, uint64_t ms, const uint8_t *data, size_t len)
+    {
+        size_t size = header_size + len;
+        if (!buf.size() || size > buf.size() || len > 0xffff || (ms == 0 && (ms = now()) == 0))
+        {
+            dropped++;
+            return false;
+        }
+
+        while (buf.size() - count < size)
+        {
+            if (!dropOldest())
+            {
+                dropped++;
+                return false;
+            }
+        }
+
+        uint8_t h[header_size];
+        h[0] = type;
+        for (int i = 1; i <= 6; i++)
+        {
+            h[i] = ms & 0xff;
+            ms >>= 8;
+        }
+        h[7] = len & 0xff;
+        h[8] = len >> 8;
+        size_t pos = (head + count) % buf.size();
+        put(pos, h, header_size);
+        put(pos + header_size, data, len);
+        count += size;
+        records++;
+
+        if (max_records && records - sending_records >= max_records && !in_flight)
+            flush();
+        return true;
+    }
+
+    void build()
+    {
+        payload.remove(0, payload.length());
+        payload.reserve(count * 2 + 2);
+        payload += '{';
+        size_t size = 0, num = 0;
+        char id[21], tmp[FIREBASE_NUMBER_BUF_SIZE];
+        while (size < count)
+        {
+            uint8_t type;
+            uint64_t ms;
+            uint16_t len;
+            size_t pos = (head + size) % buf.size();
+            recordHeader(pos, type, ms, len);
+            push_id.generate(ms, id);
+            if (num)
+                payload += ',';
+            payload += '"';
+            payload += id;
+            payload += FPSTR("\":");
+
+            pos += header_size;
+            if (type == sample_type_double)
+            {
+                double v;
+                get(pos, reinterpret_cast<uint8_t *>(&v), sizeof(v));
+                NumberUtil::format(v, decimals, tmp);
+                payload += tmp;
+            }
+            else if (type == sample_type_int)
+            {
+                int64_t v;
+                get(pos, reinterpret_cast<uint8_t *>(&v), sizeof(v));
+                NumberUtil::format(v, tmp);
+                payload += tmp;
+            }
+            else
+            {
+                for (uint16_t i = 0; i < len; i++)
+                    payload += (char)buf[(pos + i) % buf.size()];
+            }
+            size += header_size + len;
+            num++;
+        }
+        payload += '}';
+        sending = size;
+        sending_records = num;
+    }
+
+    // The failed batch is retried with the same payload, then the same push IDs are written.
+    void done(bool ok)
+    {
+        in_flight = false;
+        if (!ok)
+            return;
+        head = (head + sending) % buf.size();
+        count -= sending;
+        records -= sending_records;
+        sent += sending_records;
+        sending = 0;
+        sending_records = 0;
+        payload.remove(0, payload.length());
+    }
+
+public:
+    /**
+     * The batcher of telemetry samples of Realtime Database.
+     *
+     * @param size The size in bytes of sample ring buffer, the oldest samples are dropped when it is full.
+     * @param interval The interval in ms of the batch write.
+     * @param maxSamples The numbers of samples that the batch is written before the interval, 0 for no limit.
+     */
+    RealtimeDatabaseTelemetry(size_t size = FIREBASE_RTDB_TELEMETRY_SIZE, uint32_t interval = 10000, uint16_t maxSamples = 0)
+        : interval_ms(interval), max_records(maxSamples) { buf.resize(size); }
+
+    /**
+     * Set the node and client of the batch write.
+     *
+     * @param database The RealtimeDatabase that the samples are written to.
+     * @param aClient The async client.
+     * @param path The node path that the samples are pushed to.
+     * @param timeCb The TimeStatusCallback that provides the current timestamp (epoch seconds) for the push IDs.
+     */
+    void begin(RealtimeDatabase &database, AsyncClientClass &aClient, const String &path, TimeStatusCallback timeCb)
+    {
+        db = &database;
+        client = &aClient;
+        this->path = path;
+        time_cb = timeCb;
+        flush_ms = millis();
+    }
+
+    // The decimal places of the floating point samples, the negative value is for the shortest text.
+    void setDecimals(int8_t decimals) { this->decimals = decimals; }
+
+    // Add the sample of the current time or the time in ms since epoch.
+    bool add(double value, uint64_t ms = 0) { return addRecord(sample_type_double, ms, reinterpret_cast<const uint8_t *>(&value), sizeof(value)); }
+
+    // The integer samples of any type (e.g. uint32_t and the millis() value) are stored as int64_t.
+    template <typename T>
+    auto add(T value, uint64_t ms = 0) -> typename std::enable_if<std::is_integral<T>::value, bool>::type { return add((int64_t)value, ms); }
+
+    bool add(int64_t value, uint64_t ms = 0) { return addRecord(sample_type_int, ms, reinterpret_cast<const uint8_t *>(&value), sizeof(value)); }
+
+    // Add the JSON sample e.g. the object of several readings.
+    bool add(const object_t &value, uint64_t ms = 0) { return addRecord(sample_type_json, ms, reinterpret_cast<const uint8_t *>(value.c_str()), strlen(value.c_str())); }
+
+    /**
+     * Write the samples in buffer as one update of the node.
+     *
+     * The batch that was failed is written again before the new samples.
+     *
+     * @return boolean The batch was written, false when there are no samples or the previous batch is being sent.
+     */
+    bool flush()
+    {
+        if (!db || !client || in_flight || count == 0)
+            return false;
+
+        if (sending == 0)
+            build();
+
+        flush_ms = millis();
+        in_flight = true;
+        db->update<object_t>(*client, path, object_t(payload), result);
+        return true;
+    }
+
+    // Write the batch at the interval and process the result of the batch write, it should be called in loop.
+    void loop()
+    {
+        if (in_flight)
+        {
+            if (result.isError())
+                done(false);
+            else if (result.available())
+                done(true);
+        }
+        else if (count && interval_ms && millis() - flush_ms >= interval_ms)
+            flush();
+    }
+
+    // The numbers of samples in buffer.
+    size_t size() const { return records; }
+
+    // The numbers of bytes of samples in buffer.
+    size_t bytes() const { return count; }
+
+    // The numbers of samples that were dropped because the buffer was full or there was no time.
+    uint32_t droppedCount() const { return dropped; }
+
+    // The numbers of samples that were written.
+    uint32_t sentCount() const { return sent; }
+
+    bool isSending() const { return in_flight; }
+
+    const AsyncResult &lastResult() const { return result; }
+};
+
+#endif
+
+#endif
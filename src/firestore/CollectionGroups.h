@@ -105,7 +105,7 @@ namespace Firestore
              * This function requires ServiceAuth authentication.
              *
              */
-            void create(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &collectionId, CollectionGroupsIndex::Index index, AsyncResultCallback cb, const String &uid = "")
+            void create(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &collectionId, CollectionGroupsIndex::Index index, AsyncResultCallback cb, const StringRef &uid = "")
             {
                 collectionGroupIndexManager(aClient, nullptr, cb, uid, parent, index, collectionId, "", false, true);
             }
@@ -171,7 +171,7 @@ namespace Firestore
              * This function requires ServiceAuth authentication.
              *
              */
-            void deleteIndex(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &collectionId, const String &indexId, AsyncResultCallback cb, const String &uid = "")
+            void deleteIndex(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &collectionId, const String &indexId, AsyncResultCallback cb, const StringRef &uid = "")
             {
                 CollectionGroupsIndex::Index index;
                 collectionGroupIndexManager(aClient, nullptr, cb, uid, parent, index, collectionId, indexId, true, true);
@@ -238,7 +238,7 @@ namespace Firestore
              * This function requires ServiceAuth authentication.
              *
              */
-            void get(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &collectionId, const String &indexId, AsyncResultCallback cb, const String &uid = "")
+            void get(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &collectionId, const String &indexId, AsyncResultCallback cb, const StringRef &uid = "")
             {
                 CollectionGroupsIndex::Index index;
                 collectionGroupIndexManager(aClient, nullptr, cb, uid, parent, index, collectionId, indexId, false, true);
@@ -300,7 +300,7 @@ namespace Firestore
              * This function requires ServiceAuth authentication.
              *
              */
-            void list(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &collectionId, AsyncResultCallback cb, const String &uid = "")
+            void list(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &collectionId, AsyncResultCallback cb, const StringRef &uid = "")
             {
                 CollectionGroupsIndex::Index index;
                 collectionGroupIndexManager(aClient, nullptr, cb, uid, parent, index, collectionId, "", false, true);
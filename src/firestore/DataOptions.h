@@ -32,6 +32,7 @@
 
 #if defined(ENABLE_FIRESTORE)
 #include "./firestore/Values.h"
+#include "./firestore/FieldSet.h"
 #if defined(ENABLE_FIRESTORE_QUERY)
 #include "./firestore/Query.h"
 using namespace FirestoreQuery;
@@ -55,11 +56,14 @@ enum firebase_firestore_request_type
     firebase_firestore_request_type_create_composite_index,
     firebase_firestore_request_type_create_field_index,
     firebase_firestore_request_type_manage_database,
+    firebase_firestore_request_type_listen,
+    firebase_firestore_request_type_run_aggregation_query,
 
     firebase_firestore_request_type_get_doc = 300,
     firebase_firestore_request_type_list_doc,
     firebase_firestore_request_type_list_index,
     firebase_firestore_request_type_get_index,
+    firebase_firestore_request_type_get_operation,
 
     firebase_firestore_request_type_patch_doc = 400,
 
@@ -80,12 +84,14 @@ class DocumentMask : public BaseO2
 
 private:
     ObjectWriter owriter;
+    // The comma separated field paths, the JSON object of mask is kept in buf.
+    String field_paths;
 
     String get()
     {
         String temp;
         JSONUtil jut;
-        jut.addTokens(temp, jut.toString("fieldPaths"), buf[1], true);
+        jut.addTokens(temp, jut.toString("fieldPaths"), field_paths, true);
         return temp;
     }
 
@@ -103,6 +109,16 @@ public:
         setFieldPaths(fieldPaths);
     }
 
+    /**
+     * A set of field paths on a document.
+     *
+     * @param fieldSet The FieldSet object that provides the field paths.
+     */
+    DocumentMask(const FieldSet &fieldSet)
+    {
+        setFieldPaths(fieldSet.toString());
+    }
+
     /**
      * A set of field paths on a document.
      * Used to restrict a get or update operation on a document to a subset of its fields.
@@ -115,16 +131,18 @@ public:
     {
         if (fieldPaths.length())
         {
-            this->buf[1] = fieldPaths;
+            field_paths = fieldPaths;
+            String temp;
             JSONUtil jut;
-            jut.addTokens(buf[0], "fieldPaths", buf[1], true);
+            jut.addTokens(temp, "fieldPaths", field_paths, true);
+            buf.setContent(temp);
         }
     }
-    String getQuery(const String &mask, bool hasParam)
+    String getQuery(const String &mask, bool hasParam) const
     {
         String temp;
         URLUtil uut;
-        uut.addParamsTokens(temp, String(mask + ".fieldPaths="), this->buf[1], hasParam);
+        uut.addParamsTokens(temp, String(mask + ".fieldPaths="), field_paths, hasParam);
         return temp;
     }
 };
@@ -330,61 +348,44 @@ class Precondition : public BaseO4
 private:
     ObjectWriter owriter;
     JSONUtil jut;
+    // The values of query parameters, the exists is -1 when it was not set.
+    int8_t exists_val = -1;
+    String update_time;
 
     String getQuery(const String &mask)
     {
-        buf[1].remove(0, buf[1].length());
-        if (buf[2].length())
+        String query;
+        if (exists_val > -1)
         {
-            buf[1] = FPSTR("?");
-            buf[1] += mask;
-            buf[1] += FPSTR(".exists=");
-            buf[1] += buf[2];
+            query = FPSTR("?");
+            query += mask;
+            query += FPSTR(".exists=");
+            query += owriter.getBoolStr(exists_val);
         }
 
-        if (buf[3].length())
+        if (update_time.length())
         {
-            if (buf[1].length())
-                buf[1] += '&';
+            if (query.length())
+                query += '&';
             else
-                buf[1] = FPSTR("?");
-            buf[1] += mask;
-            buf[1] += FPSTR(".updateTime=");
-            buf[1] += jut.toString(buf[3]);
+                query = FPSTR("?");
+            query += mask;
+            query += FPSTR(".updateTime=");
+            query += jut.toString(update_time);
         }
-        return buf[1];
-    }
-
-    Precondition &setObject()
-    {
-        if (buf[2].length())
-        {
-            if (buf[0].length() == 0)
-                owriter.setPair(buf[0], FPSTR("exists"), buf[2]);
-            else
-            {
-                buf[0][buf[0].length() - 1] = '\0';
-                jut.addObject(buf[0], FPSTR("exists"), buf[2], true);
-            }
-        }
-
-        if (buf[3].length())
-        {
-            if (buf[0].length() == 0)
-                owriter.setPair(buf[0], FPSTR("updateTime"), buf[3]);
-            else
-            {
-                buf[0][buf[0].length() - 1] = '\0';
-                jut.addObject(buf[0], FPSTR("updateTime"), buf[3], true);
-            }
-        }
-
-        return *this;
+        return query;
     }
 
 public:
     Precondition() {}
 
+    void clear()
+    {
+        buf.clear();
+        exists_val = -1;
+        update_time.remove(0, update_time.length());
+    }
+
     /**
      * Set the exists condition.
      * @param value When set to true, the target document must exist.
@@ -392,8 +393,8 @@ public:
      */
     Precondition &exists(bool value)
     {
-        this->buf[2] = owriter.getBoolStr(value);
-        return setObject();
+        exists_val = value;
+        return wr.set<Precondition &, bool>(*this, value, buf, bufSize, 1, FPSTR("exists"));
     }
 
     /**
@@ -404,8 +405,8 @@ public:
      */
     Precondition &updateTime(const String &timestamp)
     {
-        this->buf[3] = timestamp;
-        return setObject();
+        update_time = timestamp;
+        return wr.set<Precondition &, String>(*this, timestamp, buf, bufSize, 2, FPSTR("updateTime"));
     }
 };
 
@@ -421,26 +422,25 @@ private:
     Values::MapValue mv;
     ObjectWriter owriter;
     JSONUtil jut;
+    // The fields were set from value tree.
+    bool tree = false;
 
+    // The name and fields members are kept in the fields 1 and 2 of buf.
     Document &getBuf()
     {
-        buf[2] = mv.c_str();
-        buf[3].remove(0, buf[3].length());
-        if (buf[1].length())
-            jut.addObject(buf[3], FPSTR("name"), owriter.makeResourcePath(buf[1]), true, true);
-        else
-        {
-            buf[0] = buf[2];
-            return *this;
-        }
-
-        buf[0] = buf[3];
-        if (buf[2].length())
-            owriter.addMember(buf[0], buf[2], false, "}");
-
+        if (!tree)
+            buf.setObject(2, mv.c_str());
         return *this;
     }
 
+    void setNameField(const String &name)
+    {
+        String temp;
+        if (name.length())
+            jut.addObject(temp, FPSTR("name"), owriter.makeResourcePath(name), true, true);
+        buf.setObject(1, temp);
+    }
+
 public:
     /**
      * A Firestore document constructor with document resource name.
@@ -448,7 +448,7 @@ public:
      */
     Document(const String &name = "")
     {
-        buf[1] = name;
+        setNameField(name);
         getBuf();
     }
 
@@ -463,13 +463,30 @@ public:
         getBuf();
     }
 
+    /**
+     * A Firestore document constructor with the value tree of document fields.
+     * The fields JSON is written once here.
+     * @param fields The value tree of document fields.
+     * @param name The resource name of the document.
+     */
+    Document(const Values::ValueTree &fields, const String &name = "")
+    {
+        setNameField(name);
+        String temp;
+        fields.create(temp);
+        buf.setObject(2, temp);
+        tree = true;
+    }
+
     /**
      * Add the object to Firestore document.
+     * The fields that were set from value tree are replaced.
      * @param key The key of an object.
      * @param value The value of an object.
      */
     Document &add(const String &key, T value)
     {
+        tree = false;
         mv.add(key, value);
         return getBuf();
     }
@@ -480,16 +497,17 @@ public:
      */
     void setName(const String &name)
     {
-        buf[1] = name;
+        setNameField(name);
         getBuf();
     }
 
-    const char *c_str() const { return buf[0].c_str(); }
+    const char *c_str() const { return buf.c_str(); }
 
     void clear()
     {
-        owriter.clearBuf(buf, bufSize);
+        buf.clear();
         mv.clear();
+        tree = false;
     }
 };
 
@@ -977,6 +995,32 @@ public:
     QueryOptions &readTime(const String &value) { return wr.set<QueryOptions &, String>(*this, value, buf, bufSize, 3, FPSTR(__func__)); }
 };
 
+// Ref https://firebase.google.com/docs/firestore/reference/rest/v1/projects.databases.documents/runAggregationQuery
+
+class AggregationQueryOptions : public BaseO4
+{
+public:
+    AggregationQueryOptions() {}
+
+    // Optional. Explain options for the query. If set, additional query statistics will be returned. If not, only query results will be returned.
+    AggregationQueryOptions &explainOptions(const ExplainOptions &value) { return wr.set<AggregationQueryOptions &, ExplainOptions>(*this, value, buf, bufSize, 1, FPSTR(__func__)); }
+
+    // An aggregation query.
+    AggregationQueryOptions &structuredAggregationQuery(const StructuredAggregationQuery &value) { return wr.set<AggregationQueryOptions &, StructuredAggregationQuery>(*this, value, buf, bufSize, 2, FPSTR(__func__)); }
+
+    // Union field consistency_selector
+    // Run the aggregation within an already active transaction.
+    AggregationQueryOptions &transaction(const String &value) { return wr.set<AggregationQueryOptions &, String>(*this, value, buf, bufSize, 3, FPSTR(__func__)); }
+
+    // Union field consistency_selector
+    // Starts a new transaction as part of the query, defaulting to read-only.
+    AggregationQueryOptions &newTransaction(const TransactionOptions &value) { return wr.set<AggregationQueryOptions &, TransactionOptions>(*this, value, buf, bufSize, 3, FPSTR(__func__)); }
+
+    // Union field consistency_selector
+    // Timestamp. Executes the query at the given timestamp.
+    AggregationQueryOptions &readTime(const String &value) { return wr.set<AggregationQueryOptions &, String>(*this, value, buf, bufSize, 3, FPSTR(__func__)); }
+};
+
 #endif
 
 // Ref https://firebase.google.com/docs/firestore/reference/rest/v1/projects.databases.documents/list
@@ -984,69 +1028,57 @@ public:
 /**
  * This class used in Documents.list function represents the query parametes.
  */
-class ListDocumentsOptions : public BaseO6
+class ListDocumentsOptions : public BaseO8
 {
 private:
-    int pagesize = 0;
-    DocumentMask msk;
     ObjectWriter owriter;
-    URLUtil uut;
 
-    ListDocumentsOptions &set()
+    // The parameter of empty value is removed.
+    ListDocumentsOptions &set(uint8_t index, const String &key, const String &value)
     {
-        bool hasParam = false;
-        owriter.clear(buf[0]);
-
-        if (pagesize > 0)
-            uut.addParam(buf[0], FPSTR("pageSize"), String(pagesize), hasParam);
-        if (buf[1].length() > 0)
-            uut.addParam(buf[0], FPSTR("pageToken"), buf[1], hasParam);
-        if (buf[2].length() > 0)
-            uut.addParam(buf[0], FPSTR("orderBy"), buf[2], hasParam);
-        if (strlen(msk.c_str()) > 0)
-            buf[0] += msk.getQuery("mask", hasParam);
-        if (buf[3].length() > 0)
-            uut.addParam(buf[0], FPSTR("showMissing"), buf[3], hasParam);
-        if (buf[4].length() > 0)
-            uut.addParam(buf[0], FPSTR("transaction"), buf[4], hasParam);
-        if (buf[5].length() > 0)
-            uut.addParam(buf[0], FPSTR("readTime"), buf[5], hasParam);
-
+        String param;
+        if (value.length())
+        {
+            param = key;
+            param += '=';
+            param += value;
+        }
+        buf.set(index, param);
         return *this;
     }
 
 public:
-    ListDocumentsOptions() {}
+    // The query parameters are joined with '&' after '?'.
+    ListDocumentsOptions() { buf.setFormat('?', '&', 0); }
 
     // Optional. The maximum number of documents to return in a single response.
     // Firestore may return fewer than this value.
     ListDocumentsOptions &pageSize(int value)
     {
-        pagesize = value;
-        return set();
+        return set(1, FPSTR("pageSize"), value > 0 ? String(value) : String());
     }
 
     // Optional. A page token, received from a previous documents.list response.
     ListDocumentsOptions &pageToken(const String &value)
     {
-        buf[1] = value;
-        return set();
+        return set(2, FPSTR("pageToken"), value);
     }
 
     // Optional. The optional ordering of the documents to return.
     // For example: priority desc, __name__ desc.
     ListDocumentsOptions &orderBy(const String value)
     {
-        buf[2] = value;
-        return set();
+        return set(3, FPSTR("orderBy"), value);
     }
 
     // Optional. The fields to return. If not set, returns all fields.
     // If a document has a field that is not present in this mask, that field will not be returned in the response.
     ListDocumentsOptions &mask(const DocumentMask &value)
     {
-        msk = value;
-        return set();
+        // The mask parameters without the first '&'.
+        String query = value.getQuery("mask", true);
+        buf.set(4, query.length() ? query.c_str() + 1 : "", query.length() ? query.length() - 1 : 0);
+        return *this;
     }
 
     // If the list should show missing documents.
@@ -1054,24 +1086,21 @@ public:
     // Requests with showMissing may not specify where or orderBy.
     ListDocumentsOptions &showMissing(bool value)
     {
-        buf[3] = owriter.getBoolStr(value);
-        return set();
+        return set(5, FPSTR("showMissing"), owriter.getBoolStr(value));
     }
 
     // Perform the read as part of an already active transaction.
     // A base64-encoded string.
     ListDocumentsOptions &transaction(const String value)
     {
-        buf[4] = value;
-        return set();
+        return set(6, FPSTR("transaction"), value);
     }
 
     // Perform the read at the provided time.
     // This must be a microsecond precision timestamp within the past one hour,or if Point-in-Time Recovery is enabled, can additionally be a whole minute timestamp within the past 7 days.
     ListDocumentsOptions &readTime(const String value)
     {
-        buf[5] = value;
-        return set();
+        return set(7, FPSTR("readTime"), value);
     }
 };
 
@@ -116,7 +116,7 @@ namespace Firestore
          * This function requires ServiceAuth or AccessToken authentication.
          *
          */
-        void exportDocuments(AsyncClientClass &aClient, const Firestore::Parent &parent, EximDocumentOptions exportOptions, AsyncResultCallback cb, const String &uid = "")
+        void exportDocuments(AsyncClientClass &aClient, const Firestore::Parent &parent, EximDocumentOptions exportOptions, AsyncResultCallback cb, const StringRef &uid = "")
         {
             eximDocs(aClient, nullptr, cb, uid, parent, exportOptions, false, true);
         }
@@ -186,11 +186,35 @@ namespace Firestore
          * This function requires ServiceAuth or AccessToken authentication.
          *
          */
-        void importDocuments(AsyncClientClass &aClient, const Firestore::Parent &parent, EximDocumentOptions importOptions, AsyncResultCallback cb, const String &uid = "")
+        void importDocuments(AsyncClientClass &aClient, const Firestore::Parent &parent, EximDocumentOptions importOptions, AsyncResultCallback cb, const StringRef &uid = "")
         {
             eximDocs(aClient, nullptr, cb, uid, parent, importOptions, true, true);
         }
 
+        /** Wait for the long-running operation e.g. of export, import, create, delete or patch database to complete.
+         *
+         * The operation is polled with the delay that grows from FIREBASE_FIRESTORE_OPERATION_POLL_MIN to
+         * FIREBASE_FIRESTORE_OPERATION_POLL_MAX, or at half of the remaining time that was estimated from its progress.
+         *
+         * ### Example
+         * ```cpp
+         * // Start to wait in the callback of exportDocuments.
+         * Databases.waitOperation(aClient, aResult.c_str(), operationCb);
+         * ```
+         * @param aClient The async client.
+         * @param operation The operation name or the Operation JSON response of the request.
+         * @param cb The async result callback (AsyncResultCallback) that receives the final Operation JSON.
+         * @param uid The user specified UID of async result (optional).
+         *
+         * The failed operation is returned as the FIREBASE_ERROR_SERVER_RESPONSE error with the message of operation error,
+         * and the invalid operation name as the FIREBASE_ERROR_INVALID_ARGUMENT error.
+         *
+         */
+        void waitOperation(AsyncClientClass &aClient, const String &operation, AsyncResultCallback cb, const StringRef &uid = "")
+        {
+            waitOperationImpl(aClient, operation, cb, uid);
+        }
+
         /** Create a database.
          *
          * @param aClient The async client.
@@ -250,7 +274,7 @@ namespace Firestore
          * This function requires ServiceAuth or AccessToken authentication.
          *
          */
-        void create(AsyncClientClass &aClient, const Firestore::Parent &parent, Database &database, AsyncResultCallback cb, const String &uid = "")
+        void create(AsyncClientClass &aClient, const Firestore::Parent &parent, Database &database, AsyncResultCallback cb, const StringRef &uid = "")
         {
             manageDatabase(aClient, nullptr, cb, uid, parent, database.c_str(), "", Firestore::firestore_database_mode_create, true);
         }
@@ -308,7 +332,7 @@ namespace Firestore
          * This function requires ServiceAuth or AccessToken authentication.
          *
          */
-        void deleteDatabase(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &etag, AsyncResultCallback cb, const String &uid = "")
+        void deleteDatabase(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &etag, AsyncResultCallback cb, const StringRef &uid = "")
         {
             manageDatabase(aClient, nullptr, cb, uid, parent, "", etag, Firestore::firestore_database_mode_delete, true);
         }
@@ -360,7 +384,7 @@ namespace Firestore
          * This function requires ServiceAuth or AccessToken authentication.
          *
          */
-        void get(AsyncClientClass &aClient, const Firestore::Parent &parent, AsyncResultCallback cb, const String &uid = "")
+        void get(AsyncClientClass &aClient, const Firestore::Parent &parent, AsyncResultCallback cb, const StringRef &uid = "")
         {
             manageDatabase(aClient, nullptr, cb, uid, parent, "", "", Firestore::firestore_database_mode_get, true);
         }
@@ -412,7 +436,7 @@ namespace Firestore
          * This function requires ServiceAuth or AccessToken authentication.
          *
          */
-        void list(AsyncClientClass &aClient, const Firestore::Parent &parent, AsyncResultCallback cb, const String &uid = "")
+        void list(AsyncClientClass &aClient, const Firestore::Parent &parent, AsyncResultCallback cb, const StringRef &uid = "")
         {
             manageDatabase(aClient, nullptr, cb, uid, parent, "", "", Firestore::firestore_database_mode_list, true);
         }
@@ -482,7 +506,7 @@ namespace Firestore
          * This function requires ServiceAuth or AccessToken authentication.
          *
          */
-        void patch(AsyncClientClass &aClient, const Firestore::Parent &parent, Database &database, const String &updateMask, AsyncResultCallback cb, const String &uid = "")
+        void patch(AsyncClientClass &aClient, const Firestore::Parent &parent, Database &database, const String &updateMask, AsyncResultCallback cb, const StringRef &uid = "")
         {
             manageDatabase(aClient, nullptr, cb, uid, parent, database.c_str(), updateMask, Firestore::firestore_database_mode_patch, true);
         }
@@ -548,7 +572,7 @@ namespace Firestore
              * This function requires ServiceAuth authentication.
              *
              */
-            void create(AsyncClientClass &aClient, const Firestore::Parent &parent, DatabaseIndex::Index index, AsyncResultCallback cb, const String &uid = "")
+            void create(AsyncClientClass &aClient, const Firestore::Parent &parent, DatabaseIndex::Index index, AsyncResultCallback cb, const StringRef &uid = "")
             {
                 databaseIndexManager(aClient, nullptr, cb, uid, parent, index, "", false, true);
             }
@@ -611,7 +635,7 @@ namespace Firestore
              * This function requires ServiceAuth authentication.
              *
              */
-            void deleteIndex(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &indexId, AsyncResultCallback cb, const String &uid = "")
+            void deleteIndex(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &indexId, AsyncResultCallback cb, const StringRef &uid = "")
             {
                 DatabaseIndex::Index index("");
                 databaseIndexManager(aClient, nullptr, cb, uid, parent, index, indexId, true, true);
@@ -675,7 +699,7 @@ namespace Firestore
              * This function requires ServiceAuth authentication.
              *
              */
-            void get(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &indexId, AsyncResultCallback cb, const String &uid = "")
+            void get(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &indexId, AsyncResultCallback cb, const StringRef &uid = "")
             {
                 DatabaseIndex::Index index("");
                 databaseIndexManager(aClient, nullptr, cb, uid, parent, index, indexId, false, true);
@@ -737,7 +761,7 @@ namespace Firestore
              * This function requires ServiceAuth authentication.
              *
              */
-            void list(AsyncClientClass &aClient, const Firestore::Parent &parent, AsyncResultCallback cb, const String &uid = "")
+            void list(AsyncClientClass &aClient, const Firestore::Parent &parent, AsyncResultCallback cb, const StringRef &uid = "")
             {
                 DatabaseIndex::Index index("");
                 databaseIndexManager(aClient, nullptr, cb, uid, parent, index, "", false, true);
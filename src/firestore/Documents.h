@@ -145,11 +145,47 @@ namespace Firestore
          * For more detail, see https://cloud.google.com/firestore/docs/reference/rest/v1/projects.databases.documents/batchGet
          *
          */
-        void batchGet(AsyncClientClass &aClient, const Firestore::Parent &parent, BatchGetDocumentOptions batchOptions, AsyncResultCallback cb, const String &uid = "")
+        void batchGet(AsyncClientClass &aClient, const Firestore::Parent &parent, BatchGetDocumentOptions batchOptions, AsyncResultCallback cb, const StringRef &uid = "")
         {
             batchGetDoc(aClient, nullptr, cb, uid, parent, batchOptions, true);
         }
 
+        /** Gets multiple documents and delivers the entries one at a time as the response arrives.
+         *
+         * The documents are requested in parts of up to FIREBASE_FIRESTORE_BATCH_GET_LIMIT documents, one part at a time,
+         * with the same mask, transaction or readTime of batchOptions. The documents are requested at once when newTransaction was set.
+         *
+         * The array of entries is parsed from the response payload as it arrives and only one entry is kept in memory.
+         * The entry is the JSON object that has the "found" document or the "missing" document name, and the "readTime".
+         * The remaining parts are not requested and the connection is closed when the entry callback returns false
+         * or the error occurred.
+         * The result payload is empty, the result callback is called when all parts were finished, stopped or the error occurred.
+         *
+         * ### Example
+         * ```cpp
+         * bool onEntry(const String &entry)
+         * {
+         *     Serial.println(entry);
+         *     return true;
+         * }
+         *
+         * Docs.batchGet(aClient, Firestore::Parent(FIREBASE_PROJECT_ID), batchOptions, onEntry, asyncCB);
+         * ```
+         * @param aClient The async client.
+         * @param parent The Firestore::Parent object included project Id and database Id in its constructor.
+         * @param batchOptions The BatchGetDocumentOptions object which provided the member functions to construct the requst body.
+         * @param entryCb The callback function that receives each entry JSON object, returns false to stop.
+         * @param cb The async result callback (AsyncResultCallback) that is called when all parts were finished.
+         * @param uid The user specified UID of async result (optional).
+         *
+         * This function requires ServiceAuth authentication.
+         *
+         */
+        void batchGet(AsyncClientClass &aClient, const Firestore::Parent &parent, BatchGetDocumentOptions batchOptions, FirestoreQueryCallback entryCb, AsyncResultCallback cb = NULL, const StringRef &uid = "")
+        {
+            batchGetStream(aClient, entryCb, cb, uid, parent, batchOptions);
+        }
+
         /** Applies a batch of write operations.
          *
          * @param aClient The async client.
@@ -210,11 +246,201 @@ namespace Firestore
          * For more description, see https://cloud.google.com/firestore/docs/reference/rest/v1/projects.databases.documents/batchWrite
          *
          */
-        void batchWrite(AsyncClientClass &aClient, const Firestore::Parent &parent, Writes &writes, AsyncResultCallback cb, const String &uid = "")
+        void batchWrite(AsyncClientClass &aClient, const Firestore::Parent &parent, Writes &writes, AsyncResultCallback cb, const StringRef &uid = "")
         {
             batchWriteDoc(aClient, nullptr, cb, uid, parent, writes, true);
         }
 
+        /** Begin the batch writer that applies the stream of writes in batches.
+         *
+         * The writes that added by addWrite are split into batches of up to FIREBASE_FIRESTORE_BATCH_WRITE_LIMIT writes
+         * (or FIREBASE_FIRESTORE_BATCH_WRITE_SIZE bytes of payload) and the next batch is serialized while the previous batch is in flight.
+         * Only one batch is sent at a time, the batch writer works in the loop function.
+         *
+         * The status of each write is reported to the status callback with the index of write in the order it was added.
+         * The result callback is called once when all writes were reported after endBatchWrite, its payload is {"writes":<count>,"failed":<count>}.
+         *
+         * ### Example
+         * ```cpp
+         * void onWriteStatus(uint32_t index, int code, const String &message)
+         * {
+         *     if (code)
+         *         Serial.printf("Write %d failed, %s\n", index, message.c_str());
+         * }
+         *
+         * Docs.beginBatchWrite(aClient, Firestore::Parent(FIREBASE_PROJECT_ID), onWriteStatus, asyncCB);
+         * ```
+         * @param aClient The async client.
+         * @param parent The Firestore::Parent object included project Id and database Id in its constructor.
+         * @param statusCb The callback function that receives the status of each write.
+         * @param cb The async result callback (AsyncResultCallback) that is called when all writes were applied.
+         * @param uid The user specified UID of async result (optional).
+         * @return Boolean value, false when the previous batch writer was not ended.
+         *
+         * This function requires ServiceAuth authentication.
+         *
+         */
+        bool beginBatchWrite(AsyncClientClass &aClient, const Firestore::Parent &parent, FirestoreWriteStatusCallback statusCb, AsyncResultCallback cb = NULL, const StringRef &uid = "")
+        {
+            return beginWriter(aClient, parent, statusCb, cb, uid);
+        }
+
+        /** Add the write to batch writer.
+         *
+         * @param write The Write object.
+         * @return Boolean value, false when the batch writer was not begun or ended, or the next batch is full while the previous batch is in flight.
+         * The write that was not added should be added again after calling the loop function.
+         */
+        bool addWrite(const Write &write) { return addWriter(write); }
+
+        /** End the batch writer, the remaining writes are sent and the result callback is called when all writes were applied.
+         */
+        void endBatchWrite()
+        {
+            if (writer)
+                writer->closed = true;
+        }
+
+        /** Begin the pipelined writer that sends the writes without waiting for the previous responses.
+         *
+         * Each write that added by addPipelineWrite is committed in its own commit request, up to window writes are in flight
+         * on the connections of async client (see AsyncClientClass::addClient), or they are queued and sent back-to-back
+         * on the kept-alive connection. The writes of the same document are sent one at a time in the order they were added.
+         * The pipelined writer works in the loop function.
+         *
+         * The status of each write is reported to the status callback in the order the writes were added, the write that was completed
+         * before the previous writes is reported after them. The write that was not sent completely (the connection or send error) is sent
+         * again for up to FIREBASE_FIRESTORE_PIPELINE_ATTEMPTS attempts, the write that was sent is not sent again as it may be committed.
+         * The result callback is called once when all writes were reported after endPipelineWrite, its payload is {"writes":<count>,"failed":<count>}.
+         *
+         * ### Example
+         * ```cpp
+         * Docs.beginPipelineWrite(aClient, Firestore::Parent(FIREBASE_PROJECT_ID), onWriteStatus, asyncCB);
+         *
+         * // For each reading.
+         * Docs.addPipelineWrite(write);
+         * ```
+         * @param aClient The async client.
+         * @param parent The Firestore::Parent object included project Id and database Id in its constructor.
+         * @param statusCb The callback function that receives the status of each write.
+         * @param cb The async result callback (AsyncResultCallback) that is called when all writes were reported.
+         * @param window The numbers of writes in flight.
+         * @param uid The user specified UID of async result (optional).
+         * @return Boolean value, false when the previous pipelined writer was not ended.
+         *
+         * This function requires ServiceAuth, CustomAuth, UserAuth, CustomToken or IDToken authentication.
+         *
+         */
+        bool beginPipelineWrite(AsyncClientClass &aClient, const Firestore::Parent &parent, FirestoreWriteStatusCallback statusCb, AsyncResultCallback cb = NULL, uint8_t window = FIREBASE_FIRESTORE_PIPELINE_WINDOW, const StringRef &uid = "")
+        {
+            return beginPipeline(aClient, parent, statusCb, cb, window, uid);
+        }
+
+        /** Add the write to pipelined writer.
+         *
+         * @param write The Write object.
+         * @return Boolean value, false when the pipelined writer was not begun or ended, or FIREBASE_FIRESTORE_PIPELINE_QUEUE_LIMIT writes
+         * were not acknowledged. The write that was not added should be added again after calling the loop function.
+         */
+        bool addPipelineWrite(const Write &write) { return addPipeline(write); }
+
+        /** End the pipelined writer, the result callback is called when all writes were reported.
+         */
+        void endPipelineWrite()
+        {
+            if (pipeline)
+                pipeline->closed = true;
+        }
+
+        /** Begin the accumulator that merges the field transforms locally and commits them together.
+         *
+         * The increments of the same document field are added, the maximums and minimums are reduced and the array elements are merged,
+         * then the transforms are committed as one commit request when the interval was elapsed or the numbers of pending transforms reached the threshold.
+         * The transforms of different types on the same field are kept in the order they were added then the result is the same as committing each transform.
+         * The accumulator works in the loop function.
+         *
+         * ### Example
+         * ```cpp
+         * Docs.beginTransforms(aClient, Firestore::Parent(FIREBASE_PROJECT_ID), 60 * 1000, 100, asyncCB);
+         *
+         * // For each event.
+         * Docs.addIncrement("counters/device1", "events", 1);
+         * Docs.addMaximum("counters/device1", "peak", reading);
+         * ```
+         * @param aClient The async client.
+         * @param parent The Firestore::Parent object included project Id and database Id in its constructor.
+         * @param intervalMs The interval in milliseconds to commit the pending transforms, 0 for no interval.
+         * @param threshold The numbers of pending transforms (merged) to commit, the maximum is FIREBASE_FIRESTORE_BATCH_WRITE_LIMIT.
+         * @param cb The async result callback (AsyncResultCallback) that receives the result of each commit.
+         * @param uid The user specified UID of async result (optional).
+         * @return Boolean value, false when the previous accumulator was not ended.
+         *
+         * This function requires ServiceAuth, CustomAuth, UserAuth, CustomToken or IDToken authentication.
+         *
+         */
+        bool beginTransforms(AsyncClientClass &aClient, const Firestore::Parent &parent, uint32_t intervalMs, uint16_t threshold, AsyncResultCallback cb = NULL, const StringRef &uid = "")
+        {
+            return beginAccumulator(aClient, parent, intervalMs, threshold, cb, uid);
+        }
+
+        /** Add the increment transform to accumulator.
+         *
+         * @param documentPath The relative path of document.
+         * @param fieldPath The path of field.
+         * @param value The value to add to the field.
+         * @return Boolean value, false when the accumulator was not begun or ended.
+         */
+        bool addIncrement(const String &documentPath, const String &fieldPath, int64_t value) { return addTransform(documentPath, fieldPath, transform_op_increment, false, value, 0); }
+        bool addIncrement(const String &documentPath, const String &fieldPath, int value) { return addIncrement(documentPath, fieldPath, (int64_t)value); }
+        bool addIncrement(const String &documentPath, const String &fieldPath, double value) { return addTransform(documentPath, fieldPath, transform_op_increment, true, 0, value); }
+
+        /** Add the maximum transform to accumulator.
+         *
+         * @param documentPath The relative path of document.
+         * @param fieldPath The path of field.
+         * @param value The value to set the field to the maximum of its current value and this value.
+         * @return Boolean value, false when the accumulator was not begun or ended.
+         */
+        bool addMaximum(const String &documentPath, const String &fieldPath, int64_t value) { return addTransform(documentPath, fieldPath, transform_op_maximum, false, value, 0); }
+        bool addMaximum(const String &documentPath, const String &fieldPath, int value) { return addMaximum(documentPath, fieldPath, (int64_t)value); }
+        bool addMaximum(const String &documentPath, const String &fieldPath, double value) { return addTransform(documentPath, fieldPath, transform_op_maximum, true, 0, value); }
+
+        /** Add the minimum transform to accumulator.
+         *
+         * @param documentPath The relative path of document.
+         * @param fieldPath The path of field.
+         * @param value The value to set the field to the minimum of its current value and this value.
+         * @return Boolean value, false when the accumulator was not begun or ended.
+         */
+        bool addMinimum(const String &documentPath, const String &fieldPath, int64_t value) { return addTransform(documentPath, fieldPath, transform_op_minimum, false, value, 0); }
+        bool addMinimum(const String &documentPath, const String &fieldPath, int value) { return addMinimum(documentPath, fieldPath, (int64_t)value); }
+        bool addMinimum(const String &documentPath, const String &fieldPath, double value) { return addTransform(documentPath, fieldPath, transform_op_minimum, true, 0, value); }
+
+        /** Add the array union (appendMissingElements) transform to accumulator.
+         *
+         * @param documentPath The relative path of document.
+         * @param fieldPath The path of field.
+         * @param element The element to append if it is not already present in the array.
+         * @return Boolean value, false when the accumulator was not begun or ended.
+         */
+        bool addArrayUnion(const String &documentPath, const String &fieldPath, const Values::Value &element) { return addTransform(documentPath, fieldPath, transform_op_append, false, 0, 0, element.c_str()); }
+
+        /** Commit the pending transforms at the next loop.
+         */
+        void flushTransforms()
+        {
+            if (accumulator)
+                accumulator->flush = true;
+        }
+
+        /** End the accumulator, the pending transforms are committed before it was removed.
+         */
+        void endTransforms()
+        {
+            if (accumulator)
+                accumulator->closed = true;
+        }
+
         /** Starts a new transaction.
          *
          * @param aClient The async client.
@@ -303,11 +529,56 @@ namespace Firestore
          *
          * This function requires ServiceAuth authentication.
          */
-        void beginTransaction(AsyncClientClass &aClient, const Firestore::Parent &parent, const TransactionOptions &transOptions, AsyncResultCallback cb, const String &uid = "")
+        void beginTransaction(AsyncClientClass &aClient, const Firestore::Parent &parent, const TransactionOptions &transOptions, AsyncResultCallback cb, const StringRef &uid = "")
         {
             beginTrans(aClient, nullptr, cb, uid, parent, transOptions, true);
         }
 
+        /** Run the read-write transaction.
+         *
+         * The transaction is started, the documents are read in one batchGet request in transaction and
+         * the function of transaction is called with the documents to add the writes, then the writes are committed.
+         * When the transaction was aborted (ABORTED) by the contention, it is retried from the beginning after the backoff delay.
+         * When the read or commit failed with the other error, the transaction is rolled back and its error is reported.
+         *
+         * ### Example
+         * ```cpp
+         * bool addCredit(const String &documents, std::vector<Write> &writes)
+         * {
+         *     // Parse the balance from documents and add the update write.
+         *     writes.push_back(Write(DocumentMask("balance"), doc, Precondition()));
+         *     return true;
+         * }
+         *
+         * BatchGetDocumentOptions reads;
+         * reads.documents("accounts/user1");
+         * Docs.runTransaction(aClient, Firestore::Parent(FIREBASE_PROJECT_ID), reads, addCredit, asyncCB, "transferTask");
+         * ```
+         * @param aClient The async client.
+         * @param parent The Firestore::Parent object included project Id and database Id in its constructor.
+         * @param reads The BatchGetDocumentOptions object that holds the documents to read, the transaction should not be set.
+         * @param fn The function of transaction (FirestoreTransactionCallback) that can be called more than once when the transaction was retried.
+         * Return false from this function to roll back the transaction.
+         * @param cb The async result callback (AsyncResultCallback) that receives the commit response or the error.
+         * @param uid The user specified UID of async result (optional).
+         * @param maxAttempts The maximum numbers of attempts when the transaction was aborted.
+         *
+         * This function requires ServiceAuth, CustomAuth, UserAuth, CustomToken or IDToken authentication.
+         *
+         */
+        void runTransaction(AsyncClientClass &aClient, const Firestore::Parent &parent, const BatchGetDocumentOptions &reads, FirestoreTransactionCallback fn, AsyncResultCallback cb, const StringRef &uid = "", uint8_t maxAttempts = FIREBASE_FIRESTORE_TRANSACTION_ATTEMPTS)
+        {
+            trans_task_t *t = new trans_task_t();
+            t->aClient = &aClient;
+            t->parent = parent;
+            t->reads = reads;
+            t->fn = fn;
+            t->cb = cb;
+            t->uid = uid.toString();
+            t->max_attempts = maxAttempts > 0 ? maxAttempts : 1;
+            beginTransRunner(t);
+        }
+
         /** Commits a transaction, while optionally updating documents.
          *
          * @param aClient The async client.
@@ -364,7 +635,7 @@ namespace Firestore
          * This function requires ServiceAuth, CustomAuth, UserAuth, CustomToken or IDToken authentication.
          *
          */
-        void commit(AsyncClientClass &aClient, const Firestore::Parent &parent, Writes &writes, AsyncResultCallback cb, const String &uid = "")
+        void commit(AsyncClientClass &aClient, const Firestore::Parent &parent, Writes &writes, AsyncResultCallback cb, const StringRef &uid = "")
         {
             commitDoc(aClient, nullptr, cb, uid, parent, writes, true);
         }
@@ -434,7 +705,7 @@ namespace Firestore
          * This function requires ServiceAuth, CustomAuth, UserAuth, CustomToken or IDToken authentication.
          *
          */
-        void createDocument(AsyncClientClass &aClient, Firestore::Parent parent, const String &documentPath, DocumentMask mask, Document<Values::Value> &document, AsyncResultCallback cb, const String &uid = "")
+        void createDocument(AsyncClientClass &aClient, Firestore::Parent parent, const String &documentPath, DocumentMask mask, Document<Values::Value> &document, AsyncResultCallback cb, const StringRef &uid = "")
         {
             parent.setDocPath(documentPath);
             String collectionId, documentId;
@@ -506,7 +777,7 @@ namespace Firestore
          * This function requires ServiceAuth, CustomAuth, UserAuth, CustomToken or IDToken authentication.
          *
          */
-        void createDocument(AsyncClientClass &aClient, Firestore::Parent parent, const String &collectionId, const String &documentId, DocumentMask mask, Document<Values::Value> &document, AsyncResultCallback cb, const String &uid = "")
+        void createDocument(AsyncClientClass &aClient, Firestore::Parent parent, const String &collectionId, const String &documentId, DocumentMask mask, Document<Values::Value> &document, AsyncResultCallback cb, const StringRef &uid = "")
         {
             createDoc(aClient, nullptr, cb, uid, parent, collectionId, documentId, mask, document, true);
         }
@@ -590,11 +861,56 @@ namespace Firestore
          * This function requires ServiceAuth, CustomAuth, UserAuth, CustomToken or IDToken authentication.
          *
          */
-        void deleteDoc(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &documentPath, const Precondition &currentDocument, AsyncResultCallback cb, const String &uid = "")
+        void deleteDoc(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &documentPath, const Precondition &currentDocument, AsyncResultCallback cb, const StringRef &uid = "")
         {
             deleteDocBase(aClient, nullptr, cb, uid, parent, documentPath, currentDocument, true);
         }
 
+        /** Set the document cache for the async get.
+         *
+         * The document is returned from the cache within the time to live after it was fetched or validated.
+         * After that, only the name and updateTime of the document are read and the cached document is returned
+         * when its updateTime was not changed, otherwise the document is fetched again.
+         * The get in a transaction or at the read time is not cached.
+         *
+         * ### Example
+         * ```cpp
+         * Docs.setDocumentCache(4096, 300);
+         * ```
+         * @param size The maximum bytes of cached documents, the cache is disabled when it is zero.
+         * @param ttl The time to live in seconds of cached document.
+         */
+        void setDocumentCache(size_t size = FIREBASE_RESPONSE_CACHE_SIZE, uint32_t ttl = 60)
+        {
+            doc_cache.setLimit(size);
+            doc_ttl_ms = ttl * 1000;
+            freshVec.clear();
+        }
+
+#if defined(ENABLE_FS)
+        /** Set the document cache for the async get that keeps the documents in files.
+         *
+         * The time to live is counted from the fetch or validation after boot, the documents that were loaded
+         * from files are validated at the first get.
+         *
+         * @param file The file config data, its file name is used as the index file and the prefix of document files.
+         * @param size The maximum bytes of cached documents.
+         * @param ttl The time to live in seconds of cached document.
+         */
+        void setDocumentCache(file_config_data file, size_t size = FIREBASE_RESPONSE_CACHE_SIZE, uint32_t ttl = 60)
+        {
+            setDocumentCache(size, ttl);
+            doc_cache.setFile(file);
+        }
+#endif
+
+        // Remove all cached documents.
+        void clearDocumentCache()
+        {
+            doc_cache.clear();
+            freshVec.clear();
+        }
+
         /** Get a document at the defined path.
          *
          * @param aClient The async client.
@@ -643,7 +959,7 @@ namespace Firestore
          */
         void get(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &documentPath, const GetDocumentOptions &options, AsyncResult &aResult)
         {
-            getDoc(aClient, &aResult, NULL, "", parent, documentPath, options, true);
+            getDocCached(aClient, &aResult, NULL, "", parent, documentPath, options);
         }
 
         /** Get a document at the defined path.
@@ -666,9 +982,9 @@ namespace Firestore
          * This function requires ServiceAuth, CustomAuth, UserAuth, CustomToken or IDToken authentication.
          *
          */
-        void get(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &documentPath, const GetDocumentOptions &options, AsyncResultCallback cb, const String &uid = "")
+        void get(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &documentPath, const GetDocumentOptions &options, AsyncResultCallback cb, const StringRef &uid = "")
         {
-            getDoc(aClient, nullptr, cb, uid, parent, documentPath, options, true);
+            getDocCached(aClient, nullptr, cb, uid, parent, documentPath, options);
         }
 
         /** List the documents in the defined documents collection.
@@ -750,11 +1066,52 @@ namespace Firestore
          * This function requires ServiceAuth, CustomAuth, UserAuth, CustomToken or IDToken authentication.
          *
          */
-        void list(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &collectionId, ListDocumentsOptions listDocsOptions, AsyncResultCallback cb, const String &uid = "")
+        void list(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &collectionId, ListDocumentsOptions listDocsOptions, AsyncResultCallback cb, const StringRef &uid = "")
         {
             listDocs(aClient, nullptr, cb, uid, parent, collectionId, listDocsOptions, true);
         }
 
+        /** Iterate the documents in collection page by page.
+         *
+         * The nextPageToken of each page is used for requesting the next page and the next page is requested
+         * before the documents of current page are delivered. The documents are delivered one at a time
+         * and at most two pages are kept in memory. The result callback is called when all documents were delivered or the error occurred.
+         *
+         * ### Example
+         * ```cpp
+         * void onDocument(const String &document)
+         * {
+         *     Serial.println(document);
+         * }
+         *
+         * ListDocumentsOptions listDocsOptions;
+         * listDocsOptions.pageSize(20);
+         * Docs.iterate(aClient, Firestore::Parent(FIREBASE_PROJECT_ID), "logs", listDocsOptions, onDocument, asyncCB);
+         * ```
+         * @param aClient The async client.
+         * @param parent The Firestore::Parent object included project Id and database Id in its constructor.
+         * @param collectionId The relative path of document collection id to get the documents.
+         * @param listDocsOptions The ListDocumentsOptions object, the pageSize is the numbers of documents in each page.
+         * @param docCb The callback function that receives each document JSON object.
+         * @param cb The async result callback (AsyncResultCallback) that is called when iteration was finished.
+         * @param uid The user specified UID of async result (optional).
+         *
+         * This function requires ServiceAuth, CustomAuth, UserAuth, CustomToken or IDToken authentication.
+         *
+         */
+        void iterate(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &collectionId, ListDocumentsOptions listDocsOptions, FirestoreItemCallback docCb, AsyncResultCallback cb = NULL, const StringRef &uid = "")
+        {
+            list_task_t *t = new list_task_t();
+            t->aClient = &aClient;
+            t->parent = parent;
+            t->path = collectionId;
+            t->docsOptions = listDocsOptions;
+            t->itemCb = docCb;
+            t->cb = cb;
+            t->uid = uid.toString();
+            beginList(t);
+        }
+
         /** List the document collection ids in the defined document path.
          *
          * @param aClient The async client.
@@ -828,11 +1185,41 @@ namespace Firestore
          * This function requires ServiceAuth authentication.
          *
          */
-        void listCollectionIds(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &documentPath, ListCollectionIdsOptions listCollectionIdsOptions, AsyncResultCallback cb, const String &uid = "")
+        void listCollectionIds(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &documentPath, ListCollectionIdsOptions listCollectionIdsOptions, AsyncResultCallback cb, const StringRef &uid = "")
         {
             listCollIds(aClient, nullptr, cb, uid, parent, documentPath, listCollectionIdsOptions, true);
         }
 
+        /** Iterate the collection Ids under the document page by page.
+         *
+         * The next page is requested with the nextPageToken before the collection Ids of current page are delivered.
+         * The result callback is called when all collection Ids were delivered or the error occurred.
+         *
+         * @param aClient The async client.
+         * @param parent The Firestore::Parent object included project Id and database Id in its constructor.
+         * @param documentPath The relative path of document to get its collections' id.
+         * @param listCollectionIdsOptions The ListCollectionIdsOptions object, the pageSize is the numbers of collection Ids in each page.
+         * @param idCb The callback function that receives each collection Id.
+         * @param cb The async result callback (AsyncResultCallback) that is called when iteration was finished.
+         * @param uid The user specified UID of async result (optional).
+         *
+         * This function requires ServiceAuth authentication.
+         *
+         */
+        void iterateCollectionIds(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &documentPath, ListCollectionIdsOptions listCollectionIdsOptions, FirestoreItemCallback idCb, AsyncResultCallback cb = NULL, const StringRef &uid = "")
+        {
+            list_task_t *t = new list_task_t();
+            t->aClient = &aClient;
+            t->parent = parent;
+            t->path = documentPath;
+            t->collOptions = listCollectionIdsOptions;
+            t->collections = true;
+            t->itemCb = idCb;
+            t->cb = cb;
+            t->uid = uid.toString();
+            beginList(t);
+        }
+
         /** Patch or update a document at the defined path.
          *
          * @param aClient The async client.
@@ -939,7 +1326,7 @@ namespace Firestore
          * This function requires ServiceAuth, CustomAuth, UserAuth, CustomToken or IDToken authentication.
          *
          */
-        void patch(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &documentPath, PatchDocumentOptions patchOptions, Document<Values::Value> &document, AsyncResultCallback cb, const String &uid = "")
+        void patch(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &documentPath, PatchDocumentOptions patchOptions, Document<Values::Value> &document, AsyncResultCallback cb, const StringRef &uid = "")
         {
             patchDoc(aClient, nullptr, cb, uid, parent, documentPath, patchOptions, document, true);
         }
@@ -993,11 +1380,79 @@ namespace Firestore
          *
          * This function requires ServiceAuth authentication.
          */
-        void rollback(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &transaction, AsyncResultCallback cb, const String &uid = "")
+        void rollback(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &transaction, AsyncResultCallback cb, const StringRef &uid = "")
         {
             transRollback(aClient, nullptr, cb, uid, parent, transaction, true);
         }
 
+        /** Listen to the changes of documents.
+         *
+         * The subscription uses the Listen channel (WebChannel) of Firestore, the changes are delivered as they arrive
+         * from the long-lived back channel that is polled again when it was ended by the server.
+         * When the channel session was lost, the new session is opened and the target is resumed from
+         * the resume token of last target change then the whole target is not replayed.
+         * The new session is opened with the backoff delay after the error.
+         *
+         * ### Example
+         * ```cpp
+         * void onChange(const String &type, const String &data)
+         * {
+         *     if (type == "documentChange")
+         *         Serial.println(data);
+         * }
+         *
+         * Docs.listen(aClient, Firestore::Parent(FIREBASE_PROJECT_ID), "config/device1,config/common", onChange, asyncCB, "configListener");
+         * ```
+         * @param aClient The async client, the dedicated async client is recommended as the back channel keeps the connection busy.
+         * @param parent The Firestore::Parent object included project Id and database Id in its constructor.
+         * @param documentPaths The relative paths of documents to listen, use comma (,) to separate between the paths.
+         * @param eventCb The callback function that receives each change event, the type is targetChange, documentChange,
+         * documentDelete, documentRemove or filter and the data is its JSON object.
+         * @param cb The async result callback (AsyncResultCallback) that receives the errors and the stop status.
+         * @param uid The user specified UID of subscription (optional).
+         *
+         * This function requires ServiceAuth, CustomAuth, UserAuth, CustomToken or IDToken authentication.
+         *
+         */
+        void listen(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &documentPaths, FirestoreListenCallback eventCb, AsyncResultCallback cb = NULL, const StringRef &uid = "")
+        {
+            listen_task_t *t = new listen_task_t(eventCb);
+            t->aClient = &aClient;
+            t->parent = parent;
+            t->target = FPSTR("\"documents\":{\"documents\":[");
+            int start = 0;
+            for (int i = 0; i <= (int)documentPaths.length(); i++)
+            {
+                if (i < (int)documentPaths.length() && documentPaths[i] != ',')
+                    continue;
+                String path = documentPaths.substring(start, i);
+                path.trim();
+                start = i + 1;
+                if (path.length() == 0)
+                    continue;
+                if (t->target[t->target.length() - 1] != '[')
+                    t->target += ',';
+                t->target += '"';
+                t->target += RESOURCE_PATH_BASE;
+                if (path[0] != '/')
+                    t->target += '/';
+                t->target += path;
+                t->target += '"';
+            }
+            t->target += FPSTR("]}");
+            t->cb = cb;
+            t->uid = uid.toString();
+            beginListen(t);
+        }
+
+        /** Stop the listen subscription.
+         *
+         * The result callback of subscription is called when it was stopped.
+         *
+         * @param uid The UID of subscription, all subscriptions are stopped when it is empty.
+         */
+        void stopListen(const StringRef &uid = "") { stopListenImpl(uid); }
+
 #if defined(ENABLE_FIRESTORE_QUERY)
 
         /** Runs a query.
@@ -1089,11 +1544,142 @@ namespace Firestore
          * For more description, see https://firebase.google.com/docs/firestore/reference/rest/v1beta1/projects.databases.documents/runQuery
          *
          */
-        void runQuery(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &documentPath, QueryOptions queryOptions, AsyncResultCallback cb, const String &uid = "")
+        void runQuery(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &documentPath, QueryOptions queryOptions, AsyncResultCallback cb, const StringRef &uid = "")
         {
             runQueryImpl(aClient, nullptr, cb, uid, parent, documentPath, queryOptions, true);
         }
 
+        /** Runs a query and delivers the documents one at a time as the response arrives.
+         *
+         * The array of results is parsed from the response payload as it arrives and only one result is kept in memory.
+         * The query is stopped and the connection is closed when the document callback returns false.
+         * The result payload is empty, the result callback is called when the query was finished, stopped or the error occurred.
+         *
+         * ### Example
+         * ```cpp
+         * bool onDocument(const String &document)
+         * {
+         *     Serial.println(document);
+         *     return true;
+         * }
+         *
+         * Docs.runQuery(aClient, Firestore::Parent(FIREBASE_PROJECT_ID), "/", queryOptions, onDocument, asyncCB);
+         * ```
+         * @param aClient The async client.
+         * @param parent The Firestore::Parent object included project Id and database Id in its constructor.
+         * @param documentPath The relative path of document to get.
+         * @param queryOptions The QueryOptions object that provides the function to create the query (StructuredQuery) and consistency mode.
+         * @param docCb The callback function that receives each document JSON object, returns false to stop the query.
+         * @param cb The async result callback (AsyncResultCallback) that is called when query was finished.
+         * @param uid The user specified UID of async result (optional).
+         *
+         * This function requires ServiceAuth, CustomAuth, UserAuth, CustomToken or IDToken authentication.
+         *
+         */
+        void runQuery(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &documentPath, QueryOptions queryOptions, FirestoreQueryCallback docCb, AsyncResultCallback cb = NULL, const StringRef &uid = "")
+        {
+            runQueryStream(aClient, docCb, cb, uid, parent, documentPath, queryOptions);
+        }
+
+        /** Listen to the changes of query results.
+         *
+         * @param aClient The async client.
+         * @param parent The Firestore::Parent object included project Id and database Id in its constructor.
+         * @param documentPath The relative path of parent document of query or empty string for the root.
+         * @param query The StructuredQuery object.
+         * @param eventCb The callback function that receives each change event.
+         * @param cb The async result callback (AsyncResultCallback) that receives the errors and the stop status.
+         * @param uid The user specified UID of subscription (optional).
+         *
+         * This function requires ServiceAuth, CustomAuth, UserAuth, CustomToken or IDToken authentication.
+         *
+         */
+        void listen(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &documentPath, StructuredQuery query, FirestoreListenCallback eventCb, AsyncResultCallback cb = NULL, const StringRef &uid = "")
+        {
+            listen_task_t *t = new listen_task_t(eventCb);
+            t->aClient = &aClient;
+            t->parent = parent;
+            t->target = FPSTR("\"query\":{\"parent\":\"");
+            t->target += RESOURCE_PATH_BASE;
+            if (documentPath.length() && documentPath != "/")
+            {
+                if (documentPath[0] != '/')
+                    t->target += '/';
+                t->target += documentPath;
+            }
+            t->target += FPSTR("\",\"structuredQuery\":");
+            t->target += query.c_str();
+            t->target += '}';
+            t->cb = cb;
+            t->uid = uid.toString();
+            beginListen(t);
+        }
+
+        /** Runs an aggregation query.
+         *
+         * The aggregation e.g. count, sum and avg is computed by the server and only its result is returned, the documents are not downloaded.
+         *
+         * ### Example
+         * ```cpp
+         * StructuredAggregationQuery aggr;
+         * aggr.structuredQuery(query).aggregations(Aggregation().count().alias("total")).aggregations(Aggregation().avg(FieldReference("temp")).alias("avgTemp"));
+         *
+         * AggregationQueryOptions aggrOptions;
+         * aggrOptions.structuredAggregationQuery(aggr);
+         *
+         * Docs.runAggregationQuery(aClient, Firestore::Parent(FIREBASE_PROJECT_ID), "/", aggrOptions, asyncCB);
+         * ```
+         * @param aClient The async client.
+         * @param parent The Firestore::Parent object included project Id and database Id in its constructor.
+         * @param documentPath The relative path of parent document of query or empty string for the root.
+         * @param queryOptions The AggregationQueryOptions object that provides the aggregation query (StructuredAggregationQuery) and consistency mode.
+         * @return Boolean value, indicates the success of the operation.
+         *
+         * This function requires ServiceAuth, CustomAuth, UserAuth, CustomToken or IDToken authentication.
+         *
+         * For more description, see https://firebase.google.com/docs/firestore/reference/rest/v1/projects.databases.documents/runAggregationQuery
+         *
+         */
+        bool runAggregationQuery(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &documentPath, AggregationQueryOptions queryOptions)
+        {
+            AsyncResult result;
+            runAggregationQueryImpl(aClient, &result, NULL, "", parent, documentPath, queryOptions, false);
+            return result.lastError.code() == 0;
+        }
+
+        /** Runs an aggregation query.
+         *
+         * @param aClient The async client.
+         * @param parent The Firestore::Parent object included project Id and database Id in its constructor.
+         * @param documentPath The relative path of parent document of query or empty string for the root.
+         * @param queryOptions The AggregationQueryOptions object that provides the aggregation query (StructuredAggregationQuery) and consistency mode.
+         * @param aResult The async result (AsyncResult).
+         *
+         * This function requires ServiceAuth, CustomAuth, UserAuth, CustomToken or IDToken authentication.
+         *
+         */
+        void runAggregationQuery(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &documentPath, AggregationQueryOptions queryOptions, AsyncResult &aResult)
+        {
+            runAggregationQueryImpl(aClient, &aResult, NULL, "", parent, documentPath, queryOptions, true);
+        }
+
+        /** Runs an aggregation query.
+         *
+         * @param aClient The async client.
+         * @param parent The Firestore::Parent object included project Id and database Id in its constructor.
+         * @param documentPath The relative path of parent document of query or empty string for the root.
+         * @param queryOptions The AggregationQueryOptions object that provides the aggregation query (StructuredAggregationQuery) and consistency mode.
+         * @param cb The async result callback (AsyncResultCallback).
+         * @param uid The user specified UID of async result (optional).
+         *
+         * This function requires ServiceAuth, CustomAuth, UserAuth, CustomToken or IDToken authentication.
+         *
+         */
+        void runAggregationQuery(AsyncClientClass &aClient, const Firestore::Parent &parent, const String &documentPath, AggregationQueryOptions queryOptions, AsyncResultCallback cb, const StringRef &uid = "")
+        {
+            runAggregationQueryImpl(aClient, nullptr, cb, uid, parent, documentPath, queryOptions, true);
+        }
+
 #endif
 
     private:
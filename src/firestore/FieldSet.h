@@ -0,0 +1,133 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef FIRESTORE_FIELD_SET_H
+#define FIRESTORE_FIELD_SET_H
+
+#include <Arduino.h>
+#include <vector>
+#include <initializer_list>
+#include "./Config.h"
+#include "./core/Schema.h"
+
+#if defined(ENABLE_FIRESTORE)
+
+/**
+ * The set of document field paths that is declared once and used as the DocumentMask of
+ * GetDocumentOptions, BatchGetDocumentOptions and ListDocumentsOptions and the Projection of query.
+ *
+ * ### Example
+ * ```cpp
+ * FieldSet fields({"temp", "humid", "state"});
+ * // or the fields of struct that has its schema (FIREBASE_JSON_SCHEMA).
+ * FieldSet fields = FieldSet::of<Reading>();
+ *
+ * Docs.get(aClient, Firestore::Parent(FIREBASE_PROJECT_ID), "info/device", GetDocumentOptions(fields), asyncCB);
+ * ```
+ */
+class FieldSet
+{
+private:
+    std::vector<String> paths;
+
+    struct schema_visitor
+    {
+    public:
+        FieldSet *set = nullptr;
+        template <typename T>
+        void field(const char *name, T &) { set->add(name); }
+    };
+
+public:
+    FieldSet() {}
+
+    // The field paths that separated by comma.
+    FieldSet(const String &fieldPaths)
+    {
+        int start = 0;
+        for (int i = 0; i <= (int)fieldPaths.length(); i++)
+        {
+            if (i == (int)fieldPaths.length() || fieldPaths[i] == ',')
+            {
+                String path = fieldPaths.substring(start, i);
+                path.trim();
+                add(path);
+                start = i + 1;
+            }
+        }
+    }
+
+    FieldSet(std::initializer_list<const char *> fieldPaths)
+    {
+        for (const char *path : fieldPaths)
+            add(path);
+    }
+
+    // The fields of struct that has its schema.
+    template <typename T>
+    static auto of() -> typename std::enable_if<json_schema<T>::value, FieldSet>::type
+    {
+        FieldSet set;
+        schema_visitor v;
+        v.set = &set;
+        T o;
+        json_schema<T>::visit(v, o);
+        return set;
+    }
+
+    // Add the field path, the duplicate or empty path is ignored.
+    FieldSet &add(const String &fieldPath)
+    {
+        if (fieldPath.length() == 0)
+            return *this;
+        for (size_t i = 0; i < paths.size(); i++)
+        {
+            if (paths[i] == fieldPath)
+                return *this;
+        }
+        paths.push_back(fieldPath);
+        return *this;
+    }
+
+    size_t size() const { return paths.size(); }
+
+    const String &operator[](size_t index) const { return paths[index]; }
+
+    // The field paths that separated by comma.
+    String toString() const
+    {
+        String s;
+        for (size_t i = 0; i < paths.size(); i++)
+        {
+            if (i > 0)
+                s += ',';
+            s += paths[i];
+        }
+        return s;
+    }
+};
+
+#endif
+
+#endif
@@ -27,21 +27,155 @@
 #include <Arduino.h>
 #include "./core/FirebaseApp.h"
 #include "./firestore/DataOptions.h"
+#include "./core/JsonParser.h"
+#include "./core/ResponseCache.h"
+#include "./firestore/QuerySink.h"
+#include "./firestore/ListenSink.h"
 
 #if defined(ENABLE_FIRESTORE)
 
+#if !defined(FIREBASE_FIRESTORE_BATCH_WRITE_LIMIT)
+#define FIREBASE_FIRESTORE_BATCH_WRITE_LIMIT 500
+#endif
+
+#if !defined(FIREBASE_FIRESTORE_BATCH_WRITE_SIZE)
+#define FIREBASE_FIRESTORE_BATCH_WRITE_SIZE 16 * 1024
+#endif
+
+#if !defined(FIREBASE_FIRESTORE_PIPELINE_WINDOW)
+#define FIREBASE_FIRESTORE_PIPELINE_WINDOW 4
+#endif
+
+#if !defined(FIREBASE_FIRESTORE_PIPELINE_QUEUE_LIMIT)
+#define FIREBASE_FIRESTORE_PIPELINE_QUEUE_LIMIT 16
+#endif
+
+#if !defined(FIREBASE_FIRESTORE_PIPELINE_ATTEMPTS)
+#define FIREBASE_FIRESTORE_PIPELINE_ATTEMPTS 3
+#endif
+
+#if !defined(FIREBASE_FIRESTORE_PIPELINE_RETRY_MS)
+#define FIREBASE_FIRESTORE_PIPELINE_RETRY_MS 1000
+#endif
+
+#if !defined(FIREBASE_FIRESTORE_BATCH_GET_LIMIT)
+#define FIREBASE_FIRESTORE_BATCH_GET_LIMIT 100
+#endif
+
+#if !defined(FIREBASE_FIRESTORE_OPERATION_POLL_MIN)
+#define FIREBASE_FIRESTORE_OPERATION_POLL_MIN 1000
+#endif
+
+#if !defined(FIREBASE_FIRESTORE_OPERATION_POLL_MAX)
+#define FIREBASE_FIRESTORE_OPERATION_POLL_MAX 60 * 1000
+#endif
+
+#if !defined(FIREBASE_FIRESTORE_OPERATION_RETRY)
+#define FIREBASE_FIRESTORE_OPERATION_RETRY 5
+#endif
+
+#if !defined(FIREBASE_FIRESTORE_TRANSACTION_ATTEMPTS)
+#define FIREBASE_FIRESTORE_TRANSACTION_ATTEMPTS 5
+#endif
+
+// The callback of batch writer that receives the status of each write, the code is 0 when the write was applied.
+typedef void (*FirestoreWriteStatusCallback)(uint32_t index, int code, const String &message);
+
+// The callback of page iterator that receives each item e.g. the document JSON object or the collection Id.
+typedef void (*FirestoreItemCallback)(const String &item);
+
+// The function of transaction that receives the documents (BatchGetDocumentsResponse array) that were read in transaction
+// and adds the writes to commit, returns false to roll back the transaction.
+typedef bool (*FirestoreTransactionCallback)(const String &documents, std::vector<Write> &writes);
+
 using namespace firebase;
 
 #include "./firestore/Query.h"
+#include "./firestore/QueryTemplate.h"
 
 class FirestoreBase
 {
     friend class FirebaseApp;
 
 public:
-    std::vector<uint32_t> cVec; // AsyncClient vector
+    std::vector<list_handle_t> cVec; // AsyncClient handles
+
+    ~FirestoreBase()
+    {
+        if (writer)
+            delete writer;
+        writer = nullptr;
+
+        if (pipeline)
+        {
+            for (size_t i = 0; i < pipeline->writes.size(); i++)
+                delete pipeline->writes[i];
+            delete pipeline;
+        }
+        pipeline = nullptr;
+
+        if (accumulator)
+            delete accumulator;
+        accumulator = nullptr;
+
+        for (size_t i = 0; i < listVec.size(); i++)
+        {
+            list_task_t *t = listVec[i];
+            if (t)
+                delete t;
+        }
+        listVec.clear();
+
+        for (size_t i = 0; i < docVec.size(); i++)
+        {
+            doc_task_t *t = docVec[i];
+            if (t)
+                delete t;
+        }
+        docVec.clear();
+
+        for (size_t i = 0; i < listenVec.size(); i++)
+        {
+            listen_task_t *t = listenVec[i];
+            if (t)
+                delete t;
+        }
+        listenVec.clear();
+
+        for (size_t i = 0; i < transVec.size(); i++)
+        {
+            trans_task_t *t = transVec[i];
+            if (t)
+                delete t;
+        }
+        transVec.clear();
+
+        for (size_t i = 0; i < batchGetVec.size(); i++)
+        {
+            batch_get_task_t *t = batchGetVec[i];
+            if (t)
+                delete t;
+        }
+        batchGetVec.clear();
+
+        for (size_t i = 0; i < operationVec.size(); i++)
+        {
+            operation_task_t *t = operationVec[i];
+            if (t)
+                delete t;
+        }
+        operationVec.clear();
 
-    ~FirestoreBase() {}
+#if defined(ENABLE_FIRESTORE_QUERY)
+        for (size_t i = 0; i < queryVec.size(); i++)
+        {
+            query_task_t *t = queryVec[i];
+            if (t)
+                delete t;
+        }
+        queryVec.clear();
+#endif
+    }
 
     FirestoreBase(const String &url = "")
     {
@@ -63,40 +197,60 @@ public:
         this->service_url = url;
     }
 
-    void setApp(uint32_t app_addr, app_token_t *app_token, uint32_t avec_addr)
+    /**
+     * Open the connection to the Firestore host and refresh the token that is going to expire before the requests are sent.
+     *
+     * ### Example
+     * ```cpp
+     * // The sensor interrupt was triggered, the data will be sent soon.
+     * Docs.warmUp(aClient);
+     * ```
+     * @param aClient The async client.
+     * @return bool true when the connect task was added (see AsyncClientClass::preconnect).
+     */
+    bool warmUp(AsyncClientClass &aClient)
     {
-        this->app_addr = app_addr;
-        this->app_token = app_token;
-        this->avec_addr = avec_addr; // AsyncClient vector (list) address
+        return aClient.warmUp(app_handle, cVec, FPSTR("firestore.googleapis.com"));
     }
 
-    app_token_t *appToken()
+    void setApp(list_handle_t app_handle, app_token_t *app_token)
     {
-        if (avec_addr > 0)
-        {
-            std::vector<uint32_t> *cVec = reinterpret_cast<std::vector<uint32_t> *>(avec_addr);
-            List vec;
-            if (cVec)
-                return vec.existed(*cVec, app_addr) ? app_token : nullptr;
-        }
-        return nullptr;
+        this->app_handle = app_handle;
+        this->app_token = app_token;
     }
 
+    // Returns the token of app or nullptr when the app was destroyed.
+    app_token_t *appToken() { return Registry::shared().get(app_handle) ? app_token : nullptr; }
+
     /**
      * Perform the async task repeatedly.
      * Should be places in main loop function.
      */
     void loop()
     {
+        List vec;
         for (size_t i = 0; i < cVec.size(); i++)
         {
-            AsyncClientClass *aClient = reinterpret_cast<AsyncClientClass *>(cVec[i]);
+            AsyncClientClass *aClient = Registry::shared().get<AsyncClientClass>(vec.at(cVec, i));
             if (aClient)
             {
                 aClient->process(true);
                 aClient->handleRemove();
             }
         }
+
+        handleWriter();
+        handlePipeline();
+        handleTransforms();
+        handleList();
+        handleDocCache();
+        handleListen();
+        handleTrans();
+        handleBatchGet();
+        handleOperation();
+#if defined(ENABLE_FIRESTORE_QUERY)
+        handleQuery();
+#endif
     }
 
 protected:
@@ -104,22 +258,269 @@ protected:
     String path;
     String uid;
     // FirebaseApp address and FirebaseApp vector address
-    uint32_t app_addr = 0, avec_addr = 0;
+    list_handle_t app_handle = 0;
     app_token_t *app_token = nullptr;
 
+    struct batch_writer_t
+    {
+    public:
+        AsyncClientClass *aClient = nullptr;
+        Firestore::Parent parent;
+        String uid, res_path;
+        FirestoreWriteStatusCallback statusCb = NULL;
+        AsyncResultCallback cb = NULL;
+        // The serialized writes of next batch, it is built while the previous batch is in flight.
+        String next;
+        uint16_t next_count = 0, sent_count = 0;
+        // The index of first write of the batch in flight.
+        uint32_t base = 0, total = 0, failed = 0;
+        AsyncResult result;
+        bool sending = false, closed = false;
+        // The next batch reached the limit.
+        bool full = false;
+    };
+
+    // The batch writer that splits the stream of writes into batches.
+    batch_writer_t *writer = nullptr;
+
+    struct pipeline_write_t
+    {
+    public:
+        // The commit payload of write and the document that it writes.
+        String payload, document;
+        AsyncResult result;
+        uint8_t attempts = 0;
+        unsigned long failed_ms = 0;
+        bool sending = false, done = false;
+    };
+
+    struct pipeline_writer_t
+    {
+    public:
+        AsyncClientClass *aClient = nullptr;
+        Firestore::Parent parent;
+        String uid, res_path;
+        FirestoreWriteStatusCallback statusCb = NULL;
+        AsyncResultCallback cb = NULL;
+        // The writes that were not acknowledged in the order they were added.
+        std::vector<pipeline_write_t *> writes;
+        // The index of first write in writes.
+        uint32_t base = 0, total = 0, failed = 0;
+        uint8_t window = FIREBASE_FIRESTORE_PIPELINE_WINDOW;
+        AsyncResult result;
+        bool closed = false;
+    };
+
+    // The pipelined writer that sends the writes without waiting for the previous responses.
+    pipeline_writer_t *pipeline = nullptr;
+
+    enum transform_op
+    {
+        transform_op_increment,
+        transform_op_maximum,
+        transform_op_minimum,
+        transform_op_append
+    };
+
+    struct transform_entry_t
+    {
+    public:
+        String document, field;
+        transform_op op = transform_op_increment;
+        bool dbl = false;
+        int64_t i = 0;
+        double d = 0;
+        // The serialized elements of appendMissingElements.
+        std::vector<String> elements;
+    };
+
+    struct transform_acc_t
+    {
+    public:
+        AsyncClientClass *aClient = nullptr;
+        Firestore::Parent parent;
+        String uid;
+        AsyncResultCallback cb = NULL;
+        uint32_t interval_ms = 0;
+        uint16_t threshold = 0;
+        unsigned long flush_ms = 0;
+        // The merged transforms in the order they were added and the transforms of commit in flight.
+        std::vector<transform_entry_t> pending, sent;
+        AsyncResult result;
+        bool sending = false, flush = false, closed = false;
+    };
+
+    // The accumulator that merges the field transforms locally.
+    transform_acc_t *accumulator = nullptr;
+
+    struct list_task_t
+    {
+    public:
+        AsyncClientClass *aClient = nullptr;
+        Firestore::Parent parent;
+        // The collection Id of documents or the document path of collection Ids.
+        String path, uid;
+        ListDocumentsOptions docsOptions;
+        ListCollectionIdsOptions collOptions;
+        bool collections = false;
+        FirestoreItemCallback itemCb = NULL;
+        AsyncResultCallback cb = NULL;
+        // The page results, the next page is fetched into the other result while the current page is delivered.
+        AsyncResult result[2];
+        uint8_t current = 0;
+    };
+
+    // The page iterations that are waiting for their pages.
+    std::vector<list_task_t *> listVec;
+
+    struct doc_task_t
+    {
+    public:
+        AsyncClientClass *aClient = nullptr;
+        Firestore::Parent parent;
+        String path, uid;
+        GetDocumentOptions options;
+        AsyncResult *aResult = nullptr;
+        AsyncResultCallback cb = NULL;
+        AsyncResult result;
+        uint32_t key = 0;
+        // The updateTime of cached document is being checked.
+        bool validating = false;
+    };
+
+    struct doc_fresh_t
+    {
+    public:
+        uint32_t key = 0;
+        unsigned long ms = 0;
+    };
+
+    // The cached documents that keyed by document name and options, the updateTime is kept as ETag.
+    ResponseCache doc_cache;
+    // The time that cached documents were fetched or validated.
+    std::vector<doc_fresh_t> freshVec;
+    uint32_t doc_ttl_ms = 0;
+    // The document reads that are waiting for the results.
+    std::vector<doc_task_t *> docVec;
+
+    struct listen_task_t
+    {
+    public:
+        AsyncClientClass *aClient = nullptr;
+        Firestore::Parent parent;
+        // The target of ListenRequest without targetId and resumeToken e.g. "documents":{...} or "query":{...}.
+        String target, uid;
+        AsyncResultCallback cb = NULL;
+        ListenSink sink;
+        AsyncResult result;
+        // The channel session was opened and the changes are being received.
+        bool polling = false, waiting = false;
+        uint8_t retry = 0;
+        unsigned long retry_ms = 0, delay_ms = 0;
+        listen_task_t(FirestoreListenCallback eventCb) : sink(eventCb) {}
+    };
+
+    // The listen subscriptions.
+    std::vector<listen_task_t *> listenVec;
+
+    enum trans_step
+    {
+        trans_step_begin,
+        trans_step_read,
+        trans_step_commit,
+        trans_step_rollback
+    };
+
+    struct trans_task_t
+    {
+    public:
+        AsyncClientClass *aClient = nullptr;
+        Firestore::Parent parent;
+        // The documents to read in transaction, the transaction is set for each attempt.
+        BatchGetDocumentOptions reads;
+        String uid, transaction;
+        FirestoreTransactionCallback fn = NULL;
+        AsyncResultCallback cb = NULL;
+        AsyncResult result;
+        trans_step step = trans_step_begin;
+        // The error of the read or commit that was failed, it is reported after the transaction was rolled back.
+        int error_code = 0;
+        String error_message;
+        uint8_t attempt = 0, max_attempts = 0;
+        bool waiting = false;
+        unsigned long retry_ms = 0, delay_ms = 0;
+    };
+
+    // The transactions that are running.
+    std::vector<trans_task_t *> transVec;
+
+    struct batch_get_task_t
+    {
+    public:
+        AsyncClientClass *aClient = nullptr;
+        Firestore::Parent parent;
+        String uid;
+        // The request body of all documents and the span of its documents array.
+        String body;
+        json_span_t docs;
+        // The offset in body of the next document to request.
+        int next = 0;
+        QuerySink sink;
+        AsyncResult result;
+        AsyncResultCallback cb = NULL;
+        batch_get_task_t(FirestoreQueryCallback entryCb) : sink(entryCb, nullptr) {}
+    };
+
+    // The streaming batchGet requests that are waiting for their parts.
+    std::vector<batch_get_task_t *> batchGetVec;
+
+    struct operation_task_t
+    {
+    public:
+        AsyncClientClass *aClient = nullptr;
+        // The operation name e.g. projects/{project}/databases/{database}/operations/{operation}.
+        String name, uid;
+        AsyncResultCallback cb = NULL;
+        AsyncResult result;
+        bool waiting = false;
+        uint8_t retry = 0;
+        // The completed work and its time of the last progress to estimate the remaining time.
+        uint64_t work = 0;
+        unsigned long work_ms = 0, poll_ms = 0, delay_ms = 0;
+    };
+
+    // The long-running operations that are being polled.
+    std::vector<operation_task_t *> operationVec;
+
+#if defined(ENABLE_FIRESTORE_QUERY)
+    struct query_task_t
+    {
+    public:
+        QuerySink sink;
+        AsyncResult result;
+        AsyncResultCallback cb = NULL;
+        String uid;
+        query_task_t(FirestoreQueryCallback docCb) : sink(docCb) {}
+    };
+
+    // The streaming queries that are waiting for their results.
+    std::vector<query_task_t *> queryVec;
+#endif
+
     struct async_request_data_t
     {
     public:
         AsyncClientClass *aClient = nullptr;
         String path;
-        String uid;
+        // The uid of the function argument that is valid until the request was built.
+        StringRef uid;
         async_request_handler_t::http_request_method method = async_request_handler_t::http_undefined;
         slot_options_t opt;
         Firestore::DataOptions *options = nullptr;
         AsyncResult *aResult = nullptr;
         AsyncResultCallback cb = NULL;
         async_request_data_t() {}
-        async_request_data_t(AsyncClientClass *aClient, const String &path, async_request_handler_t::http_request_method method, slot_options_t opt, Firestore::DataOptions *options, AsyncResult *aResult, AsyncResultCallback cb, const String &uid = "")
+        async_request_data_t(AsyncClientClass *aClient, const String &path, async_request_handler_t::http_request_method method, slot_options_t opt, Firestore::DataOptions *options, AsyncResult *aResult, AsyncResultCallback cb, const StringRef &uid = "")
         {
             this->aClient = aClient;
             this->path = path;
@@ -134,6 +535,7 @@ protected:
 
     void asyncRequest(async_request_data_t &request, int beta = 0)
     {
+        AsyncClientClass::SlotGuard guard(request.aClient);
         URLUtil uut;
         app_token_t *app_token = appToken();
 
@@ -142,18 +544,22 @@ protected:
 
         request.opt.app_token = app_token;
         String extras;
-        if (beta == 2)
-            uut.addGAPIv1beta2Path(request.path);
-        else if (beta == 1)
-            uut.addGAPIv1beta1Path(request.path);
-        else
-            uut.addGAPIv1Path(request.path);
-        request.path += request.options->parent.getProjectId().length() == 0 ? app_token->val[app_tk_ns::pid] : request.options->parent.getProjectId();
-        request.path += FPSTR("/databases");
-        if (!request.options->parent.isDatabaseIdParam())
+        // The Listen channel and operation paths are used as is.
+        if (request.options->requestType != firebase_firestore_request_type_listen && request.options->requestType != firebase_firestore_request_type_get_operation)
         {
-            request.path += '/';
-            request.path += request.options->parent.getDatabaseId().length() > 0 ? request.options->parent.getDatabaseId() : FPSTR("(default)");
+            if (beta == 2)
+                uut.addGAPIv1beta2Path(request.path);
+            else if (beta == 1)
+                uut.addGAPIv1beta1Path(request.path);
+            else
+                uut.addGAPIv1Path(request.path);
+            request.path += request.options->parent.getProjectId().length() == 0 ? app_token->val[app_tk_ns::pid] : request.options->parent.getProjectId();
+            request.path += FPSTR("/databases");
+            if (!request.options->parent.isDatabaseIdParam())
+            {
+                request.path += '/';
+                request.path += request.options->parent.getDatabaseId().length() > 0 ? request.options->parent.getDatabaseId() : FPSTR("(default)");
+            }
         }
         addParams(request, extras);
 
@@ -168,6 +574,8 @@ protected:
 
         if (request.options->payload.length())
         {
+            if (request.options->requestType == firebase_firestore_request_type_listen)
+                request.aClient->setContentType(sData, FPSTR("application/x-www-form-urlencoded"));
             sData->request.val[req_hndlr_ns::payload] = request.options->payload;
             request.aClient->setContentLength(sData, request.options->payload.length());
         }
@@ -175,10 +583,10 @@ protected:
         if (request.cb)
             sData->cb = request.cb;
 
-        request.aClient->addRemoveClientVec(reinterpret_cast<uint32_t>(&(cVec)), true);
+        request.aClient->addRemoveClientVec(cVec, true);
 
         if (request.aResult)
-            sData->setRefResult(request.aResult, reinterpret_cast<uint32_t>(&(request.aClient->rVec)));
+            sData->setRefResult(request.aResult);
 
         sData->download = request.method == async_request_handler_t::http_get && sData->request.file_data.filename.length();
 
@@ -213,7 +621,7 @@ protected:
         }
     }
 
-    void eximDocs(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const Firestore::Parent &parent, EximDocumentOptions &eximOptions, bool isImport, bool async)
+    void eximDocs(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const StringRef &uid, const Firestore::Parent &parent, EximDocumentOptions &eximOptions, bool isImport, bool async)
     {
         Firestore::DataOptions options;
         options.requestType = isImport ? firebase_firestore_request_type_import_docs : firebase_firestore_request_type_export_docs;
@@ -226,7 +634,7 @@ protected:
         asyncRequest(aReq);
     }
 
-    void manageDatabase(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const Firestore::Parent &parent, const String &database, const String &key, Firestore::firestore_database_mode mode, bool async)
+    void manageDatabase(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const StringRef &uid, const Firestore::Parent &parent, const String &database, const String &key, Firestore::firestore_database_mode mode, bool async)
     {
         Firestore::DataOptions options;
         options.requestType = firebase_firestore_request_type_manage_database;
@@ -270,7 +678,7 @@ protected:
         asyncRequest(aReq);
     }
 
-    void createDoc(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const Firestore::Parent &parent, const String &collectionId, const String &documentId, DocumentMask &mask, Document<Values::Value> &document, bool async)
+    void createDoc(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const StringRef &uid, const Firestore::Parent &parent, const String &collectionId, const String &documentId, DocumentMask &mask, Document<Values::Value> &document, bool async)
     {
         Firestore::DataOptions options;
         options.requestType = firebase_firestore_request_type_create_doc;
@@ -289,7 +697,7 @@ protected:
         asyncRequest(aReq);
     }
 
-    void patchDoc(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const Firestore::Parent &parent, const String &documentPath, PatchDocumentOptions patchOptions, Document<Values::Value> &document, bool async)
+    void patchDoc(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const StringRef &uid, const Firestore::Parent &parent, const String &documentPath, PatchDocumentOptions patchOptions, Document<Values::Value> &document, bool async)
     {
         Firestore::DataOptions options;
         options.requestType = firebase_firestore_request_type_patch_doc;
@@ -303,7 +711,7 @@ protected:
         asyncRequest(aReq);
     }
 
-    void commitDoc(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const Firestore::Parent &parent, Writes &writes, bool async)
+    void commitDoc(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const StringRef &uid, const Firestore::Parent &parent, Writes &writes, bool async)
     {
         Firestore::DataOptions options;
         options.requestType = firebase_firestore_request_type_commit_document;
@@ -316,7 +724,7 @@ protected:
         asyncRequest(aReq);
     }
 
-    void batchWriteDoc(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const Firestore::Parent &parent, Writes &writes, bool async)
+    void batchWriteDoc(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const StringRef &uid, const Firestore::Parent &parent, Writes &writes, bool async)
     {
         Firestore::DataOptions options;
         options.requestType = firebase_firestore_request_type_batch_write_doc;
@@ -329,77 +737,1354 @@ protected:
         asyncRequest(aReq);
     }
 
-    void getDoc(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const Firestore::Parent &parent, const String &documentPath, GetDocumentOptions getOptions, bool async)
+    bool beginWriter(AsyncClientClass &aClient, const Firestore::Parent &parent, FirestoreWriteStatusCallback statusCb, AsyncResultCallback cb, const StringRef &uid)
     {
-        Firestore::DataOptions options;
-        options.requestType = firebase_firestore_request_type_get_doc;
-        options.parent = parent;
-        addDocsPath(options.extras);
-        options.extras += '/';
-        options.extras += documentPath;
-        options.extras += getOptions.c_str();
-        async_request_data_t aReq(&aClient, path, async_request_handler_t::http_get, slot_options_t(false, false, async, false, false, false), &options, result, cb, uid);
-        asyncRequest(aReq);
+        if (writer)
+            return false;
+        writer = new batch_writer_t();
+        writer->aClient = &aClient;
+        writer->parent = parent;
+        writer->res_path = makeResourcePath(parent);
+        writer->statusCb = statusCb;
+        writer->cb = cb;
+        writer->uid = uid.toString();
+        writer->next = FPSTR("{\"writes\":[");
+        return true;
     }
 
-    void batchGetDoc(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const Firestore::Parent &parent, BatchGetDocumentOptions batchOptions, bool async)
+    bool addWriter(const Write &write)
     {
-        Firestore::DataOptions options;
-        options.requestType = firebase_firestore_request_type_batch_get_doc;
-        options.parent = parent;
-        options.payload = batchOptions.c_str();
-        options.payload.replace((const char *)RESOURCE_PATH_BASE, makeResourcePath(parent));
-        addDocsPath(options.extras);
-        options.extras += FPSTR(":batchGet");
-        async_request_data_t aReq(&aClient, path, async_request_handler_t::http_post, slot_options_t(false, false, async, false, false, false), &options, result, cb, uid);
-        asyncRequest(aReq);
+        if (!writer || writer->closed)
+            return false;
+
+        String w = write.c_str();
+        w.replace((const char *)RESOURCE_PATH_BASE, writer->res_path);
+
+        if (writer->next_count >= FIREBASE_FIRESTORE_BATCH_WRITE_LIMIT || (writer->next_count > 0 && writer->next.length() + w.length() + 3 > FIREBASE_FIRESTORE_BATCH_WRITE_SIZE))
+        {
+            // The next batch is full, wait for the batch in flight.
+            writer->full = true;
+            if (writer->sending)
+                return false;
+            sendWriterBatch(writer);
+        }
+
+        if (writer->next_count)
+            writer->next += ',';
+        writer->next += w;
+        writer->next_count++;
+        writer->total++;
+
+        if (!writer->sending && writer->next_count >= FIREBASE_FIRESTORE_BATCH_WRITE_LIMIT)
+            sendWriterBatch(writer);
+        return true;
     }
 
-    void beginTrans(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const Firestore::Parent &parent, TransactionOptions transOptions, bool async)
+    void sendWriterBatch(batch_writer_t *w)
     {
         Firestore::DataOptions options;
-        options.requestType = firebase_firestore_request_type_begin_transaction;
-        options.parent = parent;
-        JSONUtil jut;
-        jut.addObject(options.payload, "options", transOptions.c_str(), false, true);
+        options.requestType = firebase_firestore_request_type_batch_write_doc;
+        options.parent = w->parent;
+        w->next += FPSTR("]}");
+        options.payload = std::move(w->next);
+        w->next = FPSTR("{\"writes\":[");
         addDocsPath(options.extras);
-        options.extras += FPSTR(":beginTransaction");
-        async_request_data_t aReq(&aClient, path, async_request_handler_t::http_post, slot_options_t(false, false, async, false, false, false), &options, result, cb, uid);
+        options.extras += FPSTR(":batchWrite");
+
+        w->base = w->total - w->next_count;
+        w->sent_count = w->next_count;
+        w->next_count = 0;
+        w->full = false;
+        w->sending = true;
+        w->result.clear();
+        w->result.error_available = false;
+
+        async_request_data_t aReq(w->aClient, path, async_request_handler_t::http_post, slot_options_t(false, false, true, false, false, false), &options, &w->result, NULL, w->uid);
         asyncRequest(aReq);
     }
 
-    void transRollback(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const Firestore::Parent &parent, const String &transaction, bool async)
+    // Report the status of each write in batch from the status array of BatchWriteResponse.
+    void reportWriterBatch(batch_writer_t *w)
     {
-        Firestore::DataOptions options;
-        options.requestType = firebase_firestore_request_type_rollback;
-        options.parent = parent;
-        JSONUtil jut;
-        jut.addObject(options.payload, "transaction", transaction, true, true);
-        addDocsPath(options.extras);
-        options.extras += FPSTR(":rollback");
-        async_request_data_t aReq(&aClient, path, async_request_handler_t::http_post, slot_options_t(false, false, async, false, false, false), &options, result, cb, uid);
-        asyncRequest(aReq);
+        uint16_t j = 0;
+        if (w->result.error_available)
+        {
+            w->failed += w->sent_count;
+            for (; j < w->sent_count; j++)
+            {
+                if (w->statusCb)
+                    w->statusCb(w->base + j, w->result.lastError.code(), w->result.lastError.message());
+            }
+            return;
+        }
+
+        const String &payload = w->result.payload_val;
+        json_span_t s;
+        if (JsonPullParser::get(payload, "status", s))
+        {
+            JsonPullParser parser(payload.c_str() + s.start, s.length());
+            if (parser.next() == json_token_array_begin)
+            {
+                for (json_token_type t = parser.next(); t == json_token_object_begin && j < w->sent_count; t = parser.next(), j++)
+                {
+                    int code = 0;
+                    String message;
+                    uint8_t level = parser.depth();
+                    while (parser.next() == json_token_key && parser.depth() == level)
+                    {
+                        bool isCode = parser.equals("code", 4), isMessage = parser.equals("message", 7);
+                        parser.next();
+                        json_span_t v = parser.skipValue();
+                        if (!v.valid())
+                            break;
+                        if (isCode)
+                            code = atoi(payload.c_str() + s.start + v.start);
+                        else if (isMessage)
+                        {
+                            v = v.unquote(payload.c_str() + s.start);
+                            message = payload.substring(s.start + v.start, s.start + v.end);
+                        }
+                    }
+                    if (code)
+                        w->failed++;
+                    if (w->statusCb)
+                        w->statusCb(w->base + j, code, message);
+                }
+            }
+        }
+
+        // The write that has no status was applied.
+        for (; j < w->sent_count; j++)
+        {
+            if (w->statusCb)
+                w->statusCb(w->base + j, 0, "");
+        }
     }
 
-#if defined(ENABLE_FIRESTORE_QUERY)
-    void runQueryImpl(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const Firestore::Parent &parent, const String &documentPath, QueryOptions queryOptions, bool async)
+    void handleWriter()
     {
-        Firestore::DataOptions options;
-        options.requestType = firebase_firestore_request_type_run_query;
-        options.parent = parent;
-        options.parent.setDocPath(documentPath);
-        options.payload = queryOptions.c_str();
+        batch_writer_t *w = writer;
+        if (!w)
+            return;
 
-        addDocsPath(options.extras);
-        URLUtil uut;
-        uut.addPath(options.extras, documentPath);
-        options.extras += FPSTR(":runQuery");
-        async_request_data_t aReq(&aClient, path, async_request_handler_t::http_post, slot_options_t(false, false, async, false, false, false), &options, result, cb, uid);
-        asyncRequest(aReq);
+        if (w->sending && (w->result.data_available || w->result.error_available))
+        {
+            reportWriterBatch(w);
+            w->sending = false;
+        }
+
+        if (!w->sending && w->next_count && (w->closed || w->full || w->next_count >= FIREBASE_FIRESTORE_BATCH_WRITE_LIMIT))
+            sendWriterBatch(w);
+
+        if (w->sending || !w->closed || w->next_count)
+            return;
+
+        String summary = FPSTR("{\"writes\":");
+        summary += w->total;
+        summary += FPSTR(",\"failed\":");
+        summary += w->failed;
+        summary += '}';
+        w->result.setPayload(summary);
+        w->result.setDebug(FPSTR("Batch write complete"));
+        w->result.setUID(w->uid);
+
+        writer = nullptr;
+        if (w->cb)
+            w->cb(w->result);
+        delete w;
+    }
+
+    bool beginPipeline(AsyncClientClass &aClient, const Firestore::Parent &parent, FirestoreWriteStatusCallback statusCb, AsyncResultCallback cb, uint8_t window, const StringRef &uid)
+    {
+        if (pipeline)
+            return false;
+        pipeline = new pipeline_writer_t();
+        pipeline->aClient = &aClient;
+        pipeline->parent = parent;
+        pipeline->res_path = makeResourcePath(parent);
+        pipeline->statusCb = statusCb;
+        pipeline->cb = cb;
+        pipeline->window = window ? window : 1;
+        pipeline->uid = uid.toString();
+        return true;
+    }
+
+    bool addPipeline(const Write &write)
+    {
+        if (!pipeline || pipeline->closed || pipeline->writes.size() >= FIREBASE_FIRESTORE_PIPELINE_QUEUE_LIMIT)
+            return false;
+
+        pipeline_write_t *w = new pipeline_write_t();
+        w->payload = FPSTR("{\"writes\":[");
+        w->payload += write.c_str();
+        w->payload += FPSTR("]}");
+        w->payload.replace((const char *)RESOURCE_PATH_BASE, pipeline->res_path);
+
+        // The writes of the same document are sent one at a time in the order they were added.
+        if (!JsonPullParser::get(w->payload, "writes/0/update/name", w->document) && !JsonPullParser::get(w->payload, "writes/0/delete", w->document))
+            JsonPullParser::get(w->payload, "writes/0/transform/document", w->document);
+
+        pipeline->writes.push_back(w);
+        pipeline->total++;
+        sendPipeline(pipeline);
+        return true;
+    }
+
+    // Send the writes that are not in flight up to the window.
+    void sendPipeline(pipeline_writer_t *p)
+    {
+        uint8_t inflight = 0;
+        for (size_t i = 0; i < p->writes.size(); i++)
+        {
+            if (p->writes[i]->sending)
+                inflight++;
+        }
+
+        // The window is reduced on the lossy link when the link adaptation of async client is enabled.
+        uint8_t window = p->aClient->linkWindow(p->window);
+        for (size_t i = 0; i < p->writes.size() && inflight < window; i++)
+        {
+            pipeline_write_t *w = p->writes[i];
+            // The write that failed is sent again after the delay that grows with its attempts.
+            if (w->sending || w->done || (w->attempts && millis() - w->failed_ms < (unsigned long)FIREBASE_FIRESTORE_PIPELINE_RETRY_MS * w->attempts))
+                continue;
+
+            bool blocked = false;
+            for (size_t j = 0; j < i && !blocked; j++)
+                blocked = !p->writes[j]->done && w->document.length() && p->writes[j]->document == w->document;
+            if (blocked)
+                continue;
+
+            Firestore::DataOptions options;
+            options.requestType = firebase_firestore_request_type_commit_document;
+            options.parent = p->parent;
+            options.payload = w->payload;
+            addDocsPath(options.extras);
+            options.extras += FPSTR(":commit");
+
+            w->sending = true;
+            w->result.clear();
+            w->result.error_available = false;
+            inflight++;
+            async_request_data_t aReq(p->aClient, path, async_request_handler_t::http_post, slot_options_t(false, false, true, false, false, false), &options, &w->result, NULL, p->uid);
+            asyncRequest(aReq);
+        }
+    }
+
+    void handlePipeline()
+    {
+        pipeline_writer_t *p = pipeline;
+        if (!p)
+            return;
+
+        for (size_t i = 0; i < p->writes.size(); i++)
+        {
+            pipeline_write_t *w = p->writes[i];
+            if (!w->sending || (!w->result.data_available && !w->result.error_available))
+                continue;
+
+            w->sending = false;
+            int code = w->result.error_available ? w->result.lastError.code() : 0;
+            // The write that was not sent completely is sent again, the write that was sent before the receive timeout
+            // or disconnection may have been committed and its error is returned.
+            bool unsent = code == FIREBASE_ERROR_TCP_CONNECTION || code == FIREBASE_ERROR_TCP_SEND;
+            w->done = !(unsent && ++w->attempts < FIREBASE_FIRESTORE_PIPELINE_ATTEMPTS);
+            w->failed_ms = millis();
+        }
+
+        // The writes are acknowledged in the order they were added.
+        while (p->writes.size() && p->writes[0]->done)
+        {
+            pipeline_write_t *w = p->writes[0];
+            p->writes.erase(p->writes.begin());
+            int code = w->result.error_available ? w->result.lastError.code() : 0;
+            if (code)
+                p->failed++;
+            if (p->statusCb)
+                p->statusCb(p->base, code, code ? w->result.lastError.message() : String());
+            p->base++;
+            delete w;
+        }
+
+        sendPipeline(p);
+
+        if (!p->closed || p->writes.size())
+            return;
+
+        String summary = FPSTR("{\"writes\":");
+        summary += p->total;
+        summary += FPSTR(",\"failed\":");
+        summary += p->failed;
+        summary += '}';
+        p->result.setPayload(summary);
+        p->result.setDebug(FPSTR("Pipeline write complete"));
+        p->result.setUID(p->uid);
+
+        pipeline = nullptr;
+        if (p->cb)
+            p->cb(p->result);
+        delete p;
+    }
+
+    bool beginAccumulator(AsyncClientClass &aClient, const Firestore::Parent &parent, uint32_t intervalMs, uint16_t threshold, AsyncResultCallback cb, const StringRef &uid)
+    {
+        if (accumulator)
+            return false;
+        accumulator = new transform_acc_t();
+        accumulator->aClient = &aClient;
+        accumulator->parent = parent;
+        accumulator->interval_ms = intervalMs;
+        accumulator->threshold = threshold > 0 && threshold <= FIREBASE_FIRESTORE_BATCH_WRITE_LIMIT ? threshold : FIREBASE_FIRESTORE_BATCH_WRITE_LIMIT;
+        accumulator->cb = cb;
+        accumulator->uid = uid.toString();
+        accumulator->flush_ms = millis();
+        return true;
+    }
+
+    // Merge the transform into the last transform of the same field, the transform of other type is kept in order.
+    bool addTransform(const String &document, const String &field, transform_op op, bool dbl, int64_t i, double d, const String &element = "")
+    {
+        transform_acc_t *a = accumulator;
+        if (!a || a->closed)
+            return false;
+
+        transform_entry_t *e = nullptr;
+        for (size_t k = a->pending.size(); k > 0; k--)
+        {
+            if (a->pending[k - 1].document == document && a->pending[k - 1].field == field)
+            {
+                if (a->pending[k - 1].op == op)
+                    e = &a->pending[k - 1];
+                break;
+            }
+        }
+
+        if (!e)
+        {
+            transform_entry_t entry;
+            entry.document = document;
+            entry.field = field;
+            entry.op = op;
+            entry.dbl = dbl;
+            entry.i = i;
+            entry.d = dbl ? d : (double)i;
+            if (op == transform_op_append)
+                entry.elements.push_back(element);
+            a->pending.push_back(entry);
+            return true;
+        }
+
+        double v = dbl ? d : (double)i;
+        if (op == transform_op_increment)
+        {
+            e->i += i;
+            e->d += v;
+            e->dbl |= dbl;
+        }
+        else if (op == transform_op_append)
+        {
+            for (size_t k = 0; k < e->elements.size(); k++)
+            {
+                if (e->elements[k] == element)
+                    return true;
+            }
+            e->elements.push_back(element);
+        }
+        else if (op == transform_op_maximum ? v > e->d : v < e->d)
+        {
+            e->dbl = dbl;
+            e->i = i;
+            e->d = v;
+        }
+        return true;
+    }
+
+    void addTransformValue(String &buf, const transform_entry_t &e)
+    {
+        char tmp[FIREBASE_NUMBER_BUF_SIZE];
+        if (e.dbl)
+        {
+            NumberUtil::format(e.d, -1, tmp);
+            buf += FPSTR("{\"doubleValue\":");
+            buf += tmp;
+            buf += '}';
+        }
+        else
+        {
+            NumberUtil::format(e.i, tmp);
+            buf += FPSTR("{\"integerValue\":\"");
+            buf += tmp;
+            buf += FPSTR("\"}");
+        }
+    }
+
+    // The Writes of transforms, the transforms of the same document are in one write.
+    void makeTransforms(const std::vector<transform_entry_t> &entries, String &payload)
+    {
+        ObjectWriter owriter;
+        payload = FPSTR("{\"writes\":[");
+        std::vector<bool> done(entries.size(), false);
+        for (size_t k = 0; k < entries.size(); k++)
+        {
+            if (done[k])
+                continue;
+            if (k > 0)
+                payload += ',';
+            payload += FPSTR("{\"transform\":{\"document\":");
+            payload += owriter.makeResourcePath(entries[k].document, true);
+            payload += FPSTR(",\"fieldTransforms\":[");
+            for (size_t j = k; j < entries.size(); j++)
+            {
+                const transform_entry_t &e = entries[j];
+                if (done[j] || e.document != entries[k].document)
+                    continue;
+                done[j] = true;
+                if (j > k)
+                    payload += ',';
+                payload += FPSTR("{\"fieldPath\":\"");
+                payload += e.field;
+                payload += FPSTR("\",\"");
+                payload += e.op == transform_op_increment ? FPSTR("increment") : e.op == transform_op_maximum ? FPSTR("maximum")
+                                                                              : e.op == transform_op_minimum   ? FPSTR("minimum")
+                                                                                                               : FPSTR("appendMissingElements");
+                payload += FPSTR("\":");
+                if (e.op == transform_op_append)
+                {
+                    payload += FPSTR("{\"values\":[");
+                    for (size_t n = 0; n < e.elements.size(); n++)
+                    {
+                        if (n > 0)
+                            payload += ',';
+                        payload += e.elements[n];
+                    }
+                    payload += FPSTR("]}");
+                }
+                else
+                    addTransformValue(payload, e);
+                payload += '}';
+            }
+            payload += FPSTR("]}}");
+        }
+        payload += FPSTR("]}");
+    }
+
+    // Commit the pending transforms up to the threshold.
+    void sendTransforms(transform_acc_t *a)
+    {
+        size_t count = a->pending.size() > a->threshold ? a->threshold : a->pending.size();
+        a->sent.assign(a->pending.begin(), a->pending.begin() + count);
+        a->pending.erase(a->pending.begin(), a->pending.begin() + count);
+
+        Firestore::DataOptions options;
+        options.requestType = firebase_firestore_request_type_commit_document;
+        options.parent = a->parent;
+        makeTransforms(a->sent, options.payload);
+        options.payload.replace((const char *)RESOURCE_PATH_BASE, makeResourcePath(a->parent));
+        addDocsPath(options.extras);
+        options.extras += FPSTR(":commit");
+
+        a->sending = true;
+        a->flush = false;
+        a->flush_ms = millis();
+        a->result.clear();
+        a->result.error_available = false;
+        async_request_data_t aReq(a->aClient, path, async_request_handler_t::http_post, slot_options_t(false, false, true, false, false, false), &options, &a->result, NULL, a->uid);
+        asyncRequest(aReq);
+    }
+
+    void handleTransforms()
+    {
+        transform_acc_t *a = accumulator;
+        if (!a)
+            return;
+
+        if (a->sending && (a->result.data_available || a->result.error_available))
+        {
+            a->sending = false;
+            int code = a->result.error_available ? a->result.lastError.code() : 0;
+            // The transforms are committed again when the commit was not reached or the service was unavailable.
+            if (a->result.error_available && (code < 0 || code == FIREBASE_ERROR_HTTP_CODE_TOO_MANY_REQUESTS || code >= FIREBASE_ERROR_HTTP_CODE_INTERNAL_SERVER_ERROR))
+                a->pending.insert(a->pending.begin(), a->sent.begin(), a->sent.end());
+            a->sent.clear();
+            a->result.setUID(a->uid);
+            if (a->cb)
+                a->cb(a->result);
+        }
+
+        if (a->sending)
+            return;
+
+        if (a->pending.size() && (a->flush || a->closed || a->pending.size() >= a->threshold || (a->interval_ms > 0 && millis() - a->flush_ms >= a->interval_ms)))
+        {
+            sendTransforms(a);
+            return;
+        }
+
+        if (a->closed && a->pending.size() == 0)
+        {
+            accumulator = nullptr;
+            delete a;
+        }
+    }
+
+    void beginList(list_task_t *t)
+    {
+        listVec.push_back(t);
+        requestListPage(t);
+    }
+
+    // Request the page of iteration into the current result.
+    void requestListPage(list_task_t *t)
+    {
+        AsyncResult &r = t->result[t->current];
+        r.clear();
+        r.error_available = false;
+        if (t->collections)
+            listCollIds(*t->aClient, &r, NULL, t->uid, t->parent, t->path, t->collOptions, true);
+        else
+            listDocs(*t->aClient, &r, NULL, t->uid, t->parent, t->path, t->docsOptions, true);
+    }
+
+    void handleList()
+    {
+        for (size_t i = listVec.size(); i > 0; i--)
+        {
+            list_task_t *t = listVec[i - 1];
+            if (!t || (!t->result[t->current].data_available && !t->result[t->current].error_available))
+                continue;
+
+            AsyncResult &r = t->result[t->current];
+            const String &payload = r.payload_val;
+
+            // Prefetch the next page before delivering the items of this page.
+            String token;
+            bool more = !r.error_available && JsonPullParser::get(payload, "nextPageToken", token) && token.length();
+            if (more)
+            {
+                if (t->collections)
+                    t->collOptions.pageToken(token);
+                else
+                    t->docsOptions.pageToken(token);
+                t->current ^= 1;
+                requestListPage(t);
+            }
+
+            json_span_t s;
+            if (!r.error_available && JsonPullParser::get(payload, t->collections ? "collectionIds" : "documents", s))
+            {
+                const char *buf = payload.c_str() + s.start;
+                JsonPullParser parser(buf, s.length());
+                if (parser.next() == json_token_array_begin)
+                {
+                    for (json_token_type tk = parser.next(); tk != json_token_array_end && tk != json_token_end && tk != json_token_error; tk = parser.next())
+                    {
+                        json_span_t v = parser.skipValue();
+                        if (!v.valid())
+                            break;
+                        if (tk == json_token_string)
+                            v = v.unquote(buf);
+                        if (t->itemCb)
+                            t->itemCb(payload.substring(s.start + v.start, s.start + v.end));
+                    }
+                }
+            }
+
+            if (more)
+            {
+                r.clear();
+                continue;
+            }
+
+            if (!r.error_available)
+            {
+                r.payload_val.remove(0, r.payload_val.length());
+                r.setDebug(FPSTR("Iteration complete"));
+            }
+            r.setUID(t->uid);
+            if (t->cb)
+                t->cb(r);
+
+            listVec.erase(listVec.begin() + i - 1);
+            delete t;
+        }
+    }
+
+    bool isDocFresh(uint32_t key)
+    {
+        for (size_t i = 0; i < freshVec.size(); i++)
+        {
+            if (freshVec[i].key == key)
+                return millis() - freshVec[i].ms < doc_ttl_ms;
+        }
+        return false;
+    }
+
+    void setDocFresh(uint32_t key)
+    {
+        for (size_t i = freshVec.size(); i > 0; i--)
+        {
+            // The evicted documents are removed.
+            if (freshVec[i - 1].key == key || doc_cache.etag(freshVec[i - 1].key).length() == 0)
+                freshVec.erase(freshVec.begin() + i - 1);
+        }
+        doc_fresh_t f;
+        f.key = key;
+        f.ms = millis();
+        freshVec.push_back(f);
+    }
+
+    void returnDoc(doc_task_t *t, AsyncResult &r)
+    {
+        r.setUID(t->uid);
+        if (t->aResult)
+            *t->aResult = r;
+        if (t->cb)
+            t->cb(r);
+    }
+
+    // The get that is served from the document cache when the document is fresh or its updateTime was not changed.
+    void getDocCached(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const StringRef &uid, const Firestore::Parent &parent, const String &documentPath, const GetDocumentOptions &getOptions)
+    {
+        String query = getOptions.c_str();
+        if (!doc_cache.isEnabled() || query.indexOf("transaction=") > -1 || query.indexOf("readTime=") > -1)
+            return getDoc(aClient, result, cb, uid, parent, documentPath, getOptions, true);
+
+        doc_task_t *t = new doc_task_t();
+        t->aClient = &aClient;
+        t->parent = parent;
+        t->path = documentPath;
+        t->uid = uid.toString();
+        t->options = getOptions;
+        t->aResult = result;
+        t->cb = cb;
+        t->key = ResponseCache::hash(makeResourcePath(parent) + '/' + documentPath + query);
+
+        String body;
+        if (isDocFresh(t->key) && doc_cache.get(t->key, body))
+        {
+            t->result.setPayload(body);
+            t->result.setDebug(FPSTR("Document served from cache"));
+            returnDoc(t, t->result);
+            delete t;
+            return;
+        }
+
+        docVec.push_back(t);
+        t->validating = doc_cache.etag(t->key).length() > 0;
+        // Only the name and updateTime are returned with the mask that has no fields.
+        getDoc(aClient, &t->result, NULL, uid, parent, documentPath, t->validating ? GetDocumentOptions(DocumentMask("__name__")) : getOptions, true);
+    }
+
+    void handleDocCache()
+    {
+        for (size_t i = docVec.size(); i > 0; i--)
+        {
+            doc_task_t *t = docVec[i - 1];
+            if (!t || (!t->result.data_available && !t->result.error_available))
+                continue;
+
+            String updateTime;
+            if (!t->result.error_available)
+                JsonPullParser::get(t->result.payload_val, "updateTime", updateTime);
+
+            if (t->validating && !t->result.error_available)
+            {
+                String body;
+                if (updateTime.length() && updateTime == doc_cache.etag(t->key) && doc_cache.get(t->key, body))
+                {
+                    setDocFresh(t->key);
+                    t->result.setPayload(body);
+                    t->result.setDebug(FPSTR("Document validated from cache"));
+                }
+                else
+                {
+                    // The document was changed, fetch its body.
+                    t->validating = false;
+                    t->result.clear();
+                    getDoc(*t->aClient, &t->result, NULL, t->uid, t->parent, t->path, t->options, true);
+                    continue;
+                }
+            }
+            else if (t->result.error_available)
+            {
+                // The document was deleted.
+                if (t->result.lastError.code() == FIREBASE_ERROR_HTTP_CODE_NOT_FOUND)
+                    doc_cache.remove(t->key);
+            }
+            else
+            {
+                doc_cache.put(t->key, updateTime, t->result.payload_val);
+                setDocFresh(t->key);
+            }
+
+            returnDoc(t, t->result);
+            docVec.erase(docVec.begin() + i - 1);
+            delete t;
+        }
+    }
+
+    void beginListen(listen_task_t *t)
+    {
+        // The slots of subscription are stopped by their UID.
+        if (t->uid.length() == 0)
+        {
+            t->uid = FPSTR("listen_");
+            t->uid += (unsigned long)reinterpret_cast<uintptr_t>(t);
+        }
+        listenVec.push_back(t);
+        openListen(t);
+    }
+
+    String listenDatabase(listen_task_t *t)
+    {
+        app_token_t *app_token = appToken();
+        String db = FPSTR("projects/");
+        db += t->parent.getProjectId().length() == 0 && app_token ? app_token->val[app_tk_ns::pid] : t->parent.getProjectId();
+        db += FPSTR("/databases/");
+        db += t->parent.getDatabaseId().length() > 0 ? t->parent.getDatabaseId() : FPSTR("(default)");
+        return db;
+    }
+
+    void listenRequest(listen_task_t *t, Firestore::DataOptions &options, async_request_handler_t::http_request_method method)
+    {
+        URLUtil uut;
+        options.requestType = firebase_firestore_request_type_listen;
+        options.parent = t->parent;
+        String extras = options.extras;
+        options.extras = FPSTR("?database=");
+        options.extras += uut.encode(listenDatabase(t));
+        options.extras += FPSTR("&VER=8");
+        options.extras += extras;
+        options.extras += FPSTR("&zx=");
+        options.extras += random(0x7fffffff);
+        options.extras += FPSTR("&t=1");
+
+        t->result.clear();
+        t->result.error_available = false;
+        t->aClient->setPayloadSink(t->sink);
+        async_request_data_t aReq(t->aClient, FPSTR("/google.firestore.v1.Firestore/Listen/channel"), method, slot_options_t(false, false, true, false, false, false), &options, &t->result, NULL, t->uid);
+        asyncRequest(aReq);
+        // The sink is not used when the request was not added.
+        t->aClient->reqSink = nullptr;
+    }
+
+    // Open the channel with the target, the target is resumed from the last resume token.
+    void openListen(listen_task_t *t)
+    {
+        URLUtil uut;
+        String req = FPSTR("{\"database\":\"");
+        req += listenDatabase(t);
+        req += FPSTR("\",\"addTarget\":{");
+        req += t->target;
+        req.replace((const char *)RESOURCE_PATH_BASE, listenDatabase(t) + FPSTR("/documents"));
+        req += FPSTR(",\"targetId\":1");
+        if (t->sink.resume_token.length())
+        {
+            req += FPSTR(",\"resumeToken\":\"");
+            req += t->sink.resume_token;
+            req += '"';
+        }
+        req += FPSTR("}}");
+
+        Firestore::DataOptions options;
+        options.payload = FPSTR("count=1&ofs=0&req0___data__=");
+        options.payload += uut.encode(req);
+        options.extras = FPSTR("&RID=");
+        options.extras += 10000 + random(90000);
+        options.extras += FPSTR("&CVER=22");
+
+        t->polling = false;
+        t->sink.reset();
+        listenRequest(t, options, async_request_handler_t::http_post);
+    }
+
+    // Receive the changes from the back channel, the messages that were received are acknowledged.
+    void pollListen(listen_task_t *t)
+    {
+        Firestore::DataOptions options;
+        options.extras = FPSTR("&RID=rpc&SID=");
+        options.extras += t->sink.sid;
+        options.extras += FPSTR("&AID=");
+        options.extras += t->sink.aid;
+        options.extras += FPSTR("&CI=0&TYPE=xmlhttp");
+
+        t->polling = true;
+        listenRequest(t, options, async_request_handler_t::http_get);
+    }
+
+    // The exponential delay with jitter for the retry count.
+    unsigned long backoffDelay(uint8_t retry)
+    {
+        unsigned long delay = FIREBASE_SSE_BACKOFF_MIN;
+        for (uint8_t i = 0; i < retry && delay < FIREBASE_SSE_BACKOFF_MAX; i++)
+            delay *= 2;
+        if (delay > FIREBASE_SSE_BACKOFF_MAX)
+            delay = FIREBASE_SSE_BACKOFF_MAX;
+        return delay / 2 + random(delay / 2 + 1);
+    }
+
+    void setListenBackoff(listen_task_t *t)
+    {
+        t->delay_ms = backoffDelay(t->retry);
+        if (t->retry < 255)
+            t->retry++;
+        t->retry_ms = millis();
+        t->waiting = true;
+    }
+
+    void handleListen()
+    {
+        for (size_t i = listenVec.size(); i > 0; i--)
+        {
+            listen_task_t *t = listenVec[i - 1];
+            if (!t)
+                continue;
+
+            if (t->waiting)
+            {
+                if (millis() - t->retry_ms >= t->delay_ms)
+                {
+                    t->waiting = false;
+                    openListen(t);
+                }
+                continue;
+            }
+
+            if (!t->result.data_available && !t->result.error_available)
+                continue;
+
+            if (t->sink.isStopped())
+            {
+                t->result.clear();
+                t->result.error_available = false;
+                t->result.setDebug(FPSTR("Listen stopped"));
+                t->result.setUID(t->uid);
+                if (t->cb)
+                    t->cb(t->result);
+                listenVec.erase(listenVec.begin() + i - 1);
+                delete t;
+                continue;
+            }
+
+            // The idle back channel is timed out and the session is still valid.
+            bool timeout = t->result.error_available && t->result.lastError.code() == FIREBASE_ERROR_TCP_RECEIVE_TIMEOUT;
+
+            if (t->result.error_available && !timeout)
+            {
+                t->result.setUID(t->uid);
+                if (t->cb)
+                    t->cb(t->result);
+                setListenBackoff(t);
+            }
+            else if (t->sink.sid.length() && !t->sink.closed)
+            {
+                t->retry = 0;
+                pollListen(t);
+            }
+            else
+                openListen(t);
+        }
+    }
+
+    void stopListenImpl(const StringRef &uid)
+    {
+        for (size_t i = 0; i < listenVec.size(); i++)
+        {
+            listen_task_t *t = listenVec[i];
+            if (!t || (uid.length() && !uid.equals(t->uid)))
+                continue;
+            t->sink.stop();
+            if (t->waiting)
+            {
+                // Complete at the next loop.
+                t->waiting = false;
+                t->result.data_available = true;
+            }
+            else
+                t->aClient->stopAsyncImpl(false, t->uid);
+        }
+    }
+
+    void getDoc(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const StringRef &uid, const Firestore::Parent &parent, const String &documentPath, GetDocumentOptions getOptions, bool async)
+    {
+        Firestore::DataOptions options;
+        options.requestType = firebase_firestore_request_type_get_doc;
+        options.parent = parent;
+        addDocsPath(options.extras);
+        options.extras += '/';
+        options.extras += documentPath;
+        options.extras += getOptions.c_str();
+        async_request_data_t aReq(&aClient, path, async_request_handler_t::http_get, slot_options_t(false, false, async, false, false, false), &options, result, cb, uid);
+        asyncRequest(aReq);
+    }
+
+    void batchGetDoc(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const StringRef &uid, const Firestore::Parent &parent, BatchGetDocumentOptions batchOptions, bool async)
+    {
+        Firestore::DataOptions options;
+        options.requestType = firebase_firestore_request_type_batch_get_doc;
+        options.parent = parent;
+        options.payload = batchOptions.c_str();
+        options.payload.replace((const char *)RESOURCE_PATH_BASE, makeResourcePath(parent));
+        addDocsPath(options.extras);
+        options.extras += FPSTR(":batchGet");
+        async_request_data_t aReq(&aClient, path, async_request_handler_t::http_post, slot_options_t(false, false, async, false, false, false), &options, result, cb, uid);
+        asyncRequest(aReq);
+    }
+
+    void batchGetStream(AsyncClientClass &aClient, FirestoreQueryCallback entryCb, AsyncResultCallback cb, const StringRef &uid, const Firestore::Parent &parent, BatchGetDocumentOptions batchOptions)
+    {
+        batch_get_task_t *t = new batch_get_task_t(entryCb);
+        t->aClient = &aClient;
+        t->parent = parent;
+        t->uid = uid.toString();
+        t->cb = cb;
+        t->body = batchOptions.c_str();
+        // The documents are requested at once when the new transaction is started in the first response.
+        json_span_t s;
+        if (!JsonPullParser::get(t->body, "newTransaction", s) && JsonPullParser::get(t->body, "documents", t->docs) && t->body[t->docs.start] == '[')
+            t->next = t->docs.start + 1;
+        batchGetVec.push_back(t);
+        // The empty documents array is sent as is.
+        if (!sendBatchGetPart(t))
+        {
+            t->next = 0;
+            sendBatchGetPart(t);
+        }
+    }
+
+    // Request the next part of up to FIREBASE_FIRESTORE_BATCH_GET_LIMIT documents, returns false when no document is left.
+    bool sendBatchGetPart(batch_get_task_t *t)
+    {
+        BatchGetDocumentOptions part;
+        if (t->next > 0)
+        {
+            JsonPullParser parser(t->body.c_str() + t->next, t->docs.end - t->next);
+            int end = 0;
+            uint16_t count = 0;
+            String names;
+            while (count < FIREBASE_FIRESTORE_BATCH_GET_LIMIT && parser.next() == json_token_string)
+            {
+                json_span_t v = parser.skipValue();
+                if (count++ > 0)
+                    names += ',';
+                names.concat(t->body.c_str() + t->next + v.start, v.length());
+                end = v.end;
+            }
+
+            if (count == 0)
+                return false;
+
+            t->next += end;
+            String body = t->body.substring(0, t->docs.start);
+            body += '[';
+            body += names;
+            body += ']';
+            body += t->body.c_str() + t->docs.end;
+            part.setContent(body);
+        }
+        else if (t->next < 0)
+            return false;
+        else
+        {
+            // All documents are in one request.
+            part.setContent(t->body);
+            t->next = -1;
+        }
+
+        t->result.clear();
+        t->result.error_available = false;
+        t->aClient->setPayloadSink(t->sink);
+        batchGetDoc(*t->aClient, &t->result, NULL, t->uid, t->parent, part, true);
+        // The sink is not used when the request was not added.
+        t->aClient->reqSink = nullptr;
+        return true;
+    }
+
+    void handleBatchGet()
+    {
+        for (size_t i = batchGetVec.size(); i > 0; i--)
+        {
+            batch_get_task_t *t = batchGetVec[i - 1];
+            if (!t || (!t->result.data_available && !t->result.error_available))
+                continue;
+
+            if (!t->result.error_available && !t->sink.isStopped() && sendBatchGetPart(t))
+                continue;
+
+            if (!t->result.error_available)
+                t->result.setDebug(t->sink.isStopped() ? FPSTR("Batch get stopped") : FPSTR("Batch get complete"));
+            t->result.setUID(t->uid);
+            if (t->cb)
+                t->cb(t->result);
+
+            batchGetVec.erase(batchGetVec.begin() + i - 1);
+            delete t;
+        }
+    }
+
+    void waitOperationImpl(AsyncClientClass &aClient, const String &operation, AsyncResultCallback cb, const StringRef &uid)
+    {
+        operation_task_t *t = new operation_task_t();
+        t->aClient = &aClient;
+        t->cb = cb;
+        t->uid = uid.toString();
+
+        // The Operation JSON of the response is parsed for its name and state.
+        String done;
+        if (operation.length() && operation[0] == '{')
+        {
+            JsonPullParser::get(operation, "name", t->name);
+            JsonPullParser::get(operation, "done", done);
+            t->result.payload_val = operation;
+        }
+        else
+            t->name = operation;
+
+        operationVec.push_back(t);
+
+        if (t->name.indexOf("/operations/") == -1)
+        {
+            t->result.error_available = true;
+            t->result.lastError.setClientError(FIREBASE_ERROR_INVALID_ARGUMENT);
+        }
+        else if (done == "true")
+            t->result.data_available = true;
+        else
+            setOperationDelay(t, FIREBASE_FIRESTORE_OPERATION_POLL_MIN);
+    }
+
+    void pollOperation(operation_task_t *t)
+    {
+        Firestore::DataOptions options;
+        options.requestType = firebase_firestore_request_type_get_operation;
+        String path = FPSTR("/v1/");
+        path += t->name;
+        t->waiting = false;
+        t->result.clear();
+        t->result.error_available = false;
+        async_request_data_t aReq(t->aClient, path, async_request_handler_t::http_get, slot_options_t(false, false, true, false, false, false), &options, &t->result, NULL, t->uid);
+        asyncRequest(aReq);
+    }
+
+    void setOperationDelay(operation_task_t *t, unsigned long delay)
+    {
+        if (delay < FIREBASE_FIRESTORE_OPERATION_POLL_MIN)
+            delay = FIREBASE_FIRESTORE_OPERATION_POLL_MIN;
+        if (delay > FIREBASE_FIRESTORE_OPERATION_POLL_MAX)
+            delay = FIREBASE_FIRESTORE_OPERATION_POLL_MAX;
+        t->delay_ms = delay;
+        t->poll_ms = millis();
+        t->waiting = true;
+    }
+
+    // The next poll is at half of the remaining time that was estimated from the progress rate, or after the delay
+    // grown by half when the progress is unknown or not changed.
+    unsigned long nextOperationDelay(operation_task_t *t)
+    {
+        const String &payload = t->result.payload_val;
+        unsigned long delay = t->delay_ms + t->delay_ms / 2;
+        String completed, estimated;
+        if (!(JsonPullParser::get(payload, "metadata/progressDocuments/completedWork", completed) && JsonPullParser::get(payload, "metadata/progressDocuments/estimatedWork", estimated)) &&
+            !(JsonPullParser::get(payload, "metadata/progressBytes/completedWork", completed) && JsonPullParser::get(payload, "metadata/progressBytes/estimatedWork", estimated)))
+            return delay;
+
+        uint64_t work = strtoull(completed.c_str(), nullptr, 10), total = strtoull(estimated.c_str(), nullptr, 10);
+        if (work > t->work && t->work_ms)
+        {
+            uint64_t remaining = total > work ? (total - work) * (millis() - t->work_ms) / (work - t->work) : 0;
+            delay = remaining / 2 < FIREBASE_FIRESTORE_OPERATION_POLL_MAX ? remaining / 2 : FIREBASE_FIRESTORE_OPERATION_POLL_MAX;
+        }
+        if (work != t->work || !t->work_ms)
+        {
+            t->work = work;
+            t->work_ms = millis();
+        }
+        return delay;
+    }
+
+    void handleOperation()
+    {
+        for (size_t i = operationVec.size(); i > 0; i--)
+        {
+            operation_task_t *t = operationVec[i - 1];
+            if (!t)
+                continue;
+
+            if (t->waiting)
+            {
+                if (millis() - t->poll_ms >= t->delay_ms)
+                    pollOperation(t);
+                continue;
+            }
+
+            if (!t->result.data_available && !t->result.error_available)
+                continue;
+
+            String done, message;
+            if (t->result.error_available)
+            {
+                // The network and server errors are retried with the grown delay.
+                int code = t->result.lastError.code();
+                if ((code == FIREBASE_ERROR_HTTP_CODE_TOO_MANY_REQUESTS || code >= FIREBASE_ERROR_HTTP_CODE_INTERNAL_SERVER_ERROR || (code < 0 && code > FIREBASE_ERROR_NETWORK_DISCONNECTED)) && t->retry < FIREBASE_FIRESTORE_OPERATION_RETRY)
+                {
+                    t->retry++;
+                    setOperationDelay(t, t->delay_ms * 2);
+                    continue;
+                }
+            }
+            else if (!JsonPullParser::get(t->result.payload_val, "done", done) || done != "true")
+            {
+                t->retry = 0;
+                setOperationDelay(t, nextOperationDelay(t));
+                continue;
+            }
+            else if (JsonPullParser::get(t->result.payload_val, "error/message", message))
+            {
+                // The failed operation is the client error with the message of operation error, it is not the HTTP status.
+                t->result.error_available = true;
+                t->result.lastError.setLastError(FIREBASE_ERROR_SERVER_RESPONSE, message);
+            }
+            else
+                t->result.setDebug(FPSTR("Operation complete"));
+
+            t->result.setUID(t->uid);
+            if (t->cb)
+                t->cb(t->result);
+
+            operationVec.erase(operationVec.begin() + i - 1);
+            delete t;
+        }
+    }
+
+    void beginTrans(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const StringRef &uid, const Firestore::Parent &parent, TransactionOptions transOptions, bool async)
+    {
+        Firestore::DataOptions options;
+        options.requestType = firebase_firestore_request_type_begin_transaction;
+        options.parent = parent;
+        JSONUtil jut;
+        jut.addObject(options.payload, "options", transOptions.c_str(), false, true);
+        addDocsPath(options.extras);
+        options.extras += FPSTR(":beginTransaction");
+        async_request_data_t aReq(&aClient, path, async_request_handler_t::http_post, slot_options_t(false, false, async, false, false, false), &options, result, cb, uid);
+        asyncRequest(aReq);
+    }
+
+    void transRollback(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const StringRef &uid, const Firestore::Parent &parent, const String &transaction, bool async)
+    {
+        Firestore::DataOptions options;
+        options.requestType = firebase_firestore_request_type_rollback;
+        options.parent = parent;
+        JSONUtil jut;
+        jut.addObject(options.payload, "transaction", transaction, true, true);
+        addDocsPath(options.extras);
+        options.extras += FPSTR(":rollback");
+        async_request_data_t aReq(&aClient, path, async_request_handler_t::http_post, slot_options_t(false, false, async, false, false, false), &options, result, cb, uid);
+        asyncRequest(aReq);
+    }
+
+    void beginTransRunner(trans_task_t *t)
+    {
+        transVec.push_back(t);
+        sendTransBegin(t);
+    }
+
+    // Begin the transaction, the aborted transaction is retried with its Id.
+    void sendTransBegin(trans_task_t *t)
+    {
+        t->step = trans_step_begin;
+        t->result.clear();
+        t->result.error_available = false;
+        beginTrans(*t->aClient, &t->result, NULL, t->uid, t->parent, TransactionOptions(ReadWrite(t->transaction)), true);
+    }
+
+    // Read all documents in one batchGet request.
+    void sendTransRead(trans_task_t *t)
+    {
+        BatchGetDocumentOptions reads = t->reads;
+        reads.transaction(t->transaction);
+        t->step = trans_step_read;
+        t->result.clear();
+        t->result.error_available = false;
+        batchGetDoc(*t->aClient, &t->result, NULL, t->uid, t->parent, reads, true);
+    }
+
+    void sendTransCommit(trans_task_t *t, const std::vector<Write> &writes)
+    {
+        Firestore::DataOptions options;
+        options.requestType = firebase_firestore_request_type_commit_document;
+        options.parent = t->parent;
+        options.payload = FPSTR("{\"writes\":[");
+        for (size_t i = 0; i < writes.size(); i++)
+        {
+            if (i > 0)
+                options.payload += ',';
+            options.payload += writes[i].c_str();
+        }
+        options.payload += FPSTR("],\"transaction\":\"");
+        options.payload += t->transaction;
+        options.payload += FPSTR("\"}");
+        options.payload.replace((const char *)RESOURCE_PATH_BASE, makeResourcePath(t->parent));
+        addDocsPath(options.extras);
+        options.extras += FPSTR(":commit");
+
+        t->step = trans_step_commit;
+        t->result.clear();
+        t->result.error_available = false;
+        async_request_data_t aReq(t->aClient, path, async_request_handler_t::http_post, slot_options_t(false, false, true, false, false, false), &options, &t->result, NULL, t->uid);
+        asyncRequest(aReq);
+    }
+
+    void sendTransRollback(trans_task_t *t)
+    {
+        t->step = trans_step_rollback;
+        t->result.clear();
+        t->result.error_available = false;
+        transRollback(*t->aClient, &t->result, NULL, t->uid, t->parent, t->transaction, true);
+    }
+
+    void handleTrans()
+    {
+        for (size_t i = transVec.size(); i > 0; i--)
+        {
+            trans_task_t *t = transVec[i - 1];
+            if (!t)
+                continue;
+
+            if (t->waiting)
+            {
+                if (millis() - t->retry_ms >= t->delay_ms)
+                {
+                    t->waiting = false;
+                    sendTransBegin(t);
+                }
+                continue;
+            }
+
+            if (!t->result.data_available && !t->result.error_available)
+                continue;
+
+            bool done = true;
+            if (t->result.error_available)
+            {
+                // The transaction was aborted by the contention, retry after the backoff delay.
+                if (t->result.lastError.code() == FIREBASE_ERROR_HTTP_CODE_CONFLICT && t->step != trans_step_rollback && t->attempt + 1 < t->max_attempts)
+                {
+                    t->delay_ms = backoffDelay(t->attempt++);
+                    t->retry_ms = millis();
+                    t->waiting = true;
+                    done = false;
+                }
+                // The aborted transaction was already ended by server, the other failures of read and commit are rolled back.
+                else if (t->result.lastError.code() != FIREBASE_ERROR_HTTP_CODE_CONFLICT && (t->step == trans_step_read || t->step == trans_step_commit) && t->transaction.length())
+                {
+                    t->error_code = t->result.lastError.code();
+                    t->error_message = t->result.lastError.message();
+                    sendTransRollback(t);
+                    done = false;
+                }
+            }
+            else if (t->step == trans_step_begin)
+            {
+                JsonPullParser::get(t->result.payload_val, "transaction", t->transaction);
+                sendTransRead(t);
+                done = false;
+            }
+            else if (t->step == trans_step_read)
+            {
+                std::vector<Write> writes;
+                if (t->fn && t->fn(t->result.payload_val, writes))
+                    sendTransCommit(t, writes);
+                else
+                    sendTransRollback(t);
+                done = false;
+            }
+            else
+                t->result.setDebug(t->step == trans_step_commit ? FPSTR("Transaction committed") : FPSTR("Transaction rolled back"));
+
+            if (!done)
+                continue;
+
+            if (t->error_code)
+            {
+                t->result.data_available = false;
+                t->result.error_available = true;
+                t->result.lastError.setLastError(t->error_code, t->error_message);
+            }
+
+            t->result.setUID(t->uid);
+            if (t->cb)
+                t->cb(t->result);
+            transVec.erase(transVec.begin() + i - 1);
+            delete t;
+        }
+    }
+
+#if defined(ENABLE_FIRESTORE_QUERY)
+    void runQueryImpl(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const StringRef &uid, const Firestore::Parent &parent, const String &documentPath, QueryOptions queryOptions, bool async)
+    {
+        Firestore::DataOptions options;
+        options.requestType = firebase_firestore_request_type_run_query;
+        options.parent = parent;
+        options.parent.setDocPath(documentPath);
+        options.payload = queryOptions.c_str();
+
+        addDocsPath(options.extras);
+        URLUtil uut;
+        uut.addPath(options.extras, documentPath);
+        options.extras += FPSTR(":runQuery");
+        async_request_data_t aReq(&aClient, path, async_request_handler_t::http_post, slot_options_t(false, false, async, false, false, false), &options, result, cb, uid);
+        asyncRequest(aReq);
+    }
+
+    void runAggregationQueryImpl(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const StringRef &uid, const Firestore::Parent &parent, const String &documentPath, AggregationQueryOptions queryOptions, bool async)
+    {
+        Firestore::DataOptions options;
+        options.requestType = firebase_firestore_request_type_run_aggregation_query;
+        options.parent = parent;
+        options.parent.setDocPath(documentPath);
+        options.payload = queryOptions.c_str();
+
+        addDocsPath(options.extras);
+        URLUtil uut;
+        uut.addPath(options.extras, documentPath);
+        options.extras += FPSTR(":runAggregationQuery");
+        async_request_data_t aReq(&aClient, path, async_request_handler_t::http_post, slot_options_t(false, false, async, false, false, false), &options, result, cb, uid);
+        asyncRequest(aReq);
+    }
+
+    void runQueryStream(AsyncClientClass &aClient, FirestoreQueryCallback docCb, AsyncResultCallback cb, const StringRef &uid, const Firestore::Parent &parent, const String &documentPath, QueryOptions queryOptions)
+    {
+        query_task_t *t = new query_task_t(docCb);
+        t->cb = cb;
+        t->uid = uid.toString();
+        queryVec.push_back(t);
+        aClient.setPayloadSink(t->sink);
+        runQueryImpl(aClient, &t->result, NULL, uid, parent, documentPath, queryOptions, true);
+        // The sink is not used when the request was not added.
+        aClient.reqSink = nullptr;
+    }
+
+    void handleQuery()
+    {
+        for (size_t i = queryVec.size(); i > 0; i--)
+        {
+            query_task_t *t = queryVec[i - 1];
+            if (!t || (!t->result.data_available && !t->result.error_available))
+                continue;
+
+            if (!t->result.error_available)
+                t->result.setDebug(t->sink.isStopped() ? FPSTR("Query stopped") : FPSTR("Query complete"));
+            t->result.setUID(t->uid);
+            if (t->cb)
+                t->cb(t->result);
+
+            queryVec.erase(queryVec.begin() + i - 1);
+            delete t;
+        }
     }
 #endif
 
-    void deleteDocBase(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const Firestore::Parent &parent, const String &documentPath, Precondition currentDocument, bool async)
+    void deleteDocBase(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const StringRef &uid, const Firestore::Parent &parent, const String &documentPath, Precondition currentDocument, bool async)
     {
         Firestore::DataOptions options;
         options.requestType = firebase_firestore_request_type_delete_doc;
@@ -414,7 +2099,7 @@ protected:
         asyncRequest(aReq);
     }
 
-    void listDocs(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const Firestore::Parent &parent, const String &collectionId, ListDocumentsOptions listDocsOptions, bool async)
+    void listDocs(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const StringRef &uid, const Firestore::Parent &parent, const String &collectionId, ListDocumentsOptions listDocsOptions, bool async)
     {
         Firestore::DataOptions options;
         options.requestType = firebase_firestore_request_type_list_doc;
@@ -429,7 +2114,7 @@ protected:
         asyncRequest(aReq);
     }
 
-    void listCollIds(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const Firestore::Parent &parent, const String &documentPath, ListCollectionIdsOptions listCollectionIdsOptions, bool async)
+    void listCollIds(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const StringRef &uid, const Firestore::Parent &parent, const String &documentPath, ListCollectionIdsOptions listCollectionIdsOptions, bool async)
     {
         Firestore::DataOptions options;
         options.requestType = firebase_firestore_request_type_list_collection;
@@ -446,7 +2131,7 @@ protected:
         asyncRequest(aReq);
     }
 
-    void databaseIndexManager(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const Firestore::Parent &parent, DatabaseIndex::Index index, const String &indexId, bool deleteMode, bool async)
+    void databaseIndexManager(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const StringRef &uid, const Firestore::Parent &parent, DatabaseIndex::Index index, const String &indexId, bool deleteMode, bool async)
     {
         Firestore::DataOptions options;
         options.requestType = firebase_firestore_request_type_create_field_index;
@@ -470,7 +2155,7 @@ protected:
         asyncRequest(aReq, 1);
     }
 
-    void collectionGroupIndexManager(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const Firestore::Parent &parent, CollectionGroupsIndex::Index index, const String &collectionId, const String &indexId, bool deleteMode, bool async)
+    void collectionGroupIndexManager(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const StringRef &uid, const Firestore::Parent &parent, CollectionGroupsIndex::Index index, const String &collectionId, const String &indexId, bool deleteMode, bool async)
     {
         Firestore::DataOptions options;
         options.requestType = firebase_firestore_request_type_create_composite_index;
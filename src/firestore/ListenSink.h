@@ -0,0 +1,186 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef ASYNC_FIRESTORE_LISTEN_SINK_H
+#define ASYNC_FIRESTORE_LISTEN_SINK_H
+
+#include <Arduino.h>
+#include "./Config.h"
+#include "./core/JsonParser.h"
+
+#if defined(ENABLE_FIRESTORE)
+
+/**
+ * The callback of listen subscription that receives each change event.
+ * The type is the member of ListenResponse e.g. targetChange, documentChange, documentDelete, documentRemove and filter,
+ * the data is the JSON object of that member.
+ */
+typedef void (*FirestoreListenCallback)(const String &type, const String &data);
+
+// The payload sink of Listen channel that parses the WebChannel frames as they arrive, only one frame is kept in memory.
+class ListenSink : public Print
+{
+private:
+    FirestoreListenCallback cb = NULL;
+    String frame;
+    uint8_t depth = 0;
+    bool in_str = false, esc = false, stopped = false;
+
+    // The frame is the array of [array id, [message]] e.g. [[1,[{"documentChange":{...}}]]] or [[0,["c","SID","",8]]].
+    void parseFrame()
+    {
+        JsonPullParser parser(frame);
+        if (parser.next() != json_token_array_begin)
+            return;
+
+        while (parser.next() == json_token_array_begin)
+        {
+            if (parser.next() != json_token_primitive)
+                return;
+            aid = atoi(frame.c_str() + parser.span().start);
+
+            if (parser.next() != json_token_array_begin)
+                return;
+
+            uint8_t level = parser.depth();
+            json_token_type t = parser.next();
+            if (t == json_token_string)
+            {
+                // The control message.
+                if (parser.equals("c", 1) && parser.next() == json_token_string)
+                    sid = frame.substring(parser.span().start, parser.span().end);
+                else if (parser.equals("close", 5))
+                    closed = true;
+            }
+
+            for (; t == json_token_object_begin; t = parser.next())
+                parseResponse(parser);
+
+            // Skip to the end of this element.
+            while (parser.depth() >= level - 1 && t != json_token_end && t != json_token_error)
+                t = parser.next();
+            if (t == json_token_end || t == json_token_error)
+                return;
+        }
+    }
+
+    void parseResponse(JsonPullParser &parser)
+    {
+        uint8_t level = parser.depth();
+        while (parser.next() == json_token_key && parser.depth() == level)
+        {
+            String type = frame.substring(parser.span().start, parser.span().end);
+            parser.next();
+            json_span_t v = parser.skipValue();
+            if (!v.valid())
+                return;
+            String data = frame.substring(v.start, v.end);
+            if (type == "targetChange")
+            {
+                String token;
+                if (JsonPullParser::get(data, "resumeToken", token) && token.length())
+                    resume_token = token;
+            }
+            if (cb)
+                cb(type, data);
+        }
+    }
+
+public:
+    // The session Id of channel.
+    String sid;
+    // The resume token of last target change, it is used for resuming the target in new channel.
+    String resume_token;
+    // The array id of last message that was received.
+    int32_t aid = -1;
+    // The server closed the channel.
+    bool closed = false;
+
+    ListenSink(FirestoreListenCallback cb = NULL) : cb(cb) {}
+
+    // Prepare for the new channel, the resume token is kept.
+    void reset()
+    {
+        frame.remove(0, frame.length());
+        sid.remove(0, sid.length());
+        depth = 0;
+        in_str = false;
+        esc = false;
+        aid = -1;
+        closed = false;
+    }
+
+    // Stop receiving, the connection is closed at the next write.
+    void stop() { stopped = true; }
+
+    bool isStopped() const { return stopped; }
+
+    size_t write(uint8_t c) override
+    {
+        if (stopped)
+            return 0;
+
+        // The length of frame is not used, the frame is the top level array.
+        if (depth == 0 && c != '[')
+            return 1;
+
+        frame += (char)c;
+
+        if (in_str)
+        {
+            if (esc)
+                esc = false;
+            else if (c == '\\')
+                esc = true;
+            else if (c == '"')
+                in_str = false;
+            return 1;
+        }
+
+        if (c == '"')
+            in_str = true;
+        else if (c == '{' || c == '[')
+            depth++;
+        else if ((c == '}' || c == ']') && depth > 0 && --depth == 0)
+        {
+            parseFrame();
+            frame.remove(0, frame.length());
+        }
+        return 1;
+    }
+
+    size_t write(const uint8_t *buf, size_t size) override
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            if (write(buf[i]) == 0)
+                return i;
+        }
+        return size;
+    }
+};
+
+#endif
+
+#endif
@@ -46,6 +46,39 @@ namespace FirestoreQuery
     StructuredQuery &StructuredQuery::offset(int value) { return wr.set<StructuredQuery &, int>(*this, value, buf, bufSize, 7, FPSTR(__func__)); }
     StructuredQuery &StructuredQuery::limit(int value) { return wr.set<StructuredQuery &, int>(*this, value, buf, bufSize, 8, FPSTR(__func__)); }
 
+    Aggregation::Aggregation() {}
+    Aggregation &Aggregation::alias(const String &value) { return wr.set<Aggregation &, String>(*this, value, buf, bufSize, 1, FPSTR(__func__)); }
+    Aggregation &Aggregation::count(int64_t upTo)
+    {
+        BaseO1 v;
+        if (upTo > 0)
+        {
+            String str = FPSTR("{\"upTo\":\"");
+            str += NumberUtil::toString(upTo);
+            str += FPSTR("\"}");
+            v.setContent(str);
+        }
+        else
+            v.setContent(FPSTR("{}"));
+        return wr.set<Aggregation &, BaseO1>(*this, v, buf, bufSize, 2, FPSTR(__func__));
+    }
+    Aggregation &Aggregation::sum(const FieldReference &field)
+    {
+        BaseO1 v;
+        v.setContent(String(FPSTR("{\"field\":")) + field.c_str() + '}');
+        return wr.set<Aggregation &, BaseO1>(*this, v, buf, bufSize, 2, FPSTR(__func__));
+    }
+    Aggregation &Aggregation::avg(const FieldReference &field)
+    {
+        BaseO1 v;
+        v.setContent(String(FPSTR("{\"field\":")) + field.c_str() + '}');
+        return wr.set<Aggregation &, BaseO1>(*this, v, buf, bufSize, 2, FPSTR(__func__));
+    }
+
+    StructuredAggregationQuery::StructuredAggregationQuery() {}
+    StructuredAggregationQuery &StructuredAggregationQuery::structuredQuery(const StructuredQuery &value) { return wr.set<StructuredAggregationQuery &, StructuredQuery>(*this, value, buf, bufSize, 1, FPSTR(__func__)); }
+    StructuredAggregationQuery &StructuredAggregationQuery::aggregations(const Aggregation &value) { return wr.append<StructuredAggregationQuery &, Aggregation>(*this, value, buf, bufSize, 2, FPSTR(__func__)); }
+
     CompositeFilter::CompositeFilter() {}
     CompositeFilter &CompositeFilter::op(CompositFilterOperator::OPERATOR_TYPE value) { return wr.set<CompositeFilter &, const char *>(*this, CompositFilterOperator::_OPERATOR_TYPE[value].text, buf, bufSize, 1, FPSTR(__func__)); }
     CompositeFilter &CompositeFilter::filters(const Filter &value) { return wr.append<CompositeFilter &, Filter>(*this, value, buf, bufSize, 2, FPSTR(__func__)); }
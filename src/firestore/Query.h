@@ -31,6 +31,7 @@
 #if defined(ENABLE_FIRESTORE) && defined(ENABLE_FIRESTORE_QUERY)
 
 #include "./firestore/Values.h"
+#include "./firestore/FieldSet.h"
 
 namespace FirestoreQuery
 {
@@ -131,6 +132,13 @@ namespace FirestoreQuery
         // A reference to a field in a document.
         Projection(const FieldReference &value) { Projection::fields(value); }
 
+        // The references to the fields in the field set.
+        Projection(const FieldSet &fieldSet)
+        {
+            for (size_t i = 0; i < fieldSet.size(); i++)
+                Projection::fields(FieldReference(fieldSet[i]));
+        }
+
         // This value represents the item to add to an array.
         // A reference to a field in a document.
         Projection &fields(const FieldReference &value) { return wr.append<Projection &, FieldReference>(*this, value, buf, bufSize, 1, FPSTR(__func__)); }
@@ -249,6 +257,44 @@ namespace FirestoreQuery
         StructuredQuery &limit(int value);
     };
 
+    /**
+     * An aggregation over the results of query, only one of count, sum and avg can be set.
+     */
+    class Aggregation : public BaseO4
+    {
+    public:
+        Aggregation();
+
+        // Optional. The name of the field to store the result of aggregation into.
+        Aggregation &alias(const String &value);
+
+        // The count of documents that match the query.
+        // upTo The maximum number of documents to count, 0 for no limit.
+        Aggregation &count(int64_t upTo = 0);
+
+        // The sum of the values of the requested field, the non-numeric values are ignored.
+        Aggregation &sum(const FieldReference &field);
+
+        // The average of the values of the requested field, the non-numeric values are ignored.
+        Aggregation &avg(const FieldReference &field);
+    };
+
+    /**
+     * A Firestore query for running an aggregation over a StructuredQuery.
+     */
+    class StructuredAggregationQuery : public BaseO4
+    {
+    public:
+        StructuredAggregationQuery();
+
+        // Nested structured query.
+        StructuredAggregationQuery &structuredQuery(const StructuredQuery &value);
+
+        // This value represents the item to add to an array.
+        // The series of aggregations to apply over the results of the structuredQuery, up to 5 aggregations.
+        StructuredAggregationQuery &aggregations(const Aggregation &value);
+    };
+
     /**
      * A filter that merges multiple other filters using the given operator.
      */
@@ -0,0 +1,124 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef ASYNC_FIRESTORE_QUERY_SINK_H
+#define ASYNC_FIRESTORE_QUERY_SINK_H
+
+#include <Arduino.h>
+#include "./Config.h"
+#include "./core/JsonParser.h"
+
+#if defined(ENABLE_FIRESTORE)
+
+// The callback that receives each document of query (or each entry of batchGet), returns false to stop the query.
+typedef bool (*FirestoreQueryCallback)(const String &document);
+
+// The payload sink of runQuery and batchGet that parses the array of results as it arrives, only one result is kept in memory.
+class QuerySink : public Print
+{
+private:
+    FirestoreQueryCallback cb = NULL;
+    // The member of result to deliver, the whole result is delivered when it is null.
+    const char *member = nullptr;
+    String item;
+    size_t count = 0;
+    uint8_t depth = 0;
+    bool in_str = false, esc = false, stopped = false;
+
+    // Deliver the document of result and release the result buffer.
+    void deliver()
+    {
+        json_span_t s;
+        if (!member)
+        {
+            count++;
+            if (cb && !cb(item))
+                stopped = true;
+        }
+        else if (JsonPullParser::get(item, member, s))
+        {
+            count++;
+            if (cb && !cb(item.substring(s.start, s.end)))
+                stopped = true;
+        }
+        item.remove(0, item.length());
+    }
+
+public:
+    QuerySink(FirestoreQueryCallback cb = NULL, const char *member = "document") : cb(cb), member(member) {}
+
+    size_t write(uint8_t c) override
+    {
+        if (stopped)
+            return 0;
+
+        // The element of top level array.
+        if (depth > 1 || (depth == 1 && c != ',' && c != ']' && c != ' ' && c != '\r' && c != '\n' && c != '\t'))
+            item += (char)c;
+
+        if (in_str)
+        {
+            if (esc)
+                esc = false;
+            else if (c == '\\')
+                esc = true;
+            else if (c == '"')
+                in_str = false;
+            return 1;
+        }
+
+        if (c == '"')
+            in_str = true;
+        else if (c == '{' || c == '[')
+            depth++;
+        else if (c == '}' || c == ']')
+        {
+            if (depth > 0)
+                depth--;
+            if (depth == 1)
+                deliver();
+        }
+        return 1;
+    }
+
+    size_t write(const uint8_t *buf, size_t size) override
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            if (write(buf[i]) == 0)
+                return i;
+        }
+        return size;
+    }
+
+    // The numbers of documents that were delivered.
+    size_t size() const { return count; }
+
+    // The query was stopped by the callback.
+    bool isStopped() const { return stopped; }
+};
+
+#endif
+
+#endif
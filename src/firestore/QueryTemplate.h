@@ -0,0 +1,213 @@
+/**
+ * Created October 14, 2026
+ *
+ * The MIT License (MIT)
+ * Copyright (c) 2026 K. Suwatchai (Mobizt)
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person returning a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef FIRESTORE_QUERY_TEMPLATE_H
+#define FIRESTORE_QUERY_TEMPLATE_H
+
+#include <Arduino.h>
+#include <vector>
+#include "./Config.h"
+
+#if defined(ENABLE_FIRESTORE) && defined(ENABLE_FIRESTORE_QUERY)
+
+#include "./core/Number.h"
+#include "./core/Scan.h"
+#include "./core/JsonEscape.h"
+#include "./firestore/DataOptions.h"
+
+/**
+ * The query that was serialized once with the named parameters.
+ *
+ * The parameter is declared as the string value "{{name}}" in the query e.g. Values::Value(Values::StringValue("{{since}}")),
+ * the value object of parameter is replaced by the typed value that was bound, then the query options are built
+ * by copying the serialized parts and the bound values. The parameter that is declared more than once is bound at all places.
+ */
+class QueryTemplate
+{
+private:
+    struct query_param_t
+    {
+    public:
+        String name, value;
+        // The span of parameter in the template.
+        size_t start = 0, end = 0;
+        // The parameter is the whole value object e.g. {"stringValue":"{{name}}"}.
+        bool object = false;
+    };
+
+    String tpl;
+    std::vector<query_param_t> params;
+
+    void compile()
+    {
+        static const char *obj = "{\"stringValue\":";
+        size_t obj_len = strlen(obj), len = tpl.length();
+        const char *buf = tpl.c_str();
+        size_t pos = 0;
+        while (pos < len)
+        {
+            size_t p = pos + Scan::find(buf + pos, len - pos, "\"{{", 3);
+            if (p >= len)
+                break;
+            size_t q = p + 3 + Scan::find(buf + p + 3, len - p - 3, "}}\"", 3);
+            if (q >= len)
+                break;
+
+            query_param_t prm;
+            prm.name = tpl.substring(p + 3, q);
+            prm.start = p;
+            prm.end = q + 3;
+            if (p >= obj_len && strncmp(buf + p - obj_len, obj, obj_len) == 0 && prm.end < len && buf[prm.end] == '}')
+            {
+                prm.object = true;
+                prm.start = p - obj_len;
+                prm.end++;
+            }
+            params.push_back(prm);
+            pos = prm.end;
+        }
+    }
+
+    // The value is bound to all parameters of the same name.
+    QueryTemplate &setParam(const String &name, const char *type, const String &text, bool quoted)
+    {
+        for (size_t i = 0; i < params.size(); i++)
+        {
+            if (params[i].name != name)
+                continue;
+
+            String &v = params[i].value;
+            v.remove(0, v.length());
+            if (params[i].object)
+            {
+                v += FPSTR("{\"");
+                v += type;
+                v += FPSTR("\":");
+            }
+            if (quoted)
+                v += '"';
+            v += text;
+            if (quoted)
+                v += '"';
+            if (params[i].object)
+                v += '}';
+        }
+        return *this;
+    }
+
+public:
+    /**
+     * Compile the query options.
+     * @param options The QueryOptions that the parameters were declared as the string values "{{name}}".
+     */
+    QueryTemplate(const QueryOptions &options) : tpl(options.c_str()) { compile(); }
+
+    // The numbers of parameters.
+    size_t size() const { return params.size(); }
+
+    // Bind the integer value.
+    QueryTemplate &bind(const String &name, int64_t value)
+    {
+        char tmp[FIREBASE_NUMBER_BUF_SIZE];
+        NumberUtil::format(value, tmp);
+        return setParam(name, "integerValue", tmp, true);
+    }
+
+    QueryTemplate &bind(const String &name, int value) { return bind(name, (int64_t)value); }
+
+    // Bind the double value.
+    QueryTemplate &bind(const String &name, double value)
+    {
+        char tmp[FIREBASE_NUMBER_BUF_SIZE];
+        NumberUtil::format(value, -1, tmp);
+        return setParam(name, "doubleValue", tmp, false);
+    }
+
+    // Bind the boolean value.
+    QueryTemplate &bind(const String &name, bool value) { return setParam(name, "booleanValue", value ? FPSTR("true") : FPSTR("false"), false); }
+
+    // Bind the string value.
+    QueryTemplate &bind(const String &name, const String &value)
+    {
+        String s;
+        s.reserve(value.length());
+        JsonEscape::append(s, value);
+        return setParam(name, "stringValue", s, true);
+    }
+
+    QueryTemplate &bind(const String &name, const char *value) { return bind(name, String(value)); }
+
+    // Bind the timestamp value in RFC3339 UTC "Zulu" format e.g. "2014-10-02T15:01:23Z".
+    QueryTemplate &bindTimestamp(const String &name, const String &value) { return setParam(name, "timestampValue", value, true); }
+
+    // Bind the value object e.g. Values::Value(Values::MapValue(...)), it replaces the whole parameter.
+    QueryTemplate &bind(const String &name, const Values::Value &value)
+    {
+        for (size_t i = 0; i < params.size(); i++)
+        {
+            if (params[i].name == name)
+                params[i].value = value.c_str();
+        }
+        return *this;
+    }
+
+    /**
+     * Build the query options with the bound values.
+     * The parameter that was not bound keeps its declared value.
+     * @return QueryOptions The query options to run.
+     */
+    QueryOptions options() const
+    {
+        size_t len = tpl.length();
+        for (size_t i = 0; i < params.size(); i++)
+        {
+            if (params[i].value.length())
+                len += params[i].value.length() - (params[i].end - params[i].start);
+        }
+
+        String buf;
+        buf.reserve(len);
+        size_t pos = 0;
+        for (size_t i = 0; i < params.size(); i++)
+        {
+            const query_param_t &prm = params[i];
+            if (prm.value.length() == 0)
+                continue;
+            for (size_t j = pos; j < prm.start; j++)
+                buf += tpl[j];
+            buf += prm.value;
+            pos = prm.end;
+        }
+        for (size_t j = pos; j < tpl.length(); j++)
+            buf += tpl[j];
+
+        QueryOptions options;
+        options.setContent(buf);
+        return options;
+    }
+};
+
+#endif
+
+#endif
@@ -28,6 +28,10 @@
 #include <Arduino.h>
 #include "./Config.h"
 #include "./core/ObjectWriter.h"
+#include "./core/Number.h"
+#include "./core/JsonEscape.h"
+#include "./core/FileConfig.h"
+#include "./core/Base64.h"
 
 #if defined(ENABLE_FIRESTORE)
 
@@ -256,6 +260,25 @@ namespace Values
             buf = StringValue(value).c_str();
             getVal();
         }
+
+        /**
+         * A bytes value of binary data.
+         * The data is base64 encoded when the value is created, the data is not used after that.
+         * @param data The binary data.
+         * @param len The length of data.
+         */
+        BytesValue(const uint8_t *data, size_t len)
+        {
+            Memory mem;
+            Base64Util but;
+            char *enc = but.encodeToChars(mem, data, len);
+            buf = "\"";
+            if (enc)
+                buf += enc;
+            buf += "\"";
+            mem.release(&enc);
+            getVal();
+        }
         const char *c_str() const { return buf.c_str(); }
         const char *val() { return getVal(); }
         size_t printTo(Print &p) const { return p.print(str.c_str()); }
@@ -458,6 +481,269 @@ namespace Values
             str.remove(0, str.length());
         }
     };
+    /**
+     * The compact value tree of document fields, each value is the node with type tag and inline scalar
+     * or child index. The keys and strings are kept in one buffer and the JSON is written at once when sending.
+     * The node index that returned from add functions is used as the parent of map and array values.
+     */
+    class ValueTree : public Printable
+    {
+    private:
+        struct value_node_t
+        {
+            uint8_t type = firestore_const_key_nullValue;
+            uint16_t key_len = 0;
+            uint32_t key_pos = 0;
+            union
+            {
+                bool b;
+                int64_t i;
+                double d;
+                struct
+                {
+                    uint32_t pos, len;
+                } s;
+            } v;
+            int32_t first_child = -1, last_child = -1, next_sibling = -1;
+            value_node_t() { v.i = 0; }
+        };
+
+        std::vector<value_node_t> nodes;
+        String pool;
+
+        void append(const char *str, size_t len)
+        {
+            for (size_t i = 0; i < len; i++)
+                pool += str[i];
+        }
+
+        int add(int parent, const char *key, uint8_t type)
+        {
+            if (parent < 0 || parent >= (int)nodes.size() || (nodes[parent].type != firestore_const_key_mapValue && nodes[parent].type != firestore_const_key_arrayValue))
+                return -1;
+
+            value_node_t n;
+            n.type = type;
+            if (nodes[parent].type == firestore_const_key_mapValue && key)
+            {
+                n.key_pos = pool.length();
+                n.key_len = strlen(key);
+                append(key, n.key_len);
+            }
+
+            int idx = nodes.size();
+            if (nodes[parent].last_child == -1)
+                nodes[parent].first_child = idx;
+            else
+                nodes[nodes[parent].last_child].next_sibling = idx;
+            nodes[parent].last_child = idx;
+            nodes.push_back(n);
+            return idx;
+        }
+
+        int addText(int parent, const char *key, uint8_t type, const String &value)
+        {
+            int idx = add(parent, key, type);
+            if (idx > -1)
+            {
+                nodes[idx].v.s.pos = pool.length();
+                nodes[idx].v.s.len = value.length();
+                append(value.c_str(), value.length());
+            }
+            return idx;
+        }
+
+        size_t printRaw(Print &out, uint32_t pos, uint32_t len) const { return out.write((const uint8_t *)pool.c_str() + pos, len); }
+
+        size_t printString(Print &out, uint32_t pos, uint32_t len) const
+        {
+            size_t n = out.print('"');
+            n += JsonEscape::print(out, pool.c_str() + pos, len);
+            return n + out.print('"');
+        }
+
+        size_t printNumber(Print &out, const value_node_t &n) const
+        {
+            char tmp[FIREBASE_NUMBER_BUF_SIZE];
+            if (n.type == firestore_const_key_integerValue)
+            {
+                // The integer value is string in JSON.
+                NumberUtil::format(n.v.i, tmp);
+                return out.print('"') + out.print(tmp) + out.print('"');
+            }
+            NumberUtil::format(n.v.d, -1, tmp);
+            return out.print(tmp);
+        }
+
+        size_t printFields(Print &out, int idx) const
+        {
+            const value_node_t &n = nodes[idx];
+            bool map = n.type == firestore_const_key_mapValue;
+            size_t len = out.print('{');
+            if (n.first_child > -1)
+            {
+                len += out.print('"');
+                len += out.print(map ? FPSTR("fields") : FPSTR("values"));
+                len += out.print(FPSTR("\":"));
+                len += out.print(map ? '{' : '[');
+                for (int c = n.first_child; c > -1; c = nodes[c].next_sibling)
+                {
+                    if (c != n.first_child)
+                        len += out.print(',');
+                    if (map)
+                    {
+                        len += printString(out, nodes[c].key_pos, nodes[c].key_len);
+                        len += out.print(':');
+                    }
+                    len += printValue(out, c);
+                }
+                len += out.print(map ? '}' : ']');
+            }
+            return len + out.print('}');
+        }
+
+        size_t printValue(Print &out, int idx) const
+        {
+            const value_node_t &n = nodes[idx];
+            size_t len = out.print(FPSTR("{\""));
+            len += out.print(FPSTR(firestore_const_key[n.type].text));
+            len += out.print(FPSTR("\":"));
+
+            switch (n.type)
+            {
+            case firestore_const_key_nullValue:
+                len += out.print(FPSTR("null"));
+                break;
+            case firestore_const_key_booleanValue:
+                len += out.print(n.v.b ? FPSTR("true") : FPSTR("false"));
+                break;
+            case firestore_const_key_integerValue:
+            case firestore_const_key_doubleValue:
+                len += printNumber(out, n);
+                break;
+            case firestore_const_key_geoPointValue:
+                len += out.print(FPSTR("{\"latitude\":"));
+                len += printNumber(out, nodes[n.first_child]);
+                len += out.print(FPSTR(",\"longitude\":"));
+                len += printNumber(out, nodes[nodes[n.first_child].next_sibling]);
+                len += out.print('}');
+                break;
+            case firestore_const_key_arrayValue:
+            case firestore_const_key_mapValue:
+                len += printFields(out, idx);
+                break;
+            default:
+                len += printString(out, n.v.s.pos, n.v.s.len);
+                break;
+            }
+            return len + out.print('}');
+        }
+
+    public:
+        // The node index of document fields (root map).
+        static const int root = 0;
+
+        ValueTree() { clear(); }
+
+        int addNull(int parent, const char *key) { return add(parent, key, firestore_const_key_nullValue); }
+
+        int addBoolean(int parent, const char *key, bool value)
+        {
+            int idx = add(parent, key, firestore_const_key_booleanValue);
+            if (idx > -1)
+                nodes[idx].v.b = value;
+            return idx;
+        }
+
+        int addInteger(int parent, const char *key, int64_t value)
+        {
+            int idx = add(parent, key, firestore_const_key_integerValue);
+            if (idx > -1)
+                nodes[idx].v.i = value;
+            return idx;
+        }
+
+        int addDouble(int parent, const char *key, double value)
+        {
+            int idx = add(parent, key, firestore_const_key_doubleValue);
+            if (idx > -1)
+                nodes[idx].v.d = value;
+            return idx;
+        }
+
+        int addString(int parent, const char *key, const String &value) { return addText(parent, key, firestore_const_key_stringValue, value); }
+
+        // The timestamp in RFC3339 UTC "Zulu" format.
+        int addTimestamp(int parent, const char *key, const String &value) { return addText(parent, key, firestore_const_key_timestampValue, value); }
+
+        // The base64-encoded bytes.
+        int addBytes(int parent, const char *key, const String &value) { return addText(parent, key, firestore_const_key_bytesValue, value); }
+
+        // The resource name of document.
+        int addReference(int parent, const char *key, const String &value) { return addText(parent, key, firestore_const_key_referenceValue, value); }
+
+        int addGeoPoint(int parent, const char *key, double lat, double lng)
+        {
+            int idx = add(parent, key, firestore_const_key_geoPointValue);
+            if (idx > -1)
+            {
+                // The latitude and longitude are kept in the child nodes.
+                value_node_t n;
+                n.type = firestore_const_key_doubleValue;
+                n.v.d = lat;
+                n.next_sibling = nodes.size() + 1;
+                nodes[idx].first_child = nodes.size();
+                nodes.push_back(n);
+                n.v.d = lng;
+                n.next_sibling = -1;
+                nodes.push_back(n);
+            }
+            return idx;
+        }
+
+        // The array cannot directly contain another array value.
+        int addArray(int parent, const char *key)
+        {
+            if (parent > -1 && parent < (int)nodes.size() && nodes[parent].type == firestore_const_key_arrayValue)
+                return -1;
+            return add(parent, key, firestore_const_key_arrayValue);
+        }
+
+        int addMap(int parent, const char *key) { return add(parent, key, firestore_const_key_mapValue); }
+
+        void clear()
+        {
+            nodes.clear();
+            pool.remove(0, pool.length());
+            value_node_t n;
+            n.type = firestore_const_key_mapValue;
+            nodes.push_back(n);
+        }
+
+        // The numbers of values.
+        size_t size() const { return nodes.size() - 1; }
+
+        // Write the document fields e.g. {"fields":{"name":{"stringValue":"Jack"}}}.
+        size_t printTo(Print &out) const { return printFields(out, root); }
+
+        // The exact length of document fields JSON.
+        size_t length() const
+        {
+            CountPrint counter;
+            return printTo(counter);
+        }
+
+        // Serialize the document fields with exact capacity.
+        void create(String &buf) const
+        {
+            size_t len = length();
+            buf.remove(0, buf.length());
+            buf.reserve(len);
+            StringPrint out(buf, len);
+            printTo(out);
+        }
+    };
+
     /**
      * A message that can hold any of the supported value types.
      */
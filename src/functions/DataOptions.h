@@ -443,52 +443,36 @@ namespace GoogleCloudFunctions
     struct ListOptions : public BaseO6
     {
 
-    protected:
-        ObjectWriter owriter;
-        StringUtil sut;
-
-        ListOptions &setBuf()
-        {
-            owriter.clear(buf[0]);
-            for (size_t i = 1; i < bufSize; i++)
-            {
-                if (buf[i].length())
-                {
-                    if (buf[0].length())
-                        buf[0] += '&';
-                    buf[0] += buf[i];
-                }
-            }
-            return *this;
-        }
-
     public:
+        // The query parameters are joined with '&'.
+        ListOptions() { buf.setFormat(0, '&', 0); }
+
         // Maximum number of functions to return per call. The largest allowed pageSize is 1,000, if the pageSize is omitted or specified as greater than 1,000 then it will be replaced as 1,000. The size of the list response can be less than specified when used with filters.
         ListOptions &pageSize(uint64_t value)
         {
-            buf[1] = "pageSize=" + sut.u64Str(value);
-            return setBuf();
+            buf.set(1, "pageSize=" + NumberUtil::toString(value));
+            return *this;
         }
 
         // The value returned by the last ListFunctionsResponse; indicates that this is a continuation of a prior functions.list call, and that the system should return the next page of data.
         ListOptions &pageToken(const String &value)
         {
-            buf[2] = "pageToken=" + value;
-            return setBuf();
+            buf.set(2, "pageToken=" + value);
+            return *this;
         }
 
         // The filter for Functions that match the filter expression, following the syntax outlined in https://google.aip.dev/160.
         ListOptions &filter(const String &value)
         {
-            buf[3] = "filter=" + value;
-            return setBuf();
+            buf.set(3, "filter=" + value);
+            return *this;
         }
 
         // The sorting order of the resources returned. Value should be a comma separated list of fields. The default sorting oder is ascending. See https://google.aip.dev/132#ordering.
         ListOptions &orderBy(const String &value)
         {
-            buf[4] = "orderBy=" + value;
-            return setBuf();
+            buf.set(4, "orderBy=" + value);
+            return *this;
         }
     };
 
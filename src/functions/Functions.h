@@ -27,6 +27,7 @@
 #include <Arduino.h>
 #include "./core/FirebaseApp.h"
 #include "./functions/DataOptions.h"
+#include "./core/ResponseCache.h"
 using namespace std;
 
 using namespace firebase;
@@ -37,9 +38,30 @@ class CloudFunctions
 {
 
 public:
-    std::vector<uint32_t> cVec; // AsyncClient vector
+    std::vector<list_handle_t> cVec; // AsyncClient handles
+
+    ~CloudFunctions()
+    {
+        for (size_t i = 0; i < cacheVec.size(); i++)
+        {
+            cache_task_t *t = cacheVec[i];
+            if (t)
+            {
+                detachResult(t->client_handle, &t->result);
+                delete t;
+            }
+        }
+        cacheVec.clear();
+
+        for (size_t i = 0; i < uploadVec.size(); i++)
+        {
+            source_upload_t *t = uploadVec[i];
+            if (t)
+                delete t;
+        }
+        uploadVec.clear();
+    }
 
-    ~CloudFunctions() {}
     CloudFunctions(const String &url = "")
     {
         this->service_url = url;
@@ -60,40 +82,76 @@ public:
         this->service_url = url;
     }
 
-    void setApp(uint32_t app_addr, app_token_t *app_token, uint32_t avec_addr)
+    /**
+     * Open the connection to the Cloud Functions host and refresh the token that is going to expire before the requests are sent.
+     *
+     * ### Example
+     * ```cpp
+     * // The sensor interrupt was triggered, the data will be sent soon.
+     * cfunctions.warmUp(aClient);
+     * ```
+     * @param aClient The async client.
+     * @return bool true when the connect task was added (see AsyncClientClass::preconnect).
+     */
+    bool warmUp(AsyncClientClass &aClient)
     {
-        this->app_addr = app_addr;
-        this->app_token = app_token;
-        this->avec_addr = avec_addr; // AsyncClient vector (list) address
+        return aClient.warmUp(app_handle, cVec, FPSTR("cloudfunctions.googleapis.com"));
     }
 
-    app_token_t *appToken()
+    void setApp(list_handle_t app_handle, app_token_t *app_token)
     {
-        if (avec_addr > 0)
-        {
-            std::vector<uint32_t> *cVec = reinterpret_cast<std::vector<uint32_t> *>(avec_addr);
-            List vec;
-            if (cVec)
-                return vec.existed(*cVec, app_addr) ? app_token : nullptr;
-        }
-        return nullptr;
+        this->app_handle = app_handle;
+        this->app_token = app_token;
     }
 
+    // Returns the token of app or nullptr when the app was destroyed.
+    app_token_t *appToken() { return Registry::shared().get(app_handle) ? app_token : nullptr; }
+
     /**
      * Perform the async task repeatedly.
      * Should be places in main loop function.
      */
     void loop()
     {
+        List vec;
         for (size_t i = 0; i < cVec.size(); i++)
         {
-            AsyncClientClass *aClient = reinterpret_cast<AsyncClientClass *>(cVec[i]);
+            AsyncClientClass *aClient = Registry::shared().get<AsyncClientClass>(vec.at(cVec, i));
             if (aClient)
             {
                 aClient->process(true);
                 aClient->handleRemove();
             }
         }
+
+        handleResultCache();
+        handleSourceUpload();
+    }
+
+    /** Set the result cache of get, list and getIamPolicy.
+     *
+     * The result is returned from the cache within the time to live after it was fetched, the cache is keyed by
+     * the function resource, the request type and the request options.
+     * All cached results are removed when create, patch, deleteFunction or setIamPolicy is called.
+     *
+     * ### Example
+     * ```cpp
+     * cfunctions.setResultCache(4096, 300);
+     * ```
+     * @param size The maximum bytes of cached results, the cache is disabled when it is zero.
+     * @param ttl The time to live in seconds of cached result.
+     */
+    void setResultCache(size_t size = FIREBASE_RESPONSE_CACHE_SIZE, uint32_t ttl = 60)
+    {
+        result_cache.setLimit(size);
+        cache_ttl_ms = ttl * 1000;
+    }
+
+    // Remove all cached results, the results of the reads in flight are not cached.
+    void clearResultCache()
+    {
+        result_cache.clear();
+        cache_gen++;
     }
 
     /** Creates a new function.
@@ -390,7 +448,7 @@ public:
     {
         AsyncResult result;
         file_config_data file;
-        sendRequest(aClient, &result, NULL, "", parent, file, "", nullptr, "", GoogleCloudFunctions::google_cloud_functions_request_type_get, "", false);
+        sendRequest(aClient, &result, NULL, "", parent, file, functionId, nullptr, "", GoogleCloudFunctions::google_cloud_functions_request_type_get, "", false);
         return result.lastError.code() == 0;
     }
 
@@ -411,7 +469,7 @@ public:
     void get(AsyncClientClass &aClient, const GoogleCloudFunctions::Parent &parent, const String &functionId, AsyncResult &aResult)
     {
         file_config_data file;
-        sendRequest(aClient, &aResult, NULL, "", parent, file, "", nullptr, "", GoogleCloudFunctions::google_cloud_functions_request_type_get, "", true);
+        sendRequest(aClient, &aResult, NULL, "", parent, file, functionId, nullptr, "", GoogleCloudFunctions::google_cloud_functions_request_type_get, "", true);
     }
 
     /** Returns a function with the given name from the requested project.
@@ -432,7 +490,7 @@ public:
     void get(AsyncClientClass &aClient, const GoogleCloudFunctions::Parent &parent, const String &functionId, AsyncResultCallback cb, const String &uid = "")
     {
         file_config_data file;
-        sendRequest(aClient, nullptr, cb, uid, parent, file, "", nullptr, "", GoogleCloudFunctions::google_cloud_functions_request_type_get, "", true);
+        sendRequest(aClient, nullptr, cb, uid, parent, file, functionId, nullptr, "", GoogleCloudFunctions::google_cloud_functions_request_type_get, "", true);
     }
 
     /** Synchronously invokes a deployed Cloud Function. To be used for testing purposes as very limited traffic is allowed. For more information on the actual limits, refer to Rate Limits (https://cloud.google.com/functions/quotas#rate_limits).
@@ -501,6 +559,58 @@ public:
         sendRequest(aClient, nullptr, cb, uid, parent, file, functionId, nullptr, "", GoogleCloudFunctions::google_cloud_functions_request_type_call, payload, true);
     }
 
+    /** Invokes a deployed Cloud Function and writes its response to the sink as it arrives.
+     *
+     * The response payload (also of chunked transfer encoding) is not kept in async result, the error response is kept in async result.
+     *
+     * ### Example
+     * ```cpp
+     * File report = LittleFS.open("/report.json", "w");
+     * cfunctions.call(aClient, GoogleCloudFunctions::Parent(FIREBASE_PROJECT_ID, PROJECT_LOCATION), "report", "{}", report, asyncCB, 64 * 1024);
+     * ```
+     * @param aClient The async client.
+     * @param parent The GoogleCloudFunctions::Parent object included project Id and location name in its constructor.
+     * @param functionId The name of function.
+     * @param payload The Input to be passed to the function.
+     * @param sink The Print object that receives the response payload.
+     * @param cb The async result callback (AsyncResultCallback).
+     * @param maxSize The maximum response payload size, the call is failed with FIREBASE_ERROR_RESPONSE_TOO_LARGE
+     * and the remaining payload is discarded when it was exceeded (0 for no limit).
+     * @param uid The user specified UID of async result (optional).
+     *
+     * This function requires OAuth2.0 authentication.
+     *
+     */
+    void call(AsyncClientClass &aClient, const GoogleCloudFunctions::Parent &parent, const String &functionId, const String &payload, Print &sink, AsyncResultCallback cb, size_t maxSize = 0, const String &uid = "")
+    {
+        file_config_data file;
+        aClient.setPayloadSink(sink);
+        aClient.setResponseLimit(maxSize);
+        sendRequest(aClient, nullptr, cb, uid, parent, file, functionId, nullptr, "", GoogleCloudFunctions::google_cloud_functions_request_type_call, payload, true);
+    }
+
+    /** Invokes a deployed Cloud Function and writes its response to the sink as it arrives.
+     *
+     * @param aClient The async client.
+     * @param parent The GoogleCloudFunctions::Parent object included project Id and location name in its constructor.
+     * @param functionId The name of function.
+     * @param payload The Input to be passed to the function.
+     * @param sink The Print object that receives the response payload.
+     * @param aResult The async result (AsyncResult).
+     * @param maxSize The maximum response payload size, the call is failed with FIREBASE_ERROR_RESPONSE_TOO_LARGE
+     * and the remaining payload is discarded when it was exceeded (0 for no limit).
+     *
+     * This function requires OAuth2.0 authentication.
+     *
+     */
+    void call(AsyncClientClass &aClient, const GoogleCloudFunctions::Parent &parent, const String &functionId, const String &payload, Print &sink, AsyncResult &aResult, size_t maxSize = 0)
+    {
+        file_config_data file;
+        aClient.setPayloadSink(sink);
+        aClient.setResponseLimit(maxSize);
+        sendRequest(aClient, &aResult, NULL, "", parent, file, functionId, nullptr, "", GoogleCloudFunctions::google_cloud_functions_request_type_call, payload, true);
+    }
+
     /** Returns a signed URL for downloading deployed function source code. The URL is only valid for a limited period and should be used within 30 minutes of generation. For more information about the signed URL usage see: https://cloud.google.com/storage/docs/access-control/signed-urls
      *
      * @param aClient The async client.
@@ -630,6 +740,49 @@ public:
         sendRequest(aClient, nullptr, cb, uid, parent, file, functionId, nullptr, "", GoogleCloudFunctions::google_cloud_functions_request_type_gen_uploadUrl, options.c_str(), true);
     }
 
+    /** Upload the function source code to the signed URL from generateUploadURL.
+     *
+     * The signed URL is requested and the source (file, blob or producer source) is sent with PUT request to the URL
+     * by the same async client, the upload progress is reported to the result callback.
+     * The result payload is the response of generateUploadURL that its storageSource should be provided in create or patch.
+     *
+     * ### Example
+     * ```cpp
+     * cfunctions.uploadSource(aClient, GoogleCloudFunctions::Parent(FIREBASE_PROJECT_ID, PROJECT_LOCATION), "helloWorld", GoogleCloudFunctions::UploadURLOptions(), getFile(source_zip), asyncCB);
+     * ```
+     * @param aClient The async client.
+     * @param parent The GoogleCloudFunctions::Parent object included project Id and location name in its constructor.
+     * @param functionId The name of function.
+     * @param options The GoogleCloudFunctions::UploadURLOptions object that provides the kmsKeyName and environment options.
+     * @param file The file config data of zip archive, in case of file, blob or producer source.
+     * @param cb The async result callback (AsyncResultCallback).
+     * @param uid The user specified UID of async result (optional).
+     *
+     * This function requires OAuth2.0 authentication.
+     *
+     */
+    void uploadSource(AsyncClientClass &aClient, const GoogleCloudFunctions::Parent &parent, const String &functionId, GoogleCloudFunctions::UploadURLOptions options, file_config_data &file, AsyncResultCallback cb, const String &uid = "")
+    {
+        beginSourceUpload(aClient, nullptr, cb, uid, parent, functionId, options, file);
+    }
+
+    /** Upload the function source code to the signed URL from generateUploadURL.
+     *
+     * @param aClient The async client.
+     * @param parent The GoogleCloudFunctions::Parent object included project Id and location name in its constructor.
+     * @param functionId The name of function.
+     * @param options The GoogleCloudFunctions::UploadURLOptions object that provides the kmsKeyName and environment options.
+     * @param file The file config data of zip archive, in case of file, blob or producer source.
+     * @param aResult The async result (AsyncResult).
+     *
+     * This function requires OAuth2.0 authentication.
+     *
+     */
+    void uploadSource(AsyncClientClass &aClient, const GoogleCloudFunctions::Parent &parent, const String &functionId, GoogleCloudFunctions::UploadURLOptions options, file_config_data &file, AsyncResult &aResult)
+    {
+        beginSourceUpload(aClient, &aResult, NULL, "", parent, functionId, options, file);
+    }
+
     /** Gets the access control policy for a resource. Returns an empty policy if the resource exists and does not have a policy set.
      *
      * @param aClient The async client.
@@ -840,10 +993,264 @@ private:
     String path;
     String uid;
     // FirebaseApp address and FirebaseApp vector address
-    uint32_t app_addr = 0, avec_addr = 0;
+    list_handle_t app_handle = 0;
     app_token_t *app_token = nullptr;
 
+    struct cache_task_t
+    {
+    public:
+        AsyncResult *aResult = nullptr;
+        AsyncResultCallback cb = NULL;
+        String uid;
+        AsyncResult result;
+        String key;
+        uint32_t gen = 0;
+        list_handle_t client_handle = 0;
+    };
+
+    // The cached results that keyed by request, the fetch time (millis) is kept as ETag.
+    ResponseCache result_cache;
+    uint32_t cache_ttl_ms = 0;
+    // The cache generation, the result of read that was sent before the cache was cleared is not cached.
+    uint32_t cache_gen = 0;
+    // The reads that are waiting for the results to cache.
+    std::vector<cache_task_t *> cacheVec;
+
+    bool isCacheable(GoogleCloudFunctions::google_cloud_functions_request_type requestType)
+    {
+        return requestType == GoogleCloudFunctions::google_cloud_functions_request_type_get ||
+               requestType == GoogleCloudFunctions::google_cloud_functions_request_type_list ||
+               requestType == GoogleCloudFunctions::google_cloud_functions_request_type_get_iam_policy;
+    }
+
+    bool isModifying(GoogleCloudFunctions::google_cloud_functions_request_type requestType)
+    {
+        return requestType == GoogleCloudFunctions::google_cloud_functions_request_type_create ||
+               requestType == GoogleCloudFunctions::google_cloud_functions_request_type_patch ||
+               requestType == GoogleCloudFunctions::google_cloud_functions_request_type_delete ||
+               requestType == GoogleCloudFunctions::google_cloud_functions_request_type_set_iam_policy;
+    }
+
+    void returnCached(AsyncResult *aResult, AsyncResultCallback cb, AsyncResult &r)
+    {
+        if (aResult)
+            *aResult = r;
+        if (cb)
+            cb(r);
+    }
+
+    void putResult(const String &key, AsyncResult &r)
+    {
+        if (r.error_available || r.payload_val.length() == 0)
+            return;
+        String ts;
+        ts += millis();
+        result_cache.put(key, ts, r.payload_val);
+    }
+
+    void handleResultCache()
+    {
+        for (size_t i = cacheVec.size(); i > 0; i--)
+        {
+            cache_task_t *t = cacheVec[i - 1];
+            if (!t || (!t->result.data_available && !t->result.error_available))
+                continue;
+            if (t->gen == cache_gen)
+                putResult(t->key, t->result);
+            cacheVec.erase(cacheVec.begin() + i - 1);
+            returnCached(t->aResult, t->cb, t->result);
+            detachResult(t->client_handle, &t->result);
+            delete t;
+        }
+    }
+
+    // Detach the result from the tasks of client before the result was deleted.
+    void detachResult(list_handle_t client_handle, AsyncResult *result)
+    {
+        AsyncClientClass *aClient = Registry::shared().get<AsyncClientClass>(client_handle);
+        for (size_t i = 0; aClient && i < aClient->sVec.size(); i++)
+        {
+            async_data_item_t *sData = aClient->getData(i);
+            if (sData && sData->refResult == result)
+            {
+                sData->refResult = nullptr;
+                sData->ref_result_handle = 0;
+            }
+        }
+    }
+
+    struct source_upload_t
+    {
+    public:
+        AsyncClientClass *aClient = nullptr;
+        AsyncResult *aResult = nullptr;
+        AsyncResultCallback cb = NULL;
+        String uid;
+        file_config_data file;
+        AsyncResult result;
+        // The response of generateUploadURL.
+        String meta;
+        int progress = -1;
+        // The source is being uploaded to the signed URL.
+        bool uploading = false;
+    };
+
+    // The source uploads that are waiting for the signed URL or the upload result.
+    std::vector<source_upload_t *> uploadVec;
+
+    void beginSourceUpload(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const GoogleCloudFunctions::Parent &parent, const String &functionId, GoogleCloudFunctions::UploadURLOptions &options, file_config_data &file)
+    {
+        source_upload_t *t = new source_upload_t();
+        t->aClient = &aClient;
+        t->aResult = result;
+        t->cb = cb;
+        t->uid = uid;
+        t->file.copy(file);
+        uploadVec.push_back(t);
+        file_config_data none;
+        sendRequest(aClient, &t->result, NULL, uid, parent, none, functionId, nullptr, "", GoogleCloudFunctions::google_cloud_functions_request_type_gen_uploadUrl, options.c_str(), true);
+    }
+
+    // Send the source with PUT request to the signed URL, the URL is authorized by its signature.
+    bool putSource(source_upload_t *t, String &uploadUrl)
+    {
+        AsyncClientClass::SlotGuard guard(t->aClient);
+        URLUtil uut;
+        String path;
+        String host = uut.getHost(uploadUrl, &path);
+        slot_options_t opt(false, false, true, false, false, true);
+        async_data_item_t *sData = host.length() ? t->aClient->createSlot(opt) : nullptr;
+        if (!sData)
+            return false;
+
+        t->aClient->newRequest(sData, host, path, "", async_request_handler_t::http_put, opt, t->uid);
+        sData->request.file_data.copy(t->file);
+        sData->request.base64 = false;
+        sData->upload = true;
+        t->aClient->setContentType(sData, FPSTR("application/zip"));
+        t->aClient->setFileContentLength(sData, 0);
+        if (sData->request.file_data.file_size == 0 && !sData->request.file_data.chunked())
+        {
+            sData->to_remove = true;
+            return false;
+        }
+
+        t->uploading = true;
+        t->result.clear();
+        t->result.error_available = false;
+        t->aClient->addRemoveClientVec(cVec, true);
+        sData->setRefResult(&t->result);
+        return true;
+    }
+
+    bool uploadPending(source_upload_t *t)
+    {
+        for (size_t i = 0; i < t->aClient->sVec.size(); i++)
+        {
+            async_data_item_t *sData = t->aClient->getData(i);
+            if (sData && sData->refResult == &t->result)
+                return true;
+        }
+        return false;
+    }
+
+    void handleSourceUpload()
+    {
+        for (size_t i = uploadVec.size(); i > 0; i--)
+        {
+            source_upload_t *t = uploadVec[i - 1];
+            if (!t)
+                continue;
+
+            // The signed URL responds with the empty body, the upload is done when its task was removed.
+            bool done = t->result.data_available || t->result.error_available || (t->uploading && !uploadPending(t));
+            if (t->uploading && !done && t->result.upload_data.progress != t->progress)
+            {
+                // The upload progress is forwarded.
+                t->progress = t->result.upload_data.progress;
+                t->result.upload_data.progress_available = true;
+                returnCached(t->aResult, t->cb, t->result);
+                continue;
+            }
+
+            if (!done)
+                continue;
+
+            if (!t->uploading && !t->result.error_available)
+            {
+                String url;
+                t->meta = t->result.payload_val;
+                if (JsonPullParser::get(t->meta, "uploadUrl", url) && putSource(t, url))
+                    continue;
+                t->result.error_available = true;
+                t->result.lastError.setClientError(FIREBASE_ERROR_FILE_READ);
+            }
+            else if (t->uploading && !t->result.error_available)
+            {
+                t->result.setPayload(t->meta);
+                t->result.setDebug(FPSTR("Function source uploaded"));
+            }
+
+            t->result.setUID(t->uid);
+            uploadVec.erase(uploadVec.begin() + i - 1);
+            returnCached(t->aResult, t->cb, t->result);
+            delete t;
+        }
+    }
+
     void sendRequest(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const GoogleCloudFunctions::Parent &parent, file_config_data &file, const String &functionId, GoogleCloudFunctions::ListOptions *listOptions, const String &updateMask, GoogleCloudFunctions::google_cloud_functions_request_type requestType, const String &payload, bool async)
+    {
+        if (!result_cache.isEnabled() || (!isCacheable(requestType) && !isModifying(requestType)))
+            return buildRequest(aClient, result, cb, uid, parent, file, functionId, listOptions, updateMask, requestType, payload, async);
+
+        if (isModifying(requestType))
+        {
+            clearResultCache();
+            return buildRequest(aClient, result, cb, uid, parent, file, functionId, listOptions, updateMask, requestType, payload, async);
+        }
+
+        String k = parent.getProjectId();
+        k += '/';
+        k += parent.getLocationId();
+        k += '/';
+        k += functionId;
+        k += '#';
+        k += (int)requestType;
+        if (listOptions)
+            k += listOptions->c_str();
+        k += '?';
+        k += payload;
+        String ts = result_cache.etag(k), body;
+        if (ts.length() && millis() - strtoul(ts.c_str(), nullptr, 10) < cache_ttl_ms && result_cache.get(k, body))
+        {
+            AsyncResult r;
+            r.setPayload(body);
+            r.setDebug(FPSTR("Result served from cache"));
+            r.setUID(uid);
+            return returnCached(result, cb, r);
+        }
+
+        if (!async)
+        {
+            uint32_t gen = cache_gen;
+            buildRequest(aClient, result, cb, uid, parent, file, functionId, listOptions, updateMask, requestType, payload, async);
+            if (result && gen == cache_gen)
+                putResult(k, *result);
+            return;
+        }
+
+        cache_task_t *t = new cache_task_t();
+        t->aResult = result;
+        t->cb = cb;
+        t->uid = uid;
+        t->key = k;
+        t->gen = cache_gen;
+        t->client_handle = aClient.handle();
+        cacheVec.push_back(t);
+        buildRequest(aClient, &t->result, NULL, uid, parent, file, functionId, listOptions, updateMask, requestType, payload, async);
+    }
+
+    void buildRequest(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const GoogleCloudFunctions::Parent &parent, file_config_data &file, const String &functionId, GoogleCloudFunctions::ListOptions *listOptions, const String &updateMask, GoogleCloudFunctions::google_cloud_functions_request_type requestType, const String &payload, bool async)
     {
         GoogleCloudFunctions::DataOptions options;
         options.requestType = requestType;
@@ -904,6 +1311,7 @@ private:
 
     void asyncRequest(GoogleCloudFunctions::async_request_data_t &request, GoogleCloudFunctions::google_cloud_functions_request_type requestType)
     {
+        AsyncClientClass::SlotGuard guard(request.aClient);
         app_token_t *app_token = appToken();
 
         if (!app_token)
@@ -988,10 +1396,10 @@ private:
         if (request.cb)
             sData->cb = request.cb;
 
-        request.aClient->addRemoveClientVec(reinterpret_cast<uint32_t>(&(cVec)), true);
+        request.aClient->addRemoveClientVec(cVec, true);
 
         if (request.aResult)
-            sData->setRefResult(request.aResult, reinterpret_cast<uint32_t>(&(request.aClient->rVec)));
+            sData->setRefResult(request.aResult);
 
         request.aClient->process(sData->async);
         request.aClient->handleRemove();
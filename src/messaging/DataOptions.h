@@ -28,6 +28,7 @@
 #include <Arduino.h>
 #include "./Config.h"
 #include "./core/JSON.h"
+#include "./core/JsonEscape.h"
 #include "./core/ObjectWriter.h"
 
 // https://firebase.google.com/docs/reference/fcm/rest/v1/projects.messages
@@ -381,6 +382,133 @@ namespace Messages
         // Union field target.
         // Condition to send a message to, e.g. "'foo' in topics && 'bar' in topics".
         Message &condition(const String &value) { return wr.set<Message &, String>(*this, value, buf, bufSize, 7, FPSTR(__func__)); }
+
+        // The serialized message without the target field, it is the template of fan-out sending.
+        String untargeted() const
+        {
+            ObjectWriter owriter;
+            String s;
+            for (size_t i = 1; i < 7; i++)
+                owriter.addObject(s, buf.get(i), "}");
+            return s;
+        }
+    };
+
+    /**
+     * The message that was frozen into the serialized send request with the substitution slots.
+     * The slot is the "{{name}}" in string value of message e.g. Notification().title("{{title}}"), the name is letters, digits and '_'.
+     * The same name can be used in many slots and all of them are substituted by the same value.
+     */
+    class MessageTemplate
+    {
+    private:
+        struct slot_t
+        {
+        public:
+            String name;
+            // The offset in skeleton where the value is inserted.
+            size_t pos = 0;
+        };
+
+        // The serialized send request without the slot values.
+        String skel;
+        std::vector<slot_t> slots;
+        std::vector<String> values;
+
+        bool isNameChar(char c) const { return isalnum((unsigned char)c) || c == '_'; }
+
+    public:
+        MessageTemplate() {}
+        MessageTemplate(const Message &message) { freeze(message); }
+
+        // Serialize the message once and take the slots out of the skeleton.
+        void freeze(const Message &message)
+        {
+            slots.clear();
+            values.clear();
+            String msg = message.c_str();
+            skel.remove(0, skel.length());
+            skel.reserve(msg.length() + 13);
+            skel += FPSTR("{\"message\":");
+            skel += msg.length() ? msg : String(FPSTR("{}"));
+            skel += '}';
+
+            size_t i = 0;
+            while (i + 1 < skel.length())
+            {
+                if (skel[i] != '{' || skel[i + 1] != '{')
+                {
+                    i++;
+                    continue;
+                }
+                size_t j = i + 2;
+                while (j < skel.length() && isNameChar(skel[j]))
+                    j++;
+                if (j == i + 2 || j + 1 >= skel.length() || skel[j] != '}' || skel[j + 1] != '}')
+                {
+                    i++;
+                    continue;
+                }
+                slot_t slot;
+                slot.name = skel.substring(i + 2, j);
+                slot.pos = i;
+                skel.remove(i, j + 2 - i);
+                slots.push_back(slot);
+            }
+            values.resize(slots.size());
+        }
+
+        // The numbers of slots.
+        size_t slotCount() const { return slots.size(); }
+
+        // Set the value of slot by its index in the order it appears in the serialized message.
+        bool set(size_t index, const String &value)
+        {
+            if (index >= values.size())
+                return false;
+            values[index] = value;
+            return true;
+        }
+
+        // Set the value of all slots with the name.
+        bool set(const String &name, const String &value)
+        {
+            bool found = false;
+            for (size_t i = 0; i < slots.size(); i++)
+            {
+                if (slots[i].name == name)
+                {
+                    values[i] = value;
+                    found = true;
+                }
+            }
+            return found;
+        }
+
+        // The exact length of send request payload e.g. for Content-Length.
+        size_t length() const
+        {
+            size_t n = skel.length();
+            for (size_t i = 0; i < values.size(); i++)
+                n += JsonEscape::length(values[i].c_str(), values[i].length());
+            return n;
+        }
+
+        // Create the send request payload with exact capacity.
+        String payload() const
+        {
+            String out;
+            out.reserve(length());
+            size_t last = 0;
+            for (size_t i = 0; i < slots.size(); i++)
+            {
+                out.concat(skel.c_str() + last, slots[i].pos - last);
+                JsonEscape::append(out, values[i]);
+                last = slots[i].pos;
+            }
+            out += skel.c_str() + last;
+            return out;
+        }
     };
 
     class Parent
@@ -33,14 +33,27 @@ using namespace firebase;
 #if defined(ENABLE_MESSAGING)
 
 #include "./messaging/DataOptions.h"
+#include "./core/JsonParser.h"
+
+#if !defined(FIREBASE_FCM_FANOUT_WINDOW)
+#define FIREBASE_FCM_FANOUT_WINDOW 4
+#endif
+
+// The callback of fan-out sending that receives the status of each target, the code is 0 and the message is the message name when it was sent.
+typedef void (*MessagingSendStatusCallback)(uint32_t index, int code, const String &message);
 
 class Messaging
 {
 
 public:
-    std::vector<uint32_t> cVec; // AsyncClient vector
+    std::vector<list_handle_t> cVec; // AsyncClient handles
 
-    ~Messaging() {}
+    ~Messaging()
+    {
+        if (fan)
+            delete fan;
+        fan = nullptr;
+    }
     Messaging(const String &url = "")
     {
         this->service_url = url;
@@ -61,40 +74,49 @@ public:
         this->service_url = url;
     }
 
-    void setApp(uint32_t app_addr, app_token_t *app_token, uint32_t avec_addr)
+    /**
+     * Open the connection to the Messaging host and refresh the token that is going to expire before the requests are sent.
+     *
+     * ### Example
+     * ```cpp
+     * // The sensor interrupt was triggered, the data will be sent soon.
+     * messaging.warmUp(aClient);
+     * ```
+     * @param aClient The async client.
+     * @return bool true when the connect task was added (see AsyncClientClass::preconnect).
+     */
+    bool warmUp(AsyncClientClass &aClient)
     {
-        this->app_addr = app_addr;
-        this->app_token = app_token;
-        this->avec_addr = avec_addr; // AsyncClient vector (list) address
+        return aClient.warmUp(app_handle, cVec, FPSTR("fcm.googleapis.com"));
     }
 
-    app_token_t *appToken()
+    void setApp(list_handle_t app_handle, app_token_t *app_token)
     {
-        if (avec_addr > 0)
-        {
-            std::vector<uint32_t> *cVec = reinterpret_cast<std::vector<uint32_t> *>(avec_addr);
-            List vec;
-            if (cVec)
-                return vec.existed(*cVec, app_addr) ? app_token : nullptr;
-        }
-        return nullptr;
+        this->app_handle = app_handle;
+        this->app_token = app_token;
     }
 
+    // Returns the token of app or nullptr when the app was destroyed.
+    app_token_t *appToken() { return Registry::shared().get(app_handle) ? app_token : nullptr; }
+
     /**
      * Perform the async task repeatedly.
      * Should be places in main loop function.
      */
     void loop()
     {
+        List vec;
         for (size_t i = 0; i < cVec.size(); i++)
         {
-            AsyncClientClass *aClient = reinterpret_cast<AsyncClientClass *>(cVec[i]);
+            AsyncClientClass *aClient = Registry::shared().get<AsyncClientClass>(vec.at(cVec, i));
             if (aClient)
             {
                 aClient->process(true);
                 aClient->handleRemove();
             }
         }
+
+        handleFanOut();
     }
 
     /** Send Firebase Cloud Messaging to the devices using the FCM HTTP v1 API.
@@ -151,15 +173,237 @@ public:
         sendRequest(aClient, nullptr, cb, uid, parent, message.c_str(), Messages::firebase_cloud_messaging_request_type_send, true);
     }
 
+    /** Send the message from template with HTTP v1 API.
+     *
+     * The payload is created from the skeleton and the slot values of template without building the message again.
+     *
+     * ### Example
+     * ```cpp
+     * Messages::Message msg;
+     * msg.token(DEVICE_TOKEN);
+     * msg.notification(Messages::Notification().title("{{title}}").body("{{body}}"));
+     * Messages::MessageTemplate alert(msg);
+     *
+     * alert.set("title", "Temperature");
+     * alert.set("body", "The temperature is 42°C");
+     * messaging.send(aClient, Messages::Parent(FIREBASE_PROJECT_ID), alert, asyncCB);
+     * ```
+     * @param aClient The async client.
+     * @param parent The Messages::Parent object included project Id in its constructor.
+     * @param tpl The Messages::MessageTemplate object that holds the frozen message and its slot values.
+     * @return Boolean type status indicates the success of the operation.
+     *
+     * This function requires ServiceAuth authentication.
+     */
+    bool send(AsyncClientClass &aClient, const Messages::Parent &parent, const Messages::MessageTemplate &tpl)
+    {
+        AsyncResult result;
+        sendTemplate(aClient, &result, NULL, "", parent, tpl, false);
+        return result.lastError.code() == 0;
+    }
+
+    /** Send the message from template with HTTP v1 API.
+     *
+     * @param aClient The async client.
+     * @param parent The Messages::Parent object included project Id in its constructor.
+     * @param tpl The Messages::MessageTemplate object that holds the frozen message and its slot values.
+     * @param aResult The async result (AsyncResult).
+     *
+     * This function requires ServiceAuth authentication.
+     */
+    void send(AsyncClientClass &aClient, const Messages::Parent &parent, const Messages::MessageTemplate &tpl, AsyncResult &aResult)
+    {
+        sendTemplate(aClient, &aResult, NULL, "", parent, tpl, true);
+    }
+
+    /** Send the message from template with HTTP v1 API.
+     *
+     * @param aClient The async client.
+     * @param parent The Messages::Parent object included project Id in its constructor.
+     * @param tpl The Messages::MessageTemplate object that holds the frozen message and its slot values.
+     * @param cb The async result callback (AsyncResultCallback).
+     * @param uid The user specified UID of async result (optional).
+     *
+     * This function requires ServiceAuth authentication.
+     */
+    void send(AsyncClientClass &aClient, const Messages::Parent &parent, const Messages::MessageTemplate &tpl, AsyncResultCallback cb, const String &uid = "")
+    {
+        sendTemplate(aClient, nullptr, cb, uid, parent, tpl, true);
+    }
+
+    /** Send the message to the list of registration tokens.
+     *
+     * The message is serialized once as the template and only the token is added to the payload of each target.
+     * Up to FIREBASE_FCM_FANOUT_WINDOW requests are queued at a time, they are sent on the kept-alive
+     * (or pooled) connections of async client. The fan-out sending works in the loop function.
+     *
+     * The status of each target is reported to the status callback with the index of token.
+     * The result callback is called once when all targets were reported, its payload is {"targets":<count>,"failed":<count>}.
+     *
+     * ### Example
+     * ```cpp
+     * void onSendStatus(uint32_t index, int code, const String &message)
+     * {
+     *     if (code)
+     *         Serial.printf("Token %u failed, %s\n", (unsigned int)index, message.c_str());
+     * }
+     *
+     * messaging.fanOut(aClient, Messages::Parent(FIREBASE_PROJECT_ID), msg, tokens, 200, onSendStatus, asyncCB);
+     * ```
+     * @param aClient The async client.
+     * @param parent The Messages::Parent object included project Id in its constructor.
+     * @param message The Messages::Message object that holds the information to send, its target is not used.
+     * @param tokens The array of registration tokens, it should be valid until the result callback was called.
+     * @param count The numbers of tokens.
+     * @param statusCb The callback function that receives the status of each target.
+     * @param cb The async result callback (AsyncResultCallback) that is called when all targets were sent.
+     * @param uid The user specified UID of async result (optional).
+     * @return Boolean value, false when the previous fan-out sending was not done.
+     *
+     * This function requires ServiceAuth authentication.
+     */
+    bool fanOut(AsyncClientClass &aClient, const Messages::Parent &parent, const Messages::Message &message, const String *tokens, uint32_t count, MessagingSendStatusCallback statusCb, AsyncResultCallback cb = NULL, const String &uid = "")
+    {
+        if (fan)
+            return false;
+        fan = new fan_out_t();
+        fan->aClient = &aClient;
+        fan->parent = parent;
+        fan->tokens = tokens;
+        fan->count = tokens ? count : 0;
+        fan->statusCb = statusCb;
+        fan->cb = cb;
+        fan->uid = uid;
+
+        // The payload of each target is the head, token and "}}.
+        String msg = message.untargeted();
+        fan->head = FPSTR("{\"message\":");
+        if (msg.length())
+        {
+            msg.remove(msg.length() - 1);
+            fan->head += msg;
+            fan->head += ',';
+        }
+        else
+            fan->head += '{';
+        fan->head += FPSTR("\"token\":\"");
+
+        aClient.addRemoveClientVec(cVec, true);
+        handleFanOut();
+        return true;
+    }
+
 private:
     AsyncClientClass *aClient = nullptr;
     String service_url;
     String path;
     String uid;
     // FirebaseApp address and FirebaseApp vector address
-    uint32_t app_addr = 0, avec_addr = 0;
+    list_handle_t app_handle = 0;
     app_token_t *app_token = nullptr;
 
+    struct fan_out_t
+    {
+    public:
+        AsyncClientClass *aClient = nullptr;
+        Messages::Parent parent;
+        String uid, head;
+        const String *tokens = nullptr;
+        MessagingSendStatusCallback statusCb = NULL;
+        AsyncResultCallback cb = NULL;
+        // The index of next token to send, the numbers of reported and failed targets.
+        uint32_t count = 0, next = 0, done = 0, failed = 0;
+        AsyncResult results[FIREBASE_FCM_FANOUT_WINDOW];
+        uint32_t index[FIREBASE_FCM_FANOUT_WINDOW] = {0};
+        bool busy[FIREBASE_FCM_FANOUT_WINDOW] = {false};
+        AsyncResult summary;
+    };
+
+    // The fan-out sending that is in progress.
+    fan_out_t *fan = nullptr;
+
+    void sendFanOut(fan_out_t *f, uint8_t i)
+    {
+        Messages::DataOptions options;
+        options.requestType = Messages::firebase_cloud_messaging_request_type_send;
+        options.parent = f->parent;
+        const String &token = f->tokens[f->next];
+        options.payload.reserve(f->head.length() + token.length() + 3);
+        options.payload += f->head;
+        options.payload += token;
+        options.payload += FPSTR("\"}}");
+        options.extras += FPSTR("/messages:send");
+
+        f->index[i] = f->next++;
+        f->busy[i] = true;
+        f->results[i].clear();
+        f->results[i].error_available = false;
+
+        Messages::async_request_data_t aReq(f->aClient, path, async_request_handler_t::http_post, slot_options_t(false, false, true, false, false, false), &options, &f->results[i], NULL, f->uid);
+        asyncRequest(aReq);
+    }
+
+    void reportFanOut(fan_out_t *f, uint8_t i)
+    {
+        AsyncResult &r = f->results[i];
+        f->busy[i] = false;
+        f->done++;
+        if (r.error_available)
+        {
+            f->failed++;
+            if (f->statusCb)
+                f->statusCb(f->index[i], r.lastError.code(), r.lastError.message());
+            return;
+        }
+        String name;
+        JsonPullParser::get(r.payload_val, "name", name);
+        if (f->statusCb)
+            f->statusCb(f->index[i], 0, name);
+    }
+
+    void handleFanOut()
+    {
+        fan_out_t *f = fan;
+        if (!f)
+            return;
+
+        // The window is reduced on the lossy link when the link adaptation of async client is enabled.
+        uint8_t window = f->aClient->linkWindow(FIREBASE_FCM_FANOUT_WINDOW), inflight = 0;
+        for (uint8_t i = 0; i < FIREBASE_FCM_FANOUT_WINDOW; i++)
+        {
+            if (f->busy[i] && (f->results[i].data_available || f->results[i].error_available))
+                reportFanOut(f, i);
+            inflight += f->busy[i] ? 1 : 0;
+        }
+
+        for (uint8_t i = 0; i < FIREBASE_FCM_FANOUT_WINDOW && inflight < window; i++)
+        {
+            // The slot of result is reused by the next target.
+            if (!f->busy[i] && f->next < f->count)
+            {
+                sendFanOut(f, i);
+                inflight++;
+            }
+        }
+
+        if (f->done < f->count)
+            return;
+
+        String summary = FPSTR("{\"targets\":");
+        summary += f->count;
+        summary += FPSTR(",\"failed\":");
+        summary += f->failed;
+        summary += '}';
+        f->summary.setPayload(summary);
+        f->summary.setDebug(FPSTR("Fan-out send complete"));
+        f->summary.setUID(f->uid);
+
+        fan = nullptr;
+        if (f->cb)
+            f->cb(f->summary);
+        delete f;
+    }
+
     void sendRequest(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const Messages::Parent &parent, const String &payload, Messages::firebase_cloud_messaging_request_type requestType, bool async)
     {
         Messages::DataOptions options;
@@ -176,8 +420,22 @@ private:
         asyncRequest(aReq);
     }
 
+    void sendTemplate(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const Messages::Parent &parent, const Messages::MessageTemplate &tpl, bool async)
+    {
+        Messages::DataOptions options;
+        options.requestType = Messages::firebase_cloud_messaging_request_type_send;
+        options.parent = parent;
+        // The payload is already the send request.
+        options.payload = tpl.payload();
+        options.extras += FPSTR("/messages:send");
+
+        Messages::async_request_data_t aReq(&aClient, path, async_request_handler_t::http_post, slot_options_t(false, false, async, false, false, false), &options, result, cb, uid);
+        asyncRequest(aReq);
+    }
+
     void asyncRequest(Messages::async_request_data_t &request, int beta = 0)
     {
+        AsyncClientClass::SlotGuard guard(request.aClient);
         URLUtil uut;
         app_token_t *app_token = appToken();
 
@@ -209,17 +467,18 @@ private:
 
         if (request.options->payload.length())
         {
-            sData->request.val[req_hndlr_ns::payload] = request.options->payload;
-            request.aClient->setContentLength(sData, request.options->payload.length());
+            size_t len = request.options->payload.length();
+            sData->request.val[req_hndlr_ns::payload] = std::move(request.options->payload);
+            request.aClient->setContentLength(sData, len);
         }
 
         if (request.cb)
             sData->cb = request.cb;
 
-        request.aClient->addRemoveClientVec(reinterpret_cast<uint32_t>(&(cVec)), true);
+        request.aClient->addRemoveClientVec(cVec, true);
 
         if (request.aResult)
-            sData->setRefResult(request.aResult, reinterpret_cast<uint32_t>(&(request.aClient->rVec)));
+            sData->setRefResult(request.aResult);
 
         sData->download = request.method == async_request_handler_t::http_get && sData->request.file_data.filename.length();
 
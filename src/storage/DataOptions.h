@@ -103,7 +103,8 @@ namespace FirebaseStorage
     public:
         AsyncClientClass *aClient = nullptr;
         String path;
-        String uid;
+        // The uid of the function argument that is valid until the request was built.
+        StringRef uid;
         String mime;
         async_request_handler_t::http_request_method method = async_request_handler_t::http_undefined;
         slot_options_t opt;
@@ -111,8 +112,11 @@ namespace FirebaseStorage
         file_config_data *file = nullptr;
         AsyncResult *aResult = nullptr;
         AsyncResultCallback cb = NULL;
+        // The payload sink and byte range [range_first, range_last] of range download.
+        Print *sink = nullptr;
+        size_t range_first = 0, range_last = 0;
         async_request_data_t() {}
-        async_request_data_t(AsyncClientClass *aClient, const String &path, async_request_handler_t::http_request_method method, slot_options_t opt, DataOptions *options, file_config_data *file, AsyncResult *aResult, AsyncResultCallback cb, const String &uid = "")
+        async_request_data_t(AsyncClientClass *aClient, const String &path, async_request_handler_t::http_request_method method, slot_options_t opt, DataOptions *options, file_config_data *file, AsyncResult *aResult, AsyncResultCallback cb, const StringRef &uid = "")
         {
             this->aClient = aClient;
             this->path = path;
@@ -33,14 +33,42 @@ using namespace firebase;
 #if defined(ENABLE_STORAGE)
 
 #include "./storage/DataOptions.h"
+#include "./core/RangeDownload.h"
+#include "./core/ListIterator.h"
+#include "./core/ObjectMetaCache.h"
 
 class Storage
 {
 
 public:
-    std::vector<uint32_t> cVec; // AsyncClient vector
+    std::vector<list_handle_t> cVec; // AsyncClient handles
 
-    ~Storage() {}
+    ~Storage()
+    {
+        for (size_t i = 0; i < rangeVec.size(); i++)
+        {
+            range_task_t *t = rangeVec[i];
+            if (t)
+                delete t;
+        }
+        rangeVec.clear();
+
+        for (size_t i = 0; i < listVec.size(); i++)
+        {
+            list_task_t *t = listVec[i];
+            if (t)
+                delete t;
+        }
+        listVec.clear();
+
+        for (size_t i = 0; i < iterVec.size(); i++)
+        {
+            ListIterator *it = iterVec[i];
+            if (it)
+                it->ivec = nullptr;
+        }
+        iterVec.clear();
+    }
     Storage(const String &url = "")
     {
         this->service_url = url;
@@ -61,40 +89,49 @@ public:
         this->service_url = url;
     }
 
-    void setApp(uint32_t app_addr, app_token_t *app_token, uint32_t avec_addr)
+    /**
+     * Open the connection to the Firebase Storage host and refresh the token that is going to expire before the requests are sent.
+     *
+     * ### Example
+     * ```cpp
+     * // The sensor interrupt was triggered, the data will be sent soon.
+     * storage.warmUp(aClient);
+     * ```
+     * @param aClient The async client.
+     * @return bool true when the connect task was added (see AsyncClientClass::preconnect).
+     */
+    bool warmUp(AsyncClientClass &aClient)
     {
-        this->app_addr = app_addr;
-        this->app_token = app_token;
-        this->avec_addr = avec_addr; // AsyncClient vector (list) address
+        return aClient.warmUp(app_handle, cVec, FPSTR("firebasestorage.googleapis.com"));
     }
 
-    app_token_t *appToken()
+    void setApp(list_handle_t app_handle, app_token_t *app_token)
     {
-        if (avec_addr > 0)
-        {
-            std::vector<uint32_t> *cVec = reinterpret_cast<std::vector<uint32_t> *>(avec_addr);
-            List vec;
-            if (cVec)
-                return vec.existed(*cVec, app_addr) ? app_token : nullptr;
-        }
-        return nullptr;
+        this->app_handle = app_handle;
+        this->app_token = app_token;
     }
 
+    // Returns the token of app or nullptr when the app was destroyed.
+    app_token_t *appToken() { return Registry::shared().get(app_handle) ? app_token : nullptr; }
+
     /**
      * Perform the async task repeatedly.
      * Should be places in main loop function.
      */
     void loop()
     {
+        List vec;
         for (size_t i = 0; i < cVec.size(); i++)
         {
-            AsyncClientClass *aClient = reinterpret_cast<AsyncClientClass *>(cVec[i]);
+            AsyncClientClass *aClient = Registry::shared().get<AsyncClientClass>(vec.at(cVec, i));
             if (aClient)
             {
                 aClient->process(true);
                 aClient->handleRemove();
             }
         }
+        handleRangeDownload();
+        handleListIterator();
     }
 
     /** Download object from the Firebase Storage.
@@ -141,11 +178,39 @@ public:
      * @param uid The user specified UID of async result (optional).
      *
      */
-    void download(AsyncClientClass &aClient, const FirebaseStorage::Parent &parent, file_config_data file, AsyncResultCallback cb, const String &uid = "")
+    void download(AsyncClientClass &aClient, const FirebaseStorage::Parent &parent, file_config_data file, AsyncResultCallback cb, const StringRef &uid = "")
     {
         sendRequest(aClient, nullptr, cb, uid, parent, file, "", FirebaseStorage::firebase_storage_request_type_download, true);
     }
 
+    /** Download object from the Firebase Storage in byte ranges that are fetched concurrently.
+     *
+     * @param aClient The async client, the ranges are limited to the numbers of its connections (see AsyncClientClass::addClient).
+     * @param parent The FirebaseStorage::Parent object included Storage bucket Id and object in its constructor.
+     * The bucketid is the Storage bucket Id of object to download.
+     * The object is the object in Storage bucket to download.
+     * @param file The filesystem data (file_config_data) obtained from FileConfig or BlobConfig class object.
+     * @param parts The numbers of concurrent ranges (up to FIREBASE_RANGE_DOWNLOAD_PARTS_LIMIT).
+     * @param cb The async result callback (AsyncResultCallback) that receives the download progress and the result.
+     * @param uid The user specified UID of async result (optional).
+     *
+     * The size of object is read from its metadata before the ranges are requested.
+     * The file is written in order, the range of FIREBASE_RANGE_DOWNLOAD_BUFFER_SIZE bytes that arrives before the
+     * preceding ranges is kept in its reorder buffer. The blob is split equally and each range is written at its offset.
+     *
+     * This function requires Storage::loop to be called in the main loop.
+     *
+     */
+    void parallelDownload(AsyncClientClass &aClient, const FirebaseStorage::Parent &parent, file_config_data file, uint8_t parts, AsyncResultCallback cb, const StringRef &uid = "")
+    {
+        range_task_t *t = new range_task_t(&aClient, parent, file, parts < aClient.clientCount() ? parts : aClient.clientCount(), cb, uid);
+        rangeVec.push_back(t);
+
+        // The metadata is always requested, the cached size of object that was changed after it was cached can't be used.
+        file_config_data meta;
+        sendRequest(aClient, &t->download.meta, NULL, uid, parent, meta, "", FirebaseStorage::firebase_storage_request_type_get_meta, true);
+    }
+
     /** Upload file to the Firebase Storage.
      *
      * @param aClient The async client.
@@ -194,7 +259,7 @@ public:
      * @param uid The user specified UID of async result (optional).
      *
      */
-    void upload(AsyncClientClass &aClient, const FirebaseStorage::Parent &parent, file_config_data file, const String &mime, AsyncResultCallback cb, const String &uid = "")
+    void upload(AsyncClientClass &aClient, const FirebaseStorage::Parent &parent, file_config_data file, const String &mime, AsyncResultCallback cb, const StringRef &uid = "")
     {
         sendRequest(aClient, nullptr, cb, uid, parent, file, mime, FirebaseStorage::firebase_storage_request_type_upload, true);
     }
@@ -242,7 +307,7 @@ public:
      * @param uid The user specified UID of async result (optional).
      *
      */
-    void ota(AsyncClientClass &aClient, const FirebaseStorage::Parent &parent, AsyncResultCallback cb, const String &uid = "")
+    void ota(AsyncClientClass &aClient, const FirebaseStorage::Parent &parent, AsyncResultCallback cb, const StringRef &uid = "")
     {
         file_config_data file;
         sendRequest(aClient, nullptr, cb, uid, parent, file, "", FirebaseStorage::firebase_storage_request_type_download_ota, true);
@@ -291,12 +356,64 @@ public:
      * @param uid The user specified UID of async result (optional).
      *
      */
-    void getMetadata(AsyncClientClass &aClient, const FirebaseStorage::Parent &parent, AsyncResultCallback cb, const String &uid = "")
+    void getMetadata(AsyncClientClass &aClient, const FirebaseStorage::Parent &parent, AsyncResultCallback cb, const StringRef &uid = "")
     {
         file_config_data file;
         sendRequest(aClient, nullptr, cb, uid, parent, file, "", FirebaseStorage::firebase_storage_request_type_get_meta, true);
     }
 
+    /** Checks if the object exists in Firebase Storage data bucket.
+     *
+     * The metadata is requested as the header-only request, its payload is discarded as it arrives.
+     *
+     * @param aClient The async client.
+     * @param parent The FirebaseStorage::Parent object included Storage bucket Id and object in its constructor.
+     *
+     * @return Boolean value, indicates the object exists.
+     *
+     */
+    bool existed(AsyncClientClass &aClient, const FirebaseStorage::Parent &parent)
+    {
+        AsyncResult result;
+        file_config_data file;
+        aClient.setHeaderOnly(false);
+        sendRequest(aClient, &result, NULL, "", parent, file, "", FirebaseStorage::firebase_storage_request_type_get_meta, false);
+        // The probe is not used when the request was not added.
+        aClient.reqProbe = false;
+        return result.probeInfo().code == FIREBASE_ERROR_HTTP_CODE_OK;
+    }
+
+    /** Get the cached metadata of object in Firebase Storage data bucket.
+     *
+     * @param parent The FirebaseStorage::Parent object included Storage bucket Id and object in its constructor.
+     * @param meta The object_meta_t that receives the generation, size, md5 hash and ETag of object.
+     *
+     * @return Boolean value, indicates the metadata was cached within FIREBASE_OBJECT_META_CACHE_TTL milliseconds.
+     *
+     * The metadata is cached from the responses of getMetadata and upload, and removed by deleteObject.
+     *
+     */
+    bool getCachedMetadata(const FirebaseStorage::Parent &parent, object_meta_t &meta) { return meta_cache.get(ObjectMetaCache::key(parent.getBucketId(), parent.getObject()), meta, FIREBASE_OBJECT_META_CACHE_TTL); }
+
+    /** Clear the cached metadata of objects and the ETag of downloaded files.
+     */
+    void clearMetadataCache()
+    {
+        meta_cache.clear();
+        download_cache.clear();
+        download_state.reset();
+    }
+
+    /** Set the conditional download of file.
+     *
+     * @param enable The boolean value to enable the conditional download.
+     *
+     * When enabled, the file download sends the ETag of last completed download of the same object and file (If-None-Match),
+     * the file is kept and the download is skipped when the object was not modified.
+     *
+     */
+    void setConditionalDownload(bool enable) { conditional_download = enable; }
+
     /** List all objects in Firebase Storage data bucket.
      *
      * @param aClient The async client.
@@ -337,12 +454,32 @@ public:
      * @param uid The user specified UID of async result (optional).
      *
      */
-    void list(AsyncClientClass &aClient, const FirebaseStorage::Parent &parent, AsyncResultCallback cb, const String &uid = "")
+    void list(AsyncClientClass &aClient, const FirebaseStorage::Parent &parent, AsyncResultCallback cb, const StringRef &uid = "")
     {
         file_config_data file;
         sendRequest(aClient, nullptr, cb, uid, parent, file, "", FirebaseStorage::firebase_storage_request_type_list, true);
     }
 
+    /** List all objects in Firebase Storage data bucket page by page via the list iterator.
+     *
+     * @param aClient The async client.
+     * @param parent The FirebaseStorage::Parent object included Storage bucket Id in its constructor.
+     * The bucketid is the Storage bucket Id to list all objects.
+     * @param it The list iterator (ListIterator) that the object entries are taken from by ListIterator::next.
+     *
+     * The pages of FIREBASE_LIST_PAGE_SIZE entries are requested in order, the next page is requested while the entries
+     * of current page are taken. The listing was finished when ListIterator::isDone returns true.
+     *
+     * This function requires Storage::loop to be called in the main loop.
+     *
+     */
+    void list(AsyncClientClass &aClient, const FirebaseStorage::Parent &parent, ListIterator &it)
+    {
+        releaseIterator(it);
+        it.attach(iterVec);
+        listVec.push_back(new list_task_t(&aClient, parent, &it, &iterVec));
+    }
+
     /** Delete the object in Firebase Storage data bucket.
      *
      * @param aClient The async client.
@@ -386,7 +523,7 @@ public:
      * @param uid The user specified UID of async result (optional).
      *
      */
-    void deleteObject(AsyncClientClass &aClient, const FirebaseStorage::Parent &parent, AsyncResultCallback cb, const String &uid = "")
+    void deleteObject(AsyncClientClass &aClient, const FirebaseStorage::Parent &parent, AsyncResultCallback cb, const StringRef &uid = "")
     {
         file_config_data file;
         sendRequest(aClient, nullptr, cb, uid, parent, file, "", FirebaseStorage::firebase_storage_request_type_delete, true);
@@ -398,10 +535,134 @@ private:
     String path;
     String uid;
     // FirebaseApp address and FirebaseApp vector address
-    uint32_t app_addr = 0, avec_addr = 0;
+    list_handle_t app_handle = 0;
     app_token_t *app_token = nullptr;
+    // The progress of download that is resumed by range request.
+    download_resume_state_t download_state;
+    // The progress of OTA update that is resumed by range request.
+    download_resume_state_t ota_state;
+    // The metadata of objects and the ETag of downloaded files (keyed by download target).
+    ObjectMetaCache meta_cache, download_cache;
+    bool conditional_download = false;
+
+    static void onObjectMeta(void *ctx, AsyncResult &aResult)
+    {
+        ObjectMetaCache *cache = static_cast<ObjectMetaCache *>(ctx);
+        if (cache && aResult.c_str())
+            cache->update(aResult.c_str());
+    }
+
+    struct range_task_t
+    {
+    public:
+        RangeDownload download;
+        AsyncClientClass *aClient = nullptr;
+        FirebaseStorage::Parent parent;
+
+        range_task_t(AsyncClientClass *aClient, const FirebaseStorage::Parent &parent, const file_config_data &file, uint8_t parts, AsyncResultCallback cb, const StringRef &uid)
+            : download(file, parts, cb, uid.toString()), aClient(aClient), parent(parent) {}
+    };
+
+    std::vector<range_task_t *> rangeVec; // range_task_t vector
+
+    struct list_task_t
+    {
+    public:
+        ListPage page;
+        AsyncClientClass *aClient = nullptr;
+        FirebaseStorage::Parent parent;
+
+        list_task_t(AsyncClientClass *aClient, const FirebaseStorage::Parent &parent, ListIterator *it, std::vector<ListIterator *> *iVec)
+            : page(it, iVec, ""), aClient(aClient), parent(parent) {}
+    };
+
+    std::vector<list_task_t *> listVec; // list_task_t vector
+    std::vector<ListIterator *> iterVec; // ListIterator vector
+
+    void releaseIterator(ListIterator &it)
+    {
+        // The pages that were in progress are not written to the iterator that is listed again.
+        for (size_t i = 0; i < listVec.size(); i++)
+        {
+            list_task_t *t = listVec[i];
+            if (t)
+                t->page.release(&it);
+        }
+    }
 
-    void sendRequest(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const String &uid, const FirebaseStorage::Parent &parent, file_config_data &file, const String &mime, FirebaseStorage::firebase_storage_request_type requestType, bool async)
+    void handleListIterator()
+    {
+        for (size_t i = listVec.size(); i > 0; i--)
+        {
+            list_task_t *t = listVec[i - 1];
+            if (!t)
+                continue;
+
+            if (!t->page.process())
+            {
+                if (!t->page.busy)
+                {
+                    listVec.erase(listVec.begin() + i - 1);
+                    delete t;
+                }
+                continue;
+            }
+
+            if (t->page.nextRequest())
+                listRequest(t);
+        }
+    }
+
+    void listRequest(list_task_t *t)
+    {
+        FirebaseStorage::DataOptions options;
+        options.requestType = FirebaseStorage::firebase_storage_request_type_list;
+        options.parent = t->parent;
+        options.extras += "?maxResults=";
+        options.extras += FIREBASE_LIST_PAGE_SIZE;
+        if (t->page.token.length())
+        {
+            URLUtil uut;
+            options.extras += "&pageToken=";
+            options.extras += uut.encode(t->page.token);
+        }
+
+        file_config_data file;
+        FirebaseStorage::async_request_data_t aReq(t->aClient, path, async_request_handler_t::http_get, slot_options_t(false, false, true, false, false, false), &options, &file, &t->page.result, NULL, t->page.uid);
+        t->aClient->setPayloadSink(t->page);
+        asyncRequest(aReq);
+        // The sink is not used when the request was not added.
+        t->aClient->reqSink = nullptr;
+    }
+
+    void handleRangeDownload()
+    {
+        for (size_t i = rangeVec.size(); i > 0; i--)
+        {
+            range_task_t *t = rangeVec[i - 1];
+            if (!t)
+                continue;
+
+            if (!t->download.process())
+            {
+                if (!t->download.busy())
+                {
+                    rangeVec.erase(rangeVec.begin() + i - 1);
+                    delete t;
+                }
+                continue;
+            }
+
+            RangeDownload::part_t *p = nullptr;
+            while ((p = t->download.nextRequest()) != nullptr)
+            {
+                file_config_data file;
+                sendRequest(*t->aClient, &p->result, NULL, t->download.uid, t->parent, file, "", FirebaseStorage::firebase_storage_request_type_download, true, p);
+            }
+        }
+    }
+
+    void sendRequest(AsyncClientClass &aClient, AsyncResult *result, AsyncResultCallback cb, const StringRef &uid, const FirebaseStorage::Parent &parent, file_config_data &file, const String &mime, FirebaseStorage::firebase_storage_request_type requestType, bool async, RangeDownload::part_t *part = nullptr)
     {
         FirebaseStorage::DataOptions options;
         options.requestType = requestType;
@@ -426,7 +687,10 @@ private:
             options.extras += uut.encode(parent.getObject());
 
             if (requestType == FirebaseStorage::firebase_storage_request_type_delete)
+            {
                 method = async_request_handler_t::http_delete;
+                meta_cache.remove(ObjectMetaCache::key(parent.getBucketId(), parent.getObject()));
+            }
         }
 
         FirebaseStorage::async_request_data_t aReq(&aClient, path, method, slot_options_t(false, false, async, false, requestType == FirebaseStorage::firebase_storage_request_type_download_ota, false), &options, &file, result, cb, uid);
@@ -434,11 +698,19 @@ private:
         if (mime.length() && requestType == FirebaseStorage::firebase_storage_request_type_upload)
             aReq.mime = mime;
 
+        if (part)
+        {
+            aReq.sink = part;
+            aReq.range_first = part->pos;
+            aReq.range_last = part->end - 1;
+        }
+
         asyncRequest(aReq);
     }
 
     void asyncRequest(FirebaseStorage::async_request_data_t &request, int beta = 0)
     {
+        AsyncClientClass::SlotGuard guard(request.aClient);
         app_token_t *app_token = appToken();
 
         if (!app_token)
@@ -462,6 +734,9 @@ private:
 
         url(FPSTR("firebasestorage.googleapis.com"));
 
+        if (request.sink)
+            request.aClient->setPayloadSink(*request.sink);
+
         async_data_item_t *sData = request.aClient->createSlot(request.opt);
 
         if (!sData)
@@ -469,6 +744,15 @@ private:
 
         request.aClient->newRequest(sData, service_url, request.path, extras, request.method, request.opt, request.uid);
 
+        if (request.options->requestType == FirebaseStorage::firebase_storage_request_type_get_meta || request.options->requestType == FirebaseStorage::firebase_storage_request_type_upload)
+        {
+            sData->event_handler = onObjectMeta;
+            sData->event_ctx = &meta_cache;
+        }
+
+        if (request.sink)
+            request.aClient->setRangeHeader(sData, request.range_first, request.range_last);
+
         if (request.file)
             sData->request.file_data.copy(*request.file);
 
@@ -479,6 +763,39 @@ private:
             sData->request.ota = true;
             sData->request.base64 = false;
             sData->aResult.download_data.ota = true;
+
+            // The interrupted update of the same object is resumed from the bytes that were written to flash.
+            String target = request.options->parent.getBucketId();
+            target += '/';
+            target += request.options->parent.getObject();
+            OTAUtil otaut;
+            if (ota_state.target == target)
+                ota_state.offset = otaut.updateProgress();
+            ota_state.begin(target);
+            request.aClient->setDownloadResume(sData, &ota_state);
+        }
+
+        if (request.file && request.file->filename.length() && sData->download && !request.opt.ota)
+        {
+            // The interrupted download of the same object and file is resumed from the written bytes.
+            String target = request.options->parent.getBucketId();
+            target += '/';
+            target += request.options->parent.getObject();
+            target += ':';
+            target += request.file->filename;
+            if (download_state.done_target.length())
+            {
+                object_meta_t done;
+                done.etag = download_state.done_etag;
+                download_cache.set(download_state.done_target, done);
+                download_state.done_target.remove(0, download_state.done_target.length());
+            }
+            download_state.begin(target);
+            request.aClient->setDownloadResume(sData, &download_state);
+
+            object_meta_t done;
+            if (conditional_download && download_state.start == 0 && download_cache.get(target, done))
+                request.aClient->setConditionalHeader(sData, done.etag);
         }
 
         if (request.file && sData->upload)
@@ -490,7 +807,7 @@ private:
 
             request.aClient->setFileContentLength(sData, 0);
 
-            if (sData->request.file_data.file_size == 0)
+            if (sData->request.file_data.file_size == 0 && !sData->request.file_data.chunked())
                 return setClientError(request, FIREBASE_ERROR_FILE_READ);
 
             URLUtil uut;
@@ -505,10 +822,10 @@ private:
         if (request.cb)
             sData->cb = request.cb;
 
-        request.aClient->addRemoveClientVec(reinterpret_cast<uint32_t>(&(cVec)), true);
+        request.aClient->addRemoveClientVec(cVec, true);
 
         if (request.aResult)
-            sData->setRefResult(request.aResult, reinterpret_cast<uint32_t>(&(request.aClient->rVec)));
+            sData->setRefResult(request.aResult);
 
         request.aClient->process(sData->async);
         request.aClient->handleRemove();
@@ -550,6 +867,16 @@ private:
                             request.method == async_request_handler_t::http_put ||
                             request.method == async_request_handler_t::http_patch;
         }
+        // The sink consumes the download data.
+        else if (request.file && request.file->sink)
+            sData->download = request.method == async_request_handler_t::http_get;
+        else if (request.file && (request.file->source || (request.file->data && request.file->data_size)))
+        {
+            // The blob and producer source are uploaded from memory.
+            sData->upload = request.method == async_request_handler_t::http_post ||
+                            request.method == async_request_handler_t::http_put ||
+                            request.method == async_request_handler_t::http_patch;
+        }
     }
 };
 
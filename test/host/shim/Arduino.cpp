@@ -0,0 +1,96 @@
+#include "Arduino.h"
+
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <random>
+#include <thread>
+
+HardwareSerial Serial;
+
+static std::atomic<uint32_t> alloc_count{0};
+
+static const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+static std::minstd_rand rng;
+
+unsigned long millis() { return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count(); }
+
+unsigned long micros() { return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count(); }
+
+void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+void delayMicroseconds(unsigned int us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+
+void yield() {}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    (void)pin;
+    (void)val;
+}
+
+long random(long max) { return max > 0 ? (long)(rng() % (unsigned long)max) : 0; }
+
+long random(long min, long max) { return max > min ? min + random(max - min) : min; }
+
+void randomSeed(unsigned long seed) { rng.seed(seed); }
+
+uint32_t hostAllocCount() { return alloc_count.load(std::memory_order_relaxed); }
+
+#if defined(__GLIBC__)
+
+// The glibc allocator is wrapped to count the allocations of C and C++ code (operator new calls malloc).
+extern "C"
+{
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t n, size_t size);
+    void *__libc_realloc(void *ptr, size_t size);
+
+    void *malloc(size_t size)
+    {
+        alloc_count.fetch_add(1, std::memory_order_relaxed);
+        return __libc_malloc(size);
+    }
+
+    void *calloc(size_t n, size_t size)
+    {
+        alloc_count.fetch_add(1, std::memory_order_relaxed);
+        return __libc_calloc(n, size);
+    }
+
+    void *realloc(void *ptr, size_t size)
+    {
+        alloc_count.fetch_add(1, std::memory_order_relaxed);
+        return __libc_realloc(ptr, size);
+    }
+}
+
+#else
+
+// Only the C++ allocations are counted on the other C libraries.
+void *operator new(size_t size)
+{
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+
+void operator delete(void *p) noexcept { free(p); }
+
+void operator delete[](void *p) noexcept { free(p); }
+
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+#endif
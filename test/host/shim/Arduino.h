@@ -0,0 +1,494 @@
+/**
+ * The minimal Arduino core emulation to build and test the library on host (Linux and macOS) with CMake.
+ *
+ * Only the parts of the Arduino API that are used by the library and its tests are emulated.
+ */
+#ifndef HOST_SHIM_ARDUINO_H
+#define HOST_SHIM_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+#define FPSTR(p) (reinterpret_cast<const __FlashStringHelper *>(p))
+#define pgm_read_byte(a) (*(const uint8_t *)(a))
+#define pgm_read_word(a) (*(const uint16_t *)(a))
+#define pgm_read_dword(a) (*(const uint32_t *)(a))
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strlen_P strlen
+#define memcpy_P memcpy
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+
+#define HIGH 1
+#define LOW 0
+#define OUTPUT 1
+#define INPUT 0
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+// The number of heap allocations (malloc, calloc, realloc and new) of the process since it was started.
+uint32_t hostAllocCount();
+
+class String
+{
+public:
+    String() {}
+    String(const char *c) : s(c ? c : "") {}
+    String(const __FlashStringHelper *c) : s(c ? reinterpret_cast<const char *>(c) : "") {}
+    String(const String &o) = default;
+    String(String &&o) = default;
+    explicit String(char c) : s(1, c) {}
+    explicit String(unsigned char v, unsigned char base = 10) { setNum(v, base); }
+    explicit String(int v, unsigned char base = 10) { setNum(v, base); }
+    explicit String(unsigned int v, unsigned char base = 10) { setNum(v, base); }
+    explicit String(long v, unsigned char base = 10) { setNum(v, base); }
+    explicit String(unsigned long v, unsigned char base = 10) { setNum(v, base); }
+    explicit String(long long v, unsigned char base = 10) { setNum(v, base); }
+    explicit String(unsigned long long v, unsigned char base = 10) { setNum(v, base); }
+    explicit String(float v, unsigned int decimals = 2) { setFloat(v, decimals); }
+    explicit String(double v, unsigned int decimals = 2) { setFloat(v, decimals); }
+
+    String &operator=(const String &) = default;
+    String &operator=(String &&) = default;
+    String &operator=(const char *c)
+    {
+        s = c ? c : "";
+        return *this;
+    }
+    String &operator=(const __FlashStringHelper *c) { return *this = reinterpret_cast<const char *>(c); }
+    String &operator=(char c)
+    {
+        s.assign(1, c);
+        return *this;
+    }
+
+    unsigned int length() const { return s.size(); }
+    const char *c_str() const { return s.c_str(); }
+    bool reserve(unsigned int n)
+    {
+        s.reserve(n);
+        return true;
+    }
+    void clear() { s.clear(); }
+    bool isEmpty() const { return s.empty(); }
+
+    char operator[](unsigned int i) const { return i < s.size() ? s[i] : 0; }
+    char &operator[](unsigned int i) { return s[i]; }
+    char charAt(unsigned int i) const { return (*this)[i]; }
+    void setCharAt(unsigned int i, char c)
+    {
+        if (i < s.size())
+            s[i] = c;
+    }
+
+    int indexOf(char c, unsigned int from = 0) const { return pos(s.find(c, from)); }
+    int indexOf(const String &c, unsigned int from = 0) const { return pos(s.find(c.s, from)); }
+    int indexOf(const char *c, unsigned int from = 0) const { return pos(s.find(c ? c : "", from)); }
+    int lastIndexOf(char c) const { return pos(s.rfind(c)); }
+    int lastIndexOf(char c, unsigned int from) const { return pos(s.rfind(c, from)); }
+    int lastIndexOf(const String &c) const { return pos(s.rfind(c.s)); }
+    int lastIndexOf(const String &c, unsigned int from) const { return pos(s.rfind(c.s, from)); }
+
+    String substring(unsigned int b) const { return b < s.size() ? String(s.substr(b)) : String(); }
+    String substring(unsigned int b, unsigned int e) const
+    {
+        if (b > e)
+            std::swap(b, e);
+        return b < s.size() ? String(s.substr(b, e - b)) : String();
+    }
+    void remove(unsigned int i)
+    {
+        if (i < s.size())
+            s.erase(i);
+    }
+    void remove(unsigned int i, unsigned int n)
+    {
+        if (i < s.size())
+            s.erase(i, n);
+    }
+    void replace(const String &a, const String &b)
+    {
+        if (a.s.empty())
+            return;
+        size_t p = 0;
+        while ((p = s.find(a.s, p)) != std::string::npos)
+        {
+            s.replace(p, a.s.size(), b.s);
+            p += b.s.size();
+        }
+    }
+    void replace(char a, char b)
+    {
+        for (auto &c : s)
+            if (c == a)
+                c = b;
+    }
+    void trim()
+    {
+        size_t a = s.find_first_not_of(" \t\r\n\f\v");
+        if (a == std::string::npos)
+        {
+            s.clear();
+            return;
+        }
+        size_t b = s.find_last_not_of(" \t\r\n\f\v");
+        s = s.substr(a, b - a + 1);
+    }
+    void toLowerCase()
+    {
+        for (auto &c : s)
+            c = tolower((unsigned char)c);
+    }
+    void toUpperCase()
+    {
+        for (auto &c : s)
+            c = toupper((unsigned char)c);
+    }
+
+    long toInt() const { return atol(s.c_str()); }
+    float toFloat() const { return atof(s.c_str()); }
+    double toDouble() const { return atof(s.c_str()); }
+
+    bool startsWith(const String &p) const { return s.compare(0, p.s.size(), p.s) == 0; }
+    bool startsWith(const String &p, unsigned int offset) const { return offset <= s.size() && s.compare(offset, p.s.size(), p.s) == 0; }
+    bool endsWith(const String &p) const { return s.size() >= p.s.size() && s.compare(s.size() - p.s.size(), p.s.size(), p.s) == 0; }
+    bool equals(const String &o) const { return s == o.s; }
+    bool equals(const char *o) const { return s == (o ? o : ""); }
+    bool equalsIgnoreCase(const String &o) const { return s.size() == o.s.size() && strncasecmp(s.c_str(), o.s.c_str(), s.size()) == 0; }
+    int compareTo(const String &o) const { return s.compare(o.s); }
+
+    bool concat(const String &o) { return append(o.s.data(), o.s.size()); }
+    bool concat(const char *o) { return o ? append(o, strlen(o)) : false; }
+    bool concat(const char *o, unsigned int n) { return o ? append(o, n) : false; }
+    bool concat(const __FlashStringHelper *o) { return concat(reinterpret_cast<const char *>(o)); }
+    bool concat(char c) { return append(&c, 1); }
+    bool concat(unsigned char v) { return concat(String(v)); }
+    bool concat(int v) { return concat(String(v)); }
+    bool concat(unsigned int v) { return concat(String(v)); }
+    bool concat(long v) { return concat(String(v)); }
+    bool concat(unsigned long v) { return concat(String(v)); }
+    bool concat(long long v) { return concat(String(v)); }
+    bool concat(unsigned long long v) { return concat(String(v)); }
+    bool concat(float v) { return concat(String(v)); }
+    bool concat(double v) { return concat(String(v)); }
+
+    template <typename T>
+    String &operator+=(const T &v)
+    {
+        concat(v);
+        return *this;
+    }
+
+    void getBytes(unsigned char *buf, unsigned int n, unsigned int index = 0) const { copyTo(reinterpret_cast<char *>(buf), n, index); }
+    void toCharArray(char *buf, unsigned int n, unsigned int index = 0) const { copyTo(buf, n, index); }
+
+    char *begin() { return &s[0]; }
+    char *end() { return &s[0] + s.size(); }
+    const char *begin() const { return s.data(); }
+    const char *end() const { return s.data() + s.size(); }
+
+    bool operator==(const String &o) const { return s == o.s; }
+    bool operator==(const char *o) const { return equals(o); }
+    bool operator!=(const String &o) const { return s != o.s; }
+    bool operator!=(const char *o) const { return !equals(o); }
+    bool operator<(const String &o) const { return s < o.s; }
+    bool operator>(const String &o) const { return s > o.s; }
+
+    template <typename T>
+    friend String operator+(const String &a, const T &b)
+    {
+        String r(a);
+        r += b;
+        return r;
+    }
+    friend String operator+(const char *a, const String &b)
+    {
+        String r(a);
+        r += b;
+        return r;
+    }
+
+private:
+    std::string s;
+
+    explicit String(const std::string &v) : s(v) {}
+
+    static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+
+    bool append(const char *p, size_t n)
+    {
+        s.append(p, n);
+        return true;
+    }
+
+    void copyTo(char *buf, unsigned int n, unsigned int index) const
+    {
+        if (!buf || n == 0)
+            return;
+        size_t len = index < s.size() ? s.size() - index : 0;
+        if (len > n - 1)
+            len = n - 1;
+        memcpy(buf, s.data() + (index < s.size() ? index : 0), len);
+        buf[len] = 0;
+    }
+
+    template <typename T>
+    void setNum(T v, unsigned char base)
+    {
+        if (base == 10 || base < 2 || base > 36)
+        {
+            s = std::to_string(v);
+            return;
+        }
+        // The non-decimal numbers are unsigned as Arduino core.
+        unsigned long long u = static_cast<unsigned long long>(v);
+        if (sizeof(T) < sizeof(u))
+            u &= (1ULL << (sizeof(T) * 8)) - 1;
+        do
+        {
+            int d = u % base;
+            s.insert(s.begin(), (char)(d < 10 ? '0' + d : 'a' + d - 10));
+            u /= base;
+        } while (u);
+    }
+
+    void setFloat(double v, unsigned int decimals)
+    {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+        s = buf;
+    }
+};
+
+class Print;
+
+class Printable
+{
+public:
+    virtual ~Printable() {}
+    virtual size_t printTo(Print &p) const = 0;
+};
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t) = 0;
+    virtual size_t write(const uint8_t *buf, size_t size)
+    {
+        size_t n = 0;
+        while (size-- && write(*buf++))
+            n++;
+        return n;
+    }
+    size_t write(const char *str) { return str ? write(reinterpret_cast<const uint8_t *>(str), strlen(str)) : 0; }
+    size_t write(const char *buf, size_t size) { return write(reinterpret_cast<const uint8_t *>(buf), size); }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    int getWriteError() { return write_error; }
+    void clearWriteError() { write_error = 0; }
+
+    size_t print(const __FlashStringHelper *s) { return write(reinterpret_cast<const char *>(s)); }
+    size_t print(const String &s) { return write(s.c_str(), s.length()); }
+    size_t print(const char *s) { return write(s); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char v, int base = DEC) { return print(String(v, base)); }
+    size_t print(int v, int base = DEC) { return print(String(v, base)); }
+    size_t print(unsigned int v, int base = DEC) { return print(String(v, base)); }
+    size_t print(long v, int base = DEC) { return print(String(v, base)); }
+    size_t print(unsigned long v, int base = DEC) { return print(String(v, base)); }
+    size_t print(long long v, int base = DEC) { return print(String(v, base)); }
+    size_t print(unsigned long long v, int base = DEC) { return print(String(v, base)); }
+    size_t print(double v, int decimals = 2) { return print(String(v, (unsigned int)decimals)); }
+    size_t print(const Printable &p) { return p.printTo(*this); }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T &v) { return print(v) + println(); }
+    template <typename T>
+    size_t println(const T &v, int format) { return print(v, format) + println(); }
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)))
+    {
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(nullptr, 0, format, args);
+        va_end(args);
+        if (len <= 0)
+            return 0;
+        std::string buf(len, 0);
+        va_start(args, format);
+        vsnprintf(&buf[0], len + 1, format, args);
+        va_end(args);
+        return write(buf.data(), buf.size());
+    }
+
+protected:
+    void setWriteError(int err = 1) { write_error = err; }
+
+private:
+    int write_error = 0;
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long ms) { timeout_ms = ms; }
+    unsigned long getTimeout() { return timeout_ms; }
+
+    virtual size_t readBytes(uint8_t *buf, size_t size)
+    {
+        size_t n = 0;
+        while (n < size)
+        {
+            int c = timedRead();
+            if (c < 0)
+                break;
+            buf[n++] = c;
+        }
+        return n;
+    }
+    size_t readBytes(char *buf, size_t size) { return readBytes(reinterpret_cast<uint8_t *>(buf), size); }
+
+    String readStringUntil(char terminator)
+    {
+        String ret;
+        int c;
+        while ((c = timedRead()) >= 0 && c != terminator)
+            ret += (char)c;
+        return ret;
+    }
+
+    String readString()
+    {
+        String ret;
+        int c;
+        while ((c = timedRead()) >= 0)
+            ret += (char)c;
+        return ret;
+    }
+
+protected:
+    unsigned long timeout_ms = 1000;
+
+    int timedRead()
+    {
+        unsigned long ms = millis();
+        do
+        {
+            int c = read();
+            if (c >= 0)
+                return c;
+            yield();
+        } while (millis() - ms < timeout_ms);
+        return -1;
+    }
+};
+
+class IPAddress : public Printable
+{
+public:
+    IPAddress() {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+    {
+        bytes[0] = a;
+        bytes[1] = b;
+        bytes[2] = c;
+        bytes[3] = d;
+    }
+    IPAddress(uint32_t addr) { memcpy(bytes, &addr, 4); }
+
+    operator uint32_t() const
+    {
+        uint32_t addr;
+        memcpy(&addr, bytes, 4);
+        return addr;
+    }
+    uint8_t operator[](int i) const { return bytes[i]; }
+    uint8_t &operator[](int i) { return bytes[i]; }
+    bool operator==(const IPAddress &o) const { return memcmp(bytes, o.bytes, 4) == 0; }
+
+    bool fromString(const char *str)
+    {
+        unsigned int v[4];
+        char tail;
+        if (!str || sscanf(str, "%u.%u.%u.%u%c", &v[0], &v[1], &v[2], &v[3], &tail) != 4)
+            return false;
+        for (int i = 0; i < 4; i++)
+        {
+            if (v[i] > 255)
+                return false;
+            bytes[i] = v[i];
+        }
+        return true;
+    }
+    bool fromString(const String &str) { return fromString(str.c_str()); }
+
+    String toString() const
+    {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+        return String(buf);
+    }
+
+    size_t printTo(Print &p) const override { return p.print(toString()); }
+
+private:
+    uint8_t bytes[4] = {0, 0, 0, 0};
+};
+
+// The serial port that writes to stdout and reads from stdin.
+class HardwareSerial : public Stream
+{
+public:
+    using Print::write;
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+    size_t write(const uint8_t *buf, size_t size) override { return fwrite(buf, 1, size, stdout); }
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    void flush() override { fflush(stdout); }
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif
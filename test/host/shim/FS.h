@@ -0,0 +1,116 @@
+#ifndef HOST_SHIM_FS_H
+#define HOST_SHIM_FS_H
+
+#include "Arduino.h"
+#include <map>
+#include <memory>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs
+{
+    enum SeekMode
+    {
+        SeekSet,
+        SeekCur,
+        SeekEnd
+    };
+
+    // The file of the in-memory file system, its data is kept by FS until it is removed.
+    class File : public Stream
+    {
+    public:
+        using Print::write;
+        File() {}
+        File(std::shared_ptr<std::string> data, const char *path, bool append) : data(data), path(path), pos(append ? data->size() : 0) {}
+
+        size_t write(uint8_t c) override { return write(&c, 1); }
+        size_t write(const uint8_t *buf, size_t size) override
+        {
+            if (!data)
+                return 0;
+            data->replace(pos, pos + size > data->size() ? data->size() - pos : size, reinterpret_cast<const char *>(buf), size);
+            pos += size;
+            return size;
+        }
+        int available() override { return data ? data->size() - pos : 0; }
+        int read() override { return data && pos < data->size() ? (uint8_t)(*data)[pos++] : -1; }
+        int read(uint8_t *buf, size_t size)
+        {
+            size_t n = available();
+            if (n > size)
+                n = size;
+            if (n)
+                memcpy(buf, data->data() + pos, n);
+            pos += n;
+            return n;
+        }
+        size_t readBytes(uint8_t *buf, size_t size) override { return read(buf, size); }
+        int peek() override { return data && pos < data->size() ? (uint8_t)(*data)[pos] : -1; }
+        bool seek(uint32_t offset, SeekMode mode = SeekSet)
+        {
+            if (!data)
+                return false;
+            size_t p = mode == SeekSet ? offset : mode == SeekCur ? pos + offset : data->size() + offset;
+            if (p > data->size())
+                return false;
+            pos = p;
+            return true;
+        }
+        size_t position() const { return pos; }
+        size_t size() const { return data ? data->size() : 0; }
+        const char *name() const { return path.c_str(); }
+        void close()
+        {
+            data.reset();
+            pos = 0;
+        }
+        operator bool() const { return data != nullptr; }
+
+    private:
+        std::shared_ptr<std::string> data;
+        String path;
+        size_t pos = 0;
+    };
+
+    // The in-memory file system.
+    class FS
+    {
+    public:
+        File open(const char *path, const char *mode = FILE_READ)
+        {
+            auto it = files.find(path);
+            if (mode[0] == 'r')
+                return it == files.end() ? File() : File(it->second, path, false);
+            if (it == files.end())
+                it = files.emplace(path, std::make_shared<std::string>()).first;
+            if (mode[0] == 'w')
+                it->second->clear();
+            return File(it->second, path, mode[0] == 'a');
+        }
+        File open(const String &path, const char *mode = FILE_READ) { return open(path.c_str(), mode); }
+        bool exists(const char *path) { return files.count(path) > 0; }
+        bool exists(const String &path) { return exists(path.c_str()); }
+        bool remove(const char *path) { return files.erase(path) > 0; }
+        bool remove(const String &path) { return remove(path.c_str()); }
+        bool mkdir(const char *path)
+        {
+            (void)path;
+            return true;
+        }
+
+    private:
+        std::map<std::string, std::shared_ptr<std::string>> files;
+    };
+}
+
+using fs::File;
+using fs::FS;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef HOST_SHIM_IPADDRESS_H
+#define HOST_SHIM_IPADDRESS_H
+
+#include "Arduino.h"
+
+#endif
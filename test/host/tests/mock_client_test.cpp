@@ -0,0 +1,174 @@
+/**
+ * The host test of the async client with MockClient, the Content-Length, chunked and SSE responses are replayed
+ * through the Realtime Database get and checked.
+ */
+#include <Arduino.h>
+#include <FirebaseClient.h>
+#include <core/MockClient.h>
+
+#define CHECK(cond)                                                  \
+    do                                                               \
+    {                                                                \
+        if (!(cond))                                                 \
+        {                                                            \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            failures++;                                              \
+        }                                                            \
+    } while (0)
+
+static const char content_length_response[] = "HTTP/1.1 200 OK\r\nContent-Type: application/json; charset=utf-8\r\nContent-Length: 43\r\nConnection: keep-alive\r\n\r\n{\"name\":\"replay\",\"count\":12345,\"flag\":true}";
+
+static const char chunked_response[] = "HTTP/1.1 200 OK\r\nContent-Type: application/json; charset=utf-8\r\nTransfer-Encoding: chunked\r\nConnection: keep-alive\r\n\r\n10\r\n{\"name\":\"replay\"\r\n1B\r\n,\"count\":12345,\"flag\":true}\r\n0\r\n\r\n";
+
+static const char not_found_response[] = "HTTP/1.1 404 Not Found\r\nContent-Type: application/json; charset=utf-8\r\nContent-Length: 25\r\n\r\n{\"error\":\"404 Not Found\"}";
+
+static const char sse_response[] = "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n\r\n"
+                                   "event: put\ndata: {\"path\":\"/\",\"data\":{\"a\":1}}\n\n"
+                                   "event: patch\ndata: {\"path\":\"/s1\",\"data\":{\"temp\":25}}\n\n";
+
+static const char payload[] = "{\"name\":\"replay\",\"count\":12345,\"flag\":true}";
+
+static int failures = 0;
+
+void netconnect() {}
+
+void netStatus(bool &status) { status = true; }
+
+GenericNetwork network(netconnect, netStatus);
+
+LegacyToken legacy_token("mock_database_secret");
+
+FirebaseApp app;
+
+MockClient mock;
+
+AsyncClientClass aClient(mock, getNetwork(network));
+
+RealtimeDatabase Database;
+
+// Wait until the result is available or error, the available() is true once.
+static bool wait(AsyncResult &result)
+{
+    unsigned long ms = millis();
+    while (millis() - ms < 5000)
+    {
+        Database.loop();
+        if (result.available())
+            return true;
+        if (result.isError())
+            return false;
+    }
+    return false;
+}
+
+static void get(const char *response, size_t chunk_size)
+{
+    mock.clearResponses();
+    mock.addResponse(response);
+    mock.setChunkSize(chunk_size);
+
+    AsyncResult result;
+    Database.get(aClient, "/replay", result);
+    CHECK(wait(result));
+    CHECK(strcmp(result.c_str(), payload) == 0);
+    CHECK(mock.requestCount() == 1);
+    CHECK(mock.lastRequest().startsWith("GET /replay.json"));
+}
+
+static void getError()
+{
+    mock.clearResponses();
+    mock.addResponse(not_found_response);
+    mock.setChunkSize(0);
+
+    AsyncResult result;
+    Database.get(aClient, "/missing", result);
+    CHECK(!wait(result));
+    CHECK(result.error().code() == 404);
+}
+
+static void connectFail()
+{
+    mock.clearResponses();
+    mock.addResponse(content_length_response);
+    mock.setConnectFail(true);
+
+    AsyncResult result;
+    Database.get(aClient, "/replay", result);
+    CHECK(!wait(result));
+    CHECK(result.error().code() != 0);
+    CHECK(mock.requestCount() == 0);
+    mock.setConnectFail(false);
+}
+
+static int events = 0;
+static String event_data;
+
+static void eventCB(AsyncResult &aResult)
+{
+    if (aResult.available() && aResult.to<RealtimeDatabaseResult>().isStream())
+    {
+        events++;
+        event_data += aResult.to<RealtimeDatabaseResult>().event();
+        event_data += ',';
+        event_data += aResult.to<RealtimeDatabaseResult>().dataPath();
+        event_data += ';';
+    }
+}
+
+static void stream()
+{
+    mock.clearResponses();
+    mock.addResponse(sse_response);
+    mock.setChunkSize(7);
+
+    Database.get(aClient, "/stream", eventCB, true /* SSE mode (HTTP Streaming) */);
+    unsigned long ms = millis();
+    while (events < 2 && millis() - ms < 5000)
+        Database.loop();
+    CHECK(events == 2);
+    CHECK(event_data == "put,/;patch,/s1;");
+
+    aClient.stopAsync(true);
+    for (int i = 0; i < 10; i++)
+        Database.loop();
+}
+
+static void base64()
+{
+    const char *text = "MockClient host test";
+    char enc[64];
+    uint8_t dec[64];
+    size_t len = Base64Util::encodeChars(reinterpret_cast<const uint8_t *>(text), strlen(text), enc, false);
+    enc[len] = 0;
+    CHECK(strcmp(enc, "TW9ja0NsaWVudCBob3N0IHRlc3Q=") == 0);
+
+    Base64Decoder decoder;
+    size_t written = 0;
+    decoder.decode(reinterpret_cast<const uint8_t *>(enc), len, dec, sizeof(dec), written);
+    CHECK(written == strlen(text) && memcmp(dec, text, written) == 0);
+}
+
+int main()
+{
+    initializeApp(aClient, app, getAuth(legacy_token));
+    unsigned long ms = millis();
+    while (!app.ready() && millis() - ms < 5000)
+        app.loop();
+    CHECK(app.ready());
+
+    app.getApp<RealtimeDatabase>(Database);
+    Database.url("https://mock-default-rtdb.firebaseio.com");
+
+    get(content_length_response, 0);
+    get(content_length_response, 1);
+    get(chunked_response, 0);
+    get(chunked_response, 5);
+    getError();
+    connectFail();
+    stream();
+    base64();
+
+    printf("%d failure(s)\n", failures);
+    return failures ? 1 : 0;
+}
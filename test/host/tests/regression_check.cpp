@@ -0,0 +1,10 @@
+/**
+ * The host run of the RegressionCheck example, the test fails when any of its checks failed.
+ */
+#include "../../../examples/App/Benchmark/RegressionCheck/RegressionCheck.ino"
+
+int main()
+{
+    setup();
+    return failed ? 1 : 0;
+}